@@ -59,6 +59,7 @@ All types and functions can then be written without the `CCC_` prefix. */
 #include <stddef.h>
 /** @endcond */
 
+#include "buffer.h"
 #include "private/private_array_tree_map.h"
 #include "types.h"
 
@@ -519,6 +520,39 @@ CCC_array_tree_map_clear_and_free_reserve function. */
 CCC_Result CCC_array_tree_map_reserve(CCC_Array_tree_map *map, size_t to_add,
                                       CCC_Allocator *allocate);
 
+/** @brief Builds a perfectly balanced map from a Buffer sorted by key in
+linear time.
+@param[in] map an initialized and empty map.
+@param[in] sorted a Buffer of user types sorted in strictly ascending order of
+key.
+@return OK if the map now holds a copy of every element of the Buffer. An
+argument error if map or sorted is NULL, the map is not empty, the Buffer
+element size differs from the map element size, or the keys are not strictly
+ascending. If the map lacks the capacity and cannot allocate, the resizing
+error is returned. The map is unchanged on any error.
+
+The map resizes at most once to hold exactly the elements of the Buffer and its
+sentinel. The elements are copied into consecutive slots with one copy and the
+tree is built over those slots from the middle out, assigning every parity bit
+directly, so no rotations or fix ups occur. Any remaining capacity is placed on
+the free list in slot order. O(N) compared to the O(NlgN) of N insertions.
+
+```
+#define ARRAY_TREE_MAP_USING_NAMESPACE_CCC
+Array_tree_map map = array_tree_map_initialize(
+    NULL,
+    struct Val,
+    key,
+    key_order,
+    std_allocate,
+    NULL,
+    0
+);
+CCC_Result const r = array_tree_map_from_sorted(&map, &sorted_vals);
+``` */
+CCC_Result CCC_array_tree_map_from_sorted(CCC_Array_tree_map *map,
+                                          CCC_Buffer const *sorted);
+
 /**@}*/
 
 /**@name Membership Interface
@@ -629,6 +663,24 @@ map. If more space is needed but allocation fails an insert error is set. */
             .private                                                           \
     }
 
+/** @brief Attempts to insert the key value in type starting the search at a
+handle already in the map. O(lg D) comparisons for a key D elements away from
+the hint.
+@param[in] map the pointer to the map.
+@param[in] hint the handle of an element in the map near the key or 0 to search
+from the root.
+@param[in] type the type user type map elem.
+@return a handle as returned by try insert.
+
+A good hint is the handle inserted last when keys arrive nearly sorted. A new
+greatest key with the previous greatest key as the hint costs O(1) comparisons
+and the rebalancing of an insert is amortized O(1). The search walks up parent
+links from the hint without comparing until it reaches an ancestor that could
+bound the key so any hint is correct, but a far hint is slower than none. */
+[[nodiscard]] CCC_Handle
+CCC_array_tree_map_try_insert_hint(CCC_Array_tree_map *map,
+                                   CCC_Handle_index hint, void const *type);
+
 /** @brief lazily insert type_compound_literal into the map at key if key is
 absent.
 @param[in] array_tree_map_pointer a pointer to the map.
@@ -661,6 +713,21 @@ the information regarding its presence is helpful. */
 [[nodiscard]] CCC_Handle
 CCC_array_tree_map_insert_or_assign(CCC_Array_tree_map *map, void const *type);
 
+/** @brief Invariantly inserts or overwrites a user struct into the map starting
+the search at a handle already in the map. O(lg D) comparisons for a key D
+elements away from the hint.
+@param[in] map a pointer to the map.
+@param[in] hint the handle of an element in the map near the key or 0 to search
+from the root.
+@param[in] type the type user struct key value.
+@return a handle as returned by insert or assign.
+
+See try insert hint for how the hint is used. */
+[[nodiscard]] CCC_Handle
+CCC_array_tree_map_insert_or_assign_hint(CCC_Array_tree_map *map,
+                                         CCC_Handle_index hint,
+                                         void const *type);
+
 /** @brief Inserts a new key value pair or overwrites the existing handle.
 @param[in] array_tree_map_pointer the pointer to the handle hash map.
 @param[in] key the key to be searched in the map.
@@ -754,6 +821,41 @@ to subsequent calls in the Handle Interface. */
             .private                                                           \
     }
 
+/** @brief Obtains a handle for the provided key starting the search at a handle
+already in the map. O(lg D) comparisons for a key D elements away from the hint.
+@param[in] map the map to be searched.
+@param[in] hint the handle of an element in the map near the key or 0 to search
+from the root.
+@param[in] key the key used to search the map matching the stored key type.
+@return a specialized handle for use with other functions in the Handle
+Interface.
+@warning the contents of a handle should not be examined or modified. Use the
+provided functions, only.
+
+The handle is the same as the one the search from the root would return so a
+vacant handle inserts next to the hint in O(1) when the key is adjacent to it.
+See try insert hint for how the hint is used. */
+[[nodiscard]] CCC_Array_tree_map_handle
+CCC_array_tree_map_handle_hint(CCC_Array_tree_map const *map,
+                               CCC_Handle_index hint, void const *key);
+
+/** @brief Obtains a handle for the provided key starting the search at a handle
+already in the map.
+@param[in] array_tree_map_pointer the map to be searched.
+@param[in] hint the handle of an element in the map near the key or 0.
+@param[in] key_pointer the key used to search the map matching the stored key
+type.
+@return a compound literal reference to a specialized handle for use with other
+functions in the Handle Interface. */
+#define CCC_array_tree_map_handle_hint_wrap(array_tree_map_pointer, hint,      \
+                                            key_pointer)                       \
+    &(CCC_Array_tree_map_handle)                                               \
+    {                                                                          \
+        CCC_array_tree_map_handle_hint((array_tree_map_pointer), (hint),       \
+                                       (key_pointer))                          \
+            .private                                                           \
+    }
+
 /** @brief Modifies the provided handle if it is Occupied.
 @param[in] handle the handle obtained from a handle function or macro.
 @param[in] modify an update function in which the context argument is unused.
@@ -1140,6 +1242,162 @@ CCC_array_tree_map_reverse_end(CCC_Array_tree_map const *map);
 
 /**@}*/
 
+/** @name Order Statistics Interface
+Query the map by the sorted position of its elements. A map only pays for
+subtree counts once order statistics are enabled. The counts are then stored in
+their own array at the end of the allocation and kept up to date on the path of
+every insert or remove. */
+/**@{*/
+
+/** @brief Maintain subtree counts so the map supports rank and select. O(N)
+the first time to count the existing nodes, O(1) thereafter.
+@param[in] map a pointer to the map.
+@return OK if the counts are now maintained, an argument error if map is NULL,
+a no allocation function error if the map cannot allocate, or an allocator
+error if the larger allocation fails.
+
+The counts array is added to the allocation so the map is moved to a new
+allocation of the same capacity. A fixed size map cannot grow its allocation
+and therefore cannot enable order statistics. Insertion and removal each add an
+O(lg N) walk to the root once enabled. The counts remain enabled after a clear.
+A copy keeps the setting of the destination. */
+CCC_Result
+CCC_array_tree_map_enable_order_statistics(CCC_Array_tree_map *map);
+
+/** @brief Return the number of elements with keys less than the given key.
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] key a pointer to the key which need not be in the map.
+@return the count of keys LESS than key which is the index of key in sorted
+order if it is present. An argument error is set if map or key is NULL or if
+order statistics are not enabled. */
+[[nodiscard]] CCC_Count CCC_array_tree_map_rank(CCC_Array_tree_map const *map,
+                                                void const *key);
+
+/** @brief Return a handle to the element at the given index in sorted order.
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] index the zero based position of the element in sorted order.
+@return a handle to the element at index or 0 if index is out of range, map is
+NULL, or order statistics are not enabled. */
+[[nodiscard]] CCC_Handle_index
+CCC_array_tree_map_select(CCC_Array_tree_map const *map, size_t index);
+
+/** @brief Return the number of elements with keys in [begin_key, end_key).
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] begin_key a pointer to the inclusive start of the range.
+@param[in] end_key a pointer to the exclusive end of the range.
+@return the count of keys NOT LESS than begin_key and LESS than end_key, 0 if
+end_key does not follow begin_key. An argument error is set if any argument is
+NULL or if order statistics are not enabled. */
+[[nodiscard]] CCC_Count
+CCC_array_tree_map_count_range(CCC_Array_tree_map const *map,
+                               void const *begin_key, void const *end_key);
+
+/**@}*/
+
+/** @name Join and Split Interface
+Move or combine whole ranges of elements between maps. Elements live in the
+array of their map so they are copied from one map to the other rather than
+relinked. The two maps must be initialized with the same user type, key field,
+and comparison function. Otherwise an argument error is returned and neither
+map is modified. The maps may use different allocation functions, contexts,
+and capacities.
+
+Any operation that copies elements into a map first makes room for them. If the
+map receiving the elements does not have the room and cannot allocate it, the
+allocation result is returned and neither map is modified. Elements removed from
+a map return their slots to that map for reuse.
+
+The set operations split the destination tree by the keys of the source and
+join the results back together. For maps of size M and N with M <= N they run
+in O(M lg(N / M + 1)) plus the cost of copying new elements. The source of a set
+operation is never modified. */
+/**@{*/
+
+/** @brief Move every element of the source to the end of the destination.
+O(K + lg N) to copy the K elements of the source.
+@param[in] destination the map that receives the elements.
+@param[in] source the map with keys all greater than those in destination.
+@return OK if the source is now empty and its elements are in the destination.
+An argument error is returned if the maps are not compatible or a key in source
+is not greater than every key in destination. An allocation error is returned if
+the destination cannot hold the elements. */
+CCC_Result CCC_array_tree_map_join(CCC_Array_tree_map *destination,
+                                   CCC_Array_tree_map *source);
+
+/** @brief Move every element with a key not less than key into the empty
+destination. O(K + lg N) to copy the K elements moved.
+@param[in] map the map to split.
+@param[in] key the key that begins the moved elements. It need not be present.
+@param[in] destination an empty map that receives the elements.
+@return OK if the split succeeds or an argument error if an argument is NULL,
+the destination is not empty, or the maps are not compatible. An allocation
+error is returned if the destination cannot hold the elements. */
+CCC_Result CCC_array_tree_map_split(CCC_Array_tree_map *map, void const *key,
+                                    CCC_Array_tree_map *destination);
+
+/** @brief Move every element with a key in [begin_key, end_key) into the empty
+destination. O(K + lg N) to copy the K elements moved.
+@param[in] map the map to extract from.
+@param[in] begin_key the inclusive start of the range.
+@param[in] end_key the exclusive end of the range.
+@param[in] destination an empty map that receives the elements.
+@return OK if the extraction succeeds, even if the range is empty, or an
+argument error if an argument is NULL, the destination is not empty, or the
+maps are not compatible. An allocation error is returned if the destination
+cannot hold the elements. */
+CCC_Result CCC_array_tree_map_extract_range(CCC_Array_tree_map *map,
+                                            void const *begin_key,
+                                            void const *end_key,
+                                            CCC_Array_tree_map *destination);
+
+/** @brief Copy the elements of source with keys not in destination into
+destination. O(M lg(N / M + 1)).
+@param[in] destination the map that receives the union.
+@param[in] source the map whose elements are copied.
+@return OK if the union succeeds or an argument error if the maps are NULL or
+not compatible. An allocation error is returned if the destination cannot make
+room for every element of the source.
+
+The destination keeps its own element when a key is in both maps. Room for all
+source elements is reserved before any are copied, even those with keys already
+in the destination.
+
+Unlike the tree map, the set operations of this map have no threaded versions.
+The rank parity bits of many slots share one word and every slot copied in or
+freed goes through the one free list of the map, so threads merging unrelated
+subtrees would still write the same memory. */
+CCC_Result CCC_array_tree_map_union(CCC_Array_tree_map *destination,
+                                    CCC_Array_tree_map const *source);
+
+/** @brief Keep only the elements of destination with keys also in source.
+O(M lg(N / M + 1)).
+@param[in] destination the map that keeps the intersection.
+@param[in] source the map of keys to keep.
+@param[in] destroy the destructor for every element removed from destination or
+NULL.
+@return OK if the intersection succeeds or an argument error if the maps are
+NULL or not compatible. */
+CCC_Result CCC_array_tree_map_intersection(CCC_Array_tree_map *destination,
+                                           CCC_Array_tree_map const *source,
+                                           CCC_Type_destructor *destroy);
+
+/** @brief Keep only the elements of destination with keys not in source.
+O(M lg(N / M + 1)).
+@param[in] destination the map that keeps the difference.
+@param[in] source the map of keys to remove.
+@param[in] destroy the destructor for every element removed from destination or
+NULL.
+@return OK if the difference succeeds or an argument error if the maps are NULL
+or not compatible. */
+CCC_Result CCC_array_tree_map_difference(CCC_Array_tree_map *destination,
+                                         CCC_Array_tree_map const *source,
+                                         CCC_Type_destructor *destroy);
+
+/**@}*/
+
 /** @name State Interface
 Obtain the container state. */
 /**@{*/
@@ -1193,6 +1451,8 @@ typedef CCC_Array_tree_map_handle Array_tree_map_handle;
         CCC_array_tree_map_fixed_capacity(args)
 #    define array_tree_map_copy(args...) CCC_array_tree_map_copy(args)
 #    define array_tree_map_reserve(args...) CCC_array_tree_map_reserve(args)
+#    define array_tree_map_from_sorted(args...)                                \
+        CCC_array_tree_map_from_sorted(args)
 #    define array_tree_map_at(args...) CCC_array_tree_map_at(args)
 #    define array_tree_map_as(args...) CCC_array_tree_map_as(args)
 #    define array_tree_map_and_modify_with(args...)                            \
@@ -1205,6 +1465,14 @@ typedef CCC_Array_tree_map_handle Array_tree_map_handle;
         CCC_array_tree_map_try_insert_with(args)
 #    define array_tree_map_insert_or_assign_with(args...)                      \
         CCC_array_tree_map_insert_or_assign_with(args)
+#    define array_tree_map_try_insert_hint(args...)                            \
+        CCC_array_tree_map_try_insert_hint(args)
+#    define array_tree_map_insert_or_assign_hint(args...)                      \
+        CCC_array_tree_map_insert_or_assign_hint(args)
+#    define array_tree_map_handle_hint(args...)                                \
+        CCC_array_tree_map_handle_hint(args)
+#    define array_tree_map_handle_hint_wrap(args...)                           \
+        CCC_array_tree_map_handle_hint_wrap(args)
 #    define array_tree_map_contains(args...) CCC_array_tree_map_contains(args)
 #    define array_tree_map_get_key_value(args...)                              \
         CCC_array_tree_map_get_key_value(args)
@@ -1221,6 +1489,21 @@ typedef CCC_Array_tree_map_handle Array_tree_map_handle;
 #    define array_tree_map_end(args...) CCC_array_tree_map_end(args)
 #    define array_tree_map_reverse_end(args...)                                \
         CCC_array_tree_map_reverse_end(args)
+#    define array_tree_map_enable_order_statistics(args...)                    \
+        CCC_array_tree_map_enable_order_statistics(args)
+#    define array_tree_map_rank(args...) CCC_array_tree_map_rank(args)
+#    define array_tree_map_select(args...) CCC_array_tree_map_select(args)
+#    define array_tree_map_count_range(args...)                                \
+        CCC_array_tree_map_count_range(args)
+#    define array_tree_map_join(args...) CCC_array_tree_map_join(args)
+#    define array_tree_map_split(args...) CCC_array_tree_map_split(args)
+#    define array_tree_map_extract_range(args...)                              \
+        CCC_array_tree_map_extract_range(args)
+#    define array_tree_map_union(args...) CCC_array_tree_map_union(args)
+#    define array_tree_map_intersection(args...)                               \
+        CCC_array_tree_map_intersection(args)
+#    define array_tree_map_difference(args...)                                 \
+        CCC_array_tree_map_difference(args)
 #    define array_tree_map_is_empty(args...) CCC_array_tree_map_is_empty(args)
 #    define array_tree_map_count(args...) CCC_array_tree_map_count(args)
 #    define array_tree_map_capacity(args...) CCC_array_tree_map_capacity(args)
@@ -0,0 +1,699 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The B+ Tree Map Interface
+
+A B+ tree map is an ordered map that stores copies of user types in wide
+leaves rather than one user type per tree node. Every binary tree map in this
+library follows one pointer per comparison, so a lookup among ten million keys
+costs over twenty dependent cache misses. A B+ tree node holds dozens of user
+types in a few contiguous cache lines so the same lookup visits four or five
+nodes.
+
+- Nodes are 512 bytes, eight cache lines, unless four user types do not fit in
+  that space. Then the node grows to the next power of two that fits them.
+- Each node is searched with a branchless binary search, so the only
+  unpredictable branches of a lookup are the calls to the comparison callback.
+- Leaves are linked in key order, so iteration and range scans walk through
+  contiguous user types and move between leaves without climbing the tree.
+- Branches store separator copies of user types. Only the key field of a
+  separator is read, and only through the comparison callback.
+
+The cost is that user types move within and between leaves as neighbors are
+inserted and removed. References returned by the map are invalidated by any
+insertion or removal, just as with a flat hash map. An allocation function is
+required to insert. Nodes are requested with an alignment equal to their size
+so that moving from a user type to the next in iteration is O(1). If the
+allocator ignores the request a node is placed within an allocation of twice
+its size instead, so iteration stays O(1) at the cost of memory.
+
+The Entry Interface has the same names and shapes as the tree map interface
+with a few intentional differences.
+
+- User types are copied in and out of the map rather than linked through an
+  intrusive node, so functions take the complete user type where the tree map
+  takes an intruder and no swap space is needed.
+- A reference or entry obtained from the map is invalidated by any later
+  insertion or removal, while a tree map reference lives until its user type
+  is removed.
+- Removal copies the old user type out and frees nothing the user owns, so an
+  entry of a removal never refers to memory in the map.
+- There are no hinted searches, because a search visits so few nodes that
+  starting from a neighbor saves little.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define BTREE_MAP_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_BTREE_MAP_H
+#define CCC_BTREE_MAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "private/private_btree_map.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief An ordered map with O(lg N) search, insert, and erase that stores
+user types in wide linked leaves.
+@warning it is undefined behavior to access an uninitialized container.
+
+A B+ tree map can be initialized on the stack, heap, or data segment at
+runtime or compile time. */
+typedef struct CCC_Btree_map CCC_Btree_map;
+
+/** @brief A container specific entry used to implement the Entry Interface.
+
+The Entry Interface offers efficient search and subsequent insertion, deletion,
+or value update based on the needs of the user. */
+typedef union CCC_Btree_map_entry_wrap CCC_Btree_map_entry;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the container with callbacks and permissions. */
+/**@{*/
+
+/** @brief Initializes the B+ tree map at runtime or compile time.
+@param[in] type_name the user type stored in the map.
+@param[in] type_key_field_name the name of the field in user type used as key.
+@param[in] compare the key comparison function (see types.h).
+@param[in] allocate the allocation function or NULL if allocation is banned.
+@param[in] context_data a pointer to any context data for comparison or
+allocation.
+@return the struct initialized B+ tree map for direct assignment
+(i.e. CCC_Btree_map m = CCC_btree_map_initialize(...);).
+
+```
+#define BTREE_MAP_USING_NAMESPACE_CCC
+struct Val
+{
+    int key;
+    int val;
+};
+Btree_map map
+    = btree_map_initialize(struct Val, key, val_order, std_allocate, NULL);
+```
+
+No memory is allocated until the first insertion. A map without an allocation
+function can be searched but every insertion reports an insert error. */
+#define CCC_btree_map_initialize(type_name, type_key_field_name, compare,      \
+                                 allocate, context_data)                       \
+    CCC_private_btree_map_initialize(type_name, type_key_field_name, compare,  \
+                                     allocate, context_data)
+
+/**@}*/
+
+/** @name Membership Interface
+Test membership or obtain references to stored user types directly. */
+/**@{*/
+
+/** @brief Searches the map for the presence of key.
+@param[in] map the map to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if the struct containing key is stored, false if not. Error if map
+or key is NULL. O(lg N). */
+[[nodiscard]] CCC_Tribool CCC_btree_map_contains(CCC_Btree_map const *map,
+                                                 void const *key);
+
+/** @brief Returns a reference into the map at entry key.
+@param[in] map the ordered map to search.
+@param[in] key the key to search matching stored key type.
+@return a view of the map entry if it is present, else NULL. O(lg N). */
+[[nodiscard]] void *CCC_btree_map_get_key_value(CCC_Btree_map const *map,
+                                                void const *key);
+
+/** @brief Returns a mutable reference into the map at entry key.
+@param[in] map the ordered map to search.
+@param[in] key the key to search matching stored key type.
+@return a reference to the stored user type if it is present, else NULL.
+O(lg N).
+@warning the key of the user type must not be modified.
+
+The reference is invalidated by any insertion or removal. */
+[[nodiscard]] void *CCC_btree_map_get_mut(CCC_Btree_map *map, void const *key);
+
+/**@}*/
+
+/** @name Entry Interface
+Obtain and operate on container entries for efficient queries when non-trivial
+control flow is needed. */
+/**@{*/
+
+/** @brief Invariantly inserts the key value wrapping type_output.
+@param[in] map the pointer to the map.
+@param[in,out] type_output the complete user type to insert.
+@return an entry. If Vacant, no prior element with key existed and the entry
+may be unwrapped to view the new insertion in the map. If Occupied the old
+value is written to type_output and the entry wraps type_output. If more space
+is needed but allocation fails or has been forbidden, an insert error is set.
+
+Note that this function may write to the struct provided as the second
+parameter and wraps it in an entry to provide information about the old value.
+*/
+[[nodiscard]] CCC_Entry CCC_btree_map_swap_entry(CCC_Btree_map *map,
+                                                 void *type_output);
+
+/** @brief Invariantly inserts the key value wrapping type_output.
+@param[in] map_pointer the pointer to the map.
+@param[in,out] type_output_pointer the complete user type to insert.
+@return a compound literal reference to the entry of the existing or newly
+inserted value. */
+#define CCC_btree_map_swap_entry_wrap(map_pointer, type_output_pointer)        \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_btree_map_swap_entry((map_pointer), (type_output_pointer)).private \
+    }
+
+/** @brief Attempts to insert the key value in type.
+@param[in] map the pointer to the map.
+@param[in] type the complete user type to insert.
+@return an entry. If Occupied, the entry contains a reference to the key value
+user type in the map and may be unwrapped. If Vacant the entry contains a
+reference to the newly inserted entry in the map. If more space is needed but
+allocation fails or has been forbidden, an insert error is set. */
+[[nodiscard]] CCC_Entry CCC_btree_map_try_insert(CCC_Btree_map *map,
+                                                 void const *type);
+
+/** @brief Attempts to insert the key value in type.
+@param[in] map_pointer the pointer to the map.
+@param[in] type_pointer the complete user type to insert.
+@return a compound literal reference to the entry of the existing or newly
+inserted value. */
+#define CCC_btree_map_try_insert_wrap(map_pointer, type_pointer)               \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_btree_map_try_insert((map_pointer), (type_pointer)).private        \
+    }
+
+/** @brief lazily insert type_compound_literal into the map at key if key is
+absent.
+@param[in] map_pointer a pointer to the map.
+@param[in] key the direct key r-value.
+@param[in] type_compound_literal the compound literal specifying the value.
+@return a compound literal reference to the entry of the existing or newly
+inserted value. Occupied indicates the key existed, Vacant indicates the key
+was absent. Unwrapping in any case provides the current value unless an error
+occurs that prevents insertion. An insertion error will flag such a case.
+
+Note that for brevity and convenience the user need not write the key to the
+lazy value compound literal as well. This function ensures the key in the
+compound literal matches the searched key. */
+#define CCC_btree_map_try_insert_with(map_pointer, key,                        \
+                                      type_compound_literal...)                \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_private_btree_map_try_insert_with(map_pointer, key,                \
+                                              type_compound_literal)           \
+    }
+
+/** @brief Invariantly inserts or overwrites a user struct into the map.
+@param[in] map a pointer to the map.
+@param[in] type the complete user type to insert.
+@return an entry. If Occupied an entry was overwritten by the new key value.
+If Vacant no prior map entry existed. Either way the entry wraps the user type
+stored in the map. If more space is needed but allocation fails or has been
+forbidden, an insert error is set. */
+[[nodiscard]] CCC_Entry CCC_btree_map_insert_or_assign(CCC_Btree_map *map,
+                                                       void const *type);
+
+/** @brief Invariantly inserts or overwrites a user struct into the map.
+@param[in] map_pointer a pointer to the map.
+@param[in] type_pointer the complete user type to insert.
+@return a compound literal reference to the entry of the stored value. */
+#define CCC_btree_map_insert_or_assign_wrap(map_pointer, type_pointer)         \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_btree_map_insert_or_assign((map_pointer), (type_pointer)).private  \
+    }
+
+/** @brief Inserts a new key value pair or overwrites the existing entry.
+@param[in] map_pointer the pointer to the map.
+@param[in] key the key to be searched in the map.
+@param[in] type_compound_literal the compound literal to insert or use for
+overwrite.
+@return a compound literal reference to the entry of the existing or newly
+inserted value. Occupied indicates the key existed, Vacant indicates the key
+was absent. Unwrapping in any case provides the current value unless an error
+occurs that prevents insertion. An insertion error will flag such a case.
+
+Note that for brevity and convenience the user need not write the key to the
+lazy value compound literal as well. This function ensures the key in the
+compound literal matches the searched key. */
+#define CCC_btree_map_insert_or_assign_with(map_pointer, key,                  \
+                                            type_compound_literal...)          \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_private_btree_map_insert_or_assign_with(map_pointer, key,          \
+                                                    type_compound_literal)     \
+    }
+
+/** @brief Removes the key value in the map storing the old value, if present,
+in the struct provided by the user.
+@param[in] map the pointer to the map.
+@param[in,out] type_output the user type with the search key written to it.
+@return the removed entry. If Occupied the removed user type was written to
+type_output which the entry wraps. If Vacant no user type had the key and the
+entry wraps NULL. If bad input is provided an input error is set. */
+[[nodiscard]] CCC_Entry CCC_btree_map_remove_key_value(CCC_Btree_map *map,
+                                                       void *type_output);
+
+/** @brief Removes the key value in the map storing the old value, if present,
+in the struct provided by the user.
+@param[in] map_pointer the pointer to the map.
+@param[in,out] type_output_pointer the user type with the search key written
+to it.
+@return a compound literal reference to the removed entry. */
+#define CCC_btree_map_remove_key_value_wrap(map_pointer, type_output_pointer)  \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_btree_map_remove_key_value((map_pointer), (type_output_pointer))   \
+            .private                                                           \
+    }
+
+/** @brief Obtains an entry for the provided key in the map for future use.
+@param[in] map the map to be searched.
+@param[in] key the key used to search the map matching the stored key type.
+@return a specialized entry for use with other functions in the Entry
+Interface.
+@warning the contents of an entry should not be examined or modified. Use the
+provided functions, only.
+
+An Occupied entry refers to the stored user type and a Vacant entry remembers
+the leaf and position where the key belongs, so acting on the entry needs no
+second search. An entry is invalidated by any other insertion or removal. */
+[[nodiscard]] CCC_Btree_map_entry CCC_btree_map_entry(CCC_Btree_map const *map,
+                                                      void const *key);
+
+/** @brief Obtains an entry for the provided key in the map for future use.
+@param[in] map_pointer the map to be searched.
+@param[in] key_pointer the key used to search the map matching the stored key
+type.
+@return a compound literal reference to a specialized entry for use with other
+functions in the Entry Interface. */
+#define CCC_btree_map_entry_wrap(map_pointer, key_pointer)                     \
+    &(CCC_Btree_map_entry)                                                     \
+    {                                                                          \
+        CCC_btree_map_entry((map_pointer), (key_pointer)).private              \
+    }
+
+/** @brief Modifies the provided entry if it is Occupied.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] modify an update function in which the context argument is unused.
+@return the updated entry if it was Occupied or the unmodified vacant entry.
+@warning the modifier must not change the key of the user type. */
+[[nodiscard]] CCC_Btree_map_entry *
+CCC_btree_map_and_modify(CCC_Btree_map_entry *entry, CCC_Type_modifier *modify);
+
+/** @brief Modifies the provided entry if it is Occupied.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] modify an update function that requires context data.
+@param[in] context context data required for the update.
+@return the updated entry if it was Occupied or the unmodified vacant entry.
+@warning the modifier must not change the key of the user type. */
+[[nodiscard]] CCC_Btree_map_entry *
+CCC_btree_map_and_modify_context(CCC_Btree_map_entry *entry,
+                                 CCC_Type_modifier *modify, void *context);
+
+/** @brief Modifies the provided entry if it is Occupied.
+@param[in] entry_pointer the entry obtained from an entry function or macro.
+@param[in] modify an update function in which the context argument is unused.
+@return a compound literal reference to the updated entry if it was Occupied
+or the unmodified vacant entry. If entry_pointer or modify is NULL the entry
+holds an argument error rather than being NULL, so it may still be passed to
+the rest of the Entry Interface.
+@warning the modifier must not change the key of the user type. */
+#define CCC_btree_map_and_modify_wrap(entry_pointer, modify)                   \
+    &(CCC_Btree_map_entry)                                                     \
+    {                                                                          \
+        CCC_private_btree_map_and_modify_wrap(entry_pointer, modify)           \
+    }
+
+/** @brief Modify an Occupied entry with a closure over user type T.
+@param[in] entry_pointer a pointer to the obtained entry.
+@param[in] type_name the name of the user type stored in the container.
+@param[in] closure_over_T the code to be run on the reference to user type T,
+if Occupied. This may be a semicolon separated list of statements to execute on
+T or a section of code wrapped in braces {code here} which may be preferred
+for formatting.
+@return a compound literal reference to the modified entry if it was occupied
+or a vacant entry if it was vacant.
+@note T is a reference to the user type stored in the entry guaranteed to be
+non-NULL if the closure executes.
+@warning the closure must not change the key of T.
+
+```
+#define BTREE_MAP_USING_NAMESPACE_CCC
+// Increment the count if found otherwise insert a default value.
+Word *w =
+    btree_map_or_insert_with(
+        btree_map_and_modify_with(
+            btree_map_entry_wrap(&map, &k),
+            Word,
+            { T->cnt++; }
+        ),
+        (Word){.key = k, .cnt = 1}
+    );
+```
+
+Note that any code written is only evaluated if the entry is Occupied and the
+container can deliver the user type T. */
+#define CCC_btree_map_and_modify_with(entry_pointer, type_name,                \
+                                      closure_over_T...)                       \
+    &(CCC_Btree_map_entry)                                                     \
+    {                                                                          \
+        CCC_private_btree_map_and_modify_with(entry_pointer, type_name,        \
+                                              closure_over_T)                  \
+    }
+
+/** @brief Inserts the user type if the entry is Vacant.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] type the complete user type to insert if the entry is Vacant.
+@return a reference to the stored user type, whether it was already present or
+newly inserted. NULL is returned if a node could not be allocated.
+
+The key of type must match the key used to obtain the entry. */
+[[nodiscard]] void *CCC_btree_map_or_insert(CCC_Btree_map_entry const *entry,
+                                            void const *type);
+
+/** @brief Lazily insert the desired key value into the entry if it is Vacant.
+@param[in] entry_pointer a pointer to the obtained entry.
+@param[in] type_compound_literal the compound literal to copy into the map if
+the entry is Vacant.
+@return a reference to the unwrapped user type in the entry, either the
+unmodified reference if the entry was Occupied or the newly inserted element
+if the entry was Vacant. NULL is returned if a node could not be allocated.
+
+Note that if the compound literal uses any function calls to generate values
+or other data, such functions will not be called if the entry is Occupied. */
+#define CCC_btree_map_or_insert_with(entry_pointer, type_compound_literal...)  \
+    CCC_private_btree_map_or_insert_with(entry_pointer, type_compound_literal)
+
+/** @brief Writes the user type to the entry whether it is Occupied or Vacant.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] type the complete user type to write.
+@return a reference to the stored user type or NULL if a node could not be
+allocated.
+
+The key of type must match the key used to obtain the entry. */
+[[nodiscard]] void *
+CCC_btree_map_insert_entry(CCC_Btree_map_entry const *entry, void const *type);
+
+/** @brief Write the contents of the compound literal type_compound_literal to
+the entry whether it is Occupied or Vacant.
+@param[in] entry_pointer a pointer to the obtained entry.
+@param[in] type_compound_literal the compound literal to write.
+@return a reference to the newly inserted or overwritten user type. NULL is
+returned if a node could not be allocated. */
+#define CCC_btree_map_insert_entry_with(entry_pointer,                         \
+                                        type_compound_literal...)              \
+    CCC_private_btree_map_insert_entry_with(entry_pointer,                     \
+                                            type_compound_literal)
+
+/** @brief Removes the user type of an Occupied entry.
+@param[in] entry the entry obtained from an entry function or macro.
+@return an entry wrapping NULL. Occupied if a user type was removed, Vacant if
+the entry was Vacant. An argument error is set if entry is NULL. */
+CCC_Entry CCC_btree_map_remove_entry(CCC_Btree_map_entry const *entry);
+
+/** @brief Removes the user type of an Occupied entry.
+@param[in] entry_pointer the entry obtained from an entry function or macro.
+@return a compound literal reference to an entry wrapping NULL. Occupied if a
+user type was removed, Vacant if the entry was Vacant. */
+#define CCC_btree_map_remove_entry_wrap(entry_pointer)                         \
+    &(CCC_Entry)                                                               \
+    {                                                                          \
+        CCC_btree_map_remove_entry((entry_pointer)).private                    \
+    }
+
+/** @brief Unwraps the provided entry to obtain a view into the map element.
+@param[in] entry the entry from a query to the map via function or macro.
+@return a view of the user type if the entry is Occupied, or NULL. */
+[[nodiscard]] void *CCC_btree_map_unwrap(CCC_Btree_map_entry const *entry);
+
+/** @brief Unwraps the provided entry to obtain a mutable reference into the
+map element.
+@param[in] entry the entry from a query to the map via function or macro.
+@return a reference to the user type if the entry is Occupied, or NULL.
+@warning the key of the user type must not be modified. */
+[[nodiscard]] void *CCC_btree_map_unwrap_mut(CCC_Btree_map_entry *entry);
+
+/** @brief Returns the Occupied status of the entry.
+@param[in] entry the entry from a query to the map via function or macro.
+@return true if the entry is Occupied, false if not. Error if entry is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_btree_map_occupied(CCC_Btree_map_entry const *entry);
+
+/** @brief Provides the status of the entry should an insertion follow.
+@param[in] entry the entry from a query to the map via function or macro.
+@return true if an entry obtained from an insertion attempt failed to insert
+due to an allocation failure when allocation success was expected. Error if
+entry is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_btree_map_insert_error(CCC_Btree_map_entry const *entry);
+
+/** @brief Obtain the entry status from a container entry.
+@param[in] entry a pointer to the entry.
+@return the status stored in the entry after the required action on the
+container completes. If entry is NULL an entry argument error is returned.
+
+See CCC_entry_status_message() in ccc/types.h for more information on detailed
+entry statuses. */
+[[nodiscard]] CCC_Entry_status
+CCC_btree_map_entry_status(CCC_Btree_map_entry const *entry);
+
+/**@}*/
+
+/** @name Iterator Interface
+Obtain and manage iterators over the container in key order. */
+/**@{*/
+
+/** @brief Return an iterable range of values from [begin_key, end_key).
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] begin_key a pointer to the key intended as the start of the range.
+@param[in] end_key a pointer to the key intended as the end of the range.
+@return a range containing the first element NOT LESS than the begin_key and
+the first element GREATER than end_key.
+
+A range scan is a search for each bound followed by a walk through contiguous
+user types in linked leaves.
+
+for (struct Val *i = range_begin(&range);
+     i != range_end(&range);
+     i = next(&map, i))
+{} */
+[[nodiscard]] CCC_Range CCC_btree_map_equal_range(CCC_Btree_map const *map,
+                                                  void const *begin_key,
+                                                  void const *end_key);
+
+/** @brief Returns a compound literal reference to the desired range. O(lg N).
+@param[in] map_pointer a pointer to the map.
+@param[in] begin_and_end_key_pointers two pointers, the first to the start of
+the range the second to the end of the range.
+@return a compound literal reference to the produced range associated with the
+enclosing scope. This reference is always non-NULL. */
+#define CCC_btree_map_equal_range_wrap(map_pointer,                            \
+                                       begin_and_end_key_pointers...)          \
+    &(CCC_Range)                                                               \
+    {                                                                          \
+        CCC_btree_map_equal_range((map_pointer), begin_and_end_key_pointers)   \
+            .private                                                           \
+    }
+
+/** @brief Return an iterable range_reverse of values from [reverse_begin_key,
+reverse_end_key) in descending order. O(lg N).
+@param[in] map a pointer to the map.
+@param[in] reverse_begin_key a pointer to the key intended as the start of the
+range_reverse.
+@param[in] reverse_end_key a pointer to the key intended as the end of the
+range_reverse.
+@return a range_reverse containing the first element NOT GREATER than the
+reverse_begin_key and the first element LESS than reverse_end_key. */
+[[nodiscard]] CCC_Range_reverse
+CCC_btree_map_equal_range_reverse(CCC_Btree_map const *map,
+                                  void const *reverse_begin_key,
+                                  void const *reverse_end_key);
+
+/** @brief Returns a compound literal reference to the desired range_reverse.
+O(lg N).
+@param[in] map_pointer a pointer to the map.
+@param[in] reverse_begin_and_reverse_end_key_pointers two pointers, the first
+to the start of the range_reverse the second to the end of the range_reverse.
+@return a compound literal reference to the produced range_reverse associated
+with the enclosing scope. This reference is always non-NULL. */
+#define CCC_btree_map_equal_range_reverse_wrap(                                \
+    map_pointer, reverse_begin_and_reverse_end_key_pointers...)                \
+    &(CCC_Range_reverse)                                                       \
+    {                                                                          \
+        CCC_btree_map_equal_range_reverse(                                     \
+            (map_pointer), reverse_begin_and_reverse_end_key_pointers)         \
+            .private                                                           \
+    }
+
+/** @brief Return the start of an inorder traversal of the map. O(1).
+@param[in] map a pointer to the map.
+@return the smallest element or the end if the map is empty. */
+[[nodiscard]] void *CCC_btree_map_begin(CCC_Btree_map const *map);
+
+/** @brief Return the start of a reverse inorder traversal of the map. O(1).
+@param[in] map a pointer to the map.
+@return the largest element or the reverse end if the map is empty. */
+[[nodiscard]] void *CCC_btree_map_reverse_begin(CCC_Btree_map const *map);
+
+/** @brief Return the next element in an inorder traversal of the map.
+@param[in] map a pointer to the map.
+@param[in] type_iterator a pointer to the current user type in the map.
+@return the next user type in key order or the end. O(1). */
+[[nodiscard]] void *CCC_btree_map_next(CCC_Btree_map const *map,
+                                       void const *type_iterator);
+
+/** @brief Return the next element in a reverse inorder traversal of the map.
+@param[in] map a pointer to the map.
+@param[in] type_iterator a pointer to the current user type in the map.
+@return the previous user type in key order or the reverse end. O(1). */
+[[nodiscard]] void *CCC_btree_map_reverse_next(CCC_Btree_map const *map,
+                                               void const *type_iterator);
+
+/** @brief Return the end of an inorder traversal of the map. O(1).
+@param[in] map a pointer to the map.
+@return the end of the traversal, NULL. */
+[[nodiscard]] void *CCC_btree_map_end(CCC_Btree_map const *map);
+
+/** @brief Return the reverse end of a reverse inorder traversal of the map.
+O(1).
+@param[in] map a pointer to the map.
+@return the end of the reverse traversal, NULL. */
+[[nodiscard]] void *CCC_btree_map_reverse_end(CCC_Btree_map const *map);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Deallocate the container. */
+/**@{*/
+
+/** @brief Frees every node of the map, calling destroy on each user type.
+@param[in] map the map to clear.
+@param[in] destroy the optional destructor for each user type.
+@return OK or an argument error if map is NULL. The map remains initialized
+and may be used again. O(N). */
+CCC_Result CCC_btree_map_clear(CCC_Btree_map *map,
+                               CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the container state. */
+/**@{*/
+
+/** @brief Returns the count of map occupied nodes.
+@param[in] map the map.
+@return the size or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count CCC_btree_map_count(CCC_Btree_map const *map);
+
+/** @brief Returns the size status of the map.
+@param[in] map the map.
+@return true if empty else false. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool CCC_btree_map_is_empty(CCC_Btree_map const *map);
+
+/** @brief Validates the invariants of the map.
+@param[in] map the map to validate.
+@return true if every leaf is at the same depth, every node other than the
+root is at least half full, separators bound their subtrees, keys are strictly
+ascending across the linked leaves, and the count is correct. Error if map is
+NULL. O(N). */
+[[nodiscard]] CCC_Tribool CCC_btree_map_validate(CCC_Btree_map const *map);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are helpful. Ensure
+no namespace clashes occur before shortening. */
+#ifdef BTREE_MAP_USING_NAMESPACE_CCC
+typedef CCC_Btree_map Btree_map;
+typedef CCC_Btree_map_entry Btree_map_entry;
+#    define btree_map_initialize(args...) CCC_btree_map_initialize(args)
+#    define btree_map_contains(args...) CCC_btree_map_contains(args)
+#    define btree_map_get_key_value(args...) CCC_btree_map_get_key_value(args)
+#    define btree_map_get_mut(args...) CCC_btree_map_get_mut(args)
+#    define btree_map_swap_entry(args...) CCC_btree_map_swap_entry(args)
+#    define btree_map_swap_entry_wrap(args...)                                 \
+        CCC_btree_map_swap_entry_wrap(args)
+#    define btree_map_try_insert(args...) CCC_btree_map_try_insert(args)
+#    define btree_map_try_insert_wrap(args...)                                 \
+        CCC_btree_map_try_insert_wrap(args)
+#    define btree_map_try_insert_with(args...)                                 \
+        CCC_btree_map_try_insert_with(args)
+#    define btree_map_insert_or_assign(args...)                                \
+        CCC_btree_map_insert_or_assign(args)
+#    define btree_map_insert_or_assign_wrap(args...)                           \
+        CCC_btree_map_insert_or_assign_wrap(args)
+#    define btree_map_insert_or_assign_with(args...)                           \
+        CCC_btree_map_insert_or_assign_with(args)
+#    define btree_map_remove_key_value(args...)                                \
+        CCC_btree_map_remove_key_value(args)
+#    define btree_map_remove_key_value_wrap(args...)                           \
+        CCC_btree_map_remove_key_value_wrap(args)
+#    define btree_map_entry(args...) CCC_btree_map_entry(args)
+#    define btree_map_entry_wrap(args...) CCC_btree_map_entry_wrap(args)
+#    define btree_map_and_modify(args...) CCC_btree_map_and_modify(args)
+#    define btree_map_and_modify_context(args...)                              \
+        CCC_btree_map_and_modify_context(args)
+#    define btree_map_and_modify_wrap(args...)                                 \
+        CCC_btree_map_and_modify_wrap(args)
+#    define btree_map_and_modify_with(args...)                                 \
+        CCC_btree_map_and_modify_with(args)
+#    define btree_map_or_insert(args...) CCC_btree_map_or_insert(args)
+#    define btree_map_or_insert_with(args...) CCC_btree_map_or_insert_with(args)
+#    define btree_map_insert_entry(args...) CCC_btree_map_insert_entry(args)
+#    define btree_map_insert_entry_with(args...)                               \
+        CCC_btree_map_insert_entry_with(args)
+#    define btree_map_remove_entry(args...) CCC_btree_map_remove_entry(args)
+#    define btree_map_remove_entry_wrap(args...)                               \
+        CCC_btree_map_remove_entry_wrap(args)
+#    define btree_map_unwrap(args...) CCC_btree_map_unwrap(args)
+#    define btree_map_unwrap_mut(args...) CCC_btree_map_unwrap_mut(args)
+#    define btree_map_occupied(args...) CCC_btree_map_occupied(args)
+#    define btree_map_insert_error(args...) CCC_btree_map_insert_error(args)
+#    define btree_map_entry_status(args...) CCC_btree_map_entry_status(args)
+#    define btree_map_equal_range(args...) CCC_btree_map_equal_range(args)
+#    define btree_map_equal_range_wrap(args...)                                \
+        CCC_btree_map_equal_range_wrap(args)
+#    define btree_map_equal_range_reverse(args...)                             \
+        CCC_btree_map_equal_range_reverse(args)
+#    define btree_map_equal_range_reverse_wrap(args...)                        \
+        CCC_btree_map_equal_range_reverse_wrap(args)
+#    define btree_map_begin(args...) CCC_btree_map_begin(args)
+#    define btree_map_reverse_begin(args...) CCC_btree_map_reverse_begin(args)
+#    define btree_map_next(args...) CCC_btree_map_next(args)
+#    define btree_map_reverse_next(args...) CCC_btree_map_reverse_next(args)
+#    define btree_map_end(args...) CCC_btree_map_end(args)
+#    define btree_map_reverse_end(args...) CCC_btree_map_reverse_end(args)
+#    define btree_map_clear(args...) CCC_btree_map_clear(args)
+#    define btree_map_count(args...) CCC_btree_map_count(args)
+#    define btree_map_is_empty(args...) CCC_btree_map_is_empty(args)
+#    define btree_map_validate(args...) CCC_btree_map_validate(args)
+#endif /* BTREE_MAP_USING_NAMESPACE_CCC */
+
+#endif /* CCC_BTREE_MAP_H */
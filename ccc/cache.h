@@ -0,0 +1,392 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Cache Interface
+
+A Cache holds at most a fixed number of user types and evicts one of them to
+make room when a new key is inserted into a full cache. The user types are kept
+in an array of capacity records, a flat hash map of record positions finds
+them, and the recency state of each record is kept in a parallel array of
+nodes linked by 32 bit positions. The eviction policy is chosen at
+initialization.
+
+- LRU evicts the entry accessed least recently. A hit moves its node to the
+  front of one list.
+- CLOCK sweeps a hand over the records and evicts the first one whose reference
+  bit is clear, clearing bits as it passes. A hit only sets a bit.
+- S3-FIFO admits new keys to a small FIFO queue holding about a tenth of the
+  cache. Entries accessed while in the small queue move to a main FIFO queue
+  and the rest are evicted early, which keeps one time keys from flushing the
+  working set. Hashes of keys evicted from the small queue are remembered in a
+  ghost table so that a key which returns soon after is admitted to the main
+  queue directly. A hit only increments a small counter.
+
+Beyond the user type itself an entry costs a 12 byte node, two index slots of
+5 bytes each, and for S3-FIFO one 8 byte ghost hash. A hit hashes the key once,
+probes the index, and updates the node of the record it finds. No hit moves a
+record, and insertions into a full cache reuse the position of the evicted
+record, so a cache never allocates after initialization.
+
+A cache may be given an allocation function, in which case its arrays are
+allocated once at initialization, or it may be declared as a fixed size type
+with CCC_cache_declare_fixed and need no allocation at all. Only a fixed type
+declared with CCC_cache_declare_fixed_s3_fifo holds the ghost table, so the
+LRU and CLOCK policies do not pay for it.
+
+A cache keeps a reference to itself for hashing and comparison and must not
+be copied or moved by value after initialization.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define CACHE_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_CACHE_H
+#define CCC_CACHE_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "private/private_cache.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A fixed capacity cache indexed by a flat hash map.
+
+The cache must be initialized at runtime with CCC_cache_initialize or
+CCC_cache_initialize_fixed before use. It must not be copied by value after
+initialization. */
+typedef struct CCC_Cache CCC_Cache;
+
+/** @brief The eviction policy of a cache.
+
+- `CCC_CACHE_POLICY_LRU` evicts the least recently accessed entry.
+- `CCC_CACHE_POLICY_CLOCK` approximates LRU with one reference bit per entry.
+- `CCC_CACHE_POLICY_S3_FIFO` uses small, main, and ghost FIFO queues. */
+typedef enum CCC_Cache_policy CCC_Cache_policy;
+
+/** @brief The arguments given to a loader by CCC_cache_get_or_load. */
+typedef struct
+{
+    /** The key that missed in the cache. */
+    void const *key;
+    /** The user type to fill, including its key field, if the load succeeds. */
+    void *type_output;
+    /** The context passed to CCC_cache_get_or_load. */
+    void *context;
+} CCC_Cache_load_context;
+
+/** @brief A callback that produces the user type for a key that missed.
+
+Return true if the output was filled and should be inserted or false if no
+value exists for the key or it could not be loaded. */
+typedef bool CCC_Cache_loader(CCC_Cache_load_context);
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the cache at runtime. */
+/**@{*/
+
+/** @brief Declare a fixed size cache type that needs no allocation. Does not
+return a value.
+@param[in] fixed_cache_type_name the user chosen name of the fixed cache type.
+@param[in] type_name the type the user plans to store in the cache.
+@param[in] capacity the power of two number of records the cache may hold.
+
+The type holds the records, their nodes, and an index table with twice
+capacity slots. The capacity must be a power of two so that the index table is
+one as well, and twice the capacity must be at least
+CCC_FLAT_HASH_MAP_GROUP_COUNT. The type has no ghost table and may only be
+initialized with the LRU or CLOCK policy. Use CCC_cache_declare_fixed_s3_fifo
+for S3-FIFO.
+
+```
+#define CACHE_USING_NAMESPACE_CCC
+struct Page
+{
+    int id;
+    char bytes[64];
+};
+cache_declare_fixed(Page_cache, struct Page, 256);
+``` */
+#define CCC_cache_declare_fixed(fixed_cache_type_name, type_name, capacity)    \
+    CCC_private_cache_declare_fixed(fixed_cache_type_name, type_name, capacity)
+
+/** @brief Declare a fixed size cache type that may use any policy, including
+S3-FIFO. Does not return a value.
+@param[in] fixed_cache_type_name the user chosen name of the fixed cache type.
+@param[in] type_name the type the user plans to store in the cache.
+@param[in] capacity the power of two number of records the cache may hold.
+
+The type holds everything CCC_cache_declare_fixed does plus a ghost table of
+one 8 byte hash per record, which only the S3-FIFO policy uses.
+
+```
+#define CACHE_USING_NAMESPACE_CCC
+cache_declare_fixed_s3_fifo(Page_cache, struct Page, 256);
+``` */
+#define CCC_cache_declare_fixed_s3_fifo(fixed_cache_type_name, type_name,      \
+                                        capacity)                              \
+    CCC_private_cache_declare_fixed_s3_fifo(fixed_cache_type_name, type_name,  \
+                                            capacity)
+
+/** @brief Obtain the capacity previously chosen for a fixed cache type.
+@param[in] fixed_cache_type_name the name of a previously declared cache.
+@return the size_t number of records the cache may hold. */
+#define CCC_cache_fixed_capacity(fixed_cache_type_name)                        \
+    CCC_private_cache_fixed_capacity(fixed_cache_type_name)
+
+/** @brief Initialize a cache that allocates its arrays once at runtime.
+@param[in] cache_pointer a pointer to the uninitialized cache.
+@param[in] type_name the user type stored in the cache.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] policy the CCC_Cache_policy used to choose victims.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] capacity the number of records the cache may hold.
+@return the result of initialization. An argument error is returned if the
+cache, hash, compare, or allocation function is NULL, the policy is unknown,
+or the capacity is 0 or does not fit in 32 bits. An allocator error is
+returned if the arrays cannot be allocated.
+
+```
+#define CACHE_USING_NAMESPACE_CCC
+Cache cache;
+CCC_Result const r = cache_initialize(
+    &cache,
+    struct Page,
+    id,
+    page_hash,
+    page_order,
+    CCC_CACHE_POLICY_S3_FIFO,
+    std_allocate,
+    NULL,
+    1000
+);
+```
+
+The cache must be freed with CCC_cache_clear_and_free. */
+#define CCC_cache_initialize(cache_pointer, type_name, key_field, hash,        \
+                             compare, policy, allocate, context_data,          \
+                             capacity)                                         \
+    CCC_private_cache_initialize((cache_pointer), sizeof(type_name),           \
+                                 offsetof(type_name, key_field), (hash),       \
+                                 (compare), (policy), (allocate),              \
+                                 (context_data), (capacity), NULL, 0, 0, 0,    \
+                                 0)
+
+/** @brief Initialize a cache over a fixed cache type with no allocation.
+@param[in] cache_pointer a pointer to the uninitialized cache.
+@param[in] fixed_pointer a pointer to a type declared by
+CCC_cache_declare_fixed or CCC_cache_declare_fixed_s3_fifo. It is evaluated
+once and may be a compound literal.
+@param[in] type_name the user type stored in the cache.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] policy the CCC_Cache_policy used to choose victims.
+@param[in] context_data context data for hashing and comparison.
+@return the result of initialization. An argument error is returned if the
+cache, storage, hash, or compare function is NULL, the policy is unknown, or
+the policy is S3-FIFO and the type was not declared with
+CCC_cache_declare_fixed_s3_fifo.
+
+```
+#define CACHE_USING_NAMESPACE_CCC
+cache_declare_fixed(Page_cache, struct Page, 256);
+static Cache cache;
+CCC_Result const r = cache_initialize_fixed(
+    &cache,
+    &(static Page_cache){},
+    struct Page,
+    id,
+    page_hash,
+    page_order,
+    CCC_CACHE_POLICY_CLOCK,
+    NULL
+);
+``` */
+#define CCC_cache_initialize_fixed(cache_pointer, fixed_pointer, type_name,    \
+                                   key_field, hash, compare, policy,           \
+                                   context_data)                               \
+    CCC_private_cache_initialize_fixed(cache_pointer, fixed_pointer,           \
+                                       type_name, key_field, hash, compare,    \
+                                       policy, context_data)
+
+/**@}*/
+
+/** @name Membership Interface
+Test membership or obtain references to stored user types directly. */
+/**@{*/
+
+/** @brief Searches the cache for the presence of key without counting an
+access.
+@param[in] cache the cache to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if the key is cached, false if absent, or an error if cache or
+key is NULL. The eviction order is not changed. */
+[[nodiscard]] CCC_Tribool CCC_cache_contains(CCC_Cache const *cache,
+                                             void const *key);
+
+/** @brief Returns a reference to the cached user type and counts an access.
+@param[in] cache the cache to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return a reference to the cached user type or NULL if it is absent.
+
+The reference remains valid until the next insertion or removal, either of
+which may evict or move the record. The access updates the recency of the
+entry according to the policy of the cache. */
+[[nodiscard]] void *CCC_cache_get_key_value(CCC_Cache *cache, void const *key);
+
+/** @brief Searches for each key, loading and inserting those that miss, and
+copies every result out of the cache.
+@param[in] cache the cache to be searched.
+@param[in] keys an array of count pointers to keys.
+@param[in] count the number of keys.
+@param[out] type_outputs an array of count user types to receive the results.
+@param[in] load the CCC_Cache_loader called for each key that misses.
+@param[in] context the context passed to the loader.
+@return the number of keys served in order. If the loader fails for a key the
+count is the index of that key and the error is CCC_RESULT_FAIL. An argument
+error is returned if any argument is NULL.
+
+Keys are hashed in chunks and the index slots their probes will visit are
+prefetched before any of them is searched, so the cache misses of independent
+lookups overlap. Hits count as accesses just as with CCC_cache_get_key_value.
+A key that misses is loaded directly into its output, which is then inserted,
+possibly evicting another entry. Results are copied out so that no reference
+can be invalidated by an eviction later in the same batch. A key repeated in
+the batch is served from the cache after its first load unless a miss between
+the two occurrences evicted it, in which case it is loaded again. */
+CCC_Count CCC_cache_get_or_load(CCC_Cache *cache, void const *const keys[],
+                                size_t count, void *type_outputs,
+                                CCC_Cache_loader *load, void *context);
+
+/**@}*/
+
+/** @name Insert and Remove Interface
+Add or remove elements from the cache. */
+/**@{*/
+
+/** @brief Inserts type or overwrites the cached type with the same key.
+@param[in] cache the cache in which to insert.
+@param[in] type the user type to copy into the cache.
+@return an Occupied entry if the key was cached and has been overwritten, or
+a Vacant entry if the type was newly inserted. Either way the entry refers to
+the cached type. An argument error is set if cache or type is NULL.
+
+Overwriting counts as an access. Inserting into a full cache first evicts the
+victim chosen by the policy and reuses its record. */
+[[nodiscard]] CCC_Entry CCC_cache_insert_or_assign(CCC_Cache *cache,
+                                                   void const *type);
+
+/** @brief Removes the entry with the key in type_output, writing the removed
+type to type_output.
+@param[in] cache the cache from which to remove.
+@param[in] type_output a user type with the key field set.
+@return an Occupied entry referring to type_output if the key was removed or
+a Vacant entry if it was absent. An argument error is set if cache or
+type_output is NULL. */
+[[nodiscard]] CCC_Entry CCC_cache_remove_key_value(CCC_Cache *cache,
+                                                   void *type_output);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the cache state. */
+/**@{*/
+
+/** @brief Returns the number of entries in the cache.
+@param[in] cache the cache.
+@return the count or an argument error if cache is NULL. */
+[[nodiscard]] CCC_Count CCC_cache_count(CCC_Cache const *cache);
+
+/** @brief Returns the number of entries the cache may hold.
+@param[in] cache the cache.
+@return the capacity or an argument error if cache is NULL. */
+[[nodiscard]] CCC_Count CCC_cache_capacity(CCC_Cache const *cache);
+
+/** @brief Returns true if the cache is empty.
+@param[in] cache the cache.
+@return true if empty, false if not, or an error if cache is NULL. */
+[[nodiscard]] CCC_Tribool CCC_cache_is_empty(CCC_Cache const *cache);
+
+/** @brief Validates the index table, the queues, and every record position.
+@param[in] cache the cache to validate.
+@return true if all invariants hold, false if not, or an error if cache is
+NULL. */
+[[nodiscard]] CCC_Tribool CCC_cache_validate(CCC_Cache const *cache);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Destroy the container. */
+/**@{*/
+
+/** @brief Removes every entry, keeping the arrays of the cache.
+@param[in] cache the cache to clear.
+@param[in] destroy the destructor for each record or NULL.
+@return OK or an argument error if cache is NULL. The ghost table of an
+S3-FIFO cache is cleared as well. */
+CCC_Result CCC_cache_clear(CCC_Cache *cache, CCC_Type_destructor *destroy);
+
+/** @brief Removes every entry and frees the arrays of the cache.
+@param[in] cache the cache to free.
+@param[in] destroy the destructor for each record or NULL.
+@return OK, an argument error if cache is NULL, or a no allocation function
+error for a fixed cache, which is cleared but owns no memory to free. */
+CCC_Result CCC_cache_clear_and_free(CCC_Cache *cache,
+                                    CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are desired for the
+cache container. Check for collisions with names in your namespace. */
+#ifdef CACHE_USING_NAMESPACE_CCC
+typedef CCC_Cache Cache;
+typedef CCC_Cache_policy Cache_policy;
+typedef CCC_Cache_load_context Cache_load_context;
+typedef CCC_Cache_loader Cache_loader;
+#    define cache_declare_fixed(args...) CCC_cache_declare_fixed(args)
+#    define cache_declare_fixed_s3_fifo(args...)                               \
+        CCC_cache_declare_fixed_s3_fifo(args)
+#    define cache_fixed_capacity(args...) CCC_cache_fixed_capacity(args)
+#    define cache_initialize(args...) CCC_cache_initialize(args)
+#    define cache_initialize_fixed(args...) CCC_cache_initialize_fixed(args)
+#    define cache_contains(args...) CCC_cache_contains(args)
+#    define cache_get_key_value(args...) CCC_cache_get_key_value(args)
+#    define cache_get_or_load(args...) CCC_cache_get_or_load(args)
+#    define cache_insert_or_assign(args...) CCC_cache_insert_or_assign(args)
+#    define cache_remove_key_value(args...) CCC_cache_remove_key_value(args)
+#    define cache_count(args...) CCC_cache_count(args)
+#    define cache_capacity(args...) CCC_cache_capacity(args)
+#    define cache_is_empty(args...) CCC_cache_is_empty(args)
+#    define cache_validate(args...) CCC_cache_validate(args)
+#    define cache_clear(args...) CCC_cache_clear(args)
+#    define cache_clear_and_free(args...) CCC_cache_clear_and_free(args)
+#endif /* CACHE_USING_NAMESPACE_CCC */
+
+#endif /* CCC_CACHE_H */
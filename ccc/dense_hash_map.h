@@ -0,0 +1,404 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Dense Hash Map Interface
+
+A Dense Hash Map is a hash index over a dense array of records. The user types
+are stored contiguously with no gaps, as in a Buffer, while the probing table
+holds only the position of each record and its full hash. This suits large
+records of hundreds of bytes where a flat hash map would be a poor fit.
+
+- Growing the probing table moves 16 bytes per element rather than the whole
+  record, and growing the record array is one reallocation with no rehashing.
+- Empty slots of the probing table cost 17 bytes rather than the size of a
+  record, so the load factor of the table no longer multiplies record memory.
+- Iteration walks the dense record array front to back.
+- The stored hash filters nearly every mismatch so a lookup usually touches
+  only the record it is looking for.
+
+The cost is one indirection from the probing table to the record and 8 bytes
+per record for its hash. Records keep their positions until a removal, which
+moves the last record into the hole it leaves. Insertions that grow the record
+array move every record, so references are invalidated by insertions and
+removals just as with a flat hash map.
+
+The map keeps a reference to itself for hashing and comparison and must not be
+copied or moved by value after initialization. An allocation function is
+required.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define DENSE_HASH_MAP_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_DENSE_HASH_MAP_H
+#define CCC_DENSE_HASH_MAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "private/private_dense_hash_map.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A hash map storing user types in a dense array behind a hash index.
+
+The map must be initialized at runtime with CCC_dense_hash_map_initialize
+before use and destroyed with CCC_dense_hash_map_clear_and_free. It must not be
+copied by value after initialization. */
+typedef struct CCC_Dense_hash_map CCC_Dense_hash_map;
+
+/** @brief A container specific entry used to implement the Entry Interface.
+
+The Entry Interface offers efficient search and subsequent insertion, deletion,
+or value update based on the needs of the user. */
+typedef union CCC_Dense_hash_map_entry_wrap CCC_Dense_hash_map_entry;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the map at runtime. */
+/**@{*/
+
+/** @brief Initialize a dense hash map at runtime.
+@param[in] map_pointer a pointer to the uninitialized map.
+@param[in] type_name the user type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] capacity the number of records to reserve room for, or 0.
+@return the result of initialization. An argument error is returned if the
+map, hash, compare, or allocation function is NULL. An allocator error is
+returned if the requested capacity cannot be reserved.
+
+```
+#define DENSE_HASH_MAP_USING_NAMESPACE_CCC
+struct Record
+{
+    int id;
+    char payload[256];
+};
+Dense_hash_map map;
+CCC_Result const r = dense_hash_map_initialize(
+    &map,
+    struct Record,
+    id,
+    record_hash,
+    record_order,
+    std_allocate,
+    NULL,
+    0
+);
+```
+*/
+#define CCC_dense_hash_map_initialize(map_pointer, type_name, key_field, hash, \
+                                      compare, allocate, context_data,         \
+                                      capacity)                                \
+    CCC_private_dense_hash_map_initialize(                                     \
+        (map_pointer), sizeof(type_name), offsetof(type_name, key_field),      \
+        (hash), (compare), (allocate), (context_data), (capacity))
+
+/** @brief Reserves room for to_add more records without further allocation.
+@param[in] map the map to reserve.
+@param[in] to_add the number of records to add beyond the current count.
+@return OK if the record array and index table can hold to_add more records,
+an argument error if map is NULL, or an allocator error.
+
+Reserving ahead avoids the reallocations that move every record. */
+CCC_Result CCC_dense_hash_map_reserve(CCC_Dense_hash_map *map, size_t to_add);
+
+/**@}*/
+
+/** @name Membership Interface
+Test membership or obtain references to stored user types directly. */
+/**@{*/
+
+/** @brief Searches the map for the presence of key.
+@param[in] map the map to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if the struct containing key is stored, false if not. Error if map
+or key is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_dense_hash_map_contains(CCC_Dense_hash_map const *map, void const *key);
+
+/** @brief Returns a reference to the record with key.
+@param[in] map the map to search.
+@param[in] key the key to search matching stored key type.
+@return a view of the record if it is present, else NULL. */
+[[nodiscard]] void *
+CCC_dense_hash_map_get_key_value(CCC_Dense_hash_map const *map,
+                                 void const *key);
+
+/**@}*/
+
+/** @name Entry Interface
+Obtain and operate on container entries for efficient queries when non-trivial
+control flow is needed. */
+/**@{*/
+
+/** @brief Obtains an entry for the provided key in the map for future use.
+@param[in] map the map to be searched.
+@param[in] key the key used to search the map matching the stored key type.
+@return a specialized entry for use with other functions in the Entry
+Interface.
+@warning the contents of an entry should not be examined or modified. Use the
+provided functions, only.
+
+The key is hashed once. An Occupied entry refers to the stored record and a
+Vacant entry remembers where the index of a new record belongs. */
+[[nodiscard]] CCC_Dense_hash_map_entry
+CCC_dense_hash_map_entry(CCC_Dense_hash_map *map, void const *key);
+
+/** @brief Obtains an entry for the provided key in the map for future use.
+@param[in] map_pointer the map to be searched.
+@param[in] key_pointer the key used to search the map matching the stored key
+type.
+@return a compound literal reference to a specialized entry for use with other
+functions in the Entry Interface. */
+#define CCC_dense_hash_map_entry_wrap(map_pointer, key_pointer)                \
+    &(CCC_Dense_hash_map_entry)                                                \
+    {                                                                          \
+        CCC_dense_hash_map_entry(map_pointer, key_pointer).private             \
+    }
+
+/** @brief Modifies the provided entry if it is Occupied.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] modify an update function in which the context argument is unused.
+@return the updated entry if it was Occupied or the unmodified vacant entry.
+@warning the modifier must not change the key of the record. */
+[[nodiscard]] CCC_Dense_hash_map_entry *
+CCC_dense_hash_map_and_modify(CCC_Dense_hash_map_entry *entry,
+                              CCC_Type_modifier *modify);
+
+/** @brief Modifies the provided entry if it is Occupied.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] modify an update function that requires context data.
+@param[in] context context data required for the update.
+@return the updated entry if it was Occupied or the unmodified vacant entry.
+@warning the modifier must not change the key of the record. */
+[[nodiscard]] CCC_Dense_hash_map_entry *
+CCC_dense_hash_map_and_modify_context(CCC_Dense_hash_map_entry *entry,
+                                      CCC_Type_modifier *modify, void *context);
+
+/** @brief Inserts the record if the entry is Vacant.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] type the complete record to insert if the entry is Vacant.
+@return a reference to the stored record, whether it was already present or
+newly inserted. NULL is returned if the entry has an insert error or the
+record array could not grow.
+
+The key of type must match the key used to obtain the entry. */
+[[nodiscard]] void *
+CCC_dense_hash_map_or_insert(CCC_Dense_hash_map_entry const *entry,
+                             void const *type);
+
+/** @brief Writes the record to the entry whether it is Occupied or Vacant.
+@param[in] entry the entry obtained from an entry function or macro.
+@param[in] type the complete record to write.
+@return a reference to the stored record or NULL if the entry has an insert
+error or the record array could not grow.
+
+The key of type must match the key used to obtain the entry. */
+[[nodiscard]] void *
+CCC_dense_hash_map_insert_entry(CCC_Dense_hash_map_entry const *entry,
+                                void const *type);
+
+/** @brief Removes the record of an Occupied entry.
+@param[in] entry the entry obtained from an entry function or macro.
+@return an entry wrapping NULL. Occupied if a record was removed, Vacant if the
+entry was Vacant. An argument error is set if entry is NULL.
+
+The last record of the array is moved into the position of the removed record
+so the array stays dense. */
+CCC_Entry
+CCC_dense_hash_map_remove_entry(CCC_Dense_hash_map_entry const *entry);
+
+/** @brief Unwraps the provided entry to obtain a view into the stored record.
+@param[in] entry the entry from a query to the map via function or macro.
+@return a view of the record if the entry is Occupied, or NULL. */
+[[nodiscard]] void *
+CCC_dense_hash_map_unwrap(CCC_Dense_hash_map_entry const *entry);
+
+/** @brief Returns the Occupied status of the entry.
+@param[in] entry the entry from a query to the map via function or macro.
+@return true if the entry is Occupied, false if not. Error if entry is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_dense_hash_map_occupied(CCC_Dense_hash_map_entry const *entry);
+
+/** @brief Provides the status of the entry should an insertion follow.
+@param[in] entry the entry from a query to the map via function or macro.
+@return true if the index table could not make room for an insertion, false
+if it could. Error if entry is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_dense_hash_map_insert_error(CCC_Dense_hash_map_entry const *entry);
+
+/** @brief Attempts to insert the record only if its key is absent.
+@param[in] map the map.
+@param[in] type the complete record to insert.
+@return an entry. If Occupied the entry wraps the record already stored. If
+Vacant the entry wraps the newly inserted record. An insert error is set if
+the map could not grow. */
+[[nodiscard]] CCC_Entry CCC_dense_hash_map_try_insert(CCC_Dense_hash_map *map,
+                                                      void const *type);
+
+/** @brief Invariantly inserts or overwrites the record.
+@param[in] map the map.
+@param[in] type the complete record to insert.
+@return an entry wrapping the stored record. Occupied if a record with the key
+was overwritten, Vacant if the key was absent. An insert error is set if the
+map could not grow. */
+[[nodiscard]] CCC_Entry
+CCC_dense_hash_map_insert_or_assign(CCC_Dense_hash_map *map, void const *type);
+
+/** @brief Removes the record with the key of type_output and copies it out.
+@param[in] map the map.
+@param[in,out] type_output the user type with the search key written to it.
+@return an entry. If Occupied the removed record was written to type_output
+which the entry wraps. If Vacant no record had the key and the entry wraps
+NULL.
+
+The last record of the array is moved into the position of the removed record
+so the array stays dense. */
+[[nodiscard]] CCC_Entry
+CCC_dense_hash_map_remove_key_value(CCC_Dense_hash_map *map, void *type_output);
+
+/**@}*/
+
+/** @name Iterator Interface
+Iterate over the dense record array in order of position. */
+/**@{*/
+
+/** @brief Obtains a pointer to the first record.
+@param[in] map the map to iterate through.
+@return a pointer to the first record or the end if the map is empty.
+@warning insertions and removals during iteration invalidate iterators. */
+[[nodiscard]] void *CCC_dense_hash_map_begin(CCC_Dense_hash_map const *map);
+
+/** @brief Advances the iterator to the next record.
+@param[in] map the map being iterated upon.
+@param[in] type_iterator the previous iterator.
+@return a pointer to the next record or the end. */
+[[nodiscard]] void *CCC_dense_hash_map_next(CCC_Dense_hash_map const *map,
+                                            void const *type_iterator);
+
+/** @brief Returns the end of the record array for loop termination.
+@param[in] map the map being iterated upon.
+@return one past the last record.
+@warning It is undefined behavior to access or modify the end address. */
+[[nodiscard]] void *CCC_dense_hash_map_end(CCC_Dense_hash_map const *map);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the container state. */
+/**@{*/
+
+/** @brief Returns the number of records in the map.
+@param[in] map the map.
+@return the count or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count
+CCC_dense_hash_map_count(CCC_Dense_hash_map const *map);
+
+/** @brief Returns true if the map is empty.
+@param[in] map the map.
+@return true if empty, false if not. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_dense_hash_map_is_empty(CCC_Dense_hash_map const *map);
+
+/** @brief Validates that every record is indexed once at its own position.
+@param[in] map the map.
+@return true if valid, false if not. Error if map is NULL. O(N). */
+[[nodiscard]] CCC_Tribool
+CCC_dense_hash_map_validate(CCC_Dense_hash_map const *map);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Destroy the map. */
+/**@{*/
+
+/** @brief Removes every record, keeping the memory for later use.
+@param[in] map the map.
+@param[in] destroy the optional destructor for each record.
+@return OK or an argument error if map is NULL. */
+CCC_Result CCC_dense_hash_map_clear(CCC_Dense_hash_map *map,
+                                    CCC_Type_destructor *destroy);
+
+/** @brief Removes every record and frees the record array and index table.
+@param[in] map the map.
+@param[in] destroy the optional destructor for each record.
+@return OK or an argument error if map is NULL. The map remains initialized
+and may be used again. */
+CCC_Result CCC_dense_hash_map_clear_and_free(CCC_Dense_hash_map *map,
+                                             CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are helpful. Ensure
+no namespace clashes occur before shortening. */
+#ifdef DENSE_HASH_MAP_USING_NAMESPACE_CCC
+typedef CCC_Dense_hash_map Dense_hash_map;
+typedef CCC_Dense_hash_map_entry Dense_hash_map_entry;
+#    define dense_hash_map_initialize(args...)                                 \
+        CCC_dense_hash_map_initialize(args)
+#    define dense_hash_map_reserve(args...) CCC_dense_hash_map_reserve(args)
+#    define dense_hash_map_contains(args...) CCC_dense_hash_map_contains(args)
+#    define dense_hash_map_get_key_value(args...)                              \
+        CCC_dense_hash_map_get_key_value(args)
+#    define dense_hash_map_entry(args...) CCC_dense_hash_map_entry(args)
+#    define dense_hash_map_entry_wrap(args...)                                 \
+        CCC_dense_hash_map_entry_wrap(args)
+#    define dense_hash_map_and_modify(args...)                                 \
+        CCC_dense_hash_map_and_modify(args)
+#    define dense_hash_map_and_modify_context(args...)                         \
+        CCC_dense_hash_map_and_modify_context(args)
+#    define dense_hash_map_or_insert(args...)                                  \
+        CCC_dense_hash_map_or_insert(args)
+#    define dense_hash_map_insert_entry(args...)                               \
+        CCC_dense_hash_map_insert_entry(args)
+#    define dense_hash_map_remove_entry(args...)                               \
+        CCC_dense_hash_map_remove_entry(args)
+#    define dense_hash_map_unwrap(args...) CCC_dense_hash_map_unwrap(args)
+#    define dense_hash_map_occupied(args...) CCC_dense_hash_map_occupied(args)
+#    define dense_hash_map_insert_error(args...)                               \
+        CCC_dense_hash_map_insert_error(args)
+#    define dense_hash_map_try_insert(args...)                                 \
+        CCC_dense_hash_map_try_insert(args)
+#    define dense_hash_map_insert_or_assign(args...)                           \
+        CCC_dense_hash_map_insert_or_assign(args)
+#    define dense_hash_map_remove_key_value(args...)                           \
+        CCC_dense_hash_map_remove_key_value(args)
+#    define dense_hash_map_begin(args...) CCC_dense_hash_map_begin(args)
+#    define dense_hash_map_next(args...) CCC_dense_hash_map_next(args)
+#    define dense_hash_map_end(args...) CCC_dense_hash_map_end(args)
+#    define dense_hash_map_count(args...) CCC_dense_hash_map_count(args)
+#    define dense_hash_map_is_empty(args...) CCC_dense_hash_map_is_empty(args)
+#    define dense_hash_map_validate(args...) CCC_dense_hash_map_validate(args)
+#    define dense_hash_map_clear(args...) CCC_dense_hash_map_clear(args)
+#    define dense_hash_map_clear_and_free(args...)                             \
+        CCC_dense_hash_map_clear_and_free(args)
+#endif /* DENSE_HASH_MAP_USING_NAMESPACE_CCC */
+
+#endif /* CCC_DENSE_HASH_MAP_H */
@@ -0,0 +1,314 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Filter Interface
+
+A Filter answers whether a key may have been inserted. A negative answer is
+always correct and a positive answer is wrong with a small probability, so a
+filter placed in front of a hash map or a slower store avoids most lookups for
+keys that are absent. A filter stores no keys, only bits or small counters
+derived from their hashes.
+
+The filter is blocked. It is an array of 64 byte blocks, one cache line each,
+and a key is confined to the single block its hash selects. Within the block a
+key selects one bit or counter in each of the eight 64 bit words, so every
+operation costs one cache miss at most. On x86 targets with AVX2 or AVX-512
+the eight positions are computed and set or tested in vector registers.
+
+- A Bloom filter keeps one bit per position. Keys cannot be removed. A block
+  holds 512 bits and a filter initialized for an expected count spends about
+  16 bits per key, giving a false positive rate below one percent.
+- A counting filter keeps a four bit counter per position so that keys may be
+  removed. A block holds 128 counters and a filter initialized for an expected
+  count spends about 16 counters per key. A counter that reaches its maximum
+  stays there, so heavy repetition of one key can only raise the false
+  positive rate, never cause a false negative.
+
+A filter may be given an allocation function, in which case its blocks are
+allocated once at initialization, or it may be declared as a fixed size type
+with CCC_filter_declare_fixed and need no allocation at all. A filter never
+resizes.
+
+The hash function of the filter is the user hash function of its keys. The
+filter mixes the value it returns, so the hash used by a flat hash map may be
+shared with the `_with_hash` functions of a filter in front of it.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define FILTER_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_FILTER_H
+#define CCC_FILTER_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "private/private_filter.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A blocked Bloom or counting filter.
+
+The filter must be initialized at runtime with CCC_filter_initialize or
+CCC_filter_initialize_fixed before use. */
+typedef struct CCC_Filter CCC_Filter;
+
+/** @brief The kind of a filter.
+
+- `CCC_FILTER_KIND_BLOOM` keeps one bit per position and cannot remove keys.
+- `CCC_FILTER_KIND_COUNTING` keeps a four bit counter per position and can
+  remove keys. */
+typedef enum CCC_Filter_kind CCC_Filter_kind;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the filter at runtime. */
+/**@{*/
+
+/** @brief Declare a fixed size filter type that needs no allocation. Does not
+return a value.
+@param[in] fixed_filter_type_name the user chosen name of the fixed type.
+@param[in] block_count the power of two number of 64 byte blocks.
+
+A Bloom block serves about 32 keys and a counting block about 8 keys at the
+false positive rate described for the filter.
+
+```
+#define FILTER_USING_NAMESPACE_CCC
+filter_declare_fixed(Small_filter, 64);
+``` */
+#define CCC_filter_declare_fixed(fixed_filter_type_name, block_count)          \
+    CCC_private_filter_declare_fixed(fixed_filter_type_name, block_count)
+
+/** @brief Obtain the block count previously chosen for a fixed filter type.
+@param[in] fixed_filter_type_name the name of a previously declared filter.
+@return the size_t number of blocks in the filter. */
+#define CCC_filter_fixed_block_count(fixed_filter_type_name)                   \
+    CCC_private_filter_fixed_block_count(fixed_filter_type_name)
+
+/** @brief Initialize a filter that allocates its blocks once at runtime.
+@param[in] filter the uninitialized filter.
+@param[in] kind the CCC_Filter_kind of the filter.
+@param[in] hash the CCC_Key_hasher for the keys.
+@param[in] allocate the allocation function for the blocks.
+@param[in] context context data for hashing and allocation.
+@param[in] expected_count the number of keys the filter should serve at its
+intended false positive rate.
+@return the result of initialization. An argument error is returned if the
+filter, hash, or allocate function is NULL or the kind is unknown, and an
+allocator error if the blocks could not be allocated.
+
+The block count is the power of two that gives each expected key at least 16
+bits or counters, and at least one block. Allocation requests cache line
+alignment. */
+CCC_Result CCC_filter_initialize(CCC_Filter *filter, CCC_Filter_kind kind,
+                                 CCC_Key_hasher *hash, CCC_Allocator *allocate,
+                                 void *context, size_t expected_count);
+
+/** @brief Initialize a filter over the blocks of a fixed filter type.
+@param[in] filter_pointer a pointer to the uninitialized filter.
+@param[in] fixed_pointer a pointer to a type declared by
+CCC_filter_declare_fixed. It is evaluated once and may be a compound literal.
+@param[in] kind the CCC_Filter_kind of the filter.
+@param[in] hash the CCC_Key_hasher for the keys.
+@param[in] context_data context data for hashing.
+@return the result of initialization. An argument error is returned if the
+filter, storage, or hash function is NULL or the kind is unknown.
+
+The blocks are cleared by initialization.
+
+```
+#define FILTER_USING_NAMESPACE_CCC
+filter_declare_fixed(Small_filter, 64);
+static Filter filter;
+CCC_Result const r = filter_initialize_fixed(
+    &filter,
+    &(static Small_filter){},
+    CCC_FILTER_KIND_BLOOM,
+    CCC_hash_key_u32,
+    NULL
+);
+``` */
+#define CCC_filter_initialize_fixed(filter_pointer, fixed_pointer, kind, hash, \
+                                    context_data)                              \
+    CCC_private_filter_initialize_fixed(filter_pointer, fixed_pointer, kind,   \
+                                        hash, context_data)
+
+/**@}*/
+
+/** @name Membership Interface
+Test whether keys may be present. */
+/**@{*/
+
+/** @brief Returns whether key may have been inserted.
+@param[in] filter the filter to query.
+@param[in] key pointer to the key.
+@return false if key was certainly not inserted, true if it probably was, or
+an error if filter or key is NULL. */
+[[nodiscard]] CCC_Tribool CCC_filter_contains(CCC_Filter const *filter,
+                                              void const *key);
+
+/** @brief Returns whether the key with the given user hash may have been
+inserted.
+@param[in] filter the filter to query.
+@param[in] hash the value of the user hash function for the key.
+@return false if the key was certainly not inserted, true if it probably was,
+or an error if filter is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_filter_contains_with_hash(CCC_Filter const *filter, uint64_t hash);
+
+/** @brief Queries many keys at once, writing whether each may be present.
+@param[in] filter the filter to query.
+@param[in] keys an array of n pointers to keys.
+@param[in] n the number of keys.
+@param[out] maybe_present an array of at least n results. Index i receives the
+answer CCC_filter_contains would give for keys[i].
+@return the number of keys that may be present. An argument error is set if
+filter is NULL, n is non-zero and keys or maybe_present is NULL, or any key is
+NULL, in which case no output is written.
+
+The keys are processed in small chunks. Every key in a chunk is hashed and its
+block prefetched before any block is tested, so the cache misses of
+independent queries overlap rather than each query stalling in turn.
+
+```
+#define FILTER_USING_NAMESPACE_CCC
+void const *keys[3] = {&(uint32_t){1}, &(uint32_t){2}, &(uint32_t){3}};
+bool maybe[3];
+CCC_Count const hits = filter_contains_batch(&filter, keys, 3, maybe);
+``` */
+[[nodiscard]] CCC_Count
+CCC_filter_contains_batch(CCC_Filter const *filter, void const *const keys[],
+                          size_t n, bool maybe_present[]);
+
+/**@}*/
+
+/** @name Insert and Remove Interface
+Add or remove keys. */
+/**@{*/
+
+/** @brief Inserts key into the filter.
+@param[in] filter the filter in which to insert.
+@param[in] key pointer to the key.
+@return OK or an argument error if filter or key is NULL or the filter has no
+blocks because it was freed.
+
+Inserting a key more than once is allowed. In a counting filter each
+insertion must be matched by one removal before the key is absent again. */
+CCC_Result CCC_filter_insert(CCC_Filter *filter, void const *key);
+
+/** @brief Inserts the key with the given user hash into the filter.
+@param[in] filter the filter in which to insert.
+@param[in] hash the value of the user hash function for the key.
+@return the same results as CCC_filter_insert. */
+CCC_Result CCC_filter_insert_with_hash(CCC_Filter *filter, uint64_t hash);
+
+/** @brief Removes one insertion of key from a counting filter.
+@param[in] filter the counting filter from which to remove.
+@param[in] key pointer to the key.
+@return OK if the counters of key were decremented, a fail result if key was
+certainly not present and nothing changed, or an argument error if filter or
+key is NULL or the filter is a Bloom filter.
+@warning only remove keys that were inserted. Removing a key that is merely a
+false positive decrements counters shared with other keys and may cause false
+negatives for them. */
+CCC_Result CCC_filter_remove(CCC_Filter *filter, void const *key);
+
+/** @brief Removes one insertion of the key with the given user hash from a
+counting filter.
+@param[in] filter the counting filter from which to remove.
+@param[in] hash the value of the user hash function for the key.
+@return the same results as CCC_filter_remove.
+@warning only remove keys that were inserted. */
+CCC_Result CCC_filter_remove_with_hash(CCC_Filter *filter, uint64_t hash);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the filter state. */
+/**@{*/
+
+/** @brief Returns the number of insertions less the number of removals.
+@param[in] filter the filter.
+@return the count or an argument error if filter is NULL. */
+[[nodiscard]] CCC_Count CCC_filter_count(CCC_Filter const *filter);
+
+/** @brief Returns the number of 64 byte blocks in the filter.
+@param[in] filter the filter.
+@return the block count or an argument error if filter is NULL. */
+[[nodiscard]] CCC_Count CCC_filter_block_count(CCC_Filter const *filter);
+
+/** @brief Returns true if nothing has been inserted since the filter was
+initialized or cleared, or every insertion has been removed.
+@param[in] filter the filter.
+@return true if empty, false if not, or an error if filter is NULL. */
+[[nodiscard]] CCC_Tribool CCC_filter_is_empty(CCC_Filter const *filter);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Destroy the container. */
+/**@{*/
+
+/** @brief Clears every block, keeping the blocks of the filter.
+@param[in] filter the filter to clear.
+@return OK or an argument error if filter is NULL. */
+CCC_Result CCC_filter_clear(CCC_Filter *filter);
+
+/** @brief Clears the filter and frees its blocks.
+@param[in] filter the filter to free.
+@return OK, an argument error if filter is NULL, or a no allocation function
+error for a fixed filter, which is cleared but owns no memory to free. */
+CCC_Result CCC_filter_clear_and_free(CCC_Filter *filter);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are desired for the
+filter container. Check for collisions with names in your namespace. */
+#ifdef FILTER_USING_NAMESPACE_CCC
+typedef CCC_Filter Filter;
+typedef CCC_Filter_kind Filter_kind;
+#    define filter_declare_fixed(args...) CCC_filter_declare_fixed(args)
+#    define filter_fixed_block_count(args...)                                  \
+        CCC_filter_fixed_block_count(args)
+#    define filter_initialize(args...) CCC_filter_initialize(args)
+#    define filter_initialize_fixed(args...) CCC_filter_initialize_fixed(args)
+#    define filter_contains(args...) CCC_filter_contains(args)
+#    define filter_contains_with_hash(args...)                                 \
+        CCC_filter_contains_with_hash(args)
+#    define filter_contains_batch(args...) CCC_filter_contains_batch(args)
+#    define filter_insert(args...) CCC_filter_insert(args)
+#    define filter_insert_with_hash(args...) CCC_filter_insert_with_hash(args)
+#    define filter_remove(args...) CCC_filter_remove(args)
+#    define filter_remove_with_hash(args...) CCC_filter_remove_with_hash(args)
+#    define filter_count(args...) CCC_filter_count(args)
+#    define filter_block_count(args...) CCC_filter_block_count(args)
+#    define filter_is_empty(args...) CCC_filter_is_empty(args)
+#    define filter_clear(args...) CCC_filter_clear(args)
+#    define filter_clear_and_free(args...) CCC_filter_clear_and_free(args)
+#endif /* FILTER_USING_NAMESPACE_CCC */
+
+#endif /* CCC_FILTER_H */
@@ -24,10 +24,12 @@ available in this implementation.
 A flat hash map requires the user to provide a pointer to the map, a type, a key
 field, a hash function, and a key three way comparator function. The hasher
 should be well tailored to the key being stored in the table to prevent
-collisions. Good variety in the upper bits of the hashed value will also result
-in faster performance. Currently, the flat hash map does not offer any default
-hash functions or hash strengthening algorithms so strong hash functions should
-be obtained by the user for the data set.
+collisions. The low bits of the hash select where a search begins and the upper
+seven bits form a tag that filters candidates, so both must vary across keys.
+Seeded hash functions for integers, byte ranges, and strings that meet these
+requirements are provided in `ccc/hash.h`. If a user hash function is weak in
+either region, such as the identity function on integers, initialize the map
+with `CCC_FLAT_HASH_MAP_OPTION_MIX_HASH` to finalize every user hash.
 
 The current implementation will seek to use the best platform specific Single
 Instruction Multiple Data (SIMD) or Single Register Multiple Data (SRMD)
@@ -78,6 +80,19 @@ Or finally, just define it before including the flat hash map header.
 #include "ccc/flat_hash_map.h"
 ```
 
+On x86 a fixed size map scans 16 tags per probe with SSE2, which every x86-64
+processor supports, because its layout is decided at compile time. A dynamic
+map picks its group width when it first allocates: 64 tags with AVX-512BW or
+32 tags with AVX2 if the processor supports them, otherwise 16. The library
+carries all three scans and asks the processor at runtime, so no target flags
+are needed and one build runs on any x86-64 processor. The CMake option below
+lowers the widest group a dynamic map picks, which is mostly useful to test the
+narrower scans on a processor that supports the wider ones.
+
+```
+cmake --preset=clang-release -DCCC_FLAT_HASH_MAP_WIDEST_GROUP=32
+```
+
 To shorten names in the interface, define the following preprocessor directive
 at the top of your file. The `CCC_` prefix may then be omitted for only this
 container.
@@ -95,6 +110,7 @@ All types and functions can then be written without the `CCC_` prefix. */
 #include <stddef.h>
 /** @endcond */
 
+#include "buffer.h"
 #include "private/private_flat_hash_map.h"
 #include "types.h"
 
@@ -115,6 +131,94 @@ The Entry Interface offers efficient search and subsequent insertion, deletion,
 or value update based on the needs of the user. */
 typedef union CCC_Flat_hash_map_entry_wrap CCC_Flat_hash_map_entry;
 
+/** @brief Options chosen at initialization that change how the map stores its
+data. Options may be combined with bitwise or.
+
+`CCC_FLAT_HASH_MAP_OPTION_STORE_HASH` keeps the full 64 bit hash of every
+element in an array after the tags. Resizing and rehashing then only move
+memory and never call the user hash function, and a full hash comparison
+filters out tag collisions before the user comparison function is called. This
+is worthwhile when hashing or comparing keys is expensive, such as with long
+strings, at the cost of 8 additional bytes per slot.
+
+`CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE` spreads the cost of growing the
+map over later operations. When the map must grow, the larger table is
+allocated but no elements are moved. Each later insertion or removal moves a
+small, fixed number of groups from the previous table and searches check both
+tables until the previous table is empty and freed. This bounds the worst case
+latency of an insertion at the cost of keeping both tables allocated for a
+short time. Searches through a const map never move elements. The option has
+no effect on maps without an allocation function. As with any resize,
+references to elements are invalidated by insertions and removals.
+
+`CCC_FLAT_HASH_MAP_OPTION_MIX_HASH` passes every value returned by the user
+hash function through the finalizer of `CCC_hash_mix` from `ccc/hash.h`. This
+costs a few multiplies per hash and repairs hash functions whose variety is
+only in the low or only in the high bits. It is unnecessary with the hash
+functions of `ccc/hash.h`. When combined with stored hashes, the stored value
+is the finalized hash. */
+typedef enum CCC_Flat_hash_map_option CCC_Flat_hash_map_option;
+
+/** @brief The parts of a snapshot of the map to be written in order.
+
+The header must be written first, followed by the table bytes. The table is
+the map's own allocation, so writing a snapshot copies nothing in memory. */
+typedef struct
+{
+    /** The fixed size header describing the table. */
+    struct CCC_Flat_hash_map_snapshot_header header;
+    /** The start of the table to write after the header or NULL if empty. */
+    void const *table;
+    /** The number of table bytes to write after the header. */
+    size_t table_bytes;
+} CCC_Flat_hash_map_snapshot;
+
+/** @brief The number of buckets in the probe length histogram of the
+statistics. The last bucket collects every longer probe. */
+enum : size_t
+{
+    CCC_FLAT_HASH_MAP_STATS_PROBE_BUCKETS = 16,
+};
+
+/** @brief A report of how well the elements of a map are spread across its
+table, as filled by CCC_flat_hash_map_stats.
+
+Every count describes only the groups that were sampled except for the
+element count and byte totals, which describe the whole map. */
+typedef struct
+{
+    /** The number of elements in the whole map. */
+    size_t count;
+    /** The number of slots in the current table. */
+    size_t capacity;
+    /** The number of groups of tags that were examined. */
+    size_t sampled_groups;
+    /** The number of elements found in the examined groups. */
+    size_t sampled_elements;
+    /** The number of deleted tags in the examined groups. Deleted tags make
+    probes longer and are only reclaimed by a rehash. */
+    size_t tombstones;
+    /** Entry i counts the elements found by visiting i + 1 groups. The last
+    entry counts every element requiring that many groups or more. */
+    size_t probe_length[CCC_FLAT_HASH_MAP_STATS_PROBE_BUCKETS];
+    /** The sum of groups visited over every sampled element, so that the mean
+    is this divided by the sampled elements. */
+    size_t total_probe_length;
+    /** The most groups visited to find any sampled element. */
+    size_t max_probe_length;
+    /** The number of times a different element with the same 7 bit tag was
+    compared before the sampled element was found. */
+    size_t false_tag_matches;
+    /** Entry i counts the examined groups with exactly i full tags. Entries
+    past the group width of the map stay 0. */
+    size_t group_fill[CCC_FLAT_HASH_MAP_MAX_GROUP_COUNT + 1];
+    /** The bytes of user types stored, count times the element size. */
+    size_t bytes_used;
+    /** The bytes of every table the map holds, including the tag and stored
+    hash arrays and the previous table during an incremental resize. */
+    size_t bytes_allocated;
+} CCC_Flat_hash_map_stats;
+
 /**@}*/
 
 /** @name Initialization Interface
@@ -130,8 +234,8 @@ segment. Does not return a value.
 may have a key and value field as well as any additional fields. For set-like
 behavior, wrap a field in a struct/union (e.g. `union int_node {int e;};`).
 @param[in] capacity the power of two capacity for the map.
-@warning the capacity must be a power of two greater than 8 or 16, depending on
-the platform (e.g. 16, 32, 64, etc.).
+@warning the capacity must be a power of two greater than 8 or 16,
+depending on the platform group width (e.g. 16, 32, 64, 128, etc.).
 
 Once the location for the fixed size map is chosen--stack, heap, or data
 segment--provide a pointer to the map for the initialization macro.
@@ -199,6 +303,39 @@ restrictions. */
 #define CCC_flat_hash_map_fixed_capacity(fixed_map_type_name)                  \
     CCC_private_flat_hash_map_fixed_capacity(fixed_map_type_name)
 
+/** @brief Declare a fixed size map type with room to store the full hash of
+every element. Does not return a value.
+@param[in] fixed_map_type_name the user chosen name of the fixed sized map.
+@param[in] type_name the type the user plans to store in the map.
+@param[in] capacity the power of two capacity for the map.
+@warning a map using this type must be initialized with the
+`CCC_FLAT_HASH_MAP_OPTION_STORE_HASH` option and a map with that option must
+use this type if it is fixed size. The option and layout are not checked
+against each other.
+
+All of the requirements of CCC_flat_hash_map_declare_fixed apply. The capacity
+is still obtained with CCC_flat_hash_map_fixed_capacity.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+flat_hash_map_declare_fixed_stored_hash(Small_hashed_map, struct Val, 64);
+static Flat_hash_map static_map = flat_hash_map_initialize_with_options(
+    &(static Small_hashed_map){},
+    struct Val,
+    key,
+    flat_hash_map_int_to_u64,
+    flat_hash_map_key_order,
+    NULL,
+    NULL,
+    flat_hash_map_fixed_capacity(Small_hashed_map),
+    CCC_FLAT_HASH_MAP_OPTION_STORE_HASH
+);
+``` */
+#define CCC_flat_hash_map_declare_fixed_stored_hash(fixed_map_type_name,       \
+                                                    type_name, capacity)       \
+    CCC_private_flat_hash_map_declare_fixed_stored_hash(fixed_map_type_name,   \
+                                                        type_name, capacity)
+
 /** @brief Initialize a map of types at compile time or runtime.
 @param[in] map_pointer a pointer to a fixed map allocation or NULL.
 @param[in] type_name the name of the user defined type stored in the map.
@@ -268,6 +405,46 @@ identical to the provided examples. Omit `static` in a runtime context. */
                                          hash, compare, allocate,              \
                                          context_data, capacity)
 
+/** @brief Initialize a map of types at compile time or runtime with options.
+@param[in] map_pointer a pointer to a fixed map allocation or NULL.
+@param[in] type_name the name of the user defined type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the allocation function for resizing or NULL if no
+resizing is allowed.
+@param[in] context_data context data that is needed for hashing or comparison.
+@param[in] capacity the capacity of a fixed size map or 0.
+@param[in] options the CCC_Flat_hash_map_option flags for this map.
+@return the flat hash map directly initialized on the right hand side of the
+equality operator.
+@warning a fixed size map that stores hashes must be declared with
+CCC_flat_hash_map_declare_fixed_stored_hash.
+
+This is identical to CCC_flat_hash_map_initialize with the addition of options
+that remain fixed for the lifetime of the map.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+static Flat_hash_map static_map = flat_hash_map_initialize_with_options(
+    NULL,
+    struct Val,
+    key,
+    flat_hash_map_string_hash,
+    flat_hash_map_key_order,
+    std_allocate,
+    NULL,
+    0,
+    CCC_FLAT_HASH_MAP_OPTION_STORE_HASH
+);
+``` */
+#define CCC_flat_hash_map_initialize_with_options(                             \
+    map_pointer, type_name, key_field, hash, compare, allocate, context_data,  \
+    capacity, options)                                                         \
+    CCC_private_flat_hash_map_initialize_with_options(                         \
+        map_pointer, type_name, key_field, hash, compare, allocate,            \
+        context_data, capacity, options)
+
 /** @brief Initialize a dynamic map at runtime from an initializer list.
 @param[in] key_field the field of the struct used for key storage.
 @param[in] hash the CCC_Key_hasher function provided by the user.
@@ -333,6 +510,47 @@ map to protect its invariants from user error at compile time. */
                                    context_data, optional_capacity,            \
                                    array_compound_literal)
 
+/** @brief Initialize a dynamic map at runtime from the elements of a Buffer.
+@param[in] type_name the type stored in the buffer and the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data that is needed for hashing or comparison.
+@param[in] buffer_pointer a pointer to the CCC_Buffer of type_name elements.
+@param[in] keys_unique true if the caller guarantees no two elements of the
+buffer share a key, allowing every key comparison to be skipped.
+@return the flat hash map directly initialized on the right hand side of the
+equality operator (i.e. CCC_Flat_hash_map map = CCC_flat_hash_map_from_buffer
+(...);)
+@warning An allocation function is required. This initializer is only available
+for dynamic maps.
+@warning If initialization fails, the map will be returned empty.
+
+The map is built with one allocation and one pass as described by
+CCC_flat_hash_map_extend. The buffer is only read and remains owned by the
+caller.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+Flat_hash_map map = flat_hash_map_from_buffer(
+    struct Val,
+    key,
+    CCC_hash_key_u64,
+    val_key_order,
+    std_allocate,
+    NULL,
+    &records,
+    CCC_TRUE
+);
+``` */
+#define CCC_flat_hash_map_from_buffer(type_name, key_field, hash, compare,     \
+                                      allocate, context_data, buffer_pointer,  \
+                                      keys_unique)                             \
+    CCC_private_flat_hash_map_from_buffer(type_name, key_field, hash, compare, \
+                                          allocate, context_data,              \
+                                          buffer_pointer, keys_unique)
+
 /** @brief Initialize a dynamic map at runtime with at least the specified
 capacity.
 @param[in] type_name the name of the type being stored in the map.
@@ -616,6 +834,158 @@ provide the same function that was passed upon initialization. */
 CCC_Result CCC_flat_hash_map_reserve(CCC_Flat_hash_map *map, size_t to_add,
                                      CCC_Allocator *allocate);
 
+/** @brief Reserve space for to_add more elements, moving the elements of
+the current table with several threads if the map must grow.
+@param[in] map a pointer to the hash map.
+@param[in] to_add the number of elements the map must accept without another
+resize.
+@param[in] allocate the required allocation function.
+@param[in] threads the number of threads to use, including the caller.
+@return the same results as CCC_flat_hash_map_reserve.
+
+Each thread hashes the elements of an equal share of the old table's groups and
+counts them by the high bits of their home slot in the new table. The elements
+are then grouped by those bits so that each thread fills separate ranges of the
+new table without any synchronization. An element whose probe would leave its
+range is placed by the caller once the threads finish. The new table has the
+same layout as one built by a single thread.
+
+Elements are hashed again unless the map stores hashes, so the hash function
+must be safe to call from many threads at once. Temporary arrays of one hash
+per old slot and one index per element are allocated with allocate for the
+duration of the call. If threads is at most one or the map is small, the map
+is resized by the caller alone. An incremental resize in progress is finished
+first. */
+CCC_Result CCC_flat_hash_map_reserve_parallel(CCC_Flat_hash_map *map,
+                                              size_t to_add,
+                                              CCC_Allocator *allocate,
+                                              size_t threads);
+
+/** @brief Reallocate the map to the smallest capacity that holds its elements.
+@param[in] map a pointer to the hash map.
+@param[in] allocate the required allocation function. If the map has
+allocation permission it must be the same function provided on initialization.
+A map that was given its memory with the reserve function may provide the same
+function used to reserve.
+@return the result of the operation, OK if successful or an error code to
+indicate the specific failure. If the new table cannot be allocated the map is
+unchanged.
+@warning It is an error to provide an allocation function for a map whose
+memory did not come from that function, such as a fixed size map.
+
+The new capacity is the smallest power of two, no smaller than one group, whose
+load factor admits the current count. If that is the current capacity the
+deleted slots are purged in place as with CCC_flat_hash_map_compact and no
+allocation occurs. Any incremental resize in progress is finished first. All
+references into the map are invalidated. O(capacity). */
+CCC_Result CCC_flat_hash_map_shrink_to_fit(CCC_Flat_hash_map *map,
+                                           CCC_Allocator *allocate);
+
+/** @brief Purge the deleted slots left by removals without reallocating.
+@param[in] map a pointer to the hash map.
+@return OK if successful or an argument error if map is NULL.
+
+Removals that cannot leave an empty slot without breaking a probe sequence
+leave a deleted slot instead. Deleted slots lengthen unsuccessful searches and
+are not reclaimed until the table runs out of empty slots. Compacting rehashes
+the elements in place so every deleted slot becomes empty again. This is the
+only way to purge deleted slots of a fixed size map early. Any incremental
+resize in progress is finished first. All references into the map are
+invalidated. O(capacity). */
+CCC_Result CCC_flat_hash_map_compact(CCC_Flat_hash_map *map);
+
+/** @brief Shrink to fit automatically when removals leave the map sparse.
+@param[in] map a pointer to the hash map.
+@param[in] denominator shrink whenever a removal leaves fewer than capacity /
+denominator elements. Zero disables automatic shrinking, the default.
+@return OK if the setting was applied, an argument error if map is NULL or the
+denominator is 1, or a no allocation function error if the map does not have
+allocation permission.
+
+Once enabled, removals through CCC_flat_hash_map_remove_key_value and
+CCC_flat_hash_map_remove_entry may reallocate the table as described by
+CCC_flat_hash_map_shrink_to_fit, invalidating references into the map. If the
+allocation fails the removal still succeeds and the map keeps its capacity.
+Shrinking is deferred while an incremental resize is in progress. A
+denominator of 4 is a reasonable choice that leaves room to grow again. */
+CCC_Result CCC_flat_hash_map_auto_shrink(CCC_Flat_hash_map *map,
+                                         size_t denominator);
+
+/** @brief Describe the map as a header and table that may be written to a
+file and loaded later without rebuilding.
+@param[in] map a pointer to the hash map.
+@param[in] hash_id a user chosen identifier of the hash function and seed. A
+snapshot only loads with the same identifier because the table position of
+every element depends on its hash.
+@param[out] snapshot the header and the range of table bytes to write.
+@return OK if the snapshot describes the map or an argument error if map or
+snapshot is NULL.
+
+The map is one contiguous allocation of user data, tags, and optionally stored
+hashes with no pointers. The snapshot refers to that allocation directly so
+the table is written straight from the map. If an incremental resize is in
+progress it is finished first so the snapshot holds one table. Any change to
+the map invalidates the snapshot.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+Flat_hash_map_snapshot s = {};
+(void)flat_hash_map_snapshot(&map, MY_HASH_ID, &s);
+(void)write(fd, &s.header, sizeof(s.header));
+(void)write(fd, s.table, s.table_bytes);
+```
+
+User types holding pointers are written as is, so only types whose contents
+remain meaningful in another process should be saved. The snapshot is read
+back by CCC_flat_hash_map_load_snapshot on a machine of the same architecture
+that scans groups as wide as those of the saved map. */
+CCC_Result CCC_flat_hash_map_snapshot(CCC_Flat_hash_map *map, uint64_t hash_id,
+                                      CCC_Flat_hash_map_snapshot *snapshot);
+
+/** @brief Initialize a map that serves its table directly from the memory of
+a snapshot, such as a memory mapped file.
+@param[in] map_pointer a pointer to the map to initialize.
+@param[in] type_name the type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] context_data context data that is needed for hashing or comparison.
+@param[in] hash_id the identifier given when the snapshot was taken.
+@param[in] snapshot_pointer the start of the snapshot header.
+@param[in] snapshot_bytes the bytes available from the snapshot pointer.
+@return OK if the map now refers to the snapshot table. An argument error, with
+the map unchanged, if any pointer is NULL, the memory is not aligned to the size
+of the snapshot header, the bytes are too few, or the header does not match the
+type, group width, or hash identifier.
+
+Nothing is copied or rehashed, so loading takes constant time regardless of the
+size of the table. Pages of the table are read in by the operating system as
+lookups touch them.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+void *const mem = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+Flat_hash_map map;
+CCC_Result const r = flat_hash_map_load_snapshot(
+    &map, struct Val, key, CCC_hash_key_u64, val_key_order, NULL, MY_HASH_ID,
+    mem, bytes);
+```
+
+The loaded map has no allocation function and does not own the memory, which
+the user releases after the map is no longer used. The map is read only so the
+memory may be mapped without write permission. Insertions report an insert
+error, even for a key that is present, and removals, clearing, retaining,
+modifying entries, compaction, and reserving report an argument error. The
+references returned by lookups must not be written through. To modify the
+contents copy the loaded map into a map with an allocation function with
+CCC_flat_hash_map_copy. */
+#define CCC_flat_hash_map_load_snapshot(                                       \
+    map_pointer, type_name, key_field, hash, compare, context_data, hash_id,   \
+    snapshot_pointer, snapshot_bytes)                                          \
+    CCC_private_flat_hash_map_load_snapshot(                                   \
+        map_pointer, type_name, key_field, hash, compare, context_data,        \
+        hash_id, snapshot_pointer, snapshot_bytes)
+
 /**@}*/
 
 /**@name Membership Interface
@@ -637,6 +1007,36 @@ CCC_flat_hash_map_contains(CCC_Flat_hash_map const *map, void const *key);
 [[nodiscard]] void *
 CCC_flat_hash_map_get_key_value(CCC_Flat_hash_map const *map, void const *key);
 
+/** @brief Searches the table for many keys at once, writing a reference to
+each element found or NULL to the corresponding output.
+@param[in] map the flat hash map to search.
+@param[in] keys an array of n pointers to keys matching the stored key type.
+@param[in] n the number of keys to search.
+@param[out] type_outputs an array of at least n pointers. Index i receives a
+reference to the element matching keys[i] or NULL if it is absent.
+@return the number of keys found. An argument error is set if map is NULL or
+n is non-zero and keys or type_outputs is NULL.
+
+The keys are processed in small chunks. Every key in a chunk is hashed and the
+first tag group and data slot its probe will visit are prefetched before any
+probing begins. This allows the cache misses of independent lookups to overlap
+rather than each lookup stalling in turn, which helps most when the table is
+much larger than the cache and many keys are known ahead of time, as in a
+join. The results are identical to calling get on each key in order.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+void const *keys[3] = {&(int){1}, &(int){2}, &(int){3}};
+void *found[3];
+CCC_Count const hits = flat_hash_map_get_key_value_batch(&map, keys, 3, found);
+```
+
+The keys must not be NULL. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_map_get_key_value_batch(CCC_Flat_hash_map const *map,
+                                      void const *const keys[], size_t n,
+                                      void *type_outputs[]);
+
 /**@}*/
 
 /** @name Entry Interface
@@ -782,6 +1182,78 @@ or other data, such functions will not be called if the entry is Occupied. */
     CCC_private_flat_hash_map_or_insert_with(map_entry_pointer,                \
                                              type_compound_literal)
 
+/** @brief Inserts each element whose key is not yet present, writing a
+reference to the element now in the table for each input.
+@param[in] map the flat hash map.
+@param[in] types an array of n pointers to complete user types to insert if
+their keys are absent.
+@param[in] n the number of user types.
+@param[out] type_outputs an array of at least n pointers. Index i receives a
+reference to the stored element with the key of types[i], either the element
+already present or the newly inserted copy. NULL is written if insertion was
+required but no space remained.
+@return the number of new elements inserted. An argument error is set if map
+is NULL or n is non-zero and types or type_outputs is NULL. If the map has no
+memory and cannot obtain any the resizing error is set.
+
+This is the batched equivalent of `or_insert(entry(map, key), type)` for each
+input in order, so a later duplicate key receives a reference to the earlier
+element. Space for all n elements is reserved before any insertion, so if the
+map may resize it does so at most once and every reference written to
+type_outputs remains valid when the function returns. As with the batched
+search, hashes and prefetches are issued for a chunk of inputs before their
+probes are resolved. The user types must not be NULL. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_map_or_insert_batch(CCC_Flat_hash_map *map,
+                                  void const *const types[], size_t n,
+                                  void *type_outputs[]);
+
+/** @brief Inserts or assigns every element of a Buffer with one reservation.
+@param[in] map the flat hash map.
+@param[in] buffer the Buffer of elements of the same type as the map.
+@param[in] keys_unique true if the caller guarantees that no element of the
+buffer shares a key with another element or with any element already in the
+map. Every key comparison is then skipped and each element is placed in the
+first free slot of its probe sequence.
+@return OK if every element was inserted or assigned. An argument error if map
+or buffer is NULL, keys_unique is an error, or the buffer element size differs
+from the map element size. If the space for every element cannot be reserved
+the resizing error is returned and the map is unchanged.
+
+Elements with a key already present overwrite the stored element, so the last
+occurrence of a key in the buffer wins. Space for the whole buffer is reserved
+before any insertion so the table resizes at most once. Elements are then
+hashed in chunks, prefetching the home group and slot of each, before their
+probes are resolved. If keys_unique is true but a key repeats, the map will
+hold duplicates and its behavior is undefined. O(N). */
+CCC_Result CCC_flat_hash_map_extend(CCC_Flat_hash_map *map,
+                                    CCC_Buffer const *buffer,
+                                    CCC_Tribool keys_unique);
+
+/** @brief Inserts or assigns every element of a Buffer using several threads.
+@param[in] map the flat hash map.
+@param[in] buffer the Buffer of elements of the same type as the map.
+@param[in] keys_unique true if the caller guarantees that no element of the
+buffer shares a key with another element or with any element in the map.
+@param[in] threads the number of threads to use, including the caller.
+@return the same results as CCC_flat_hash_map_extend.
+
+The result is the same as CCC_flat_hash_map_extend, including that the last
+occurrence of a key in the buffer wins. If the map must grow it does so as
+described by CCC_flat_hash_map_reserve_parallel. The elements are then hashed
+by all threads and grouped by the high bits of their home slot, so that each
+range of the table is written by exactly one thread. The rare element whose
+probe would leave its range is placed by the caller after the threads finish.
+
+The hash and comparison functions must be safe to call from many threads at
+once. The map must have an allocation function for the temporary arrays of
+hashes and groupings, otherwise, or if threads is at most one, the elements are
+inserted by the caller alone. */
+CCC_Result CCC_flat_hash_map_extend_parallel(CCC_Flat_hash_map *map,
+                                             CCC_Buffer const *buffer,
+                                             CCC_Tribool keys_unique,
+                                             size_t threads);
+
 /** @brief Inserts the provided entry invariantly.
 @param[in] entry the entry returned from a call obtaining an entry.
 @param[in] type the complete key and value type to be inserted.
@@ -993,6 +1465,22 @@ and wraps it in an entry to provide information about the old value. */
             .private                                                           \
     }
 
+/** @brief Removes every element for which the predicate returns false.
+@param[in] map the pointer to the flat hash map.
+@param[in] keep the predicate deciding which elements remain in the map.
+@param[in] context any context data passed to each call of the predicate.
+@return the number of elements removed or an argument error if map or keep is
+NULL.
+
+The tag array is scanned one aligned group at a time and each full slot is
+handed to the predicate in place. A rejected element is erased by its index so
+no key is hashed or probed again. The predicate may release any resources the
+element owns before returning false but must not insert into or remove from the
+map. An incremental resize in progress is finished first and an automatic
+shrink may follow the scan. O(capacity). */
+CCC_Count CCC_flat_hash_map_retain(CCC_Flat_hash_map *map,
+                                   CCC_Type_predicate *keep, void *context);
+
 /** @brief Unwraps the provided entry to obtain a view into the table element.
 @param[in] entry the entry from a query to the table via function or macro.
 @return an view into the table entry if one is present, or NULL. */
@@ -1037,6 +1525,111 @@ CCC_flat_hash_map_entry_status(CCC_Flat_hash_map_entry const *entry);
 
 /**@}*/
 
+/** @name Precomputed Hash Interface
+Hash a key once and reuse the value for lookups in every map sharing the same
+hash function. */
+/**@{*/
+
+/** @brief Returns the hash of key produced by the hash function of the map.
+@param[in] map the flat hash map providing the hash function and context.
+@param[in] key the key to hash matching the stored key type.
+@return the value of the user hash function for key, or 0 if map or key is
+NULL.
+
+The value is the output of the user hash function before any mixing the map
+applies internally. It may therefore be passed to the `_with_hash` functions of
+any map that uses the same hash function and context, whatever options each map
+was initialized with.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+uint64_t const hash = flat_hash_map_hash(&records, &id);
+struct Record *r = flat_hash_map_get_key_value_with_hash(&records, &id, hash);
+struct Stats *s = flat_hash_map_get_key_value_with_hash(&stats, &id, hash);
+```
+*/
+[[nodiscard]] uint64_t CCC_flat_hash_map_hash(CCC_Flat_hash_map const *map,
+                                              void const *key);
+
+/** @brief Searches the table for the presence of key with a known hash.
+@param[in] map the flat hash map to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@param[in] hash the value of CCC_flat_hash_map_hash for key.
+@return true if the struct containing key is stored, false if not. Error if map
+or key is NULL.
+@warning a hash that does not belong to key gives unspecified results and may
+corrupt the map. */
+[[nodiscard]] CCC_Tribool
+CCC_flat_hash_map_contains_with_hash(CCC_Flat_hash_map const *map,
+                                     void const *key, uint64_t hash);
+
+/** @brief Returns a reference into the table at entry key with a known hash.
+@param[in] map the flat hash map to search.
+@param[in] key the key to search matching stored key type.
+@param[in] hash the value of CCC_flat_hash_map_hash for key.
+@return a view of the table entry if it is present, else NULL.
+@warning a hash that does not belong to key gives unspecified results and may
+corrupt the map. */
+[[nodiscard]] void *
+CCC_flat_hash_map_get_key_value_with_hash(CCC_Flat_hash_map const *map,
+                                          void const *key, uint64_t hash);
+
+/** @brief Obtains an entry for the provided key with a known hash.
+@param[in] map the hash table to be searched.
+@param[in] key the key used to search the table matching the stored key type.
+@param[in] hash the value of CCC_flat_hash_map_hash for key.
+@return a specialized hash entry for use with other functions in the Entry
+Interface.
+@warning a hash that does not belong to key gives unspecified results and may
+corrupt the map.
+
+The entry behaves exactly as one obtained from CCC_flat_hash_map_entry. */
+[[nodiscard]] CCC_Flat_hash_map_entry
+CCC_flat_hash_map_entry_with_hash(CCC_Flat_hash_map *map, void const *key,
+                                  uint64_t hash);
+
+/** @brief Obtains an entry for the provided key with a known hash.
+@param[in] map_pointer the hash table to be searched.
+@param[in] key_pointer the key used to search the table matching the stored key
+type.
+@param[in] hash the value of CCC_flat_hash_map_hash for the key.
+@return a compound literal reference to a specialized hash entry for use with
+other functions in the Entry Interface.
+@warning a hash that does not belong to the key gives unspecified results and
+may corrupt the map. */
+#define CCC_flat_hash_map_entry_with_hash_wrap(map_pointer, key_pointer, hash) \
+    &(CCC_Flat_hash_map_entry)                                                 \
+    {                                                                          \
+        CCC_flat_hash_map_entry_with_hash(map_pointer, key_pointer, hash)      \
+            .private                                                           \
+    }
+
+/** @brief Attempts to insert the key value wrapping type with a known hash.
+@param[in] map the pointer to the flat hash map.
+@param[in] type the complete key and value type to be inserted.
+@param[in] hash the value of CCC_flat_hash_map_hash for the key in type.
+@return an entry exactly as CCC_flat_hash_map_try_insert would return.
+@warning a hash that does not belong to the key gives unspecified results and
+may corrupt the map. */
+[[nodiscard]] CCC_Entry
+CCC_flat_hash_map_try_insert_with_hash(CCC_Flat_hash_map *map, void const *type,
+                                       uint64_t hash);
+
+/** @brief Removes the key value in the map with a known hash, storing the old
+value, if present, in the struct provided by the user.
+@param[in] map the pointer to the flat hash map.
+@param[out] type_output the complete key and value type to be removed.
+@param[in] hash the value of CCC_flat_hash_map_hash for the key in type_output.
+@return the removed entry exactly as CCC_flat_hash_map_remove_key_value would
+return.
+@warning a hash that does not belong to the key gives unspecified results and
+may corrupt the map. */
+[[nodiscard]] CCC_Entry
+CCC_flat_hash_map_remove_key_value_with_hash(CCC_Flat_hash_map *map,
+                                             void *type_output, uint64_t hash);
+
+/**@}*/
+
 /** @name Deallocation Interface
 Destroy the container. */
 /**@{*/
@@ -1125,6 +1718,50 @@ resizing occurs which would lead to undefined behavior. O(capacity). */
 @warning It is undefined behavior to access or modify the end address. */
 [[nodiscard]] void *CCC_flat_hash_map_end(CCC_Flat_hash_map const *map);
 
+/** @brief Obtain the number of tag groups available to range iteration.
+@param[in] map the table to be iterated upon.
+@return the number of groups or an argument error if map is NULL.
+
+The count includes the groups of the previous table while an incremental resize
+is in progress. It is only stable until the next insertion or removal. The
+group width of a dynamic map depends on the processor, so divide the work by
+this count rather than by the capacity. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_map_group_count(CCC_Flat_hash_map const *map);
+
+/** @brief Calls the modifier on each element in a range of tag groups.
+@param[in] map the table to be iterated upon.
+@param[in] start_group the first group to visit.
+@param[in] end_group one past the last group to visit.
+@param[in] modify the function called on every element in the range.
+@param[in] context any context data passed to each call of the modifier.
+@return OK if the range was visited or an argument error if map or modify is
+NULL or the range exceeds CCC_flat_hash_map_group_count.
+
+Each group is a fixed run of slots in the tag array, so disjoint ranges visit
+disjoint elements. Several threads may therefore each scan their own range of
+the same map at once provided no thread inserts into or removes from the map
+during the scan. The modifier may change values but must not change keys.
+
+```
+CCC_Count const groups = CCC_flat_hash_map_group_count(&map);
+size_t const share = (groups.count + THREADS - 1) / THREADS;
+for (size_t t = 0; t < THREADS; ++t)
+{
+    size_t const start = min(t * share, groups.count);
+    size_t const end = min(start + share, groups.count);
+    // Launch a thread calling:
+    // CCC_flat_hash_map_for_each_range(&map, start, end, visit, &shared);
+}
+```
+
+Iteration order within a range is unspecified. O(range). */
+CCC_Result CCC_flat_hash_map_for_each_range(CCC_Flat_hash_map *map,
+                                            size_t start_group,
+                                            size_t end_group,
+                                            CCC_Type_modifier *modify,
+                                            void *context);
+
 /**@}*/
 
 /** @name State Interface
@@ -1155,6 +1792,97 @@ NULL. */
 [[nodiscard]] CCC_Tribool
 CCC_flat_hash_map_validate(CCC_Flat_hash_map const *map);
 
+/** @brief Measures probe lengths, tag collisions, and occupancy of the table.
+@param[in] map the hash table.
+@param[in] sample_groups the number of groups of tags to examine, spread
+evenly across the table. Zero, or a number at least the number of groups,
+examines every group.
+@param[out] stats the report to fill.
+@return OK if the report was filled or an argument error if map or stats is
+NULL.
+
+The table is scanned one aligned group at a time. Each element found is probed
+again from its hash to count the groups visited and the other elements with the
+same tag that a search compares before reaching it. A map with a good hash
+function finds nearly every element in the first group and has about one false
+tag match in 128 comparisons. Long probes or frequent false matches point to a
+hash function with too little variety in its low or high bits, which the
+`CCC_FLAT_HASH_MAP_OPTION_MIX_HASH` option or the functions of `ccc/hash.h`
+repair. Many tombstones point to a workload that would benefit from
+CCC_flat_hash_map_compact.
+
+Unless hashes are stored, the user hash function is called once per sampled
+element, so sampling a few groups is cheap enough for periodic collection in
+production. During an incremental resize both tables are sampled. O(N) in the
+sampled elements. */
+CCC_Result CCC_flat_hash_map_stats(CCC_Flat_hash_map const *map,
+                                   size_t sample_groups,
+                                   CCC_Flat_hash_map_stats *stats);
+
+/**@}*/
+
+/** @name Specialization Interface
+Generate functions for one map type with hashing and comparison inlined. */
+/**@{*/
+
+/** @brief Define static inline functions specialized to one element type.
+@param[in] name the prefix of the generated functions.
+@param[in] type_name the type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash a function of the form `uint64_t hash(key_type const *key)`.
+It must return the same hash as the CCC_Key_hasher the map was initialized
+with, before any mixing the map applies.
+@param[in] equal a function of the form
+`bool equal(key_type const *left, key_type const *right)`. It must agree with
+the CCC_Key_comparator the map was initialized with.
+
+The following functions are defined, each with the semantics of the library
+function of the same suffix.
+
+- `type_name *name_get_key_value(CCC_Flat_hash_map const *, key_type const *)`
+- `CCC_Tribool name_contains(CCC_Flat_hash_map const *, key_type const *)`
+- `CCC_Entry name_insert_or_assign(CCC_Flat_hash_map *, type_name const *)`
+- `CCC_Entry name_remove_key_value(CCC_Flat_hash_map *, type_name *)`
+
+Every lookup in the library calls the hash and comparison through function
+pointers and finds elements by multiplying a runtime element size. For small
+keys those calls cost more than matching a group of tags. The generated
+functions call the provided hash and comparison directly, so the compiler may
+inline them, and index the data as an array of type_name. They probe the same
+table with the same tags, probe sequence, and erase rule as the library, so
+generated and library functions may be freely mixed on one map.
+
+The generated functions fall back to the library when an insertion may rehash,
+a removal may shrink the table, the table has not been allocated, or an
+incremental resize is in progress. The hash is computed once either way.
+
+```
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+struct Id
+{
+    uint64_t id;
+    int val;
+};
+static inline uint64_t
+id_hash(uint64_t const *id)
+{
+    return CCC_hash_u64(*id, CCC_HASH_DEFAULT_SEED);
+}
+static inline bool
+id_equal(uint64_t const *left, uint64_t const *right)
+{
+    return *left == *right;
+}
+CCC_FLAT_HASH_MAP_SPECIALIZE(id_map, struct Id, id, id_hash, id_equal);
+```
+
+The map itself is still initialized with the library hash and comparison
+callbacks, which are used whenever the library rehashes or falls back. The
+macro is used at file scope and must be followed by a semicolon. */
+#define CCC_FLAT_HASH_MAP_SPECIALIZE(name, type_name, key_field, hash, equal)  \
+    CCC_private_flat_hash_map_specialize(name, type_name, key_field, hash,     \
+                                         equal)
+
 /**@}*/
 
 /** Define this preprocessor directive if shorter names are helpful. Ensure
@@ -1162,13 +1890,32 @@ CCC_flat_hash_map_validate(CCC_Flat_hash_map const *map);
 #ifdef FLAT_HASH_MAP_USING_NAMESPACE_CCC
 typedef CCC_Flat_hash_map Flat_hash_map;
 typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
+typedef CCC_Flat_hash_map_option Flat_hash_map_option;
+typedef CCC_Flat_hash_map_stats Flat_hash_map_stats;
+typedef CCC_Flat_hash_map_snapshot Flat_hash_map_snapshot;
 #    define flat_hash_map_declare_fixed(args...)                               \
         CCC_flat_hash_map_declare_fixed(args)
 #    define flat_hash_map_fixed_capacity(args...)                              \
         CCC_flat_hash_map_fixed_capacity(args)
+#    define flat_hash_map_declare_fixed_stored_hash(args...)                   \
+        CCC_flat_hash_map_declare_fixed_stored_hash(args)
 #    define flat_hash_map_reserve(args...) CCC_flat_hash_map_reserve(args)
+#    define flat_hash_map_extend(args...) CCC_flat_hash_map_extend(args)
+#    define flat_hash_map_extend_parallel(args...)                             \
+        CCC_flat_hash_map_extend_parallel(args)
+#    define flat_hash_map_reserve_parallel(args...)                            \
+        CCC_flat_hash_map_reserve_parallel(args)
+#    define flat_hash_map_shrink_to_fit(args...)                               \
+        CCC_flat_hash_map_shrink_to_fit(args)
+#    define flat_hash_map_compact(args...) CCC_flat_hash_map_compact(args)
+#    define flat_hash_map_auto_shrink(args...)                                 \
+        CCC_flat_hash_map_auto_shrink(args)
 #    define flat_hash_map_initialize(args...) CCC_flat_hash_map_initialize(args)
+#    define flat_hash_map_initialize_with_options(args...)                     \
+        CCC_flat_hash_map_initialize_with_options(args)
 #    define flat_hash_map_from(args...) CCC_flat_hash_map_from(args)
+#    define flat_hash_map_from_buffer(args...)                                 \
+        CCC_flat_hash_map_from_buffer(args)
 #    define flat_hash_map_with_capacity(args...)                               \
         CCC_flat_hash_map_with_capacity(args)
 #    define flat_hash_map_with_compound_literal(args...)                       \
@@ -1189,6 +1936,8 @@ typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
 #    define flat_hash_map_contains(args...) CCC_flat_hash_map_contains(args)
 #    define flat_hash_map_get_key_value(args...)                               \
         CCC_flat_hash_map_get_key_value(args)
+#    define flat_hash_map_get_key_value_batch(args...)                         \
+        CCC_flat_hash_map_get_key_value_batch(args)
 #    define flat_hash_map_remove_key_value_wrap(args...)                       \
         CCC_flat_hash_map_remove_key_value_wrap(args)
 #    define flat_hash_map_swap_entry_wrap(args...)                             \
@@ -1201,6 +1950,20 @@ typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
         CCC_flat_hash_map_remove_entry_wrap(args)
 #    define flat_hash_map_remove_key_value(args...)                            \
         CCC_flat_hash_map_remove_key_value(args)
+#    define flat_hash_map_retain(args...) CCC_flat_hash_map_retain(args)
+#    define flat_hash_map_hash(args...) CCC_flat_hash_map_hash(args)
+#    define flat_hash_map_contains_with_hash(args...)                          \
+        CCC_flat_hash_map_contains_with_hash(args)
+#    define flat_hash_map_get_key_value_with_hash(args...)                     \
+        CCC_flat_hash_map_get_key_value_with_hash(args)
+#    define flat_hash_map_entry_with_hash(args...)                             \
+        CCC_flat_hash_map_entry_with_hash(args)
+#    define flat_hash_map_entry_with_hash_wrap(args...)                        \
+        CCC_flat_hash_map_entry_with_hash_wrap(args)
+#    define flat_hash_map_try_insert_with_hash(args...)                        \
+        CCC_flat_hash_map_try_insert_with_hash(args)
+#    define flat_hash_map_remove_key_value_with_hash(args...)                  \
+        CCC_flat_hash_map_remove_key_value_with_hash(args)
 #    define flat_hash_map_swap_entry(args...) CCC_flat_hash_map_swap_entry(args)
 #    define flat_hash_map_try_insert(args...) CCC_flat_hash_map_try_insert(args)
 #    define flat_hash_map_insert_or_assign(args...)                            \
@@ -1213,6 +1976,8 @@ typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
 #    define flat_hash_map_and_modify_context(args...)                          \
         CCC_flat_hash_map_and_modify_context(args)
 #    define flat_hash_map_or_insert(args...) CCC_flat_hash_map_or_insert(args)
+#    define flat_hash_map_or_insert_batch(args...)                             \
+        CCC_flat_hash_map_or_insert_batch(args)
 #    define flat_hash_map_insert_entry(args...)                                \
         CCC_flat_hash_map_insert_entry(args)
 #    define flat_hash_map_unwrap(args...) CCC_flat_hash_map_unwrap(args)
@@ -1221,6 +1986,10 @@ typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
         CCC_flat_hash_map_insert_error(args)
 #    define flat_hash_map_begin(args...) CCC_flat_hash_map_begin(args)
 #    define flat_hash_map_next(args...) CCC_flat_hash_map_next(args)
+#    define flat_hash_map_group_count(args...)                                 \
+        CCC_flat_hash_map_group_count(args)
+#    define flat_hash_map_for_each_range(args...)                              \
+        CCC_flat_hash_map_for_each_range(args)
 #    define flat_hash_map_end(args...) CCC_flat_hash_map_end(args)
 #    define flat_hash_map_is_empty(args...) CCC_flat_hash_map_is_empty(args)
 #    define flat_hash_map_count(args...) CCC_flat_hash_map_count(args)
@@ -1231,6 +2000,10 @@ typedef CCC_Flat_hash_map_entry Flat_hash_map_entry;
         CCC_flat_hash_map_clear_and_free_reserve(args)
 #    define flat_hash_map_capacity(args...) CCC_flat_hash_map_capacity(args)
 #    define flat_hash_map_validate(args...) CCC_flat_hash_map_validate(args)
+#    define flat_hash_map_stats(args...) CCC_flat_hash_map_stats(args)
+#    define flat_hash_map_snapshot(args...) CCC_flat_hash_map_snapshot(args)
+#    define flat_hash_map_load_snapshot(args...)                               \
+        CCC_flat_hash_map_load_snapshot(args)
 #endif
 
 #endif /* CCC_FLAT_HASH_MAP_H */
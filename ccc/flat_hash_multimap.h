@@ -0,0 +1,382 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Flat Hash Multimap Interface
+
+A Flat Hash Multimap is a flat hash map that accepts any number of elements
+with equal keys. It uses the same table, tag groups, and SIMD probing as the
+flat hash map. Every element, duplicate or not, occupies its own slot of the
+one table allocation, so no per key allocation or nested container is needed
+to hold duplicates.
+
+An element is inserted into the first free slot along the probe sequence of
+its hash. Elements with equal keys therefore gather along one probe sequence,
+usually in one or two groups of adjacent slots. Counting, collecting, and
+erasing every element with a key each take one probe that matches tags until
+the first group with an empty slot.
+
+Elements may be copied and moved when the table rehashes so no pointer
+stability is available. The same hash function requirements as the flat hash
+map apply, and many equal keys share one probe sequence, so a key repeated
+thousands of times will lengthen searches for the keys whose probes cross it.
+
+Fixed size multimaps use the types declared for fixed size flat hash maps.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_FLAT_HASH_MULTIMAP_H
+#define CCC_FLAT_HASH_MULTIMAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "private/private_flat_hash_multimap.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A flat hash map that stores elements with equal keys.
+
+It may be initialized at compile time or runtime exactly as a flat hash map. */
+typedef struct CCC_Flat_hash_multimap CCC_Flat_hash_multimap;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the container with memory, callbacks, and permissions. */
+/**@{*/
+
+/** @brief Declare a fixed size multimap type for use in the stack, heap, or
+data segment. Does not return a value.
+@param[in] fixed_map_type_name the user chosen name of the fixed sized map.
+@param[in] type_name the type the user plans to store in the map.
+@param[in] capacity a power of two capacity for the map.
+
+The requirements and layout are those of CCC_flat_hash_map_declare_fixed. */
+#define CCC_flat_hash_multimap_declare_fixed(fixed_map_type_name, type_name,   \
+                                             capacity)                         \
+    CCC_private_flat_hash_map_declare_fixed(fixed_map_type_name, type_name,    \
+                                            capacity)
+
+/** @brief Obtain the capacity previously chosen for the fixed size map type.
+@param[in] fixed_map_type_name the name of a previously declared map.
+@return the size_t capacity. This is the full capacity without any load factor
+restrictions. */
+#define CCC_flat_hash_multimap_fixed_capacity(fixed_map_type_name)             \
+    CCC_private_flat_hash_map_fixed_capacity(fixed_map_type_name)
+
+/** @brief Initialize a multimap at compile time or runtime.
+@param[in] map_pointer a pointer to a fixed map allocation or NULL.
+@param[in] type_name the name of the user defined type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the allocation function for resizing or NULL.
+@param[in] context_data context data for hashing and comparison.
+@param[in] capacity the capacity of a fixed map or 0.
+@return the multimap directly initialized on the right hand side of the
+equality operator.
+
+```
+#define FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC
+struct Row
+{
+    int group;
+    int row;
+};
+static Flat_hash_multimap by_group = flat_hash_multimap_initialize(
+    NULL,
+    struct Row,
+    group,
+    row_group_hash,
+    row_group_order,
+    std_allocate,
+    NULL,
+    0
+);
+``` */
+#define CCC_flat_hash_multimap_initialize(map_pointer, type_name, key_field,   \
+                                          hash, compare, allocate,             \
+                                          context_data, capacity)              \
+    CCC_private_flat_hash_multimap_initialize(map_pointer, type_name,          \
+                                              key_field, hash, compare,        \
+                                              allocate, context_data, capacity)
+
+/** @brief Reserves space for at least to_add more elements.
+@param[in] map the multimap to reserve.
+@param[in] to_add the number of elements to add beyond the current count.
+@param[in] allocate the allocation function to use to reserve memory.
+@return the result of the reservation. OK if successful, otherwise an error
+status is returned.
+
+The semantics are those of CCC_flat_hash_map_reserve. A multimap without its
+own allocation function must be freed with
+CCC_flat_hash_multimap_clear_and_free_reserve. */
+CCC_Result CCC_flat_hash_multimap_reserve(CCC_Flat_hash_multimap *map,
+                                          size_t to_add,
+                                          CCC_Allocator *allocate);
+
+/**@}*/
+
+/** @name Membership Interface
+Test membership or obtain references to stored user types directly. */
+/**@{*/
+
+/** @brief Searches the multimap for the presence of key.
+@param[in] map the multimap to be searched.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if at least one element has the key, false if none does, or an
+error if map or key is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_flat_hash_multimap_contains(CCC_Flat_hash_multimap const *map,
+                                void const *key);
+
+/** @brief Returns a reference to one element with the key.
+@param[in] map the multimap to search.
+@param[in] key the key to search matching stored key type.
+@return a reference to the first element with the key along its probe
+sequence or NULL if there is none. */
+[[nodiscard]] void *
+CCC_flat_hash_multimap_get_key_value(CCC_Flat_hash_multimap const *map,
+                                     void const *key);
+
+/** @brief Counts the elements with the key in one probe.
+@param[in] map the multimap to search.
+@param[in] key the key to count.
+@return the number of elements with the key or an argument error if map or
+key is NULL. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_multimap_count_key(CCC_Flat_hash_multimap const *map,
+                                 void const *key);
+
+/** @brief Collects references to every element with the key in one probe.
+@param[in] map the multimap to search.
+@param[in] key the key to search matching stored key type.
+@param[out] range an array to receive references to the matching elements.
+@param[in] range_capacity the number of references range may hold.
+@return the number of elements with the key or an argument error if map or
+key is NULL, or range is NULL with a non-zero capacity.
+
+References are written in probe order up to range_capacity. The count is the
+full number of matches, which may exceed range_capacity, so a caller may size
+an array from a first call with a capacity of 0 or retry with a larger array.
+The references are invalidated by any insertion or removal.
+
+```
+#define FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC
+struct Row *rows[16];
+CCC_Count const n = flat_hash_multimap_equal_range(
+    &by_group, &(int){3}, (void **)rows, 16
+);
+for (size_t i = 0; i < n.count && i < 16; ++i)
+{
+    use(rows[i]);
+}
+``` */
+CCC_Count CCC_flat_hash_multimap_equal_range(CCC_Flat_hash_multimap const *map,
+                                             void const *key, void *range[],
+                                             size_t range_capacity);
+
+/**@}*/
+
+/** @name Insert and Remove Interface
+Add or remove elements from the multimap. */
+/**@{*/
+
+/** @brief Inserts a copy of the type whether or not its key is present.
+@param[in] map the multimap in which to insert.
+@param[in] type the user type to copy into the map.
+@return a Vacant entry referring to the new element, an insert error if the
+map could not make room, or an argument error if map or type is NULL.
+
+No search for an equal key is made. The element takes the first free slot of
+its probe sequence. */
+[[nodiscard]] CCC_Entry
+CCC_flat_hash_multimap_insert(CCC_Flat_hash_multimap *map, void const *type);
+
+/** @brief Removes one element with the key in type_output, writing it to
+type_output.
+@param[in] map the multimap from which to remove.
+@param[in] type_output a user type with the key field set.
+@return an Occupied entry referring to type_output if an element was removed,
+a Vacant entry if none had the key, or an argument error if map or
+type_output is NULL.
+
+The element removed is the first with the key along its probe sequence, the
+same one CCC_flat_hash_multimap_get_key_value returns. */
+[[nodiscard]] CCC_Entry
+CCC_flat_hash_multimap_remove_key_value(CCC_Flat_hash_multimap *map,
+                                        void *type_output);
+
+/** @brief Removes every element with the key in one probe.
+@param[in] map the multimap from which to remove.
+@param[in] key the key of the elements to remove. It must not point into the
+map.
+@param[in] destroy the destructor called on each element before removal or
+NULL.
+@return the number of elements removed or an argument error if map or key is
+NULL. */
+CCC_Count CCC_flat_hash_multimap_remove_all(CCC_Flat_hash_multimap *map,
+                                            void const *key,
+                                            CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** @name Iterator Interface
+Obtain and manage iterators over the container. */
+/**@{*/
+
+/** @brief Obtains a pointer to the first element in the table.
+@param[in] map the table to iterate through.
+@return a pointer to the first element or the end sentinel if empty.
+
+Iteration visits slots in table order, not grouped by key. */
+[[nodiscard]] void *
+CCC_flat_hash_multimap_begin(CCC_Flat_hash_multimap const *map);
+
+/** @brief Advances the iterator to the next occupied table slot.
+@param[in] map the table being iterated upon.
+@param[in] type_iterator the previous iterator.
+@return a pointer to the next element or the end sentinel. */
+[[nodiscard]] void *
+CCC_flat_hash_multimap_next(CCC_Flat_hash_multimap const *map,
+                            void const *type_iterator);
+
+/** @brief Check the current iterator against the end for loop termination.
+@param[in] map the table being iterated upon.
+@return the end address of the hash table. */
+[[nodiscard]] void *
+CCC_flat_hash_multimap_end(CCC_Flat_hash_multimap const *map);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the container state. */
+/**@{*/
+
+/** @brief Returns the number of elements, counting each duplicate.
+@param[in] map the multimap.
+@return the count or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_multimap_count(CCC_Flat_hash_multimap const *map);
+
+/** @brief Returns the full capacity of the table.
+@param[in] map the multimap.
+@return the capacity or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count
+CCC_flat_hash_multimap_capacity(CCC_Flat_hash_multimap const *map);
+
+/** @brief Returns true if the multimap is empty.
+@param[in] map the multimap.
+@return true if empty, false if not, or an error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_flat_hash_multimap_is_empty(CCC_Flat_hash_multimap const *map);
+
+/** @brief Validates the invariants of the table.
+@param[in] map the multimap to validate.
+@return true if the invariants hold, false if not, or an error if map is
+NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_flat_hash_multimap_validate(CCC_Flat_hash_multimap const *map);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Destroy the container. */
+/**@{*/
+
+/** @brief Removes every element, keeping the table.
+@param[in] map the multimap to clear.
+@param[in] destroy the destructor for each element or NULL.
+@return OK or an argument error if map is NULL. */
+CCC_Result CCC_flat_hash_multimap_clear(CCC_Flat_hash_multimap *map,
+                                        CCC_Type_destructor *destroy);
+
+/** @brief Removes every element and frees the table.
+@param[in] map the multimap to free.
+@param[in] destroy the destructor for each element or NULL.
+@return OK, an argument error if map is NULL, or a no allocation function
+error if the map cannot free its own table. */
+CCC_Result CCC_flat_hash_multimap_clear_and_free(CCC_Flat_hash_multimap *map,
+                                                 CCC_Type_destructor *destroy);
+
+/** @brief Frees the table of a multimap reserved without its own allocation
+function.
+@param[in] map the multimap to free.
+@param[in] destroy the destructor for each element or NULL.
+@param[in] allocate the allocation function used to reserve the table.
+@return OK or an error as with CCC_flat_hash_map_clear_and_free_reserve. */
+CCC_Result
+CCC_flat_hash_multimap_clear_and_free_reserve(CCC_Flat_hash_multimap *map,
+                                              CCC_Type_destructor *destroy,
+                                              CCC_Allocator *allocate);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are desired for the
+flat hash multimap container. Check for collisions with names in your
+namespace. */
+#ifdef FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC
+typedef CCC_Flat_hash_multimap Flat_hash_multimap;
+#    define flat_hash_multimap_declare_fixed(args...)                          \
+        CCC_flat_hash_multimap_declare_fixed(args)
+#    define flat_hash_multimap_fixed_capacity(args...)                         \
+        CCC_flat_hash_multimap_fixed_capacity(args)
+#    define flat_hash_multimap_initialize(args...)                             \
+        CCC_flat_hash_multimap_initialize(args)
+#    define flat_hash_multimap_reserve(args...)                                \
+        CCC_flat_hash_multimap_reserve(args)
+#    define flat_hash_multimap_contains(args...)                               \
+        CCC_flat_hash_multimap_contains(args)
+#    define flat_hash_multimap_get_key_value(args...)                          \
+        CCC_flat_hash_multimap_get_key_value(args)
+#    define flat_hash_multimap_count_key(args...)                              \
+        CCC_flat_hash_multimap_count_key(args)
+#    define flat_hash_multimap_equal_range(args...)                            \
+        CCC_flat_hash_multimap_equal_range(args)
+#    define flat_hash_multimap_insert(args...)                                 \
+        CCC_flat_hash_multimap_insert(args)
+#    define flat_hash_multimap_remove_key_value(args...)                       \
+        CCC_flat_hash_multimap_remove_key_value(args)
+#    define flat_hash_multimap_remove_all(args...)                             \
+        CCC_flat_hash_multimap_remove_all(args)
+#    define flat_hash_multimap_begin(args...) CCC_flat_hash_multimap_begin(args)
+#    define flat_hash_multimap_next(args...) CCC_flat_hash_multimap_next(args)
+#    define flat_hash_multimap_end(args...) CCC_flat_hash_multimap_end(args)
+#    define flat_hash_multimap_count(args...) CCC_flat_hash_multimap_count(args)
+#    define flat_hash_multimap_capacity(args...)                               \
+        CCC_flat_hash_multimap_capacity(args)
+#    define flat_hash_multimap_is_empty(args...)                               \
+        CCC_flat_hash_multimap_is_empty(args)
+#    define flat_hash_multimap_validate(args...)                               \
+        CCC_flat_hash_multimap_validate(args)
+#    define flat_hash_multimap_clear(args...) CCC_flat_hash_multimap_clear(args)
+#    define flat_hash_multimap_clear_and_free(args...)                         \
+        CCC_flat_hash_multimap_clear_and_free(args)
+#    define flat_hash_multimap_clear_and_free_reserve(args...)                 \
+        CCC_flat_hash_multimap_clear_and_free_reserve(args)
+#endif /* FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC */
+
+#endif /* CCC_FLAT_HASH_MULTIMAP_H */
@@ -0,0 +1,180 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Hash Function Interface
+
+The hash functions provided here are fast, seeded, non-cryptographic hashes
+suitable for hash tables such as the flat hash map. They follow the design of
+wyhash and rapidhash: input is consumed eight bytes at a time and folded with
+a 64 by 64 bit multiply into a 128 bit product. Long inputs are consumed 48
+bytes at a time across three independent lanes so that modern processors may
+overlap the multiplications. Inputs of 16 bytes or fewer are read with a few
+overlapping loads and no loop.
+
+The hashes are not suitable for cryptography or for authentication. They are
+designed to spread keys evenly across both the low and high bits of the result
+which the flat hash map relies upon for group selection and tags. A seed may
+be chosen per table, for example randomly at startup, to make the layout of a
+table harder to predict from the outside.
+
+Two groups of functions are provided. The first group hashes values directly
+with an explicit seed. The second group are ready made `CCC_Key_hasher`
+functions that use `CCC_HASH_DEFAULT_SEED` and may be passed directly to the
+initializer of a container. If a different seed is needed, a one line hasher
+forwarding to the first group is sufficient.
+
+```
+static uint64_t
+hash_name(CCC_Key_context const k)
+{
+    struct Seed const *const s = k.context;
+    return CCC_hash_string(*(char const *const *)k.key, s->seed);
+}
+```
+
+Hash values are stable for a given seed within a build of the library but
+they are not guaranteed to be stable across library versions or platforms of
+different endianness. Do not persist them.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define HASH_USING_NAMESPACE_CCC
+```
+
+All functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_HASH_H
+#define CCC_HASH_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "types.h"
+
+/** @name Constants
+Constants used by the hash interface. */
+/**@{*/
+
+/** @brief The seed used by the `CCC_Key_hasher` functions of this interface.
+Any 64 bit value is a valid seed. */
+enum : uint64_t
+{
+    CCC_HASH_DEFAULT_SEED = 0x9E3779B97F4A7C15,
+};
+
+/**@}*/
+
+/** @name Seeded Hash Interface
+Hash values directly with a seed chosen by the user. */
+/**@{*/
+
+/** @brief Hash a range of bytes.
+@param[in] bytes a pointer to the first byte of the range.
+@param[in] count the number of bytes in the range.
+@param[in] seed any 64 bit value that changes the resulting hash.
+@return the 64 bit hash of the range. If bytes is NULL the range is treated as
+empty.
+
+The range need not be aligned. Padding bytes within a struct are part of the
+range so only hash structs without padding or hash each field separately. */
+[[nodiscard]] uint64_t CCC_hash_bytes(void const *bytes, size_t count,
+                                      uint64_t seed);
+
+/** @brief Hash a NUL terminated string.
+@param[in] string the string to hash. The terminator is not hashed.
+@param[in] seed any 64 bit value that changes the resulting hash.
+@return the 64 bit hash of the string. If string is NULL it is treated as the
+empty string.
+
+The result is equal to hashing the same characters with CCC_hash_bytes so
+strings stored inline and strings referenced by pointer hash identically. */
+[[nodiscard]] uint64_t CCC_hash_string(char const *string, uint64_t seed);
+
+/** @brief Hash a 64 bit integer.
+@param[in] value the integer to hash. Signed values may be cast.
+@param[in] seed any 64 bit value that changes the resulting hash.
+@return the 64 bit hash of the value.
+
+This is faster than CCC_hash_bytes for integers because no loads or length
+dependent branches are needed. */
+[[nodiscard]] uint64_t CCC_hash_u64(uint64_t value, uint64_t seed);
+
+/** @brief Hash a 32 bit integer.
+@param[in] value the integer to hash. Signed values may be cast.
+@param[in] seed any 64 bit value that changes the resulting hash.
+@return the 64 bit hash of the value. Equal to CCC_hash_u64 of the value
+widened without sign extension. */
+[[nodiscard]] uint64_t CCC_hash_u32(uint32_t value, uint64_t seed);
+
+/** @brief Strengthen an existing 64 bit hash.
+@param[in] hash the hash to finalize.
+@return a hash in which every input bit affects every output bit.
+
+The mix is a bijection so distinct inputs produce distinct outputs. It is the
+same finalizer the flat hash map applies to user hashes when initialized with
+`CCC_FLAT_HASH_MAP_OPTION_MIX_HASH`. It repairs hashes that only vary in their
+low bits, such as the identity function on integers, but it cannot repair
+hashes that collide. */
+[[nodiscard]] uint64_t CCC_hash_mix(uint64_t hash);
+
+/**@}*/
+
+/** @name Key Hasher Interface
+Functions matching the `CCC_Key_hasher` signature that may be passed directly
+to container initializers. Each uses `CCC_HASH_DEFAULT_SEED` and ignores the
+context of the container. */
+/**@{*/
+
+/** @brief Hash a key field of type uint64_t or int64_t.
+@param[in] key_context the key to hash.
+@return the hash of the key. */
+[[nodiscard]] uint64_t CCC_hash_key_u64(CCC_Key_context key_context);
+
+/** @brief Hash a key field of type uint32_t or int32_t.
+@param[in] key_context the key to hash.
+@return the hash of the key. */
+[[nodiscard]] uint64_t CCC_hash_key_u32(CCC_Key_context key_context);
+
+/** @brief Hash a key field of type `char const *`, a pointer to a NUL
+terminated string.
+@param[in] key_context the key to hash.
+@return the hash of the string referenced by the key field.
+
+For strings stored inline as a character array in the user type, use
+CCC_hash_string on the key directly in a custom hasher. */
+[[nodiscard]] uint64_t CCC_hash_key_string(CCC_Key_context key_context);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are helpful. Ensure
+no namespace clashes occur before shortening. The key hashers are aliased as
+objects rather than function-like macros so they may be passed by name. */
+#ifdef HASH_USING_NAMESPACE_CCC
+#    define HASH_DEFAULT_SEED CCC_HASH_DEFAULT_SEED
+#    define hash_bytes(args...) CCC_hash_bytes(args)
+#    define hash_string(args...) CCC_hash_string(args)
+#    define hash_u64(args...) CCC_hash_u64(args)
+#    define hash_u32(args...) CCC_hash_u32(args)
+#    define hash_mix(args...) CCC_hash_mix(args)
+#    define hash_key_u64 CCC_hash_key_u64
+#    define hash_key_u32 CCC_hash_key_u32
+#    define hash_key_string CCC_hash_key_string
+#endif /* HASH_USING_NAMESPACE_CCC */
+
+#endif /* CCC_HASH_H */
@@ -0,0 +1,293 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Optimistic Flat Hash Map Interface
+
+An Optimistic Flat Hash Map is a flat hash map modified by one writer thread
+and searched by any number of reader threads without locks. Readers never
+write to memory the writer or other readers use, so lookups scale across cores
+without a reader-writer lock bouncing its cache line between them.
+
+Lookups are optimistic in the manner of a sequence lock. Every group of the
+table is guarded by a sequence counter that the writer makes odd while it
+inserts into, overwrites, or erases from a slot of the group. A reader probes
+the tags with the same group matching as the flat hash map and, upon finding
+its key, copies the element out and confirms the counter of its group did not
+change. If it did, the lookup is retried. Readers whose keys live in other
+groups are unaffected by the write.
+
+When the table must grow the writer builds a new table beside the old one and
+publishes it with one atomic store, so a table is never rearranged while
+readers may probe it. The replaced table is retired and freed once every
+reader that could still hold it has finished its lookup. Readers announce the
+global epoch on entry to a lookup and the writer frees a retired table only
+when no announced epoch is as old as the table. Each reader thread is given
+its own index in [0, reader count) to announce its epoch.
+
+Because readers may observe a slot while it is being written, the key
+comparison function may be called on a partially written element while
+probing. Its result is discarded in that case and the found element is
+compared again on a consistent copy before it is reported, but the comparison
+must not follow pointers stored in the element or otherwise fault on arbitrary
+bytes. Thread sanitizers will
+report these reads as races even though the results are never used.
+
+The map requires an allocation function. The incremental resize option is not
+supported because the growth of the table is managed by this map.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define OPTIMISTIC_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_OPTIMISTIC_FLAT_HASH_MAP_H
+#define CCC_OPTIMISTIC_FLAT_HASH_MAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "flat_hash_map.h"
+#include "private/private_optimistic_flat_hash_map.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A single writer, many reader flat hash map with lock free lookups.
+
+The map must be initialized at runtime with one of the initialization macros
+before use and destroyed with CCC_optimistic_flat_hash_map_clear_and_free. It
+must not be copied by value after initialization. */
+typedef struct CCC_Optimistic_flat_hash_map CCC_Optimistic_flat_hash_map;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the map and its reader epochs. */
+/**@{*/
+
+/** @brief Initialize an optimistic map at runtime.
+@param[in] map_pointer a pointer to the uninitialized map.
+@param[in] type_name the user type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] reader_count the number of reader threads. Each reader thread
+passes its own index in [0, reader_count) to the lookup functions.
+@return the result of initialization. An argument error is returned if the
+map or allocation function is NULL, the reader count is 0 or greater than
+4096, or the incremental resize option is requested. An allocator error is
+returned if the reader epochs cannot be allocated.
+
+```
+#define OPTIMISTIC_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+struct Val
+{
+    uint64_t key;
+    int val;
+};
+Optimistic_flat_hash_map map;
+CCC_Result const r = optimistic_flat_hash_map_initialize(
+    &map,
+    struct Val,
+    key,
+    CCC_hash_key_u64,
+    val_key_order,
+    std_allocate,
+    NULL,
+    16
+);
+```
+
+The map begins empty with no table. */
+#define CCC_optimistic_flat_hash_map_initialize(map_pointer, type_name,        \
+                                                key_field, hash, compare,      \
+                                                allocate, context_data,        \
+                                                reader_count)                  \
+    CCC_private_optimistic_flat_hash_map_initialize_with_options(              \
+        map_pointer, type_name, key_field, hash, compare, allocate,            \
+        context_data, reader_count, CCC_FLAT_HASH_MAP_OPTION_NONE)
+
+/** @brief Initialize an optimistic map at runtime with flat hash map options.
+@param[in] map_pointer a pointer to the uninitialized map.
+@param[in] type_name the user type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] reader_count the number of reader threads.
+@param[in] options the CCC_Flat_hash_map_option flags for every table.
+@return the result of initialization as described in
+CCC_optimistic_flat_hash_map_initialize. */
+#define CCC_optimistic_flat_hash_map_initialize_with_options(                  \
+    map_pointer, type_name, key_field, hash, compare, allocate, context_data,  \
+    reader_count, options)                                                     \
+    CCC_private_optimistic_flat_hash_map_initialize_with_options(              \
+        map_pointer, type_name, key_field, hash, compare, allocate,            \
+        context_data, reader_count, options)
+
+/**@}*/
+
+/** @name Reader Interface
+Lock free lookups that may run on any number of threads concurrently with the
+writer. No two threads may use the same reader index at the same time. */
+/**@{*/
+
+/** @brief Searches the map for the presence of key.
+@param[in] map the optimistic map.
+@param[in] reader the index of the calling reader in [0, reader count).
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if the key was present at some point during the search, false if
+not. Error if map or key is NULL or the reader index is out of range. */
+[[nodiscard]] CCC_Tribool
+CCC_optimistic_flat_hash_map_contains(CCC_Optimistic_flat_hash_map const *map,
+                                      size_t reader, void const *key);
+
+/** @brief Copies the user type stored with key into type_output.
+@param[in] map the optimistic map.
+@param[in] reader the index of the calling reader in [0, reader count).
+@param[in] key pointer to the key matching the key type of the user struct.
+@param[out] type_output the user memory that receives a copy of the element.
+@return true if the key was found and a consistent copy of its element was
+written, false if the key was absent. The contents of type_output are
+unspecified if false is returned. Error if any argument is NULL or the reader
+index is out of range. */
+[[nodiscard]] CCC_Tribool CCC_optimistic_flat_hash_map_get_key_value(
+    CCC_Optimistic_flat_hash_map const *map, size_t reader, void const *key,
+    void *type_output);
+
+/**@}*/
+
+/** @name Writer Interface
+Modify the map. Only one thread may call these functions, and the remaining
+functions of this interface, at a time. */
+/**@{*/
+
+/** @brief Inserts the user type only if its key is absent.
+@param[in] map the optimistic map.
+@param[in,out] type_input_output the complete key and value type to insert.
+@return an entry. If Occupied the value already in the map was written to
+type_input_output which the entry wraps. If Vacant the type was inserted and
+the entry wraps type_input_output. If the table had to grow but allocation
+failed, an insert error is set. */
+[[nodiscard]] CCC_Entry
+CCC_optimistic_flat_hash_map_try_insert(CCC_Optimistic_flat_hash_map *map,
+                                        void *type_input_output);
+
+/** @brief Invariantly inserts or overwrites the user type.
+@param[in] map the optimistic map.
+@param[in] type the complete key and value type to insert.
+@return an entry wrapping NULL. Occupied if an element was overwritten, Vacant
+if the key was absent. If the table had to grow but allocation failed, an
+insert error is set. */
+[[nodiscard]] CCC_Entry
+CCC_optimistic_flat_hash_map_insert_or_assign(CCC_Optimistic_flat_hash_map *map,
+                                              void const *type);
+
+/** @brief Removes the element with the key of type_output and copies it out.
+@param[in] map the optimistic map.
+@param[in,out] type_output the user type with the search key written to it.
+@return an entry. If Occupied the removed element was written to type_output
+which the entry wraps. If Vacant no element had the key and the entry wraps
+NULL. */
+[[nodiscard]] CCC_Entry
+CCC_optimistic_flat_hash_map_remove_key_value(CCC_Optimistic_flat_hash_map *map,
+                                              void *type_output);
+
+/** @brief Frees every retired table that no reader can still be probing.
+@param[in] map the optimistic map.
+@return the number of retired tables that remain because a reader began its
+lookup before they were replaced, or an argument error if map is NULL.
+
+Reclamation is attempted every time the table grows, so calling this function
+is only needed to return memory sooner, such as after readers go idle. */
+CCC_Count
+CCC_optimistic_flat_hash_map_reclaim(CCC_Optimistic_flat_hash_map *map);
+
+/** @brief Returns the number of elements in the map.
+@param[in] map the optimistic map.
+@return the count or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count
+CCC_optimistic_flat_hash_map_count(CCC_Optimistic_flat_hash_map const *map);
+
+/** @brief Returns true if the map is empty.
+@param[in] map the optimistic map.
+@return true if empty, false if not. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_optimistic_flat_hash_map_is_empty(CCC_Optimistic_flat_hash_map const *map);
+
+/** @brief Validates the invariants of the table and its published view.
+@param[in] map the optimistic map.
+@return true if valid, false if not. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_optimistic_flat_hash_map_validate(CCC_Optimistic_flat_hash_map const *map);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Destroy the map. No reader may be inside a lookup. */
+/**@{*/
+
+/** @brief Removes every element and frees all tables and reader epochs.
+@param[in] map the optimistic map.
+@param[in] destroy the optional destructor for each element.
+@return OK or an argument error if map is NULL. The map must be initialized
+again before reuse. */
+CCC_Result
+CCC_optimistic_flat_hash_map_clear_and_free(CCC_Optimistic_flat_hash_map *map,
+                                            CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are helpful. Ensure
+no namespace clashes occur before shortening. */
+#ifdef OPTIMISTIC_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+typedef CCC_Optimistic_flat_hash_map Optimistic_flat_hash_map;
+#    define optimistic_flat_hash_map_initialize(args...)                       \
+        CCC_optimistic_flat_hash_map_initialize(args)
+#    define optimistic_flat_hash_map_initialize_with_options(args...)          \
+        CCC_optimistic_flat_hash_map_initialize_with_options(args)
+#    define optimistic_flat_hash_map_contains(args...)                         \
+        CCC_optimistic_flat_hash_map_contains(args)
+#    define optimistic_flat_hash_map_get_key_value(args...)                    \
+        CCC_optimistic_flat_hash_map_get_key_value(args)
+#    define optimistic_flat_hash_map_try_insert(args...)                       \
+        CCC_optimistic_flat_hash_map_try_insert(args)
+#    define optimistic_flat_hash_map_insert_or_assign(args...)                 \
+        CCC_optimistic_flat_hash_map_insert_or_assign(args)
+#    define optimistic_flat_hash_map_remove_key_value(args...)                 \
+        CCC_optimistic_flat_hash_map_remove_key_value(args)
+#    define optimistic_flat_hash_map_reclaim(args...)                          \
+        CCC_optimistic_flat_hash_map_reclaim(args)
+#    define optimistic_flat_hash_map_count(args...)                            \
+        CCC_optimistic_flat_hash_map_count(args)
+#    define optimistic_flat_hash_map_is_empty(args...)                         \
+        CCC_optimistic_flat_hash_map_is_empty(args)
+#    define optimistic_flat_hash_map_validate(args...)                         \
+        CCC_optimistic_flat_hash_map_validate(args)
+#    define optimistic_flat_hash_map_clear_and_free(args...)                   \
+        CCC_optimistic_flat_hash_map_clear_and_free(args)
+#endif /* OPTIMISTIC_FLAT_HASH_MAP_USING_NAMESPACE_CCC */
+
+#endif /* CCC_OPTIMISTIC_FLAT_HASH_MAP_H */
@@ -127,7 +127,12 @@ and nodes can be loaded on a cache line. We no longer need to consider
 arbitrarily sized or organized user data while we do operations on nodes and
 bits. Performance metrics still must be measured to say whether this is faster
 or slower than other approaches. However, the goal with this design is space
-efficiency first, speed second. */
+efficiency first, speed second.
+
+Subtree counts for rank and select queries follow the same reasoning. They are
+not stored in the nodes, where every map would pay for them. Only a map that
+enables order statistics carves a fourth array of counts, aligned for `size_t`,
+after the parity bit array. */
 struct CCC_Array_tree_map
 {
     /** @internal The contiguous array of user data. */
@@ -136,6 +141,9 @@ struct CCC_Array_tree_map
     struct CCC_Array_tree_map_node *nodes;
     /** @internal The parity bit array corresponding to each node. */
     unsigned *parity;
+    /** @internal The subtree counts corresponding to each node. Only present
+    when order statistics are enabled. */
+    size_t *counts;
     /** @internal The root node of the WAVL tree. */
     size_t root;
     /** @internal The start of the free singly linked list. */
@@ -154,6 +162,9 @@ struct CCC_Array_tree_map
     CCC_Allocator *allocate;
     /** @internal The provided context data, if any. */
     void *context;
+    /** @internal If the counts array is part of the layout and maintained on
+    every insert and remove to support rank and select queries. */
+    bool order_statistics;
 };
 
 /** @internal */
@@ -241,6 +252,7 @@ runtime. */
         .data = (private_memory_pointer),                                      \
         .nodes = NULL,                                                         \
         .parity = NULL,                                                        \
+        .counts = NULL,                                                        \
         .capacity = (private_capacity),                                        \
         .count = 0,                                                            \
         .root = 0,                                                             \
@@ -250,6 +262,7 @@ runtime. */
         .compare = (private_key_compare),                                      \
         .allocate = (private_allocate),                                        \
         .context = (private_context_data),                                     \
+        .order_statistics = false,                                             \
     }
 
 /** @internal Initialize an array tree map from user input list. */
@@ -329,6 +342,7 @@ runtime. */
         .data = &(private_compound_literal),                                   \
         .nodes = NULL,                                                         \
         .parity = NULL,                                                        \
+        .counts = NULL,                                                        \
         .capacity = CCC_private_array_tree_map_fixed_capacity(                 \
             typeof(private_compound_literal)),                                 \
         .count = 0,                                                            \
@@ -341,6 +355,7 @@ runtime. */
         .compare = (private_key_order_fn),                                     \
         .allocate = NULL,                                                      \
         .context = NULL,                                                       \
+        .order_statistics = false,                                             \
     }
 
 /** @internal */
@@ -351,6 +366,7 @@ runtime. */
         .data = &(private_compound_literal),                                   \
         .nodes = NULL,                                                         \
         .parity = NULL,                                                        \
+        .counts = NULL,                                                        \
         .capacity = CCC_private_array_tree_map_fixed_capacity(                 \
             typeof(private_compound_literal)),                                 \
         .count = 0,                                                            \
@@ -363,6 +379,7 @@ runtime. */
         .compare = (private_key_order_fn),                                     \
         .allocate = NULL,                                                      \
         .context = (private_context),                                          \
+        .order_statistics = false,                                             \
     }
 
 /** @internal */
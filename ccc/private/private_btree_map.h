@@ -0,0 +1,286 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_BTREE_MAP_H
+#define CCC_PRIVATE_BTREE_MAP_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_types.h"
+
+/* NOLINTBEGIN(readability-identifier-naming) */
+
+/** @internal Every node begins with this header. A leaf stores user types
+after the header. A branch stores separator copies of user types followed by
+pointers to its children. Leaves are linked to their neighbors in key order so
+scans never climb the tree. */
+struct CCC_Btree_map_node
+{
+    /** @internal The parent branch or NULL for the root. */
+    struct CCC_Btree_map_node *parent;
+    /** @internal Previous and next leaf in key order. Unused by branches. */
+    struct CCC_Btree_map_node *link[2];
+    /** @internal User types in a leaf or separators in a branch. */
+    uint32_t count;
+    /** @internal If this node stores user types rather than children. */
+    bool leaf;
+    /** @internal If this node was placed within a larger allocation because
+    the allocator ignored the alignment request. The address of the allocation
+    is stored in the word before the node. */
+    bool padded;
+};
+
+/** @internal A B+ tree storing copies of user types in wide leaves. Node size
+is fixed per map from the size of the user type so a lookup touches a few
+cache lines in each of very few nodes. */
+struct CCC_Btree_map
+{
+    /** @internal The root leaf or branch, NULL if empty. */
+    struct CCC_Btree_map_node *root;
+    /** @internal The first and last leaf in key order. */
+    struct CCC_Btree_map_node *ends[2];
+    /** @internal The count of stored user types. */
+    size_t count;
+    /** @internal The size of the user type. */
+    size_t sizeof_type;
+    /** @internal The byte offset of the key in the user type. */
+    size_t key_offset;
+    /** @internal The bytes and requested alignment of every node, 0 until the
+    first node is allocated. A power of two. */
+    size_t node_bytes;
+    /** @internal The most user types a leaf holds. */
+    uint32_t leaf_capacity;
+    /** @internal The most separators a branch holds. */
+    uint32_t branch_capacity;
+    /** @internal If the allocator returned a node that was not aligned to its
+    size. Every later node is then padded without asking for alignment. */
+    bool pad_nodes;
+    /** @internal The comparison function for three way comparison. */
+    CCC_Key_comparator *compare;
+    /** @internal An allocation function, if any. */
+    CCC_Allocator *allocate;
+    /** @internal Auxiliary data, if any. */
+    void *context;
+};
+
+/** @internal An entry is the position of the key in its leaf. If the key is
+absent this is the position it would be inserted at. */
+struct CCC_Btree_map_entry
+{
+    /** @internal The map associated with this query. */
+    struct CCC_Btree_map *map;
+    /** @internal The leaf holding or bounding the key, NULL if empty. */
+    struct CCC_Btree_map_node *leaf;
+    /** @internal The index of the key in the leaf or its insert position. */
+    size_t index;
+    /** @internal The stored user type if Occupied and the entry status. */
+    struct CCC_Entry entry;
+};
+
+/** @internal Enable return by compound literal reference on the stack. */
+union CCC_Btree_map_entry_wrap
+{
+    /** @internal The field containing the entry struct. */
+    struct CCC_Btree_map_entry private;
+};
+
+/*==========================   Initialization     ===========================*/
+
+/** @internal */
+#define CCC_private_btree_map_initialize(private_type_name,                    \
+                                         private_key_field_name,               \
+                                         private_key_order_fn,                 \
+                                         private_allocate, private_context)    \
+    {                                                                          \
+        .root = NULL,                                                          \
+        .ends = {NULL, NULL},                                                  \
+        .count = 0,                                                            \
+        .sizeof_type = sizeof(private_type_name),                              \
+        .key_offset = offsetof(private_type_name, private_key_field_name),     \
+        .node_bytes = 0,                                                       \
+        .leaf_capacity = 0,                                                    \
+        .branch_capacity = 0,                                                  \
+        .pad_nodes = false,                                                    \
+        .compare = (private_key_order_fn),                                     \
+        .allocate = (private_allocate),                                        \
+        .context = (private_context),                                          \
+    }
+
+/*==================     Core Macro Implementations     =====================*/
+
+/** @internal Writes a copy of the compound literal with its key set to the
+searched key to the entry. The copy is built only once insertion is known to
+be needed. */
+#define CCC_private_btree_map_insert_and_copy_key(                             \
+    Btree_map_entry, Btree_map_entry_ret, key, type_compound_literal...)       \
+    (__extension__({                                                           \
+        typeof(type_compound_literal) private_btree_map_new_ins                \
+            = type_compound_literal;                                           \
+        *((typeof(key) *)((char *)&private_btree_map_new_ins                   \
+                          + (Btree_map_entry).private.map->key_offset))        \
+            = key;                                                             \
+        void *const private_btree_map_new_ins_ret                              \
+            = CCC_btree_map_insert_entry(&(Btree_map_entry),                   \
+                                         &private_btree_map_new_ins);          \
+        Btree_map_entry_ret = (struct CCC_Entry){                              \
+            .type = private_btree_map_new_ins_ret,                             \
+            .status = !private_btree_map_new_ins_ret                           \
+                        ? CCC_ENTRY_INSERT_ERROR                               \
+                        : (Btree_map_entry).private.entry.status,              \
+        };                                                                     \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_and_modify_wrap(Btree_map_entry_pointer,         \
+                                              modify)                          \
+    (__extension__({                                                           \
+        union CCC_Btree_map_entry_wrap *const private_btree_map_mod_pointer    \
+            = CCC_btree_map_and_modify((Btree_map_entry_pointer), (modify));   \
+        private_btree_map_mod_pointer                                          \
+            ? private_btree_map_mod_pointer->private                           \
+            : (struct CCC_Btree_map_entry){                                    \
+                  .entry = {.status = CCC_ENTRY_ARGUMENT_ERROR},               \
+              };                                                               \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_and_modify_with(Btree_map_entry_pointer,         \
+                                              type_name, closure_over_T...)    \
+    (__extension__({                                                           \
+        __auto_type private_btree_map_ent_pointer = (Btree_map_entry_pointer); \
+        struct CCC_Btree_map_entry private_btree_map_mod_ent                   \
+            = {.entry = {.status = CCC_ENTRY_ARGUMENT_ERROR}};                 \
+        if (private_btree_map_ent_pointer)                                     \
+        {                                                                      \
+            private_btree_map_mod_ent                                          \
+                = private_btree_map_ent_pointer->private;                      \
+            if (private_btree_map_mod_ent.entry.status & CCC_ENTRY_OCCUPIED)   \
+            {                                                                  \
+                type_name *const T = private_btree_map_mod_ent.entry.type;     \
+                if (T)                                                         \
+                {                                                              \
+                    closure_over_T                                             \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+        private_btree_map_mod_ent;                                             \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_or_insert_with(Btree_map_entry_pointer,          \
+                                             type_compound_literal...)         \
+    (__extension__({                                                           \
+        __auto_type private_btree_map_or_ins_pointer                           \
+            = (Btree_map_entry_pointer);                                       \
+        typeof(type_compound_literal) *private_btree_map_or_ins_ret = NULL;    \
+        if (private_btree_map_or_ins_pointer)                                  \
+        {                                                                      \
+            if (private_btree_map_or_ins_pointer->private.entry.status         \
+                == CCC_ENTRY_OCCUPIED)                                         \
+            {                                                                  \
+                private_btree_map_or_ins_ret                                   \
+                    = private_btree_map_or_ins_pointer->private.entry.type;    \
+            }                                                                  \
+            else if (private_btree_map_or_ins_pointer->private.entry.status    \
+                     == CCC_ENTRY_VACANT)                                      \
+            {                                                                  \
+                typeof(type_compound_literal) private_btree_map_or_ins_new     \
+                    = type_compound_literal;                                   \
+                private_btree_map_or_ins_ret = CCC_btree_map_or_insert(        \
+                    private_btree_map_or_ins_pointer,                          \
+                    &private_btree_map_or_ins_new);                            \
+            }                                                                  \
+        }                                                                      \
+        private_btree_map_or_ins_ret;                                          \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_insert_entry_with(Btree_map_entry_pointer,       \
+                                                type_compound_literal...)      \
+    (__extension__({                                                           \
+        __auto_type private_btree_map_ins_pointer = (Btree_map_entry_pointer); \
+        typeof(type_compound_literal) *private_btree_map_ins_ret = NULL;       \
+        if (private_btree_map_ins_pointer                                      \
+            && !(private_btree_map_ins_pointer->private.entry.status           \
+                 & CCC_ENTRY_ARGUMENT_ERROR))                                  \
+        {                                                                      \
+            typeof(type_compound_literal) private_btree_map_ins_new            \
+                = type_compound_literal;                                       \
+            private_btree_map_ins_ret = CCC_btree_map_insert_entry(            \
+                private_btree_map_ins_pointer, &private_btree_map_ins_new);    \
+        }                                                                      \
+        private_btree_map_ins_ret;                                             \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_try_insert_with(Btree_map_pointer, key,          \
+                                              type_compound_literal...)        \
+    (__extension__({                                                           \
+        struct CCC_Btree_map *const private_btree_map_try_ins_map              \
+            = (Btree_map_pointer);                                             \
+        struct CCC_Entry private_btree_map_try_ins_ret                         \
+            = {.status = CCC_ENTRY_ARGUMENT_ERROR};                            \
+        if (private_btree_map_try_ins_map)                                     \
+        {                                                                      \
+            __auto_type private_btree_map_key = (key);                         \
+            union CCC_Btree_map_entry_wrap private_btree_map_try_ins_ent       \
+                = CCC_btree_map_entry(private_btree_map_try_ins_map,           \
+                                      &private_btree_map_key);                 \
+            if (private_btree_map_try_ins_ent.private.entry.status             \
+                == CCC_ENTRY_VACANT)                                           \
+            {                                                                  \
+                CCC_private_btree_map_insert_and_copy_key(                     \
+                    private_btree_map_try_ins_ent,                             \
+                    private_btree_map_try_ins_ret, private_btree_map_key,      \
+                    type_compound_literal);                                    \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                private_btree_map_try_ins_ret                                  \
+                    = private_btree_map_try_ins_ent.private.entry;             \
+            }                                                                  \
+        }                                                                      \
+        private_btree_map_try_ins_ret;                                         \
+    }))
+
+/** @internal */
+#define CCC_private_btree_map_insert_or_assign_with(Btree_map_pointer, key,    \
+                                                    type_compound_literal...)  \
+    (__extension__({                                                           \
+        struct CCC_Btree_map *const private_btree_map_ins_or_assign_map        \
+            = (Btree_map_pointer);                                             \
+        struct CCC_Entry private_btree_map_ins_or_assign_ret                   \
+            = {.status = CCC_ENTRY_ARGUMENT_ERROR};                            \
+        if (private_btree_map_ins_or_assign_map)                               \
+        {                                                                      \
+            __auto_type private_btree_map_key = (key);                         \
+            union CCC_Btree_map_entry_wrap private_btree_map_ins_or_assign_ent \
+                = CCC_btree_map_entry(private_btree_map_ins_or_assign_map,     \
+                                      &private_btree_map_key);                 \
+            CCC_private_btree_map_insert_and_copy_key(                         \
+                private_btree_map_ins_or_assign_ent,                           \
+                private_btree_map_ins_or_assign_ret, private_btree_map_key,    \
+                type_compound_literal);                                        \
+        }                                                                      \
+        private_btree_map_ins_or_assign_ret;                                   \
+    }))
+
+/* NOLINTEND(readability-identifier-naming) */
+
+#endif /* CCC_PRIVATE_BTREE_MAP_H */
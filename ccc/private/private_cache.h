@@ -0,0 +1,204 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_CACHE_H
+#define CCC_PRIVATE_CACHE_H
+
+/** @cond */
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_flat_hash_map.h"
+
+/** @internal The eviction policy chosen for the lifetime of a cache. */
+enum CCC_Cache_policy : uint8_t
+{
+    /** Evict the entry that was accessed least recently. */
+    CCC_CACHE_POLICY_LRU = 0,
+    /** Sweep a hand over the entries and evict the first one that has not
+    been accessed since the hand last passed it. */
+    CCC_CACHE_POLICY_CLOCK,
+    /** Admit new entries to a small queue, promote those accessed again to a
+    main queue, and remember recently evicted keys in a ghost table. */
+    CCC_CACHE_POLICY_S3_FIFO,
+};
+
+/** @internal The element of the index table. It names the position of one
+record in the record array. */
+struct CCC_Cache_slot
+{
+    /** The position of the record in the record array. */
+    uint32_t index;
+};
+
+/** @internal The recency information kept beside each record. Positions are
+32 bits so that a node costs 12 bytes per entry. */
+struct CCC_Cache_node
+{
+    /** The previous node in its queue, toward the head. */
+    uint32_t prev;
+    /** The next node in its queue, toward the tail, or the next free node. */
+    uint32_t next;
+    /** The queue holding the node or the mark of a free node. */
+    uint8_t queue;
+    /** The CLOCK reference bit or the S3-FIFO access count. */
+    uint8_t frequency;
+};
+
+/** @internal A FIFO or recency ordered list of nodes. New nodes enter at the
+head and victims leave from the tail. */
+struct CCC_Cache_queue
+{
+    /** The most recently inserted or accessed node. */
+    uint32_t head;
+    /** The node considered first for eviction. */
+    uint32_t tail;
+    /** The number of nodes in the queue. */
+    uint32_t count;
+};
+
+/** @internal A flat hash index over a fixed array of records with the
+recency state of each record in a parallel array of nodes. The index table is
+an ordinary flat hash map of record positions sized so it never needs to grow.
+A cache never holds more than its capacity of records. Inserting into a full
+cache first evicts a victim chosen by the policy and reuses its position. */
+struct CCC_Cache
+{
+    /** The flat hash map of slots. Its context is this cache. */
+    struct CCC_Flat_hash_map index;
+    /** The array of capacity user types. */
+    void *records;
+    /** The array of capacity nodes parallel to the records. */
+    struct CCC_Cache_node *nodes;
+    /** The S3-FIFO table of recently evicted hashes or NULL. */
+    uint64_t *ghosts;
+    /** The mask for a position in the ghost table. */
+    size_t ghost_mask;
+    /** The small and main queues. LRU uses only the first. */
+    struct CCC_Cache_queue queue[2];
+    /** The head of the list of positions freed by removal. */
+    uint32_t free;
+    /** The number of positions ever handed out. */
+    uint32_t end;
+    /** The number of records in the cache. */
+    uint32_t count;
+    /** The number of records the cache may hold. */
+    uint32_t capacity;
+    /** The position the CLOCK hand inspects next. */
+    uint32_t hand;
+    /** The size of the user type. */
+    size_t sizeof_type;
+    /** The byte offset of the key field in the user type. */
+    size_t key_offset;
+    /** The user hash function. */
+    CCC_Key_hasher *hash;
+    /** The user key comparison function. */
+    CCC_Key_comparator *compare;
+    /** The allocation function or NULL for a fixed size cache. */
+    CCC_Allocator *allocate;
+    /** The user context for hashing, comparison, and allocation. */
+    void *context;
+    /** The eviction policy. */
+    enum CCC_Cache_policy policy;
+};
+
+/*=========================    Fixed Storage    =============================*/
+
+/** @internal The checks on the capacity of every fixed cache type. */
+#define CCC_private_cache_fixed_asserts(capacity)                              \
+    static_assert((capacity) > 0,                                              \
+                  "fixed size cache must have capacity greater than 0");       \
+    static_assert((capacity) < UINT32_MAX,                                     \
+                  "fixed size cache must have capacity less than UINT32_MAX"); \
+    static_assert(((capacity) & ((capacity) - 1)) == 0,                        \
+                  "fixed size cache must be a power of 2 capacity");           \
+    static_assert(2 * (capacity) >= CCC_FLAT_HASH_MAP_GROUP_COUNT,             \
+                  "fixed size cache must have capacity >= half of "            \
+                  "CCC_FLAT_HASH_MAP_GROUP_COUNT (4 or 8 depending on "        \
+                  "platform)")
+
+/** @internal The arrays every fixed cache holds: its records, nodes, and an
+index table with twice as many slots as records. At most seven of every eight
+index slots may be filled so half full leaves room for the deleted slots that
+evictions leave behind before the table is rehashed in place. */
+#define CCC_private_cache_fixed_arrays(type_name, capacity)                    \
+    type_name records[(capacity)];                                             \
+    struct CCC_Cache_node nodes[(capacity)];                                   \
+    CCC_private_flat_hash_map_fixed_storage(struct CCC_Cache_slot,             \
+                                            2 * (capacity)) index
+
+/** @internal A fixed cache for the LRU and CLOCK policies. The ghost table is
+a flexible array that occupies no space so the initializer may still locate
+it and find it too small for S3-FIFO. */
+#define CCC_private_cache_declare_fixed(fixed_cache_type_name, type_name,      \
+                                        capacity)                              \
+    CCC_private_cache_fixed_asserts(capacity);                                 \
+    typedef struct                                                             \
+    {                                                                          \
+        CCC_private_cache_fixed_arrays(type_name, capacity);                   \
+        uint64_t ghosts[];                                                     \
+    }(fixed_cache_type_name)
+
+/** @internal A fixed cache that also holds the S3-FIFO ghost table of one
+hash per record. */
+#define CCC_private_cache_declare_fixed_s3_fifo(fixed_cache_type_name,         \
+                                                type_name, capacity)           \
+    CCC_private_cache_fixed_asserts(capacity);                                 \
+    typedef struct                                                             \
+    {                                                                          \
+        CCC_private_cache_fixed_arrays(type_name, capacity);                   \
+        uint64_t ghosts[(capacity)];                                           \
+    }(fixed_cache_type_name)
+
+/** @internal The capacity of records chosen for a fixed cache type. */
+#define CCC_private_cache_fixed_capacity(fixed_cache_type_name)                \
+    (sizeof((fixed_cache_type_name){}.nodes) / sizeof(struct CCC_Cache_node))
+
+/*======================     Private Interface      =========================*/
+
+/** @internal Initializes a cache for records of the given size and key offset.
+A NULL storage pointer requests arrays from the allocator. Otherwise storage
+is a fixed cache type, the offsets locate its arrays, and the last argument is
+the number of ghost hashes it holds. */
+CCC_Result CCC_private_cache_initialize(struct CCC_Cache *, size_t, size_t,
+                                        CCC_Key_hasher *, CCC_Key_comparator *,
+                                        enum CCC_Cache_policy, CCC_Allocator *,
+                                        void *, size_t, void *, size_t, size_t,
+                                        size_t, size_t);
+
+/** @internal Initializes a cache over the arrays of a fixed cache type. The
+storage pointer is evaluated once so compound literals are accepted. */
+#define CCC_private_cache_initialize_fixed(                                    \
+    private_cache_pointer, private_fixed_pointer, private_type_name,           \
+    private_key_field, private_hash, private_compare, private_policy,          \
+    private_context_data)                                                      \
+    CCC_private_cache_initialize(                                              \
+        (private_cache_pointer), sizeof(private_type_name),                    \
+        offsetof(private_type_name, private_key_field), (private_hash),        \
+        (private_compare), (private_policy), NULL, (private_context_data),     \
+        sizeof((typeof(*(private_fixed_pointer))){}.nodes)                     \
+            / sizeof(struct CCC_Cache_node),                                   \
+        (private_fixed_pointer), offsetof(typeof(*(private_fixed_pointer)),    \
+                                          nodes),                              \
+        offsetof(typeof(*(private_fixed_pointer)), ghosts),                    \
+        offsetof(typeof(*(private_fixed_pointer)), index),                     \
+        (sizeof(typeof(*(private_fixed_pointer)))                              \
+         - offsetof(typeof(*(private_fixed_pointer)), ghosts))                 \
+            / sizeof(uint64_t))
+
+#endif /* CCC_PRIVATE_CACHE_H */
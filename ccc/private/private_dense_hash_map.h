@@ -0,0 +1,87 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_DENSE_HASH_MAP_H
+#define CCC_PRIVATE_DENSE_HASH_MAP_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_buffer.h"
+#include "private_flat_hash_map.h"
+
+/** @internal The element of the index table. It names the position of one
+record in the dense record array. The full hash of the record is stored beside
+it by the index table so probes rarely need to visit the record. */
+struct CCC_Dense_hash_map_slot
+{
+    /** The position of the record in the record array. */
+    size_t index;
+};
+
+/** @internal A hash index over a dense array of records. The index table is an
+ordinary flat hash map of slots that stores hashes. Records are kept without
+gaps in insertion order until a removal moves the last record into the hole. */
+struct CCC_Dense_hash_map
+{
+    /** The flat hash map of slots. Its context is this map. */
+    struct CCC_Flat_hash_map index;
+    /** The user types stored contiguously. */
+    struct CCC_Buffer records;
+    /** The user hash of each record at the same position. */
+    struct CCC_Buffer hashes;
+    /** The byte offset of the key field in the user type. */
+    size_t key_offset;
+    /** The user hash function. */
+    CCC_Key_hasher *hash;
+    /** The user key comparison function. */
+    CCC_Key_comparator *compare;
+    /** The user allocation function. */
+    CCC_Allocator *allocate;
+    /** The user context for hashing, comparison, and allocation. */
+    void *context;
+};
+
+/** @internal An entry is the index table entry and the map it belongs to. */
+struct CCC_Dense_hash_map_entry
+{
+    /** The map associated with this entry. */
+    struct CCC_Dense_hash_map *map;
+    /** The entry of the index table. Occupied slots name a record. */
+    struct CCC_Flat_hash_map_entry slot;
+};
+
+/** @internal Wrapper to allow returning compound literal references. */
+union CCC_Dense_hash_map_entry_wrap
+{
+    /** @internal The wrapped entry. */
+    struct CCC_Dense_hash_map_entry private;
+};
+
+/*======================     Private Interface      =========================*/
+
+/** @internal Initializes the map for records of the given size and key
+offset. Reserves room for capacity records if it is non-zero. */
+CCC_Result CCC_private_dense_hash_map_initialize(struct CCC_Dense_hash_map *,
+                                                 size_t, size_t,
+                                                 CCC_Key_hasher *,
+                                                 CCC_Key_comparator *,
+                                                 CCC_Allocator *, void *,
+                                                 size_t);
+
+#endif /* CCC_PRIVATE_DENSE_HASH_MAP_H */
@@ -0,0 +1,116 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_FILTER_H
+#define CCC_PRIVATE_FILTER_H
+
+/** @cond */
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_types.h"
+
+/** @internal The layout of the blocks chosen for the lifetime of a filter. */
+enum CCC_Filter_kind : uint8_t
+{
+    /** Every block is 512 bits and a key sets one bit in each 64 bit word. */
+    CCC_FILTER_KIND_BLOOM = 0,
+    /** Every block is 128 four bit counters and a key increments one counter
+    in each 64 bit word. */
+    CCC_FILTER_KIND_COUNTING,
+};
+
+/** @internal The shape of one block. A block is one cache line so a key
+touches exactly one line of memory for any operation. */
+enum : size_t
+{
+    /** The 64 bit words in a block. A key selects one bit or counter in each
+    word. */
+    CCC_PRIVATE_FILTER_BLOCK_WORDS = 8,
+};
+
+/** @internal One cache line of the filter. The type is not over aligned so
+that a block array from an allocator that ignored the alignment request is
+still valid. Fixed filters align their array explicitly. */
+struct CCC_Filter_block
+{
+    /** The bits or counters of the block. */
+    uint64_t words[CCC_PRIVATE_FILTER_BLOCK_WORDS];
+};
+
+/** @internal A blocked Bloom or counting filter over a power of two number of
+blocks. */
+struct CCC_Filter
+{
+    /** The array of blocks, allocated or provided by a fixed filter type. */
+    struct CCC_Filter_block *blocks;
+    /** The number of blocks, a power of two or 0 before initialization. */
+    size_t block_count;
+    /** Insertions less removals. */
+    size_t count;
+    /** The user hash function. */
+    CCC_Key_hasher *hash;
+    /** The allocation function or NULL for a fixed size filter. */
+    CCC_Allocator *allocate;
+    /** The user context for hashing and allocation. */
+    void *context;
+    /** The block layout. */
+    enum CCC_Filter_kind kind;
+};
+
+/*=========================    Fixed Storage    =============================*/
+
+/** @internal A fixed filter is its array of blocks aligned to a cache line. */
+#define CCC_private_filter_declare_fixed(fixed_filter_type_name, block_count)  \
+    static_assert((block_count) > 0,                                           \
+                  "fixed size filter must have block count greater than 0");   \
+    static_assert(((block_count) & ((block_count) - 1)) == 0,                  \
+                  "fixed size filter must be a power of 2 block count");       \
+    typedef struct                                                             \
+    {                                                                          \
+        alignas(CCC_PRIVATE_CACHE_LINE_ALIGN)                                  \
+            struct CCC_Filter_block blocks[(block_count)];                     \
+    }(fixed_filter_type_name)
+
+/** @internal The block count chosen for a fixed filter type. */
+#define CCC_private_filter_fixed_block_count(fixed_filter_type_name)           \
+    (sizeof((fixed_filter_type_name){}.blocks)                                 \
+     / sizeof(struct CCC_Filter_block))
+
+/*======================     Private Interface      =========================*/
+
+/** @internal Initializes a filter over the given blocks. A NULL storage
+pointer requests block_count blocks from the allocator. */
+CCC_Result CCC_private_filter_initialize(struct CCC_Filter *,
+                                         enum CCC_Filter_kind, CCC_Key_hasher *,
+                                         CCC_Allocator *, void *, void *,
+                                         size_t);
+
+/** @internal Initializes a filter over the blocks of a fixed filter type. The
+storage pointer is evaluated once so compound literals are accepted. */
+#define CCC_private_filter_initialize_fixed(private_filter_pointer,            \
+                                            private_fixed_pointer,             \
+                                            private_kind, private_hash,        \
+                                            private_context_data)              \
+    CCC_private_filter_initialize(                                             \
+        (private_filter_pointer), (private_kind), (private_hash), NULL,        \
+        (private_context_data), (private_fixed_pointer),                       \
+        sizeof((typeof(*(private_fixed_pointer))){}.blocks)                    \
+            / sizeof(struct CCC_Filter_block))
+
+#endif /* CCC_PRIVATE_FILTER_H */
@@ -38,9 +38,11 @@ most complexity in the implementation. */
 #include <stdalign.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 /** @endcond */
 
 #include "../types.h"
+#include "private_hash.h"
 #include "private_types.h"
 
 /* NOLINTBEGIN(readability-identifier-naming) */
@@ -50,16 +52,17 @@ and used the source code during all the platform based implementations. */
 #if defined(__x86_64) && defined(__SSE2__)                                     \
     && !defined(CCC_FLAT_HASH_MAP_PORTABLE)
 /** @internal Internal container collection detection for SIMD instructions on
-the x86 architectures. This will be the most efficient version possible
-offering the widest group matching. */
+the x86 architectures. Every x86-64 processor scans groups of 16 tags with
+SSE2. The library also carries AVX2 and AVX-512BW versions of the group scans
+and a dynamic map picks the widest one the processor supports when it first
+allocates, so one build runs on any x86-64 processor. */
 #    define CCC_HAS_X86_SIMD
 #elif defined(__ARM_NEON__) && !defined(CCC_FLAT_HASH_MAP_PORTABLE)
 /** @internal Internal container collection detection for SIMD instructions on
 the NEON architecture. This implementation currently lacks some of the features
 of the x86 SIMD version but should still be fast. */
 #    define CCC_HAS_ARM_SIMD
-#endif /* defined(__x86_64)&&defined(__SSE2__)&&!defined(CCC_FLAT_HASH_MAP_PORTABLE) \
-        */
+#endif /* defined(__x86_64) && defined(__SSE2__) && ... */
 /** else we define nothing and the portable fallback will take effect. */
 
 /** @internal An array of this byte will be in the tag array. Same idea as
@@ -87,21 +90,70 @@ struct CCC_Flat_hash_map_tag
 fallback of 8 is good for a portable implementation that will use the widest
 word on a platform for group scanning. Right now, this lib targets 64-bit so
 that means uint64_t is widest default integer widely supported. That width
-is still valid on 32-bit but probably very slow due to emulation. */
+is still valid on 32-bit but probably very slow due to emulation.
+
+The group count is the width every processor of the platform scans and the
+width of every fixed size map, whose layout is decided at compile time. A
+dynamic map on x86 may scan wider groups, which it records at runtime. */
 enum : typeof((struct CCC_Flat_hash_map_tag){}.v)
 {
 #ifdef CCC_HAS_X86_SIMD
     /** A group of tags that can be loaded into a 128 bit vector. */
     CCC_FLAT_HASH_MAP_GROUP_COUNT = 16,
+    /** A group of tags that can be loaded into a 512 bit vector. */
+    CCC_FLAT_HASH_MAP_MAX_GROUP_COUNT = 64,
 #elifdef CCC_HAS_ARM_SIMD
     /** A group of tags that can be loded into a 64 bit integer. */
     CCC_FLAT_HASH_MAP_GROUP_COUNT = 8,
+    /** NEON scans one width. */
+    CCC_FLAT_HASH_MAP_MAX_GROUP_COUNT = 8,
 #else  /* PORTABLE FALLBACK */
     /** A group of tags that can be loded into a 64 bit integer. */
     CCC_FLAT_HASH_MAP_GROUP_COUNT = 8,
+    /** The portable fallback scans one width. */
+    CCC_FLAT_HASH_MAP_MAX_GROUP_COUNT = 8,
 #endif /* defined(CCC_HAS_X86_SIMD) */
 };
 
+/** @internal Options fixed at initialization that change how the map stores
+its data. These are bit flags and may be combined. */
+enum CCC_Flat_hash_map_option : uint8_t
+{
+    /** The default map stores only user data and one byte tags. */
+    CCC_FLAT_HASH_MAP_OPTION_NONE = 0,
+    /** A full 64 bit hash is stored for every slot in an array after the tags.
+    Rehashing never calls the user hash function and the full hash is compared
+    before the user comparison function is called. */
+    CCC_FLAT_HASH_MAP_OPTION_STORE_HASH = 1 << 0,
+    /** Growing a map allocates the larger table but leaves the elements in the
+    previous table. Each later modification moves a bounded number of groups
+    and searches consult both tables until the previous table is empty. Only
+    takes effect for maps with an allocation function. */
+    CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE = 1 << 1,
+    /** Every hash returned by the user hash function is passed through a
+    finalizer before it is used to select groups and tags. */
+    CCC_FLAT_HASH_MAP_OPTION_MIX_HASH = 1 << 2,
+};
+
+/** @internal The previous table of a map that is growing incrementally. The
+previous table keeps the same layout it had before the resize began. Elements
+leave it in group order from next, or earlier if a modification finds them
+first, and their tags are marked deleted so probing of the remaining elements
+is unchanged. The data is NULL when no resize is in progress. */
+struct CCC_Flat_hash_map_migration
+{
+    /** The base of the previous allocation. */
+    void *data;
+    /** The tag array of the previous allocation. */
+    struct CCC_Flat_hash_map_tag *tag;
+    /** The mask of the previous table. */
+    size_t mask;
+    /** The number of elements that remain in the previous table. */
+    size_t count;
+    /** The aligned index of the next group of the previous table to move. */
+    size_t next;
+};
+
 /** @internal The layout of the map uses only pointers to account for the
 possibility of memory provided from the data segment, stack, or heap. When the
 map is allowed to allocate it will take care of aligning pointers appropriately.
@@ -132,6 +184,19 @@ a fixed or dynamic map, we must assume data starts at the base address and that
 there may be zero or more bytes of padding between the data and tag arrays for
 alignment.
 
+If the map stores hashes, an array of one 64 bit hash per slot follows the
+replica group. The tag array and replica group are always a multiple of 8 bytes
+so the hash array is naturally aligned without any padding.
+
+┌───┬───┬───┬────┬───┬───┬───┬───┬───┬───┬───┬───┐
+│D_0│...│D_N│Swap│T_0│...│T_N│R_0│...│H_0│...│H_N│
+└───┴───┴───┴────┴───┴───┴───┴───┴───┴─┬─┴───┴───┘
+                                       │
+                           ┌───────────┴───────────┐
+                           │Stored hash of D_0 when│
+                           │the option is enabled. │
+                           └───────────────────────┘
+
 We may lose some of the assembly optimizations in indexing that Rust's table
 gets by adding and subtracting from a shared base address. However, this table
 still needs to use byte offset multiplication because the data is stored as
@@ -162,6 +227,55 @@ struct CCC_Flat_hash_map
     CCC_Allocator *allocate;
     /** Auxiliary data, if any. */
     void *context;
+    /** Layout and behavior options chosen at initialization. */
+    enum CCC_Flat_hash_map_option options;
+    /** The number of tags scanned in one probe. A fixed size map was laid out
+    for CCC_FLAT_HASH_MAP_GROUP_COUNT and keeps it. A dynamic map picks the
+    widest group the processor scans when it first allocates. */
+    uint8_t group_count;
+    /** If the table is served from the memory of a loaded snapshot, which
+    may be mapped without write permission. Every modification fails. */
+    bool read_only;
+    /** The previous table while an incremental resize is in progress. */
+    struct CCC_Flat_hash_map_migration migration;
+    /** Removals shrink the table to fit when the count falls below the
+    capacity divided by this. Zero disables shrinking. */
+    size_t shrink_denominator;
+};
+
+/** @internal The header written before the table of a snapshot. Every field
+is 64 bits wide so the header has no padding and the same layout from any
+compiler on one architecture. Its size is also the alignment required of the
+snapshot memory, so the table that follows is aligned for group loads and any
+user type. */
+struct CCC_Flat_hash_map_snapshot_header
+{
+    /** Identifies a snapshot and the byte order it was written in. */
+    uint64_t magic;
+    /** The version of this header and the table layout. */
+    uint64_t version;
+    /** The alignment required of the snapshot memory. */
+    uint64_t alignment;
+    /** The group width of the table, which decides its layout. */
+    uint64_t group_count;
+    /** The mask of the table, zero if no table was allocated. */
+    uint64_t mask;
+    /** The number of elements in the table. */
+    uint64_t count;
+    /** The empty slots that may be used before a rehash. */
+    uint64_t remain;
+    /** The size of the user type. */
+    uint64_t sizeof_type;
+    /** The offset of the key in the user type. */
+    uint64_t key_offset;
+    /** The options that change the table layout or hashes. */
+    uint64_t options;
+    /** The user identifier of the hash function and seed. */
+    uint64_t hash_id;
+    /** The bytes of the table following this header. */
+    uint64_t table_bytes;
+    /** Room for later versions, written as zero. */
+    uint64_t reserved[4];
 };
 
 /** @internal A struct for containing all relevant information for a query
@@ -172,8 +286,8 @@ struct CCC_Flat_hash_map_entry
     struct CCC_Flat_hash_map *map;
     /** The index in the data/tag array of this entry. */
     size_t index;
-    /** The saved tag from the current query hash value. */
-    struct CCC_Flat_hash_map_tag tag;
+    /** The saved hash of the query from which the tag is derived. */
+    uint64_t hash;
     /** The status of this entry. */
     enum CCC_Entry_status status;
 };
@@ -195,20 +309,224 @@ union CCC_Flat_hash_map_entry_wrap
 /** @internal */
 struct CCC_Flat_hash_map_entry
 CCC_private_flat_hash_map_entry(struct CCC_Flat_hash_map *, void const *);
+/** @internal Returns the hash the map uses for key, including any mix. */
+uint64_t CCC_private_flat_hash_map_hash(struct CCC_Flat_hash_map const *,
+                                        void const *);
+/** @internal Obtains an entry with a hash already computed by
+CCC_private_flat_hash_map_hash so that wrappers hash each key once. */
+struct CCC_Flat_hash_map_entry
+CCC_private_flat_hash_map_entry_with_hash(struct CCC_Flat_hash_map *,
+                                          void const *, uint64_t);
+/** @internal Read only search with a precomputed hash. NULL if absent. */
+void *
+CCC_private_flat_hash_map_find_with_hash(struct CCC_Flat_hash_map const *,
+                                         void const *, uint64_t);
+/** @internal Removal with a precomputed hash. Writes the element out. */
+CCC_Entry CCC_private_flat_hash_map_remove_with_hash(struct CCC_Flat_hash_map *,
+                                                     void *, uint64_t);
 /** @internal */
 void CCC_private_flat_hash_map_insert(struct CCC_Flat_hash_map *, void const *,
-                                      struct CCC_Flat_hash_map_tag, size_t);
+                                      uint64_t, size_t);
 /** @internal */
 void CCC_private_flat_hash_map_erase(struct CCC_Flat_hash_map *, size_t);
+/** @internal Inserts a copy of the type in the first free slot of its probe
+sequence without searching for an equal key. NULL if there is no room. */
+void *CCC_private_flat_hash_map_insert_duplicate(struct CCC_Flat_hash_map *,
+                                                 void const *, uint64_t);
+/** @internal Counts every element equal to key in one probe, writing up to
+the given capacity of references to them in probe order. */
+size_t CCC_private_flat_hash_map_find_matches(struct CCC_Flat_hash_map const *,
+                                              void const *, uint64_t, void *[],
+                                              size_t);
+/** @internal Erases every element equal to key in one probe, destroying each
+first if a destructor is given. Returns the number erased. */
+size_t CCC_private_flat_hash_map_erase_matches(struct CCC_Flat_hash_map *,
+                                               void const *, uint64_t,
+                                               CCC_Type_destructor *);
 /** @internal */
 void *CCC_private_flat_hash_map_data_at(struct CCC_Flat_hash_map const *,
                                         size_t);
 /** @internal */
 void *CCC_private_flat_hash_map_key_at(struct CCC_Flat_hash_map const *,
                                        size_t);
+/** @internal Returns the bytes of a table allocation with the given mask for
+the type and options of the map. */
+size_t CCC_private_flat_hash_map_table_bytes(struct CCC_Flat_hash_map const *,
+                                             size_t);
 /** @internal */
 void
 CCC_private_flat_hash_map_set_insert(struct CCC_Flat_hash_map_entry const *);
+/** @internal Points the map at the table of a snapshot after checking the
+header against the type described by the prototype map. */
+CCC_Result CCC_private_flat_hash_map_load_snapshot_table(
+    struct CCC_Flat_hash_map *, struct CCC_Flat_hash_map, uint64_t, void const *,
+    size_t);
+
+/*====================   Specialized Inline Probing   ======================*/
+
+/** @internal The constant tags, repeated here for the specialized probes that
+are compiled into user code. The source asserts they match its own. */
+enum : typeof((struct CCC_Flat_hash_map_tag){}.v)
+{
+    /** @internal A removed slot that probes must continue past. */
+    CCC_PRIVATE_FLAT_HASH_MAP_TAG_DELETED = 0x80,
+    /** @internal A slot that has never held an element since the last
+    rehash. Probes stop at a group containing one. */
+    CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY = 0xFF,
+};
+
+/** @internal Returns the hash the map uses for a user hash, including the
+optional finalizer. */
+static inline uint64_t
+CCC_private_flat_hash_map_specialized_mix(
+    struct CCC_Flat_hash_map const *const map, uint64_t const hash)
+{
+    return (map->options & CCC_FLAT_HASH_MAP_OPTION_MIX_HASH)
+             ? CCC_private_hash_mix(hash)
+             : hash;
+}
+
+/** @internal The tag fingerprint is the top 7 bits of the hash. */
+static inline uint8_t
+CCC_private_flat_hash_map_specialized_tag(uint64_t const hash)
+{
+    return (uint8_t)(hash >> 57);
+}
+
+/** @internal The specialized probes only handle a table that is allocated,
+not moving elements from a previous table, and not shrinking on removal. Every
+other case is left to the library. */
+static inline bool
+CCC_private_flat_hash_map_specialized_ready(
+    struct CCC_Flat_hash_map const *const map)
+{
+    return map->data && map->tag && !map->migration.data;
+}
+
+/** @internal Returns a mask with bit i on if tag i of the group equals the
+tag. The group is as wide as the map records, which the probe must follow to
+visit the same slots as the library. The loop has no early exit so the
+compiler may still vectorize it. */
+static inline uint64_t
+CCC_private_flat_hash_map_specialized_match(
+    struct CCC_Flat_hash_map_tag const *const group, uint8_t const tag,
+    size_t const group_count)
+{
+    uint64_t m = 0;
+    for (size_t i = 0; i < group_count; ++i)
+    {
+        m |= (uint64_t)(group[i].v == tag) << i;
+    }
+    return m;
+}
+
+/** @internal Returns a mask with bit i on if tag i of the group is empty or
+deleted and therefore available for insertion. */
+static inline uint64_t
+CCC_private_flat_hash_map_specialized_match_available(
+    struct CCC_Flat_hash_map_tag const *const group, size_t const group_count)
+{
+    uint64_t m = 0;
+    for (size_t i = 0; i < group_count; ++i)
+    {
+        m |= (uint64_t)(group[i].v >> 7) << i;
+    }
+    return m;
+}
+
+/** @internal Returns the index of the lowest on bit of a non-zero mask. */
+static inline size_t
+CCC_private_flat_hash_map_specialized_lowest(uint64_t const m)
+{
+#if defined(__has_builtin) && __has_builtin(__builtin_ctzll)
+    return (size_t)__builtin_ctzll(m);
+#else
+    size_t i = 0;
+    while (!((m >> i) & 1))
+    {
+        ++i;
+    }
+    return i;
+#endif
+}
+
+/** @internal Returns the stored hash array of a map storing hashes. It follows
+the tag array and its replica group. */
+static inline uint64_t *
+CCC_private_flat_hash_map_specialized_hashes(
+    struct CCC_Flat_hash_map const *const map)
+{
+    return (uint64_t *)(void *)((char *)map->tag + map->mask + 1
+                                + map->group_count);
+}
+
+/** @internal Rules out slot i by its stored hash, if the map stores hashes,
+before the key comparison. */
+static inline bool
+CCC_private_flat_hash_map_specialized_hash_equal(
+    struct CCC_Flat_hash_map const *const map, uint64_t const hash,
+    size_t const i)
+{
+    return !(map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+        || CCC_private_flat_hash_map_specialized_hashes(map)[i] == hash;
+}
+
+/** @internal Writes the tag of slot i and its replica if i is in the first
+group. */
+static inline void
+CCC_private_flat_hash_map_specialized_tag_set(
+    struct CCC_Flat_hash_map *const map, uint8_t const tag, size_t const i)
+{
+    map->tag[i].v = tag;
+    map->tag[((i - map->group_count) & map->mask) + map->group_count].v = tag;
+}
+
+/** @internal Claims the empty or deleted slot i for the hash. The caller
+copies the element. */
+static inline void
+CCC_private_flat_hash_map_specialized_claim(struct CCC_Flat_hash_map *const map,
+                                            uint64_t const hash, size_t const i)
+{
+    map->remain -= (map->tag[i].v == CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY);
+    ++map->count;
+    CCC_private_flat_hash_map_specialized_tag_set(
+        map, CCC_private_flat_hash_map_specialized_tag(hash), i);
+    if (map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+    {
+        CCC_private_flat_hash_map_specialized_hashes(map)[i] = hash;
+    }
+}
+
+/** @internal Frees slot i with the same rule as the library. The slot may be
+empty only if no group load that includes it sees a full run of occupied or
+deleted tags, otherwise a probe could stop before reaching a displaced key. */
+static inline void
+CCC_private_flat_hash_map_specialized_erase(struct CCC_Flat_hash_map *const map,
+                                            size_t const i)
+{
+    size_t const mask = map->mask;
+    size_t const group_count = map->group_count;
+    size_t before = 0;
+    while (before < group_count
+           && map->tag[(i - 1 - before) & mask].v
+                  != CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY)
+    {
+        ++before;
+    }
+    size_t after = 0;
+    while (after < group_count
+           && map->tag[(i + after) & mask].v
+                  != CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY)
+    {
+        ++after;
+    }
+    uint8_t const tag = before + after >= group_count
+                          ? CCC_PRIVATE_FLAT_HASH_MAP_TAG_DELETED
+                          : CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY;
+    map->remain += (tag == CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY);
+    --map->count;
+    CCC_private_flat_hash_map_specialized_tag_set(map, tag, i);
+}
 
 /*======================    Macro Implementations   =========================*/
 
@@ -228,6 +546,38 @@ Finally, we must align the tag array to start on an aligned group size byte
 boundary to be able to perform aligned loads and stores. */
 #define CCC_private_flat_hash_map_declare_fixed(fixed_map_type_name,           \
                                                 key_val_type_name, capacity)   \
+    CCC_private_flat_hash_map_assert_fixed_capacity(capacity);                 \
+    typedef CCC_private_flat_hash_map_fixed_storage(key_val_type_name,         \
+                                                    capacity)                  \
+    (fixed_map_type_name)
+
+/** @internal The unnamed struct laid out as a fixed size map. Containers built
+on a flat hash map embed it as a member of their own fixed size types. The
+capacity requirements are checked by whoever declares the enclosing type. */
+#define CCC_private_flat_hash_map_fixed_storage(key_val_type_name, capacity)   \
+    struct                                                                     \
+    {                                                                          \
+        key_val_type_name data[(capacity) + 1];                                \
+        alignas(CCC_FLAT_HASH_MAP_GROUP_COUNT) struct CCC_Flat_hash_map_tag    \
+            tag[(capacity) + CCC_FLAT_HASH_MAP_GROUP_COUNT];                   \
+    }
+
+/** @internal The same fixed size map with the array of stored hashes after
+the tag array. The tag array length is a multiple of 8 and begins on a group
+aligned boundary so the hash array follows with no padding. */
+#define CCC_private_flat_hash_map_declare_fixed_stored_hash(                   \
+    fixed_map_type_name, key_val_type_name, capacity)                          \
+    CCC_private_flat_hash_map_assert_fixed_capacity(capacity);                 \
+    typedef struct                                                             \
+    {                                                                          \
+        key_val_type_name data[(capacity) + 1];                                \
+        alignas(CCC_FLAT_HASH_MAP_GROUP_COUNT) struct CCC_Flat_hash_map_tag    \
+            tag[(capacity) + CCC_FLAT_HASH_MAP_GROUP_COUNT];                   \
+        uint64_t hash[(capacity)];                                             \
+    }(fixed_map_type_name)
+
+/** @internal The capacity requirements shared by every fixed size map. */
+#define CCC_private_flat_hash_map_assert_fixed_capacity(capacity)              \
     static_assert((capacity) > 0,                                              \
                   "fixed size map must have capacity greater than 0");         \
     static_assert(                                                             \
@@ -236,13 +586,7 @@ boundary to be able to perform aligned loads and stores. */
         "(8 or 16 depending on platform)");                                    \
     static_assert(((capacity) & ((capacity) - 1)) == 0,                        \
                   "fixed size map must be a power of 2 capacity (32, 64, "     \
-                  "128, 256, etc.)");                                          \
-    typedef struct                                                             \
-    {                                                                          \
-        key_val_type_name data[(capacity) + 1];                                \
-        alignas(CCC_FLAT_HASH_MAP_GROUP_COUNT) struct CCC_Flat_hash_map_tag    \
-            tag[(capacity) + CCC_FLAT_HASH_MAP_GROUP_COUNT];                   \
-    }(fixed_map_type_name)
+                  "128, 256, etc.)")
 
 /** @internal If the user does not want to remember the capacity they chose
 for their type or make mistakes this macro offers consistent calculation of
@@ -277,6 +621,17 @@ fixed size and has data or is dynamic and has not yet been given allocation. */
     private_fixed_map_pointer, private_type_name, private_key_field,           \
     private_hash, private_key_compare, private_allocate, private_context_data, \
     private_capacity)                                                          \
+    CCC_private_flat_hash_map_initialize_with_options(                         \
+        private_fixed_map_pointer, private_type_name, private_key_field,       \
+        private_hash, private_key_compare, private_allocate,                   \
+        private_context_data, private_capacity, CCC_FLAT_HASH_MAP_OPTION_NONE)
+
+/** @internal The full initializer with the user chosen options. Options are
+fixed for the lifetime of the map because they may change its layout. */
+#define CCC_private_flat_hash_map_initialize_with_options(                     \
+    private_fixed_map_pointer, private_type_name, private_key_field,           \
+    private_hash, private_key_compare, private_allocate, private_context_data, \
+    private_capacity, private_options)                                         \
     {                                                                          \
         .data = (private_fixed_map_pointer),                                   \
         .tag = NULL,                                                           \
@@ -291,8 +646,29 @@ fixed size and has data or is dynamic and has not yet been given allocation. */
         .hash = (private_hash),                                                \
         .allocate = (private_allocate),                                        \
         .context = (private_context_data),                                     \
+        .options = (private_options),                                          \
+        .group_count = CCC_FLAT_HASH_MAP_GROUP_COUNT,                          \
+        .read_only = false,                                                    \
+        .migration = {},                                                       \
+        .shrink_denominator = 0,                                               \
     }
 
+/** @internal Describes the type with an empty map and hands it to the runtime
+loader, which takes the layout options from the snapshot header. */
+#define CCC_private_flat_hash_map_load_snapshot(                               \
+    private_map_pointer, private_type_name, private_key_field, private_hash,   \
+    private_key_compare, private_context_data, private_hash_id,                \
+    private_snapshot_pointer, private_snapshot_bytes)                          \
+    CCC_private_flat_hash_map_load_snapshot_table(                             \
+        (private_map_pointer),                                                 \
+        (struct CCC_Flat_hash_map)                                             \
+            CCC_private_flat_hash_map_initialize_with_options(                 \
+                NULL, private_type_name, private_key_field, private_hash,      \
+                private_key_compare, NULL, private_context_data, 0,            \
+                CCC_FLAT_HASH_MAP_OPTION_NONE),                                \
+        (private_hash_id), (private_snapshot_pointer),                         \
+        (private_snapshot_bytes))
+
 /** @internal Initialize  dynamic container with a compound literal array. */
 #define CCC_private_flat_hash_map_from(                                        \
     private_key_field, private_hash, private_key_compare, private_allocate,    \
@@ -338,6 +714,22 @@ fixed size and has data or is dynamic and has not yet been given allocation. */
         private_map;                                                           \
     }))
 
+/** @internal Initialize a dynamic container from the elements of a Buffer. */
+#define CCC_private_flat_hash_map_from_buffer(                                 \
+    private_type_name, private_key_field, private_hash, private_key_compare,   \
+    private_allocate, private_context_data, private_buffer_pointer,            \
+    private_keys_unique)                                                       \
+    (__extension__({                                                           \
+        struct CCC_Flat_hash_map private_map                                   \
+            = CCC_private_flat_hash_map_initialize(                            \
+                NULL, private_type_name, private_key_field, private_hash,      \
+                private_key_compare, private_allocate, private_context_data,   \
+                0);                                                            \
+        (void)CCC_flat_hash_map_extend(&private_map, (private_buffer_pointer), \
+                                       (private_keys_unique));                 \
+        private_map;                                                           \
+    }))
+
 /** @internal Initializes the flat hash map with the specified capacity. */
 #define CCC_private_flat_hash_map_with_capacity(                               \
     private_type_name, private_key_field, private_hash, private_key_compare,   \
@@ -380,6 +772,11 @@ fixed size and has data or is dynamic and has not yet been given allocation. */
         .hash = (private_hash),                                                \
         .allocate = NULL,                                                      \
         .context = NULL,                                                       \
+        .options = CCC_FLAT_HASH_MAP_OPTION_NONE,                              \
+        .group_count = CCC_FLAT_HASH_MAP_GROUP_COUNT,                          \
+        .read_only = false,                                                    \
+        .migration = {},                                                       \
+        .shrink_denominator = 0,                                               \
     }
 
 /** @internal We can cut out boilerplate by assuming fixed size map. */
@@ -409,6 +806,11 @@ fixed size and has data or is dynamic and has not yet been given allocation. */
         .hash = (private_hash),                                                \
         .allocate = NULL,                                                      \
         .context = (private_context),                                          \
+        .options = CCC_FLAT_HASH_MAP_OPTION_NONE,                              \
+        .group_count = CCC_FLAT_HASH_MAP_GROUP_COUNT,                          \
+        .read_only = false,                                                    \
+        .migration = {},                                                       \
+        .shrink_denominator = 0,                                               \
     }
 
 /*========================    Construct In Place    =========================*/
@@ -609,6 +1011,222 @@ Similar to insert entry this will overwrite. */
         private_flat_hash_map_insert_or_assign_res;                            \
     }))
 
+/** @internal Generates the probe for a key as a statement expression so that
+the comparison is inlined. It evaluates to the slot of the key or, if the key
+is absent, to SIZE_MAX with the first available slot written to the optional
+slot pointer. The map must be ready for specialized probing and have at least
+one empty slot. */
+#define CCC_private_flat_hash_map_specialized_probe(                           \
+    private_map, private_type_name, private_key_field, private_equal,          \
+    private_key, private_hash, private_slot)                                   \
+    (__extension__({                                                           \
+        size_t const private_mask = (private_map)->mask;                       \
+        size_t const private_group_count = (private_map)->group_count;         \
+        uint8_t const private_tag                                              \
+            = CCC_private_flat_hash_map_specialized_tag(private_hash);         \
+        size_t private_index = (private_hash) & private_mask;                  \
+        size_t private_stride = 0;                                             \
+        size_t private_found = SIZE_MAX;                                       \
+        size_t *const private_available = (private_slot);                      \
+        if (private_available)                                                 \
+        {                                                                      \
+            *private_available = SIZE_MAX;                                     \
+        }                                                                      \
+        for (;;)                                                               \
+        {                                                                      \
+            struct CCC_Flat_hash_map_tag const *const private_group            \
+                = &(private_map)->tag[private_index];                          \
+            uint64_t private_m = CCC_private_flat_hash_map_specialized_match(  \
+                private_group, private_tag, private_group_count);              \
+            while (private_m)                                                  \
+            {                                                                  \
+                size_t const private_j                                         \
+                    = (private_index                                           \
+                       + CCC_private_flat_hash_map_specialized_lowest(         \
+                           private_m))                                         \
+                    & private_mask;                                            \
+                private_m &= private_m - 1;                                    \
+                if (CCC_private_flat_hash_map_specialized_hash_equal(          \
+                        (private_map), (private_hash), private_j)              \
+                    && private_equal(                                          \
+                        (private_key),                                         \
+                        &((private_type_name *)(private_map)->data)[private_j] \
+                             .private_key_field))                              \
+                {                                                              \
+                    private_found = private_j;                                 \
+                    break;                                                     \
+                }                                                              \
+            }                                                                  \
+            if (private_found != SIZE_MAX)                                     \
+            {                                                                  \
+                break;                                                         \
+            }                                                                  \
+            uint64_t const private_open                                        \
+                = CCC_private_flat_hash_map_specialized_match_available(       \
+                    private_group, private_group_count);                       \
+            if (private_available && *private_available == SIZE_MAX            \
+                && private_open)                                               \
+            {                                                                  \
+                *private_available                                             \
+                    = (private_index                                           \
+                       + CCC_private_flat_hash_map_specialized_lowest(         \
+                           private_open))                                      \
+                    & private_mask;                                            \
+            }                                                                  \
+            if (CCC_private_flat_hash_map_specialized_match(                   \
+                    private_group, CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY,        \
+                    private_group_count))                                      \
+            {                                                                  \
+                break;                                                         \
+            }                                                                  \
+            private_stride += private_group_count;                             \
+            private_index = (private_index + private_stride) & private_mask;   \
+        }                                                                      \
+        private_found;                                                         \
+    }))
+
+/** @internal Emits the specialized functions. Each hashes and compares keys
+with direct calls and indexes the data array with the constant element size.
+Whenever the map is not ready for specialized probing, or an insertion could
+trigger a rehash, or a removal could trigger a shrink, the function forwards to
+the library with the hash it has already computed. */
+#define CCC_private_flat_hash_map_specialize(private_name, private_type_name,  \
+                                             private_key_field, private_hash,  \
+                                             private_equal)                    \
+    [[maybe_unused]] static inline private_type_name                           \
+        *private_name##_get_key_value(                                         \
+            struct CCC_Flat_hash_map const *const private_map,                 \
+            typeof(((private_type_name *)NULL)->private_key_field) const       \
+                *const private_key)                                            \
+    {                                                                          \
+        if (!private_map || !private_key)                                      \
+        {                                                                      \
+            return NULL;                                                       \
+        }                                                                      \
+        uint64_t const private_h = CCC_private_flat_hash_map_specialized_mix(  \
+            private_map, private_hash(private_key));                           \
+        if (!CCC_private_flat_hash_map_specialized_ready(private_map))         \
+        {                                                                      \
+            return CCC_private_flat_hash_map_find_with_hash(                   \
+                private_map, private_key, private_h);                          \
+        }                                                                      \
+        size_t const private_i = CCC_private_flat_hash_map_specialized_probe(  \
+            private_map, private_type_name, private_key_field, private_equal,  \
+            private_key, private_h, NULL);                                     \
+        return private_i == SIZE_MAX                                           \
+                 ? NULL                                                        \
+                 : &((private_type_name *)private_map->data)[private_i];       \
+    }                                                                          \
+                                                                               \
+    [[maybe_unused]] static inline CCC_Tribool private_name##_contains(        \
+        struct CCC_Flat_hash_map const *const private_map,                     \
+        typeof(((private_type_name *)NULL)->private_key_field) const           \
+            *const private_key)                                                \
+    {                                                                          \
+        if (!private_map || !private_key)                                      \
+        {                                                                      \
+            return CCC_TRIBOOL_ERROR;                                          \
+        }                                                                      \
+        return private_name##_get_key_value(private_map, private_key)          \
+            != NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    [[maybe_unused]] static inline CCC_Entry private_name##_insert_or_assign(  \
+        struct CCC_Flat_hash_map *const private_map,                           \
+        private_type_name const *const private_type)                           \
+    {                                                                          \
+        if (!private_map || !private_type)                                     \
+        {                                                                      \
+            return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};          \
+        }                                                                      \
+        uint64_t const private_h = CCC_private_flat_hash_map_specialized_mix(  \
+            private_map, private_hash(&private_type->private_key_field));      \
+        size_t private_slot = SIZE_MAX;                                        \
+        size_t private_i = SIZE_MAX;                                           \
+        if (CCC_private_flat_hash_map_specialized_ready(private_map)           \
+            && private_map->remain)                                            \
+        {                                                                      \
+            private_i = CCC_private_flat_hash_map_specialized_probe(           \
+                private_map, private_type_name, private_key_field,             \
+                private_equal, &private_type->private_key_field, private_h,    \
+                &private_slot);                                                \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            struct CCC_Flat_hash_map_entry const private_e                     \
+                = CCC_private_flat_hash_map_entry_with_hash(                   \
+                    private_map, &private_type->private_key_field, private_h); \
+            if (private_e.status & CCC_ENTRY_INSERT_ERROR)                     \
+            {                                                                  \
+                return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};        \
+            }                                                                  \
+            if (private_e.status & CCC_ENTRY_OCCUPIED)                         \
+            {                                                                  \
+                private_i = private_e.index;                                   \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                CCC_private_flat_hash_map_insert(private_map, private_type,    \
+                                                 private_h, private_e.index);  \
+                return (CCC_Entry){{                                           \
+                    .type = CCC_private_flat_hash_map_data_at(                 \
+                        private_map, private_e.index),                         \
+                    .status = CCC_ENTRY_VACANT,                                \
+                }};                                                            \
+            }                                                                  \
+        }                                                                      \
+        private_type_name *const private_data = private_map->data;             \
+        if (private_i != SIZE_MAX)                                             \
+        {                                                                      \
+            private_data[private_i] = *private_type;                           \
+            return (CCC_Entry){{                                               \
+                .type = &private_data[private_i],                              \
+                .status = CCC_ENTRY_OCCUPIED,                                  \
+            }};                                                                \
+        }                                                                      \
+        CCC_private_flat_hash_map_specialized_claim(private_map, private_h,    \
+                                                    private_slot);             \
+        private_data[private_slot] = *private_type;                            \
+        return (CCC_Entry){{                                                   \
+            .type = &private_data[private_slot],                               \
+            .status = CCC_ENTRY_VACANT,                                        \
+        }};                                                                    \
+    }                                                                          \
+                                                                               \
+    [[maybe_unused]] static inline CCC_Entry private_name##_remove_key_value(  \
+        struct CCC_Flat_hash_map *const private_map,                           \
+        private_type_name *const private_type_output)                          \
+    {                                                                          \
+        if (!private_map || !private_type_output)                              \
+        {                                                                      \
+            return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};          \
+        }                                                                      \
+        uint64_t const private_h = CCC_private_flat_hash_map_specialized_mix(  \
+            private_map,                                                       \
+            private_hash(&private_type_output->private_key_field));            \
+        if (!CCC_private_flat_hash_map_specialized_ready(private_map)          \
+            || private_map->shrink_denominator || private_map->read_only)      \
+        {                                                                      \
+            return CCC_private_flat_hash_map_remove_with_hash(                 \
+                private_map, private_type_output, private_h);                  \
+        }                                                                      \
+        size_t const private_i = CCC_private_flat_hash_map_specialized_probe(  \
+            private_map, private_type_name, private_key_field, private_equal,  \
+            &private_type_output->private_key_field, private_h, NULL);         \
+        if (private_i == SIZE_MAX)                                             \
+        {                                                                      \
+            return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};                  \
+        }                                                                      \
+        *private_type_output                                                   \
+            = ((private_type_name *)private_map->data)[private_i];             \
+        CCC_private_flat_hash_map_specialized_erase(private_map, private_i);   \
+        return (CCC_Entry){{                                                   \
+            .type = private_type_output,                                       \
+            .status = CCC_ENTRY_OCCUPIED,                                      \
+        }};                                                                    \
+    }                                                                          \
+    static_assert(true, "semicolon required after specialization")
+
 /* NOLINTEND(readability-identifier-naming) */
 
 #endif /* CCC_PRIVATE_FLAT_HASH_MAP_H */
@@ -0,0 +1,51 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_FLAT_HASH_MULTIMAP_H
+#define CCC_PRIVATE_FLAT_HASH_MULTIMAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_flat_hash_map.h"
+
+/** @internal A flat hash map whose elements may share keys. Every element is
+a full slot of the table. An element is inserted in the first free slot of the
+probe sequence of its hash so elements with equal keys sit along one probe
+sequence, usually within one or two groups, and all of them are found by
+matching tags until the first group with an empty slot. Incremental resizing
+is never enabled because it migrates elements one key at a time. */
+struct CCC_Flat_hash_multimap
+{
+    /** @internal The table holding every element. */
+    struct CCC_Flat_hash_map map;
+};
+
+/** @internal The multimap is initialized exactly as a flat hash map with no
+options. The same fixed size types serve both containers. */
+#define CCC_private_flat_hash_multimap_initialize(                             \
+    private_fixed_map_pointer, private_type_name, private_key_field,           \
+    private_hash, private_key_compare, private_allocate, private_context_data, \
+    private_capacity)                                                          \
+    {                                                                          \
+        .map = CCC_private_flat_hash_map_initialize(                           \
+            private_fixed_map_pointer, private_type_name, private_key_field,   \
+            private_hash, private_key_compare, private_allocate,               \
+            private_context_data, private_capacity),                           \
+    }
+
+#endif /* CCC_PRIVATE_FLAT_HASH_MULTIMAP_H */
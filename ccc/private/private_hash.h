@@ -0,0 +1,46 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_HASH_H
+#define CCC_PRIVATE_HASH_H
+
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
+/** @internal Constants of the finalizer. Odd multipliers with good avalanche
+behavior found by search for the moremur variant of the splitmix finalizer. */
+enum : uint64_t
+{
+    CCC_PRIVATE_HASH_MIX_MULTIPLY_1 = 0x3C79AC492BA7B653,
+    CCC_PRIVATE_HASH_MIX_MULTIPLY_2 = 0x1C69B3F74AC4AE35,
+};
+
+/** @internal Finalizes a 64 bit hash so that every input bit affects both the
+low bits, used to select a group, and the high bits, used for the tag. The
+function is a bijection so distinct user hashes remain distinct. It lives in
+a header so containers may inline it on the lookup path. */
+static inline uint64_t
+CCC_private_hash_mix(uint64_t hash)
+{
+    hash ^= hash >> 27;
+    hash *= CCC_PRIVATE_HASH_MIX_MULTIPLY_1;
+    hash ^= hash >> 33;
+    hash *= CCC_PRIVATE_HASH_MIX_MULTIPLY_2;
+    hash ^= hash >> 27;
+    return hash;
+}
+
+#endif /* CCC_PRIVATE_HASH_H */
@@ -0,0 +1,124 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_H
+#define CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_H
+
+/** @cond */
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_flat_hash_map.h"
+
+/** @internal Layout constants of the optimistic map. */
+enum : size_t
+{
+    /** Reader epochs are aligned to two cache lines so that readers entering
+    and leaving lookups never invalidate each other's lines. */
+    CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_READER_ALIGN = 128,
+    /** The number of sequence counters. Slot i is guarded by the counter of
+    its group modulo this count so writes to one group only force retries of
+    readers that found their key in a group sharing the counter. */
+    CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_STRIPES = 64,
+    /** The upper limit on registered readers. */
+    CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_MAX_READERS = 4096,
+};
+
+/** @internal The published view of one table. Readers load the pointer to
+the current view and may then probe its table for as long as their epoch is
+announced, even if the writer replaces the table in the meantime. */
+struct CCC_Optimistic_flat_hash_map_table
+{
+    /** The base of the table allocation, as in the flat hash map. */
+    void *data;
+    /** The tag array within the allocation. */
+    struct CCC_Flat_hash_map_tag *tag;
+    /** The capacity of the table minus one. */
+    size_t mask;
+    /** The group width the table was laid out and is probed with. */
+    uint8_t group_count;
+    /** The global epoch at the time the table was replaced. */
+    uint64_t retired;
+    /** The next retired table awaiting reclamation. */
+    struct CCC_Optimistic_flat_hash_map_table *next;
+};
+
+/** @internal The epoch announced by one reader. Zero means the reader is not
+inside a lookup. */
+struct CCC_Optimistic_flat_hash_map_reader
+{
+    /** The global epoch observed when the current lookup began. */
+    alignas(CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_READER_ALIGN) _Atomic uint64_t
+        epoch;
+};
+
+/** @internal A flat hash map written by one thread and read by many without
+locks. The fields read by readers come first and are only written at
+initialization, or atomically. The writer alone touches the map itself and
+the list of retired tables. */
+struct CCC_Optimistic_flat_hash_map
+{
+    /** The empty map used for hashing, comparison, and new tables. */
+    struct CCC_Flat_hash_map prototype;
+    /** The aligned array of reader epochs. */
+    struct CCC_Optimistic_flat_hash_map_reader *readers;
+    /** The sequence counters, odd while the writer changes a guarded group. */
+    _Atomic uint64_t *sequence;
+    /** One slot per reader, each on its own lines, that receives the copy of
+    a found element when the caller provides no output. */
+    void *scratch;
+    /** The pointer returned by the allocator for readers and sequences. */
+    void *allocation;
+    /** The number of reader epochs. */
+    size_t reader_count;
+    /** The view of the current table or NULL before the first insertion. */
+    struct CCC_Optimistic_flat_hash_map_table *_Atomic table;
+    /** The global epoch, advanced each time a table is retired. */
+    _Atomic uint64_t epoch;
+    /** The writer's map. Its table is always the one published in table. */
+    struct CCC_Flat_hash_map map;
+    /** Replaced tables that readers may still be probing. */
+    struct CCC_Optimistic_flat_hash_map_table *retired;
+};
+
+/*======================     Private Interface      =========================*/
+
+/** @internal Initializes the map with the provided empty map as the template
+for every table. */
+CCC_Result CCC_private_optimistic_flat_hash_map_initialize(
+    struct CCC_Optimistic_flat_hash_map *, struct CCC_Flat_hash_map, size_t);
+
+/*======================    Macro Implementations   =========================*/
+
+/** @internal Builds an empty dynamic flat hash map to serve as the template
+for every table and hands it to the runtime initializer. */
+#define CCC_private_optimistic_flat_hash_map_initialize_with_options(          \
+    private_map_pointer, private_type_name, private_key_field, private_hash,   \
+    private_key_compare, private_allocate, private_context_data,               \
+    private_reader_count, private_options)                                     \
+    CCC_private_optimistic_flat_hash_map_initialize(                           \
+        (private_map_pointer),                                                 \
+        (struct CCC_Flat_hash_map)                                             \
+            CCC_private_flat_hash_map_initialize_with_options(                 \
+                NULL, private_type_name, private_key_field, private_hash,      \
+                private_key_compare, private_allocate, private_context_data,   \
+                0, private_options),                                           \
+        (private_reader_count))
+
+#endif /* CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_H */
@@ -0,0 +1,110 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+#ifndef CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_H
+#define CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_H
+
+/** @cond */
+#include <pthread.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "../types.h"
+#include "private_flat_hash_map.h"
+
+/** @internal Sizing limits of the sharded map. */
+enum : size_t
+{
+    /** Shards are aligned to two cache lines. Adjacent line prefetchers on
+    x86 and the 128 byte lines of some ARM cores would otherwise let writers
+    to neighboring shards invalidate each other's lines. */
+    CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_SHARD_ALIGN = 128,
+    /** The shard index is taken from the hash bits just below the seven tag
+    bits so that the tags within a shard keep all of their entropy. Sixteen
+    bits leaves the low bits, used to select groups, to the shard maps. */
+    CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_MAX_SHARD_BITS = 16,
+};
+
+/** @internal One independent flat hash map and the lock protecting it. The
+alignment pads every shard to a multiple of the alignment so that no two locks
+or maps share a cache line when shards are stored in an array. */
+struct CCC_Sharded_flat_hash_map_shard
+{
+    /** The lock held for every operation on this shard. */
+    alignas(CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_SHARD_ALIGN) pthread_mutex_t lock;
+    /** The map holding every element whose hash selects this shard. */
+    struct CCC_Flat_hash_map map;
+};
+
+/** @internal The sharded map owns an aligned array of shards. The fields of
+this struct are written only at initialization and destruction so they may be
+read by any number of threads without synchronization. */
+struct CCC_Sharded_flat_hash_map
+{
+    /** The aligned array of shards. */
+    struct CCC_Sharded_flat_hash_map_shard *shards;
+    /** The empty map every shard was copied from. Shard maps are rewritten
+    when they resize so hashing and key layout are read from this copy. */
+    struct CCC_Flat_hash_map prototype;
+    /** The pointer returned by the allocator, freed on destruction. */
+    void *allocation;
+    /** The power of two number of shards. */
+    size_t shard_count;
+    /** The right shift that brings the shard bits of a hash to the bottom. */
+    unsigned shard_shift;
+    /** The allocation function for the shard array and every shard map. */
+    CCC_Allocator *allocate;
+    /** Context passed to the allocation function and user callbacks. */
+    void *context;
+};
+
+/** @internal An entry into one shard. The shard lock is held from the time
+the entry is obtained until it is released. */
+struct CCC_Sharded_flat_hash_map_entry
+{
+    /** The locked shard or NULL if the entry could not be obtained. */
+    struct CCC_Sharded_flat_hash_map_shard *shard;
+    /** The entry into the shard map used by the flat hash map interface. */
+    union CCC_Flat_hash_map_entry_wrap entry;
+};
+
+/*======================     Private Interface      =========================*/
+
+/** @internal Initializes every shard as a copy of the provided empty map. */
+CCC_Result
+CCC_private_sharded_flat_hash_map_initialize(struct CCC_Sharded_flat_hash_map *,
+                                             struct CCC_Flat_hash_map,
+                                             size_t);
+
+/*======================    Macro Implementations   =========================*/
+
+/** @internal Builds an empty dynamic flat hash map to serve as the template
+for every shard and hands it to the runtime initializer. */
+#define CCC_private_sharded_flat_hash_map_initialize_with_options(             \
+    private_map_pointer, private_type_name, private_key_field, private_hash,   \
+    private_key_compare, private_allocate, private_context_data,               \
+    private_shard_count, private_options)                                      \
+    CCC_private_sharded_flat_hash_map_initialize(                              \
+        (private_map_pointer),                                                 \
+        (struct CCC_Flat_hash_map)                                             \
+            CCC_private_flat_hash_map_initialize_with_options(                 \
+                NULL, private_type_name, private_key_field, private_hash,      \
+                private_key_compare, private_allocate, private_context_data,   \
+                0, private_options),                                           \
+        (private_shard_count))
+
+#endif /* CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_H */
@@ -38,6 +38,20 @@ struct CCC_Tree_map_node
     uint8_t parity;
 };
 
+/** @internal A WAVL node with room for the count of its subtree. The node comes
+first so the map links the counted node exactly as it links a plain node and
+recovers the count with a cast. Only a map of user types that embed this node
+may maintain order statistics, so a map that never asks for them does not pay
+for the count in every element. */
+struct CCC_Tree_map_counted_node
+{
+    /** @internal The node linked into the tree. */
+    struct CCC_Tree_map_node node;
+    /** @internal The number of nodes in the subtree rooted at this node. Only
+    accurate when the map has order statistics enabled. */
+    size_t count;
+};
+
 /** @internal The realtime ordered map offers strict `O(log(N))` searching,
 inserting, and deleting operations with the Weak AVL Tree Rank Balance
 framework. The number of rotations after an operation are kept to a maximum of
@@ -69,6 +83,11 @@ struct CCC_Tree_map
     CCC_Allocator *allocate;
     /** @internal Auxiliary data, if any. */
     void *context;
+    /** @internal If the intrusive node of the user type is a counted node. */
+    bool counted;
+    /** @internal If subtree counts are maintained on every insert and remove
+    to support rank and select queries. */
+    bool order_statistics;
 };
 
 /** @internal An entry is a way to store a node or the information needed to
@@ -129,6 +148,11 @@ void *CCC_private_tree_map_insert(
         .compare = (private_key_order_fn),                                     \
         .allocate = (private_allocate),                                        \
         .context = (private_context_data),                                     \
+        .counted = _Generic(                                                   \
+            ((private_struct_name *)NULL)->private_node_node_field,            \
+            struct CCC_Tree_map_counted_node: true,                            \
+            default: false),                                                   \
+        .order_statistics = false,                                             \
     }
 
 /** @internal */
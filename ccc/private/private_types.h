@@ -21,6 +21,14 @@ limitations under the License.
 #include <stdint.h>
 /** @endcond */
 
+/** @internal The alignment containers request from the allocator for their
+hot contiguous arrays. The allocator may ignore the request so no container
+relies on it for correctness. */
+enum : size_t
+{
+    CCC_PRIVATE_CACHE_LINE_ALIGN = 64,
+};
+
 /** @internal The basic statuses possible when interacting with entries and
 handles. Handles are just an index based version of entries. Not only can
 we clearly understand the enum itself in a debugger, but we may provide more
@@ -0,0 +1,478 @@
+/** @cond
+Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+@endcond */
+/** @file
+@brief The Sharded Flat Hash Map Interface
+
+A Sharded Flat Hash Map partitions keys across a power of two number of
+independent flat hash maps, called shards, each protected by its own lock. Any
+number of threads may operate on the map at once and threads only wait for one
+another when their keys fall in the same shard. Shards are aligned and padded
+so that a lock or table header of one shard never shares a cache line with
+another shard.
+
+A key is assigned to a shard by the bits of its hash just below the seven bits
+the flat hash map uses for tags. The hash is computed once per operation,
+before any lock is taken, and the same hash is used within the shard. A hash
+function with good variety in its upper bits is therefore required, such as
+those in `ccc/hash.h` or any hash with `CCC_FLAT_HASH_MAP_OPTION_MIX_HASH`.
+
+Because other threads may move or remove elements as soon as a lock is
+released, functions that operate on the map directly never return references
+to elements. Values are copied in and out of user memory instead. When a
+reference to an element is needed, obtain an entry. An entry holds the lock of
+its shard until it is released and offers the familiar flat hash map entry
+interface. For scans, each shard may be locked individually and iterated with
+the flat hash map interface, so parallel scans need no global lock.
+
+The map requires an allocation function because the shard array and every
+shard grow dynamically. Locks are POSIX mutexes.
+
+To shorten names in the interface, define the following preprocessor directive
+at the top of your file.
+
+```
+#define SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+```
+
+All types and functions can then be written without the `CCC_` prefix. */
+#ifndef CCC_SHARDED_FLAT_HASH_MAP_H
+#define CCC_SHARDED_FLAT_HASH_MAP_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+#include "flat_hash_map.h"
+#include "private/private_sharded_flat_hash_map.h"
+#include "types.h"
+
+/** @name Container Types
+Types available in the container interface. */
+/**@{*/
+
+/** @brief A thread safe hash map made of independently locked flat hash map
+shards.
+
+The map must be initialized at runtime with one of the initialization macros
+before use and destroyed with CCC_sharded_flat_hash_map_clear_and_free. It
+must not be copied by value after initialization. */
+typedef struct CCC_Sharded_flat_hash_map CCC_Sharded_flat_hash_map;
+
+/** @brief An entry into one shard of the map that holds the shard lock.
+
+Every entry obtained must be released with
+CCC_sharded_flat_hash_map_entry_release by the same thread, and no other
+operation on the same map should be attempted by that thread until then.
+References obtained through the entry are only valid until release. */
+typedef struct CCC_Sharded_flat_hash_map_entry CCC_Sharded_flat_hash_map_entry;
+
+/**@}*/
+
+/** @name Initialization Interface
+Initialize the shards and their locks. */
+/**@{*/
+
+/** @brief Initialize a sharded map at runtime.
+@param[in] map_pointer a pointer to the uninitialized sharded map.
+@param[in] type_name the user type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] shard_count the desired number of shards. It is rounded up to a
+power of two. A small multiple of the number of writing threads is typical.
+@return the result of initialization. An argument error is returned if the
+map or allocation function is NULL or the shard count is 0 or greater than
+65536. An allocator error is returned if the shard array cannot be allocated.
+
+```
+#define SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+struct Val
+{
+    uint64_t key;
+    int val;
+};
+Sharded_flat_hash_map map;
+CCC_Result const r = sharded_flat_hash_map_initialize(
+    &map,
+    struct Val,
+    key,
+    CCC_hash_key_u64,
+    val_key_order,
+    std_allocate,
+    NULL,
+    64
+);
+```
+
+Every shard begins empty with no allocation and grows independently. */
+#define CCC_sharded_flat_hash_map_initialize(map_pointer, type_name,           \
+                                             key_field, hash, compare,         \
+                                             allocate, context_data,           \
+                                             shard_count)                      \
+    CCC_private_sharded_flat_hash_map_initialize_with_options(                 \
+        map_pointer, type_name, key_field, hash, compare, allocate,            \
+        context_data, shard_count, CCC_FLAT_HASH_MAP_OPTION_NONE)
+
+/** @brief Initialize a sharded map at runtime with flat hash map options.
+@param[in] map_pointer a pointer to the uninitialized sharded map.
+@param[in] type_name the user type stored in the map.
+@param[in] key_field the field of the struct used for key storage.
+@param[in] hash the CCC_Key_hasher function provided by the user.
+@param[in] compare the CCC_Key_comparator the user intends to use.
+@param[in] allocate the required allocation function.
+@param[in] context_data context data for hashing, comparison, and allocation.
+@param[in] shard_count the desired number of shards.
+@param[in] options the CCC_Flat_hash_map_option flags applied to every shard.
+@return the result of initialization as described in
+CCC_sharded_flat_hash_map_initialize. */
+#define CCC_sharded_flat_hash_map_initialize_with_options(                     \
+    map_pointer, type_name, key_field, hash, compare, allocate, context_data,  \
+    shard_count, options)                                                      \
+    CCC_private_sharded_flat_hash_map_initialize_with_options(                 \
+        map_pointer, type_name, key_field, hash, compare, allocate,            \
+        context_data, shard_count, options)
+
+/**@}*/
+
+/** @name Membership Interface
+Test membership or copy out an element. Each call locks one shard. */
+/**@{*/
+
+/** @brief Searches the map for the presence of key.
+@param[in] map the sharded map.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return true if the key was present at the time of the search, false if not.
+Error if map or key is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_sharded_flat_hash_map_contains(CCC_Sharded_flat_hash_map *map,
+                                   void const *key);
+
+/** @brief Copies the user type stored with key into type_output.
+@param[in] map the sharded map.
+@param[in] key pointer to the key matching the key type of the user struct.
+@param[out] type_output the user memory that receives a copy of the element.
+@return true if the key was found and copied, false if the key was absent and
+type_output is unchanged. Error if any argument is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_sharded_flat_hash_map_get_key_value(CCC_Sharded_flat_hash_map *map,
+                                        void const *key, void *type_output);
+
+/**@}*/
+
+/** @name Insert and Remove Interface
+Insert or remove elements by copying them between the map and user memory.
+The entries returned refer only to user memory, never to the map. */
+/**@{*/
+
+/** @brief Invariantly inserts the user type, swapping out any old value.
+@param[in] map the sharded map.
+@param[in,out] type_input_output the complete key and value type to insert.
+@return an entry. If Occupied the old value was written to type_input_output
+which the entry wraps. If Vacant the type was inserted and the entry wraps
+type_input_output. If more space was needed but allocation failed, an insert
+error is set. */
+[[nodiscard]] CCC_Entry
+CCC_sharded_flat_hash_map_swap_entry(CCC_Sharded_flat_hash_map *map,
+                                     void *type_input_output);
+
+/** @brief Inserts the user type only if its key is absent.
+@param[in] map the sharded map.
+@param[in,out] type_input_output the complete key and value type to insert.
+@return an entry. If Occupied the value already in the map was written to
+type_input_output which the entry wraps. If Vacant the type was inserted and
+the entry wraps type_input_output. If more space was needed but allocation
+failed, an insert error is set. */
+[[nodiscard]] CCC_Entry
+CCC_sharded_flat_hash_map_try_insert(CCC_Sharded_flat_hash_map *map,
+                                     void *type_input_output);
+
+/** @brief Invariantly inserts or overwrites the user type.
+@param[in] map the sharded map.
+@param[in] type the complete key and value type to insert.
+@return an entry wrapping NULL. Occupied if an element was overwritten, Vacant
+if the key was absent. If more space was needed but allocation failed, an
+insert error is set. */
+[[nodiscard]] CCC_Entry
+CCC_sharded_flat_hash_map_insert_or_assign(CCC_Sharded_flat_hash_map *map,
+                                           void const *type);
+
+/** @brief Removes the element with the key of type_output and copies it out.
+@param[in] map the sharded map.
+@param[in,out] type_output the user type with the search key written to it.
+@return an entry. If Occupied the removed element was written to type_output
+which the entry wraps. If Vacant no element had the key and the entry wraps
+NULL. */
+[[nodiscard]] CCC_Entry
+CCC_sharded_flat_hash_map_remove_key_value(CCC_Sharded_flat_hash_map *map,
+                                           void *type_output);
+
+/**@}*/
+
+/** @name Entry Interface
+Lock the shard of a key and operate on its slot with the flat hash map entry
+interface. Every entry must be released. */
+/**@{*/
+
+/** @brief Locks the shard of key and obtains an entry to its slot.
+@param[in] map the sharded map.
+@param[in] key pointer to the key matching the key type of the user struct.
+@return an entry holding the lock of the shard of key. If an argument is NULL
+the entry holds no lock and reports an argument error.
+
+```
+#define SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+Sharded_flat_hash_map_entry e = sharded_flat_hash_map_entry(&map, &key);
+struct Val *v = sharded_flat_hash_map_or_insert(&e, &(struct Val){key, 0});
+if (v)
+{
+    ++v->val;
+}
+(void)sharded_flat_hash_map_entry_release(&e);
+``` */
+[[nodiscard]] CCC_Sharded_flat_hash_map_entry
+CCC_sharded_flat_hash_map_entry(CCC_Sharded_flat_hash_map *map,
+                                void const *key);
+
+/** @brief Releases the lock held by an entry.
+@param[in] entry the entry to release.
+@return OK if the lock was released. An argument error if the entry is NULL
+or holds no lock. The entry holds no lock after release. */
+CCC_Result
+CCC_sharded_flat_hash_map_entry_release(CCC_Sharded_flat_hash_map_entry *entry);
+
+/** @brief Inserts type if the entry is Vacant.
+@param[in] entry a pointer to a held entry.
+@param[in] type the complete key and value type to insert if Vacant.
+@return a reference to the element in the map, valid until the entry is
+released. NULL if insertion failed or the entry is invalid. */
+[[nodiscard]] void *CCC_sharded_flat_hash_map_or_insert(
+    CCC_Sharded_flat_hash_map_entry const *entry, void const *type);
+
+/** @brief Writes type to the slot of the entry whether Occupied or Vacant.
+@param[in] entry a pointer to a held entry.
+@param[in] type the complete key and value type to write.
+@return a reference to the element in the map, valid until the entry is
+released. NULL if insertion failed or the entry is invalid. */
+[[nodiscard]] void *CCC_sharded_flat_hash_map_insert_entry(
+    CCC_Sharded_flat_hash_map_entry const *entry, void const *type);
+
+/** @brief Removes the element of the entry if Occupied.
+@param[in] entry a pointer to a held entry.
+@return an entry wrapping NULL. Occupied if an element was removed, Vacant if
+none existed. The lock is still held. */
+[[nodiscard]] CCC_Entry CCC_sharded_flat_hash_map_remove_entry(
+    CCC_Sharded_flat_hash_map_entry const *entry);
+
+/** @brief Modifies the element of the entry if Occupied.
+@param[in] entry a pointer to a held entry.
+@param[in] modify the modification function applied to the user type.
+@return the same entry. */
+CCC_Sharded_flat_hash_map_entry *
+CCC_sharded_flat_hash_map_and_modify(CCC_Sharded_flat_hash_map_entry *entry,
+                                     CCC_Type_modifier *modify);
+
+/** @brief Modifies the element of the entry if Occupied with context.
+@param[in] entry a pointer to a held entry.
+@param[in] modify the modification function applied to the user type.
+@param[in] context context data passed to the modification function.
+@return the same entry. */
+CCC_Sharded_flat_hash_map_entry *CCC_sharded_flat_hash_map_and_modify_context(
+    CCC_Sharded_flat_hash_map_entry *entry, CCC_Type_modifier *modify,
+    void *context);
+
+/** @brief Unwraps the entry to the element in the map if Occupied.
+@param[in] entry a pointer to a held entry.
+@return a reference valid until release if Occupied, otherwise NULL. */
+[[nodiscard]] void *
+CCC_sharded_flat_hash_map_unwrap(CCC_Sharded_flat_hash_map_entry const *entry);
+
+/** @brief Returns the Occupied status of the entry.
+@param[in] entry a pointer to an entry.
+@return true if Occupied, false if Vacant. Error if entry is NULL. */
+[[nodiscard]] CCC_Tribool CCC_sharded_flat_hash_map_occupied(
+    CCC_Sharded_flat_hash_map_entry const *entry);
+
+/** @brief Returns the insert error status of the entry.
+@param[in] entry a pointer to an entry.
+@return true if an insertion into a Vacant entry cannot succeed because more
+space is needed and could not be allocated. Error if entry is NULL. */
+[[nodiscard]] CCC_Tribool CCC_sharded_flat_hash_map_insert_error(
+    CCC_Sharded_flat_hash_map_entry const *entry);
+
+/**@}*/
+
+/** @name Shard Interface
+Lock individual shards to scan or operate on many elements at once. */
+/**@{*/
+
+/** @brief Returns the number of shards.
+@param[in] map the sharded map.
+@return the power of two number of shards or an argument error if map is
+NULL. */
+[[nodiscard]] CCC_Count
+CCC_sharded_flat_hash_map_shard_count(CCC_Sharded_flat_hash_map const *map);
+
+/** @brief Locks a shard and returns its flat hash map.
+@param[in] map the sharded map.
+@param[in] shard_index the index of the shard in [0, shard count).
+@return the flat hash map of the shard or NULL if an argument is invalid.
+
+The returned map may be used with the read and iteration functions of the
+flat hash map interface until the shard is unlocked. Elements may be modified
+in place but keys must not change, and elements must not be inserted through
+the returned map because their hash may select a different shard. Elements may
+be removed.
+
+```
+#define SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+size_t const shards = sharded_flat_hash_map_shard_count(&map).count;
+for (size_t s = thread_id; s < shards; s += thread_count)
+{
+    Flat_hash_map *const shard = sharded_flat_hash_map_shard_lock(&map, s);
+    for (struct Val const *v = begin(shard); v != end(shard);
+         v = next(shard, v))
+    {
+        total += v->val;
+    }
+    (void)sharded_flat_hash_map_shard_unlock(&map, s);
+}
+``` */
+[[nodiscard]] CCC_Flat_hash_map *
+CCC_sharded_flat_hash_map_shard_lock(CCC_Sharded_flat_hash_map *map,
+                                     size_t shard_index);
+
+/** @brief Unlocks a shard previously locked by the calling thread.
+@param[in] map the sharded map.
+@param[in] shard_index the index of the locked shard.
+@return OK if unlocked or an argument error if an argument is invalid. */
+CCC_Result
+CCC_sharded_flat_hash_map_shard_unlock(CCC_Sharded_flat_hash_map *map,
+                                       size_t shard_index);
+
+/**@}*/
+
+/** @name Deallocation Interface
+Clear or destroy the map. These functions must not run concurrently with any
+other operation on the map. */
+/**@{*/
+
+/** @brief Removes every element, keeping the memory of every shard.
+@param[in] map the sharded map.
+@param[in] destroy the optional destructor for each element.
+@return OK or an argument error if map is NULL. */
+CCC_Result CCC_sharded_flat_hash_map_clear(CCC_Sharded_flat_hash_map *map,
+                                           CCC_Type_destructor *destroy);
+
+/** @brief Removes every element, frees all memory, and destroys all locks.
+@param[in] map the sharded map.
+@param[in] destroy the optional destructor for each element.
+@return OK or an argument error if map is NULL. The map must be initialized
+again before reuse. */
+CCC_Result
+CCC_sharded_flat_hash_map_clear_and_free(CCC_Sharded_flat_hash_map *map,
+                                         CCC_Type_destructor *destroy);
+
+/**@}*/
+
+/** @name State Interface
+Obtain the state of the map. Each shard is locked in turn so the results are
+not a consistent snapshot while other threads modify the map. */
+/**@{*/
+
+/** @brief Returns the total number of elements across all shards.
+@param[in] map the sharded map.
+@return the count or an argument error if map is NULL. */
+[[nodiscard]] CCC_Count
+CCC_sharded_flat_hash_map_count(CCC_Sharded_flat_hash_map *map);
+
+/** @brief Returns true if every shard is empty.
+@param[in] map the sharded map.
+@return true if empty, false if not. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_sharded_flat_hash_map_is_empty(CCC_Sharded_flat_hash_map *map);
+
+/** @brief Validates the invariants of every shard and that every element is
+stored in the shard its hash selects.
+@param[in] map the sharded map.
+@return true if valid, false if not. Error if map is NULL. */
+[[nodiscard]] CCC_Tribool
+CCC_sharded_flat_hash_map_validate(CCC_Sharded_flat_hash_map *map);
+
+/**@}*/
+
+/** Define this preprocessor directive if shorter names are helpful. Ensure
+no namespace clashes occur before shortening. */
+#ifdef SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+typedef CCC_Sharded_flat_hash_map Sharded_flat_hash_map;
+typedef CCC_Sharded_flat_hash_map_entry Sharded_flat_hash_map_entry;
+#    define sharded_flat_hash_map_initialize(args...)                          \
+        CCC_sharded_flat_hash_map_initialize(args)
+#    define sharded_flat_hash_map_initialize_with_options(args...)             \
+        CCC_sharded_flat_hash_map_initialize_with_options(args)
+#    define sharded_flat_hash_map_contains(args...)                            \
+        CCC_sharded_flat_hash_map_contains(args)
+#    define sharded_flat_hash_map_get_key_value(args...)                       \
+        CCC_sharded_flat_hash_map_get_key_value(args)
+#    define sharded_flat_hash_map_swap_entry(args...)                          \
+        CCC_sharded_flat_hash_map_swap_entry(args)
+#    define sharded_flat_hash_map_try_insert(args...)                          \
+        CCC_sharded_flat_hash_map_try_insert(args)
+#    define sharded_flat_hash_map_insert_or_assign(args...)                    \
+        CCC_sharded_flat_hash_map_insert_or_assign(args)
+#    define sharded_flat_hash_map_remove_key_value(args...)                    \
+        CCC_sharded_flat_hash_map_remove_key_value(args)
+#    define sharded_flat_hash_map_entry(args...)                               \
+        CCC_sharded_flat_hash_map_entry(args)
+#    define sharded_flat_hash_map_entry_release(args...)                       \
+        CCC_sharded_flat_hash_map_entry_release(args)
+#    define sharded_flat_hash_map_or_insert(args...)                           \
+        CCC_sharded_flat_hash_map_or_insert(args)
+#    define sharded_flat_hash_map_insert_entry(args...)                        \
+        CCC_sharded_flat_hash_map_insert_entry(args)
+#    define sharded_flat_hash_map_remove_entry(args...)                        \
+        CCC_sharded_flat_hash_map_remove_entry(args)
+#    define sharded_flat_hash_map_and_modify(args...)                          \
+        CCC_sharded_flat_hash_map_and_modify(args)
+#    define sharded_flat_hash_map_and_modify_context(args...)                  \
+        CCC_sharded_flat_hash_map_and_modify_context(args)
+#    define sharded_flat_hash_map_unwrap(args...)                              \
+        CCC_sharded_flat_hash_map_unwrap(args)
+#    define sharded_flat_hash_map_occupied(args...)                            \
+        CCC_sharded_flat_hash_map_occupied(args)
+#    define sharded_flat_hash_map_insert_error(args...)                        \
+        CCC_sharded_flat_hash_map_insert_error(args)
+#    define sharded_flat_hash_map_shard_count(args...)                         \
+        CCC_sharded_flat_hash_map_shard_count(args)
+#    define sharded_flat_hash_map_shard_lock(args...)                          \
+        CCC_sharded_flat_hash_map_shard_lock(args)
+#    define sharded_flat_hash_map_shard_unlock(args...)                        \
+        CCC_sharded_flat_hash_map_shard_unlock(args)
+#    define sharded_flat_hash_map_clear(args...)                               \
+        CCC_sharded_flat_hash_map_clear(args)
+#    define sharded_flat_hash_map_clear_and_free(args...)                      \
+        CCC_sharded_flat_hash_map_clear_and_free(args)
+#    define sharded_flat_hash_map_count(args...)                               \
+        CCC_sharded_flat_hash_map_count(args)
+#    define sharded_flat_hash_map_is_empty(args...)                            \
+        CCC_sharded_flat_hash_map_is_empty(args)
+#    define sharded_flat_hash_map_validate(args...)                            \
+        CCC_sharded_flat_hash_map_validate(args)
+#endif /* SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC */
+
+#endif /* CCC_SHARDED_FLAT_HASH_MAP_H */
@@ -36,6 +36,7 @@ All types and functions can then be written without the `CCC_` prefix. */
 #include <stddef.h>
 /** @endcond */
 
+#include "buffer.h"
 #include "private/private_tree_map.h"
 #include "types.h"
 
@@ -62,6 +63,15 @@ the container will handle copying the data wrapping the element to allocations
 and deallocating when necessary. */
 typedef struct CCC_Tree_map_node CCC_Tree_map_node;
 
+/** @brief The intrusive element of a user defined struct stored in a map that
+supports order statistics.
+
+A counted node wraps a plain node with the count of its subtree. Embed it in
+place of a CCC_Tree_map_node only if the map will enable order statistics, and
+pass the address of its node field wherever the interface asks for a
+CCC_Tree_map_node. Maps of types that embed a plain node do not store counts. */
+typedef struct CCC_Tree_map_counted_node CCC_Tree_map_counted_node;
+
 /** @brief A container specific entry used to implement the Entry Interface.
 
 The Entry Interface offers efficient search and subsequent insertion, deletion,
@@ -119,6 +129,27 @@ allocate function. */
                               compare, allocate, destroy, context_data,        \
                               compound_literal_array)
 
+/** @brief Builds a perfectly balanced map from a Buffer sorted by key in
+linear time.
+@param[in] map an initialized and empty map.
+@param[in] sorted a Buffer of user types wrapping the intrusive element, sorted
+in strictly ascending order of key.
+@return OK if the map now holds every element of the Buffer. An argument error
+if map or sorted is NULL, the map is not empty, the Buffer element size differs
+from the map element size, or the keys are not strictly ascending. An allocator
+error if a copy could not be allocated. The map is left empty on any error.
+
+If the map has allocation permission each element is copied to a new
+allocation and the Buffer is not modified. Otherwise, the elements of the
+Buffer themselves are linked into the map, so the Buffer must not be resized,
+freed, or modified until the map is cleared.
+
+The sort order is verified with N - 1 comparisons before any element is
+touched. The tree is then built from the middle out with every rank assigned
+directly, so no rotations or fix ups occur. O(N) compared to the O(NlgN) of N
+insertions. */
+CCC_Result CCC_tree_map_from_sorted(CCC_Tree_map *map, CCC_Buffer *sorted);
+
 /**@}*/
 
 /**@name Membership Interface
@@ -213,6 +244,24 @@ error is set. */
             .private                                                           \
     }
 
+/** @brief Attempts to insert the key value wrapping type_intruder starting the
+search at a user type already in the map. O(lg D) comparisons for a key D
+elements away from the hint.
+@param[in] map the pointer to the map.
+@param[in] hint a user type in the map near the key or NULL to search from the
+root.
+@param[in] type_intruder the handle to the user type wrapping map elem.
+@return an entry as returned by try insert.
+
+A good hint is the element inserted last when keys arrive nearly sorted. A new
+greatest key with the previous greatest key as the hint costs O(1) comparisons
+and the rebalancing of an insert is amortized O(1). The search walks up parent
+links from the hint without comparing until it reaches an ancestor that could
+bound the key so any hint is correct, but a far hint is slower than none. */
+[[nodiscard]] CCC_Entry
+CCC_tree_map_try_insert_hint(CCC_Tree_map *map, void const *hint,
+                             CCC_Tree_map_node *type_intruder);
+
 /** @brief lazily insert type_compound_literal into the map at key if key is
 absent.
 @param[in] map_pointer a pointer to the map.
@@ -266,6 +315,20 @@ return by value; the reference is returned to enable function chaining. */
             .private                                                           \
     }
 
+/** @brief Invariantly inserts or overwrites a user struct into the map starting
+the search at a user type already in the map. O(lg D) comparisons for a key D
+elements away from the hint.
+@param[in] map a pointer to the map.
+@param[in] hint a user type in the map near the key or NULL to search from the
+root.
+@param[in] type_intruder the handle to the wrapping user struct key value.
+@return an entry as returned by insert or assign.
+
+See try insert hint for how the hint is used. */
+[[nodiscard]] CCC_Entry
+CCC_tree_map_insert_or_assign_hint(CCC_Tree_map *map, void const *hint,
+                                   CCC_Tree_map_node *type_intruder);
+
 /** @brief Inserts a new key value pair or overwrites the existing entry.
 @param[in] map_pointer the pointer to the flat hash map.
 @param[in] key the key to be searched in the map.
@@ -370,6 +433,39 @@ to subsequent calls in the Entry Interface. */
         CCC_tree_map_entry((map_pointer), (key_pointer)).private               \
     }
 
+/** @brief Obtains an entry for the provided key starting the search at a user
+type already in the map. O(lg D) comparisons for a key D elements away from the
+hint.
+@param[in] map the map to be searched.
+@param[in] hint a user type in the map near the key or NULL to search from the
+root.
+@param[in] key the key used to search the map matching the stored key type.
+@return a specialized entry for use with other functions in the Entry Interface.
+@warning the contents of an entry should not be examined or modified. Use the
+provided functions, only.
+
+The entry is the same as the one the search from the root would return so a
+vacant entry inserts next to the hint in O(1) when the key is adjacent to it.
+See try insert hint for how the hint is used. */
+[[nodiscard]] CCC_Tree_map_entry
+CCC_tree_map_entry_hint(CCC_Tree_map const *map, void const *hint,
+                        void const *key);
+
+/** @brief Obtains an entry for the provided key starting the search at a user
+type already in the map.
+@param[in] map_pointer the map to be searched.
+@param[in] hint_pointer a user type in the map near the key or NULL.
+@param[in] key_pointer the key used to search the map matching the stored key
+type.
+@return a compound literal reference to a specialized entry for use with other
+functions in the Entry Interface. */
+#define CCC_tree_map_entry_hint_wrap(map_pointer, hint_pointer, key_pointer)   \
+    &(CCC_Tree_map_entry)                                                      \
+    {                                                                          \
+        CCC_tree_map_entry_hint((map_pointer), (hint_pointer), (key_pointer))  \
+            .private                                                           \
+    }
+
 /** @brief Modifies the provided entry if it is Occupied.
 @param[in] entry the entry obtained from an entry function or macro.
 @param[in] modify an update function in which the context argument is unused.
@@ -698,6 +794,197 @@ O(1).
 
 /**@}*/
 
+/** @name Order Statistics Interface
+Query the map by the sorted position of its elements. Only a map of user types
+that embed a CCC_Tree_map_counted_node has room for subtree counts, and the
+counts are only kept up to date on the path of an insert or remove once order
+statistics are enabled. A map of plain nodes pays nothing for this interface. */
+/**@{*/
+
+/** @brief Maintain subtree counts so the map supports rank and select. O(N)
+the first time to count the existing nodes, O(1) thereafter.
+@param[in] map a pointer to the map.
+@return OK if the counts are now maintained or an argument error if map is
+NULL or the user type does not embed a CCC_Tree_map_counted_node.
+
+Insertion and removal each add an O(lg N) walk to the root once enabled. The
+counts remain enabled after a clear. */
+CCC_Result CCC_tree_map_enable_order_statistics(CCC_Tree_map *map);
+
+/** @brief Return the number of elements with keys less than the given key.
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] key a pointer to the key which need not be in the map.
+@return the count of keys LESS than key which is the index of key in sorted
+order if it is present. An argument error is set if map or key is NULL or if
+order statistics are not enabled. */
+[[nodiscard]] CCC_Count CCC_tree_map_rank(CCC_Tree_map const *map,
+                                          void const *key);
+
+/** @brief Return the user type at the given index in sorted order. O(lg N).
+@param[in] map a pointer to the map.
+@param[in] index the zero based position of the element in sorted order.
+@return the user type at index or NULL if index is out of range, map is NULL,
+or order statistics are not enabled. */
+[[nodiscard]] void *CCC_tree_map_select(CCC_Tree_map const *map, size_t index);
+
+/** @brief Return the number of elements with keys in [begin_key, end_key).
+O(lg N).
+@param[in] map a pointer to the map.
+@param[in] begin_key a pointer to the inclusive start of the range.
+@param[in] end_key a pointer to the exclusive end of the range.
+@return the count of keys NOT LESS than begin_key and LESS than end_key, 0 if
+end_key does not follow begin_key. An argument error is set if any argument is
+NULL or if order statistics are not enabled.
+
+Unlike counting the elements of an equal range this does not visit the
+elements between the bounds. */
+[[nodiscard]] CCC_Count CCC_tree_map_count_range(CCC_Tree_map const *map,
+                                                 void const *begin_key,
+                                                 void const *end_key);
+
+/**@}*/
+
+/** @name Join and Split Interface
+Move whole ranges of nodes between maps. Nodes are relinked rather than copied
+so the two maps must be initialized with the same user type, intrusive element,
+key field, comparison function, allocation function, and context. Otherwise an
+argument error is returned and neither map is modified.
+
+The set operations split one tree by the keys of the other and join the results
+back together. For maps of size M and N with M <= N they run in
+O(M lg(N / M + 1)) which is far less than inserting one element at a time when
+one map is much smaller than the other. If only one of the two maps has order
+statistics enabled the other is counted first in O(N). */
+/**@{*/
+
+/** @brief Move every element of the source to the end of the destination.
+O(lg N).
+@param[in] destination the map that receives the elements.
+@param[in] source the map with keys all greater than those in destination.
+@return OK if the source is now empty and its elements are in the destination.
+An argument error is returned if the maps are not compatible or a key in source
+is not greater than every key in destination. */
+CCC_Result CCC_tree_map_join(CCC_Tree_map *destination, CCC_Tree_map *source);
+
+/** @brief Move every element with a key not less than key into the empty
+destination. O(lg N) if order statistics are enabled, otherwise O(lg N + K) to
+count the K elements moved.
+@param[in] map the map to split.
+@param[in] key the key that begins the moved elements. It need not be present.
+@param[in] destination an empty map that receives the elements.
+@return OK if the split succeeds or an argument error if an argument is NULL,
+the destination is not empty, or the maps are not compatible. */
+CCC_Result CCC_tree_map_split(CCC_Tree_map *map, void const *key,
+                              CCC_Tree_map *destination);
+
+/** @brief Move every element with a key in [begin_key, end_key) into the empty
+destination. O(lg N) if order statistics are enabled, otherwise O(lg N + K) to
+count the K elements moved.
+@param[in] map the map to extract from.
+@param[in] begin_key the inclusive start of the range.
+@param[in] end_key the exclusive end of the range.
+@param[in] destination an empty map that receives the elements.
+@return OK if the extraction succeeds, even if the range is empty, or an
+argument error if an argument is NULL, the destination is not empty, or the
+maps are not compatible. */
+CCC_Result CCC_tree_map_extract_range(CCC_Tree_map *map, void const *begin_key,
+                                      void const *end_key,
+                                      CCC_Tree_map *destination);
+
+/** @brief Move the elements of source with keys not in destination into
+destination. O(M lg(N / M + 1)).
+@param[in] destination the map that receives the union.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for source elements with a key already in
+the destination or NULL. Such elements are freed if the maps allocate.
+@return OK if the union succeeds or an argument error if the maps are NULL or
+not compatible.
+
+The destination keeps its own element when a key is in both maps. */
+CCC_Result CCC_tree_map_union(CCC_Tree_map *destination, CCC_Tree_map *source,
+                              CCC_Type_destructor *destroy);
+
+/** @brief Keep only the elements of destination with keys also in source.
+O(M lg(N / M + 1)).
+@param[in] destination the map that keeps the intersection.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for every element not kept in destination or
+NULL. Such elements are freed if the maps allocate.
+@return OK if the intersection succeeds or an argument error if the maps are
+NULL or not compatible. */
+CCC_Result CCC_tree_map_intersection(CCC_Tree_map *destination,
+                                     CCC_Tree_map *source,
+                                     CCC_Type_destructor *destroy);
+
+/** @brief Keep only the elements of destination with keys not in source.
+O(M lg(N / M + 1)).
+@param[in] destination the map that keeps the difference.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for every element not kept in destination or
+NULL. Such elements are freed if the maps allocate.
+@return OK if the difference succeeds or an argument error if the maps are NULL
+or not compatible. */
+CCC_Result CCC_tree_map_difference(CCC_Tree_map *destination,
+                                   CCC_Tree_map *source,
+                                   CCC_Type_destructor *destroy);
+
+/** @brief Perform CCC_tree_map_union with several threads.
+@param[in] destination the map that receives the union.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for source elements with a key already in
+the destination or NULL.
+@param[in] threads the number of threads to use, including the caller.
+@return the same results as CCC_tree_map_union.
+
+The root of the destination splits the source and the two sides are merged
+independently. While threads remain and both lesser sides are large, the lesser
+sides are merged by a new thread given half of the threads while the caller
+merges the greater sides. The sides share no nodes so no synchronization is
+needed until the caller joins them around the root. If a thread cannot be
+started the caller merges both sides itself.
+
+The comparison function must be safe to call from many threads at once. The
+destructor and the allocation function only run on the calling thread after the
+merge is done. If threads is at most one or the maps are small, the union is
+performed by the caller alone. */
+CCC_Result CCC_tree_map_union_parallel(CCC_Tree_map *destination,
+                                       CCC_Tree_map *source,
+                                       CCC_Type_destructor *destroy,
+                                       size_t threads);
+
+/** @brief Perform CCC_tree_map_intersection with several threads.
+@param[in] destination the map that keeps the intersection.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for every element not kept in destination or
+NULL.
+@param[in] threads the number of threads to use, including the caller.
+@return the same results as CCC_tree_map_intersection.
+
+The work is divided as in CCC_tree_map_union_parallel and the same requirements
+on the comparison function apply. */
+CCC_Result CCC_tree_map_intersection_parallel(CCC_Tree_map *destination,
+                                              CCC_Tree_map *source,
+                                              CCC_Type_destructor *destroy,
+                                              size_t threads);
+
+/** @brief Perform CCC_tree_map_difference with several threads.
+@param[in] destination the map that keeps the difference.
+@param[in] source the map that is emptied by the operation.
+@param[in] destroy the destructor for every element not kept in destination or
+NULL.
+@param[in] threads the number of threads to use, including the caller.
+@return the same results as CCC_tree_map_difference.
+
+The work is divided as in CCC_tree_map_union_parallel and the same requirements
+on the comparison function apply. */
+CCC_Result CCC_tree_map_difference_parallel(CCC_Tree_map *destination,
+                                            CCC_Tree_map *source,
+                                            CCC_Type_destructor *destroy,
+                                            size_t threads);
+
+/**@}*/
+
 /** @name State Interface
 Obtain the container state. */
 /**@{*/
@@ -724,17 +1011,22 @@ NULL. */
  no namespace clashes occur before shortening. */
 #ifdef TREE_MAP_USING_NAMESPACE_CCC
 typedef CCC_Tree_map_node Tree_map_node;
+typedef CCC_Tree_map_counted_node Tree_map_counted_node;
 typedef CCC_Tree_map Tree_map;
 typedef CCC_Tree_map_entry Tree_map_entry;
 #    define tree_map_initialize(args...) CCC_tree_map_initialize(args)
 #    define tree_map_from(args...) CCC_tree_map_from(args)
+#    define tree_map_from_sorted(args...) CCC_tree_map_from_sorted(args)
 #    define tree_map_and_modify_with(args...) CCC_tree_map_and_modify_with(args)
 #    define tree_map_or_insert_with(args...) CCC_tree_map_or_insert_with(args)
 #    define tree_map_insert_entry_with(args...)                                \
         CCC_tree_map_insert_entry_with(args)
 #    define tree_map_try_insert_with(args...) CCC_tree_map_try_insert_with(args)
+#    define tree_map_try_insert_hint(args...) CCC_tree_map_try_insert_hint(args)
 #    define tree_map_insert_or_assign(args...)                                 \
         CCC_tree_map_insert_or_assign(args)
+#    define tree_map_insert_or_assign_hint(args...)                            \
+        CCC_tree_map_insert_or_assign_hint(args)
 #    define tree_map_insert_or_assign_wrap(args...)                            \
         CCC_tree_map_insert_or_assign_wrap(args)
 #    define tree_map_insert_or_assign_with(args...)                            \
@@ -745,6 +1037,7 @@ typedef CCC_Tree_map_entry Tree_map_entry;
 #    define tree_map_remove_entry_wrap(args...)                                \
         CCC_tree_map_remove_entry_wrap(args)
 #    define tree_map_entry_wrap(args...) CCC_tree_map_entry_wrap(args)
+#    define tree_map_entry_hint_wrap(args...) CCC_tree_map_entry_hint_wrap(args)
 #    define tree_map_and_modify_wrap(args...) CCC_tree_map_and_modify_wrap(args)
 #    define tree_map_and_modify_context_wrap(args...)                          \
         CCC_tree_map_and_modify_context_wrap(args)
@@ -755,6 +1048,7 @@ typedef CCC_Tree_map_entry Tree_map_entry;
 #    define tree_map_remove_key_value(args...)                                 \
         CCC_tree_map_remove_key_value(args)
 #    define tree_map_entry(args...) CCC_tree_map_entry(args)
+#    define tree_map_entry_hint(args...) CCC_tree_map_entry_hint(args)
 #    define tree_map_remove_entry(args...) CCC_tree_map_remove_entry(args)
 #    define tree_map_or_insert(args...) CCC_tree_map_or_insert(args)
 #    define tree_map_insert_entry(args...) CCC_tree_map_insert_entry(args)
@@ -766,6 +1060,22 @@ typedef CCC_Tree_map_entry Tree_map_entry;
 #    define tree_map_reverse_next(args...) CCC_tree_map_reverse_next(args)
 #    define tree_map_end(args...) CCC_tree_map_end(args)
 #    define tree_map_reverse_end(args...) CCC_tree_map_reverse_end(args)
+#    define tree_map_enable_order_statistics(args...)                          \
+        CCC_tree_map_enable_order_statistics(args)
+#    define tree_map_rank(args...) CCC_tree_map_rank(args)
+#    define tree_map_select(args...) CCC_tree_map_select(args)
+#    define tree_map_count_range(args...) CCC_tree_map_count_range(args)
+#    define tree_map_join(args...) CCC_tree_map_join(args)
+#    define tree_map_split(args...) CCC_tree_map_split(args)
+#    define tree_map_extract_range(args...) CCC_tree_map_extract_range(args)
+#    define tree_map_union(args...) CCC_tree_map_union(args)
+#    define tree_map_intersection(args...) CCC_tree_map_intersection(args)
+#    define tree_map_difference(args...) CCC_tree_map_difference(args)
+#    define tree_map_union_parallel(args...) CCC_tree_map_union_parallel(args)
+#    define tree_map_intersection_parallel(args...)                            \
+        CCC_tree_map_intersection_parallel(args)
+#    define tree_map_difference_parallel(args...)                              \
+        CCC_tree_map_difference_parallel(args)
 #    define tree_map_count(args...) CCC_tree_map_count(args)
 #    define tree_map_is_empty(args...) CCC_tree_map_is_empty(args)
 #    define tree_map_clear(args...) CCC_tree_map_clear(args)
@@ -288,6 +288,13 @@ typedef struct
     size_t bytes;
     /** Additional state to pass to the allocator to help manage memory. */
     void *context;
+    /** The alignment in bytes requested for new or resized memory. 0 asks
+        for the default alignment of the allocator. Otherwise a power of two.
+        Honoring the request is optional. */
+    size_t alignment;
+    /** The bytes last requested for input when it was allocated or resized.
+        0 when input is NULL or the size is not known to the caller. */
+    size_t old_bytes;
 } CCC_Allocator_context;
 
 /** @brief An allocation function at the core of all containers.
@@ -305,6 +312,22 @@ initialization and the programmer may choose how to best utilize this reference
   pointer returned might not be equal to the pointer provided.
 - If input is non-NULL and size is 0, input is freed and NULL is returned.
 
+Two fields are optional for the allocator to read and every container in this
+collection fills them in where it can.
+
+- The alignment field is a request for memory aligned to a power of two larger
+  than the allocator default, 0 meaning no request. Containers ask for cache
+  line alignment of their hot contiguous arrays so that a probe or scan touches
+  as few lines as possible. An allocator may ignore the request and containers
+  remain correct with the default alignment.
+- The old_bytes field reports the bytes last requested for a non-NULL input on
+  a resize or free. A pool or size class allocator can then resize or free in
+  O(1) without storing a header in front of every block. It is 0 when input is
+  NULL.
+
+Because both fields default to 0 in a designated initializer, allocators
+written before these fields existed need no changes.
+
 One may be tempted to use realloc to check all of these boxes but realloc is
 implementation defined on some of these points. So, the context parameter also
 discourages users from providing realloc. For example, one solution using the
@@ -357,6 +380,15 @@ functions to modify the key or value used to determine sorted order of elements
 in the container. */
 typedef void CCC_Type_modifier(CCC_Type_context);
 
+/** @brief A callback function for deciding whether to keep an element.
+
+A reference to the container type and any context data is available. The
+container pointer points to the base of the user type and is not NULL. Return
+true to keep the element in the container or false to remove it. A predicate is
+used when a container Interface exposes functions to filter many elements in
+one pass. */
+typedef bool CCC_Type_predicate(CCC_Type_context);
+
 /** @brief A callback function for destroying an element in the container.
 
 A reference to the container type and any context data provided on
@@ -625,6 +657,7 @@ typedef CCC_Key_comparator_context Key_comparator_context;
 typedef CCC_Allocator Allocator;
 typedef CCC_Type_comparator Type_comparator;
 typedef CCC_Type_modifier Type_modifier;
+typedef CCC_Type_predicate Type_predicate;
 typedef CCC_Type_destructor Type_destructor;
 typedef CCC_Key_comparator Key_comparator;
 typedef CCC_Key_hasher Key_hasher;
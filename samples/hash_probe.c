@@ -0,0 +1,514 @@
+/** The hash probe program measures how well hash functions spread keys across
+the groups and tags of the flat hash map. Weak hash functions rarely cause
+incorrect behavior, they only cause long probe sequences and many false tag
+matches, so the effect is easy to miss without measurement.
+
+For every key set and hash function the program reports the distribution of
+groups loaded to find each key, the false tag matches per successful search,
+the groups loaded by searches for absent keys, and the time per search in a
+real flat hash map. The distributions come from a model of the map's probing:
+the same triangular probe over groups of tags, the same seven bit tags taken
+from the upper bits of the hash, and the same 7/8 maximum load factor. The
+model makes every probe length observable without instrumenting the map.
+
+Please specify a command as follows:
+./build/[debug/]bin/hash_probe [-n=N] [-group=N]
+-n=N the number of keys in each key set. Default 16384.
+-group=N the group width of the model, 8, 16, 32, or 64. Default 16. */
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+#define HASH_USING_NAMESPACE_CCC
+#define TRAITS_USING_NAMESPACE_CCC
+#define TYPES_USING_NAMESPACE_CCC
+
+#include "ccc/flat_hash_map.h"
+#include "ccc/hash.h"
+#include "ccc/traits.h"
+#include "ccc/types.h"
+#include "utility/allocate.h"
+#include "utility/cli.h"
+#include "utility/random.h"
+#include "utility/string_view/string_view.h"
+
+/** A key in the map is only the key. The value does not affect probing. */
+struct Key
+{
+    uint64_t key;
+};
+
+/** Every hash function is available in two forms. The model calls the hash
+directly and the real map calls the Key_hasher. The mix is an option of the
+map rather than part of the Key_hasher so it is measured as the map uses it. */
+struct Hash_function
+{
+    char const *name;
+    uint64_t (*hash)(uint64_t);
+    Key_hasher *key_hasher;
+    Flat_hash_map_option options;
+};
+
+struct Key_set
+{
+    char const *name;
+    void (*fill)(uint64_t *keys, size_t n, size_t offset);
+};
+
+/** Groups loaded by a search are bucketed for printing. The last bucket
+collects everything at or above its lower bound. */
+struct Histogram_bucket
+{
+    size_t lower;
+    size_t upper;
+};
+
+struct Probe_report
+{
+    double mean_groups;
+    size_t max_groups;
+    double false_tag_matches;
+    double miss_mean_groups;
+    double nanoseconds_per_search;
+    size_t buckets[7];
+};
+
+/*=======================     Constants    ==================================*/
+
+enum : size_t
+{
+    DEFAULT_KEYS = 16384,
+    DEFAULT_GROUP = 16,
+    TAG_BITS = 7,
+};
+
+enum : uint8_t
+{
+    MODEL_EMPTY = 0xFF,
+};
+
+static struct Histogram_bucket const buckets[] = {
+    {1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 8}, {9, 16}, {17, SIZE_MAX},
+};
+static size_t const bucket_count = sizeof(buckets) / sizeof(buckets[0]);
+
+static SV_String_view const directions
+    = SV("\nPlease specify a command as follows:\n"
+         "./build/[debug/]bin/hash_probe [-n=N] [-group=N]\n"
+         "-n=N\n"
+         "\tthe number of keys in each key set. Default 16384.\n"
+         "-group=N\n"
+         "\tthe group width of the model, 8, 16, 32, or 64. Default 16.\n");
+
+/*=======================   Prototypes     ==================================*/
+
+/* Hash Functions */
+static uint64_t identity(uint64_t);
+static uint64_t identity_mixed(uint64_t);
+static uint64_t fibonacci(uint64_t);
+static uint64_t seeded(uint64_t);
+static uint64_t identity_key(Key_context);
+static uint64_t fibonacci_key(Key_context);
+
+/* Key Sets */
+static void fill_sequential(uint64_t *keys, size_t n, size_t offset);
+static void fill_strided(uint64_t *keys, size_t n, size_t offset);
+static void fill_high_bits(uint64_t *keys, size_t n, size_t offset);
+static void fill_random(uint64_t *keys, size_t n, size_t offset);
+
+/* Measurement */
+static struct Probe_report model_probes(struct Hash_function const *,
+                                        uint64_t const *keys,
+                                        uint64_t const *absent, size_t n,
+                                        size_t group);
+static double time_searches(struct Hash_function const *, uint64_t const *keys,
+                            size_t n);
+static Order order_keys(Key_comparator_context);
+static double now_nanoseconds(void);
+static size_t model_capacity(size_t n, size_t group);
+static void print_report(char const *key_set, char const *hash,
+                         struct Probe_report const *);
+static struct Int_conversion parse_flag_value(SV_String_view arg);
+
+/*=======================     Main         ==================================*/
+
+int
+main(int argc, char *argv[])
+{
+    size_t n = DEFAULT_KEYS;
+    size_t group = DEFAULT_GROUP;
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        SV_String_view const sv_arg = SV_sv(argv[arg]);
+        if (SV_starts_with(sv_arg, SV("-h")))
+        {
+            SV_print(stdout, directions);
+            return 0;
+        }
+        struct Int_conversion const c = parse_flag_value(sv_arg);
+        if (c.status == CONV_ER || c.conversion <= 0)
+        {
+            quit("flag values must be positive integers.\n", 1);
+        }
+        if (SV_starts_with(sv_arg, SV("-n=")))
+        {
+            n = (size_t)c.conversion;
+        }
+        else if (SV_starts_with(sv_arg, SV("-group=")))
+        {
+            group = (size_t)c.conversion;
+            if (group != 8 && group != 16 && group != 32 && group != 64)
+            {
+                quit("group width must be 8, 16, 32, or 64.\n", 1);
+            }
+        }
+        else
+        {
+            SV_print(stdout, directions);
+            return 1;
+        }
+    }
+    static struct Hash_function const hashes[] = {
+        {"identity", identity, identity_key, CCC_FLAT_HASH_MAP_OPTION_NONE},
+        {"identity+mix", identity_mixed, identity_key,
+         CCC_FLAT_HASH_MAP_OPTION_MIX_HASH},
+        {"fibonacci", fibonacci, fibonacci_key, CCC_FLAT_HASH_MAP_OPTION_NONE},
+        {"hash_u64", seeded, hash_key_u64, CCC_FLAT_HASH_MAP_OPTION_NONE},
+    };
+    static struct Key_set const key_sets[] = {
+        {"sequential", fill_sequential},
+        {"stride 4096", fill_strided},
+        {"high bits", fill_high_bits},
+        {"random", fill_random},
+    };
+    uint64_t *const keys = malloc(sizeof(uint64_t) * n * 2);
+    if (!keys)
+    {
+        quit("could not allocate keys.\n", 1);
+    }
+    uint64_t *const absent = keys + n;
+    random_seed((unsigned)time(NULL));
+    (void)printf("%zu keys, model group width %zu, table capacity %zu\n", n,
+                 group, model_capacity(n, group));
+    (void)printf("%-12s %-13s %6s %5s %6s %6s %7s  %s\n", "keys", "hash",
+                 "mean", "max", "tag fp", "miss", "ns/find",
+                 "% of keys found in 1,2,3,4,5-8,9-16,17+ groups");
+    for (size_t k = 0; k < sizeof(key_sets) / sizeof(key_sets[0]); ++k)
+    {
+        /* Absent keys come from the same distribution as present keys. */
+        key_sets[k].fill(keys, n, 0);
+        key_sets[k].fill(absent, n, n);
+        for (size_t h = 0; h < sizeof(hashes) / sizeof(hashes[0]); ++h)
+        {
+            struct Probe_report report
+                = model_probes(&hashes[h], keys, absent, n, group);
+            report.nanoseconds_per_search = time_searches(&hashes[h], keys, n);
+            print_report(key_sets[k].name, hashes[h].name, &report);
+        }
+    }
+    free(keys);
+    return 0;
+}
+
+/*=======================   Measurement    ==================================*/
+
+/** Inserts every key into a model table and then searches for every present
+and absent key, counting the groups loaded and the tag matches that are not
+the key. A search loads a group starting at the current index, checks the tags
+that match, and stops at the key or at a group containing an empty slot. */
+static struct Probe_report
+model_probes(struct Hash_function const *const fn, uint64_t const *const keys,
+             uint64_t const *const absent, size_t const n, size_t const group)
+{
+    struct Probe_report report = {};
+    size_t const capacity = model_capacity(n, group);
+    size_t const mask = capacity - 1;
+    uint8_t *const tags = malloc(capacity);
+    size_t *const owners = malloc(sizeof(size_t) * capacity);
+    if (!tags || !owners)
+    {
+        quit_and("could not allocate model table.\n", 1, free(tags);
+                 free(owners););
+    }
+    memset(tags, MODEL_EMPTY, capacity);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t const hash = fn->hash(keys[i]);
+        size_t index = hash & mask;
+        for (size_t stride = group;; index = (index + stride) & mask,
+                    stride += group)
+        {
+            size_t slot = 0;
+            while (slot < group && tags[(index + slot) & mask] != MODEL_EMPTY)
+            {
+                ++slot;
+            }
+            if (slot != group)
+            {
+                tags[(index + slot) & mask]
+                    = (uint8_t)(hash >> (64 - TAG_BITS));
+                owners[(index + slot) & mask] = i;
+                break;
+            }
+        }
+    }
+    size_t total_groups = 0;
+    size_t total_false = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t const hash = fn->hash(keys[i]);
+        uint8_t const tag = (uint8_t)(hash >> (64 - TAG_BITS));
+        size_t index = hash & mask;
+        size_t groups = 1;
+        for (size_t stride = group;; index = (index + stride) & mask,
+                    stride += group, ++groups)
+        {
+            bool found = false;
+            for (size_t slot = 0; slot < group && !found; ++slot)
+            {
+                size_t const s = (index + slot) & mask;
+                if (tags[s] == tag)
+                {
+                    found = owners[s] == i;
+                    total_false += !found;
+                }
+            }
+            if (found)
+            {
+                break;
+            }
+        }
+        total_groups += groups;
+        report.max_groups = groups > report.max_groups ? groups
+                                                       : report.max_groups;
+        for (size_t b = 0; b < bucket_count; ++b)
+        {
+            if (groups >= buckets[b].lower && groups <= buckets[b].upper)
+            {
+                ++report.buckets[b];
+                break;
+            }
+        }
+    }
+    size_t miss_groups = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t const hash = fn->hash(absent[i]);
+        size_t index = hash & mask;
+        for (size_t stride = group;; index = (index + stride) & mask,
+                    stride += group)
+        {
+            ++miss_groups;
+            bool has_empty = false;
+            for (size_t slot = 0; slot < group && !has_empty; ++slot)
+            {
+                has_empty = tags[(index + slot) & mask] == MODEL_EMPTY;
+            }
+            if (has_empty)
+            {
+                break;
+            }
+        }
+    }
+    report.mean_groups = (double)total_groups / (double)n;
+    report.false_tag_matches = (double)total_false / (double)n;
+    report.miss_mean_groups = (double)miss_groups / (double)n;
+    free(tags);
+    free(owners);
+    return report;
+}
+
+/** Times only successful searches so that the cost reflects the probe
+lengths measured by the model, including the cost of the hash itself. */
+static double
+time_searches(struct Hash_function const *const fn, uint64_t const *const keys,
+              size_t const n)
+{
+    Flat_hash_map map = flat_hash_map_initialize_with_options(
+        NULL, struct Key, key, fn->key_hasher, order_keys, std_allocate, NULL,
+        0, fn->options);
+    if (flat_hash_map_reserve(&map, n, std_allocate) != CCC_RESULT_OK)
+    {
+        quit("could not reserve flat hash map.\n", 1);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&map, &(struct Key){keys[i]});
+        if (insert_error(&e))
+        {
+            quit_and("could not insert into flat hash map.\n", 1,
+                     flat_hash_map_clear_and_free(&map, NULL););
+        }
+    }
+    size_t found = 0;
+    double const start = now_nanoseconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        found += get_key_value(&map, &keys[i]) != NULL;
+    }
+    double const end = now_nanoseconds();
+    if (found != n)
+    {
+        quit_and("flat hash map lost keys.\n", 1,
+                 flat_hash_map_clear_and_free(&map, NULL););
+    }
+    (void)flat_hash_map_clear_and_free(&map, NULL);
+    return (end - start) / (double)n;
+}
+
+/** The smallest power of two capacity that holds n keys at a 7/8 load factor,
+and at least one group, as the map chooses for a reserved table. */
+static size_t
+model_capacity(size_t const n, size_t const group)
+{
+    size_t capacity = group;
+    while ((capacity / 8) * 7 < n)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static void
+print_report(char const *const key_set, char const *const hash,
+             struct Probe_report const *const r)
+{
+    size_t total = 0;
+    for (size_t b = 0; b < bucket_count; ++b)
+    {
+        total += r->buckets[b];
+    }
+    (void)printf("%-12s %-13s %6.2f %5zu %6.2f %6.2f %7.1f ", key_set, hash,
+                 r->mean_groups, r->max_groups, r->false_tag_matches,
+                 r->miss_mean_groups, r->nanoseconds_per_search);
+    for (size_t b = 0; b < bucket_count; ++b)
+    {
+        (void)printf(" %5.1f",
+                     total ? 100.0 * (double)r->buckets[b] / (double)total
+                           : 0.0);
+    }
+    (void)printf("\n");
+}
+
+static double
+now_nanoseconds(void)
+{
+    struct timespec t = {};
+    (void)timespec_get(&t, TIME_UTC);
+    return ((double)t.tv_sec * 1e9) + (double)t.tv_nsec;
+}
+
+static Order
+order_keys(Key_comparator_context const order)
+{
+    uint64_t const *const left = order.key_left;
+    struct Key const *const right = order.type_right;
+    return (*left > right->key) - (*left < right->key);
+}
+
+static struct Int_conversion
+parse_flag_value(SV_String_view arg)
+{
+    size_t const eql = SV_rfind(arg, SV_npos(arg), SV("="));
+    if (eql == SV_npos(arg))
+    {
+        return (struct Int_conversion){.status = CONV_ER};
+    }
+    arg = SV_substr(arg, eql + 1, ULLONG_MAX);
+    if (SV_empty(arg))
+    {
+        return (struct Int_conversion){.status = CONV_ER};
+    }
+    return convert_to_int(SV_begin(arg));
+}
+
+/*=======================   Hash Functions   ================================*/
+
+/** The most common user hash for integers. Low bits vary but every upper bit,
+and thus every tag, is zero for small keys. */
+static uint64_t
+identity(uint64_t const key)
+{
+    return key;
+}
+
+static uint64_t
+identity_mixed(uint64_t const key)
+{
+    return hash_mix(key);
+}
+
+/** Multiplicative hashing spreads the upper bits well but the low bits of the
+product only depend on the low bits of the key. */
+static uint64_t
+fibonacci(uint64_t const key)
+{
+    return key * UINT64_C(0x9E3779B97F4A7C15);
+}
+
+static uint64_t
+seeded(uint64_t const key)
+{
+    return hash_u64(key, HASH_DEFAULT_SEED);
+}
+
+static uint64_t
+identity_key(Key_context const k)
+{
+    return identity(*(uint64_t const *)k.key);
+}
+
+static uint64_t
+fibonacci_key(Key_context const k)
+{
+    return fibonacci(*(uint64_t const *)k.key);
+}
+
+/*=======================     Key Sets     ==================================*/
+
+static void
+fill_sequential(uint64_t *const keys, size_t const n, size_t const offset)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = i + offset;
+    }
+}
+
+/** Keys such as aligned addresses or scaled identifiers share low bits. */
+static void
+fill_strided(uint64_t *const keys, size_t const n, size_t const offset)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = (i + offset) << 12;
+    }
+}
+
+/** Keys such as packed pairs vary only in their upper half. */
+static void
+fill_high_bits(uint64_t *const keys, size_t const n, size_t const offset)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = (uint64_t)(i + offset) << 32;
+    }
+}
+
+/** Random keys have no pattern for a weak hash function to fail on. */
+static void
+fill_random(uint64_t *const keys, size_t const n, size_t const)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t const high = (uint64_t)rand_range(0, INT_MAX);
+        uint64_t const low = (uint64_t)rand_range(0, INT_MAX);
+        keys[i] = (high << 31) | low;
+    }
+}
@@ -339,6 +339,7 @@ CCC_adaptive_map_remove_key_value(
             .input = n,
             .bytes = 0,
             .context = map->context,
+            .old_bytes = map->sizeof_type,
         });
         return (CCC_Entry){{
             .type = any_struct,
@@ -369,6 +370,7 @@ CCC_adaptive_map_remove_entry(CCC_Adaptive_map_entry *const e)
                 .input = erased,
                 .bytes = 0,
                 .context = e->private.map->context,
+                .old_bytes = e->private.map->sizeof_type,
             });
             return (CCC_Entry){{
                 .type = NULL,
@@ -552,6 +554,7 @@ CCC_adaptive_map_clear(CCC_Adaptive_map *const map,
                 .input = del,
                 .bytes = 0,
                 .context = map->context,
+                .old_bytes = map->sizeof_type,
             });
         }
         node = next;
@@ -725,6 +725,7 @@ CCC_array_adaptive_map_clear_and_free(CCC_Array_adaptive_map *const map,
     {
         delete_nodes(map, destroy);
     }
+    size_t const old_bytes = total_bytes(map->sizeof_type, map->capacity);
     map->root = 0;
     map->count = 0;
     map->capacity = 0;
@@ -732,6 +733,7 @@ CCC_array_adaptive_map_clear_and_free(CCC_Array_adaptive_map *const map,
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     map->nodes = NULL;
@@ -751,6 +753,7 @@ CCC_array_adaptive_map_clear_and_free_reserve(
     {
         delete_nodes(map, destroy);
     }
+    size_t const old_bytes = total_bytes(map->sizeof_type, map->capacity);
     map->root = 0;
     map->count = 0;
     map->capacity = 0;
@@ -758,6 +761,7 @@ CCC_array_adaptive_map_clear_and_free_reserve(
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     return CCC_RESULT_OK;
@@ -946,6 +950,7 @@ resize(struct CCC_Array_adaptive_map *const map, size_t const new_capacity,
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = total_bytes(map->sizeof_type, map->capacity),
     });
     map->data = new_data;
     map->capacity = new_capacity;
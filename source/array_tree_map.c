@@ -58,6 +58,7 @@ to that section, in my opinion. */
 #include <string.h>
 
 #include "array_tree_map.h"
+#include "buffer.h"
 #include "private/private_array_tree_map.h"
 #include "private/private_types.h"
 #include "types.h"
@@ -176,6 +177,28 @@ struct Query
     };
 };
 
+/** @internal A tree cut loose from the map by a split or join. Only the parity
+of a rank is stored in the tree so the rank of the root travels with it. An
+empty tree is the sentinel with rank -1. */
+struct Subtree
+{
+    /** The root of the tree or 0 if it is empty. */
+    size_t root;
+    /** The rank of the root. */
+    int rank;
+};
+
+/** @internal The result of splitting a tree around a key. */
+struct Split
+{
+    /** The nodes with keys less than the split key. */
+    struct Subtree lesser;
+    /** The node with the split key or 0 if it is absent. */
+    size_t equal;
+    /** The nodes with keys greater than the split key. */
+    struct Subtree greater;
+};
+
 #define INORDER R
 #define INORDER_REVERSE L
 
@@ -203,12 +226,16 @@ static_assert(PARITY_BLOCK_BITS >> PARITY_BLOCK_BITS_LOG2 == 1,
 /* Returning the user struct type with stored offsets. */
 static void insert(struct CCC_Array_tree_map *, size_t, CCC_Order, size_t);
 static CCC_Result resize(struct CCC_Array_tree_map *, size_t, CCC_Allocator *);
-static void copy_soa(struct CCC_Array_tree_map const *, void *, size_t);
+static void copy_soa(struct CCC_Array_tree_map const *, void *, size_t,
+                     CCC_Tribool);
 static size_t data_bytes(size_t, size_t);
 static size_t node_bytes(size_t);
 static size_t parity_bytes(size_t);
+static size_t count_offset(size_t, size_t);
 static struct CCC_Array_tree_map_node *node_pos(size_t, void const *, size_t);
 static Parity_block *parity_pos(size_t, void const *, size_t);
+static size_t *count_pos(size_t, void const *, size_t);
+static void locate_arrays(struct CCC_Array_tree_map *, void const *, size_t);
 static size_t maybe_allocate_insert(struct CCC_Array_tree_map *, size_t,
                                     CCC_Order, void const *);
 static size_t remove_fixup(struct CCC_Array_tree_map *, size_t);
@@ -223,9 +250,19 @@ node_at(struct CCC_Array_tree_map const *, size_t);
 static void *data_at(struct CCC_Array_tree_map const *, size_t);
 /* Returning the internal query helper to aid in handle handling. */
 static struct Query find(struct CCC_Array_tree_map const *, void const *);
+static struct Query find_from(struct CCC_Array_tree_map const *, size_t,
+                              CCC_Order, void const *);
+static struct Query find_hint(struct CCC_Array_tree_map const *, size_t,
+                              void const *);
+static CCC_Handle try_insert(struct CCC_Array_tree_map *, struct Query,
+                             void const *);
+static CCC_Handle insert_or_assign(struct CCC_Array_tree_map *, struct Query,
+                                   void const *);
 /* Returning the handle core to the Handle Interface. */
 static inline struct CCC_Array_tree_map_handle
 handle(struct CCC_Array_tree_map const *, void const *);
+static struct CCC_Array_tree_map_handle
+handle_from(struct CCC_Array_tree_map const *, struct Query);
 /* Returning a generic range that can be use for range or range_reverse. */
 static struct CCC_Handle_range equal_range(struct CCC_Array_tree_map const *,
                                            void const *, void const *,
@@ -265,7 +302,7 @@ static CCC_Tribool is_22_parent(struct CCC_Array_tree_map const *, size_t,
 static CCC_Tribool is_leaf(struct CCC_Array_tree_map const *, size_t);
 static CCC_Tribool parity(struct CCC_Array_tree_map const *, size_t);
 static void set_parity(struct CCC_Array_tree_map const *, size_t, CCC_Tribool);
-static size_t total_bytes(size_t, size_t);
+static size_t total_bytes(size_t, size_t, CCC_Tribool);
 static size_t block_count(size_t);
 static CCC_Tribool validate(struct CCC_Array_tree_map const *);
 /* Returning void and maintaining the WAVL tree. */
@@ -285,6 +322,59 @@ static void double_rotate(struct CCC_Array_tree_map *, size_t, size_t, size_t,
 /* Returning void as miscellaneous helpers. */
 static void swap(void *, void *, void *, size_t);
 static size_t max(size_t, size_t);
+static CCC_Tribool is_strictly_sorted(struct CCC_Array_tree_map const *,
+                                      CCC_Buffer const *);
+static size_t build_sorted(struct CCC_Array_tree_map *, size_t, size_t,
+                           size_t *);
+/* Subtree counts for order statistics. */
+static size_t subtree_count(struct CCC_Array_tree_map const *, size_t);
+static void update_count(struct CCC_Array_tree_map const *, size_t);
+static void add_path_count(struct CCC_Array_tree_map const *, size_t, size_t);
+static void subtract_path_count(struct CCC_Array_tree_map const *, size_t,
+                                size_t);
+static size_t count_subtrees(struct CCC_Array_tree_map const *, size_t);
+static size_t rank_of(struct CCC_Array_tree_map const *, void const *);
+static CCC_Tribool are_compatible(struct CCC_Array_tree_map const *,
+                                  struct CCC_Array_tree_map const *);
+static CCC_Result reserve_slots(struct CCC_Array_tree_map *, size_t);
+static size_t tree_size(struct CCC_Array_tree_map const *, size_t);
+static int rank_difference(struct CCC_Array_tree_map const *, size_t, size_t);
+static struct Subtree whole_tree(struct CCC_Array_tree_map const *);
+static struct Subtree child_tree(struct CCC_Array_tree_map const *,
+                                 struct Subtree, enum Link);
+static struct Subtree detach(struct CCC_Array_tree_map const *, size_t,
+                             enum Link, int);
+static size_t root_of(struct CCC_Array_tree_map const *, size_t);
+static struct Subtree join(struct CCC_Array_tree_map *, struct Subtree, size_t,
+                           struct Subtree);
+static struct Subtree join_spine(struct CCC_Array_tree_map *, struct Subtree,
+                                 size_t, struct Subtree, enum Link);
+static CCC_Tribool join_fixup(struct CCC_Array_tree_map *, size_t, size_t);
+static struct Subtree join_trees(struct CCC_Array_tree_map *, struct Subtree,
+                                 struct Subtree);
+static struct Split split(struct CCC_Array_tree_map *, struct Subtree,
+                          void const *);
+static struct Subtree split_last(struct CCC_Array_tree_map *, struct Subtree,
+                                 size_t *);
+static struct Subtree union_trees(struct CCC_Array_tree_map *, struct Subtree,
+                                  struct CCC_Array_tree_map const *,
+                                  struct Subtree);
+static struct Subtree intersect_trees(struct CCC_Array_tree_map *,
+                                      struct Subtree,
+                                      struct CCC_Array_tree_map const *,
+                                      struct Subtree, CCC_Type_destructor *);
+static struct Subtree subtract_trees(struct CCC_Array_tree_map *,
+                                     struct Subtree,
+                                     struct CCC_Array_tree_map const *,
+                                     struct Subtree, CCC_Type_destructor *);
+static size_t copy_subtree(struct CCC_Array_tree_map *,
+                           struct CCC_Array_tree_map const *, size_t);
+static struct Subtree move_subtree(struct CCC_Array_tree_map *,
+                                   struct CCC_Array_tree_map *, struct Subtree);
+static void delete_node(struct CCC_Array_tree_map *, size_t,
+                        CCC_Type_destructor *);
+static size_t delete_tree(struct CCC_Array_tree_map *, size_t,
+                          CCC_Type_destructor *);
 
 /*==============================  Interface    ==============================*/
 
@@ -364,26 +454,19 @@ CCC_array_tree_map_try_insert(CCC_Array_tree_map *const map,
     {
         return (CCC_Handle){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    struct Query const q = find(map, key_in_slot(map, type));
-    if (CCC_ORDER_EQUAL == q.last_order)
-    {
-        return (CCC_Handle){{
-            .index = q.found,
-            .status = CCC_ENTRY_OCCUPIED,
-        }};
-    }
-    size_t const i = maybe_allocate_insert(map, q.parent, q.last_order, type);
-    if (!i)
+    return try_insert(map, find(map, key_in_slot(map, type)), type);
+}
+
+CCC_Handle
+CCC_array_tree_map_try_insert_hint(CCC_Array_tree_map *const map,
+                                   CCC_Handle_index const hint,
+                                   void const *const type)
+{
+    if (!map || !type)
     {
-        return (CCC_Handle){{
-            .index = 0,
-            .status = CCC_ENTRY_INSERT_ERROR,
-        }};
+        return (CCC_Handle){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    return (CCC_Handle){{
-        .index = i,
-        .status = CCC_ENTRY_VACANT,
-    }};
+    return try_insert(map, find_hint(map, hint, key_in_slot(map, type)), type);
 }
 
 CCC_Handle
@@ -394,28 +477,20 @@ CCC_array_tree_map_insert_or_assign(CCC_Array_tree_map *const map,
     {
         return (CCC_Handle){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    struct Query const q = find(map, key_in_slot(map, type));
-    if (CCC_ORDER_EQUAL == q.last_order)
-    {
-        void *const found = data_at(map, q.found);
-        (void)memcpy(found, type, map->sizeof_type);
-        return (CCC_Handle){{
-            .index = q.found,
-            .status = CCC_ENTRY_OCCUPIED,
-        }};
-    }
-    size_t const i = maybe_allocate_insert(map, q.parent, q.last_order, type);
-    if (!i)
+    return insert_or_assign(map, find(map, key_in_slot(map, type)), type);
+}
+
+CCC_Handle
+CCC_array_tree_map_insert_or_assign_hint(CCC_Array_tree_map *const map,
+                                         CCC_Handle_index const hint,
+                                         void const *const type)
+{
+    if (!map || !type)
     {
-        return (CCC_Handle){{
-            .index = 0,
-            .status = CCC_ENTRY_INSERT_ERROR,
-        }};
+        return (CCC_Handle){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    return (CCC_Handle){{
-        .index = i,
-        .status = CCC_ENTRY_VACANT,
-    }};
+    return insert_or_assign(map, find_hint(map, hint, key_in_slot(map, type)),
+                            type);
 }
 
 CCC_Array_tree_map_handle *
@@ -498,6 +573,20 @@ CCC_array_tree_map_handle(CCC_Array_tree_map const *const map,
     return (CCC_Array_tree_map_handle){handle(map, key)};
 }
 
+CCC_Array_tree_map_handle
+CCC_array_tree_map_handle_hint(CCC_Array_tree_map const *const map,
+                               CCC_Handle_index const hint,
+                               void const *const key)
+{
+    if (!map || !key)
+    {
+        return (CCC_Array_tree_map_handle){
+            {.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    return (CCC_Array_tree_map_handle){
+        handle_from(map, find_hint(map, hint, key))};
+}
+
 CCC_Handle
 CCC_array_tree_map_remove_handle(CCC_Array_tree_map_handle const *const h)
 {
@@ -737,16 +826,58 @@ CCC_array_tree_map_reserve(CCC_Array_tree_map *const map, size_t const to_add,
     }
     old_cap = old_count ? old_cap : 0;
     size_t const new_cap = map->capacity;
-    size_t prev = 0;
+    /* New slots lead into any slots that were already free so none are lost. */
+    size_t prev = old_count ? map->free_list : 0;
     for (ptrdiff_t i = (ptrdiff_t)new_cap - 1; i > 0 && i >= (ptrdiff_t)old_cap;
          prev = i, --i)
     {
         node_at(map, i)->next_free = prev;
     }
-    if (!map->free_list)
+    map->free_list = prev;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_array_tree_map_from_sorted(CCC_Array_tree_map *const map,
+                               CCC_Buffer const *const sorted)
+{
+    if (!map || !sorted || map->count > 1
+        || (sorted->count
+            && (!sorted->data || sorted->sizeof_type != map->sizeof_type))
+        || !is_strictly_sorted(map, sorted))
     {
-        map->free_list = prev;
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    size_t const n = sorted->count;
+    if (!n)
+    {
+        return CCC_RESULT_OK;
+    }
+    /* The sentinel at slot 0 takes one slot so the elements fill 1 to N. */
+    if (map->capacity < n + 1)
+    {
+        CCC_Result const r = resize(map, n + 1, map->allocate);
+        if (r != CCC_RESULT_OK)
+        {
+            return r;
+        }
+    }
+    else
+    {
+        locate_arrays(map, map->data, map->capacity);
+    }
+    (void)memcpy(data_at(map, 1), sorted->data, n * map->sizeof_type);
+    size_t rank = 0;
+    map->root = build_sorted(map, 1, n, &rank);
+    node_at(map, map->root)->parent = 0;
+    set_parity(map, 0, CCC_TRUE);
+    map->count = n + 1;
+    size_t prev = 0;
+    for (size_t i = map->capacity - 1; i > n; prev = i, --i)
+    {
+        node_at(map, i)->next_free = prev;
     }
+    map->free_list = prev;
     return CCC_RESULT_OK;
 }
 
@@ -764,14 +895,18 @@ CCC_array_tree_map_copy(CCC_Array_tree_map *const destination,
     struct CCC_Array_tree_map_node *const destination_nodes
         = destination->nodes;
     Parity_block *const destination_parity = destination->parity;
+    size_t *const destination_counts = destination->counts;
     size_t const destination_cap = destination->capacity;
     CCC_Allocator *const destination_allocate = destination->allocate;
+    bool const destination_order_statistics = destination->order_statistics;
     *destination = *source;
     destination->data = destination_data;
     destination->nodes = destination_nodes;
     destination->parity = destination_parity;
+    destination->counts = destination_counts;
     destination->capacity = destination_cap;
     destination->allocate = destination_allocate;
+    destination->order_statistics = destination_order_statistics;
     if (!source->capacity)
     {
         return CCC_RESULT_OK;
@@ -787,16 +922,20 @@ CCC_array_tree_map_copy(CCC_Array_tree_map *const destination,
     else
     {
         /* Might not be necessary but not worth finding out. Do every time. */
-        destination->nodes = node_pos(destination->sizeof_type,
-                                      destination->data, destination->capacity);
-        destination->parity = parity_pos(
-            destination->sizeof_type, destination->data, destination->capacity);
+        locate_arrays(destination, destination->data, destination->capacity);
     }
     if (!destination->data || !source->data)
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
-    copy_soa(source, destination->data, destination->capacity);
+    copy_soa(source, destination->data, destination->capacity,
+             destination->order_statistics);
+    /* The destination layout decides if counts exist so a destination that
+       keeps counts for a source that does not must count the copied tree. */
+    if (destination->order_statistics && !source->order_statistics)
+    {
+        (void)count_subtrees(destination, destination->root);
+    }
     return CCC_RESULT_OK;
 }
 
@@ -829,16 +968,22 @@ CCC_array_tree_map_clear_and_free(CCC_Array_tree_map *const map,
     {
         delete_nodes(map, destroy);
     }
+    size_t const old_bytes
+        = total_bytes(map->sizeof_type, map->capacity, map->order_statistics);
     map->root = 0;
+    map->count = 0;
+    map->free_list = 0;
     map->capacity = 0;
     (void)map->allocate((CCC_Allocator_context){
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     map->nodes = NULL;
     map->parity = NULL;
+    map->counts = NULL;
     return CCC_RESULT_OK;
 }
 
@@ -855,16 +1000,295 @@ CCC_array_tree_map_clear_and_free_reserve(CCC_Array_tree_map *const map,
     {
         delete_nodes(map, destroy);
     }
+    size_t const old_bytes
+        = total_bytes(map->sizeof_type, map->capacity, map->order_statistics);
     map->root = 0;
+    map->count = 0;
+    map->free_list = 0;
     map->capacity = 0;
     (void)allocate((CCC_Allocator_context){
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     map->nodes = NULL;
     map->parity = NULL;
+    map->counts = NULL;
+    return CCC_RESULT_OK;
+}
+
+/** The counts array only exists in the allocation of a map that asked for it
+so enabling moves the map into a new allocation of the same capacity with room
+for counts and then counts the existing nodes in one postorder pass. */
+CCC_Result
+CCC_array_tree_map_enable_order_statistics(CCC_Array_tree_map *const map)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (map->order_statistics)
+    {
+        return CCC_RESULT_OK;
+    }
+    if (!map->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    if (!map->data)
+    {
+        map->order_statistics = true;
+        return CCC_RESULT_OK;
+    }
+    void *const new_data = map->allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = total_bytes(map->sizeof_type, map->capacity, CCC_TRUE),
+        .context = map->context,
+    });
+    if (!new_data)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    copy_soa(map, new_data, map->capacity, CCC_FALSE);
+    (void)map->allocate((CCC_Allocator_context){
+        .input = map->data,
+        .bytes = 0,
+        .context = map->context,
+        .old_bytes = total_bytes(map->sizeof_type, map->capacity, CCC_FALSE),
+    });
+    map->data = new_data;
+    map->order_statistics = true;
+    locate_arrays(map, map->data, map->capacity);
+    (void)count_subtrees(map, map->root);
+    return CCC_RESULT_OK;
+}
+
+CCC_Count
+CCC_array_tree_map_rank(CCC_Array_tree_map const *const map,
+                        void const *const key)
+{
+    if (!map || !key || !map->order_statistics)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = rank_of(map, key)};
+}
+
+CCC_Handle_index
+CCC_array_tree_map_select(CCC_Array_tree_map const *const map, size_t index)
+{
+    if (!map || !map->order_statistics || !map->count
+        || index >= map->count - 1)
+    {
+        return 0;
+    }
+    size_t node = map->root;
+    while (node)
+    {
+        size_t const left = subtree_count(map, branch_index(map, node, L));
+        if (index == left)
+        {
+            return node;
+        }
+        if (index < left)
+        {
+            node = branch_index(map, node, L);
+        }
+        else
+        {
+            index -= left + 1;
+            node = branch_index(map, node, R);
+        }
+    }
+    return 0;
+}
+
+CCC_Count
+CCC_array_tree_map_count_range(CCC_Array_tree_map const *const map,
+                               void const *const begin_key,
+                               void const *const end_key)
+{
+    if (!map || !begin_key || !end_key || !map->order_statistics)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    size_t const begin = rank_of(map, begin_key);
+    size_t const end = rank_of(map, end_key);
+    return (CCC_Count){.count = end > begin ? end - begin : 0};
+}
+
+/** The source is copied into the destination as one tree of the same shape and
+the last node of the destination joins the two trees. The source slots are then
+returned to the free list of the source. */
+CCC_Result
+CCC_array_tree_map_join(CCC_Array_tree_map *const destination,
+                        CCC_Array_tree_map *const source)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!source->root)
+    {
+        return CCC_RESULT_OK;
+    }
+    if (destination->root
+        && order_nodes(destination,
+                       key_at(source, min_max_from(source, source->root, L)),
+                       min_max_from(destination, destination->root, R),
+                       destination->compare)
+               != CCC_ORDER_GREATER)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    CCC_Result const r = reserve_slots(destination, source->count - 1);
+    if (r != CCC_RESULT_OK)
+    {
+        return r;
+    }
+    struct Subtree joined
+        = move_subtree(destination, source, whole_tree(source));
+    if (destination->root)
+    {
+        size_t last = 0;
+        struct Subtree const rest
+            = split_last(destination, whole_tree(destination), &last);
+        joined = join(destination, rest, last, joined);
+    }
+    destination->root = joined.root;
+    source->root = 0;
+    return CCC_RESULT_OK;
+}
+
+/** If the destination cannot hold the split elements the two halves are joined
+back together so a failed split leaves the map as it was. */
+CCC_Result
+CCC_array_tree_map_split(CCC_Array_tree_map *const map, void const *const key,
+                         CCC_Array_tree_map *const destination)
+{
+    if (!map || !key || !destination || destination->root
+        || !are_compatible(map, destination))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct Split const parts = split(map, whole_tree(map), key);
+    struct Subtree greater = parts.greater;
+    if (parts.equal)
+    {
+        greater
+            = join(map, (struct Subtree){.rank = -1}, parts.equal, greater);
+    }
+    CCC_Result const r
+        = reserve_slots(destination, tree_size(map, greater.root));
+    if (r != CCC_RESULT_OK)
+    {
+        map->root = join_trees(map, parts.lesser, greater).root;
+        return r;
+    }
+    destination->root = move_subtree(destination, map, greater).root;
+    map->root = parts.lesser.root;
+    return CCC_RESULT_OK;
+}
+
+/** Two splits isolate the range and one join closes the gap it leaves. A range
+that ends before it begins is empty because everything not less than the begin
+key is then greater than the end key. */
+CCC_Result
+CCC_array_tree_map_extract_range(CCC_Array_tree_map *const map,
+                                 void const *const begin_key,
+                                 void const *const end_key,
+                                 CCC_Array_tree_map *const destination)
+{
+    if (!map || !begin_key || !end_key || !destination || destination->root
+        || !are_compatible(map, destination))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct Split const first = split(map, whole_tree(map), begin_key);
+    struct Subtree middle = first.greater;
+    if (first.equal)
+    {
+        middle = join(map, (struct Subtree){.rank = -1}, first.equal, middle);
+    }
+    struct Split const second = split(map, middle, end_key);
+    struct Subtree greater = second.greater;
+    if (second.equal)
+    {
+        greater
+            = join(map, (struct Subtree){.rank = -1}, second.equal, greater);
+    }
+    CCC_Result const r
+        = reserve_slots(destination, tree_size(map, second.lesser.root));
+    if (r != CCC_RESULT_OK)
+    {
+        map->root
+            = join_trees(map, join_trees(map, first.lesser, second.lesser),
+                         greater)
+                  .root;
+        return r;
+    }
+    destination->root = move_subtree(destination, map, second.lesser).root;
+    map->root = join_trees(map, first.lesser, greater).root;
+    return CCC_RESULT_OK;
+}
+
+/** Room for every source element is reserved up front so the union cannot
+fail part way through, even though keys already in the destination are not
+copied. */
+CCC_Result
+CCC_array_tree_map_union(CCC_Array_tree_map *const destination,
+                         CCC_Array_tree_map const *const source)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!source->root)
+    {
+        return CCC_RESULT_OK;
+    }
+    CCC_Result const r = reserve_slots(destination, source->count - 1);
+    if (r != CCC_RESULT_OK)
+    {
+        return r;
+    }
+    destination->root = union_trees(destination, whole_tree(destination),
+                                    source, whole_tree(source))
+                            .root;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_array_tree_map_intersection(CCC_Array_tree_map *const destination,
+                                CCC_Array_tree_map const *const source,
+                                CCC_Type_destructor *const destroy)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    destination->root
+        = intersect_trees(destination, whole_tree(destination), source,
+                          whole_tree(source), destroy)
+              .root;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_array_tree_map_difference(CCC_Array_tree_map *const destination,
+                              CCC_Array_tree_map const *const source,
+                              CCC_Type_destructor *const destroy)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    destination->root
+        = subtract_trees(destination, whole_tree(destination), source,
+                         whole_tree(source), destroy)
+              .root;
     return CCC_RESULT_OK;
 }
 
@@ -961,9 +1385,7 @@ allocate_slot(struct CCC_Array_tree_map *const map)
         }
         else
         {
-            map->nodes = node_pos(map->sizeof_type, map->data, map->capacity);
-            map->parity
-                = parity_pos(map->sizeof_type, map->data, map->capacity);
+            locate_arrays(map, map->data, map->capacity);
         }
         old_cap = old_count ? old_cap : 0;
         size_t const new_cap = map->capacity;
@@ -1000,20 +1422,22 @@ resize(struct CCC_Array_tree_map *const map, size_t const new_capacity,
     }
     void *const new_data = allocate((CCC_Allocator_context){
         .input = NULL,
-        .bytes = total_bytes(map->sizeof_type, new_capacity),
+        .bytes
+        = total_bytes(map->sizeof_type, new_capacity, map->order_statistics),
         .context = map->context,
     });
     if (!new_data)
     {
         return CCC_RESULT_ALLOCATOR_ERROR;
     }
-    copy_soa(map, new_data, new_capacity);
-    map->nodes = node_pos(map->sizeof_type, new_data, new_capacity);
-    map->parity = parity_pos(map->sizeof_type, new_data, new_capacity);
+    copy_soa(map, new_data, new_capacity, map->order_statistics);
+    locate_arrays(map, new_data, new_capacity);
     allocate((CCC_Allocator_context){
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes
+        = total_bytes(map->sizeof_type, map->capacity, map->order_statistics),
     });
     map->data = new_data;
     map->capacity = new_capacity;
@@ -1040,6 +1464,10 @@ insert(struct CCC_Array_tree_map *const map, size_t const parent_i,
         parent->branch[CCC_ORDER_GREATER == last_order] = elem_i;
     }
     elem->parent = parent_i;
+    if (map->order_statistics)
+    {
+        add_path_count(map, parent_i, 1);
+    }
     if (rank_rule_break)
     {
         insert_fixup(map, parent_i, elem_i);
@@ -1049,7 +1477,12 @@ insert(struct CCC_Array_tree_map *const map, size_t const parent_i,
 static struct CCC_Array_tree_map_handle
 handle(struct CCC_Array_tree_map const *const map, void const *const key)
 {
-    struct Query const q = find(map, key);
+    return handle_from(map, find(map, key));
+}
+
+static struct CCC_Array_tree_map_handle
+handle_from(struct CCC_Array_tree_map const *const map, struct Query const q)
+{
     if (CCC_ORDER_EQUAL == q.last_order)
     {
         return (struct CCC_Array_tree_map_handle){
@@ -1067,18 +1500,121 @@ handle(struct CCC_Array_tree_map const *const map, void const *const key)
     };
 }
 
-static struct Query
-find(struct CCC_Array_tree_map const *const map, void const *const key)
+/** Attempts to insert the user type if the query did not find its key. */
+static CCC_Handle
+try_insert(struct CCC_Array_tree_map *const map, struct Query const q,
+           void const *const type)
 {
-    size_t parent = 0;
-    struct Query q = {
-        .last_order = CCC_ORDER_ERROR,
-        .found = map->root,
-    };
-    while (q.found)
+    if (CCC_ORDER_EQUAL == q.last_order)
     {
-        q.last_order = order_nodes(map, key, q.found, map->compare);
-        if (CCC_ORDER_EQUAL == q.last_order)
+        return (CCC_Handle){{
+            .index = q.found,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    size_t const i = maybe_allocate_insert(map, q.parent, q.last_order, type);
+    if (!i)
+    {
+        return (CCC_Handle){{
+            .index = 0,
+            .status = CCC_ENTRY_INSERT_ERROR,
+        }};
+    }
+    return (CCC_Handle){{
+        .index = i,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+/** Overwrites the element the query found or inserts the user type. */
+static CCC_Handle
+insert_or_assign(struct CCC_Array_tree_map *const map, struct Query const q,
+                 void const *const type)
+{
+    if (CCC_ORDER_EQUAL == q.last_order)
+    {
+        (void)memcpy(data_at(map, q.found), type, map->sizeof_type);
+        return (CCC_Handle){{
+            .index = q.found,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    return try_insert(map, q, type);
+}
+
+static struct Query
+find(struct CCC_Array_tree_map const *const map, void const *const key)
+{
+    return find_from(map, 0, CCC_ORDER_ERROR, key);
+}
+
+/** Starts the search for the key at a slot in the map rather than the root. A
+hint is a node whose subtree the key may not be in, so the search first walks
+up. Ancestors reached from their near side are on the same side of the key as
+the hint and are passed without a comparison. Each ancestor reached from the far
+side bounds the keys next to the hint, so it is compared and the walk stops at
+the first one the key does not pass. The search then descends from the last
+node the key passed. A key next to the hint, such as a new greatest key after
+the previous greatest key, is found with one or two comparisons. A hint of 0, a
+hint out of bounds, or an empty map searches from the root. */
+static struct Query
+find_hint(struct CCC_Array_tree_map const *const map, size_t const hint,
+          void const *const key)
+{
+    if (!hint || !map->root || hint >= map->capacity)
+    {
+        return find(map, key);
+    }
+    size_t passed = hint;
+    CCC_Order const side = order_nodes(map, key, passed, map->compare);
+    if (CCC_ORDER_EQUAL == side)
+    {
+        return (struct Query){
+            .last_order = side,
+            .found = passed,
+        };
+    }
+    enum Link const dir = CCC_ORDER_GREATER == side;
+    for (size_t x = passed, p = parent_index(map, x); p;
+         x = p, p = parent_index(map, p))
+    {
+        if (branch_index(map, p, dir) == x)
+        {
+            continue;
+        }
+        CCC_Order const o = order_nodes(map, key, p, map->compare);
+        if (CCC_ORDER_EQUAL == o)
+        {
+            return (struct Query){
+                .last_order = o,
+                .found = p,
+            };
+        }
+        if (o != side)
+        {
+            break;
+        }
+        passed = p;
+    }
+    return find_from(map, passed, side, key);
+}
+
+/** Continues a search below the parent in the direction of the last order or
+from the root if the parent is the sentinel. */
+static struct Query
+find_from(struct CCC_Array_tree_map const *const map, size_t parent,
+          CCC_Order const last_order, void const *const key)
+{
+    struct Query q = {
+        .last_order = last_order,
+        .found = parent ? branch_index(map, parent,
+                                       CCC_ORDER_GREATER == last_order)
+                        : map->root,
+    };
+    while (q.found)
+    {
+        q.last_order = order_nodes(map, key, q.found, map->compare);
+        if (CCC_ORDER_EQUAL == q.last_order)
         {
             return q;
         }
@@ -1232,7 +1768,8 @@ node_bytes(size_t const capacity)
 
 /** Calculates the number of bytes needed for the parity block bit array. No
 rounding up or alignment concerns need apply because this is the last array
-in the allocation. */
+in the allocation unless order statistics add the counts array, which finds its
+own aligned start with count_offset. */
 static inline size_t
 parity_bytes(size_t capacity)
 {
@@ -1249,12 +1786,31 @@ on an aligned byte boundary for its own type. This means that the bytes returned
 by this function may be greater than summing the (sizeof(type) * capacity) for
 each array in the conceptual struct. */
 static inline size_t
-total_bytes(size_t sizeof_type, size_t const capacity)
+total_bytes(size_t sizeof_type, size_t const capacity,
+            CCC_Tribool const counted)
 {
+    if (counted)
+    {
+        return count_offset(sizeof_type, capacity)
+             + (sizeof(*(struct CCC_Array_tree_map){}.counts) * capacity);
+    }
     return data_bytes(sizeof_type, capacity) + node_bytes(capacity)
          + parity_bytes(capacity);
 }
 
+/** Returns the offset of the counts array from the data base pointer. The end
+of the parity bit array is rounded up to the alignment of a count. The padding
+is only paid by maps with order statistics because no other map has a counts
+array. */
+static inline size_t
+count_offset(size_t const sizeof_type, size_t const capacity)
+{
+    return (data_bytes(sizeof_type, capacity) + node_bytes(capacity)
+            + parity_bytes(capacity)
+            + alignof(*(struct CCC_Array_tree_map){}.counts) - 1)
+         & ~(alignof(*(struct CCC_Array_tree_map){}.counts) - 1);
+}
+
 /** Returns the base of the node array relative to the data base pointer. This
 positions is guaranteed to be the first aligned byte given the alignment of the
 node type after the data array. The data array has added any necessary padding
@@ -1281,14 +1837,39 @@ parity_pos(size_t const sizeof_type, void const *const data,
                             + node_bytes(capacity));
 }
 
+/** Returns the base of the counts array relative to the data base pointer. Only
+valid for an allocation made with room for counts. */
+static inline size_t *
+count_pos(size_t const sizeof_type, void const *const data,
+          size_t const capacity)
+{
+    return (size_t *)((char *)data + count_offset(sizeof_type, capacity));
+}
+
+/** Points the array fields of the map into the allocation at data for the
+given capacity. The counts array is only carved when the map maintains order
+statistics. */
+static inline void
+locate_arrays(struct CCC_Array_tree_map *const map, void const *const data,
+              size_t const capacity)
+{
+    map->nodes = node_pos(map->sizeof_type, data, capacity);
+    map->parity = parity_pos(map->sizeof_type, data, capacity);
+    map->counts = map->order_statistics
+                    ? count_pos(map->sizeof_type, data, capacity)
+                    : NULL;
+}
+
 /** Copies over the Struct of Arrays contained within the one contiguous
 allocation of the map to the new memory provided. Assumes the new_data pointer
 points to the base of an allocation that has been allocated with sufficient
 bytes to support the user data, nodes, and parity arrays for the provided new
-capacity. */
+capacity, and the counts array if counted is true. Counts are only copied if
+both the source and destination layouts have them. */
 static inline void
 copy_soa(struct CCC_Array_tree_map const *const source,
-         void *const destination_data_base, size_t const destination_capacity)
+         void *const destination_data_base, size_t const destination_capacity,
+         CCC_Tribool const counted)
 {
     if (!source->data)
     {
@@ -1308,14 +1889,90 @@ copy_soa(struct CCC_Array_tree_map const *const source,
         parity_pos(sizeof_type, destination_data_base, destination_capacity),
         parity_pos(sizeof_type, source->data, source->capacity),
         parity_bytes(source->capacity));
+    if (counted && source->order_statistics)
+    {
+        (void)memcpy(
+            count_pos(sizeof_type, destination_data_base, destination_capacity),
+            count_pos(sizeof_type, source->data, source->capacity),
+            sizeof(*source->counts) * source->capacity);
+    }
+}
+
+static CCC_Tribool
+is_strictly_sorted(struct CCC_Array_tree_map const *const map,
+                   CCC_Buffer const *const sorted)
+{
+    for (size_t i = 1; i < sorted->count; ++i)
+    {
+        char const *const prev
+            = (char const *)sorted->data + ((i - 1) * map->sizeof_type);
+        if (map->compare((CCC_Key_comparator_context){
+                .key_left = key_in_slot(map, prev + map->sizeof_type),
+                .type_right = prev,
+                .context = map->context,
+            })
+            != CCC_ORDER_GREATER)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Builds a tree over the count consecutive slots starting at first and
+returns the index of its root. The left subtree receives the larger half so its
+rank is the maximum of the two and the rank of the root is one more, or 0 for a
+leaf. Halving keeps sibling ranks within one of each other so every rank
+difference is 1 or 2, a valid WAVL tree in which no leaf is a 2,2 node. The
+recursion depth is lg N. */
+static size_t
+build_sorted(struct CCC_Array_tree_map *const map, size_t const first,
+             size_t const count, size_t *const rank)
+{
+    if (!count)
+    {
+        return 0;
+    }
+    size_t left_rank = 0;
+    size_t right_rank = 0;
+    size_t const root = first + (count / 2);
+    size_t const left = build_sorted(map, first, count / 2, &left_rank);
+    size_t const right
+        = build_sorted(map, root + 1, count - (count / 2) - 1, &right_rank);
+    struct CCC_Array_tree_map_node *const node = node_at(map, root);
+    node->branch[L] = left;
+    node->branch[R] = right;
+    if (left)
+    {
+        node_at(map, left)->parent = root;
+    }
+    if (right)
+    {
+        node_at(map, right)->parent = root;
+    }
+    *rank = left ? left_rank + 1 : 0;
+    set_parity(map, root, *rank & 1);
+    if (map->order_statistics)
+    {
+        map->counts[root] = count;
+    }
+    return root;
 }
 
+/* NOLINTEND(*misc-no-recursion) */
+
 static inline void
 init_node(struct CCC_Array_tree_map const *const map, size_t const node)
 {
     set_parity(map, node, CCC_FALSE);
     struct CCC_Array_tree_map_node *const e = node_at(map, node);
     e->branch[L] = e->branch[R] = e->parent = 0;
+    if (map->order_statistics)
+    {
+        map->counts[node] = 1;
+    }
 }
 
 static inline void
@@ -1491,6 +2148,10 @@ remove_fixup(struct CCC_Array_tree_map *const map, size_t const remove)
             map->root = x;
         }
         *branch_pointer(map, p, branch_index(map, p, R) == y) = x;
+        if (map->order_statistics)
+        {
+            subtract_path_count(map, p, 1);
+        }
         two_child = is_2_child(map, p, y);
     }
     else
@@ -1505,6 +2166,12 @@ remove_fixup(struct CCC_Array_tree_map *const map, size_t const remove)
 
         two_child = is_2_child(map, p, y);
         *branch_pointer(map, p, branch_index(map, p, R) == y) = x;
+        /* The path from the spliced parent passes through remove so the count
+           y inherits from remove in the transplant is already correct. */
+        if (map->order_statistics)
+        {
+            subtract_path_count(map, p, 1);
+        }
         transplant(map, remove, y);
         if (remove == p)
         {
@@ -1561,6 +2228,10 @@ transplant(struct CCC_Array_tree_map *const map, size_t const remove,
     *parent_pointer(map, remove_r->branch[L]) = replacement;
     replace_r->branch[R] = remove_r->branch[R];
     replace_r->branch[L] = remove_r->branch[L];
+    if (map->order_statistics)
+    {
+        map->counts[replacement] = map->counts[remove];
+    }
     set_parity(map, replacement, parity(map, remove));
 }
 
@@ -1674,6 +2345,11 @@ rotate(struct CCC_Array_tree_map *const map, size_t const z, size_t const x,
     z_r->parent = x;
     z_r->branch[!dir] = y;
     *parent_pointer(map, y) = z;
+    if (map->order_statistics)
+    {
+        map->counts[x] = map->counts[z];
+        update_count(map, z);
+    }
 }
 
 /** A double rotation shouldn't actually be two calls to rotate because that
@@ -1717,6 +2393,12 @@ double_rotate(struct CCC_Array_tree_map *const map, size_t const z,
     *parent_pointer(map, y_r->branch[!dir]) = z;
     y_r->branch[!dir] = z;
     z_r->parent = y;
+    if (map->order_statistics)
+    {
+        map->counts[y] = map->counts[z];
+        update_count(map, x);
+        update_count(map, z);
+    }
 }
 
 /* Returns true for rank difference 0 (rule break) between the parent and node.
@@ -1870,6 +2552,588 @@ max(size_t const a, size_t const b)
     return a > b ? a : b;
 }
 
+/*========================   Order Statistics   =============================*/
+
+/** The counts array is only present when order statistics are enabled so every
+function in this section may only be called by such a map. The sentinel at index
+0 stands in for every empty subtree but its count is never written. */
+static inline size_t
+subtree_count(struct CCC_Array_tree_map const *const map, size_t const node)
+{
+    return node ? map->counts[node] : 0;
+}
+
+/** Rotations rebuild counts from the children of each moved node. */
+static inline void
+update_count(struct CCC_Array_tree_map const *const map, size_t const node)
+{
+    struct CCC_Array_tree_map_node const *const n = node_at(map, node);
+    map->counts[node] = 1 + subtree_count(map, n->branch[L])
+                      + subtree_count(map, n->branch[R]);
+}
+
+static inline void
+add_path_count(struct CCC_Array_tree_map const *const map, size_t node,
+               size_t const n)
+{
+    for (; node; node = parent_index(map, node))
+    {
+        map->counts[node] += n;
+    }
+}
+
+static inline void
+subtract_path_count(struct CCC_Array_tree_map const *const map, size_t node,
+                    size_t const n)
+{
+    for (; node; node = parent_index(map, node))
+    {
+        map->counts[node] -= n;
+    }
+}
+
+/** The number of keys in the map strictly less than the given key. */
+static size_t
+rank_of(struct CCC_Array_tree_map const *const map, void const *const key)
+{
+    size_t rank = 0;
+    size_t node = map->root;
+    while (node)
+    {
+        if (order_nodes(map, key, node, map->compare) == CCC_ORDER_GREATER)
+        {
+            rank += subtree_count(map, branch_index(map, node, L)) + 1;
+            node = branch_index(map, node, R);
+        }
+        else
+        {
+            node = branch_index(map, node, L);
+        }
+    }
+    return rank;
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Counts every subtree in postorder, writing the counts if the map has a
+counts array. The recursion depth is bounded by the height of the tree. */
+static size_t
+count_subtrees(struct CCC_Array_tree_map const *const map, size_t const node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    struct CCC_Array_tree_map_node const *const n = node_at(map, node);
+    size_t const count = 1 + count_subtrees(map, n->branch[L])
+                       + count_subtrees(map, n->branch[R]);
+    if (map->order_statistics)
+    {
+        map->counts[node] = count;
+    }
+    return count;
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
+/*=========================   Join and Split   =============================*/
+
+/** Elements are copied between the arrays of two maps so the maps only need to
+agree on the layout of the user type and the ordering of keys. */
+static CCC_Tribool
+are_compatible(struct CCC_Array_tree_map const *const a,
+               struct CCC_Array_tree_map const *const b)
+{
+    return a != b && a->sizeof_type == b->sizeof_type
+        && a->key_offset == b->key_offset && a->compare == b->compare;
+}
+
+/** Makes room for n more elements before an operation that copies elements
+begins so the operation cannot fail part way through. A map without an
+allocation function must already have the room. */
+static CCC_Result
+reserve_slots(struct CCC_Array_tree_map *const map, size_t const n)
+{
+    if (!n || map->count + n + (map->count == 0) <= map->capacity)
+    {
+        return CCC_RESULT_OK;
+    }
+    if (!map->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    return CCC_array_tree_map_reserve(map, n, map->allocate);
+}
+
+/** The number of nodes in a tree produced by a split. */
+static size_t
+tree_size(struct CCC_Array_tree_map const *const map, size_t const root)
+{
+    return map->order_statistics ? subtree_count(map, root)
+                                  : count_subtrees(map, root);
+}
+
+/** Ranks are only stored as parity but a valid rank difference is 1 or 2, so
+the parity of a parent and child tells the two apart. The sentinel has the
+parity of rank -1 so it works as an empty child. */
+static inline int
+rank_difference(struct CCC_Array_tree_map const *const map, size_t const parent,
+                size_t const child)
+{
+    return parity(map, parent) == parity(map, child) ? 2 : 1;
+}
+
+/** Recovers the rank of the root by summing rank differences down to the
+sentinel. */
+static struct Subtree
+whole_tree(struct CCC_Array_tree_map const *const map)
+{
+    int rank = -1;
+    for (size_t x = map->root; x; x = branch_index(map, x, L))
+    {
+        rank += rank_difference(map, x, branch_index(map, x, L));
+    }
+    return (struct Subtree){.root = map->root, .rank = rank};
+}
+
+/** The child of the root of a tree in the given direction without cutting it
+loose. Used to walk a source map that is only read. */
+static struct Subtree
+child_tree(struct CCC_Array_tree_map const *const map,
+           struct Subtree const tree, enum Link const dir)
+{
+    size_t const child = branch_index(map, tree.root, dir);
+    return (struct Subtree){
+        .root = child,
+        .rank = tree.rank - rank_difference(map, tree.root, child),
+    };
+}
+
+/** Cuts the child of a node in the given direction loose as its own tree. */
+static struct Subtree
+detach(struct CCC_Array_tree_map const *const map, size_t const parent,
+       enum Link const dir, int const parent_rank)
+{
+    size_t const child = branch_index(map, parent, dir);
+    int const rank = parent_rank - rank_difference(map, parent, child);
+    node_at(map, parent)->branch[dir] = 0;
+    if (child)
+    {
+        node_at(map, child)->parent = 0;
+    }
+    return (struct Subtree){.root = child, .rank = rank};
+}
+
+static size_t
+root_of(struct CCC_Array_tree_map const *const map, size_t node)
+{
+    for (; parent_index(map, node); node = parent_index(map, node))
+    {}
+    return node;
+}
+
+/** Joins two trees and a middle node with a key between them. If the ranks are
+within one of each other the middle node becomes the root. Otherwise the middle
+node is placed on the spine of the taller tree. The cost is proportional to the
+difference in rank. */
+static struct Subtree
+join(struct CCC_Array_tree_map *const map, struct Subtree const lesser,
+     size_t const middle, struct Subtree const greater)
+{
+    if (lesser.rank > greater.rank + 1)
+    {
+        return join_spine(map, lesser, middle, greater, R);
+    }
+    if (greater.rank > lesser.rank + 1)
+    {
+        return join_spine(map, greater, middle, lesser, L);
+    }
+    int const rank
+        = (lesser.rank > greater.rank ? lesser.rank : greater.rank) + 1;
+    struct CCC_Array_tree_map_node *const m = node_at(map, middle);
+    m->branch[L] = lesser.root;
+    m->branch[R] = greater.root;
+    m->parent = 0;
+    if (lesser.root)
+    {
+        node_at(map, lesser.root)->parent = middle;
+    }
+    if (greater.root)
+    {
+        node_at(map, greater.root)->parent = middle;
+    }
+    set_parity(map, middle, rank & 1);
+    if (map->order_statistics)
+    {
+        update_count(map, middle);
+    }
+    return (struct Subtree){.root = middle, .rank = rank};
+}
+
+/** Walks down the spine of the taller tree facing the shorter tree to the first
+node with a rank no more than one above the shorter tree. That node and the
+shorter tree become the children of the middle node which takes its place. The
+parent on the spine had a rank at least two above the shorter tree so the middle
+node is a 0 or 1 child and any rank rule break is repaired on the way up. */
+static struct Subtree
+join_spine(struct CCC_Array_tree_map *const map, struct Subtree const taller,
+           size_t const middle, struct Subtree const shorter,
+           enum Link const dir)
+{
+    size_t parent = 0;
+    size_t cut = taller.root;
+    int parent_rank = taller.rank;
+    int cut_rank = taller.rank;
+    while (cut_rank > shorter.rank + 1)
+    {
+        parent = cut;
+        parent_rank = cut_rank;
+        cut = branch_index(map, parent, dir);
+        cut_rank -= rank_difference(map, parent, cut);
+    }
+    assert(parent);
+    int const middle_rank = cut_rank + 1;
+    struct CCC_Array_tree_map_node *const m = node_at(map, middle);
+    m->branch[!dir] = cut;
+    m->branch[dir] = shorter.root;
+    if (cut)
+    {
+        node_at(map, cut)->parent = middle;
+    }
+    if (shorter.root)
+    {
+        node_at(map, shorter.root)->parent = middle;
+    }
+    set_parity(map, middle, middle_rank & 1);
+    m->parent = parent;
+    node_at(map, parent)->branch[dir] = middle;
+    if (map->order_statistics)
+    {
+        for (size_t x = middle; x; x = parent_index(map, x))
+        {
+            update_count(map, x);
+        }
+    }
+    int rank = taller.rank;
+    if (parent_rank == middle_rank && join_fixup(map, parent, middle))
+    {
+        ++rank;
+    }
+    return (struct Subtree){.root = root_of(map, taller.root), .rank = rank};
+}
+
+/** Repairs a 0 child x of z left by a join. This is the insertion fix up with
+one more case. The middle node of a join may be a 1,1 node under a 0,2 parent,
+which insertion never produces. A single rotation lifts x over z and a promotion
+of x leaves it a 1,2 node so the repair continues as an insertion would. Returns
+true if the rank of the root of the whole tree grew. */
+static CCC_Tribool
+join_fixup(struct CCC_Array_tree_map *const map, size_t z, size_t x)
+{
+    for (;;)
+    {
+        if (parity(map, z) != parity(map, sibling_of(map, x)))
+        {
+            promote(map, z);
+            x = z;
+            z = parent_index(map, z);
+            if (!z)
+            {
+                return CCC_TRUE;
+            }
+            if (parity(map, z) != parity(map, x))
+            {
+                return CCC_FALSE;
+            }
+            continue;
+        }
+        enum Link const p_to_x_dir = branch_index(map, z, R) == x;
+        size_t const y = branch_index(map, x, !p_to_x_dir);
+        if (parity(map, x) != parity(map, branch_index(map, x, L))
+            && parity(map, x) != parity(map, branch_index(map, x, R)))
+        {
+            size_t const g = parent_index(map, z);
+            CCC_Tribool const makes_0_child
+                = g && parity(map, g) != parity(map, z);
+            rotate(map, z, x, y, !p_to_x_dir);
+            promote(map, x);
+            if (!g)
+            {
+                return CCC_TRUE;
+            }
+            if (!makes_0_child)
+            {
+                return CCC_FALSE;
+            }
+            z = g;
+            continue;
+        }
+        if (!y || is_2_child(map, x, y))
+        {
+            rotate(map, z, x, y, !p_to_x_dir);
+            demote(map, z);
+        }
+        else
+        {
+            double_rotate(map, z, x, y, p_to_x_dir);
+            promote(map, y);
+            demote(map, x);
+            demote(map, z);
+        }
+        return CCC_FALSE;
+    }
+}
+
+/** Joins two trees without a middle node by borrowing the last node of the
+lesser tree. */
+static struct Subtree
+join_trees(struct CCC_Array_tree_map *const map, struct Subtree const lesser,
+           struct Subtree const greater)
+{
+    if (!lesser.root)
+    {
+        return greater;
+    }
+    if (!greater.root)
+    {
+        return lesser;
+    }
+    size_t last = 0;
+    struct Subtree const rest = split_last(map, lesser, &last);
+    return join(map, rest, last, greater);
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Splits a tree into the nodes less than and greater than the key by cutting
+the search path apart and joining the pieces on each side from the bottom up.
+The joins on each side climb in rank so the total cost is O(lg N). */
+static struct Split
+split(struct CCC_Array_tree_map *const map, struct Subtree const tree,
+      void const *const key)
+{
+    if (!tree.root)
+    {
+        return (struct Split){
+            .lesser = tree,
+            .greater = tree,
+        };
+    }
+    size_t const root = tree.root;
+    struct Subtree const left = detach(map, root, L, tree.rank);
+    struct Subtree const right = detach(map, root, R, tree.rank);
+    CCC_Order const o = order_nodes(map, key, root, map->compare);
+    if (o == CCC_ORDER_EQUAL)
+    {
+        return (struct Split){
+            .lesser = left,
+            .equal = root,
+            .greater = right,
+        };
+    }
+    if (o == CCC_ORDER_LESSER)
+    {
+        struct Split parts = split(map, left, key);
+        parts.greater = join(map, parts.greater, root, right);
+        return parts;
+    }
+    struct Split parts = split(map, right, key);
+    parts.lesser = join(map, left, root, parts.lesser);
+    return parts;
+}
+
+/** Removes the last node of a tree, handing it back through the output
+parameter, and returns the rest of the tree. */
+static struct Subtree
+split_last(struct CCC_Array_tree_map *const map, struct Subtree const tree,
+           size_t *const last)
+{
+    size_t const root = tree.root;
+    struct Subtree const left = detach(map, root, L, tree.rank);
+    if (!branch_index(map, root, R))
+    {
+        *last = root;
+        return left;
+    }
+    struct Subtree const rest
+        = split_last(map, detach(map, root, R, tree.rank), last);
+    return join(map, left, root, rest);
+}
+
+/** The root of the source tree b splits the destination tree a and each side
+is merged recursively before the two sides are joined around the destination
+element with that key or a new copy of the source element. The recursion follows
+the height of b and the cost is O(M lg(N / M + 1)) for trees of size M and N
+with M <= N. */
+static struct Subtree
+union_trees(struct CCC_Array_tree_map *const map, struct Subtree const a,
+            struct CCC_Array_tree_map const *const source,
+            struct Subtree const b)
+{
+    if (!b.root)
+    {
+        return a;
+    }
+    if (!a.root)
+    {
+        return (struct Subtree){
+            .root = copy_subtree(map, source, b.root),
+            .rank = b.rank,
+        };
+    }
+    struct Split const parts = split(map, a, key_at(source, b.root));
+    struct Subtree const lesser
+        = union_trees(map, parts.lesser, source, child_tree(source, b, L));
+    struct Subtree const greater
+        = union_trees(map, parts.greater, source, child_tree(source, b, R));
+    size_t middle = parts.equal;
+    if (!middle)
+    {
+        middle = allocate_slot(map);
+        assert(middle);
+        (void)memcpy(data_at(map, middle), data_at(source, b.root),
+                     map->sizeof_type);
+    }
+    return join(map, lesser, middle, greater);
+}
+
+/** Keeps the destination element with the key of the root of the source tree
+b if there is one. Destination elements left over when b runs out are dropped
+along with the nodes that are not found. */
+static struct Subtree
+intersect_trees(struct CCC_Array_tree_map *const map, struct Subtree const a,
+                struct CCC_Array_tree_map const *const source,
+                struct Subtree const b, CCC_Type_destructor *const destroy)
+{
+    if (!a.root)
+    {
+        return a;
+    }
+    if (!b.root)
+    {
+        (void)delete_tree(map, a.root, destroy);
+        return (struct Subtree){.rank = -1};
+    }
+    struct Split const parts = split(map, a, key_at(source, b.root));
+    struct Subtree const lesser = intersect_trees(
+        map, parts.lesser, source, child_tree(source, b, L), destroy);
+    struct Subtree const greater = intersect_trees(
+        map, parts.greater, source, child_tree(source, b, R), destroy);
+    if (parts.equal)
+    {
+        return join(map, lesser, parts.equal, greater);
+    }
+    return join_trees(map, lesser, greater);
+}
+
+/** Drops the destination element with the key of the root of the source tree
+b if there is one and closes the gap with a join. */
+static struct Subtree
+subtract_trees(struct CCC_Array_tree_map *const map, struct Subtree const a,
+               struct CCC_Array_tree_map const *const source,
+               struct Subtree const b, CCC_Type_destructor *const destroy)
+{
+    if (!a.root || !b.root)
+    {
+        return a;
+    }
+    struct Split const parts = split(map, a, key_at(source, b.root));
+    struct Subtree const lesser = subtract_trees(
+        map, parts.lesser, source, child_tree(source, b, L), destroy);
+    struct Subtree const greater = subtract_trees(
+        map, parts.greater, source, child_tree(source, b, R), destroy);
+    if (parts.equal)
+    {
+        delete_node(map, parts.equal, destroy);
+    }
+    return join_trees(map, lesser, greater);
+}
+
+/** Copies a tree of the source into new slots of the map with the same shape
+and ranks and returns the new root. The slots must already be reserved. */
+static size_t
+copy_subtree(struct CCC_Array_tree_map *const map,
+             struct CCC_Array_tree_map const *const source, size_t const node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    size_t const left
+        = copy_subtree(map, source, branch_index(source, node, L));
+    size_t const right
+        = copy_subtree(map, source, branch_index(source, node, R));
+    size_t const slot = allocate_slot(map);
+    assert(slot);
+    (void)memcpy(data_at(map, slot), data_at(source, node), map->sizeof_type);
+    struct CCC_Array_tree_map_node *const n = node_at(map, slot);
+    n->branch[L] = left;
+    n->branch[R] = right;
+    n->parent = 0;
+    if (left)
+    {
+        node_at(map, left)->parent = slot;
+    }
+    if (right)
+    {
+        node_at(map, right)->parent = slot;
+    }
+    set_parity(map, slot, parity(source, node));
+    if (map->order_statistics)
+    {
+        map->counts[slot]
+            = 1 + subtree_count(map, left) + subtree_count(map, right);
+    }
+    return slot;
+}
+
+/** Frees every node of a tree and returns how many there were. */
+static size_t
+delete_tree(struct CCC_Array_tree_map *const map, size_t const root,
+            CCC_Type_destructor *const destroy)
+{
+    if (!root)
+    {
+        return 0;
+    }
+    size_t const left = branch_index(map, root, L);
+    size_t const right = branch_index(map, root, R);
+    delete_node(map, root, destroy);
+    return 1 + delete_tree(map, left, destroy)
+         + delete_tree(map, right, destroy);
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
+/** Copies a tree of the source into the map and returns the source slots to the
+free list of the source. The caller sets the root of the source. */
+static struct Subtree
+move_subtree(struct CCC_Array_tree_map *const map,
+             struct CCC_Array_tree_map *const source, struct Subtree const tree)
+{
+    size_t const root = copy_subtree(map, source, tree.root);
+    (void)delete_tree(source, tree.root, NULL);
+    return (struct Subtree){.root = root, .rank = tree.rank};
+}
+
+/** Returns the slot of a node that is no longer in the tree to the free list
+after the destructor, if any, has run on the element. */
+static void
+delete_node(struct CCC_Array_tree_map *const map, size_t const node,
+            CCC_Type_destructor *const destroy)
+{
+    if (destroy)
+    {
+        destroy((CCC_Type_context){
+            .type = data_at(map, node),
+            .context = map->context,
+        });
+    }
+    node_at(map, node)->next_free = map->free_list;
+    map->free_list = node;
+    --map->count;
+}
+
 /*===========================   Validation   ===============================*/
 
 /* NOLINTBEGIN(*misc-no-recursion) */
@@ -1942,6 +3206,23 @@ is_storing_parent(struct CCC_Array_tree_map const *const map, size_t const p,
         && is_storing_parent(map, root, branch_index(map, root, R));
 }
 
+static CCC_Tribool
+are_counts_valid(struct CCC_Array_tree_map const *const map, size_t const root)
+{
+    if (!root)
+    {
+        return CCC_TRUE;
+    }
+    if (subtree_count(map, root)
+        != 1 + subtree_count(map, branch_index(map, root, L))
+               + subtree_count(map, branch_index(map, root, R)))
+    {
+        return CCC_FALSE;
+    }
+    return are_counts_valid(map, branch_index(map, root, L))
+        && are_counts_valid(map, branch_index(map, root, R));
+}
+
 static CCC_Tribool
 is_free_list_valid(struct CCC_Array_tree_map const *const map)
 {
@@ -2000,6 +3281,10 @@ validate(struct CCC_Array_tree_map const *const map)
     {
         return CCC_FALSE;
     }
+    if (map->order_statistics && !are_counts_valid(map, map->root))
+    {
+        return CCC_FALSE;
+    }
     return CCC_TRUE;
 }
 
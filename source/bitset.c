@@ -995,6 +995,9 @@ CCC_bitset_clear_and_free(CCC_Bitset *const bitset)
             .input = bitset->blocks,
             .bytes = 0,
             .context = bitset->context,
+            .old_bytes = bitset->capacity
+                           ? block_count(bitset->capacity) * SIZEOF_BLOCK
+                           : 0,
         });
     }
     bitset->count = 0;
@@ -1017,6 +1020,9 @@ CCC_bitset_clear_and_free_reserve(CCC_Bitset *const bitset,
             .input = bitset->blocks,
             .bytes = 0,
             .context = bitset->context,
+            .old_bytes = bitset->capacity
+                           ? block_count(bitset->capacity) * SIZEOF_BLOCK
+                           : 0,
         });
     }
     bitset->count = 0;
@@ -1055,6 +1061,11 @@ CCC_bitset_copy(CCC_Bitset *const destination, CCC_Bitset const *const source,
             .input = destination->blocks,
             .bytes = block_count(source->capacity) * SIZEOF_BLOCK,
             .context = destination->context,
+            .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+            .old_bytes
+            = destination->capacity
+                ? block_count(destination->capacity) * SIZEOF_BLOCK
+                : 0,
         });
         if (!new_data)
         {
@@ -1168,6 +1179,10 @@ maybe_resize(struct CCC_Bitset *const bitset, size_t const to_add,
         .input = bitset->blocks,
         .bytes = block_count(bits_needed) * SIZEOF_BLOCK,
         .context = bitset->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+        .old_bytes = bitset->capacity
+                       ? block_count(bitset->capacity) * SIZEOF_BLOCK
+                       : 0,
     });
     if (!new_data)
     {
@@ -0,0 +1,1311 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a B+ tree map. User types live only in the leaves, which
+are linked in key order. Branches hold separator copies of user types that
+route a search. The separator at index i of a branch is greater than every key
+in child i and not greater than any key in child i + 1. A separator is a copy
+of the first user type of a leaf when the leaf split or borrowed, so it stays a
+valid bound after the user type it copied is removed.
+
+Every node is one allocation of node_bytes. Nodes have one slot beyond their
+capacity so an insertion always fits before the node is split in half. The
+splits an insertion will cause are counted and their nodes allocated before the
+tree is touched, so a failed allocation leaves the map as it was. Removal
+borrows from a sibling with more than the minimum or merges with one, which may
+cascade up to the root. The root is the only node allowed to be less than half
+full.
+
+The comparison callback compares a key to a complete user type, so the search
+within a node runs over the contiguous user types of a leaf or separators of a
+branch rather than a dedicated key array. The search is a branchless binary
+search. The only data dependent branch per node is the loop bound.
+
+Every node is aligned to its size so the leaf of a user type is found by
+masking its address, which makes each step of iteration O(1). Nodes request
+that alignment from the allocator. If an allocation ignores the request the
+node is instead placed at the aligned address within an allocation of twice
+the size, whose address is stored in the word before the node. */
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "btree_map.h"
+#include "private/private_btree_map.h"
+#include "private/private_types.h"
+#include "types.h"
+
+/** @internal */
+enum Link
+{
+    L = 0,
+    R,
+};
+
+enum : size_t
+{
+    /** Eight cache lines. A lookup in ten million small user types visits four
+    or five nodes while shifting half a node on insertion stays cheap. */
+    NODE_BYTES = 512,
+    /** The fewest user types a leaf may be configured to hold. */
+    LEAF_MIN_CAPACITY = 4,
+    /** The fewest separators a branch may be configured to hold. */
+    BRANCH_MIN_CAPACITY = 3,
+    /** Nodes other than the root are at least half full and have at least two
+    children so the height never exceeds the bits in a count. */
+    MAX_HEIGHT = sizeof(size_t) * 8,
+    /** The slots of every node start on a maximally aligned boundary. */
+    HEADER_BYTES
+    = (sizeof(struct CCC_Btree_map_node) + alignof(max_align_t) - 1)
+    & ~(alignof(max_align_t) - 1),
+};
+
+/** @internal The position of a key in a leaf. The index is where the key is or
+where it would be inserted. It may equal the count of the leaf. */
+struct Query
+{
+    struct CCC_Btree_map_node *leaf;
+    size_t index;
+    bool found;
+};
+
+/*===========================   Prototypes   ================================*/
+
+static struct Query find(struct CCC_Btree_map const *, void const *);
+static struct Query bound(struct CCC_Btree_map const *, void const *,
+                          CCC_Order);
+static size_t search_node(struct CCC_Btree_map const *,
+                          struct CCC_Btree_map_node const *, void const *,
+                          CCC_Order);
+static void *insert(struct CCC_Btree_map *, struct CCC_Btree_map_node *, size_t,
+                    void const *);
+static void insert_separator(struct CCC_Btree_map *,
+                             struct CCC_Btree_map_node *, void const *,
+                             struct CCC_Btree_map_node *,
+                             struct CCC_Btree_map_node **, size_t);
+static void remove_at(struct CCC_Btree_map *, struct CCC_Btree_map_node *,
+                      size_t);
+static void rebalance_leaf(struct CCC_Btree_map *, struct CCC_Btree_map_node *);
+static void rebalance_branch(struct CCC_Btree_map *,
+                             struct CCC_Btree_map_node *);
+static void remove_separator(struct CCC_Btree_map const *,
+                             struct CCC_Btree_map_node *, size_t);
+static void layout(struct CCC_Btree_map *);
+static size_t branch_bytes(size_t, size_t);
+static struct CCC_Btree_map_node *allocate_node(struct CCC_Btree_map *);
+static void free_node(struct CCC_Btree_map const *,
+                      struct CCC_Btree_map_node *);
+static void free_subtree(struct CCC_Btree_map const *,
+                         struct CCC_Btree_map_node *, CCC_Type_destructor *);
+static struct Query locate(struct CCC_Btree_map const *, void const *);
+static void *at_position(struct CCC_Btree_map const *, struct Query);
+static void *before(struct CCC_Btree_map const *, struct Query);
+static size_t child_index(struct CCC_Btree_map const *,
+                          struct CCC_Btree_map_node const *,
+                          struct CCC_Btree_map_node const *);
+static size_t capacity(struct CCC_Btree_map const *,
+                       struct CCC_Btree_map_node const *);
+static void *slot(struct CCC_Btree_map const *,
+                  struct CCC_Btree_map_node const *, size_t);
+static struct CCC_Btree_map_node **children(struct CCC_Btree_map const *,
+                                            struct CCC_Btree_map_node const *);
+static void *key_in_slot(struct CCC_Btree_map const *, void const *);
+static CCC_Order order(struct CCC_Btree_map const *, void const *,
+                       void const *);
+static CCC_Tribool validate_subtree(struct CCC_Btree_map const *,
+                                    struct CCC_Btree_map_node const *,
+                                    void const *, void const *, size_t,
+                                    size_t *, size_t *);
+static CCC_Tribool validate_leaves(struct CCC_Btree_map const *);
+
+/*===========================   Interface   =================================*/
+
+CCC_Tribool
+CCC_btree_map_contains(CCC_Btree_map const *const map, void const *const key)
+{
+    if (!map || !key)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return find(map, key).found;
+}
+
+void *
+CCC_btree_map_get_key_value(CCC_Btree_map const *const map,
+                            void const *const key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+    struct Query const q = find(map, key);
+    return q.found ? slot(map, q.leaf, q.index) : NULL;
+}
+
+void *
+CCC_btree_map_get_mut(CCC_Btree_map *const map, void const *const key)
+{
+    return CCC_btree_map_get_key_value(map, key);
+}
+
+CCC_Entry
+CCC_btree_map_swap_entry(CCC_Btree_map *const map, void *const type_output)
+{
+    if (!map || !type_output)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    struct Query const q = find(map, key_in_slot(map, type_output));
+    if (q.found)
+    {
+        /* The slot past the count of a leaf is always free. */
+        void *const stored = slot(map, q.leaf, q.index);
+        void *const temp = slot(map, q.leaf, q.leaf->count);
+        (void)memcpy(temp, stored, map->sizeof_type);
+        (void)memcpy(stored, type_output, map->sizeof_type);
+        (void)memcpy(type_output, temp, map->sizeof_type);
+        return (CCC_Entry){{
+            .type = type_output,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    void *const inserted = insert(map, q.leaf, q.index, type_output);
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_btree_map_try_insert(CCC_Btree_map *const map, void const *const type)
+{
+    if (!map || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    struct Query const q = find(map, key_in_slot(map, type));
+    if (q.found)
+    {
+        return (CCC_Entry){{
+            .type = slot(map, q.leaf, q.index),
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    void *const inserted = insert(map, q.leaf, q.index, type);
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_btree_map_insert_or_assign(CCC_Btree_map *const map, void const *const type)
+{
+    if (!map || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    struct Query const q = find(map, key_in_slot(map, type));
+    if (q.found)
+    {
+        void *const stored = slot(map, q.leaf, q.index);
+        (void)memcpy(stored, type, map->sizeof_type);
+        return (CCC_Entry){{
+            .type = stored,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    void *const inserted = insert(map, q.leaf, q.index, type);
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_btree_map_remove_key_value(CCC_Btree_map *const map,
+                               void *const type_output)
+{
+    if (!map || !type_output)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    struct Query const q = find(map, key_in_slot(map, type_output));
+    if (!q.found)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    (void)memcpy(type_output, slot(map, q.leaf, q.index), map->sizeof_type);
+    remove_at(map, q.leaf, q.index);
+    return (CCC_Entry){{
+        .type = type_output,
+        .status = CCC_ENTRY_OCCUPIED,
+    }};
+}
+
+CCC_Btree_map_entry
+CCC_btree_map_entry(CCC_Btree_map const *const map, void const *const key)
+{
+    if (!map || !key)
+    {
+        return (CCC_Btree_map_entry){
+            {.entry = {.status = CCC_ENTRY_ARGUMENT_ERROR}}};
+    }
+    struct Query const q = find(map, key);
+    return (CCC_Btree_map_entry){{
+        .map = (struct CCC_Btree_map *)map,
+        .leaf = q.leaf,
+        .index = q.index,
+        .entry = {
+            .type = q.found ? slot(map, q.leaf, q.index) : NULL,
+            .status = q.found ? CCC_ENTRY_OCCUPIED : CCC_ENTRY_VACANT,
+        },
+    }};
+}
+
+CCC_Btree_map_entry *
+CCC_btree_map_and_modify(CCC_Btree_map_entry *const entry,
+                         CCC_Type_modifier *const modify)
+{
+    return CCC_btree_map_and_modify_context(entry, modify, NULL);
+}
+
+CCC_Btree_map_entry *
+CCC_btree_map_and_modify_context(CCC_Btree_map_entry *const entry,
+                                 CCC_Type_modifier *const modify,
+                                 void *const context)
+{
+    if (!entry || !modify)
+    {
+        return NULL;
+    }
+    if (entry->private.entry.status & CCC_ENTRY_OCCUPIED
+        && entry->private.entry.type)
+    {
+        modify((CCC_Type_context){
+            .type = entry->private.entry.type,
+            .context = context,
+        });
+    }
+    return entry;
+}
+
+void *
+CCC_btree_map_or_insert(CCC_Btree_map_entry const *const entry,
+                        void const *const type)
+{
+    if (!entry || !type || !entry->private.map
+        || (entry->private.entry.status & CCC_ENTRY_ARGUMENT_ERROR))
+    {
+        return NULL;
+    }
+    if (entry->private.entry.status & CCC_ENTRY_OCCUPIED)
+    {
+        return entry->private.entry.type;
+    }
+    return insert(entry->private.map, entry->private.leaf,
+                  entry->private.index, type);
+}
+
+void *
+CCC_btree_map_insert_entry(CCC_Btree_map_entry const *const entry,
+                           void const *const type)
+{
+    if (!entry || !type || !entry->private.map
+        || (entry->private.entry.status & CCC_ENTRY_ARGUMENT_ERROR))
+    {
+        return NULL;
+    }
+    if (entry->private.entry.status & CCC_ENTRY_OCCUPIED)
+    {
+        (void)memcpy(entry->private.entry.type, type,
+                     entry->private.map->sizeof_type);
+        return entry->private.entry.type;
+    }
+    return insert(entry->private.map, entry->private.leaf,
+                  entry->private.index, type);
+}
+
+CCC_Entry
+CCC_btree_map_remove_entry(CCC_Btree_map_entry const *const entry)
+{
+    if (!entry || !entry->private.map
+        || (entry->private.entry.status & CCC_ENTRY_ARGUMENT_ERROR))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (!(entry->private.entry.status & CCC_ENTRY_OCCUPIED))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    remove_at(entry->private.map, entry->private.leaf, entry->private.index);
+    return (CCC_Entry){{.status = CCC_ENTRY_OCCUPIED}};
+}
+
+void *
+CCC_btree_map_unwrap(CCC_Btree_map_entry const *const entry)
+{
+    if (!entry || !(entry->private.entry.status & CCC_ENTRY_OCCUPIED))
+    {
+        return NULL;
+    }
+    return entry->private.entry.type;
+}
+
+void *
+CCC_btree_map_unwrap_mut(CCC_Btree_map_entry *const entry)
+{
+    return CCC_btree_map_unwrap(entry);
+}
+
+CCC_Tribool
+CCC_btree_map_occupied(CCC_Btree_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return (entry->private.entry.status & CCC_ENTRY_OCCUPIED) != 0;
+}
+
+CCC_Tribool
+CCC_btree_map_insert_error(CCC_Btree_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return (entry->private.entry.status & CCC_ENTRY_INSERT_ERROR) != 0;
+}
+
+CCC_Entry_status
+CCC_btree_map_entry_status(CCC_Btree_map_entry const *const entry)
+{
+    return entry ? entry->private.entry.status : CCC_ENTRY_ARGUMENT_ERROR;
+}
+
+CCC_Range
+CCC_btree_map_equal_range(CCC_Btree_map const *const map,
+                          void const *const begin_key,
+                          void const *const end_key)
+{
+    if (!map || !begin_key || !end_key || !map->root)
+    {
+        return (CCC_Range){};
+    }
+    return (CCC_Range){{
+        .begin = at_position(map, bound(map, begin_key, CCC_ORDER_EQUAL)),
+        .end = at_position(map, bound(map, end_key, CCC_ORDER_LESSER)),
+    }};
+}
+
+CCC_Range_reverse
+CCC_btree_map_equal_range_reverse(CCC_Btree_map const *const map,
+                                  void const *const reverse_begin_key,
+                                  void const *const reverse_end_key)
+{
+    if (!map || !reverse_begin_key || !reverse_end_key || !map->root)
+    {
+        return (CCC_Range_reverse){};
+    }
+    /* The element before the first greater than a key is the last not
+       greater and the element before the first not less is the last less. */
+    return (CCC_Range_reverse){{
+        .reverse_begin
+        = before(map, bound(map, reverse_begin_key, CCC_ORDER_LESSER)),
+        .reverse_end
+        = before(map, bound(map, reverse_end_key, CCC_ORDER_EQUAL)),
+    }};
+}
+
+void *
+CCC_btree_map_begin(CCC_Btree_map const *const map)
+{
+    if (!map || !map->ends[L])
+    {
+        return NULL;
+    }
+    return slot(map, map->ends[L], 0);
+}
+
+void *
+CCC_btree_map_reverse_begin(CCC_Btree_map const *const map)
+{
+    if (!map || !map->ends[R])
+    {
+        return NULL;
+    }
+    return slot(map, map->ends[R], map->ends[R]->count - 1);
+}
+
+void *
+CCC_btree_map_next(CCC_Btree_map const *const map,
+                   void const *const type_iterator)
+{
+    if (!map || !type_iterator || !map->root)
+    {
+        return NULL;
+    }
+    struct Query q = locate(map, type_iterator);
+    ++q.index;
+    return at_position(map, q);
+}
+
+void *
+CCC_btree_map_reverse_next(CCC_Btree_map const *const map,
+                           void const *const type_iterator)
+{
+    if (!map || !type_iterator || !map->root)
+    {
+        return NULL;
+    }
+    return before(map, locate(map, type_iterator));
+}
+
+void *
+CCC_btree_map_end(CCC_Btree_map const *const)
+{
+    return NULL;
+}
+
+void *
+CCC_btree_map_reverse_end(CCC_Btree_map const *const)
+{
+    return NULL;
+}
+
+CCC_Result
+CCC_btree_map_clear(CCC_Btree_map *const map,
+                    CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (map->root)
+    {
+        free_subtree(map, map->root, destroy);
+    }
+    map->root = NULL;
+    map->ends[L] = map->ends[R] = NULL;
+    map->count = 0;
+    return CCC_RESULT_OK;
+}
+
+CCC_Count
+CCC_btree_map_count(CCC_Btree_map const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = map->count};
+}
+
+CCC_Tribool
+CCC_btree_map_is_empty(CCC_Btree_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return !map->count;
+}
+
+CCC_Tribool
+CCC_btree_map_validate(CCC_Btree_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    if (!map->root)
+    {
+        return !map->count && !map->ends[L] && !map->ends[R];
+    }
+    if (map->root->parent || !map->root->count)
+    {
+        return CCC_FALSE;
+    }
+    size_t leaf_depth = 0;
+    size_t counted = 0;
+    if (!validate_subtree(map, map->root, NULL, NULL, 1, &leaf_depth,
+                          &counted))
+    {
+        return CCC_FALSE;
+    }
+    return counted == map->count && validate_leaves(map);
+}
+
+/*=========================   Search   ======================================*/
+
+/** Finds the key or the position it would be inserted at. */
+static struct Query
+find(struct CCC_Btree_map const *const map, void const *const key)
+{
+    struct Query q = bound(map, key, CCC_ORDER_EQUAL);
+    q.found = q.leaf && q.index < q.leaf->count
+           && order(map, key, slot(map, q.leaf, q.index)) == CCC_ORDER_EQUAL;
+    return q;
+}
+
+/** Descends to the leaf that would hold the key and returns the position of the
+first user type the key does not exceed. An EQUAL bound gives the first user
+type not less than the key and a LESSER bound the first greater than the key.
+The position may be one past the end of its leaf. The leaf is NULL if the map
+is empty. */
+static struct Query
+bound(struct CCC_Btree_map const *const map, void const *const key,
+      CCC_Order const beyond)
+{
+    struct CCC_Btree_map_node *node = map->root;
+    if (!node)
+    {
+        return (struct Query){};
+    }
+    while (!node->leaf)
+    {
+        node = children(map, node)[search_node(map, node, key,
+                                               CCC_ORDER_LESSER)];
+    }
+    return (struct Query){
+        .leaf = node,
+        .index = search_node(map, node, key, beyond),
+    };
+}
+
+/** Counts the leading slots of a node the key is ordered beyond. The slots are
+sorted so these form a prefix and the count is found by halving the candidate
+range without branching on the comparison. An EQUAL bound counts slots less
+than the key and a LESSER bound counts slots not greater than the key. */
+static size_t
+search_node(struct CCC_Btree_map const *const map,
+            struct CCC_Btree_map_node const *const node, void const *const key,
+            CCC_Order const beyond)
+{
+    size_t n = node->count;
+    if (!n)
+    {
+        return 0;
+    }
+    char const *const base = slot(map, node, 0);
+    size_t low = 0;
+    while (n > 1)
+    {
+        size_t const half = n / 2;
+        char const *const probe = base + ((low + half) * map->sizeof_type);
+        low += (size_t)(order(map, key, probe) > beyond) * half;
+        n -= half;
+    }
+    return low
+         + (order(map, key, base + (low * map->sizeof_type)) > beyond);
+}
+
+/*=========================   Insertion   ===================================*/
+
+/** Inserts a copy of type at the position in the leaf. Every full node on the
+path to the root splits and a full root gains a new root, so those nodes are
+allocated first. Returns the new user type or NULL with the map unchanged if
+allocation is forbidden or fails. */
+static void *
+insert(struct CCC_Btree_map *const map, struct CCC_Btree_map_node *leaf,
+       size_t index, void const *const type)
+{
+    if (!map->allocate)
+    {
+        return NULL;
+    }
+    layout(map);
+    if (!leaf)
+    {
+        leaf = allocate_node(map);
+        if (!leaf)
+        {
+            return NULL;
+        }
+        *leaf = (struct CCC_Btree_map_node){
+            .leaf = true,
+            .padded = leaf->padded,
+        };
+        map->root = map->ends[L] = map->ends[R] = leaf;
+        index = 0;
+    }
+    struct CCC_Btree_map_node *spare[MAX_HEIGHT + 1];
+    size_t needed = 0;
+    for (struct CCC_Btree_map_node const *n = leaf;
+         n && n->count == capacity(map, n); n = n->parent)
+    {
+        needed += n->parent ? 1 : 2;
+    }
+    for (size_t i = 0; i < needed; ++i)
+    {
+        spare[i] = allocate_node(map);
+        if (!spare[i])
+        {
+            while (i--)
+            {
+                free_node(map, spare[i]);
+            }
+            return NULL;
+        }
+    }
+    (void)memmove(slot(map, leaf, index + 1), slot(map, leaf, index),
+                  (leaf->count - index) * map->sizeof_type);
+    (void)memcpy(slot(map, leaf, index), type, map->sizeof_type);
+    ++leaf->count;
+    ++map->count;
+    if (leaf->count <= map->leaf_capacity)
+    {
+        return slot(map, leaf, index);
+    }
+    struct CCC_Btree_map_node *const right = spare[--needed];
+    uint32_t const half = (leaf->count + 1) / 2;
+    *right = (struct CCC_Btree_map_node){
+        .link = {leaf, leaf->link[R]},
+        .count = leaf->count - half,
+        .leaf = true,
+        .padded = right->padded,
+    };
+    (void)memcpy(slot(map, right, 0), slot(map, leaf, half),
+                 right->count * map->sizeof_type);
+    leaf->count = half;
+    if (leaf->link[R])
+    {
+        leaf->link[R]->link[L] = right;
+    }
+    else
+    {
+        map->ends[R] = right;
+    }
+    leaf->link[R] = right;
+    insert_separator(map, leaf, slot(map, right, 0), right, spare, needed);
+    return index < half ? slot(map, leaf, index)
+                        : slot(map, right, index - half);
+}
+
+/** Places the separator and the new right sibling of left into the parent of
+left. A parent that overflows splits and its middle separator moves up in turn.
+The spare nodes were allocated for exactly these splits and the new root. */
+static void
+insert_separator(struct CCC_Btree_map *const map,
+                 struct CCC_Btree_map_node *left, void const *separator,
+                 struct CCC_Btree_map_node *right,
+                 struct CCC_Btree_map_node **const spare, size_t needed)
+{
+    for (;;)
+    {
+        struct CCC_Btree_map_node *parent = left->parent;
+        if (!parent)
+        {
+            assert(needed == 1);
+            parent = spare[--needed];
+            *parent = (struct CCC_Btree_map_node){
+                .count = 1,
+                .padded = parent->padded,
+            };
+            (void)memcpy(slot(map, parent, 0), separator, map->sizeof_type);
+            children(map, parent)[0] = left;
+            children(map, parent)[1] = right;
+            left->parent = right->parent = parent;
+            map->root = parent;
+            return;
+        }
+        struct CCC_Btree_map_node **const kids = children(map, parent);
+        size_t const i = child_index(map, parent, left);
+        (void)memmove(slot(map, parent, i + 1), slot(map, parent, i),
+                      (parent->count - i) * map->sizeof_type);
+        (void)memmove(kids + i + 2, kids + i + 1,
+                      (parent->count - i) * sizeof(*kids));
+        (void)memcpy(slot(map, parent, i), separator, map->sizeof_type);
+        kids[i + 1] = right;
+        right->parent = parent;
+        ++parent->count;
+        if (parent->count <= map->branch_capacity)
+        {
+            assert(!needed);
+            return;
+        }
+        struct CCC_Btree_map_node *const sibling = spare[--needed];
+        uint32_t const middle = parent->count / 2;
+        *sibling = (struct CCC_Btree_map_node){
+            .count = parent->count - middle - 1,
+            .padded = sibling->padded,
+        };
+        (void)memcpy(slot(map, sibling, 0), slot(map, parent, middle + 1),
+                     sibling->count * map->sizeof_type);
+        struct CCC_Btree_map_node **const sibling_kids
+            = children(map, sibling);
+        (void)memcpy(sibling_kids, kids + middle + 1,
+                     (sibling->count + 1) * sizeof(*kids));
+        for (size_t c = 0; c <= sibling->count; ++c)
+        {
+            sibling_kids[c]->parent = sibling;
+        }
+        parent->count = middle;
+        /* The middle separator is past the count of the parent and is not
+           written again until it has been copied into the grandparent. */
+        separator = slot(map, parent, middle);
+        left = parent;
+        right = sibling;
+    }
+}
+
+/*==========================   Removal   ====================================*/
+
+/** Removes the user type at the position in the leaf and restores the minimum
+fill of every node on the path to the root. */
+static void
+remove_at(struct CCC_Btree_map *const map,
+          struct CCC_Btree_map_node *const leaf, size_t const index)
+{
+    (void)memmove(slot(map, leaf, index), slot(map, leaf, index + 1),
+                  (leaf->count - index - 1) * map->sizeof_type);
+    --leaf->count;
+    --map->count;
+    if (leaf == map->root)
+    {
+        if (!leaf->count)
+        {
+            free_node(map, leaf);
+            map->root = map->ends[L] = map->ends[R] = NULL;
+        }
+        return;
+    }
+    if (leaf->count < map->leaf_capacity / 2)
+    {
+        rebalance_leaf(map, leaf);
+    }
+}
+
+/** Borrows a user type from a sibling that can spare one or merges the leaf
+with a sibling. A merge removes a separator from the parent which may then need
+rebalancing itself. */
+static void
+rebalance_leaf(struct CCC_Btree_map *const map,
+               struct CCC_Btree_map_node *const leaf)
+{
+    struct CCC_Btree_map_node *const parent = leaf->parent;
+    struct CCC_Btree_map_node **const kids = children(map, parent);
+    size_t const i = child_index(map, parent, leaf);
+    struct CCC_Btree_map_node *const left = i ? kids[i - 1] : NULL;
+    struct CCC_Btree_map_node *const right
+        = i < parent->count ? kids[i + 1] : NULL;
+    uint32_t const minimum = map->leaf_capacity / 2;
+    if (left && left->count > minimum)
+    {
+        (void)memmove(slot(map, leaf, 1), slot(map, leaf, 0),
+                      leaf->count * map->sizeof_type);
+        (void)memcpy(slot(map, leaf, 0), slot(map, left, left->count - 1),
+                     map->sizeof_type);
+        --left->count;
+        ++leaf->count;
+        (void)memcpy(slot(map, parent, i - 1), slot(map, leaf, 0),
+                     map->sizeof_type);
+        return;
+    }
+    if (right && right->count > minimum)
+    {
+        (void)memcpy(slot(map, leaf, leaf->count), slot(map, right, 0),
+                     map->sizeof_type);
+        (void)memmove(slot(map, right, 0), slot(map, right, 1),
+                      (right->count - 1) * map->sizeof_type);
+        --right->count;
+        ++leaf->count;
+        (void)memcpy(slot(map, parent, i), slot(map, right, 0),
+                     map->sizeof_type);
+        return;
+    }
+    struct CCC_Btree_map_node *const into = left ? left : leaf;
+    struct CCC_Btree_map_node *const from = left ? leaf : right;
+    (void)memcpy(slot(map, into, into->count), slot(map, from, 0),
+                 from->count * map->sizeof_type);
+    into->count += from->count;
+    into->link[R] = from->link[R];
+    if (from->link[R])
+    {
+        from->link[R]->link[L] = into;
+    }
+    else
+    {
+        map->ends[R] = into;
+    }
+    free_node(map, from);
+    remove_separator(map, parent, left ? i - 1 : i);
+    rebalance_branch(map, parent);
+}
+
+/** Rotates a separator and child through the parent from a sibling that can
+spare one or merges the branch with a sibling and the separator between them.
+Merges continue up the tree until a branch is at least half full. A root left
+with a single child is replaced by that child. */
+static void
+rebalance_branch(struct CCC_Btree_map *const map,
+                 struct CCC_Btree_map_node *node)
+{
+    uint32_t const minimum = map->branch_capacity / 2;
+    for (;;)
+    {
+        if (node == map->root)
+        {
+            if (!node->count)
+            {
+                map->root = children(map, node)[0];
+                map->root->parent = NULL;
+                free_node(map, node);
+            }
+            return;
+        }
+        if (node->count >= minimum)
+        {
+            return;
+        }
+        struct CCC_Btree_map_node *const parent = node->parent;
+        struct CCC_Btree_map_node **const kids = children(map, parent);
+        struct CCC_Btree_map_node **const node_kids = children(map, node);
+        size_t const i = child_index(map, parent, node);
+        struct CCC_Btree_map_node *const left = i ? kids[i - 1] : NULL;
+        struct CCC_Btree_map_node *const right
+            = i < parent->count ? kids[i + 1] : NULL;
+        if (left && left->count > minimum)
+        {
+            struct CCC_Btree_map_node **const left_kids = children(map, left);
+            (void)memmove(slot(map, node, 1), slot(map, node, 0),
+                          node->count * map->sizeof_type);
+            (void)memmove(node_kids + 1, node_kids,
+                          (node->count + 1) * sizeof(*node_kids));
+            (void)memcpy(slot(map, node, 0), slot(map, parent, i - 1),
+                         map->sizeof_type);
+            node_kids[0] = left_kids[left->count];
+            node_kids[0]->parent = node;
+            (void)memcpy(slot(map, parent, i - 1),
+                         slot(map, left, left->count - 1), map->sizeof_type);
+            --left->count;
+            ++node->count;
+            return;
+        }
+        if (right && right->count > minimum)
+        {
+            struct CCC_Btree_map_node **const right_kids
+                = children(map, right);
+            (void)memcpy(slot(map, node, node->count), slot(map, parent, i),
+                         map->sizeof_type);
+            node_kids[node->count + 1] = right_kids[0];
+            right_kids[0]->parent = node;
+            (void)memcpy(slot(map, parent, i), slot(map, right, 0),
+                         map->sizeof_type);
+            (void)memmove(slot(map, right, 0), slot(map, right, 1),
+                          (right->count - 1) * map->sizeof_type);
+            (void)memmove(right_kids, right_kids + 1,
+                          right->count * sizeof(*right_kids));
+            --right->count;
+            ++node->count;
+            return;
+        }
+        struct CCC_Btree_map_node *const into = left ? left : node;
+        struct CCC_Btree_map_node *const from = left ? node : right;
+        size_t const separator = left ? i - 1 : i;
+        struct CCC_Btree_map_node **const into_kids = children(map, into);
+        struct CCC_Btree_map_node **const from_kids = children(map, from);
+        (void)memcpy(slot(map, into, into->count), slot(map, parent, separator),
+                     map->sizeof_type);
+        (void)memcpy(slot(map, into, into->count + 1), slot(map, from, 0),
+                     from->count * map->sizeof_type);
+        (void)memcpy(into_kids + into->count + 1, from_kids,
+                     (from->count + 1) * sizeof(*from_kids));
+        for (size_t c = 0; c <= from->count; ++c)
+        {
+            from_kids[c]->parent = into;
+        }
+        into->count += from->count + 1;
+        free_node(map, from);
+        remove_separator(map, parent, separator);
+        node = parent;
+    }
+}
+
+/** Removes the separator at index i of a branch and the child to its right. */
+static void
+remove_separator(struct CCC_Btree_map const *const map,
+                 struct CCC_Btree_map_node *const node, size_t const i)
+{
+    struct CCC_Btree_map_node **const kids = children(map, node);
+    (void)memmove(slot(map, node, i), slot(map, node, i + 1),
+                  (node->count - i - 1) * map->sizeof_type);
+    (void)memmove(kids + i + 1, kids + i + 2,
+                  (node->count - i - 1) * sizeof(*kids));
+    --node->count;
+}
+
+/*=========================   Memory   ======================================*/
+
+/** Sizes nodes for the user type on the first allocation. Nodes start at eight
+cache lines and double until a leaf holds four user types and a branch three
+separators, each with a spare slot. */
+static void
+layout(struct CCC_Btree_map *const map)
+{
+    if (map->node_bytes)
+    {
+        return;
+    }
+    size_t bytes = NODE_BYTES;
+    size_t leaf = 0;
+    size_t branch = 0;
+    for (;; bytes *= 2)
+    {
+        leaf = ((bytes - HEADER_BYTES) / map->sizeof_type) - 1;
+        branch = (bytes - HEADER_BYTES)
+               / (map->sizeof_type + sizeof(struct CCC_Btree_map_node *));
+        while (branch && branch_bytes(map->sizeof_type, branch) > bytes)
+        {
+            --branch;
+        }
+        if (leaf >= LEAF_MIN_CAPACITY && branch >= BRANCH_MIN_CAPACITY)
+        {
+            break;
+        }
+    }
+    map->node_bytes = bytes;
+    map->leaf_capacity = (uint32_t)leaf;
+    map->branch_capacity = (uint32_t)branch;
+}
+
+/** The bytes of a branch with the given capacity and its spare slot. */
+static inline size_t
+branch_bytes(size_t const sizeof_type, size_t const branch)
+{
+    size_t const separators = HEADER_BYTES + ((branch + 1) * sizeof_type);
+    size_t const align = alignof(struct CCC_Btree_map_node *);
+    return ((separators + align - 1) & ~(align - 1))
+         + ((branch + 2) * sizeof(struct CCC_Btree_map_node *));
+}
+
+/** Returns a node aligned to its size or NULL if allocation failed. Only the
+padded field of the node header is initialized. An allocator that ignored the
+requested alignment once is assumed to ignore it every time so later nodes are
+padded with one allocation rather than a failed aligned attempt first. */
+static struct CCC_Btree_map_node *
+allocate_node(struct CCC_Btree_map *const map)
+{
+    if (!map->pad_nodes)
+    {
+        struct CCC_Btree_map_node *const node
+            = map->allocate((CCC_Allocator_context){
+                .input = NULL,
+                .bytes = map->node_bytes,
+                .context = map->context,
+                .alignment = map->node_bytes,
+            });
+        if (!node || !((uintptr_t)node & (map->node_bytes - 1)))
+        {
+            if (node)
+            {
+                node->padded = false;
+            }
+            return node;
+        }
+        (void)map->allocate((CCC_Allocator_context){
+            .input = node,
+            .bytes = 0,
+            .context = map->context,
+            .old_bytes = map->node_bytes,
+        });
+        map->pad_nodes = true;
+    }
+    char *const allocation = map->allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = map->node_bytes * 2,
+        .context = map->context,
+        .alignment = alignof(char *),
+    });
+    if (!allocation)
+    {
+        return NULL;
+    }
+    /* The allocation is at least pointer aligned so the first aligned address
+       after room for the stored address leaves a whole node before its end. */
+    assert(!((uintptr_t)allocation & (alignof(char *) - 1)));
+    uintptr_t const first = (uintptr_t)allocation + sizeof(allocation);
+    struct CCC_Btree_map_node *const padded
+        = (struct CCC_Btree_map_node *)((first + map->node_bytes - 1)
+                                        & ~(uintptr_t)(map->node_bytes - 1));
+    (void)memcpy((char *)padded - sizeof(allocation), &allocation,
+                 sizeof(allocation));
+    padded->padded = true;
+    return padded;
+}
+
+static void
+free_node(struct CCC_Btree_map const *const map,
+          struct CCC_Btree_map_node *const node)
+{
+    void *input = node;
+    size_t old_bytes = map->node_bytes;
+    if (node->padded)
+    {
+        (void)memcpy(&input, (char *)node - sizeof(input), sizeof(input));
+        old_bytes *= 2;
+    }
+    (void)map->allocate((CCC_Allocator_context){
+        .input = input,
+        .bytes = 0,
+        .context = map->context,
+        .old_bytes = old_bytes,
+    });
+}
+
+/** Frees a subtree. Recursion is bounded by the height of the tree. */
+static void
+free_subtree(struct CCC_Btree_map const *const map,
+             struct CCC_Btree_map_node *const node,
+             CCC_Type_destructor *const destroy)
+{
+    if (node->leaf)
+    {
+        for (size_t i = 0; destroy && i < node->count; ++i)
+        {
+            destroy((CCC_Type_context){
+                .type = slot(map, node, i),
+                .context = map->context,
+            });
+        }
+    }
+    else
+    {
+        struct CCC_Btree_map_node **const kids = children(map, node);
+        for (size_t i = 0; i <= node->count; ++i)
+        {
+            free_subtree(map, kids[i], destroy);
+        }
+    }
+    free_node(map, node);
+}
+
+/*=========================   Iteration   ===================================*/
+
+/** Finds the leaf and index of a user type stored in the map. */
+static struct Query
+locate(struct CCC_Btree_map const *const map, void const *const type)
+{
+    struct CCC_Btree_map_node *const leaf
+        = (struct CCC_Btree_map_node *)((uintptr_t)type
+                                        & ~(uintptr_t)(map->node_bytes - 1));
+    return (struct Query){
+        .leaf = leaf,
+        .index = (size_t)((char const *)type - (char const *)slot(map, leaf, 0))
+               / map->sizeof_type,
+        .found = true,
+    };
+}
+
+/** The user type at a position, continuing to the next leaf if the position
+is one past the end of its leaf. NULL past the last leaf. */
+static void *
+at_position(struct CCC_Btree_map const *const map, struct Query const q)
+{
+    if (!q.leaf)
+    {
+        return NULL;
+    }
+    if (q.index < q.leaf->count)
+    {
+        return slot(map, q.leaf, q.index);
+    }
+    return q.leaf->link[R] ? slot(map, q.leaf->link[R], 0) : NULL;
+}
+
+/** The user type before a position in key order, or NULL. */
+static void *
+before(struct CCC_Btree_map const *const map, struct Query const q)
+{
+    if (!q.leaf)
+    {
+        return NULL;
+    }
+    if (q.index)
+    {
+        return slot(map, q.leaf, q.index - 1);
+    }
+    struct CCC_Btree_map_node const *const prev = q.leaf->link[L];
+    return prev ? slot(map, prev, prev->count - 1) : NULL;
+}
+
+/*=========================   Validation   ==================================*/
+
+/** Checks the node counts, parent links, separator order, and that every key
+is within the separators bounding the subtree. All leaves must be at the same
+depth. */
+static CCC_Tribool
+validate_subtree(struct CCC_Btree_map const *const map,
+                 struct CCC_Btree_map_node const *const node,
+                 void const *const lower, void const *const upper,
+                 size_t const depth, size_t *const leaf_depth,
+                 size_t *const counted)
+{
+    if (depth > MAX_HEIGHT || node->count > capacity(map, node))
+    {
+        return CCC_FALSE;
+    }
+    if (node != map->root
+        && node->count < (node->leaf ? map->leaf_capacity / 2
+                                     : map->branch_capacity / 2))
+    {
+        return CCC_FALSE;
+    }
+    if ((uintptr_t)node & (map->node_bytes - 1))
+    {
+        return CCC_FALSE;
+    }
+    for (size_t i = 0; i < node->count; ++i)
+    {
+        void const *const key = key_in_slot(map, slot(map, node, i));
+        if ((lower && order(map, key, lower) == CCC_ORDER_LESSER)
+            || (upper && order(map, key, upper) != CCC_ORDER_LESSER)
+            || (i
+                && order(map, key, slot(map, node, i - 1))
+                       != CCC_ORDER_GREATER))
+        {
+            return CCC_FALSE;
+        }
+    }
+    if (node->leaf)
+    {
+        if (!*leaf_depth)
+        {
+            *leaf_depth = depth;
+        }
+        *counted += node->count;
+        return depth == *leaf_depth;
+    }
+    struct CCC_Btree_map_node *const *const kids = children(map, node);
+    for (size_t i = 0; i <= node->count; ++i)
+    {
+        if (kids[i]->parent != node
+            || !validate_subtree(map, kids[i],
+                                 i ? slot(map, node, i - 1) : lower,
+                                 i < node->count ? slot(map, node, i) : upper,
+                                 depth + 1, leaf_depth, counted))
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+/** Checks the leaves are linked both ways in strictly ascending key order from
+the first leaf to the last. */
+static CCC_Tribool
+validate_leaves(struct CCC_Btree_map const *const map)
+{
+    size_t counted = 0;
+    void const *prev = NULL;
+    struct CCC_Btree_map_node const *prev_leaf = NULL;
+    for (struct CCC_Btree_map_node const *leaf = map->ends[L]; leaf;
+         prev_leaf = leaf, leaf = leaf->link[R])
+    {
+        if (!leaf->leaf || !leaf->count || leaf->link[L] != prev_leaf
+            || counted >= map->count)
+        {
+            return CCC_FALSE;
+        }
+        for (size_t i = 0; i < leaf->count; ++i, ++counted)
+        {
+            void const *const cur = slot(map, leaf, i);
+            if (prev
+                && order(map, key_in_slot(map, cur), prev)
+                       != CCC_ORDER_GREATER)
+            {
+                return CCC_FALSE;
+            }
+            prev = cur;
+        }
+    }
+    return prev_leaf == map->ends[R] && counted == map->count;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+static size_t
+child_index(struct CCC_Btree_map const *const map,
+            struct CCC_Btree_map_node const *const parent,
+            struct CCC_Btree_map_node const *const child)
+{
+    struct CCC_Btree_map_node *const *const kids = children(map, parent);
+    size_t i = 0;
+    while (kids[i] != child)
+    {
+        ++i;
+    }
+    assert(i <= parent->count);
+    return i;
+}
+
+static inline size_t
+capacity(struct CCC_Btree_map const *const map,
+         struct CCC_Btree_map_node const *const node)
+{
+    return node->leaf ? map->leaf_capacity : map->branch_capacity;
+}
+
+static inline void *
+slot(struct CCC_Btree_map const *const map,
+     struct CCC_Btree_map_node const *const node, size_t const i)
+{
+    return (char *)node + HEADER_BYTES + (i * map->sizeof_type);
+}
+
+/** The children of a branch follow its separators and the spare separator,
+rounded up to pointer alignment. */
+static inline struct CCC_Btree_map_node **
+children(struct CCC_Btree_map const *const map,
+         struct CCC_Btree_map_node const *const node)
+{
+    size_t const separators
+        = HEADER_BYTES + ((map->branch_capacity + 1) * map->sizeof_type);
+    size_t const align = alignof(struct CCC_Btree_map_node *);
+    return (struct CCC_Btree_map_node **)((char *)node
+                                          + ((separators + align - 1)
+                                             & ~(align - 1)));
+}
+
+static inline void *
+key_in_slot(struct CCC_Btree_map const *const map, void const *const slot)
+{
+    return (char *)slot + map->key_offset;
+}
+
+static inline CCC_Order
+order(struct CCC_Btree_map const *const map, void const *const key,
+      void const *const type)
+{
+    return map->compare((CCC_Key_comparator_context){
+        .key_left = key,
+        .type_right = type,
+        .context = map->context,
+    });
+}
@@ -46,6 +46,8 @@ CCC_buffer_allocate(CCC_Buffer *const buffer, size_t const capacity,
         .input = buffer->data,
         .bytes = buffer->sizeof_type * capacity,
         .context = buffer->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+        .old_bytes = buffer->sizeof_type * buffer->capacity,
     });
     if (capacity && !new_data)
     {
@@ -77,6 +79,8 @@ CCC_buffer_reserve(CCC_Buffer *const buffer, size_t const to_add,
         .input = buffer->data,
         .bytes = buffer->sizeof_type * needed,
         .context = buffer->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+        .old_bytes = buffer->sizeof_type * buffer->capacity,
     });
     if (!new_data)
     {
@@ -134,6 +138,7 @@ CCC_buffer_clear_and_free(CCC_Buffer *const buffer,
         .input = buffer->data,
         .bytes = 0,
         .context = buffer->context,
+        .old_bytes = buffer->sizeof_type * buffer->capacity,
     });
     buffer->data = NULL;
     buffer->count = 0;
@@ -165,6 +170,7 @@ CCC_buffer_clear_and_free_reserve(CCC_Buffer *const buffer,
         .input = buffer->data,
         .bytes = 0,
         .context = buffer->context,
+        .old_bytes = buffer->sizeof_type * buffer->capacity,
     });
     buffer->data = NULL;
     buffer->count = 0;
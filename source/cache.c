@@ -0,0 +1,922 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a fixed capacity cache. Records live in an array that
+never grows and are found through an ordinary flat hash map whose elements are
+record positions. The flat hash map is given this cache as its context. Its
+comparison callback compares a user key to the record a slot names and its
+hash callback, only reached when the index table rehashes in place, hashes the
+record a slot names. Every search from this file passes the user hash directly.
+
+The index table is reserved with about twice as many slots as records and is
+never given an allocation function, so it never grows. Evictions may leave
+deleted slots behind and the table rehashes itself in place once they use up
+the slack of about three quarters of capacity slots, so the cost of a rehash is
+spread over at least that many insertions.
+
+The recency state of each record is a node in a parallel array. LRU links all
+nodes in one list. S3-FIFO links them in a small and a main queue and keeps a
+direct mapped table of hashes evicted from the small queue. A ghost hash that
+is overwritten by a colliding one is forgotten early, which only means a
+returning key is admitted to the small queue as if it were new. CLOCK links
+nothing and sweeps a hand over the positions in order. Positions freed by
+removal are linked through their nodes so insertion reuses them before any
+eviction is needed. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cache.h"
+#include "flat_hash_map.h"
+#include "private/private_cache.h"
+#include "private/private_flat_hash_map.h"
+#include "types.h"
+
+/*=========================   Prefetching    ================================*/
+
+#if defined(__has_builtin) && __has_builtin(__builtin_prefetch)
+#    define prefetch(address) __builtin_prefetch((address), 0, 3)
+#else /* !defined(__has_builtin) || !__has_builtin(__builtin_prefetch) */
+#    define prefetch(address) ((void)(address))
+#endif /* defined(__has_builtin) && __has_builtin(__builtin_prefetch) */
+
+/*=========================   Constants     =================================*/
+
+/** The position that marks the end of a queue or the free list. */
+enum : uint32_t
+{
+    NIL = UINT32_MAX,
+};
+
+/** The queue a node belongs to. LRU links every node in the small queue and
+CLOCK marks every stored node as small without linking it. */
+enum : uint8_t
+{
+    QUEUE_SMALL = 0,
+    QUEUE_MAIN = 1,
+    QUEUE_FREE = 2,
+};
+
+enum : size_t
+{
+    /** The S3-FIFO small queue is allowed a tenth of the capacity. */
+    SMALL_QUEUE_DIVISOR = 10,
+    /** The S3-FIFO access count saturates here. */
+    MAX_FREQUENCY = 3,
+    /** The number of keys hashed and prefetched before any is searched. */
+    BATCH_PREFETCH_COUNT = 16,
+};
+
+/*===========================   Prototypes   ================================*/
+
+static uint32_t find(struct CCC_Cache const *, void const *, uint64_t);
+static void *insert_new(struct CCC_Cache *, void const *, uint64_t);
+static uint32_t claim_position(struct CCC_Cache *);
+static void release_position(struct CCC_Cache *, uint32_t);
+static void evict(struct CCC_Cache *);
+static uint32_t lru_victim(struct CCC_Cache *);
+static uint32_t clock_victim(struct CCC_Cache *);
+static uint32_t s3_fifo_victim(struct CCC_Cache *);
+static void admit(struct CCC_Cache *, uint32_t, uint64_t);
+static void touch(struct CCC_Cache *, uint32_t);
+static void remove_position(struct CCC_Cache *, uint32_t, size_t);
+static void push_front(struct CCC_Cache *, uint32_t, uint8_t);
+static void unlink_node(struct CCC_Cache *, uint32_t);
+static void ghost_remember(struct CCC_Cache *, uint64_t);
+static bool ghost_take(struct CCC_Cache *, uint64_t);
+static bool is_linked(struct CCC_Cache const *);
+static bool validate_queue(struct CCC_Cache const *, uint8_t);
+static void reset(struct CCC_Cache *);
+static void prefetch_slot(struct CCC_Cache const *, uint64_t);
+static size_t slot_index(struct CCC_Flat_hash_map const *, void const *);
+static void *record_at(struct CCC_Cache const *, size_t);
+static void *key_in_record(struct CCC_Cache const *, void const *);
+static uint64_t user_hash(struct CCC_Cache const *, void const *);
+static void *allocate_array(struct CCC_Cache const *, size_t);
+static void free_array(struct CCC_Cache const *, void *, size_t);
+static void free_array_set(struct CCC_Cache const *);
+static uint64_t slot_hash(CCC_Key_context);
+static CCC_Order slot_order(CCC_Key_comparator_context);
+static void *index_allocate(CCC_Allocator_context);
+static size_t to_power_of_two(size_t);
+
+/*===========================   Interface   =================================*/
+
+CCC_Tribool
+CCC_cache_contains(CCC_Cache const *const cache, void const *const key)
+{
+    if (!cache || !key)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return find(cache, key, user_hash(cache, key)) != NIL;
+}
+
+void *
+CCC_cache_get_key_value(CCC_Cache *const cache, void const *const key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+    uint32_t const i = find(cache, key, user_hash(cache, key));
+    if (i == NIL)
+    {
+        return NULL;
+    }
+    touch(cache, i);
+    return record_at(cache, i);
+}
+
+CCC_Count
+CCC_cache_get_or_load(CCC_Cache *const cache, void const *const keys[],
+                      size_t const count, void *const type_outputs,
+                      CCC_Cache_loader *const load, void *const context)
+{
+    if (!cache || !keys || !type_outputs || !load)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    uint64_t hashes[BATCH_PREFETCH_COUNT];
+    for (size_t base = 0; base < count; base += BATCH_PREFETCH_COUNT)
+    {
+        size_t const chunk = count - base < BATCH_PREFETCH_COUNT
+                               ? count - base
+                               : BATCH_PREFETCH_COUNT;
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            if (!keys[base + i])
+            {
+                return (CCC_Count){
+                    .count = base + i,
+                    .error = CCC_RESULT_ARGUMENT_ERROR,
+                };
+            }
+            hashes[i] = user_hash(cache, keys[base + i]);
+            prefetch_slot(cache, hashes[i]);
+        }
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            void *const output
+                = (char *)type_outputs + ((base + i) * cache->sizeof_type);
+            uint32_t const found = find(cache, keys[base + i], hashes[i]);
+            if (found != NIL)
+            {
+                touch(cache, found);
+                (void)memcpy(output, record_at(cache, found),
+                             cache->sizeof_type);
+                continue;
+            }
+            if (!load((CCC_Cache_load_context){
+                    .key = keys[base + i],
+                    .type_output = output,
+                    .context = context,
+                })
+                || !insert_new(cache, output, hashes[i]))
+            {
+                return (CCC_Count){
+                    .count = base + i,
+                    .error = CCC_RESULT_FAIL,
+                };
+            }
+        }
+    }
+    return (CCC_Count){.count = count};
+}
+
+CCC_Entry
+CCC_cache_insert_or_assign(CCC_Cache *const cache, void const *const type)
+{
+    if (!cache || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_record(cache, type);
+    uint64_t const hash = user_hash(cache, key);
+    uint32_t const i = find(cache, key, hash);
+    if (i != NIL)
+    {
+        void *const record = record_at(cache, i);
+        (void)memcpy(record, type, cache->sizeof_type);
+        touch(cache, i);
+        return (CCC_Entry){{
+            .type = record,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    void *const inserted = insert_new(cache, type, hash);
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_cache_remove_key_value(CCC_Cache *const cache, void *const type_output)
+{
+    if (!cache || !type_output)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (!cache->count)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    void const *const key = key_in_record(cache, type_output);
+    struct CCC_Cache_slot const *const slot
+        = CCC_private_flat_hash_map_find_with_hash(&cache->index, key,
+                                                   user_hash(cache, key));
+    if (!slot)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    uint32_t const i = slot->index;
+    (void)memcpy(type_output, record_at(cache, i), cache->sizeof_type);
+    remove_position(cache, i, slot_index(&cache->index, slot));
+    return (CCC_Entry){{
+        .type = type_output,
+        .status = CCC_ENTRY_OCCUPIED,
+    }};
+}
+
+CCC_Count
+CCC_cache_count(CCC_Cache const *const cache)
+{
+    if (!cache)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = cache->count};
+}
+
+CCC_Count
+CCC_cache_capacity(CCC_Cache const *const cache)
+{
+    if (!cache)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = cache->capacity};
+}
+
+CCC_Tribool
+CCC_cache_is_empty(CCC_Cache const *const cache)
+{
+    if (!cache)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return !cache->count;
+}
+
+CCC_Tribool
+CCC_cache_validate(CCC_Cache const *const cache)
+{
+    if (!cache)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    if (cache->count > cache->end || cache->end > cache->capacity
+        || cache->index.count != cache->count
+        || !CCC_flat_hash_map_validate(&cache->index))
+    {
+        return CCC_FALSE;
+    }
+    size_t stored = 0;
+    for (uint32_t i = 0; i < cache->end; ++i)
+    {
+        if (cache->nodes[i].queue == QUEUE_FREE)
+        {
+            continue;
+        }
+        ++stored;
+        void const *const key = key_in_record(cache, record_at(cache, i));
+        struct CCC_Cache_slot const *const slot
+            = CCC_private_flat_hash_map_find_with_hash(&cache->index, key,
+                                                       user_hash(cache, key));
+        if (!slot || slot->index != i)
+        {
+            return CCC_FALSE;
+        }
+    }
+    if (stored != cache->count)
+    {
+        return CCC_FALSE;
+    }
+    size_t freed = 0;
+    for (uint32_t i = cache->free; i != NIL; i = cache->nodes[i].next)
+    {
+        if (++freed > cache->end || cache->nodes[i].queue != QUEUE_FREE)
+        {
+            return CCC_FALSE;
+        }
+    }
+    if (freed + cache->count != cache->end)
+    {
+        return CCC_FALSE;
+    }
+    if (!is_linked(cache))
+    {
+        return !cache->queue[QUEUE_SMALL].count
+            && !cache->queue[QUEUE_MAIN].count;
+    }
+    return validate_queue(cache, QUEUE_SMALL)
+        && validate_queue(cache, QUEUE_MAIN)
+        && cache->queue[QUEUE_SMALL].count + cache->queue[QUEUE_MAIN].count
+               == cache->count;
+}
+
+CCC_Result
+CCC_cache_clear(CCC_Cache *const cache, CCC_Type_destructor *const destroy)
+{
+    if (!cache)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (destroy)
+    {
+        for (uint32_t i = 0; i < cache->end; ++i)
+        {
+            if (cache->nodes[i].queue != QUEUE_FREE)
+            {
+                destroy((CCC_Type_context){
+                    .type = record_at(cache, i),
+                    .context = cache->context,
+                });
+            }
+        }
+    }
+    (void)CCC_flat_hash_map_clear(&cache->index, NULL);
+    reset(cache);
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_cache_clear_and_free(CCC_Cache *const cache,
+                         CCC_Type_destructor *const destroy)
+{
+    CCC_Result const res = CCC_cache_clear(cache, destroy);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    if (!cache->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    (void)CCC_flat_hash_map_clear_and_free_reserve(&cache->index, NULL,
+                                                   index_allocate);
+    free_array_set(cache);
+    cache->records = NULL;
+    cache->nodes = NULL;
+    cache->ghosts = NULL;
+    cache->ghost_mask = 0;
+    cache->capacity = 0;
+    return CCC_RESULT_OK;
+}
+
+/*======================     Private Interface      =========================*/
+
+CCC_Result
+CCC_private_cache_initialize(
+    struct CCC_Cache *const cache, size_t const sizeof_type,
+    size_t const key_offset, CCC_Key_hasher *const hash,
+    CCC_Key_comparator *const compare, enum CCC_Cache_policy const policy,
+    CCC_Allocator *const allocate, void *const context, size_t const capacity,
+    void *const storage, size_t const nodes_offset, size_t const ghosts_offset,
+    size_t const index_offset, size_t const fixed_ghosts)
+{
+    if (!cache || !hash || !compare || policy > CCC_CACHE_POLICY_S3_FIFO
+        || !capacity || capacity >= NIL || (!storage && !allocate)
+        || (storage && policy == CCC_CACHE_POLICY_S3_FIFO
+            && fixed_ghosts < capacity))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    *cache = (struct CCC_Cache){
+        .index = (struct CCC_Flat_hash_map)CCC_private_flat_hash_map_initialize(
+            storage ? (char *)storage + index_offset : NULL,
+            struct CCC_Cache_slot, index, slot_hash, slot_order, NULL, cache,
+            storage ? 2 * capacity : 0),
+        .capacity = (uint32_t)capacity,
+        .sizeof_type = sizeof_type,
+        .key_offset = key_offset,
+        .hash = hash,
+        .compare = compare,
+        .allocate = storage ? NULL : allocate,
+        .context = context,
+        .policy = policy,
+    };
+    if (storage)
+    {
+        cache->records = storage;
+        cache->nodes
+            = (struct CCC_Cache_node *)((char *)storage + nodes_offset);
+        if (policy == CCC_CACHE_POLICY_S3_FIFO)
+        {
+            cache->ghosts = (uint64_t *)((char *)storage + ghosts_offset);
+            cache->ghost_mask = capacity - 1;
+        }
+        reset(cache);
+        return CCC_RESULT_OK;
+    }
+    size_t const ghost_count = to_power_of_two(capacity);
+    cache->records = allocate_array(cache, capacity * sizeof_type);
+    cache->nodes
+        = allocate_array(cache, capacity * sizeof(struct CCC_Cache_node));
+    if (policy == CCC_CACHE_POLICY_S3_FIFO)
+    {
+        cache->ghosts = allocate_array(cache, ghost_count * sizeof(uint64_t));
+        cache->ghost_mask = ghost_count - 1;
+    }
+    /* Seven of eight index slots may be filled, so this reserves close to
+       twice capacity slots and leaves slack for deleted slots. */
+    if (!cache->records || !cache->nodes
+        || (policy == CCC_CACHE_POLICY_S3_FIFO && !cache->ghosts)
+        || CCC_flat_hash_map_reserve(&cache->index,
+                                     capacity + ((capacity * 3) / 4),
+                                     index_allocate)
+               != CCC_RESULT_OK)
+    {
+        if (cache->index.data)
+        {
+            (void)CCC_flat_hash_map_clear_and_free_reserve(
+                &cache->index, NULL, index_allocate);
+        }
+        free_array_set(cache);
+        *cache = (struct CCC_Cache){};
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    reset(cache);
+    return CCC_RESULT_OK;
+}
+
+/*=========================   Static Internals   ============================*/
+
+/** Returns the position of the record with key or NIL if it is absent. */
+static uint32_t
+find(struct CCC_Cache const *const cache, void const *const key,
+     uint64_t const hash)
+{
+    if (!cache->count)
+    {
+        return NIL;
+    }
+    struct CCC_Cache_slot const *const slot
+        = CCC_private_flat_hash_map_find_with_hash(&cache->index, key, hash);
+    return slot ? slot->index : NIL;
+}
+
+/** Inserts a type whose key is known to be absent. Any eviction happens
+before the index table is searched for a slot, because erasing the slot of the
+victim may open an earlier slot in the probe sequence of the new key. */
+static void *
+insert_new(struct CCC_Cache *const cache, void const *const type,
+           uint64_t const hash)
+{
+    uint32_t const i = claim_position(cache);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(
+            &cache->index, key_in_record(cache, type), hash);
+    if (e.status & (CCC_ENTRY_OCCUPIED | CCC_ENTRY_INSERT_ERROR))
+    {
+        release_position(cache, i);
+        return NULL;
+    }
+    void *const record = record_at(cache, i);
+    (void)memcpy(record, type, cache->sizeof_type);
+    CCC_private_flat_hash_map_insert(
+        e.map, &(struct CCC_Cache_slot){.index = i}, e.hash, e.index);
+    admit(cache, i, hash);
+    ++cache->count;
+    return record;
+}
+
+/** Returns a position for a new record. A full cache evicts first and every
+position is then in use, so the victim position is the one freed. */
+static uint32_t
+claim_position(struct CCC_Cache *const cache)
+{
+    if (cache->count == cache->capacity)
+    {
+        evict(cache);
+    }
+    if (cache->free != NIL)
+    {
+        uint32_t const i = cache->free;
+        cache->free = cache->nodes[i].next;
+        return i;
+    }
+    return cache->end++;
+}
+
+static inline void
+release_position(struct CCC_Cache *const cache, uint32_t const i)
+{
+    cache->nodes[i].queue = QUEUE_FREE;
+    cache->nodes[i].next = cache->free;
+    cache->free = i;
+}
+
+/** Removes the victim chosen by the policy. A record leaving the S3-FIFO
+small queue without being accessed leaves its hash in the ghost table. */
+static void
+evict(struct CCC_Cache *const cache)
+{
+    uint32_t victim = 0;
+    switch (cache->policy)
+    {
+        case CCC_CACHE_POLICY_LRU:
+            victim = lru_victim(cache);
+            break;
+        case CCC_CACHE_POLICY_CLOCK:
+            victim = clock_victim(cache);
+            break;
+        case CCC_CACHE_POLICY_S3_FIFO:
+            victim = s3_fifo_victim(cache);
+            break;
+    }
+    void const *const key = key_in_record(cache, record_at(cache, victim));
+    uint64_t const hash = user_hash(cache, key);
+    if (cache->policy == CCC_CACHE_POLICY_S3_FIFO
+        && cache->nodes[victim].queue == QUEUE_SMALL)
+    {
+        ghost_remember(cache, hash);
+    }
+    struct CCC_Cache_slot const *const slot
+        = CCC_private_flat_hash_map_find_with_hash(&cache->index, key, hash);
+    CCC_private_flat_hash_map_erase(&cache->index,
+                                    slot_index(&cache->index, slot));
+    release_position(cache, victim);
+    --cache->count;
+}
+
+/** The tail of the recency list was accessed least recently. */
+static uint32_t
+lru_victim(struct CCC_Cache *const cache)
+{
+    uint32_t const victim = cache->queue[QUEUE_SMALL].tail;
+    unlink_node(cache, victim);
+    return victim;
+}
+
+/** Clears reference bits under the hand until one is already clear. At most
+one full sweep passes before a victim is found. */
+static uint32_t
+clock_victim(struct CCC_Cache *const cache)
+{
+    for (;;)
+    {
+        uint32_t const i = cache->hand;
+        cache->hand = i + 1 == cache->capacity ? 0 : i + 1;
+        if (!cache->nodes[i].frequency)
+        {
+            return i;
+        }
+        cache->nodes[i].frequency = 0;
+    }
+}
+
+/** Evicts from the small queue while it holds at least its share of the
+cache, moving accessed records to the main queue instead. Otherwise evicts
+from the main queue, giving accessed records another pass and one less access.
+Each pass lowers some access count so the loop ends. The node keeps the queue
+it left so the caller knows whether to remember the victim. */
+static uint32_t
+s3_fifo_victim(struct CCC_Cache *const cache)
+{
+    uint32_t const small_share = cache->capacity / SMALL_QUEUE_DIVISOR
+                                   ? cache->capacity / SMALL_QUEUE_DIVISOR
+                                   : 1;
+    for (;;)
+    {
+        bool const from_small
+            = cache->queue[QUEUE_SMALL].count >= small_share
+           || !cache->queue[QUEUE_MAIN].count;
+        uint32_t const victim
+            = cache->queue[from_small ? QUEUE_SMALL : QUEUE_MAIN].tail;
+        struct CCC_Cache_node *const node = &cache->nodes[victim];
+        unlink_node(cache, victim);
+        if (!node->frequency)
+        {
+            return victim;
+        }
+        node->frequency = from_small ? 0 : (uint8_t)(node->frequency - 1);
+        push_front(cache, victim, QUEUE_MAIN);
+    }
+}
+
+/** Gives a new record its place in the eviction order. */
+static void
+admit(struct CCC_Cache *const cache, uint32_t const i, uint64_t const hash)
+{
+    cache->nodes[i].frequency = 0;
+    switch (cache->policy)
+    {
+        case CCC_CACHE_POLICY_LRU:
+            push_front(cache, i, QUEUE_SMALL);
+            break;
+        case CCC_CACHE_POLICY_CLOCK:
+            cache->nodes[i].queue = QUEUE_SMALL;
+            break;
+        case CCC_CACHE_POLICY_S3_FIFO:
+            push_front(cache, i,
+                       ghost_take(cache, hash) ? QUEUE_MAIN : QUEUE_SMALL);
+            break;
+    }
+}
+
+/** Records an access. Only LRU writes more than the node of the record. */
+static inline void
+touch(struct CCC_Cache *const cache, uint32_t const i)
+{
+    struct CCC_Cache_node *const node = &cache->nodes[i];
+    switch (cache->policy)
+    {
+        case CCC_CACHE_POLICY_LRU:
+            if (cache->queue[QUEUE_SMALL].head != i)
+            {
+                unlink_node(cache, i);
+                push_front(cache, i, QUEUE_SMALL);
+            }
+            break;
+        case CCC_CACHE_POLICY_CLOCK:
+            node->frequency = 1;
+            break;
+        case CCC_CACHE_POLICY_S3_FIFO:
+            if (node->frequency < MAX_FREQUENCY)
+            {
+                ++node->frequency;
+            }
+            break;
+    }
+}
+
+/** Removes the record at position i whose slot is at slot_i. */
+static void
+remove_position(struct CCC_Cache *const cache, uint32_t const i,
+                size_t const slot_i)
+{
+    CCC_private_flat_hash_map_erase(&cache->index, slot_i);
+    if (is_linked(cache))
+    {
+        unlink_node(cache, i);
+    }
+    release_position(cache, i);
+    --cache->count;
+}
+
+static inline void
+push_front(struct CCC_Cache *const cache, uint32_t const i, uint8_t const q)
+{
+    struct CCC_Cache_queue *const queue = &cache->queue[q];
+    struct CCC_Cache_node *const node = &cache->nodes[i];
+    node->queue = q;
+    node->prev = NIL;
+    node->next = queue->head;
+    if (queue->head != NIL)
+    {
+        cache->nodes[queue->head].prev = i;
+    }
+    else
+    {
+        queue->tail = i;
+    }
+    queue->head = i;
+    ++queue->count;
+}
+
+/** Unlinks the node from its queue but leaves its queue mark in place. */
+static inline void
+unlink_node(struct CCC_Cache *const cache, uint32_t const i)
+{
+    struct CCC_Cache_node const *const node = &cache->nodes[i];
+    struct CCC_Cache_queue *const queue = &cache->queue[node->queue];
+    if (node->prev != NIL)
+    {
+        cache->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        queue->head = node->next;
+    }
+    if (node->next != NIL)
+    {
+        cache->nodes[node->next].prev = node->prev;
+    }
+    else
+    {
+        queue->tail = node->prev;
+    }
+    --queue->count;
+}
+
+/** Ghost entries are direct mapped. The low bit is set so that no remembered
+hash is mistaken for an empty entry. */
+static inline void
+ghost_remember(struct CCC_Cache *const cache, uint64_t const hash)
+{
+    cache->ghosts[hash & cache->ghost_mask] = hash | 1;
+}
+
+/** Returns true and forgets the hash if it is remembered. */
+static inline bool
+ghost_take(struct CCC_Cache *const cache, uint64_t const hash)
+{
+    uint64_t *const ghost = &cache->ghosts[hash & cache->ghost_mask];
+    if (*ghost != (hash | 1))
+    {
+        return false;
+    }
+    *ghost = 0;
+    return true;
+}
+
+static inline bool
+is_linked(struct CCC_Cache const *const cache)
+{
+    return cache->policy != CCC_CACHE_POLICY_CLOCK;
+}
+
+/** Walks the queue in both directions checking links, marks, and count. */
+static bool
+validate_queue(struct CCC_Cache const *const cache, uint8_t const q)
+{
+    struct CCC_Cache_queue const *const queue = &cache->queue[q];
+    size_t seen = 0;
+    uint32_t prev = NIL;
+    for (uint32_t i = queue->head; i != NIL; i = cache->nodes[i].next)
+    {
+        if (++seen > queue->count || i >= cache->end
+            || cache->nodes[i].queue != q || cache->nodes[i].prev != prev)
+        {
+            return false;
+        }
+        prev = i;
+    }
+    return seen == queue->count && queue->tail == prev;
+}
+
+/** Empties the queues, positions, and ghost table but keeps the arrays. */
+static void
+reset(struct CCC_Cache *const cache)
+{
+    cache->queue[QUEUE_SMALL] = (struct CCC_Cache_queue){NIL, NIL, 0};
+    cache->queue[QUEUE_MAIN] = (struct CCC_Cache_queue){NIL, NIL, 0};
+    cache->free = NIL;
+    cache->end = 0;
+    cache->count = 0;
+    cache->hand = 0;
+    if (cache->ghosts)
+    {
+        (void)memset(cache->ghosts, 0,
+                     (cache->ghost_mask + 1) * sizeof(uint64_t));
+    }
+}
+
+/** Prefetches the tag group and slot at which the probe for hash begins. A
+fixed index table has no tags until its first insertion. */
+static inline void
+prefetch_slot(struct CCC_Cache const *const cache, uint64_t const hash)
+{
+    struct CCC_Flat_hash_map const *const index = &cache->index;
+    if (!index->tag)
+    {
+        return;
+    }
+    size_t const home = hash & index->mask;
+    prefetch(&index->tag[home]);
+    prefetch((char *)index->data + (home * index->sizeof_type));
+}
+
+static inline size_t
+slot_index(struct CCC_Flat_hash_map const *const map, void const *const slot)
+{
+    return (size_t)((char const *)slot - (char const *)map->data)
+         / map->sizeof_type;
+}
+
+static inline void *
+record_at(struct CCC_Cache const *const cache, size_t const i)
+{
+    return (char *)cache->records + (i * cache->sizeof_type);
+}
+
+static inline void *
+key_in_record(struct CCC_Cache const *const cache, void const *const record)
+{
+    return (char *)record + cache->key_offset;
+}
+
+static inline uint64_t
+user_hash(struct CCC_Cache const *const cache, void const *const key)
+{
+    return cache->hash((CCC_Key_context){
+        .key = key,
+        .context = cache->context,
+    });
+}
+
+static inline void *
+allocate_array(struct CCC_Cache const *const cache, size_t const bytes)
+{
+    return cache->allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = bytes,
+        .context = cache->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+    });
+}
+
+static inline void
+free_array(struct CCC_Cache const *const cache, void *const array,
+           size_t const bytes)
+{
+    if (array)
+    {
+        (void)cache->allocate((CCC_Allocator_context){
+            .input = array,
+            .bytes = 0,
+            .context = cache->context,
+            .old_bytes = bytes,
+        });
+    }
+}
+
+/** Frees the record, node, and ghost arrays of a cache that allocated them.
+The sizes are those requested on initialization. */
+static void
+free_array_set(struct CCC_Cache const *const cache)
+{
+    free_array(cache, cache->records,
+               (size_t)cache->capacity * cache->sizeof_type);
+    free_array(cache, cache->nodes,
+               (size_t)cache->capacity * sizeof(struct CCC_Cache_node));
+    free_array(cache, cache->ghosts,
+               (cache->ghost_mask + 1) * sizeof(uint64_t));
+}
+
+/** The index table hashes a slot by the key of the record it names. This is
+only reached when the table rehashes in place. */
+static uint64_t
+slot_hash(CCC_Key_context const slot)
+{
+    struct CCC_Cache const *const cache = slot.context;
+    struct CCC_Cache_slot const *const named = slot.key;
+    return user_hash(cache,
+                     key_in_record(cache, record_at(cache, named->index)));
+}
+
+/** Compares the user key on the left to the record named by the slot. */
+static CCC_Order
+slot_order(CCC_Key_comparator_context const order)
+{
+    struct CCC_Cache const *const cache = order.context;
+    struct CCC_Cache_slot const *const slot = order.type_right;
+    return cache->compare((CCC_Key_comparator_context){
+        .key_left = order.key_left,
+        .type_right = record_at(cache, slot->index),
+        .context = cache->context,
+    });
+}
+
+/** The index table holds this cache as its context so allocation requests
+are forwarded with the context the user provided. */
+static void *
+index_allocate(CCC_Allocator_context const allocation)
+{
+    struct CCC_Cache const *const cache = allocation.context;
+    return cache->allocate((CCC_Allocator_context){
+        .input = allocation.input,
+        .bytes = allocation.bytes,
+        .context = cache->context,
+        .alignment = allocation.alignment,
+        .old_bytes = allocation.old_bytes,
+    });
+}
+
+static inline size_t
+to_power_of_two(size_t const n)
+{
+    size_t p = 1;
+    while (p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
@@ -0,0 +1,610 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a hash index over a dense array of records. The index is
+an ordinary flat hash map whose elements are the positions of records, with
+the stored hash option so that the full hash of each record sits beside its
+position and rehashing never calls back into this map.
+
+The flat hash map is given this map as its context. Its comparison callback
+receives a user key on the left and a slot on the right and compares the key
+to the record the slot names. Its hash callback is only reached when the flat
+hash map checks itself or rebuilds from slots, and then reads the hash array
+kept beside the records rather than visiting a record. Every search from this
+file passes the user hash directly so the callback is never handed a user key.
+
+Removal keeps the records dense by moving the last record into the hole. The
+slot of the moved record is found by its stored hash and key and then
+rewritten with its new position. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "dense_hash_map.h"
+#include "flat_hash_map.h"
+#include "private/private_dense_hash_map.h"
+#include "private/private_flat_hash_map.h"
+#include "types.h"
+
+/*===========================   Prototypes   ================================*/
+
+static struct CCC_Dense_hash_map_entry
+container_entry(struct CCC_Dense_hash_map *, void const *);
+static void *find(struct CCC_Dense_hash_map const *, void const *);
+static void *insert_record(struct CCC_Dense_hash_map_entry const *,
+                           void const *);
+static void remove_record(struct CCC_Dense_hash_map *, size_t);
+static struct CCC_Dense_hash_map_slot *
+slot_at(struct CCC_Dense_hash_map_entry const *);
+static size_t slot_index(struct CCC_Flat_hash_map const *, void const *);
+static void *record_at(struct CCC_Dense_hash_map const *, size_t);
+static uint64_t hash_at(struct CCC_Dense_hash_map const *, size_t);
+static void *key_in_record(struct CCC_Dense_hash_map const *, void const *);
+static uint64_t user_hash(struct CCC_Dense_hash_map const *, void const *);
+static uint64_t slot_hash(CCC_Key_context);
+static CCC_Order slot_order(CCC_Key_comparator_context);
+static void *index_allocate(CCC_Allocator_context);
+
+/*===========================   Interface   =================================*/
+
+CCC_Result
+CCC_dense_hash_map_reserve(CCC_Dense_hash_map *const map, size_t const to_add)
+{
+    if (!map || !map->allocate)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!to_add)
+    {
+        return CCC_RESULT_OK;
+    }
+    CCC_Result res = CCC_buffer_reserve(&map->records, to_add, map->allocate);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    res = CCC_buffer_reserve(&map->hashes, to_add, map->allocate);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    return CCC_flat_hash_map_reserve(&map->index, to_add, index_allocate);
+}
+
+CCC_Tribool
+CCC_dense_hash_map_contains(CCC_Dense_hash_map const *const map,
+                            void const *const key)
+{
+    if (!map || !key)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return find(map, key) != NULL;
+}
+
+void *
+CCC_dense_hash_map_get_key_value(CCC_Dense_hash_map const *const map,
+                                 void const *const key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+    return find(map, key);
+}
+
+CCC_Dense_hash_map_entry
+CCC_dense_hash_map_entry(CCC_Dense_hash_map *const map, void const *const key)
+{
+    if (!map || !key)
+    {
+        return (CCC_Dense_hash_map_entry){
+            {.slot = {.status = CCC_ENTRY_ARGUMENT_ERROR}}};
+    }
+    return (CCC_Dense_hash_map_entry){container_entry(map, key)};
+}
+
+CCC_Dense_hash_map_entry *
+CCC_dense_hash_map_and_modify(CCC_Dense_hash_map_entry *const entry,
+                              CCC_Type_modifier *const modify)
+{
+    return CCC_dense_hash_map_and_modify_context(entry, modify, NULL);
+}
+
+CCC_Dense_hash_map_entry *
+CCC_dense_hash_map_and_modify_context(CCC_Dense_hash_map_entry *const entry,
+                                      CCC_Type_modifier *const modify,
+                                      void *const context)
+{
+    if (!entry || !modify)
+    {
+        return NULL;
+    }
+    if (entry->private.slot.status & CCC_ENTRY_OCCUPIED)
+    {
+        modify((CCC_Type_context){
+            .type = CCC_dense_hash_map_unwrap(entry),
+            .context = context,
+        });
+    }
+    return entry;
+}
+
+void *
+CCC_dense_hash_map_or_insert(CCC_Dense_hash_map_entry const *const entry,
+                             void const *const type)
+{
+    if (!entry || !type || !entry->private.map
+        || (entry->private.slot.status & CCC_ENTRY_INSERT_ERROR))
+    {
+        return NULL;
+    }
+    if (entry->private.slot.status & CCC_ENTRY_OCCUPIED)
+    {
+        return CCC_dense_hash_map_unwrap(entry);
+    }
+    return insert_record(&entry->private, type);
+}
+
+void *
+CCC_dense_hash_map_insert_entry(CCC_Dense_hash_map_entry const *const entry,
+                                void const *const type)
+{
+    if (!entry || !type || !entry->private.map
+        || (entry->private.slot.status & CCC_ENTRY_INSERT_ERROR))
+    {
+        return NULL;
+    }
+    if (entry->private.slot.status & CCC_ENTRY_OCCUPIED)
+    {
+        void *const record = CCC_dense_hash_map_unwrap(entry);
+        (void)memcpy(record, type, entry->private.map->records.sizeof_type);
+        return record;
+    }
+    return insert_record(&entry->private, type);
+}
+
+CCC_Entry
+CCC_dense_hash_map_remove_entry(CCC_Dense_hash_map_entry const *const entry)
+{
+    if (!entry || !entry->private.map)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (!(entry->private.slot.status & CCC_ENTRY_OCCUPIED))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    size_t const i = slot_at(&entry->private)->index;
+    CCC_private_flat_hash_map_erase(entry->private.slot.map,
+                                    entry->private.slot.index);
+    remove_record(entry->private.map, i);
+    return (CCC_Entry){{.status = CCC_ENTRY_OCCUPIED}};
+}
+
+void *
+CCC_dense_hash_map_unwrap(CCC_Dense_hash_map_entry const *const entry)
+{
+    if (!entry || !(entry->private.slot.status & CCC_ENTRY_OCCUPIED))
+    {
+        return NULL;
+    }
+    return record_at(entry->private.map, slot_at(&entry->private)->index);
+}
+
+CCC_Tribool
+CCC_dense_hash_map_occupied(CCC_Dense_hash_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return (entry->private.slot.status & CCC_ENTRY_OCCUPIED) != 0;
+}
+
+CCC_Tribool
+CCC_dense_hash_map_insert_error(CCC_Dense_hash_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return (entry->private.slot.status & CCC_ENTRY_INSERT_ERROR) != 0;
+}
+
+CCC_Entry
+CCC_dense_hash_map_try_insert(CCC_Dense_hash_map *const map,
+                              void const *const type)
+{
+    if (!map || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    CCC_Dense_hash_map_entry const e
+        = {container_entry(map, key_in_record(map, type))};
+    if (e.private.slot.status & CCC_ENTRY_OCCUPIED)
+    {
+        return (CCC_Entry){{
+            .type = CCC_dense_hash_map_unwrap(&e),
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    void *const inserted = CCC_dense_hash_map_or_insert(&e, type);
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_dense_hash_map_insert_or_assign(CCC_Dense_hash_map *const map,
+                                    void const *const type)
+{
+    if (!map || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    CCC_Dense_hash_map_entry const e
+        = {container_entry(map, key_in_record(map, type))};
+    CCC_Entry_status const status
+        = (e.private.slot.status & CCC_ENTRY_OCCUPIED) ? CCC_ENTRY_OCCUPIED
+                                                       : CCC_ENTRY_VACANT;
+    void *const stored = CCC_dense_hash_map_insert_entry(&e, type);
+    if (!stored)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = stored,
+        .status = status,
+    }};
+}
+
+CCC_Entry
+CCC_dense_hash_map_remove_key_value(CCC_Dense_hash_map *const map,
+                                    void *const type_output)
+{
+    if (!map || !type_output)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_record(map, type_output);
+    struct CCC_Dense_hash_map_slot const *const slot
+        = CCC_private_flat_hash_map_find_with_hash(&map->index, key,
+                                                   user_hash(map, key));
+    if (!slot)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    size_t const i = slot->index;
+    (void)memcpy(type_output, record_at(map, i), map->records.sizeof_type);
+    CCC_private_flat_hash_map_erase(&map->index, slot_index(&map->index, slot));
+    remove_record(map, i);
+    return (CCC_Entry){{
+        .type = type_output,
+        .status = CCC_ENTRY_OCCUPIED,
+    }};
+}
+
+void *
+CCC_dense_hash_map_begin(CCC_Dense_hash_map const *const map)
+{
+    if (!map)
+    {
+        return NULL;
+    }
+    return CCC_buffer_begin(&map->records);
+}
+
+void *
+CCC_dense_hash_map_next(CCC_Dense_hash_map const *const map,
+                        void const *const type_iterator)
+{
+    if (!map || !type_iterator)
+    {
+        return NULL;
+    }
+    return CCC_buffer_next(&map->records, type_iterator);
+}
+
+void *
+CCC_dense_hash_map_end(CCC_Dense_hash_map const *const map)
+{
+    if (!map)
+    {
+        return NULL;
+    }
+    return CCC_buffer_end(&map->records);
+}
+
+CCC_Count
+CCC_dense_hash_map_count(CCC_Dense_hash_map const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = map->records.count};
+}
+
+CCC_Tribool
+CCC_dense_hash_map_is_empty(CCC_Dense_hash_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return !map->records.count;
+}
+
+CCC_Tribool
+CCC_dense_hash_map_validate(CCC_Dense_hash_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    size_t const count = map->records.count;
+    if (map->hashes.count != count || map->index.count != count
+        || !CCC_flat_hash_map_validate(&map->index))
+    {
+        return CCC_FALSE;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        void const *const key = key_in_record(map, record_at(map, i));
+        if (hash_at(map, i) != user_hash(map, key))
+        {
+            return CCC_FALSE;
+        }
+        struct CCC_Dense_hash_map_slot const *const slot
+            = CCC_private_flat_hash_map_find_with_hash(&map->index, key,
+                                                       hash_at(map, i));
+        if (!slot || slot->index != i)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+CCC_Result
+CCC_dense_hash_map_clear(CCC_Dense_hash_map *const map,
+                         CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    (void)CCC_buffer_clear(&map->records, destroy);
+    (void)CCC_buffer_clear(&map->hashes, NULL);
+    (void)CCC_flat_hash_map_clear(&map->index, NULL);
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_dense_hash_map_clear_and_free(CCC_Dense_hash_map *const map,
+                                  CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    (void)CCC_buffer_clear_and_free(&map->records, destroy);
+    (void)CCC_buffer_clear_and_free(&map->hashes, NULL);
+    if (map->index.data)
+    {
+        (void)CCC_flat_hash_map_clear_and_free(&map->index, NULL);
+    }
+    return CCC_RESULT_OK;
+}
+
+/*======================     Private Interface      =========================*/
+
+CCC_Result
+CCC_private_dense_hash_map_initialize(
+    struct CCC_Dense_hash_map *const map, size_t const sizeof_type,
+    size_t const key_offset, CCC_Key_hasher *const hash,
+    CCC_Key_comparator *const compare, CCC_Allocator *const allocate,
+    void *const context, size_t const capacity)
+{
+    if (!map || !hash || !compare || !allocate)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    *map = (struct CCC_Dense_hash_map){
+        .index = (struct CCC_Flat_hash_map)
+            CCC_private_flat_hash_map_initialize_with_options(
+                NULL, struct CCC_Dense_hash_map_slot, index, slot_hash,
+                slot_order, index_allocate, map, 0,
+                CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+        .records = {
+            .sizeof_type = sizeof_type,
+            .allocate = allocate,
+            .context = context,
+        },
+        .hashes = {
+            .sizeof_type = sizeof(uint64_t),
+            .allocate = allocate,
+            .context = context,
+        },
+        .key_offset = key_offset,
+        .hash = hash,
+        .compare = compare,
+        .allocate = allocate,
+        .context = context,
+    };
+    return CCC_dense_hash_map_reserve(map, capacity);
+}
+
+/*=========================   Static Internals   ============================*/
+
+/** Hashes the key once and searches the index table with that hash. A Vacant
+entry keeps the slot where the position of a new record belongs. */
+static struct CCC_Dense_hash_map_entry
+container_entry(struct CCC_Dense_hash_map *const map, void const *const key)
+{
+    return (struct CCC_Dense_hash_map_entry){
+        .map = map,
+        .slot = CCC_private_flat_hash_map_entry_with_hash(&map->index, key,
+                                                          user_hash(map, key)),
+    };
+}
+
+/** Returns the record with key or NULL if it is absent. */
+static void *
+find(struct CCC_Dense_hash_map const *const map, void const *const key)
+{
+    if (!map->records.count)
+    {
+        return NULL;
+    }
+    struct CCC_Dense_hash_map_slot const *const slot
+        = CCC_private_flat_hash_map_find_with_hash(&map->index, key,
+                                                   user_hash(map, key));
+    return slot ? record_at(map, slot->index) : NULL;
+}
+
+/** Appends the record and its hash and then claims the Vacant slot of the
+entry for its position. The index table already has room for the slot, so only
+the record and hash arrays may fail to grow, and they are restored if so. */
+static void *
+insert_record(struct CCC_Dense_hash_map_entry const *const e,
+              void const *const type)
+{
+    struct CCC_Dense_hash_map *const map = e->map;
+    void *const record = CCC_buffer_push_back(&map->records, type);
+    if (!record)
+    {
+        return NULL;
+    }
+    if (!CCC_buffer_push_back(&map->hashes, &e->slot.hash))
+    {
+        (void)CCC_buffer_pop_back(&map->records);
+        return NULL;
+    }
+    CCC_private_flat_hash_map_insert(
+        e->slot.map,
+        &(struct CCC_Dense_hash_map_slot){.index = map->records.count - 1},
+        e->slot.hash, e->slot.index);
+    return record;
+}
+
+/** Removes the record at position i whose slot has already been erased. The
+last record moves into the hole and the slot naming it is found and updated.
+The moved record is still at the back when its slot is searched so the
+comparison sees a complete record either way. */
+static void
+remove_record(struct CCC_Dense_hash_map *const map, size_t const i)
+{
+    size_t const last = map->records.count - 1;
+    if (i != last)
+    {
+        void *const moved = record_at(map, last);
+        uint64_t const hash = hash_at(map, last);
+        struct CCC_Dense_hash_map_slot *const slot
+            = CCC_private_flat_hash_map_find_with_hash(
+                &map->index, key_in_record(map, moved), hash);
+        slot->index = i;
+        (void)memcpy(record_at(map, i), moved, map->records.sizeof_type);
+        *(uint64_t *)CCC_buffer_at(&map->hashes, i) = hash;
+    }
+    (void)CCC_buffer_pop_back(&map->records);
+    (void)CCC_buffer_pop_back(&map->hashes);
+}
+
+/** Returns the slot of an Occupied entry. */
+static inline struct CCC_Dense_hash_map_slot *
+slot_at(struct CCC_Dense_hash_map_entry const *const e)
+{
+    return CCC_private_flat_hash_map_data_at(e->slot.map, e->slot.index);
+}
+
+static inline size_t
+slot_index(struct CCC_Flat_hash_map const *const map, void const *const slot)
+{
+    return (size_t)((char const *)slot - (char const *)map->data)
+         / map->sizeof_type;
+}
+
+static inline void *
+record_at(struct CCC_Dense_hash_map const *const map, size_t const i)
+{
+    return CCC_buffer_at(&map->records, i);
+}
+
+static inline uint64_t
+hash_at(struct CCC_Dense_hash_map const *const map, size_t const i)
+{
+    return *(uint64_t *)CCC_buffer_at(&map->hashes, i);
+}
+
+static inline void *
+key_in_record(struct CCC_Dense_hash_map const *const map,
+              void const *const record)
+{
+    return (char *)record + map->key_offset;
+}
+
+static inline uint64_t
+user_hash(struct CCC_Dense_hash_map const *const map, void const *const key)
+{
+    return map->hash((CCC_Key_context){
+        .key = key,
+        .context = map->context,
+    });
+}
+
+/** The index table hashes a slot by the hash kept for the record it names.
+Searches from this file always pass a hash so the key here is always a slot. */
+static uint64_t
+slot_hash(CCC_Key_context const slot)
+{
+    struct CCC_Dense_hash_map const *const map = slot.context;
+    struct CCC_Dense_hash_map_slot const *const named = slot.key;
+    return hash_at(map, named->index);
+}
+
+/** Compares the user key on the left to the record named by the slot. */
+static CCC_Order
+slot_order(CCC_Key_comparator_context const order)
+{
+    struct CCC_Dense_hash_map const *const map = order.context;
+    struct CCC_Dense_hash_map_slot const *const slot = order.type_right;
+    return map->compare((CCC_Key_comparator_context){
+        .key_left = order.key_left,
+        .type_right = record_at(map, slot->index),
+        .context = map->context,
+    });
+}
+
+/** The index table holds this map as its context so allocation requests are
+forwarded with the context the user provided. */
+static void *
+index_allocate(CCC_Allocator_context const allocation)
+{
+    struct CCC_Dense_hash_map const *const map = allocation.context;
+    return map->allocate((CCC_Allocator_context){
+        .input = allocation.input,
+        .bytes = allocation.bytes,
+        .context = map->context,
+        .alignment = allocation.alignment,
+        .old_bytes = allocation.old_bytes,
+    });
+}
@@ -149,6 +149,7 @@ CCC_doubly_linked_list_pop_front(CCC_Doubly_linked_list *const list)
             .input = struct_base(list, r),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
     }
     --list->count;
@@ -170,6 +171,7 @@ CCC_doubly_linked_list_pop_back(CCC_Doubly_linked_list *const list)
             .input = struct_base(list, r),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
     }
     --list->count;
@@ -220,6 +222,7 @@ CCC_doubly_linked_list_erase(CCC_Doubly_linked_list *const list,
             .input = struct_base(list, type_intruder),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
     }
     --list->count;
@@ -572,6 +575,7 @@ CCC_doubly_linked_list_clear(CCC_Doubly_linked_list *const list,
                 .input = node,
                 .bytes = 0,
                 .context = list->context,
+                .old_bytes = list->sizeof_type,
             });
         }
     }
@@ -949,6 +953,7 @@ erase_range(struct CCC_Doubly_linked_list const *const list,
             .input = struct_base(list, node),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
         ++count;
         if (node == end)
@@ -0,0 +1,594 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements split block filters. The mixed hash of a key is divided
+in two. The low bits select a block and the high 32 bits are the key of the
+block. The key is multiplied by a different odd salt for each of the eight
+words of the block and the top bits of each product select the bit, or the
+four bit counter, of that word. One multiply and shift per word gives eight
+positions that are independent enough for a filter while keeping every word
+of the block in use, which is what lets a vector unit handle all eight at
+once.
+
+The block layout does not depend on the instructions used, so the portable
+and vector versions read and write the same bits. Counting filters keep their
+counters in the same words but are always handled a word at a time because
+saturating nibble arithmetic gains little from the vector unit next to the
+cache miss on the block. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "filter.h"
+#include "private/private_filter.h"
+#include "private/private_hash.h"
+#include "types.h"
+
+/*=========================   Platform Selection  ===========================*/
+
+/** The vector versions of Bloom setting and testing need variable 64 bit
+shifts, first found in AVX2. AVX-512 handles the whole block in one register.
+The portable version may be requested for any target. */
+#if defined(__x86_64) && defined(__AVX512F__) && !defined(CCC_FILTER_PORTABLE)
+#    define CCC_FILTER_HAS_X86_AVX512
+#    include <immintrin.h>
+#elif defined(__x86_64) && defined(__AVX2__) && !defined(CCC_FILTER_PORTABLE)
+#    define CCC_FILTER_HAS_X86_AVX2
+#    include <immintrin.h>
+#endif /* defined(__x86_64) && defined(__AVX512F__) && ... */
+
+#if defined(__has_builtin) && __has_builtin(__builtin_prefetch)
+#    define prefetch(address) __builtin_prefetch((address), 0, 3)
+#else /* !defined(__has_builtin) || !__has_builtin(__builtin_prefetch) */
+#    define prefetch(address) ((void)(address))
+#endif /* defined(__has_builtin) && __has_builtin(__builtin_prefetch) */
+
+/*=========================   Constants     =================================*/
+
+enum : size_t
+{
+    /** The keys a Bloom block serves at about 16 bits per key. */
+    BLOOM_KEYS_PER_BLOCK = 32,
+    /** The keys a counting block serves at about 16 counters per key. */
+    COUNTING_KEYS_PER_BLOCK = 8,
+    /** The number of keys hashed and prefetched before any is tested. */
+    BATCH_PREFETCH_COUNT = 16,
+    /** Shifting a 32 bit product right by this leaves a bit of a word. */
+    BIT_SHIFT = 32 - 6,
+    /** Shifting a 32 bit product right by this leaves a counter of a word. */
+    COUNTER_SHIFT = 32 - 4,
+};
+
+enum : uint64_t
+{
+    /** A four bit counter. */
+    COUNTER_MASK = 0xF,
+};
+
+/** The odd multipliers that derive a position in each word from the key of
+the block. These are the salts of the split block Bloom filter of Apache
+Parquet, chosen so that the eight products are well spread. */
+static uint32_t const salts[CCC_PRIVATE_FILTER_BLOCK_WORDS] = {
+    0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+    0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U,
+};
+
+/*===========================   Prototypes   ================================*/
+
+static struct CCC_Filter_block *block_of(struct CCC_Filter const *, uint64_t);
+static uint32_t block_key(uint64_t);
+static uint64_t user_hash(struct CCC_Filter const *, void const *);
+static void insert_mixed(struct CCC_Filter *, uint64_t);
+static CCC_Result remove_mixed(struct CCC_Filter *, uint64_t);
+static bool test_hash(struct CCC_Filter const *, uint64_t);
+static void bloom_set(struct CCC_Filter_block *, uint32_t);
+static bool bloom_test(struct CCC_Filter_block const *, uint32_t);
+static void counting_increment(struct CCC_Filter_block *, uint32_t);
+static void counting_decrement(struct CCC_Filter_block *, uint32_t);
+static bool counting_test(struct CCC_Filter_block const *, uint32_t);
+static size_t to_power_of_two(size_t);
+static size_t min(size_t, size_t);
+
+/*===========================   Interface   =================================*/
+
+CCC_Result
+CCC_filter_initialize(CCC_Filter *const filter, CCC_Filter_kind const kind,
+                      CCC_Key_hasher *const hash,
+                      CCC_Allocator *const allocate, void *const context,
+                      size_t const expected_count)
+{
+    if (!filter || !allocate)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    size_t const per_block = kind == CCC_FILTER_KIND_COUNTING
+                               ? COUNTING_KEYS_PER_BLOCK
+                               : BLOOM_KEYS_PER_BLOCK;
+    size_t const needed = (expected_count / per_block)
+                        + (expected_count % per_block != 0);
+    if (needed > (SIZE_MAX / sizeof(struct CCC_Filter_block)) / 2)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    return CCC_private_filter_initialize(filter, kind, hash, allocate, context,
+                                         NULL, to_power_of_two(needed));
+}
+
+CCC_Tribool
+CCC_filter_contains(CCC_Filter const *const filter, void const *const key)
+{
+    if (!filter || !key)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    if (!filter->block_count)
+    {
+        return CCC_FALSE;
+    }
+    return test_hash(filter, user_hash(filter, key));
+}
+
+CCC_Tribool
+CCC_filter_contains_with_hash(CCC_Filter const *const filter,
+                              uint64_t const hash)
+{
+    if (!filter)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    if (!filter->block_count)
+    {
+        return CCC_FALSE;
+    }
+    return test_hash(filter, CCC_private_hash_mix(hash));
+}
+
+CCC_Count
+CCC_filter_contains_batch(CCC_Filter const *const filter,
+                          void const *const keys[], size_t const n,
+                          bool maybe_present[])
+{
+    if (!filter || (n && (!keys || !maybe_present)))
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    /* A NULL key is rejected as CCC_filter_contains rejects it, before any
+       output is written. */
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!keys[i])
+        {
+            return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+        }
+    }
+    if (!filter->block_count)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            maybe_present[i] = false;
+        }
+        return (CCC_Count){.count = 0};
+    }
+    size_t found = 0;
+    uint64_t hashes[BATCH_PREFETCH_COUNT];
+    for (size_t base = 0; base < n; base += BATCH_PREFETCH_COUNT)
+    {
+        size_t const chunk = min(n - base, BATCH_PREFETCH_COUNT);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            hashes[i] = user_hash(filter, keys[base + i]);
+            prefetch(block_of(filter, hashes[i]));
+        }
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            maybe_present[base + i] = test_hash(filter, hashes[i]);
+            found += maybe_present[base + i];
+        }
+    }
+    return (CCC_Count){.count = found};
+}
+
+CCC_Result
+CCC_filter_insert(CCC_Filter *const filter, void const *const key)
+{
+    if (!filter || !key || !filter->block_count)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    insert_mixed(filter, user_hash(filter, key));
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_filter_insert_with_hash(CCC_Filter *const filter, uint64_t const hash)
+{
+    if (!filter || !filter->block_count)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    insert_mixed(filter, CCC_private_hash_mix(hash));
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_filter_remove(CCC_Filter *const filter, void const *const key)
+{
+    if (!filter || !key || !filter->block_count
+        || filter->kind != CCC_FILTER_KIND_COUNTING)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return remove_mixed(filter, user_hash(filter, key));
+}
+
+CCC_Result
+CCC_filter_remove_with_hash(CCC_Filter *const filter, uint64_t const hash)
+{
+    if (!filter || !filter->block_count
+        || filter->kind != CCC_FILTER_KIND_COUNTING)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return remove_mixed(filter, CCC_private_hash_mix(hash));
+}
+
+CCC_Count
+CCC_filter_count(CCC_Filter const *const filter)
+{
+    if (!filter)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = filter->count};
+}
+
+CCC_Count
+CCC_filter_block_count(CCC_Filter const *const filter)
+{
+    if (!filter)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = filter->block_count};
+}
+
+CCC_Tribool
+CCC_filter_is_empty(CCC_Filter const *const filter)
+{
+    if (!filter)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return !filter->count;
+}
+
+CCC_Result
+CCC_filter_clear(CCC_Filter *const filter)
+{
+    if (!filter)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (filter->blocks)
+    {
+        (void)memset(filter->blocks, 0,
+                     filter->block_count * sizeof(struct CCC_Filter_block));
+    }
+    filter->count = 0;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_filter_clear_and_free(CCC_Filter *const filter)
+{
+    CCC_Result const res = CCC_filter_clear(filter);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    if (!filter->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    (void)filter->allocate((CCC_Allocator_context){
+        .input = filter->blocks,
+        .bytes = 0,
+        .context = filter->context,
+        .old_bytes = filter->block_count * sizeof(struct CCC_Filter_block),
+    });
+    filter->blocks = NULL;
+    filter->block_count = 0;
+    return CCC_RESULT_OK;
+}
+
+/*======================     Private Interface      =========================*/
+
+CCC_Result
+CCC_private_filter_initialize(struct CCC_Filter *const filter,
+                              enum CCC_Filter_kind const kind,
+                              CCC_Key_hasher *const hash,
+                              CCC_Allocator *const allocate,
+                              void *const context, void *const storage,
+                              size_t const block_count)
+{
+    if (!filter || !hash || kind > CCC_FILTER_KIND_COUNTING || !block_count
+        || (block_count & (block_count - 1)) || (!storage && !allocate))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    *filter = (struct CCC_Filter){
+        .blocks = storage,
+        .block_count = block_count,
+        .hash = hash,
+        .allocate = storage ? NULL : allocate,
+        .context = context,
+        .kind = kind,
+    };
+    if (!storage)
+    {
+        filter->blocks = allocate((CCC_Allocator_context){
+            .input = NULL,
+            .bytes = block_count * sizeof(struct CCC_Filter_block),
+            .context = context,
+            .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+        });
+        if (!filter->blocks)
+        {
+            *filter = (struct CCC_Filter){};
+            return CCC_RESULT_ALLOCATOR_ERROR;
+        }
+    }
+    (void)memset(filter->blocks, 0,
+                 block_count * sizeof(struct CCC_Filter_block));
+    return CCC_RESULT_OK;
+}
+
+/*=========================   Static Internals   ============================*/
+
+static inline void
+insert_mixed(struct CCC_Filter *const filter, uint64_t const mixed)
+{
+    struct CCC_Filter_block *const block = block_of(filter, mixed);
+    if (filter->kind == CCC_FILTER_KIND_COUNTING)
+    {
+        counting_increment(block, block_key(mixed));
+    }
+    else
+    {
+        bloom_set(block, block_key(mixed));
+    }
+    ++filter->count;
+}
+
+/** Removes one insertion from a counting filter if every counter of the key
+is non-zero, and otherwise fails without changing anything. */
+static inline CCC_Result
+remove_mixed(struct CCC_Filter *const filter, uint64_t const mixed)
+{
+    struct CCC_Filter_block *const block = block_of(filter, mixed);
+    uint32_t const key = block_key(mixed);
+    if (!counting_test(block, key))
+    {
+        return CCC_RESULT_FAIL;
+    }
+    counting_decrement(block, key);
+    if (filter->count)
+    {
+        --filter->count;
+    }
+    return CCC_RESULT_OK;
+}
+
+/** Tests the block of an already mixed hash. */
+static inline bool
+test_hash(struct CCC_Filter const *const filter, uint64_t const mixed)
+{
+    struct CCC_Filter_block const *const block = block_of(filter, mixed);
+    return filter->kind == CCC_FILTER_KIND_COUNTING
+             ? counting_test(block, block_key(mixed))
+             : bloom_test(block, block_key(mixed));
+}
+
+#ifdef CCC_FILTER_HAS_X86_AVX512
+
+/** The eight bits of the key, one per 64 bit lane. */
+static inline __m512i
+bloom_mask(uint32_t const key)
+{
+    __m256i const bits = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_set1_epi32((int)key),
+                           _mm256_loadu_si256((__m256i const *)salts)),
+        BIT_SHIFT);
+    return _mm512_sllv_epi64(_mm512_set1_epi64(1),
+                             _mm512_cvtepu32_epi64(bits));
+}
+
+static inline void
+bloom_set(struct CCC_Filter_block *const block, uint32_t const key)
+{
+    _mm512_storeu_si512(
+        block->words,
+        _mm512_or_si512(_mm512_loadu_si512(block->words), bloom_mask(key)));
+}
+
+static inline bool
+bloom_test(struct CCC_Filter_block const *const block, uint32_t const key)
+{
+    __m512i const mask = bloom_mask(key);
+    return !_mm512_cmpneq_epi64_mask(
+        _mm512_and_si512(_mm512_loadu_si512(block->words), mask), mask);
+}
+
+#elifdef CCC_FILTER_HAS_X86_AVX2
+
+/** The eight bits of the key, one per 64 bit lane. The low half holds the
+bits of the first four words. */
+static inline void
+bloom_mask(uint32_t const key, __m256i *const low, __m256i *const high)
+{
+    __m256i const bits = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_set1_epi32((int)key),
+                           _mm256_loadu_si256((__m256i const *)salts)),
+        BIT_SHIFT);
+    __m256i const one = _mm256_set1_epi64x(1);
+    *low = _mm256_sllv_epi64(
+        one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+    *high = _mm256_sllv_epi64(
+        one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+}
+
+static inline void
+bloom_set(struct CCC_Filter_block *const block, uint32_t const key)
+{
+    __m256i low;
+    __m256i high;
+    bloom_mask(key, &low, &high);
+    __m256i *const words = (__m256i *)(void *)block->words;
+    _mm256_storeu_si256(&words[0],
+                        _mm256_or_si256(_mm256_loadu_si256(&words[0]), low));
+    _mm256_storeu_si256(&words[1],
+                        _mm256_or_si256(_mm256_loadu_si256(&words[1]), high));
+}
+
+static inline bool
+bloom_test(struct CCC_Filter_block const *const block, uint32_t const key)
+{
+    __m256i low;
+    __m256i high;
+    bloom_mask(key, &low, &high);
+    __m256i const *const words = (__m256i const *)(void const *)block->words;
+    /* The carry flag test is set when every bit of the mask is in the block. */
+    return _mm256_testc_si256(_mm256_loadu_si256(&words[0]), low)
+         & _mm256_testc_si256(_mm256_loadu_si256(&words[1]), high);
+}
+
+#else /* PORTABLE FALLBACK */
+
+static inline uint64_t
+bloom_bit(uint32_t const key, size_t const word)
+{
+    return (uint64_t)1 << ((uint32_t)(key * salts[word]) >> BIT_SHIFT);
+}
+
+static inline void
+bloom_set(struct CCC_Filter_block *const block, uint32_t const key)
+{
+    for (size_t i = 0; i < CCC_PRIVATE_FILTER_BLOCK_WORDS; ++i)
+    {
+        block->words[i] |= bloom_bit(key, i);
+    }
+}
+
+static inline bool
+bloom_test(struct CCC_Filter_block const *const block, uint32_t const key)
+{
+    uint64_t missing = 0;
+    for (size_t i = 0; i < CCC_PRIVATE_FILTER_BLOCK_WORDS; ++i)
+    {
+        uint64_t const bit = bloom_bit(key, i);
+        missing |= bit & ~block->words[i];
+    }
+    return !missing;
+}
+
+#endif /* defined(CCC_FILTER_HAS_X86_AVX512) */
+
+/** The shift of the four bit counter of the key in a word. */
+static inline unsigned
+counter_shift(uint32_t const key, size_t const word)
+{
+    return ((uint32_t)(key * salts[word]) >> COUNTER_SHIFT) * 4;
+}
+
+/** Counters saturate at their maximum and then never change, because the
+number of insertions they represent is no longer known. */
+static inline void
+counting_increment(struct CCC_Filter_block *const block, uint32_t const key)
+{
+    for (size_t i = 0; i < CCC_PRIVATE_FILTER_BLOCK_WORDS; ++i)
+    {
+        unsigned const shift = counter_shift(key, i);
+        if (((block->words[i] >> shift) & COUNTER_MASK) != COUNTER_MASK)
+        {
+            block->words[i] += (uint64_t)1 << shift;
+        }
+    }
+}
+
+/** Assumes every counter of the key is non-zero. */
+static inline void
+counting_decrement(struct CCC_Filter_block *const block, uint32_t const key)
+{
+    for (size_t i = 0; i < CCC_PRIVATE_FILTER_BLOCK_WORDS; ++i)
+    {
+        unsigned const shift = counter_shift(key, i);
+        if (((block->words[i] >> shift) & COUNTER_MASK) != COUNTER_MASK)
+        {
+            block->words[i] -= (uint64_t)1 << shift;
+        }
+    }
+}
+
+static inline bool
+counting_test(struct CCC_Filter_block const *const block, uint32_t const key)
+{
+    bool present = true;
+    for (size_t i = 0; i < CCC_PRIVATE_FILTER_BLOCK_WORDS; ++i)
+    {
+        present &= ((block->words[i] >> counter_shift(key, i)) & COUNTER_MASK)
+                != 0;
+    }
+    return present;
+}
+
+/** The low bits of a mixed hash select the block. */
+static inline struct CCC_Filter_block *
+block_of(struct CCC_Filter const *const filter, uint64_t const mixed)
+{
+    return &filter->blocks[mixed & (filter->block_count - 1)];
+}
+
+/** The high bits of a mixed hash are the key within the block. They are
+independent of the block for any block count up to 2^32. */
+static inline uint32_t
+block_key(uint64_t const mixed)
+{
+    return (uint32_t)(mixed >> 32);
+}
+
+static inline uint64_t
+user_hash(struct CCC_Filter const *const filter, void const *const key)
+{
+    return CCC_private_hash_mix(filter->hash((CCC_Key_context){
+        .key = key,
+        .context = filter->context,
+    }));
+}
+
+static inline size_t
+to_power_of_two(size_t const n)
+{
+    size_t p = 1;
+    while (p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
+
+static inline size_t
+min(size_t const a, size_t const b)
+{
+    return a < b ? a : b;
+}
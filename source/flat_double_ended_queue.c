@@ -744,6 +744,7 @@ maybe_resize(struct CCC_Flat_double_ended_queue *const queue,
         .input = NULL,
         .bytes = sizeof_type * required,
         .context = queue->buffer.context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
     });
     if (!new_data)
     {
@@ -26,20 +26,24 @@ Hashbrown: https://github.com/rust-lang/hashbrown
 This implementation is focused on SIMD friendly code or Portable Word based
 code when SIMD is not available. In any case the goal is to query multiple
 candidate keys for a match in the map simultaneously. This is achieved in the
-best case by having 16 one-byte hash fingerprints analyzed simultaneously for
-a match against a candidate fingerprint. The details of how this is done and
-trade-offs involved can be found in the comments around the implementations
-and data structures. The ARM NEON implementation may be updated if they add
-better capabilities for 128 bit group operations. */
+best case by having 16, 32, or 64 one-byte hash fingerprints analyzed
+simultaneously for a match against a candidate fingerprint, depending on the
+widest x86 vector extension the processor supports. The details of how
+this is done and trade-offs involved can be found in the comments around the
+implementations and data structures. The ARM NEON implementation may be updated
+if they add better capabilities for 128 bit group operations. */
 #include <assert.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdalign.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "buffer.h"
 #include "flat_hash_map.h"
 #include "private/private_flat_hash_map.h"
+#include "private/private_hash.h"
 #include "private/private_types.h"
 #include "types.h"
 
@@ -63,30 +67,42 @@ vector instructions we can try. */
 #    define likely(expr) expr
 #endif /* defined(__has_builtin) && __has_builtin(__builtin_expect) */
 
+#if defined(__has_builtin) && __has_builtin(__builtin_prefetch)
+#    define prefetch(address) __builtin_prefetch((address), 0, 3)
+#else /* !defined(__has_builtin) || !__has_builtin(__builtin_prefetch) */
+#    define prefetch(address) ((void)(address))
+#endif /* defined(__has_builtin) && __has_builtin(__builtin_prefetch) */
+
 /* Can we vectorize instructions? Also it is possible to specify we want a
 portable implementation. Consider exposing to user in header docs. */
 #ifdef CCC_HAS_X86_SIMD
 
-/** @internal The 128 bit vector type for efficient SIMD group scanning. 16 one
-byte large tags fit in this type. */
+/** @internal On x86 a group is a view of the tags because the width scanned is
+chosen at runtime. Fixed size maps and older processors scan 16 tags with
+SSE2 while a dynamic map may scan 32 with AVX2 or 64 with AVX-512BW. The tags
+are only read by the match functions, which load them with the instructions of
+the recorded width. */
 struct Group
 {
-    __m128i v;
+    /** @internal The first tag of the group. */
+    struct CCC_Flat_hash_map_tag const *tag;
+    /** @internal The number of tags in the group. */
+    size_t count;
 };
 
-/** @internal Because we use 128 bit vectors over tags the results of various
-operations can be compressed into a 16 bit integer. */
+/** @internal The most significant bit of each tag in a group compresses into
+one bit of the mask. The widest group needs every bit. */
 struct Match_mask
 {
-    uint16_t v;
+    uint64_t v;
 };
 
 enum : typeof((struct Match_mask){}.v)
 {
     /** @internal MSB tag bit used for static assert. */
-    MATCH_MASK_MSB = 0x8000,
+    MATCH_MASK_MSB = 0x8000000000000000,
     /** @internal All bits on in a mask except for the 0th tag bit. */
-    MATCH_MASK_0TH_TAG_OFF = 0xFFFE,
+    MATCH_MASK_0TH_TAG_OFF = 0xFFFFFFFFFFFFFFFE,
 };
 
 #elifdef CCC_HAS_ARM_SIMD
@@ -174,8 +190,125 @@ enum : typeof((struct CCC_Flat_hash_map_tag){}.v)
 
 enum : typeof((struct CCC_Flat_hash_map_tag){}.v)
 {
-    /** @internal Shortened group size name for readability. */
+    /** @internal Shortened group size name for readability. This is the width
+    of every fixed size map and the narrowest width a dynamic map scans. */
     GROUP_COUNT = CCC_FLAT_HASH_MAP_GROUP_COUNT,
+    /** @internal The widest group a dynamic map may scan on this platform. */
+    GROUP_COUNT_MAX = CCC_FLAT_HASH_MAP_MAX_GROUP_COUNT,
+    /** @internal The index the match functions report when no tag is on. No
+    group of any width has a tag at this index. */
+    MATCH_NONE = GROUP_COUNT_MAX,
+};
+
+/** @internal The build may lower the widest group a dynamic map picks, which
+lets one processor test the narrower scans. The default is the widest the
+platform offers, limited at runtime to what the processor supports. */
+#ifndef CCC_FLAT_HASH_MAP_WIDEST_GROUP
+#    define CCC_FLAT_HASH_MAP_WIDEST_GROUP GROUP_COUNT_MAX
+#endif /* !defined(CCC_FLAT_HASH_MAP_WIDEST_GROUP) */
+static_assert(CCC_FLAT_HASH_MAP_WIDEST_GROUP >= GROUP_COUNT
+                  && CCC_FLAT_HASH_MAP_WIDEST_GROUP <= GROUP_COUNT_MAX
+                  && (CCC_FLAT_HASH_MAP_WIDEST_GROUP
+                      & (CCC_FLAT_HASH_MAP_WIDEST_GROUP - 1))
+                         == 0,
+              "the widest group must be a width the platform scans.");
+
+/*=========================     Batch Count     =============================*/
+
+enum : size_t
+{
+    /** @internal Keys hashed and prefetched before any of their probes begin.
+    Enough to keep many cache misses in flight while the hashes stay in the
+    L1 cache. */
+    BATCH_PREFETCH_COUNT = 16,
+};
+
+/*=======================    Migration Step    ==============================*/
+
+enum : size_t
+{
+    /** @internal Groups of the previous table moved by each modification while
+    an incremental resize is in progress. The new table has room for at least
+    as many insertions as the previous table had slots, so even one group per
+    insertion empties the previous table long before the next resize. */
+    MIGRATION_GROUP_STEP = 2,
+};
+
+/*=======================    Parallel Build    ==============================*/
+
+enum : size_t
+{
+    /** @internal Table ranges per thread in a parallel build. More ranges than
+    threads even out the work when elements cluster. */
+    PARALLEL_RANGES_PER_THREAD = 8,
+    /** @internal The fewest groups in one range. Probes rarely leave a range
+    this wide so few elements fall back to the calling thread. */
+    PARALLEL_MIN_RANGE_GROUPS = 16,
+};
+
+/** @internal The steps every thread of a parallel build performs in turn. */
+enum Parallel_phase : uint8_t
+{
+    /** Hash each source element and count it in its destination range. */
+    PARALLEL_PHASE_HASH,
+    /** Write each source index to its place in the grouping by range. */
+    PARALLEL_PHASE_GROUP,
+    /** Place the elements of each range in the destination table. */
+    PARALLEL_PHASE_PLACE,
+};
+
+/** @internal The shared state of a parallel build. The elements come from the
+full slots of a source table or from a contiguous array. Each thread writes
+only its own counts, its own grouped positions, and the table slots of the
+ranges it owns, so no synchronization is needed between the joins of each
+phase. */
+struct Parallel_build
+{
+    /** The destination table, already large enough for every element. */
+    struct CCC_Flat_hash_map *map;
+    /** The table whose full slots are moved or NULL for an array source. */
+    struct CCC_Flat_hash_map const *source;
+    /** The array of user types when there is no source table. */
+    char const *types;
+    /** The source slots or array elements to consider. */
+    size_t source_count;
+    /** True if no key repeats, allowing placement without comparison. */
+    CCC_Tribool keys_unique;
+    /** The number of threads, including the caller. */
+    size_t threads;
+    /** The number of destination ranges. */
+    size_t ranges;
+    /** The destination slots in each range, a multiple of the group size. */
+    size_t range_slots;
+    /** The hash of each source index. */
+    uint64_t *hashes;
+    /** The elements each thread found for each range, then their cursors. */
+    size_t *counts;
+    /** The first grouped position of each range and one past the last. */
+    size_t *range_start;
+    /** The first grouped position of each range left for the caller. */
+    size_t *deferred;
+    /** The elements added to each range. */
+    size_t *added;
+    /** The empty slots consumed in each range. */
+    size_t *consumed;
+    /** The source indices grouped by destination range. */
+    size_t *order;
+    /** The current phase. */
+    enum Parallel_phase phase;
+};
+
+/** @internal One thread of a parallel build. */
+struct Parallel_worker
+{
+    /** The thread handle. */
+    pthread_t thread;
+    /** The shared build. */
+    struct Parallel_build *build;
+    /** The index of this worker among the threads. */
+    size_t id;
+    /** True if the thread was started and must be joined. */
+    CCC_Tribool started;
 };
 
 /*=======================   Data Alignment Test   ===========================*/
@@ -253,6 +386,26 @@ arithmetic and difference calculations. */
 static_assert((offsetof(struct Fixed_map_test_type, tag) % GROUP_COUNT) == 0,
               "The tag array starts at an aligned group size byte boundary "
               "within the struct.");
+/** @internal The stored hash variant of a fixed map must place the hash array
+on the exact next byte after the replica group, where runtime code will look
+for it. This holds for any data type because the tag array begins on a group
+boundary and its length, with the replica group, is a multiple of 8. */
+struct Fixed_map_stored_hash_test_type
+{
+    struct
+    {
+        char const c;
+    } const data[GROUP_COUNT + 1];
+    alignas(GROUP_COUNT) struct CCC_Flat_hash_map_tag const
+        tag[GROUP_COUNT + GROUP_COUNT];
+    uint64_t const hash[GROUP_COUNT];
+};
+static_assert(offsetof(struct Fixed_map_stored_hash_test_type, hash)
+                  == offsetof(struct Fixed_map_stored_hash_test_type, tag)
+                         + (sizeof(struct CCC_Flat_hash_map_tag)
+                            * (GROUP_COUNT + GROUP_COUNT)),
+              "The stored hash array must start on the byte following the "
+              "replica group of the tag array.");
 
 /*=======================    Special Constants    ===========================*/
 
@@ -289,6 +442,25 @@ static_assert(
 static_assert(
     (TAG_DELETED ^ TAG_EMPTY) == 0x7F,
     "only empty should have lsb on and 7 bits are available for hash");
+static_assert((uint8_t)TAG_DELETED
+                      == (uint8_t)CCC_PRIVATE_FLAT_HASH_MAP_TAG_DELETED
+                  && (uint8_t)TAG_EMPTY
+                         == (uint8_t)CCC_PRIVATE_FLAT_HASH_MAP_TAG_EMPTY,
+              "specialized probes in the header must agree on constant tags.");
+
+/** @internal Constants identifying a snapshot. The magic number spells
+CCCFHMS1 when read in the byte order that wrote it, so a snapshot from a machine
+of the other byte order is rejected. */
+enum : uint64_t
+{
+    SNAPSHOT_MAGIC = 0x31534D4846434343,
+    SNAPSHOT_VERSION = 1,
+    SNAPSHOT_ALIGN = sizeof(struct CCC_Flat_hash_map_snapshot_header),
+};
+static_assert(SNAPSHOT_ALIGN % GROUP_COUNT == 0,
+              "a snapshot table must start aligned for group loads.");
+static_assert(SNAPSHOT_ALIGN % alignof(max_align_t) == 0,
+              "a snapshot table must start aligned for any user type.");
 
 /*=======================    Type Declarations    ===========================*/
 
@@ -320,6 +492,10 @@ struct Query
 static void swap(void *, void *, void *, size_t);
 static struct CCC_Flat_hash_map_entry
 container_entry(struct CCC_Flat_hash_map *, void const *);
+static CCC_Entry remove_with_hash(struct CCC_Flat_hash_map *, void *,
+                                  uint64_t);
+static CCC_Entry try_insert_with_hash(struct CCC_Flat_hash_map *, void const *,
+                                      uint64_t);
 static struct Query find(struct CCC_Flat_hash_map *, void const *, uint64_t);
 static struct Query find_key_or_slot(struct CCC_Flat_hash_map const *,
                                      void const *, uint64_t);
@@ -329,62 +505,118 @@ static size_t find_slot_or_noreturn(struct CCC_Flat_hash_map const *, uint64_t);
 static void *find_first_full_slot(struct CCC_Flat_hash_map const *, size_t);
 static struct Match_mask find_first_full_group(struct CCC_Flat_hash_map const *,
                                                size_t *);
+static void retain_groups(struct CCC_Flat_hash_map *, CCC_Type_predicate *,
+                          void *);
+static void visit_groups(struct CCC_Flat_hash_map *, size_t, size_t,
+                         CCC_Type_modifier *, void *);
 static CCC_Result maybe_rehash(struct CCC_Flat_hash_map *, size_t,
                                CCC_Allocator);
-static void insert_and_copy(struct CCC_Flat_hash_map *, void const *,
-                            struct CCC_Flat_hash_map_tag, size_t);
+static void insert_and_copy(struct CCC_Flat_hash_map *, void const *, uint64_t,
+                            size_t);
 static void erase(struct CCC_Flat_hash_map *, size_t);
 static CCC_Result check_initialize(struct CCC_Flat_hash_map *, size_t,
                                    CCC_Allocator *);
 static void rehash_in_place(struct CCC_Flat_hash_map *);
-static CCC_Tribool is_same_group(size_t, size_t, uint64_t, size_t);
+static CCC_Tribool is_same_group(size_t, size_t, uint64_t, size_t,
+                                 size_t);
 static CCC_Result rehash_resize(struct CCC_Flat_hash_map *, size_t,
                                 CCC_Allocator);
+static CCC_Result rehash_to(struct CCC_Flat_hash_map *, size_t,
+                            CCC_Allocator *);
+static size_t fit_capacity(size_t, size_t);
+static void compact(struct CCC_Flat_hash_map *);
+static void maybe_shrink(struct CCC_Flat_hash_map *);
 static CCC_Tribool is_equal(struct CCC_Flat_hash_map const *, void const *,
-                            size_t);
+                            uint64_t, size_t);
 static uint64_t hasher(struct CCC_Flat_hash_map const *, void const *);
+static uint64_t finish_hash(struct CCC_Flat_hash_map const *, uint64_t);
 static void *key_at(struct CCC_Flat_hash_map const *, size_t);
 static void *data_at(struct CCC_Flat_hash_map const *, size_t);
-static struct CCC_Flat_hash_map_tag *tag_pos(size_t, void const *, size_t);
+static struct CCC_Flat_hash_map_tag *tag_pos(size_t, void const *, size_t,
+                                             size_t);
 static void *key_in_slot(struct CCC_Flat_hash_map const *, void const *);
 static void *swap_slot(struct CCC_Flat_hash_map const *);
 static CCC_Count data_index(struct CCC_Flat_hash_map const *, void const *);
-static size_t mask_to_total_bytes(size_t, size_t);
-static size_t mask_to_tag_bytes(size_t);
-static size_t mask_to_data_bytes(size_t, size_t);
-static void set_insert_tag(struct CCC_Flat_hash_map *,
-                           struct CCC_Flat_hash_map_tag, size_t);
+static size_t mask_to_total_bytes(size_t, size_t,
+                                  enum CCC_Flat_hash_map_option, size_t);
+static size_t mask_to_tag_bytes(size_t, size_t);
+static size_t mask_to_data_bytes(size_t, size_t, size_t);
+static size_t mask_to_hash_bytes(size_t, enum CCC_Flat_hash_map_option);
+static uint64_t *hash_array(struct CCC_Flat_hash_map const *);
+static uint64_t slot_hash(struct CCC_Flat_hash_map const *, size_t);
+static void hash_set(struct CCC_Flat_hash_map *, uint64_t, size_t);
+static void hash_swap(struct CCC_Flat_hash_map *, size_t, size_t);
+static void set_insert_tag(struct CCC_Flat_hash_map *, uint64_t, size_t);
 static size_t mask_to_load_factor_cap(size_t);
 static size_t max(size_t, size_t);
+static size_t min(size_t, size_t);
+static void hash_and_prefetch(struct CCC_Flat_hash_map const *,
+                              void const *const[], size_t, size_t, uint64_t *);
+static CCC_Result reserve_batch(struct CCC_Flat_hash_map *, size_t);
+static size_t grow_total_bytes(struct CCC_Flat_hash_map const *, size_t,
+                               size_t *);
+static CCC_Result begin_incremental_resize(struct CCC_Flat_hash_map *, size_t);
+static CCC_Tribool is_migrating(struct CCC_Flat_hash_map const *);
+static struct CCC_Flat_hash_map
+migration_view(struct CCC_Flat_hash_map const *);
+static void migrate_groups(struct CCC_Flat_hash_map *, size_t);
+static size_t migrate_slot(struct CCC_Flat_hash_map *,
+                           struct CCC_Flat_hash_map *, size_t, uint64_t);
+static CCC_Count migrate_key(struct CCC_Flat_hash_map *, void const *,
+                             uint64_t);
+static void free_migration(struct CCC_Flat_hash_map *);
+static void *find_in_tables(struct CCC_Flat_hash_map const *, void const *,
+                            uint64_t);
+static void *next_full_slot(struct CCC_Flat_hash_map const *, size_t);
+static void copy_full_slots(struct CCC_Flat_hash_map *,
+                            struct CCC_Flat_hash_map const *);
+static CCC_Tribool validate_migration(struct CCC_Flat_hash_map const *);
+static CCC_Result reserve_parallel(struct CCC_Flat_hash_map *, size_t,
+                                   CCC_Allocator *, size_t);
+static CCC_Result parallel_build(struct Parallel_build *, CCC_Allocator *);
+static void *parallel_work(void *);
+static void parallel_source_range(struct Parallel_build const *, size_t,
+                                  size_t *, size_t *);
+static void const *parallel_source_type(struct Parallel_build const *, size_t);
+static CCC_Tribool parallel_place(struct Parallel_build *, size_t, size_t);
+static void stats_scan(struct CCC_Flat_hash_map const *, size_t,
+                       CCC_Flat_hash_map_stats *);
+static void stats_probe(struct CCC_Flat_hash_map const *, size_t,
+                        CCC_Flat_hash_map_stats *);
+static size_t match_count(struct Match_mask);
 static void tag_set(struct CCC_Flat_hash_map *, struct CCC_Flat_hash_map_tag,
                     size_t);
 static CCC_Tribool match_has_one(struct Match_mask);
 static size_t match_trailing_one(struct Match_mask);
-static size_t match_leading_zeros(struct Match_mask);
+static size_t match_leading_zeros(struct Match_mask, size_t);
 static size_t match_trailing_zeros(struct Match_mask);
 static size_t match_next_one(struct Match_mask *);
 static CCC_Tribool tag_full(struct CCC_Flat_hash_map_tag);
 static CCC_Tribool tag_constant(struct CCC_Flat_hash_map_tag);
 static struct CCC_Flat_hash_map_tag tag_from(uint64_t);
-static struct Group group_load_unaligned(struct CCC_Flat_hash_map_tag const *);
-static struct Group group_load_aligned(struct CCC_Flat_hash_map_tag const *);
-static void group_store_aligned(struct CCC_Flat_hash_map_tag *, struct Group);
+static struct Group group_load_unaligned(struct CCC_Flat_hash_map_tag const *,
+                                         size_t);
+static struct Group group_load_aligned(struct CCC_Flat_hash_map_tag const *,
+                                       size_t);
 static struct Match_mask match_tag(struct Group, struct CCC_Flat_hash_map_tag);
 static struct Match_mask match_empty(struct Group);
 static struct Match_mask match_deleted(struct Group);
 static struct Match_mask match_empty_deleted(struct Group);
 static struct Match_mask match_full(struct Group);
 static struct Match_mask match_leading_full(struct Group, size_t);
-static struct Group group_constant_to_empty_full_to_deleted(struct Group);
+static void group_constant_to_empty_full_to_deleted(
+    struct CCC_Flat_hash_map_tag *, size_t);
 static unsigned count_trailing_zeros(struct Match_mask);
-static unsigned count_leading_zeros(struct Match_mask);
+static unsigned count_leading_zeros(struct Match_mask, size_t);
+static size_t widest_group_count(void);
+static CCC_Tribool group_count_supported(size_t);
 static unsigned count_leading_zeros_size_t(size_t);
 static size_t next_power_of_two(size_t);
 static CCC_Tribool is_power_of_two(size_t);
 static size_t to_power_of_two(size_t);
 static CCC_Tribool is_uninitialized(struct CCC_Flat_hash_map const *);
 static void destory_each(struct CCC_Flat_hash_map *, CCC_Type_destructor *);
-static size_t roundup(size_t);
+static size_t roundup(size_t, size_t);
 static CCC_Tribool check_replica_group(struct CCC_Flat_hash_map const *);
 
 /*===========================    Interface   ================================*/
@@ -431,7 +663,7 @@ CCC_flat_hash_map_contains(CCC_Flat_hash_map const *const map,
     {
         return CCC_FALSE;
     }
-    return !find_key_or_fail(map, key, hasher(map, key)).error;
+    return find_in_tables(map, key, hasher(map, key)) != NULL;
 }
 
 void *
@@ -442,12 +674,121 @@ CCC_flat_hash_map_get_key_value(CCC_Flat_hash_map const *const map,
     {
         return NULL;
     }
-    CCC_Count const i = find_key_or_fail(map, key, hasher(map, key));
-    if (i.error)
+    return find_in_tables(map, key, hasher(map, key));
+}
+
+CCC_Count
+CCC_flat_hash_map_get_key_value_batch(CCC_Flat_hash_map const *const map,
+                                      void const *const keys[], size_t const n,
+                                      void *type_outputs[])
+{
+    if (unlikely(!map || (n && (!keys || !type_outputs))))
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    if (unlikely(is_uninitialized(map) || !map->count))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            type_outputs[i] = NULL;
+        }
+        return (CCC_Count){.count = 0};
+    }
+    size_t found = 0;
+    uint64_t hashes[BATCH_PREFETCH_COUNT];
+    for (size_t base = 0; base < n; base += BATCH_PREFETCH_COUNT)
+    {
+        size_t const chunk = min(n - base, BATCH_PREFETCH_COUNT);
+        hash_and_prefetch(map, &keys[base], chunk, 0, hashes);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            type_outputs[base + i]
+                = find_in_tables(map, keys[base + i], hashes[i]);
+            found += type_outputs[base + i] != NULL;
+        }
+    }
+    return (CCC_Count){.count = found};
+}
+
+uint64_t
+CCC_flat_hash_map_hash(CCC_Flat_hash_map const *const map,
+                       void const *const key)
+{
+    if (unlikely(!map || !key))
+    {
+        return 0;
+    }
+    return map->hash((CCC_Key_context){
+        .key = key,
+        .context = map->context,
+    });
+}
+
+CCC_Tribool
+CCC_flat_hash_map_contains_with_hash(CCC_Flat_hash_map const *const map,
+                                     void const *const key, uint64_t const hash)
+{
+    if (unlikely(!map || !key))
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    if (unlikely(is_uninitialized(map) || !map->count))
+    {
+        return CCC_FALSE;
+    }
+    return find_in_tables(map, key, finish_hash(map, hash)) != NULL;
+}
+
+void *
+CCC_flat_hash_map_get_key_value_with_hash(CCC_Flat_hash_map const *const map,
+                                          void const *const key,
+                                          uint64_t const hash)
+{
+    if (unlikely(!map || !key || is_uninitialized(map) || !map->count))
     {
         return NULL;
     }
-    return data_at(map, i.count);
+    return find_in_tables(map, key, finish_hash(map, hash));
+}
+
+CCC_Flat_hash_map_entry
+CCC_flat_hash_map_entry_with_hash(CCC_Flat_hash_map *const map,
+                                  void const *const key, uint64_t const hash)
+{
+    if (unlikely(!map || !key))
+    {
+        return (CCC_Flat_hash_map_entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    return (CCC_Flat_hash_map_entry){CCC_private_flat_hash_map_entry_with_hash(
+        map, key, finish_hash(map, hash))};
+}
+
+CCC_Entry
+CCC_flat_hash_map_try_insert_with_hash(CCC_Flat_hash_map *const map,
+                                       void const *const type,
+                                       uint64_t const hash)
+{
+    if (unlikely(!map || !type))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    return try_insert_with_hash(map, type, finish_hash(map, hash));
+}
+
+CCC_Entry
+CCC_flat_hash_map_remove_key_value_with_hash(CCC_Flat_hash_map *const map,
+                                             void *const type_output,
+                                             uint64_t const hash)
+{
+    if (unlikely(!map || !type_output))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (unlikely(is_uninitialized(map) || !map->count))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    return remove_with_hash(map, type_output, finish_hash(map, hash));
 }
 
 CCC_Flat_hash_map_entry
@@ -476,7 +817,7 @@ CCC_flat_hash_map_or_insert(CCC_Flat_hash_map_entry const *const e,
     {
         return NULL;
     }
-    insert_and_copy(e->private.map, type, e->private.tag, e->private.index);
+    insert_and_copy(e->private.map, type, e->private.hash, e->private.index);
     return data_at(e->private.map, e->private.index);
 }
 
@@ -488,18 +829,170 @@ CCC_flat_hash_map_insert_entry(CCC_Flat_hash_map_entry const *const e,
     {
         return NULL;
     }
+    if (e->private.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        return NULL;
+    }
     if (e->private.status & CCC_ENTRY_OCCUPIED)
     {
         void *const slot = data_at(e->private.map, e->private.index);
         (void)memcpy(slot, type, e->private.map->sizeof_type);
         return slot;
     }
-    if (e->private.status & CCC_ENTRY_INSERT_ERROR)
+    insert_and_copy(e->private.map, type, e->private.hash, e->private.index);
+    return data_at(e->private.map, e->private.index);
+}
+
+CCC_Count
+CCC_flat_hash_map_or_insert_batch(CCC_Flat_hash_map *const map,
+                                  void const *const types[], size_t const n,
+                                  void *type_outputs[])
+{
+    if (unlikely(!map || (n && (!types || !type_outputs))))
     {
-        return NULL;
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
     }
-    insert_and_copy(e->private.map, type, e->private.tag, e->private.index);
-    return data_at(e->private.map, e->private.index);
+    if (!n)
+    {
+        return (CCC_Count){.count = 0};
+    }
+    /* A rehash moves elements so all space is claimed before the first
+       reference is written to the output. If not enough space is available
+       the batch continues with what remains and reports failures as NULL. */
+    CCC_Result const res = reserve_batch(map, n);
+    if (unlikely(is_uninitialized(map) || map->read_only))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            type_outputs[i] = NULL;
+        }
+        return (CCC_Count){.error = res};
+    }
+    /* Probing for insertion only considers the current table. */
+    migrate_groups(map, SIZE_MAX);
+    size_t inserted = 0;
+    uint64_t hashes[BATCH_PREFETCH_COUNT];
+    for (size_t base = 0; base < n; base += BATCH_PREFETCH_COUNT)
+    {
+        size_t const chunk = min(n - base, BATCH_PREFETCH_COUNT);
+        hash_and_prefetch(map, &types[base], chunk, map->key_offset, hashes);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            void const *const type = types[base + i];
+            struct Query const q
+                = find_key_or_slot(map, key_in_slot(map, type), hashes[i]);
+            if (q.status == CCC_ENTRY_OCCUPIED)
+            {
+                type_outputs[base + i] = data_at(map, q.index);
+                continue;
+            }
+            /* Reusing a deleted slot does not consume the remaining empties
+               so it is always allowed without a rehash. */
+            if (!map->remain && map->tag[q.index].v == TAG_EMPTY)
+            {
+                type_outputs[base + i] = NULL;
+                continue;
+            }
+            insert_and_copy(map, type, hashes[i], q.index);
+            type_outputs[base + i] = data_at(map, q.index);
+            ++inserted;
+        }
+    }
+    return (CCC_Count){.count = inserted};
+}
+
+CCC_Result
+CCC_flat_hash_map_extend(CCC_Flat_hash_map *const map,
+                         CCC_Buffer const *const buffer,
+                         CCC_Tribool const keys_unique)
+{
+    if (unlikely(!map || !buffer || keys_unique == CCC_TRIBOOL_ERROR
+                 || (buffer->count
+                     && (!buffer->data
+                         || buffer->sizeof_type != map->sizeof_type))))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    size_t const n = buffer->count;
+    if (!n)
+    {
+        return CCC_RESULT_OK;
+    }
+    CCC_Result const res = reserve_batch(map, n);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    /* Probing for insertion only considers the current table. */
+    migrate_groups(map, SIZE_MAX);
+    char const *const types = buffer->data;
+    void const *chunk_types[BATCH_PREFETCH_COUNT];
+    uint64_t hashes[BATCH_PREFETCH_COUNT];
+    for (size_t base = 0; base < n; base += BATCH_PREFETCH_COUNT)
+    {
+        size_t const chunk = min(n - base, BATCH_PREFETCH_COUNT);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            chunk_types[i] = types + ((base + i) * map->sizeof_type);
+        }
+        hash_and_prefetch(map, chunk_types, chunk, map->key_offset, hashes);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            if (keys_unique)
+            {
+                insert_and_copy(map, chunk_types[i], hashes[i],
+                                find_slot_or_noreturn(map, hashes[i]));
+                continue;
+            }
+            struct Query const q = find_key_or_slot(
+                map, key_in_slot(map, chunk_types[i]), hashes[i]);
+            if (q.status == CCC_ENTRY_OCCUPIED)
+            {
+                (void)memcpy(data_at(map, q.index), chunk_types[i],
+                             map->sizeof_type);
+                continue;
+            }
+            insert_and_copy(map, chunk_types[i], hashes[i], q.index);
+        }
+    }
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_flat_hash_map_extend_parallel(CCC_Flat_hash_map *const map,
+                                  CCC_Buffer const *const buffer,
+                                  CCC_Tribool const keys_unique,
+                                  size_t const threads)
+{
+    if (unlikely(!map || !buffer || keys_unique == CCC_TRIBOOL_ERROR
+                 || (buffer->count
+                     && (!buffer->data
+                         || buffer->sizeof_type != map->sizeof_type))))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (threads <= 1 || !map->allocate)
+    {
+        return CCC_flat_hash_map_extend(map, buffer, keys_unique);
+    }
+    size_t const n = buffer->count;
+    if (!n)
+    {
+        return CCC_RESULT_OK;
+    }
+    CCC_Result const res = reserve_parallel(map, n, map->allocate, threads);
+    if (res != CCC_RESULT_OK)
+    {
+        return res;
+    }
+    struct Parallel_build build = {
+        .map = map,
+        .types = buffer->data,
+        .source_count = n,
+        .keys_unique = keys_unique,
+        .threads = threads,
+    };
+    return parallel_build(&build, map->allocate);
 }
 
 CCC_Entry
@@ -513,7 +1006,12 @@ CCC_flat_hash_map_remove_entry(CCC_Flat_hash_map_entry const *const e)
     {
         return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
     }
+    if (unlikely(e->private.map->read_only))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
     erase(e->private.map, e->private.index);
+    maybe_shrink(e->private.map);
     return (CCC_Entry){{.status = CCC_ENTRY_OCCUPIED}};
 }
 
@@ -521,7 +1019,8 @@ CCC_Flat_hash_map_entry *
 CCC_flat_hash_map_and_modify(CCC_Flat_hash_map_entry *const entry,
                              CCC_Type_modifier *const modify)
 {
-    if (entry && modify && (entry->private.status & CCC_ENTRY_OCCUPIED) != 0)
+    if (entry && modify && (entry->private.status & CCC_ENTRY_OCCUPIED) != 0
+        && !entry->private.map->read_only)
     {
         modify((CCC_Type_context){
             .type = data_at(entry->private.map, entry->private.index),
@@ -536,7 +1035,8 @@ CCC_flat_hash_map_and_modify_context(CCC_Flat_hash_map_entry *const entry,
                                      CCC_Type_modifier *const modify,
                                      void *const context)
 {
-    if (entry && modify && (entry->private.status & CCC_ENTRY_OCCUPIED) != 0)
+    if (entry && modify && (entry->private.status & CCC_ENTRY_OCCUPIED) != 0
+        && !entry->private.map->read_only)
     {
         modify((CCC_Type_context){
             .type = data_at(entry->private.map, entry->private.index),
@@ -556,6 +1056,10 @@ CCC_flat_hash_map_swap_entry(CCC_Flat_hash_map *const map,
     }
     void *const key = key_in_slot(map, type_output);
     struct CCC_Flat_hash_map_entry ent = container_entry(map, key);
+    if (ent.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
     if (ent.status & CCC_ENTRY_OCCUPIED)
     {
         swap(swap_slot(map), data_at(map, ent.index), type_output,
@@ -565,11 +1069,7 @@ CCC_flat_hash_map_swap_entry(CCC_Flat_hash_map *const map,
             .status = CCC_ENTRY_OCCUPIED,
         }};
     }
-    if (ent.status & CCC_ENTRY_INSERT_ERROR)
-    {
-        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
-    }
-    insert_and_copy(ent.map, type_output, ent.tag, ent.index);
+    insert_and_copy(ent.map, type_output, ent.hash, ent.index);
     return (CCC_Entry){{
         .type = data_at(map, ent.index),
         .status = CCC_ENTRY_VACANT,
@@ -584,24 +1084,7 @@ CCC_flat_hash_map_try_insert(CCC_Flat_hash_map *const map,
     {
         return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    void *const key = key_in_slot(map, type);
-    struct CCC_Flat_hash_map_entry ent = container_entry(map, key);
-    if (ent.status & CCC_ENTRY_OCCUPIED)
-    {
-        return (CCC_Entry){{
-            .type = data_at(map, ent.index),
-            .status = CCC_ENTRY_OCCUPIED,
-        }};
-    }
-    if (ent.status & CCC_ENTRY_INSERT_ERROR)
-    {
-        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
-    }
-    insert_and_copy(ent.map, type, ent.tag, ent.index);
-    return (CCC_Entry){{
-        .type = data_at(map, ent.index),
-        .status = CCC_ENTRY_VACANT,
-    }};
+    return try_insert_with_hash(map, type, hasher(map, key_in_slot(map, type)));
 }
 
 CCC_Entry
@@ -614,6 +1097,10 @@ CCC_flat_hash_map_insert_or_assign(CCC_Flat_hash_map *const map,
     }
     void *const key = key_in_slot(map, type);
     struct CCC_Flat_hash_map_entry ent = container_entry(map, key);
+    if (ent.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
     if (ent.status & CCC_ENTRY_OCCUPIED)
     {
         (void)memcpy(data_at(map, ent.index), type, map->sizeof_type);
@@ -622,11 +1109,7 @@ CCC_flat_hash_map_insert_or_assign(CCC_Flat_hash_map *const map,
             .status = CCC_ENTRY_OCCUPIED,
         }};
     }
-    if (ent.status & CCC_ENTRY_INSERT_ERROR)
-    {
-        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
-    }
-    insert_and_copy(ent.map, type, ent.tag, ent.index);
+    insert_and_copy(ent.map, type, ent.hash, ent.index);
     return (CCC_Entry){{
         .type = data_at(map, ent.index),
         .status = CCC_ENTRY_VACANT,
@@ -645,18 +1128,8 @@ CCC_flat_hash_map_remove_key_value(CCC_Flat_hash_map *const map,
     {
         return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
     }
-    void *const key = key_in_slot(map, type_output);
-    CCC_Count const index = find_key_or_fail(map, key, hasher(map, key));
-    if (index.error)
-    {
-        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
-    }
-    (void)memcpy(type_output, data_at(map, index.count), map->sizeof_type);
-    erase(map, index.count);
-    return (CCC_Entry){{
-        .type = type_output,
-        .status = CCC_ENTRY_OCCUPIED,
-    }};
+    return remove_with_hash(map, type_output,
+                            hasher(map, key_in_slot(map, type_output)));
 }
 
 void *
@@ -666,7 +1139,13 @@ CCC_flat_hash_map_begin(CCC_Flat_hash_map const *const map)
     {
         return NULL;
     }
-    return find_first_full_slot(map, 0);
+    void *const first = find_first_full_slot(map, 0);
+    if (first || !is_migrating(map))
+    {
+        return first;
+    }
+    struct CCC_Flat_hash_map const previous = migration_view(map);
+    return find_first_full_slot(&previous, 0);
 }
 
 void *
@@ -678,22 +1157,30 @@ CCC_flat_hash_map_next(CCC_Flat_hash_map const *const map,
     {
         return NULL;
     }
-    CCC_Count i = data_index(map, type_iterator);
-    if (i.error)
+    /* The current table is visited first and then the previous table if an
+       incremental resize is in progress. */
+    CCC_Count const i = data_index(map, type_iterator);
+    if (!i.error)
+    {
+        void *const next = next_full_slot(map, i.count);
+        if (next || !is_migrating(map))
+        {
+            return next;
+        }
+        struct CCC_Flat_hash_map const previous = migration_view(map);
+        return find_first_full_slot(&previous, 0);
+    }
+    if (!is_migrating(map))
     {
         return NULL;
     }
-    size_t const aligned_group_start
-        = i.count & ~((typeof(i.count))(GROUP_COUNT - 1));
-    struct Match_mask m
-        = match_leading_full(group_load_aligned(&map->tag[aligned_group_start]),
-                             i.count & (GROUP_COUNT - 1));
-    size_t const bit = match_next_one(&m);
-    if (bit != GROUP_COUNT)
+    struct CCC_Flat_hash_map const previous = migration_view(map);
+    CCC_Count const previous_i = data_index(&previous, type_iterator);
+    if (previous_i.error)
     {
-        return data_at(map, aligned_group_start + bit);
+        return NULL;
     }
-    return find_first_full_slot(map, aligned_group_start + GROUP_COUNT);
+    return next_full_slot(&previous, previous_i.count);
 }
 
 void *
@@ -702,47 +1189,118 @@ CCC_flat_hash_map_end(CCC_Flat_hash_map const *const)
     return NULL;
 }
 
-void *
-CCC_flat_hash_map_unwrap(CCC_Flat_hash_map_entry const *const e)
-{
-    if (unlikely(!e) || !(e->private.status & CCC_ENTRY_OCCUPIED))
-    {
-        return NULL;
-    }
-    return data_at(e->private.map, e->private.index);
-}
-
-CCC_Result
-CCC_flat_hash_map_clear(CCC_Flat_hash_map *const map,
-                        CCC_Type_destructor *const destroy)
+CCC_Count
+CCC_flat_hash_map_group_count(CCC_Flat_hash_map const *const map)
 {
     if (unlikely(!map))
     {
-        return CCC_RESULT_ARGUMENT_ERROR;
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
     }
-    if (unlikely(is_uninitialized(map) || !map->mask || !map->tag))
+    if (unlikely(is_uninitialized(map) || !map->mask))
     {
-        return CCC_RESULT_OK;
+        return (CCC_Count){.count = 0};
     }
-    if (!destroy)
+    size_t groups = (map->mask + 1) / map->group_count;
+    if (is_migrating(map))
     {
-        (void)memset(map->tag, TAG_EMPTY, mask_to_tag_bytes(map->mask));
-        map->remain = mask_to_load_factor_cap(map->mask);
-        map->count = 0;
-        return CCC_RESULT_OK;
+        groups += (map->migration.mask + 1) / map->group_count;
     }
-    destory_each(map, destroy);
-    (void)memset(map->tag, TAG_EMPTY, mask_to_tag_bytes(map->mask));
-    map->remain = mask_to_load_factor_cap(map->mask);
-    map->count = 0;
-    return CCC_RESULT_OK;
+    return (CCC_Count){.count = groups};
 }
 
 CCC_Result
-CCC_flat_hash_map_clear_and_free(CCC_Flat_hash_map *const map,
-                                 CCC_Type_destructor *const destroy)
-{
-    if (unlikely(!map || !map->data || !map->mask || is_uninitialized(map)))
+CCC_flat_hash_map_for_each_range(CCC_Flat_hash_map *const map,
+                                 size_t const start_group,
+                                 size_t const end_group,
+                                 CCC_Type_modifier *const modify,
+                                 void *const context)
+{
+    CCC_Count const groups = CCC_flat_hash_map_group_count(map);
+    if (unlikely(groups.error || !modify || start_group > end_group
+                 || end_group > groups.count || map->read_only))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    /* Groups past the current table name the groups of the previous table of
+       an incremental resize. Its moved slots are deleted and skipped. */
+    size_t const current
+        = groups.count ? (map->mask + 1) / map->group_count : 0;
+    visit_groups(map, min(start_group, current), min(end_group, current),
+                 modify, context);
+    if (end_group > current)
+    {
+        struct CCC_Flat_hash_map previous = migration_view(map);
+        visit_groups(&previous, max(start_group, current) - current,
+                     end_group - current, modify, context);
+    }
+    return CCC_RESULT_OK;
+}
+
+CCC_Count
+CCC_flat_hash_map_retain(CCC_Flat_hash_map *const map,
+                         CCC_Type_predicate *const keep, void *const context)
+{
+    if (unlikely(!map || !keep || map->read_only))
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    if (unlikely(is_uninitialized(map) || !map->mask || !map->count))
+    {
+        return (CCC_Count){.count = 0};
+    }
+    migrate_groups(map, SIZE_MAX);
+    size_t const before = map->count;
+    retain_groups(map, keep, context);
+    maybe_shrink(map);
+    return (CCC_Count){.count = before - map->count};
+}
+
+void *
+CCC_flat_hash_map_unwrap(CCC_Flat_hash_map_entry const *const e)
+{
+    if (unlikely(!e) || !(e->private.status & CCC_ENTRY_OCCUPIED))
+    {
+        return NULL;
+    }
+    return data_at(e->private.map, e->private.index);
+}
+
+CCC_Result
+CCC_flat_hash_map_clear(CCC_Flat_hash_map *const map,
+                        CCC_Type_destructor *const destroy)
+{
+    if (unlikely(!map || map->read_only))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (unlikely(is_uninitialized(map) || !map->mask || !map->tag))
+    {
+        return CCC_RESULT_OK;
+    }
+    if (!destroy)
+    {
+        free_migration(map);
+        (void)memset(map->tag, TAG_EMPTY,
+                     mask_to_tag_bytes(map->mask, map->group_count));
+        map->remain = mask_to_load_factor_cap(map->mask);
+        map->count = 0;
+        return CCC_RESULT_OK;
+    }
+    destory_each(map, destroy);
+    free_migration(map);
+    (void)memset(map->tag, TAG_EMPTY,
+                 mask_to_tag_bytes(map->mask, map->group_count));
+    map->remain = mask_to_load_factor_cap(map->mask);
+    map->count = 0;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_flat_hash_map_clear_and_free(CCC_Flat_hash_map *const map,
+                                 CCC_Type_destructor *const destroy)
+{
+    if (unlikely(!map || !map->data || !map->mask || is_uninitialized(map)
+                 || map->read_only))
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
@@ -755,6 +1313,9 @@ CCC_flat_hash_map_clear_and_free(CCC_Flat_hash_map *const map,
     {
         destory_each(map, destroy);
     }
+    free_migration(map);
+    size_t const old_bytes = mask_to_total_bytes(
+        map->sizeof_type, map->mask, map->options, map->group_count);
     map->remain = 0;
     map->mask = 0;
     map->count = 0;
@@ -763,6 +1324,7 @@ CCC_flat_hash_map_clear_and_free(CCC_Flat_hash_map *const map,
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     return CCC_RESULT_OK;
@@ -774,7 +1336,8 @@ CCC_flat_hash_map_clear_and_free_reserve(CCC_Flat_hash_map *const map,
                                          CCC_Allocator *const allocate)
 {
     if (unlikely(!map || !map->data || is_uninitialized(map) || !map->mask
-                 || (map->allocate && map->allocate != allocate)))
+                 || (map->allocate && map->allocate != allocate)
+                 || map->read_only))
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
@@ -787,6 +1350,9 @@ CCC_flat_hash_map_clear_and_free_reserve(CCC_Flat_hash_map *const map,
     {
         destory_each(map, destroy);
     }
+    free_migration(map);
+    size_t const old_bytes = mask_to_total_bytes(
+        map->sizeof_type, map->mask, map->options, map->group_count);
     map->remain = 0;
     map->mask = 0;
     map->count = 0;
@@ -795,6 +1361,7 @@ CCC_flat_hash_map_clear_and_free_reserve(CCC_Flat_hash_map *const map,
         .input = map->data,
         .bytes = 0,
         .context = map->context,
+        .old_bytes = old_bytes,
     });
     map->data = NULL;
     return CCC_RESULT_OK;
@@ -836,6 +1403,7 @@ CCC_flat_hash_map_copy(CCC_Flat_hash_map *const destination,
                        CCC_Allocator *const allocate)
 {
     if (!destination || !source || source == destination
+        || destination->read_only
         || (source->mask && !is_power_of_two(source->mask + 1)))
     {
         return CCC_RESULT_ARGUMENT_ERROR;
@@ -854,51 +1422,43 @@ CCC_flat_hash_map_copy(CCC_Flat_hash_map *const destination,
         return CCC_RESULT_OK;
     }
     size_t const source_bytes
-        = mask_to_total_bytes(source->sizeof_type, source->mask);
+        = mask_to_total_bytes(source->sizeof_type, source->mask,
+                              destination->options, destination->group_count);
     if (destination->mask < source->mask)
     {
         void *const new_data = destination->allocate((CCC_Allocator_context){
             .input = destination->data,
             .bytes = source_bytes,
             .context = destination->context,
+            .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+            .old_bytes = mask_to_total_bytes(
+                destination->sizeof_type, destination->mask,
+                destination->options, destination->group_count),
         });
         if (!new_data)
         {
             return CCC_RESULT_ALLOCATOR_ERROR;
         }
         destination->data = new_data;
-        destination->tag = tag_pos(source->sizeof_type, new_data, source->mask);
+        destination->tag = tag_pos(source->sizeof_type, new_data, source->mask,
+                                   destination->group_count);
         destination->mask = source->mask;
     }
     if (!destination->data || !source->data)
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
-    (void)memset(destination->tag, TAG_EMPTY,
-                 mask_to_tag_bytes(destination->mask));
+    free_migration(destination);
+    (void)memset(
+        destination->tag, TAG_EMPTY,
+        mask_to_tag_bytes(destination->mask, destination->group_count));
     destination->remain = mask_to_load_factor_cap(destination->mask);
     destination->count = 0;
+    copy_full_slots(destination, source);
+    if (is_migrating(source))
     {
-        size_t group_start = 0;
-        struct Match_mask full = {};
-        while ((full = find_first_full_group(source, &group_start)).v)
-        {
-            {
-                size_t tag_i = 0;
-                while ((tag_i = match_next_one(&full)) != GROUP_COUNT)
-                {
-                    tag_i += group_start;
-                    uint64_t const hash = hasher(source, key_at(source, tag_i));
-                    size_t const new_i
-                        = find_slot_or_noreturn(destination, hash);
-                    tag_set(destination, tag_from(hash), new_i);
-                    (void)memcpy(data_at(destination, new_i),
-                                 data_at(source, tag_i),
-                                 destination->sizeof_type);
-                }
-            }
-            group_start += GROUP_COUNT;
-        }
+        struct CCC_Flat_hash_map const previous = migration_view(source);
+        copy_full_slots(destination, &previous);
     }
     destination->remain -= source->count;
     destination->count = source->count;
@@ -909,13 +1469,216 @@ CCC_Result
 CCC_flat_hash_map_reserve(CCC_Flat_hash_map *const map, size_t const to_add,
                           CCC_Allocator *const allocate)
 {
-    if (unlikely(!map || !to_add || !allocate))
+    if (unlikely(!map || !to_add || !allocate || map->read_only))
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
     return maybe_rehash(map, to_add, allocate);
 }
 
+CCC_Result
+CCC_flat_hash_map_reserve_parallel(CCC_Flat_hash_map *const map,
+                                   size_t const to_add,
+                                   CCC_Allocator *const allocate,
+                                   size_t const threads)
+{
+    if (unlikely(!map || !to_add || !allocate || map->read_only))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return reserve_parallel(map, to_add, allocate, threads);
+}
+
+CCC_Result
+CCC_flat_hash_map_shrink_to_fit(CCC_Flat_hash_map *const map,
+                                CCC_Allocator *const allocate)
+{
+    if (unlikely(!map || (map->allocate && map->allocate != allocate)
+                 || map->read_only))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    if (is_uninitialized(map))
+    {
+        return CCC_RESULT_OK;
+    }
+    migrate_groups(map, SIZE_MAX);
+    size_t const fit_cap = fit_capacity(map->count, map->group_count);
+    if (fit_cap >= map->mask + 1)
+    {
+        compact(map);
+        return CCC_RESULT_OK;
+    }
+    return rehash_to(map, fit_cap, allocate);
+}
+
+CCC_Result
+CCC_flat_hash_map_compact(CCC_Flat_hash_map *const map)
+{
+    if (unlikely(!map || map->read_only))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (is_uninitialized(map))
+    {
+        return CCC_RESULT_OK;
+    }
+    migrate_groups(map, SIZE_MAX);
+    compact(map);
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_flat_hash_map_auto_shrink(CCC_Flat_hash_map *const map,
+                              size_t const denominator)
+{
+    if (unlikely(!map || denominator == 1))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!map->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    map->shrink_denominator = denominator;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_flat_hash_map_snapshot(CCC_Flat_hash_map *const map, uint64_t const hash_id,
+                           CCC_Flat_hash_map_snapshot *const snapshot)
+{
+    if (unlikely(!map || !snapshot))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    migrate_groups(map, SIZE_MAX);
+    CCC_Tribool const empty = is_uninitialized(map) || !map->mask;
+    size_t const table_bytes
+        = empty ? 0
+                : mask_to_total_bytes(map->sizeof_type, map->mask,
+                                      map->options, map->group_count);
+    *snapshot = (CCC_Flat_hash_map_snapshot){
+        .header = {
+            .magic = SNAPSHOT_MAGIC,
+            .version = SNAPSHOT_VERSION,
+            .alignment = SNAPSHOT_ALIGN,
+            .group_count = map->group_count,
+            .mask = empty ? 0 : map->mask,
+            .count = empty ? 0 : map->count,
+            .remain = empty ? 0 : map->remain,
+            .sizeof_type = map->sizeof_type,
+            .key_offset = map->key_offset,
+            .options = map->options
+                     & (CCC_FLAT_HASH_MAP_OPTION_STORE_HASH
+                        | CCC_FLAT_HASH_MAP_OPTION_MIX_HASH),
+            .hash_id = hash_id,
+            .table_bytes = table_bytes,
+        },
+        .table = empty ? NULL : map->data,
+        .table_bytes = table_bytes,
+    };
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_private_flat_hash_map_load_snapshot_table(
+    struct CCC_Flat_hash_map *const map,
+    struct CCC_Flat_hash_map const prototype, uint64_t const hash_id,
+    void const *const snapshot, size_t const bytes)
+{
+    if (unlikely(!map || !snapshot || bytes < SNAPSHOT_ALIGN
+                 || (uintptr_t)snapshot % SNAPSHOT_ALIGN))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Flat_hash_map_snapshot_header const *const h = snapshot;
+    if (h->magic != SNAPSHOT_MAGIC || h->version != SNAPSHOT_VERSION
+        || h->alignment != SNAPSHOT_ALIGN
+        || !group_count_supported(h->group_count)
+        || prototype.group_count != GROUP_COUNT
+        || h->sizeof_type != prototype.sizeof_type
+        || h->key_offset != prototype.key_offset || h->hash_id != hash_id
+        || (h->options
+            & ~(uint64_t)(CCC_FLAT_HASH_MAP_OPTION_STORE_HASH
+                          | CCC_FLAT_HASH_MAP_OPTION_MIX_HASH)))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    enum CCC_Flat_hash_map_option const options = h->options;
+    /* A remaining count beyond the load factor would let insertions fill
+       every slot so that a probe for an absent key never terminates. */
+    if (h->mask
+        && ((h->mask & (h->mask + 1)) || h->mask + 1 < h->group_count
+            || h->count > mask_to_load_factor_cap(h->mask)
+            || h->remain > mask_to_load_factor_cap(h->mask) - h->count
+            || h->table_bytes
+                   != mask_to_total_bytes(h->sizeof_type, h->mask, options,
+                                          h->group_count)))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (bytes - SNAPSHOT_ALIGN < h->table_bytes)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    *map = prototype;
+    map->options = options;
+    map->allocate = NULL;
+    map->read_only = true;
+    if (!h->mask)
+    {
+        return CCC_RESULT_OK;
+    }
+    /* The memory may be mapped without write permission. The map is read
+       only so no path writes through the table despite the cast, and no
+       remaining slots are claimed so no insertion is even attempted. */
+    void *const data = (char *)snapshot + SNAPSHOT_ALIGN;
+    map->data = data;
+    map->group_count = h->group_count;
+    map->tag = tag_pos(map->sizeof_type, data, h->mask, map->group_count);
+    map->mask = h->mask;
+    map->count = h->count;
+    map->remain = 0;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_flat_hash_map_stats(CCC_Flat_hash_map const *const map,
+                        size_t const sample_groups,
+                        CCC_Flat_hash_map_stats *const stats)
+{
+    if (unlikely(!map || !stats))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    *stats = (CCC_Flat_hash_map_stats){
+        .count = map->count,
+        .bytes_used = map->count * map->sizeof_type,
+    };
+    if (is_uninitialized(map) || !map->mask)
+    {
+        return CCC_RESULT_OK;
+    }
+    stats->capacity = map->mask + 1;
+    stats->bytes_allocated = mask_to_total_bytes(
+        map->sizeof_type, map->mask, map->options, map->group_count);
+    stats_scan(map, sample_groups, stats);
+    if (is_migrating(map))
+    {
+        struct CCC_Flat_hash_map const previous = migration_view(map);
+        stats->bytes_allocated
+            += mask_to_total_bytes(map->sizeof_type, previous.mask,
+                                   previous.options, previous.group_count);
+        stats_scan(&previous, sample_groups, stats);
+    }
+    return CCC_RESULT_OK;
+}
+
 CCC_Tribool
 CCC_flat_hash_map_validate(CCC_Flat_hash_map const *const map)
 {
@@ -923,6 +1686,10 @@ CCC_flat_hash_map_validate(CCC_Flat_hash_map const *const map)
     {
         return CCC_TRIBOOL_ERROR;
     }
+    if (!group_count_supported(map->group_count))
+    {
+        return CCC_FALSE;
+    }
     /* We initialized the metadata array of 0 capacity table? Not possible. */
     if (!is_uninitialized(map) && !map->mask)
     {
@@ -971,11 +1738,19 @@ CCC_flat_hash_map_validate(CCC_Flat_hash_map const *const map)
             {
                 return CCC_FALSE;
             }
+            if ((map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+                && hash_array(map)[i] != hasher(map, key_at(map, i)))
+            {
+                return CCC_FALSE;
+            }
             ++occupied;
         }
     }
+    /* Elements still waiting in the previous table of an incremental resize
+       have room reserved for them in the current table. */
+    size_t const waiting = is_migrating(map) ? map->migration.count : 0;
     /* Do our tags agree with our manually tracked and set state? */
-    if (occupied != map->count)
+    if (occupied + waiting != map->count)
     {
         return CCC_FALSE;
     }
@@ -983,19 +1758,55 @@ CCC_flat_hash_map_validate(CCC_Flat_hash_map const *const map)
     {
         return CCC_FALSE;
     }
+    /* A map loaded from a snapshot claims no remaining slots so that nothing
+       is ever inserted into its table. */
     if (mask_to_load_factor_cap(occupied + remain + deleted) - occupied
-            - deleted
-        != map->remain)
+                - deleted - waiting
+            != map->remain
+        && !(map->read_only && !map->remain))
+    {
+        return CCC_FALSE;
+    }
+    if (is_migrating(map) && !validate_migration(map))
     {
         return CCC_FALSE;
     }
     return CCC_TRUE;
 }
 
+/** Checks that the previous table of an incremental resize holds exactly the
+elements the map expects, each with a tag matching its hash. */
+static CCC_Tribool
+validate_migration(struct CCC_Flat_hash_map const *const map)
+{
+    struct CCC_Flat_hash_map const previous = migration_view(map);
+    if (!check_replica_group(&previous))
+    {
+        return CCC_FALSE;
+    }
+    size_t occupied = 0;
+    for (size_t i = 0; i < (previous.mask + 1); ++i)
+    {
+        struct CCC_Flat_hash_map_tag const t = previous.tag[i];
+        if (!tag_full(t))
+        {
+            continue;
+        }
+        /* Groups before the next group to move must already be empty. */
+        if (i < map->migration.next
+            || tag_from(slot_hash(&previous, i)).v != t.v)
+        {
+            return CCC_FALSE;
+        }
+        ++occupied;
+    }
+    return occupied == map->migration.count;
+}
+
 static CCC_Tribool
 check_replica_group(struct CCC_Flat_hash_map const *const h)
 {
-    for (size_t original = 0, clone = (h->mask + 1); original < GROUP_COUNT;
+    for (size_t original = 0, clone = (h->mask + 1); original < h->group_count;
          ++original, ++clone)
     {
         if (h->tag[original].v != h->tag[clone].v)
@@ -1015,113 +1826,359 @@ CCC_private_flat_hash_map_entry(struct CCC_Flat_hash_map *const map,
     return container_entry(map, key);
 }
 
-void
-CCC_private_flat_hash_map_insert(struct CCC_Flat_hash_map *map,
-                                 void const *type,
-                                 struct CCC_Flat_hash_map_tag m, size_t i)
+uint64_t
+CCC_private_flat_hash_map_hash(struct CCC_Flat_hash_map const *const map,
+                               void const *const key)
 {
-    insert_and_copy(map, type, m, i);
+    return hasher(map, key);
 }
 
-void
-CCC_private_flat_hash_map_erase(struct CCC_Flat_hash_map *map, size_t i)
+struct CCC_Flat_hash_map_entry
+CCC_private_flat_hash_map_entry_with_hash(struct CCC_Flat_hash_map *const map,
+                                          void const *const key,
+                                          uint64_t const hash)
 {
-    erase(map, i);
+    struct Query const q = find(map, key, hash);
+    return (struct CCC_Flat_hash_map_entry){
+        .map = map,
+        .hash = hash,
+        .index = q.index,
+        .status = q.status,
+    };
 }
 
 void *
-CCC_private_flat_hash_map_data_at(struct CCC_Flat_hash_map const *const map,
-                                  size_t const i)
+CCC_private_flat_hash_map_find_with_hash(
+    struct CCC_Flat_hash_map const *const map, void const *const key,
+    uint64_t const hash)
 {
-    return data_at(map, i);
+    if (is_uninitialized(map))
+    {
+        return NULL;
+    }
+    return find_in_tables(map, key, hash);
 }
 
-void *
-CCC_private_flat_hash_map_key_at(struct CCC_Flat_hash_map const *const map,
-                                 size_t const i)
+CCC_Entry
+CCC_private_flat_hash_map_remove_with_hash(struct CCC_Flat_hash_map *const map,
+                                           void *const type_output,
+                                           uint64_t const hash)
 {
-    return key_at(map, i);
+    if (is_uninitialized(map) || !map->count)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    return remove_with_hash(map, type_output, hash);
 }
 
-/* This is needed to help the macros only set a new insert conditionally. */
 void
-CCC_private_flat_hash_map_set_insert(
-    struct CCC_Flat_hash_map_entry const *const entry)
+CCC_private_flat_hash_map_insert(struct CCC_Flat_hash_map *map,
+                                 void const *type, uint64_t hash, size_t i)
 {
-    return set_insert_tag(entry->map, entry->tag, entry->index);
+    insert_and_copy(map, type, hash, i);
 }
 
-/*=========================   Static Internals   ============================*/
-
-/** Returns the container entry prepared for further insertion, removal, or
-searched queries. This entry gives a reference to the associated map and any
-metadata and location info necessary for future actions. If this entry was
-obtained in hopes of insertions but insertion will cause an error. A status
-flag in the handle field will indicate the error. */
-static struct CCC_Flat_hash_map_entry
-container_entry(struct CCC_Flat_hash_map *const map, void const *const key)
+void
+CCC_private_flat_hash_map_erase(struct CCC_Flat_hash_map *map, size_t i)
 {
-    uint64_t const hash = hasher(map, key);
-    struct Query const e = find(map, key, hash);
-    return (struct CCC_Flat_hash_map_entry){
-        .map = (struct CCC_Flat_hash_map *)map,
-        .tag = tag_from(hash),
-        .index = e.index,
-        .status = e.status,
-    };
+    erase(map, i);
 }
 
-/** Obtaining a handle may fail if a resize or rehash fails but certain queries
-must continue with that information. The status of the handle will indicate if
-an entry is occupied, vacant, or some error has occurred. */
-static struct Query
-find(struct CCC_Flat_hash_map *const map, void const *const key,
-     uint64_t const hash)
+void *
+CCC_private_flat_hash_map_insert_duplicate(struct CCC_Flat_hash_map *const map,
+                                           void const *const type,
+                                           uint64_t const hash)
 {
-    CCC_Result const res = maybe_rehash(map, 1, map->allocate);
-    if (res == CCC_RESULT_OK)
-    {
-        return find_key_or_slot(map, key, hash);
-    }
-    /* Map was not initialized correctly or cannot allocate. */
-    if (!map->mask)
-    {
-        return (struct Query){.status = CCC_ENTRY_INSERT_ERROR};
-    }
-    struct Query q = find_key_or_slot(map, key, hash);
-    /* It's OK to find an occupied value when the map has resizing or memory
-       permission errors. If insertion occurs it will be to slot that exists. */
-    if (q.status == CCC_ENTRY_OCCUPIED)
+    assert(!is_migrating(map));
+    if (maybe_rehash(map, 1, map->allocate) != CCC_RESULT_OK)
     {
-        return q;
+        return NULL;
     }
-    /* We need to warn the user that we did not find the key and they cannot
-       insert a new element due to fixed size, permissions, or exhaustion. */
-    q.status = CCC_ENTRY_INSERT_ERROR;
-    return q;
+    size_t const i = find_slot_or_noreturn(map, hash);
+    insert_and_copy(map, type, hash, i);
+    return data_at(map, i);
 }
 
-/** Sets the insert tag meta data and copies the user type into the associated
-data slot. It is user's responsibility to ensure that the insert is valid. */
-static inline void
-insert_and_copy(struct CCC_Flat_hash_map *const map, void const *const type,
-                struct CCC_Flat_hash_map_tag const m, size_t const i)
+/** The probe ends at the first group with an empty slot just as a search for
+one key does. Equal keys are found wherever deletions let them be inserted
+along the sequence so the whole sequence up to that group is matched. */
+size_t
+CCC_private_flat_hash_map_find_matches(
+    struct CCC_Flat_hash_map const *const map, void const *const key,
+    uint64_t const hash, void *found[], size_t const found_capacity)
 {
-    set_insert_tag(map, m, i);
+    if (is_uninitialized(map) || !map->count)
+    {
+        return 0;
+    }
+    assert(!is_migrating(map));
+    struct CCC_Flat_hash_map_tag const tag = tag_from(hash);
+    size_t const mask = map->mask;
+    struct Probe_sequence p = {
+        .index = hash & mask,
+        .stride = 0,
+    };
+    size_t matches = 0;
+    for (;;)
+    {
+        struct Group const g
+            = group_load_unaligned(&map->tag[p.index], map->group_count);
+        size_t tag_i = 0;
+        struct Match_mask m = match_tag(g, tag);
+        while ((tag_i = match_next_one(&m)) != MATCH_NONE)
+        {
+            tag_i = (p.index + tag_i) & mask;
+            if (is_equal(map, key, hash, tag_i))
+            {
+                if (matches < found_capacity)
+                {
+                    found[matches] = data_at(map, tag_i);
+                }
+                ++matches;
+            }
+        }
+        if (match_has_one(match_empty(g)))
+        {
+            return matches;
+        }
+        p.stride += map->group_count;
+        p.index += p.stride;
+        p.index &= mask;
+    }
+}
+
+/** Erasing marks a slot empty only when every group containing it already
+held an empty slot, so the groups loaded later in this probe stop exactly
+where they would have before any erasure. For the same reason the group in hand
+holds an empty slot after its matches are erased only if it held one before. */
+size_t
+CCC_private_flat_hash_map_erase_matches(struct CCC_Flat_hash_map *const map,
+                                        void const *const key,
+                                        uint64_t const hash,
+                                        CCC_Type_destructor *const destroy)
+{
+    if (is_uninitialized(map) || !map->count)
+    {
+        return 0;
+    }
+    assert(!is_migrating(map));
+    struct CCC_Flat_hash_map_tag const tag = tag_from(hash);
+    size_t const mask = map->mask;
+    struct Probe_sequence p = {
+        .index = hash & mask,
+        .stride = 0,
+    };
+    size_t erased = 0;
+    for (;;)
+    {
+        struct Group const g
+            = group_load_unaligned(&map->tag[p.index], map->group_count);
+        size_t tag_i = 0;
+        struct Match_mask m = match_tag(g, tag);
+        while ((tag_i = match_next_one(&m)) != MATCH_NONE)
+        {
+            tag_i = (p.index + tag_i) & mask;
+            if (is_equal(map, key, hash, tag_i))
+            {
+                if (destroy)
+                {
+                    destroy((CCC_Type_context){
+                        .type = data_at(map, tag_i),
+                        .context = map->context,
+                    });
+                }
+                erase(map, tag_i);
+                ++erased;
+            }
+        }
+        if (match_has_one(match_empty(g)))
+        {
+            return erased;
+        }
+        p.stride += map->group_count;
+        p.index += p.stride;
+        p.index &= mask;
+    }
+}
+
+void *
+CCC_private_flat_hash_map_data_at(struct CCC_Flat_hash_map const *const map,
+                                  size_t const i)
+{
+    return data_at(map, i);
+}
+
+void *
+CCC_private_flat_hash_map_key_at(struct CCC_Flat_hash_map const *const map,
+                                 size_t const i)
+{
+    return key_at(map, i);
+}
+
+size_t
+CCC_private_flat_hash_map_table_bytes(struct CCC_Flat_hash_map const *const map,
+                                      size_t const mask)
+{
+    return mask_to_total_bytes(map->sizeof_type, mask, map->options,
+                               map->group_count);
+}
+
+/* This is needed to help the macros only set a new insert conditionally. */
+void
+CCC_private_flat_hash_map_set_insert(
+    struct CCC_Flat_hash_map_entry const *const entry)
+{
+    return set_insert_tag(entry->map, entry->hash, entry->index);
+}
+
+/*=========================   Static Internals   ============================*/
+
+/** Returns the container entry prepared for further insertion, removal, or
+searched queries. This entry gives a reference to the associated map and any
+metadata and location info necessary for future actions. If this entry was
+obtained in hopes of insertions but insertion will cause an error. A status
+flag in the handle field will indicate the error. */
+static struct CCC_Flat_hash_map_entry
+container_entry(struct CCC_Flat_hash_map *const map, void const *const key)
+{
+    uint64_t const hash = hasher(map, key);
+    struct Query const e = find(map, key, hash);
+    return (struct CCC_Flat_hash_map_entry){
+        .map = (struct CCC_Flat_hash_map *)map,
+        .hash = hash,
+        .index = e.index,
+        .status = e.status,
+    };
+}
+
+/** Removes the element with the key of type_output, writing it to type_output.
+The map must be initialized and the hash must be the hash of the key. */
+static CCC_Entry
+remove_with_hash(struct CCC_Flat_hash_map *const map, void *const type_output,
+                 uint64_t const hash)
+{
+    if (unlikely(map->read_only))
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void *const key = key_in_slot(map, type_output);
+    CCC_Count index = find_key_or_fail(map, key, hash);
+    if (index.error)
+    {
+        index = migrate_key(map, key, hash);
+    }
+    if (index.error)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    (void)memcpy(type_output, data_at(map, index.count), map->sizeof_type);
+    erase(map, index.count);
+    migrate_groups(map, MIGRATION_GROUP_STEP);
+    maybe_shrink(map);
+    return (CCC_Entry){{
+        .type = type_output,
+        .status = CCC_ENTRY_OCCUPIED,
+    }};
+}
+
+/** Inserts type if its key is absent, otherwise returns the stored element.
+The hash must be the hash of the key in type. */
+static CCC_Entry
+try_insert_with_hash(struct CCC_Flat_hash_map *const map,
+                     void const *const type, uint64_t const hash)
+{
+    void *const key = key_in_slot(map, type);
+    struct Query const q = find(map, key, hash);
+    if (q.status & CCC_ENTRY_OCCUPIED)
+    {
+        return (CCC_Entry){{
+            .type = data_at(map, q.index),
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    if (q.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    insert_and_copy(map, type, hash, q.index);
+    return (CCC_Entry){{
+        .type = data_at(map, q.index),
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+/** Obtaining a handle may fail if a resize or rehash fails but certain queries
+must continue with that information. The status of the handle will indicate if
+an entry is occupied, vacant, or some error has occurred. */
+static struct Query
+find(struct CCC_Flat_hash_map *const map, void const *const key,
+     uint64_t const hash)
+{
+    CCC_Result const res = maybe_rehash(map, 1, map->allocate);
+    if (is_migrating(map))
+    {
+        migrate_groups(map, MIGRATION_GROUP_STEP);
+        /* An element is moved to the current table before an entry to it is
+           returned so every entry refers to the current table. */
+        CCC_Count const moved = migrate_key(map, key, hash);
+        if (!moved.error)
+        {
+            return (struct Query){
+                .index = moved.count,
+                .status = CCC_ENTRY_OCCUPIED,
+            };
+        }
+    }
+    if (res == CCC_RESULT_OK)
+    {
+        return find_key_or_slot(map, key, hash);
+    }
+    /* Map was not initialized correctly or cannot allocate. */
+    if (!map->mask)
+    {
+        return (struct Query){.status = CCC_ENTRY_INSERT_ERROR};
+    }
+    struct Query q = find_key_or_slot(map, key, hash);
+    /* It's OK to find an occupied value when the map has resizing or memory
+       permission errors. If insertion occurs it will be to slot that exists. */
+    if (q.status == CCC_ENTRY_OCCUPIED)
+    {
+        /* The table of a loaded snapshot may not be written even to overwrite
+           a present key so the entry also reports that it cannot insert. */
+        if (map->read_only)
+        {
+            q.status = CCC_ENTRY_OCCUPIED | CCC_ENTRY_INSERT_ERROR;
+        }
+        return q;
+    }
+    /* We need to warn the user that we did not find the key and they cannot
+       insert a new element due to fixed size, permissions, or exhaustion. */
+    q.status = CCC_ENTRY_INSERT_ERROR;
+    return q;
+}
+
+/** Sets the insert tag meta data and copies the user type into the associated
+data slot. It is user's responsibility to ensure that the insert is valid. */
+static inline void
+insert_and_copy(struct CCC_Flat_hash_map *const map, void const *const type,
+                uint64_t const hash, size_t const i)
+{
+    set_insert_tag(map, hash, i);
     (void)memcpy(data_at(map, i), type, map->sizeof_type);
 }
 
-/** Sets the insert tag meta data. It is user's responsibility to ensure that
-the insert is valid. */
+/** Sets the insert tag meta data derived from the hash and stores the hash if
+the map is configured to do so. It is user's responsibility to ensure that the
+insert is valid. */
 static inline void
-set_insert_tag(struct CCC_Flat_hash_map *const map,
-               struct CCC_Flat_hash_map_tag const m, size_t const i)
+set_insert_tag(struct CCC_Flat_hash_map *const map, uint64_t const hash,
+               size_t const i)
 {
     assert(i <= map->mask);
-    assert((m.v & TAG_MSB) == 0);
     map->remain -= (map->tag[i].v == TAG_EMPTY);
     ++map->count;
-    tag_set(map, m, i);
+    tag_set(map, tag_from(hash), i);
+    hash_set(map, hash, i);
 }
 
 /** Erases an element at the provided index from the tag array, forfeiting its
@@ -1133,11 +2190,12 @@ static inline void
 erase(struct CCC_Flat_hash_map *const map, size_t const i)
 {
     assert(i <= map->mask);
-    size_t const prev_i = (i - GROUP_COUNT) & map->mask;
+    size_t const group_count = map->group_count;
+    size_t const prev_i = (i - group_count) & map->mask;
     struct Match_mask const prev_empties
-        = match_empty(group_load_unaligned(&map->tag[prev_i]));
+        = match_empty(group_load_unaligned(&map->tag[prev_i], group_count));
     struct Match_mask const empties
-        = match_empty(group_load_unaligned(&map->tag[i]));
+        = match_empty(group_load_unaligned(&map->tag[i], group_count));
     /* Leading means start at most significant bit aka last group member.
        Trailing means start at the least significant bit aka first group member.
 
@@ -1160,8 +2218,9 @@ erase(struct CCC_Flat_hash_map *const map, size_t const i)
        DELETED entries and this tag will be the first in the next group. This
        is an important case where we must mark our tag as deleted. */
     struct CCC_Flat_hash_map_tag const m
-        = (match_leading_zeros(prev_empties) + match_trailing_zeros(empties)
-           >= GROUP_COUNT)
+        = (match_leading_zeros(prev_empties, group_count)
+                   + match_trailing_zeros(empties)
+               >= group_count)
             ? (struct CCC_Flat_hash_map_tag){TAG_DELETED}
             : (struct CCC_Flat_hash_map_tag){TAG_EMPTY};
     map->remain += (TAG_EMPTY == m.v);
@@ -1186,14 +2245,15 @@ find_key_or_slot(struct CCC_Flat_hash_map const *const map,
     CCC_Count empty_deleted = {.error = CCC_RESULT_FAIL};
     for (;;)
     {
-        struct Group const g = group_load_unaligned(&map->tag[p.index]);
+        struct Group const g
+            = group_load_unaligned(&map->tag[p.index], map->group_count);
         {
             size_t tag_i = 0;
             struct Match_mask m = match_tag(g, tag);
-            while ((tag_i = match_next_one(&m)) != GROUP_COUNT)
+            while ((tag_i = match_next_one(&m)) != MATCH_NONE)
             {
                 tag_i = (p.index + tag_i) & mask;
-                if (likely(is_equal(map, key, tag_i)))
+                if (likely(is_equal(map, key, hash, tag_i)))
                 {
                     return (struct Query){
                         .index = tag_i,
@@ -1207,7 +2267,7 @@ find_key_or_slot(struct CCC_Flat_hash_map const *const map,
         if (likely(empty_deleted.error))
         {
             size_t const i_take = match_trailing_one(match_empty_deleted(g));
-            if (likely(i_take != GROUP_COUNT))
+            if (likely(i_take != MATCH_NONE))
             {
                 empty_deleted.count = (p.index + i_take) & mask;
                 empty_deleted.error = CCC_RESULT_OK;
@@ -1220,7 +2280,7 @@ find_key_or_slot(struct CCC_Flat_hash_map const *const map,
                 .status = CCC_ENTRY_VACANT,
             };
         }
-        p.stride += GROUP_COUNT;
+        p.stride += map->group_count;
         p.index += p.stride;
         p.index &= mask;
     }
@@ -1246,14 +2306,15 @@ find_key_or_fail(struct CCC_Flat_hash_map const *const map,
     };
     for (;;)
     {
-        struct Group const g = group_load_unaligned(&map->tag[p.index]);
+        struct Group const g
+            = group_load_unaligned(&map->tag[p.index], map->group_count);
         {
             size_t tag_i = 0;
             struct Match_mask m = match_tag(g, tag);
-            while ((tag_i = match_next_one(&m)) != GROUP_COUNT)
+            while ((tag_i = match_next_one(&m)) != MATCH_NONE)
             {
                 tag_i = (p.index + tag_i) & mask;
-                if (likely(is_equal(map, key, tag_i)))
+                if (likely(is_equal(map, key, hash, tag_i)))
                 {
                     return (CCC_Count){.count = tag_i};
                 }
@@ -1263,7 +2324,7 @@ find_key_or_fail(struct CCC_Flat_hash_map const *const map,
         {
             return (CCC_Count){.error = CCC_RESULT_FAIL};
         }
-        p.stride += GROUP_COUNT;
+        p.stride += map->group_count;
         p.index += p.stride;
         p.index &= mask;
     }
@@ -1283,13 +2344,13 @@ find_slot_or_noreturn(struct CCC_Flat_hash_map const *const map,
     };
     for (;;)
     {
-        size_t const i = match_trailing_one(
-            match_empty_deleted(group_load_unaligned(&map->tag[p.index])));
-        if (likely(i != GROUP_COUNT))
+        size_t const i = match_trailing_one(match_empty_deleted(
+            group_load_unaligned(&map->tag[p.index], map->group_count)));
+        if (likely(i != MATCH_NONE))
         {
             return (p.index + i) & mask;
         }
-        p.stride += GROUP_COUNT;
+        p.stride += map->group_count;
         p.index += p.stride;
         p.index &= mask;
     }
@@ -1302,16 +2363,16 @@ loads are aligned for performance. */
 static inline void *
 find_first_full_slot(struct CCC_Flat_hash_map const *const map, size_t start)
 {
-    assert((start & ~((size_t)(GROUP_COUNT - 1))) == start);
+    assert((start & ~((size_t)(map->group_count - 1))) == start);
     while (start < (map->mask + 1))
     {
-        size_t const full = match_trailing_one(
-            match_full(group_load_aligned(&map->tag[start])));
-        if (full != GROUP_COUNT)
+        size_t const full = match_trailing_one(match_full(
+            group_load_aligned(&map->tag[start], map->group_count)));
+        if (full != MATCH_NONE)
         {
             return data_at(map, start + full);
         }
-        start += GROUP_COUNT;
+        start += map->group_count;
     }
     return NULL;
 }
@@ -1327,20 +2388,71 @@ static inline struct Match_mask
 find_first_full_group(struct CCC_Flat_hash_map const *const map,
                       size_t *const start)
 {
-    assert((*start & ~((size_t)(GROUP_COUNT - 1))) == *start);
+    assert((*start & ~((size_t)(map->group_count - 1))) == *start);
     while (*start < (map->mask + 1))
     {
-        struct Match_mask const full
-            = match_full(group_load_aligned(&map->tag[*start]));
+        struct Match_mask const full = match_full(
+            group_load_aligned(&map->tag[*start], map->group_count));
         if (full.v)
         {
             return full;
         }
-        *start += GROUP_COUNT;
+        *start += map->group_count;
     }
     return (struct Match_mask){};
 }
 
+/** Erases every full slot the predicate rejects. The full mask of each aligned
+group is taken before the predicate runs so erasing a slot, which only writes
+its own tag and replica, cannot hide or repeat another slot of the group. */
+static void
+retain_groups(struct CCC_Flat_hash_map *const map,
+              CCC_Type_predicate *const keep, void *const context)
+{
+    size_t start = 0;
+    struct Match_mask full = {};
+    while ((full = find_first_full_group(map, &start)).v)
+    {
+        size_t tag_i = 0;
+        while ((tag_i = match_next_one(&full)) != MATCH_NONE)
+        {
+            tag_i += start;
+            if (!keep((CCC_Type_context){
+                    .type = data_at(map, tag_i),
+                    .context = context,
+                }))
+            {
+                erase(map, tag_i);
+            }
+        }
+        start += map->group_count;
+    }
+}
+
+/** Calls the modifier on every full slot of the aligned groups in the range
+[start_group, end_group). Only the tag array and the visited slots are read. */
+static void
+visit_groups(struct CCC_Flat_hash_map *const map,
+             size_t const start_group, size_t const end_group,
+             CCC_Type_modifier *const modify, void *const context)
+{
+    size_t const group_count = map->group_count;
+    for (size_t start = start_group * group_count;
+         start < end_group * group_count; start += group_count)
+    {
+        struct Match_mask full
+            = match_full(group_load_aligned(&map->tag[start], group_count));
+        size_t tag_i = 0;
+        while ((tag_i = match_next_one(&full)) != MATCH_NONE)
+        {
+            modify((CCC_Type_context){
+                .type = data_at(map, start + tag_i),
+                .context = context,
+            });
+        }
+    }
+}
+
 /** Returns the first deleted group mask if found and progresses the start index
 as needed to find the index corresponding to the first deleted element of this
 group. If no group with a deleted slot is found a 0 mask is returned and the
@@ -1352,16 +2464,16 @@ static inline struct Match_mask
 find_first_deleted_group(struct CCC_Flat_hash_map const *const map,
                          size_t *const start)
 {
-    assert((*start & ~((size_t)(GROUP_COUNT - 1))) == *start);
+    assert((*start & ~((size_t)(map->group_count - 1))) == *start);
     while (*start < (map->mask + 1))
     {
-        struct Match_mask const deleted
-            = match_deleted(group_load_aligned(&map->tag[*start]));
+        struct Match_mask const deleted = match_deleted(
+            group_load_aligned(&map->tag[*start], map->group_count));
         if (deleted.v)
         {
             return deleted;
         }
-        *start += GROUP_COUNT;
+        *start += map->group_count;
     }
     return (struct Match_mask){};
 }
@@ -1376,7 +2488,7 @@ static CCC_Result
 maybe_rehash(struct CCC_Flat_hash_map *const map, size_t const to_add,
              CCC_Allocator *const fn)
 {
-    if (unlikely(!map->mask && !fn))
+    if (unlikely((!map->mask && !fn) || map->read_only))
     {
         return CCC_RESULT_NO_ALLOCATION_FUNCTION;
     }
@@ -1395,9 +2507,24 @@ maybe_rehash(struct CCC_Flat_hash_map *const map, size_t const to_add,
     {
         return CCC_RESULT_OK;
     }
+    /* The previous table must be empty before another resize may begin.
+       Moving its elements may also free reserved slots that were deleted. */
+    if (is_migrating(map))
+    {
+        migrate_groups(map, SIZE_MAX);
+        if (map->remain)
+        {
+            return CCC_RESULT_OK;
+        }
+    }
     size_t const current_total_cap = map->mask + 1;
     if (fn && (map->count + to_add) > current_total_cap / 2)
     {
+        if ((map->options & CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE)
+            && fn == map->allocate)
+        {
+            return begin_incremental_resize(map, to_add);
+        }
         return rehash_resize(map, to_add, fn);
     }
     if (map->count == mask_to_load_factor_cap(map->mask))
@@ -1408,6 +2535,55 @@ maybe_rehash(struct CCC_Flat_hash_map *const map, size_t const to_add,
     return CCC_RESULT_OK;
 }
 
+/** Ensures a batch of to_add insertions can proceed without any rehash. The
+regular check only guarantees room for one more element because the load
+factor is checked again on each insertion. A batch hands out references as it
+goes so it must claim all of its space up front. */
+static CCC_Result
+reserve_batch(struct CCC_Flat_hash_map *const map, size_t const to_add)
+{
+    CCC_Result const res = maybe_rehash(map, to_add, map->allocate);
+    if (res != CCC_RESULT_OK)
+    {
+        /* A fixed map too small for the batch may still accept part of it. */
+        if (is_uninitialized(map))
+        {
+            (void)maybe_rehash(map, 1, map->allocate);
+        }
+        return res;
+    }
+    if (map->remain >= to_add)
+    {
+        return CCC_RESULT_OK;
+    }
+    if (!map->allocate)
+    {
+        return CCC_RESULT_NO_ALLOCATION_FUNCTION;
+    }
+    migrate_groups(map, SIZE_MAX);
+    return rehash_resize(map, to_add, map->allocate);
+}
+
+/** Hashes count keys and prefetches the first tag group and data slot each
+probe will visit. The keys are found key_offset bytes into each pointer so
+that full user types may be hashed as well as lone keys. Probing afterward
+overlaps the cache misses of independent lookups rather than stalling on each
+one in turn. */
+static inline void
+hash_and_prefetch(struct CCC_Flat_hash_map const *const map,
+                  void const *const any_keys[], size_t const count,
+                  size_t const key_offset, uint64_t *const hashes)
+{
+    assert(count <= BATCH_PREFETCH_COUNT);
+    for (size_t i = 0; i < count; ++i)
+    {
+        hashes[i] = hasher(map, (char const *)any_keys[i] + key_offset);
+        size_t const home = hashes[i] & map->mask;
+        prefetch(&map->tag[home]);
+        prefetch(data_at(map, home));
+    }
+}
+
 /** Rehashes the map in place. Elements may or may not move, depending on
 results. Assumes the table has been allocated and had no more remaining slots
 for insertion. Rehashing in place repeatedly can be expensive so the user
@@ -1415,16 +2591,15 @@ should ensure to select an appropriate capacity for fixed size tables. */
 static void
 rehash_in_place(struct CCC_Flat_hash_map *const map)
 {
-    assert((map->mask + 1) % GROUP_COUNT == 0);
+    size_t const group_count = map->group_count;
+    assert((map->mask + 1) % group_count == 0);
     assert(map->tag && map->data);
     size_t const mask = map->mask;
-    for (size_t i = 0; i < mask + 1; i += GROUP_COUNT)
+    for (size_t i = 0; i < mask + 1; i += group_count)
     {
-        group_store_aligned(&map->tag[i],
-                            group_constant_to_empty_full_to_deleted(
-                                group_load_aligned(&map->tag[i])));
+        group_constant_to_empty_full_to_deleted(&map->tag[i], group_count);
     }
-    (void)memcpy(map->tag + (mask + 1), map->tag, GROUP_COUNT);
+    (void)memcpy(map->tag + (mask + 1), map->tag, group_count);
     {
         size_t group_start = 0;
         struct Match_mask deleted = {};
@@ -1438,7 +2613,7 @@ rehash_in_place(struct CCC_Flat_hash_map *const map)
         {
             {
                 size_t tag_i = 0;
-                while ((tag_i = match_next_one(&deleted)) != GROUP_COUNT)
+                while ((tag_i = match_next_one(&deleted)) != MATCH_NONE)
                 {
                     tag_i += group_start;
                     /* The inner loop swap case may have made a previously
@@ -1453,7 +2628,7 @@ rehash_in_place(struct CCC_Flat_hash_map *const map)
                     }
                     for (;;)
                     {
-                        uint64_t const hash = hasher(map, key_at(map, tag_i));
+                        uint64_t const hash = slot_hash(map, tag_i);
                         size_t const new_i = find_slot_or_noreturn(map, hash);
                         struct CCC_Flat_hash_map_tag const hash_tag
                             = tag_from(hash);
@@ -1462,7 +2637,8 @@ rehash_in_place(struct CCC_Flat_hash_map *const map)
                            tag is in the proper group for an unaligned load
                            based on where the hashed value will start its loads
                            and the match and does not need relocation. */
-                        if (likely(is_same_group(tag_i, new_i, hash, mask)))
+                        if (likely(is_same_group(tag_i, new_i, hash, mask,
+                                                 group_count)))
                         {
                             tag_set(map, hash_tag, tag_i);
                             break; /* continues outer loop */
@@ -1477,6 +2653,7 @@ rehash_in_place(struct CCC_Flat_hash_map *const map)
                                     tag_i);
                             (void)memcpy(data_at(map, new_i),
                                          data_at(map, tag_i), map->sizeof_type);
+                            hash_set(map, hash, new_i);
                             break; /* continues outer loop */
                         }
                         /* The other slots data has been swapped and we rehash
@@ -1487,91 +2664,793 @@ rehash_in_place(struct CCC_Flat_hash_map *const map)
                         assert(occupant.v == TAG_DELETED);
                         swap(swap_slot(map), data_at(map, tag_i),
                              data_at(map, new_i), map->sizeof_type);
+                        hash_swap(map, tag_i, new_i);
                     }
                 }
             }
-            group_start += GROUP_COUNT;
+            group_start += group_count;
+        }
+    }
+    map->remain = mask_to_load_factor_cap(mask) - map->count;
+}
+
+/** Returns true if the position being rehashed would be moved to a new slot
+in the same group it is already in. This means when this data is hashed to its
+ideal index in the table, both i and new_slot are already in that group that
+would be loaded for simultaneous scanning. */
+static inline CCC_Tribool
+is_same_group(size_t const i, size_t const new_i, uint64_t const hash,
+              size_t const mask, size_t const group_count)
+{
+    return (((i - (hash & mask)) & mask) / group_count)
+        == (((new_i - (hash & mask)) & mask) / group_count);
+}
+
+static CCC_Result
+rehash_resize(struct CCC_Flat_hash_map *const map, size_t const to_add,
+              CCC_Allocator *const allocate)
+{
+    assert(((map->mask + 1) & map->mask) == 0);
+    assert(!is_migrating(map));
+    size_t new_pow2_cap = 0;
+    if (!grow_total_bytes(map, to_add, &new_pow2_cap))
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    return rehash_to(map, new_pow2_cap, allocate);
+}
+
+/** Moves every element into a newly allocated table of new_pow2_cap slots and
+frees the old table. The new capacity may be larger or smaller than the current
+capacity but must hold every element at the load factor. The map is unchanged
+if allocation fails. */
+static CCC_Result
+rehash_to(struct CCC_Flat_hash_map *const map, size_t const new_pow2_cap,
+          CCC_Allocator *const allocate)
+{
+    assert(!is_migrating(map));
+    assert(mask_to_load_factor_cap(new_pow2_cap - 1) >= map->count);
+    void *const new_buf = allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = mask_to_total_bytes(map->sizeof_type, new_pow2_cap - 1,
+                                     map->options, map->group_count),
+        .context = map->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+    });
+    if (!new_buf)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    struct CCC_Flat_hash_map new_h = *map;
+    new_h.count = 0;
+    new_h.mask = new_pow2_cap - 1;
+    new_h.remain = mask_to_load_factor_cap(new_h.mask);
+    new_h.data = new_buf;
+    /* Our static assertions at start of file guarantee this is correct. */
+    new_h.tag
+        = tag_pos(new_h.sizeof_type, new_buf, new_h.mask, new_h.group_count);
+    (void)memset(new_h.tag, TAG_EMPTY,
+                 mask_to_tag_bytes(new_h.mask, new_h.group_count));
+    copy_full_slots(&new_h, map);
+    new_h.remain -= map->count;
+    new_h.count = map->count;
+    (void)allocate((CCC_Allocator_context){
+        .input = map->data,
+        .bytes = 0,
+        .context = map->context,
+        .old_bytes = mask_to_total_bytes(map->sizeof_type, map->mask,
+                                         map->options, map->group_count),
+    });
+    *map = new_h;
+    return CCC_RESULT_OK;
+}
+
+/** Ensures to_add more elements fit without a rehash, growing the table with
+the given threads if needed. */
+static CCC_Result
+reserve_parallel(struct CCC_Flat_hash_map *const map, size_t const to_add,
+                 CCC_Allocator *const allocate, size_t const threads)
+{
+    if (is_uninitialized(map))
+    {
+        CCC_Result const res = maybe_rehash(map, to_add, allocate);
+        if (res != CCC_RESULT_OK)
+        {
+            return res;
+        }
+    }
+    migrate_groups(map, SIZE_MAX);
+    if (map->remain >= to_add)
+    {
+        return CCC_RESULT_OK;
+    }
+    size_t new_pow2_cap = 0;
+    if (!grow_total_bytes(map, to_add, &new_pow2_cap))
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    void *const new_buf = allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = mask_to_total_bytes(map->sizeof_type, new_pow2_cap - 1,
+                                     map->options, map->group_count),
+        .context = map->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+    });
+    if (!new_buf)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    struct CCC_Flat_hash_map new_h = *map;
+    new_h.count = 0;
+    new_h.mask = new_pow2_cap - 1;
+    new_h.remain = mask_to_load_factor_cap(new_h.mask);
+    new_h.data = new_buf;
+    new_h.tag
+        = tag_pos(new_h.sizeof_type, new_buf, new_h.mask, new_h.group_count);
+    (void)memset(new_h.tag, TAG_EMPTY,
+                 mask_to_tag_bytes(new_h.mask, new_h.group_count));
+    struct Parallel_build build = {
+        .map = &new_h,
+        .source = map,
+        .source_count = map->mask + 1,
+        .keys_unique = CCC_TRUE,
+        .threads = threads,
+    };
+    if (parallel_build(&build, allocate) != CCC_RESULT_OK)
+    {
+        copy_full_slots(&new_h, map);
+        new_h.remain -= map->count;
+        new_h.count = map->count;
+    }
+    (void)allocate((CCC_Allocator_context){
+        .input = map->data,
+        .bytes = 0,
+        .context = map->context,
+        .old_bytes = mask_to_total_bytes(map->sizeof_type, map->mask,
+                                         map->options, map->group_count),
+    });
+    *map = new_h;
+    return CCC_RESULT_OK;
+}
+
+/** Places every source element in the destination with the threads of the
+build, then places the elements whose probes left their range. An array source
+too small to split is placed by the caller. For a source table, an error is
+returned without changing the destination if the table is too small to split
+or the temporary arrays cannot be allocated, leaving the move to the caller. */
+static CCC_Result
+parallel_build(struct Parallel_build *const b, CCC_Allocator *const allocate)
+{
+    struct CCC_Flat_hash_map *const map = b->map;
+    size_t const cap = map->mask + 1;
+    size_t range_slots = cap / (b->threads * PARALLEL_RANGES_PER_THREAD);
+    size_t const group_count = map->group_count;
+    range_slots = max(range_slots, PARALLEL_MIN_RANGE_GROUPS * group_count);
+    range_slots = (range_slots + group_count - 1) & ~(group_count - 1);
+    size_t const ranges = (cap + range_slots - 1) / range_slots;
+    if (ranges < 2)
+    {
+        if (b->source)
+        {
+            return CCC_RESULT_FAIL;
+        }
+        CCC_Buffer const buffer = {
+            .data = (void *)b->types,
+            .count = b->source_count,
+            .sizeof_type = map->sizeof_type,
+        };
+        return CCC_flat_hash_map_extend(map, &buffer, b->keys_unique);
+    }
+    b->ranges = ranges;
+    b->range_slots = range_slots;
+    size_t const threads = b->threads;
+    size_t const elements = b->source ? b->source->count : b->source_count;
+    size_t const bytes = (threads * sizeof(struct Parallel_worker))
+                       + (b->source_count * sizeof(uint64_t))
+                       + (((threads * ranges) + (ranges + 1) + (ranges * 3)
+                           + elements)
+                          * sizeof(size_t));
+    struct Parallel_worker *const workers = allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = bytes,
+        .context = map->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+    });
+    if (!workers)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    b->hashes = (uint64_t *)(void *)(workers + threads);
+    b->counts = (size_t *)(void *)(b->hashes + b->source_count);
+    b->range_start = b->counts + (threads * ranges);
+    b->deferred = b->range_start + ranges + 1;
+    b->added = b->deferred + ranges;
+    b->consumed = b->added + ranges;
+    b->order = b->consumed + ranges;
+    (void)memset(b->counts, 0, threads * ranges * sizeof(size_t));
+    for (enum Parallel_phase phase = PARALLEL_PHASE_HASH;
+         phase <= PARALLEL_PHASE_PLACE; ++phase)
+    {
+        b->phase = phase;
+        for (size_t t = 1; t < threads; ++t)
+        {
+            workers[t] = (struct Parallel_worker){.build = b, .id = t};
+            workers[t].started = !pthread_create(&workers[t].thread, NULL,
+                                                 parallel_work, &workers[t]);
+        }
+        workers[0] = (struct Parallel_worker){.build = b, .id = 0};
+        (void)parallel_work(&workers[0]);
+        for (size_t t = 1; t < threads; ++t)
+        {
+            if (workers[t].started)
+            {
+                (void)pthread_join(workers[t].thread, NULL);
+            }
+            else
+            {
+                (void)parallel_work(&workers[t]);
+            }
+        }
+        if (phase == PARALLEL_PHASE_HASH)
+        {
+            /* Grouped positions follow range order and, within a range, thread
+               order, which is source order. */
+            size_t position = 0;
+            for (size_t r = 0; r < ranges; ++r)
+            {
+                b->range_start[r] = position;
+                for (size_t t = 0; t < threads; ++t)
+                {
+                    size_t const found = b->counts[(t * ranges) + r];
+                    b->counts[(t * ranges) + r] = position;
+                    position += found;
+                }
+            }
+            b->range_start[ranges] = position;
+        }
+    }
+    for (size_t r = 0; r < ranges; ++r)
+    {
+        map->count += b->added[r];
+        map->remain -= b->consumed[r];
+    }
+    /* Elements left by a range are placed in order so a later duplicate key
+       still overwrites an earlier one. */
+    for (size_t r = 0; r < ranges; ++r)
+    {
+        for (size_t k = b->deferred[r]; k < b->range_start[r + 1]; ++k)
+        {
+            size_t const s = b->order[k];
+            void const *const type = parallel_source_type(b, s);
+            uint64_t const hash = b->hashes[s];
+            if (b->keys_unique)
+            {
+                insert_and_copy(map, type, hash,
+                                find_slot_or_noreturn(map, hash));
+                continue;
+            }
+            struct Query const q
+                = find_key_or_slot(map, key_in_slot(map, type), hash);
+            if (q.status == CCC_ENTRY_OCCUPIED)
+            {
+                (void)memcpy(data_at(map, q.index), type, map->sizeof_type);
+                continue;
+            }
+            insert_and_copy(map, type, hash, q.index);
+        }
+    }
+    (void)allocate((CCC_Allocator_context){
+        .input = workers,
+        .bytes = 0,
+        .context = map->context,
+        .old_bytes = bytes,
+    });
+    return CCC_RESULT_OK;
+}
+
+/** Performs the current phase of a parallel build for one thread. */
+static void *
+parallel_work(void *const arg)
+{
+    struct Parallel_worker const *const w = arg;
+    struct Parallel_build *const b = w->build;
+    size_t const ranges = b->ranges;
+    size_t *const counts = b->counts + (w->id * ranges);
+    if (b->phase == PARALLEL_PHASE_PLACE)
+    {
+        for (size_t r = w->id; r < ranges; r += b->threads)
+        {
+            size_t k = b->range_start[r];
+            b->added[r] = 0;
+            b->consumed[r] = 0;
+            while (k < b->range_start[r + 1]
+                   && parallel_place(b, b->order[k], r))
+            {
+                ++k;
+            }
+            b->deferred[r] = k;
+        }
+        return NULL;
+    }
+    size_t lo = 0;
+    size_t hi = 0;
+    parallel_source_range(b, w->id, &lo, &hi);
+    for (size_t s = lo; s < hi; ++s)
+    {
+        if (b->source && !tag_full(b->source->tag[s]))
+        {
+            continue;
+        }
+        if (b->phase == PARALLEL_PHASE_HASH)
+        {
+            uint64_t const hash
+                = b->source ? slot_hash(b->source, s)
+                            : hasher(b->map, (char const *)parallel_source_type(
+                                                 b, s)
+                                                 + b->map->key_offset);
+            b->hashes[s] = hash;
+            ++counts[(hash & b->map->mask) / b->range_slots];
+        }
+        else
+        {
+            size_t const r = (b->hashes[s] & b->map->mask) / b->range_slots;
+            b->order[counts[r]++] = s;
+        }
+    }
+    return NULL;
+}
+/** Writes the share of source indices for thread id. Shares of a source table
+are whole groups so that each thread scans aligned tags. */
+static void
+parallel_source_range(struct Parallel_build const *const b, size_t const id,
+                      size_t *const lo, size_t *const hi)
+{
+    size_t share = (b->source_count + b->threads - 1) / b->threads;
+    if (b->source)
+    {
+        size_t const group_count = b->source->group_count;
+        share = (share + group_count - 1) & ~(group_count - 1);
+    }
+    *lo = min(id * share, b->source_count);
+    *hi = min(*lo + share, b->source_count);
+}
+
+/** Returns the user type at source index s. */
+static inline void const *
+parallel_source_type(struct Parallel_build const *const b, size_t const s)
+{
+    if (b->source)
+    {
+        return data_at(b->source, s);
+    }
+    return b->types + (s * b->map->sizeof_type);
+}
+
+/** Places source element s in range r of the destination. Every group the
+probe loads must lie within the range, because other threads are writing the
+neighboring ranges. Returns false, placing nothing, if the probe would leave the
+range. The counts of the map are updated by the caller from the range totals. */
+static CCC_Tribool
+parallel_place(struct Parallel_build *const b, size_t const s, size_t const r)
+{
+    struct CCC_Flat_hash_map *const map = b->map;
+    size_t const lo = r * b->range_slots;
+    size_t const hi = min(lo + b->range_slots, map->mask + 1);
+    void const *const type = parallel_source_type(b, s);
+    uint64_t const hash = b->hashes[s];
+    struct CCC_Flat_hash_map_tag const tag = tag_from(hash);
+    size_t const mask = map->mask;
+    struct Probe_sequence p = {
+        .index = hash & mask,
+        .stride = 0,
+    };
+    size_t slot = SIZE_MAX;
+    for (;;)
+    {
+        if (p.index < lo || p.index + map->group_count > hi)
+        {
+            return CCC_FALSE;
+        }
+        struct Group const g
+            = group_load_unaligned(&map->tag[p.index], map->group_count);
+        if (!b->keys_unique)
+        {
+            size_t tag_i = 0;
+            struct Match_mask m = match_tag(g, tag);
+            while ((tag_i = match_next_one(&m)) != MATCH_NONE)
+            {
+                tag_i += p.index;
+                if (is_equal(map, key_in_slot(map, type), hash, tag_i))
+                {
+                    (void)memcpy(data_at(map, tag_i), type, map->sizeof_type);
+                    return CCC_TRUE;
+                }
+            }
+        }
+        if (slot == SIZE_MAX)
+        {
+            size_t const i_take = match_trailing_one(match_empty_deleted(g));
+            if (i_take != MATCH_NONE)
+            {
+                slot = p.index + i_take;
+            }
+        }
+        if ((b->keys_unique && slot != SIZE_MAX)
+            || match_has_one(match_empty(g)))
+        {
+            break;
+        }
+        p.stride += map->group_count;
+        p.index += p.stride;
+        p.index &= mask;
+    }
+    b->consumed[r] += (map->tag[slot].v == TAG_EMPTY);
+    ++b->added[r];
+    tag_set(map, tag, slot);
+    hash_set(map, hash, slot);
+    (void)memcpy(data_at(map, slot), type, map->sizeof_type);
+    return CCC_TRUE;
+}
+
+/** Returns the smallest power of two capacity, no smaller than a group of the
+given width, that holds count elements at the load factor. */
+static inline size_t
+fit_capacity(size_t const count, size_t const group_count)
+{
+    size_t cap = group_count;
+    while (mask_to_load_factor_cap(cap - 1) < count)
+    {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+/** Rehashes in place if any slot is deleted. Every slot of the load factor
+that is neither occupied nor counted as remaining holds a deleted tag. */
+static inline void
+compact(struct CCC_Flat_hash_map *const map)
+{
+    assert(!is_migrating(map));
+    if (map->count + map->remain < mask_to_load_factor_cap(map->mask))
+    {
+        rehash_in_place(map);
+    }
+}
+
+/** Shrinks the table to fit after a removal if the user asked for automatic
+shrinking and the count has fallen below the chosen fraction of capacity. A
+failed allocation leaves the table as it was. */
+static inline void
+maybe_shrink(struct CCC_Flat_hash_map *const map)
+{
+    if (likely(!map->shrink_denominator) || !map->allocate
+        || is_migrating(map)
+        || map->count >= (map->mask + 1) / map->shrink_denominator)
+    {
+        return;
+    }
+    size_t const fit_cap = fit_capacity(map->count, map->group_count);
+    if (fit_cap < map->mask + 1)
+    {
+        (void)rehash_to(map, fit_cap, map->allocate);
+    }
+}
+
+/** Returns the total bytes of the next larger table able to hold to_add more
+elements and writes its capacity to new_cap. Returns 0 if the new size would
+overflow. */
+static size_t
+grow_total_bytes(struct CCC_Flat_hash_map const *const map, size_t const to_add,
+                 size_t *const new_cap)
+{
+    size_t const new_pow2_cap
+        = next_power_of_two((map->mask + 1 + to_add) << 1);
+    if (new_pow2_cap < (map->mask + 1))
+    {
+        return 0;
+    }
+    size_t const prev_bytes = mask_to_total_bytes(
+        map->sizeof_type, map->mask, map->options, map->group_count);
+    size_t const total_bytes
+        = mask_to_total_bytes(map->sizeof_type, new_pow2_cap - 1,
+                              map->options, map->group_count);
+    if (total_bytes < prev_bytes)
+    {
+        return 0;
+    }
+    *new_cap = new_pow2_cap;
+    return total_bytes;
+}
+
+/** Allocates the larger table and makes it current without moving any
+elements. The current table becomes the previous table of the migration and
+the new table reserves a slot for every element still to be moved, so the
+remaining count is exact once they have all arrived. */
+static CCC_Result
+begin_incremental_resize(struct CCC_Flat_hash_map *const map,
+                         size_t const to_add)
+{
+    assert(((map->mask + 1) & map->mask) == 0);
+    assert(!is_migrating(map));
+    size_t new_pow2_cap = 0;
+    size_t const total_bytes = grow_total_bytes(map, to_add, &new_pow2_cap);
+    if (!total_bytes)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    void *const new_buf = map->allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = total_bytes,
+        .context = map->context,
+        .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
+    });
+    if (!new_buf)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    map->migration = (struct CCC_Flat_hash_map_migration){
+        .data = map->data,
+        .tag = map->tag,
+        .mask = map->mask,
+        .count = map->count,
+        .next = 0,
+    };
+    map->data = new_buf;
+    map->mask = new_pow2_cap - 1;
+    map->tag = tag_pos(map->sizeof_type, new_buf, map->mask, map->group_count);
+    (void)memset(map->tag, TAG_EMPTY,
+                 mask_to_tag_bytes(map->mask, map->group_count));
+    map->remain = mask_to_load_factor_cap(map->mask) - map->count;
+    return CCC_RESULT_OK;
+}
+
+static inline CCC_Tribool
+is_migrating(struct CCC_Flat_hash_map const *const map)
+{
+    return map->migration.data != NULL;
+}
+
+/** Adds the aligned groups selected by the sample to the statistics. The
+sample is spread evenly so that clusters anywhere in the table are seen. */
+static void
+stats_scan(struct CCC_Flat_hash_map const *const map,
+           size_t const sample_groups, CCC_Flat_hash_map_stats *const stats)
+{
+    size_t const group_count = map->group_count;
+    size_t const groups = (map->mask + 1) / group_count;
+    size_t const sample
+        = (!sample_groups || sample_groups > groups) ? groups : sample_groups;
+    size_t const step = groups / sample;
+    for (size_t s = 0; s < sample; ++s)
+    {
+        size_t const start = s * step * group_count;
+        struct Group const g
+            = group_load_aligned(&map->tag[start], group_count);
+        stats->tombstones += match_count(match_deleted(g));
+        struct Match_mask full = match_full(g);
+        ++stats->group_fill[match_count(full)];
+        ++stats->sampled_groups;
+        size_t i = 0;
+        while ((i = match_next_one(&full)) != MATCH_NONE)
+        {
+            stats_probe(map, start + i, stats);
+        }
+    }
+}
+
+/** Repeats the search for the element at slot i from its hash, counting the
+groups visited and the elements with the same tag that are compared first. */
+static void
+stats_probe(struct CCC_Flat_hash_map const *const map, size_t const i,
+            CCC_Flat_hash_map_stats *const stats)
+{
+    uint64_t const hash = slot_hash(map, i);
+    struct CCC_Flat_hash_map_tag const tag = tag_from(hash);
+    size_t const mask = map->mask;
+    struct Probe_sequence p = {
+        .index = hash & mask,
+        .stride = 0,
+    };
+    size_t visited = 1;
+    for (;;)
+    {
+        struct Match_mask m = match_tag(
+            group_load_unaligned(&map->tag[p.index], map->group_count), tag);
+        size_t const offset = (i - p.index) & mask;
+        if (offset < map->group_count)
+        {
+            size_t tag_i = 0;
+            while ((tag_i = match_next_one(&m)) < offset)
+            {
+                ++stats->false_tag_matches;
+            }
+            break;
         }
+        stats->false_tag_matches += match_count(m);
+        p.stride += map->group_count;
+        p.index += p.stride;
+        p.index &= mask;
+        ++visited;
     }
-    map->remain = mask_to_load_factor_cap(mask) - map->count;
+    ++stats->sampled_elements;
+    ++stats->probe_length[min(visited, CCC_FLAT_HASH_MAP_STATS_PROBE_BUCKETS)
+                          - 1];
+    stats->total_probe_length += visited;
+    stats->max_probe_length = max(stats->max_probe_length, visited);
 }
 
-/** Returns true if the position being rehashed would be moved to a new slot
-in the same group it is already in. This means when this data is hashed to its
-ideal index in the table, both i and new_slot are already in that group that
-would be loaded for simultaneous scanning. */
-static inline CCC_Tribool
-is_same_group(size_t const i, size_t const new_i, uint64_t const hash,
-              size_t const mask)
+/** Returns a map describing the previous table of an incremental resize. All
+search and group functions then work on the previous table unchanged. */
+static inline struct CCC_Flat_hash_map
+migration_view(struct CCC_Flat_hash_map const *const map)
+{
+    assert(is_migrating(map));
+    struct CCC_Flat_hash_map previous = *map;
+    previous.data = map->migration.data;
+    previous.tag = map->migration.tag;
+    previous.mask = map->migration.mask;
+    previous.count = map->migration.count;
+    previous.remain = 0;
+    previous.migration = (struct CCC_Flat_hash_map_migration){};
+    return previous;
+}
+
+/** Moves up to groups groups of the previous table into the current table and
+frees the previous table once it is empty. Passing SIZE_MAX finishes the
+migration. Does nothing if no incremental resize is in progress. */
+static void
+migrate_groups(struct CCC_Flat_hash_map *const map, size_t const groups)
 {
-    return (((i - (hash & mask)) & mask) / GROUP_COUNT)
-        == (((new_i - (hash & mask)) & mask) / GROUP_COUNT);
+    if (!is_migrating(map))
+    {
+        return;
+    }
+    struct CCC_Flat_hash_map previous = migration_view(map);
+    for (size_t moved = 0; moved < groups && map->migration.count
+                           && map->migration.next < previous.mask + 1;
+         ++moved, map->migration.next += previous.group_count)
+    {
+        struct Match_mask full = match_full(group_load_aligned(
+            &previous.tag[map->migration.next], previous.group_count));
+        size_t tag_i = 0;
+        while ((tag_i = match_next_one(&full)) != MATCH_NONE)
+        {
+            tag_i += map->migration.next;
+            (void)migrate_slot(map, &previous, tag_i,
+                               slot_hash(&previous, tag_i));
+        }
+    }
+    if (!map->migration.count)
+    {
+        free_migration(map);
+    }
 }
 
-static CCC_Result
-rehash_resize(struct CCC_Flat_hash_map *const map, size_t const to_add,
-              CCC_Allocator *const allocate)
+/** Moves the element at previous_i of the previous table into the current
+table and returns its new index. The previous slot is marked deleted so probes
+for the other waiting elements still pass over it. A deleted slot reused in the
+current table returns the slot that was reserved for this element. */
+static size_t
+migrate_slot(struct CCC_Flat_hash_map *const map,
+             struct CCC_Flat_hash_map *const previous, size_t const previous_i,
+             uint64_t const hash)
+{
+    size_t const new_i = find_slot_or_noreturn(map, hash);
+    map->remain += (map->tag[new_i].v == TAG_DELETED);
+    tag_set(map, tag_from(hash), new_i);
+    hash_set(map, hash, new_i);
+    (void)memcpy(data_at(map, new_i), data_at(previous, previous_i),
+                 map->sizeof_type);
+    tag_set(previous, (struct CCC_Flat_hash_map_tag){TAG_DELETED}, previous_i);
+    --map->migration.count;
+    return new_i;
+}
+
+/** Searches the previous table for the key and, if found, moves it to the
+current table. Returns its index in the current table or a failure status. */
+static CCC_Count
+migrate_key(struct CCC_Flat_hash_map *const map, void const *const key,
+            uint64_t const hash)
 {
-    assert(((map->mask + 1) & map->mask) == 0);
-    size_t const new_pow2_cap
-        = next_power_of_two((map->mask + 1 + to_add) << 1);
-    if (new_pow2_cap < (map->mask + 1))
+    if (!is_migrating(map))
     {
-        return CCC_RESULT_ALLOCATOR_ERROR;
+        return (CCC_Count){.error = CCC_RESULT_FAIL};
     }
-    size_t const prev_bytes = mask_to_total_bytes(map->sizeof_type, map->mask);
-    size_t const total_bytes
-        = mask_to_total_bytes(map->sizeof_type, new_pow2_cap - 1);
-    if (total_bytes < prev_bytes)
+    struct CCC_Flat_hash_map previous = migration_view(map);
+    CCC_Count const found = find_key_or_fail(&previous, key, hash);
+    if (found.error)
     {
-        return CCC_RESULT_ALLOCATOR_ERROR;
+        return found;
     }
-    void *const new_buf = allocate((CCC_Allocator_context){
-        .input = NULL,
-        .bytes = total_bytes,
+    size_t const new_i = migrate_slot(map, &previous, found.count, hash);
+    if (!map->migration.count)
+    {
+        free_migration(map);
+    }
+    return (CCC_Count){.count = new_i};
+}
+
+/** Frees the previous table of an incremental resize without moving any of
+its elements. The caller is responsible for the elements and the counts. */
+static void
+free_migration(struct CCC_Flat_hash_map *const map)
+{
+    if (!is_migrating(map))
+    {
+        return;
+    }
+    (void)map->allocate((CCC_Allocator_context){
+        .input = map->migration.data,
+        .bytes = 0,
         .context = map->context,
+        .old_bytes = mask_to_total_bytes(map->sizeof_type, map->migration.mask,
+                                         map->options, map->group_count),
     });
-    if (!new_buf)
+    map->migration = (struct CCC_Flat_hash_map_migration){};
+}
+
+/** Searches the current table and then the previous table if an incremental
+resize is in progress. Returns the user type or NULL if the key is absent. */
+static void *
+find_in_tables(struct CCC_Flat_hash_map const *const map,
+               void const *const key, uint64_t const hash)
+{
+    CCC_Count i = find_key_or_fail(map, key, hash);
+    if (!i.error)
     {
-        return CCC_RESULT_ALLOCATOR_ERROR;
+        return data_at(map, i.count);
     }
-    struct CCC_Flat_hash_map new_h = *map;
-    new_h.count = 0;
-    new_h.mask = new_pow2_cap - 1;
-    new_h.remain = mask_to_load_factor_cap(new_h.mask);
-    new_h.data = new_buf;
-    /* Our static assertions at start of file guarantee this is correct. */
-    new_h.tag = tag_pos(new_h.sizeof_type, new_buf, new_h.mask);
-    (void)memset(new_h.tag, TAG_EMPTY, mask_to_tag_bytes(new_h.mask));
+    if (!is_migrating(map))
+    {
+        return NULL;
+    }
+    struct CCC_Flat_hash_map const previous = migration_view(map);
+    i = find_key_or_fail(&previous, key, hash);
+    return i.error ? NULL : data_at(&previous, i.count);
+}
+
+/** Returns the next full slot after index i or NULL if i was the last. */
+static void *
+next_full_slot(struct CCC_Flat_hash_map const *const map, size_t const i)
+{
+    size_t const group_count = map->group_count;
+    size_t const aligned_group_start = i & ~((typeof(i))(group_count - 1));
+    struct Match_mask m = match_leading_full(
+        group_load_aligned(&map->tag[aligned_group_start], group_count),
+        i & (group_count - 1));
+    size_t const bit = match_next_one(&m);
+    if (bit != MATCH_NONE)
+    {
+        return data_at(map, aligned_group_start + bit);
+    }
+    return find_first_full_slot(map, aligned_group_start + group_count);
+}
+
+/** Copies every element of source into destination by hash. The destination
+counts are left for the caller to update. */
+static void
+copy_full_slots(struct CCC_Flat_hash_map *const destination,
+                struct CCC_Flat_hash_map const *const source)
+{
+    size_t group_start = 0;
+    struct Match_mask full = {};
+    while ((full = find_first_full_group(source, &group_start)).v)
     {
-        size_t group_start = 0;
-        struct Match_mask full = {};
-        while ((full = find_first_full_group(map, &group_start)).v)
         {
+            size_t tag_i = 0;
+            while ((tag_i = match_next_one(&full)) != MATCH_NONE)
             {
-                size_t tag_i = 0;
-                while ((tag_i = match_next_one(&full)) != GROUP_COUNT)
-                {
-                    tag_i += group_start;
-                    uint64_t const hash = hasher(map, key_at(map, tag_i));
-                    size_t const new_i = find_slot_or_noreturn(&new_h, hash);
-                    tag_set(&new_h, tag_from(hash), new_i);
-                    (void)memcpy(data_at(&new_h, new_i), data_at(map, tag_i),
-                                 new_h.sizeof_type);
-                }
+                tag_i += group_start;
+                uint64_t const hash = slot_hash(source, tag_i);
+                size_t const new_i = find_slot_or_noreturn(destination, hash);
+                tag_set(destination, tag_from(hash), new_i);
+                hash_set(destination, hash, new_i);
+                (void)memcpy(data_at(destination, new_i),
+                             data_at(source, tag_i), destination->sizeof_type);
             }
-            group_start += GROUP_COUNT;
         }
+        group_start += source->group_count;
     }
-    new_h.remain -= map->count;
-    new_h.count = map->count;
-    (void)allocate((CCC_Allocator_context){
-        .input = map->data,
-        .bytes = 0,
-        .context = map->context,
-    });
-    *map = new_h;
-    return CCC_RESULT_OK;
 }
 
 /** Ensures the map is initialized due to our allowance of lazy initialization
@@ -1586,7 +3465,13 @@ check_initialize(struct CCC_Flat_hash_map *const map, size_t required_total_cap,
     }
     if (map->mask)
     {
-        /* A fixed size map that is not initialized. */
+        /* A fixed size map that is not initialized. Its layout was decided
+           at compile time for the group width every processor scans. */
+        assert(map->group_count == GROUP_COUNT);
+        if (unlikely(map->group_count != GROUP_COUNT))
+        {
+            return CCC_RESULT_ARGUMENT_ERROR;
+        }
         if (!map->data || map->mask + 1 < required_total_cap)
         {
             return CCC_RESULT_ALLOCATOR_ERROR;
@@ -1595,19 +3480,25 @@ check_initialize(struct CCC_Flat_hash_map *const map, size_t required_total_cap,
         {
             return CCC_RESULT_ARGUMENT_ERROR;
         }
-        map->tag = tag_pos(map->sizeof_type, map->data, map->mask);
-        (void)memset(map->tag, TAG_EMPTY, mask_to_tag_bytes(map->mask));
+        map->tag = tag_pos(map->sizeof_type, map->data, map->mask,
+                           map->group_count);
+        (void)memset(map->tag, TAG_EMPTY,
+                     mask_to_tag_bytes(map->mask, map->group_count));
     }
     else
     {
-        /* A dynamic map we can re-size as needed. */
-        required_total_cap = max(required_total_cap, GROUP_COUNT);
+        /* A dynamic map we can re-size as needed. Its layout follows the
+           widest group this processor scans, kept for the life of the map. */
+        map->group_count = widest_group_count();
+        required_total_cap = max(required_total_cap, map->group_count);
         size_t const total_bytes
-            = mask_to_total_bytes(map->sizeof_type, required_total_cap - 1);
+            = mask_to_total_bytes(map->sizeof_type, required_total_cap - 1,
+                                  map->options, map->group_count);
         map->data = allocate((CCC_Allocator_context){
             .input = NULL,
             .bytes = total_bytes,
             .context = map->context,
+            .alignment = CCC_PRIVATE_CACHE_LINE_ALIGN,
         });
         if (!map->data)
         {
@@ -1615,8 +3506,10 @@ check_initialize(struct CCC_Flat_hash_map *const map, size_t required_total_cap,
         }
         map->mask = required_total_cap - 1;
         map->remain = mask_to_load_factor_cap(map->mask);
-        map->tag = tag_pos(map->sizeof_type, map->data, map->mask);
-        (void)memset(map->tag, TAG_EMPTY, mask_to_tag_bytes(map->mask));
+        map->tag = tag_pos(map->sizeof_type, map->data, map->mask,
+                           map->group_count);
+        (void)memset(map->tag, TAG_EMPTY,
+                     mask_to_tag_bytes(map->mask, map->group_count));
     }
     return CCC_RESULT_OK;
 }
@@ -1635,19 +3528,87 @@ destory_each(struct CCC_Flat_hash_map *const map,
     }
 }
 
+/** Returns the base of the stored hash array. Only valid if the map stores
+hashes and has been initialized. */
+static inline uint64_t *
+hash_array(struct CCC_Flat_hash_map const *const map)
+{
+    assert(map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    return (uint64_t *)(void *)((char *)map->tag
+                                + mask_to_tag_bytes(map->mask,
+                                                    map->group_count));
+}
+
+/** Returns the full hash of the element at slot i. A stored hash avoids the
+call to the user hash function entirely. */
+static inline uint64_t
+slot_hash(struct CCC_Flat_hash_map const *const map, size_t const i)
+{
+    if (map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+    {
+        return hash_array(map)[i];
+    }
+    return hasher(map, key_at(map, i));
+}
+
+/** Records the full hash for slot i if the map stores hashes. */
+static inline void
+hash_set(struct CCC_Flat_hash_map *const map, uint64_t const hash,
+         size_t const i)
+{
+    if (map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+    {
+        hash_array(map)[i] = hash;
+    }
+}
+
+/** Swaps the stored hashes of slots i and j if the map stores hashes. */
+static inline void
+hash_swap(struct CCC_Flat_hash_map *const map, size_t const i, size_t const j)
+{
+    if (map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+    {
+        uint64_t *const hashes = hash_array(map);
+        uint64_t const tmp = hashes[i];
+        hashes[i] = hashes[j];
+        hashes[j] = tmp;
+    }
+}
+
+/** Every hash the map uses passes through here, including stored hashes, so
+the optional finalizer is applied consistently to all of them. */
 static inline uint64_t
 hasher(struct CCC_Flat_hash_map const *const map, void const *const any_key)
 {
-    return map->hash((CCC_Key_context){
-        .key = any_key,
-        .context = map->context,
-    });
+    return finish_hash(map, map->hash((CCC_Key_context){
+                                .key = any_key,
+                                .context = map->context,
+                            }));
+}
+
+/** Applies any mixing the map performs to a value of the user hash function.
+The result is the hash the map probes and stores. */
+static inline uint64_t
+finish_hash(struct CCC_Flat_hash_map const *const map, uint64_t const hash)
+{
+    if (map->options & CCC_FLAT_HASH_MAP_OPTION_MIX_HASH)
+    {
+        return CCC_private_hash_mix(hash);
+    }
+    return hash;
 }
 
+/** Compares the key to the user type at slot i. If hashes are stored, a full
+hash mismatch rules out equality without calling the user comparison. */
 static inline CCC_Tribool
 is_equal(struct CCC_Flat_hash_map const *const map, void const *const key,
-         size_t const i)
+         uint64_t const hash, size_t const i)
 {
+    if ((map->options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+        && hash_array(map)[i] != hash)
+    {
+        return CCC_FALSE;
+    }
     return map->compare((CCC_Key_comparator_context){
                .key_left = key,
                .type_right = data_at(map, i),
@@ -1739,6 +3700,36 @@ is_power_of_two(size_t const n)
     return n && ((n & (n - 1)) == 0);
 }
 
+/** Returns the widest group this processor scans, limited by the build. The
+result is recorded in a dynamic map when it first allocates and every probe of
+that map follows it. Only x86 offers more than one width. */
+static size_t
+widest_group_count(void)
+{
+#if defined(CCC_HAS_X86_SIMD) && defined(__has_builtin)                        \
+    && __has_builtin(__builtin_cpu_supports)
+    if (CCC_FLAT_HASH_MAP_WIDEST_GROUP >= 64
+        && __builtin_cpu_supports("avx512bw"))
+    {
+        return 64;
+    }
+    if (CCC_FLAT_HASH_MAP_WIDEST_GROUP >= 32 && __builtin_cpu_supports("avx2"))
+    {
+        return 32;
+    }
+#endif /* defined(CCC_HAS_X86_SIMD) && defined(__has_builtin) && ... */
+    return GROUP_COUNT;
+}
+
+/** Returns true if this processor scans groups of the given width, a power of
+two from the fixed size map width up to the widest the processor supports. */
+static CCC_Tribool
+group_count_supported(size_t const group_count)
+{
+    return group_count >= GROUP_COUNT && group_count <= widest_group_count()
+        && is_power_of_two(group_count);
+}
+
 /** Returns the total bytes used by the map in the contiguous allocation. This
 includes the bytes for the user data array (swap slot included) and the tag
 array. The tag array also has an duplicate group at the end that must be
@@ -1752,15 +3743,20 @@ This number of bytes should be consistently correct whether the map we are
 dealing with is fixed size or dynamic. A fixed size map could technically have
 more bytes as padding after the tag array but we never need or access those
 bytes so we are only interested in contiguous bytes from start of user data to
-last byte of tag array. */
+last byte of tag array. The group count is the width the map scans, which
+sizes both the padding and the duplicate group. */
 static inline size_t
-mask_to_total_bytes(size_t const sizeof_type, size_t const mask)
+mask_to_total_bytes(size_t const sizeof_type, size_t const mask,
+                    enum CCC_Flat_hash_map_option const options,
+                    size_t const group_count)
 {
     if (unlikely(!mask))
     {
         return 0;
     }
-    return mask_to_data_bytes(sizeof_type, mask) + mask_to_tag_bytes(mask);
+    return mask_to_data_bytes(sizeof_type, mask, group_count)
+         + mask_to_tag_bytes(mask, group_count)
+         + mask_to_hash_bytes(mask, options);
 }
 
 /** Returns the bytes needed for the tag metadata array. This includes the
@@ -1768,10 +3764,23 @@ bytes for the duplicate group that is at the end of the tag array.
 
 Assumes the mask is non-zero. */
 static inline size_t
-mask_to_tag_bytes(size_t const mask)
+mask_to_tag_bytes(size_t const mask, size_t const group_count)
 {
     static_assert(sizeof(struct CCC_Flat_hash_map_tag) == sizeof(uint8_t));
-    return mask + 1 + GROUP_COUNT;
+    return mask + 1 + group_count;
+}
+
+/** Returns the bytes needed for the stored hash array or 0 if the map does not
+store hashes. The array follows the replica group with no padding.
+
+Assumes the mask is non-zero. */
+static inline size_t
+mask_to_hash_bytes(size_t const mask,
+                   enum CCC_Flat_hash_map_option const options)
+{
+    return (options & CCC_FLAT_HASH_MAP_OPTION_STORE_HASH)
+             ? (mask + 1) * sizeof(uint64_t)
+             : 0;
 }
 
 /** Returns the capacity count that is available with a current load factor of
@@ -1798,11 +3807,12 @@ the correct number of aligned user data bytes. This allows aligned group loads.
 
 Assumes the mask is non-zero. */
 static inline size_t
-mask_to_data_bytes(size_t const sizeof_type, size_t const mask)
+mask_to_data_bytes(size_t const sizeof_type, size_t const mask,
+                   size_t const group_count)
 {
     /* Add two because there is always a bonus user data type at the 0th index
        of the data array for swapping purposes. */
-    return roundup(sizeof_type * (mask + 2));
+    return roundup(sizeof_type * (mask + 2), group_count);
 }
 
 /** Returns the correct position of the start of the tag array given the base
@@ -1810,12 +3820,14 @@ of the data array. This position is determined by the size of the type in the
 data array and the current mask being used for the hash map to which the data
 belongs. */
 static inline struct CCC_Flat_hash_map_tag *
-tag_pos(size_t const sizeof_type, void const *const data, size_t const mask)
+tag_pos(size_t const sizeof_type, void const *const data, size_t const mask,
+        size_t const group_count)
 {
     /* Static assertions at top of file ensure this is correct. */
     return (struct CCC_Flat_hash_map_tag *)((char *)data
-                                            + mask_to_data_bytes(sizeof_type,
-                                                                 mask));
+                                            + mask_to_data_bytes(
+                                                sizeof_type, mask,
+                                                group_count));
 }
 
 static inline size_t
@@ -1824,17 +3836,23 @@ max(size_t const a, size_t const b)
     return a > b ? a : b;
 }
 
+static inline size_t
+min(size_t const a, size_t const b)
+{
+    return a < b ? a : b;
+}
+
 static inline CCC_Tribool
 is_uninitialized(struct CCC_Flat_hash_map const *const map)
 {
     return !map->data || !map->tag;
 }
 
-/** Rounds up the provided bytes to a valid alignment for group size. */
+/** Rounds up the provided bytes to a valid alignment for the group size. */
 static inline size_t
-roundup(size_t const bytes)
+roundup(size_t const bytes, size_t const group_count)
 {
-    return (bytes + GROUP_COUNT - 1) & ~(GROUP_COUNT - 1);
+    return (bytes + group_count - 1) & ~(group_count - 1);
 }
 
 /*=====================   Intrinsics and Generics   =========================*/
@@ -1857,7 +3875,8 @@ static inline void
 tag_set(struct CCC_Flat_hash_map *const map,
         struct CCC_Flat_hash_map_tag const m, size_t const i)
 {
-    size_t const replica_byte = ((i - GROUP_COUNT) & map->mask) + GROUP_COUNT;
+    size_t const replica_byte
+        = ((i - map->group_count) & map->mask) + map->group_count;
     map->tag[i] = m;
     map->tag[replica_byte] = m;
 }
@@ -1890,6 +3909,18 @@ tag_from(uint64_t const hash)
 
 /*========================  Index Mask Implementations   ====================*/
 
+/** Returns the number of on indices in the mask. */
+static inline size_t
+match_count(struct Match_mask m)
+{
+    size_t n = 0;
+    while (match_next_one(&m) != MATCH_NONE)
+    {
+        ++n;
+    }
+    return n;
+}
+
 /** Returns true if any index is on in the mask otherwise false. */
 static inline CCC_Tribool
 match_has_one(struct Match_mask const m)
@@ -1898,10 +3929,10 @@ match_has_one(struct Match_mask const m)
 }
 
 /** Return the index of the first trailing one in the given match in the
-range `[0, GROUP_COUNT]` to indicate a positive result of a
+range `[0, MATCH_NONE]` to indicate a positive result of a
 group query operation. This index represents the group member with a tag that
 has matched. Because 0 is a valid index the user must check the index against
-`GROUP_COUNT`, which means no trailing one is found. */
+`MATCH_NONE`, which means no trailing one is found. */
 static inline size_t
 match_trailing_one(struct Match_mask const m)
 {
@@ -1911,7 +3942,7 @@ match_trailing_one(struct Match_mask const m)
 /** A function to aid in iterating over on bits/indices in a match. The
 function returns the 0-based index of the current on index and then adjusts the
 mask appropriately for future iteration by removing the lowest on index bit. If
-no bits are found the width of the mask is returned. */
+no bits are found MATCH_NONE is returned. */
 static inline size_t
 match_next_one(struct Match_mask *const m)
 {
@@ -1921,12 +3952,12 @@ match_next_one(struct Match_mask *const m)
     return index;
 }
 
-/** Counts the leading zeros in a match. Leading zeros are those starting
-at the most significant bit. */
+/** Counts the leading zeros in a match of a group of count tags. Leading
+zeros are those starting at the most significant tag of the group. */
 static inline size_t
-match_leading_zeros(struct Match_mask const m)
+match_leading_zeros(struct Match_mask const m, size_t const count)
 {
-    return count_leading_zeros(m);
+    return count_leading_zeros(m, count);
 }
 
 /** Counts the trailing zeros in a match. Trailing zeros are those
@@ -1941,10 +3972,11 @@ match_trailing_zeros(struct Match_mask const m)
 will need to vary based on availability of vectorized instructions. */
 #ifdef CCC_HAS_X86_SIMD
 
-/*=========================   Match SIMD Matching    ========================*/
+/*=========================   Group Width Kernels   ========================*/
 
-/** Returns a match with a bit on if the tag at that index in group g
-matches the provided tag m. If no indices matched this will be a 0 match.
+/** Returns a mask with a bit on if the tag at that index in the 16 tags
+starting at tag matches the provided tag m. If no indices matched this will be
+a 0 mask.
 
 Here is the process to help understand the dense intrinsics.
 
@@ -1952,7 +3984,7 @@ Here is the process to help understand the dense intrinsics.
 
 0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73
 
-2. g holds 16 tags from tag array. Find matches (_mm_cmpeq_epi8).
+2. Load 16 tags from tag array. Find matches (_mm_cmpeq_epi8).
 
 0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73|0x73
 0x79|0x33|0x21|0x73|0x45|0x55|0x12|0x54|0x11|0x44|0x73|0xFF|0xFF|0xFF|0xFF|0xFF
@@ -1966,9 +3998,106 @@ Here is the process to help understand the dense intrinsics.
      │      ┌──────────────────────────────────────┘
 0x0001000000100000
 
-4. Return the result as a match.
+4. Return the result as a mask.
+
+The AVX2 version is the same process over 32 tags and a 32 bit result. The
+AVX-512BW version skips step 3 because the comparison already writes one bit
+per byte into a 64 bit mask register.
+
+Groups are loaded with the unaligned instructions at every width. Probes start
+at any slot and on aligned addresses the unaligned instructions run at the same
+speed as the aligned ones. SSE2 is part of x86-64 so these kernels may be
+inlined. The wider kernels are compiled for their extension alone and only
+called once the processor has reported it. */
+static inline uint64_t
+sse2_match_tag(struct CCC_Flat_hash_map_tag const *const tag, uint8_t const m)
+{
+    return (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+        _mm_loadu_si128((__m128i const *)tag), _mm_set1_epi8((char)m)));
+}
+
+/** Returns a mask with a bit on for every special constant among 16 tags.
+These are the tags with the most significant bit on. */
+static inline uint64_t
+sse2_match_constant(struct CCC_Flat_hash_map_tag const *const tag)
+{
+    return (uint16_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)tag));
+}
+
+/** Rewrites 16 tags so constants become empty and full tags become deleted.
+A constant is negative as a signed byte so the comparison against zero yields
+all bits on for it, which is empty, and nothing for a full tag, which then
+becomes the deleted bit alone. */
+static inline void
+sse2_constant_to_empty_full_to_deleted(struct CCC_Flat_hash_map_tag *const tag)
+{
+    __m128i const g = _mm_loadu_si128((__m128i const *)tag);
+    _mm_storeu_si128((__m128i *)tag,
+                     _mm_or_si128(_mm_cmpgt_epi8(_mm_setzero_si128(), g),
+                                  _mm_set1_epi8((char)TAG_DELETED)));
+}
+
+/** The 32 tag version of the SSE2 tag match. */
+[[gnu::target("avx2")]] static uint64_t
+avx2_match_tag(struct CCC_Flat_hash_map_tag const *const tag, uint8_t const m)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+        _mm256_loadu_si256((__m256i const *)tag), _mm256_set1_epi8((char)m)));
+}
+
+/** The 32 tag version of the SSE2 constant match. */
+[[gnu::target("avx2")]] static uint64_t
+avx2_match_constant(struct CCC_Flat_hash_map_tag const *const tag)
+{
+    return (uint32_t)_mm256_movemask_epi8(
+        _mm256_loadu_si256((__m256i const *)tag));
+}
+
+/** The 32 tag version of the SSE2 constant and full rewrite. */
+[[gnu::target("avx2")]] static void
+avx2_constant_to_empty_full_to_deleted(struct CCC_Flat_hash_map_tag *const tag)
+{
+    __m256i const g = _mm256_loadu_si256((__m256i const *)tag);
+    _mm256_storeu_si256(
+        (__m256i *)tag,
+        _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), g),
+                        _mm256_set1_epi8((char)TAG_DELETED)));
+}
+
+/** The 64 tag version of the SSE2 tag match. The comparison writes the mask
+directly. */
+[[gnu::target("avx512bw")]] static uint64_t
+avx512_match_tag(struct CCC_Flat_hash_map_tag const *const tag, uint8_t const m)
+{
+    return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((void const *)tag),
+                                  _mm512_set1_epi8((char)m));
+}
+
+/** The 64 tag version of the SSE2 constant match. */
+[[gnu::target("avx512bw")]] static uint64_t
+avx512_match_constant(struct CCC_Flat_hash_map_tag const *const tag)
+{
+    return _mm512_movepi8_mask(_mm512_loadu_si512((void const *)tag));
+}
+
+/** The constant and full rewrite over 64 tags. The constant mask selects
+empty for those lanes and deleted for every full lane. */
+[[gnu::target("avx512bw")]] static void
+avx512_constant_to_empty_full_to_deleted(
+    struct CCC_Flat_hash_map_tag *const tag)
+{
+    _mm512_storeu_si512(
+        (void *)tag,
+        _mm512_mask_blend_epi8(
+            _mm512_movepi8_mask(_mm512_loadu_si512((void const *)tag)),
+            _mm512_set1_epi8((char)TAG_DELETED),
+            _mm512_set1_epi8((char)TAG_EMPTY)));
+}
+
+/*=========================   Match SIMD Matching    ========================*/
 
-(struct Match_mask){0x0001000000100000}
+/** Returns a match with a bit on if the tag at that index in group g
+matches the provided tag m. If no indices matched this will be a 0 match.
 
 With a good hash function it is very likely that the first match will be the
 hashed data and the full comparison will evaluate to true. Note that this
@@ -1977,9 +4106,15 @@ match so an efficient comparison is beneficial. */
 static inline struct Match_mask
 match_tag(struct Group const g, struct CCC_Flat_hash_map_tag const m)
 {
-    return (struct Match_mask){
-        _mm_movemask_epi8(_mm_cmpeq_epi8(g.v, _mm_set1_epi8((int8_t)m.v))),
-    };
+    switch (g.count)
+    {
+        case 64:
+            return (struct Match_mask){avx512_match_tag(g.tag, m.v)};
+        case 32:
+            return (struct Match_mask){avx2_match_tag(g.tag, m.v)};
+        default:
+            return (struct Match_mask){sse2_match_tag(g.tag, m.v)};
+    }
 }
 
 /** Returns 0 based match with every bit on representing those tags in
@@ -2007,67 +4142,70 @@ bit on. */
 static inline struct Match_mask
 match_empty_deleted(struct Group const g)
 {
-    static_assert(sizeof(int) >= sizeof(uint16_t));
-    return (struct Match_mask){_mm_movemask_epi8(g.v)};
+    switch (g.count)
+    {
+        case 64:
+            return (struct Match_mask){avx512_match_constant(g.tag)};
+        case 32:
+            return (struct Match_mask){avx2_match_constant(g.tag)};
+        default:
+            return (struct Match_mask){sse2_match_constant(g.tag)};
+    }
 }
 
 /** Returns a 0 based match with every bit on representing those tags in the
 group that are occupied by a hashed value. These are those tags that have the
-most significant bit off and the lower 7 bits occupied by user hash. */
+most significant bit off and the lower 7 bits occupied by user hash. Bits past
+the width of the group stay off. */
 static inline struct Match_mask
 match_full(struct Group const g)
 {
-    return (struct Match_mask){~match_empty_deleted(g).v};
+    return (struct Match_mask){~match_empty_deleted(g).v
+                               & (UINT64_MAX >> (GROUP_COUNT_MAX - g.count))};
 }
 
 /** Matches all full tag slots into a mask excluding the starting position and
 only considering the leading full slots from this position. Assumes start bit
 is 0 indexed such that only the exclusive range of leading bits is considered
-(start_tag, GROUP_COUNT). All trailing bits in the inclusive
+(start_tag, group width). All trailing bits in the inclusive
 range from [0, start_tag] are zeroed out in the mask.
 
 Assumes start tag is less than group size. */
 static inline struct Match_mask
 match_leading_full(struct Group const g, size_t const start_tag)
 {
-    assert(start_tag < GROUP_COUNT);
-    return (struct Match_mask){(~match_empty_deleted(g).v)
+    assert(start_tag < g.count);
+    return (struct Match_mask){match_full(g).v
                                & (MATCH_MASK_0TH_TAG_OFF << start_tag)};
 }
 
 /*=========================  Group Implementations   ========================*/
 
-/** Loads a group starting at source into a 128 bit vector. This is a aligned
-load and the user must ensure the load will not go off then end of the tag
-array. */
+/** Returns the group of count tags starting at source. The tags are read when
+the group is matched so they must not change in between. The user must ensure
+the group will not go off the end of the tag array. */
 static inline struct Group
-group_load_aligned(struct CCC_Flat_hash_map_tag const *const source)
-{
-    return (struct Group){_mm_load_si128((__m128i *)source)};
-}
-
-/** Stores the source group to destination. The store is aligned and the user
-must ensure the store will not go off the end of the tag array. */
-static inline void
-group_store_aligned(struct CCC_Flat_hash_map_tag *const destination,
-                    struct Group const source)
+group_load_aligned(struct CCC_Flat_hash_map_tag const *const source,
+                   size_t const count)
 {
-    _mm_store_si128((__m128i *)destination, source.v);
+    assert(((uintptr_t)source & (GROUP_COUNT - 1)) == 0);
+    return (struct Group){source, count};
 }
 
-/** Loads a group starting at source into a 128 bit vector. This is an unaligned
-load and the user must ensure the load will not go off then end of the tag
-array. */
+/** Returns the group of count tags starting at source, which may be any slot.
+The user must ensure the group will not go off the end of the tag array. */
 static inline struct Group
-group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source)
+group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source,
+                     size_t const count)
 {
-    return (struct Group){_mm_loadu_si128((__m128i *)source)};
+    return (struct Group){source, count};
 }
 
 /** Converts the empty and deleted constants all TAG_EMPTY and the full tags
-representing hashed user data TAG_DELETED. This will result in the hashed
-fingerprint lower 7 bits of the user data being lost, so a rehash will be
-required for the data corresponding to this slot.
+representing hashed user data TAG_DELETED in the group of count tags starting
+at tag. This will result in the hashed fingerprint lower 7 bits of the user
+data being lost, so a rehash will be required for the data corresponding to
+this slot.
 
 For example, both of the special constant tags will be converted as follows.
 
@@ -2080,14 +4218,22 @@ TAG_FULL = 0b0101_1101 -> 0b1000_000
 
 The hashed bits are lost because the full slot has the high bit off and
 therefore is not a match for the constants mask. */
-static inline struct Group
-group_constant_to_empty_full_to_deleted(struct Group const g)
+static inline void
+group_constant_to_empty_full_to_deleted(struct CCC_Flat_hash_map_tag *const tag,
+                                        size_t const count)
 {
-    __m128i const zero = _mm_setzero_si128();
-    __m128i const match_mask_constants = _mm_cmpgt_epi8(zero, g.v);
-    return (struct Group){
-        _mm_or_si128(match_mask_constants, _mm_set1_epi8((int8_t)TAG_DELETED)),
-    };
+    switch (count)
+    {
+        case 64:
+            avx512_constant_to_empty_full_to_deleted(tag);
+            break;
+        case 32:
+            avx2_constant_to_empty_full_to_deleted(tag);
+            break;
+        default:
+            sse2_constant_to_empty_full_to_deleted(tag);
+            break;
+    }
 }
 
 #elifdef CCC_HAS_ARM_SIMD
@@ -2206,26 +4352,21 @@ match_leading_full(struct Group const g, size_t const start_tag)
 aligned load and the user must ensure the load will not go off then end of the
 tag array. */
 static inline struct Group
-group_load_aligned(struct CCC_Flat_hash_map_tag const *const source)
+group_load_aligned(struct CCC_Flat_hash_map_tag const *const source,
+                   [[maybe_unused]] size_t const count)
 {
+    assert(count == GROUP_COUNT);
     return (struct Group){vld1_u8(&source->v)};
 }
 
-/** Stores the source group to destination. The store is aligned and the user
-must ensure the store will not go off the end of the tag array. */
-static inline void
-group_store_aligned(struct CCC_Flat_hash_map_tag *const destination,
-                    struct Group const source)
-{
-    vst1_u8(&destination->v, source.v);
-}
-
 /** Loads a group starting at source into a 8x8 (64) bit vector. This is an
 unaligned load and the user must ensure the load will not go off then end of the
 tag array. */
 static inline struct Group
-group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source)
+group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source,
+                     [[maybe_unused]] size_t const count)
 {
+    assert(count == GROUP_COUNT);
     return (struct Group){vld1_u8(&source->v)};
 }
 
@@ -2245,11 +4386,13 @@ TAG_FULL = 0b0101_1101 -> 0b1000_000
 
 The hashed bits are lost because the full slot has the high bit off and
 therefore is not a match for the constants mask. */
-static inline struct Group
-group_constant_to_empty_full_to_deleted(struct Group const g)
+static inline void
+group_constant_to_empty_full_to_deleted(struct CCC_Flat_hash_map_tag *const tag,
+                                        [[maybe_unused]] size_t const count)
 {
-    uint8x8_t const constant = vcltz_s8(vreinterpret_s8_u8(g.v));
-    return (struct Group){vorr_u8(constant, vdup_n_u8(TAG_MSB))};
+    assert(count == GROUP_COUNT);
+    uint8x8_t const constant = vcltz_s8(vreinterpret_s8_u8(vld1_u8(&tag->v)));
+    vst1_u8(&tag->v, vorr_u8(constant, vdup_n_u8(TAG_MSB)));
 }
 
 #else /* FALLBACK PORTABLE IMPLEMENTATION */
@@ -2418,25 +4561,21 @@ match_leading_full(struct Group const g, size_t const start_tag)
 
 /** Loads tags into a group without violating strict aliasing. */
 static inline struct Group
-group_load_aligned(struct CCC_Flat_hash_map_tag const *const source)
+group_load_aligned(struct CCC_Flat_hash_map_tag const *const source,
+                   [[maybe_unused]] size_t const count)
 {
+    assert(count == GROUP_COUNT);
     struct Group g;
     (void)memcpy(&g, source, sizeof(g));
     return g;
 }
 
-/** Stores a group back into the tag array without violating strict aliasing. */
-static inline void
-group_store_aligned(struct CCC_Flat_hash_map_tag *const destination,
-                    struct Group const source)
-{
-    (void)memcpy(destination, &source, sizeof(source));
-}
-
 /** Loads tags into a group without violating strict aliasing. */
 static inline struct Group
-group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source)
+group_load_unaligned(struct CCC_Flat_hash_map_tag const *const source,
+                     [[maybe_unused]] size_t const count)
 {
+    assert(count == GROUP_COUNT);
     struct Group g;
     (void)memcpy(&g, source, sizeof(g));
     return g;
@@ -2457,13 +4596,18 @@ The full tags with hashed user data will be converted as follows.
 TAG_FULL = 0b0101_1101 -> 0b1000_000
 
 The hashed bits are lost because the full slot has the high bit off and
-therefore is not a match for the constants mask. */
-static inline struct Group
-group_constant_to_empty_full_to_deleted(struct Group g)
+therefore is not a match for the constants mask. The group is read and
+written without violating strict aliasing. */
+static inline void
+group_constant_to_empty_full_to_deleted(struct CCC_Flat_hash_map_tag *const tag,
+                                        [[maybe_unused]] size_t const count)
 {
+    assert(count == GROUP_COUNT);
+    struct Group g;
+    (void)memcpy(&g, tag, sizeof(g));
     g.v = ~g.v & MATCH_MASK_TAGS_MSBS;
     g.v = ~g.v + (g.v >> (TAG_BITS - 1));
-    return g;
+    (void)memcpy(tag, &g, sizeof(g));
 }
 
 #endif /* defined(CCC_HAS_X86_SIMD) */
@@ -2478,33 +4622,34 @@ built-ins first and then falls back to manual bit counting. */
 
 #ifdef CCC_HAS_X86_SIMD
 
-#    if defined(__has_builtin) && __has_builtin(__builtin_ctz)                 \
-        && __has_builtin(__builtin_clz) && __has_builtin(__builtin_clzl)
+#    if defined(__has_builtin) && __has_builtin(__builtin_ctzll)               \
+        && __has_builtin(__builtin_clzll) && __has_builtin(__builtin_clzl)
 
 static_assert(
-    sizeof((struct Match_mask){}.v) <= sizeof(unsigned),
-    "a struct Match_mask is expected to be smaller than an unsigned due to "
-    "available builtins on the given platform.");
+    sizeof((struct Match_mask){}.v) <= sizeof(unsigned long long),
+    "a struct Match_mask is expected to be no wider than an unsigned long "
+    "long due to available builtins on the given platform.");
 
 static inline unsigned
 count_trailing_zeros(struct Match_mask const m)
 {
     static_assert(
-        __builtin_ctz(0x8000) == GROUP_COUNT - 1,
+        __builtin_ctzll(MATCH_MASK_MSB) == GROUP_COUNT_MAX - 1,
         "Counting trailing zeros will always result in a valid mask "
         "based on struct Match_mask width if the mask is not 0, even though "
-        "m is implicitly widened to an int.");
-    return m.v ? __builtin_ctz(m.v) : GROUP_COUNT;
+        "m is implicitly widened to an unsigned long long.");
+    return m.v ? __builtin_ctzll(m.v) : MATCH_NONE;
 }
 
 static inline unsigned
-count_leading_zeros(struct Match_mask const m)
-{
-    static_assert(
-        sizeof((struct Match_mask){}.v) * 2UL == sizeof(unsigned),
-        "a struct Match_mask will be implicitly widened to exactly twice "
-        "its width if non-zero due to builtin functions available.");
-    return m.v ? __builtin_clz(((unsigned)m.v) << GROUP_COUNT) : GROUP_COUNT;
+count_leading_zeros(struct Match_mask const m, size_t const count)
+{
+    /* The group occupies the low count bits so shift it into the most
+       significant bits before counting. The shift is 0 for AVX-512. */
+    return m.v ? __builtin_clzll((unsigned long long)m.v
+                                 << ((sizeof(unsigned long long) * CHAR_BIT)
+                                     - count))
+               : MATCH_NONE;
 }
 
 static inline unsigned
@@ -2516,8 +4661,8 @@ count_leading_zeros_size_t(size_t const n)
     return n ? __builtin_clzl(n) : sizeof(size_t) * CHAR_BIT;
 }
 
-#    else /* !defined(__has_builtin) || !__has_builtin(__builtin_ctz)          \
-        || !__has_builtin(__builtin_clz) || !__has_builtin(__builtin_clzl) */
+#    else /* !defined(__has_builtin) || !__has_builtin(__builtin_ctzll)        \
+        || !__has_builtin(__builtin_clzll) || !__has_builtin(__builtin_clzl) */
 
 enum : size_t
 {
@@ -2530,7 +4675,7 @@ count_trailing_zeros(struct Match_mask m)
 {
     if (!m.v)
     {
-        return GROUP_COUNT;
+        return MATCH_NONE;
     }
     unsigned cnt = 0;
     for (; m.v; cnt += ((m.v & 1U) == 0), m.v >>= 1U)
@@ -2539,17 +4684,16 @@ count_trailing_zeros(struct Match_mask m)
 }
 
 static inline unsigned
-count_leading_zeros(struct Match_mask m)
+count_leading_zeros(struct Match_mask m, size_t const count)
 {
     if (!m.v)
     {
-        return GROUP_COUNT;
+        return MATCH_NONE;
     }
-    unsigned mv = (unsigned)m.v << GROUP_COUNT;
     unsigned cnt = 0;
-    for (; (mv & (MATCH_MASK_MSB << GROUP_COUNT)) == 0; ++cnt, mv <<= 1U)
+    for (; (m.v & MATCH_MASK_MSB) == 0; ++cnt, m.v <<= 1U)
     {}
-    return cnt;
+    return cnt - (GROUP_COUNT_MAX - count);
 }
 
 static inline unsigned
@@ -2565,8 +4709,8 @@ count_leading_zeros_size_t(size_t n)
     return cnt;
 }
 
-#    endif /* defined(__has_builtin) && __has_builtin(__builtin_ctz)           \
-        && __has_builtin(__builtin_clz) && __has_builtin(__builtin_clzl) */
+#    endif /* defined(__has_builtin) && __has_builtin(__builtin_ctzll)         \
+        && __has_builtin(__builtin_clzll) && __has_builtin(__builtin_clzl) */
 
 #else /* NEON and PORTABLE implementation count bits the same way. */
 
@@ -2588,7 +4732,8 @@ count_trailing_zeros(struct Match_mask const m)
 }
 
 static inline unsigned
-count_leading_zeros(struct Match_mask const m)
+count_leading_zeros(struct Match_mask const m,
+                    [[maybe_unused]] size_t const count)
 {
     static_assert(__builtin_clzl((typeof((struct Match_mask){}.v))0x1)
                           / GROUP_COUNT
@@ -2628,7 +4773,7 @@ count_trailing_zeros(struct Match_mask m)
 }
 
 static inline unsigned
-count_leading_zeros(struct Match_mask m)
+count_leading_zeros(struct Match_mask m, [[maybe_unused]] size_t const count)
 {
     if (!m.v)
     {
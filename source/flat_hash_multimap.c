@@ -0,0 +1,242 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a flat hash multimap over the flat hash map table. The
+probing, tag matching, and resizing are those of the flat hash map. Only the
+operations that must see every element with a key, or that must not look for
+one before inserting, reach into the flat hash map through its private
+interface. Rehashing already places elements without comparing keys so
+duplicates survive any resize. */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flat_hash_map.h"
+#include "flat_hash_multimap.h"
+#include "private/private_flat_hash_map.h"
+#include "private/private_flat_hash_multimap.h"
+#include "types.h"
+
+/*===========================   Interface   =================================*/
+
+CCC_Result
+CCC_flat_hash_multimap_reserve(CCC_Flat_hash_multimap *const map,
+                               size_t const to_add,
+                               CCC_Allocator *const allocate)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return CCC_flat_hash_map_reserve(&map->map, to_add, allocate);
+}
+
+CCC_Tribool
+CCC_flat_hash_multimap_contains(CCC_Flat_hash_multimap const *const map,
+                                void const *const key)
+{
+    if (!map || !key)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return CCC_flat_hash_map_contains(&map->map, key);
+}
+
+void *
+CCC_flat_hash_multimap_get_key_value(CCC_Flat_hash_multimap const *const map,
+                                     void const *const key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_get_key_value(&map->map, key);
+}
+
+CCC_Count
+CCC_flat_hash_multimap_count_key(CCC_Flat_hash_multimap const *const map,
+                                 void const *const key)
+{
+    return CCC_flat_hash_multimap_equal_range(map, key, NULL, 0);
+}
+
+CCC_Count
+CCC_flat_hash_multimap_equal_range(CCC_Flat_hash_multimap const *const map,
+                                   void const *const key, void *range[],
+                                   size_t const range_capacity)
+{
+    if (!map || !key || (!range && range_capacity))
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){
+        .count = CCC_private_flat_hash_map_find_matches(
+            &map->map, key, CCC_private_flat_hash_map_hash(&map->map, key),
+            range, range_capacity),
+    };
+}
+
+CCC_Entry
+CCC_flat_hash_multimap_insert(CCC_Flat_hash_multimap *const map,
+                              void const *const type)
+{
+    if (!map || !type)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void *const inserted = CCC_private_flat_hash_map_insert_duplicate(
+        &map->map, type,
+        CCC_private_flat_hash_map_hash(
+            &map->map, (char const *)type + map->map.key_offset));
+    if (!inserted)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
+}
+
+CCC_Entry
+CCC_flat_hash_multimap_remove_key_value(CCC_Flat_hash_multimap *const map,
+                                        void *const type_output)
+{
+    if (!map || !type_output)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    return CCC_flat_hash_map_remove_key_value(&map->map, type_output);
+}
+
+CCC_Count
+CCC_flat_hash_multimap_remove_all(CCC_Flat_hash_multimap *const map,
+                                  void const *const key,
+                                  CCC_Type_destructor *const destroy)
+{
+    if (!map || !key)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){
+        .count = CCC_private_flat_hash_map_erase_matches(
+            &map->map, key, CCC_private_flat_hash_map_hash(&map->map, key),
+            destroy),
+    };
+}
+
+void *
+CCC_flat_hash_multimap_begin(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_begin(&map->map);
+}
+
+void *
+CCC_flat_hash_multimap_next(CCC_Flat_hash_multimap const *const map,
+                            void const *const type_iterator)
+{
+    if (!map)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_next(&map->map, type_iterator);
+}
+
+void *
+CCC_flat_hash_multimap_end(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_end(&map->map);
+}
+
+CCC_Count
+CCC_flat_hash_multimap_count(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return CCC_flat_hash_map_count(&map->map);
+}
+
+CCC_Count
+CCC_flat_hash_multimap_capacity(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return CCC_flat_hash_map_capacity(&map->map);
+}
+
+CCC_Tribool
+CCC_flat_hash_multimap_is_empty(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return CCC_flat_hash_map_is_empty(&map->map);
+}
+
+CCC_Tribool
+CCC_flat_hash_multimap_validate(CCC_Flat_hash_multimap const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return CCC_flat_hash_map_validate(&map->map);
+}
+
+CCC_Result
+CCC_flat_hash_multimap_clear(CCC_Flat_hash_multimap *const map,
+                             CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return CCC_flat_hash_map_clear(&map->map, destroy);
+}
+
+CCC_Result
+CCC_flat_hash_multimap_clear_and_free(CCC_Flat_hash_multimap *const map,
+                                      CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return CCC_flat_hash_map_clear_and_free(&map->map, destroy);
+}
+
+CCC_Result
+CCC_flat_hash_multimap_clear_and_free_reserve(
+    CCC_Flat_hash_multimap *const map, CCC_Type_destructor *const destroy,
+    CCC_Allocator *const allocate)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    return CCC_flat_hash_map_clear_and_free_reserve(&map->map, destroy,
+                                                    allocate);
+}
@@ -0,0 +1,251 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements seeded hash functions based on Wang Yi's wyhash, which is
+released into the public domain, and in the style of its descendant rapidhash.
+The stages and constants follow the final version of wyhash.
+
+wyhash: https://github.com/wangyi-fudan/wyhash
+rapidhash: https://github.com/Nicoshev/rapidhash
+
+The core operation is the multiply fold: two 64 bit words are multiplied into
+a 128 bit product and the high and low halves are combined. One multiply fold
+mixes every input bit into the middle of the product so only a handful are
+needed per 16 bytes of input. Long inputs are split across three independent
+lanes per 48 byte block so the multiplications of a block do not wait on one
+another. The final fold is applied to the last 16 bytes of input, read with
+possibly overlapping loads, so there is no byte by byte tail loop. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash.h"
+#include "private/private_hash.h"
+#include "types.h"
+
+/*=========================   Constants   ===================================*/
+
+/** @internal Odd constants with an even mix of set bits used to separate the
+lanes and stages of the hash. */
+enum : uint64_t
+{
+    SECRET_0 = 0x2D358DCCAA6C78A5,
+    SECRET_1 = 0x8BB84B93962EACC9,
+    SECRET_2 = 0x4B33A62ED433D4A3,
+    SECRET_3 = 0x4D5A2DA51DE1AA47,
+};
+
+/** @internal Sizes of the stages of the byte hash. */
+enum : size_t
+{
+    /** Inputs up to this length are read with at most four 4 byte loads. */
+    SHORT_INPUT = 16,
+    /** Inputs longer than this use the three lane loop. */
+    LANE_BLOCK = 48,
+};
+
+/*=========================   Prototypes   ==================================*/
+
+static void multiply(uint64_t *, uint64_t *);
+static uint64_t multiply_fold(uint64_t, uint64_t);
+static uint64_t read_8(unsigned char const *);
+static uint64_t read_4(unsigned char const *);
+static uint64_t read_1_to_3(unsigned char const *, size_t);
+
+/*=========================   Interface   ===================================*/
+
+uint64_t
+CCC_hash_bytes(void const *const bytes, size_t count, uint64_t seed)
+{
+    if (!bytes)
+    {
+        count = 0;
+    }
+    unsigned char const *p = bytes;
+    size_t const length = count;
+    seed ^= multiply_fold(seed ^ SECRET_0, SECRET_1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (count <= SHORT_INPUT)
+    {
+        if (count >= 4)
+        {
+            /* Two pairs of possibly overlapping loads cover 4 to 16 bytes. */
+            size_t const mid = (count >> 3) << 2;
+            a = (read_4(p) << 32) | read_4(p + mid);
+            b = (read_4(p + count - 4) << 32) | read_4(p + count - 4 - mid);
+        }
+        else if (count)
+        {
+            a = read_1_to_3(p, count);
+        }
+    }
+    else
+    {
+        if (count > LANE_BLOCK)
+        {
+            uint64_t lane_1 = seed;
+            uint64_t lane_2 = seed;
+            do
+            {
+                seed
+                    = multiply_fold(read_8(p) ^ SECRET_1, read_8(p + 8) ^ seed);
+                lane_1 = multiply_fold(read_8(p + 16) ^ SECRET_2,
+                                       read_8(p + 24) ^ lane_1);
+                lane_2 = multiply_fold(read_8(p + 32) ^ SECRET_3,
+                                       read_8(p + 40) ^ lane_2);
+                p += LANE_BLOCK;
+                count -= LANE_BLOCK;
+            }
+            while (count > LANE_BLOCK);
+            seed ^= lane_1 ^ lane_2;
+        }
+        while (count > SHORT_INPUT)
+        {
+            seed = multiply_fold(read_8(p) ^ SECRET_1, read_8(p + 8) ^ seed);
+            p += SHORT_INPUT;
+            count -= SHORT_INPUT;
+        }
+        /* The last 16 bytes may overlap bytes already consumed. */
+        a = read_8(p + count - 16);
+        b = read_8(p + count - 8);
+    }
+    a ^= SECRET_1;
+    b ^= seed;
+    multiply(&a, &b);
+    return multiply_fold(a ^ SECRET_0 ^ length, b ^ SECRET_1);
+}
+
+uint64_t
+CCC_hash_string(char const *const string, uint64_t const seed)
+{
+    if (!string)
+    {
+        return CCC_hash_bytes(NULL, 0, seed);
+    }
+    return CCC_hash_bytes(string, strlen(string), seed);
+}
+
+uint64_t
+CCC_hash_u64(uint64_t const value, uint64_t const seed)
+{
+    uint64_t a = value ^ SECRET_0;
+    uint64_t b = seed ^ SECRET_1;
+    multiply(&a, &b);
+    return multiply_fold(a ^ SECRET_2, b ^ SECRET_3);
+}
+
+uint64_t
+CCC_hash_u32(uint32_t const value, uint64_t const seed)
+{
+    return CCC_hash_u64(value, seed);
+}
+
+uint64_t
+CCC_hash_mix(uint64_t const hash)
+{
+    return CCC_private_hash_mix(hash);
+}
+
+uint64_t
+CCC_hash_key_u64(CCC_Key_context const key_context)
+{
+    uint64_t value = 0;
+    (void)memcpy(&value, key_context.key, sizeof(value));
+    return CCC_hash_u64(value, CCC_HASH_DEFAULT_SEED);
+}
+
+uint64_t
+CCC_hash_key_u32(CCC_Key_context const key_context)
+{
+    uint32_t value = 0;
+    (void)memcpy(&value, key_context.key, sizeof(value));
+    return CCC_hash_u32(value, CCC_HASH_DEFAULT_SEED);
+}
+
+uint64_t
+CCC_hash_key_string(CCC_Key_context const key_context)
+{
+    char const *string = NULL;
+    (void)memcpy(&string, key_context.key, sizeof(string));
+    return CCC_hash_string(string, CCC_HASH_DEFAULT_SEED);
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+/** Replaces a with the low half and b with the high half of the 128 bit
+product of a and b. Without a native 128 bit type the product is assembled
+from four 32 bit partial products. */
+static inline void
+multiply(uint64_t *const a, uint64_t *const b)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 const product = (unsigned __int128)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    uint64_t const a_high = *a >> 32;
+    uint64_t const a_low = (uint32_t)*a;
+    uint64_t const b_high = *b >> 32;
+    uint64_t const b_low = (uint32_t)*b;
+    uint64_t const high_high = a_high * b_high;
+    uint64_t const high_low = a_high * b_low;
+    uint64_t const low_high = a_low * b_high;
+    uint64_t const low_low = a_low * b_low;
+    uint64_t const cross
+        = (low_low >> 32) + (uint32_t)high_low + (uint32_t)low_high;
+    *a = (cross << 32) | (uint32_t)low_low;
+    *b = high_high + (high_low >> 32) + (low_high >> 32) + (cross >> 32);
+#endif /* __SIZEOF_INT128__ */
+}
+
+/** Folds the high and low halves of the 128 bit product together. */
+static inline uint64_t
+multiply_fold(uint64_t a, uint64_t b)
+{
+    multiply(&a, &b);
+    return a ^ b;
+}
+
+/** Reads are little endian on every platform and never require alignment. */
+static inline uint64_t
+read_8(unsigned char const *const p)
+{
+    uint64_t v = 0;
+    (void)memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline uint64_t
+read_4(unsigned char const *const p)
+{
+    uint32_t v = 0;
+    (void)memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+/** Combines the first, middle, and last byte so that every byte of a 1 to 3
+byte input is read without a branch on the exact length. */
+static inline uint64_t
+read_1_to_3(unsigned char const *const p, size_t const count)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[count >> 1] << 8)
+         | p[count - 1];
+}
@@ -0,0 +1,637 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a flat hash map with one writer and lock free readers.
+The writer owns an ordinary flat hash map but never lets it rehash. Before the
+table runs out of room the writer copies every element into a larger table,
+publishes a view of the new table with one atomic store, and retires the old
+table until the epochs announced by readers show that none can still probe it.
+
+Within one table the writer only inserts, overwrites, or erases single slots.
+Each of these writes is bracketed by the sequence counter of the group of the
+slot. Readers probe with the flat hash map search, which compares keys against
+live slots, then copy the found element between two loads of that counter,
+retrying if the counter moved. Only once the copy is known to be consistent is
+its key compared again to decide the result, so the comparison that counts
+never sees a torn element. A slot whose tags were read mid write can only lead
+a reader to the wrong slot or to a miss that could have happened an instant
+earlier, and a wrong slot fails the comparison of its copy. Each reader owns a
+scratch slot for the copy when the caller provides no output. */
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "flat_hash_map.h"
+#include "optimistic_flat_hash_map.h"
+#include "private/private_flat_hash_map.h"
+#include "private/private_optimistic_flat_hash_map.h"
+#include "private/private_types.h"
+#include "types.h"
+
+enum : size_t
+{
+    READER_ALIGN = CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_READER_ALIGN,
+    STRIPES = CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_STRIPES,
+    MAX_READERS = CCC_PRIVATE_OPTIMISTIC_FLAT_HASH_MAP_MAX_READERS,
+    GROUP_COUNT = CCC_FLAT_HASH_MAP_GROUP_COUNT,
+};
+
+/** Readers announce zero when they are not inside a lookup so the global
+epoch starts after it. */
+enum : uint64_t
+{
+    IDLE = 0,
+    FIRST_EPOCH = 1,
+};
+
+/*===========================   Prototypes   ================================*/
+
+static CCC_Tribool lookup(struct CCC_Optimistic_flat_hash_map const *, size_t,
+                          void const *, void *);
+static CCC_Result reserve_one(struct CCC_Optimistic_flat_hash_map *);
+static CCC_Result grow(struct CCC_Optimistic_flat_hash_map *);
+static size_t reclaim(struct CCC_Optimistic_flat_hash_map *);
+static CCC_Tribool is_quiescent(struct CCC_Optimistic_flat_hash_map const *,
+                                uint64_t);
+static void write_begin(struct CCC_Optimistic_flat_hash_map *, size_t);
+static void write_end(struct CCC_Optimistic_flat_hash_map *, size_t);
+static _Atomic uint64_t *
+sequence_of(struct CCC_Optimistic_flat_hash_map const *, size_t);
+static CCC_Tribool key_matches(struct CCC_Optimistic_flat_hash_map const *,
+                               void const *, void const *);
+static size_t slot_index(struct CCC_Flat_hash_map const *, void const *);
+static void *key_in_slot(struct CCC_Optimistic_flat_hash_map const *,
+                         void const *);
+static size_t reader_allocation_bytes(size_t, size_t);
+static size_t sequence_bytes(void);
+static size_t scratch_stride(size_t);
+static void *scratch_of(struct CCC_Optimistic_flat_hash_map const *, size_t);
+static void free_table(struct CCC_Optimistic_flat_hash_map *,
+                       struct CCC_Optimistic_flat_hash_map_table *,
+                       CCC_Tribool);
+
+/*===========================   Interface   =================================*/
+
+CCC_Tribool
+CCC_optimistic_flat_hash_map_contains(
+    CCC_Optimistic_flat_hash_map const *const map, size_t const reader,
+    void const *const key)
+{
+    if (!map || !key || reader >= map->reader_count)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return lookup(map, reader, key, NULL);
+}
+
+CCC_Tribool
+CCC_optimistic_flat_hash_map_get_key_value(
+    CCC_Optimistic_flat_hash_map const *const map, size_t const reader,
+    void const *const key, void *const type_output)
+{
+    if (!map || !key || !type_output || reader >= map->reader_count)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return lookup(map, reader, key, type_output);
+}
+
+CCC_Entry
+CCC_optimistic_flat_hash_map_try_insert(CCC_Optimistic_flat_hash_map *const map,
+                                        void *const type_input_output)
+{
+    if (!map || !type_input_output || !map->readers)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (reserve_one(map) != CCC_RESULT_OK)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type_input_output);
+    uint64_t const hash = CCC_private_flat_hash_map_hash(&map->prototype, key);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(&map->map, key, hash);
+    if (e.status & CCC_ENTRY_OCCUPIED)
+    {
+        (void)memcpy(type_input_output,
+                     CCC_private_flat_hash_map_data_at(&map->map, e.index),
+                     map->prototype.sizeof_type);
+    }
+    else
+    {
+        write_begin(map, e.index);
+        CCC_private_flat_hash_map_insert(&map->map, type_input_output, hash,
+                                         e.index);
+        write_end(map, e.index);
+    }
+    return (CCC_Entry){{.type = type_input_output, .status = e.status}};
+}
+
+CCC_Entry
+CCC_optimistic_flat_hash_map_insert_or_assign(
+    CCC_Optimistic_flat_hash_map *const map, void const *const type)
+{
+    if (!map || !type || !map->readers)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    if (reserve_one(map) != CCC_RESULT_OK)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_INSERT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type);
+    uint64_t const hash = CCC_private_flat_hash_map_hash(&map->prototype, key);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(&map->map, key, hash);
+    write_begin(map, e.index);
+    if (e.status & CCC_ENTRY_OCCUPIED)
+    {
+        (void)memcpy(CCC_private_flat_hash_map_data_at(&map->map, e.index),
+                     type, map->prototype.sizeof_type);
+    }
+    else
+    {
+        CCC_private_flat_hash_map_insert(&map->map, type, hash, e.index);
+    }
+    write_end(map, e.index);
+    return (CCC_Entry){{.status = e.status}};
+}
+
+CCC_Entry
+CCC_optimistic_flat_hash_map_remove_key_value(
+    CCC_Optimistic_flat_hash_map *const map, void *const type_output)
+{
+    if (!map || !type_output || !map->readers)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type_output);
+    void const *const slot = CCC_private_flat_hash_map_find_with_hash(
+        &map->map, key, CCC_private_flat_hash_map_hash(&map->prototype, key));
+    if (!slot)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_VACANT}};
+    }
+    (void)memcpy(type_output, slot, map->prototype.sizeof_type);
+    size_t const i = slot_index(&map->map, slot);
+    write_begin(map, i);
+    CCC_private_flat_hash_map_erase(&map->map, i);
+    write_end(map, i);
+    return (CCC_Entry){{.type = type_output, .status = CCC_ENTRY_OCCUPIED}};
+}
+
+CCC_Count
+CCC_optimistic_flat_hash_map_reclaim(CCC_Optimistic_flat_hash_map *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = reclaim(map)};
+}
+
+CCC_Count
+CCC_optimistic_flat_hash_map_count(
+    CCC_Optimistic_flat_hash_map const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = map->map.count};
+}
+
+CCC_Tribool
+CCC_optimistic_flat_hash_map_is_empty(
+    CCC_Optimistic_flat_hash_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return !map->map.count;
+}
+
+CCC_Tribool
+CCC_optimistic_flat_hash_map_validate(
+    CCC_Optimistic_flat_hash_map const *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    struct CCC_Optimistic_flat_hash_map_table const *const table
+        = atomic_load_explicit(&map->table, memory_order_relaxed);
+    if (!table)
+    {
+        return !map->map.data && !map->map.count;
+    }
+    if (table->data != map->map.data || table->tag != map->map.tag
+        || table->mask != map->map.mask
+        || table->group_count != map->map.group_count)
+    {
+        return CCC_FALSE;
+    }
+    for (size_t i = 0; i < STRIPES; ++i)
+    {
+        if (atomic_load_explicit(&map->sequence[i], memory_order_relaxed) & 1)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_flat_hash_map_validate(&map->map);
+}
+
+CCC_Result
+CCC_optimistic_flat_hash_map_clear_and_free(
+    CCC_Optimistic_flat_hash_map *const map, CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Optimistic_flat_hash_map_table *const table
+        = atomic_load_explicit(&map->table, memory_order_relaxed);
+    (void)CCC_flat_hash_map_clear_and_free(&map->map, destroy);
+    if (table)
+    {
+        free_table(map, table, CCC_FALSE);
+    }
+    while (map->retired)
+    {
+        struct CCC_Optimistic_flat_hash_map_table *const next
+            = map->retired->next;
+        free_table(map, map->retired, CCC_TRUE);
+        map->retired = next;
+    }
+    if (map->allocation)
+    {
+        (void)map->prototype.allocate((CCC_Allocator_context){
+            .input = map->allocation,
+            .bytes = 0,
+            .context = map->prototype.context,
+            .old_bytes = reader_allocation_bytes(
+                map->reader_count, map->prototype.sizeof_type),
+        });
+    }
+    *map = (struct CCC_Optimistic_flat_hash_map){};
+    return CCC_RESULT_OK;
+}
+
+/*=======================   Private Interface   =============================*/
+
+CCC_Result
+CCC_private_optimistic_flat_hash_map_initialize(
+    struct CCC_Optimistic_flat_hash_map *const map,
+    struct CCC_Flat_hash_map const prototype, size_t const reader_count)
+{
+    if (!map || !prototype.allocate || !reader_count
+        || reader_count > MAX_READERS
+        || (prototype.options & CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    size_t const reader_bytes
+        = reader_count * sizeof(struct CCC_Optimistic_flat_hash_map_reader);
+    /* Allocators may ignore the alignment request so the reader array is
+       placed at the first aligned address within a larger allocation. The
+       sequence counters and then the scratch slots follow on their own
+       lines. */
+    void *const allocation = prototype.allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = reader_allocation_bytes(reader_count, prototype.sizeof_type),
+        .context = prototype.context,
+        .alignment = READER_ALIGN,
+    });
+    if (!allocation)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    uintptr_t const first_reader = ((uintptr_t)allocation + READER_ALIGN - 1)
+                                 & ~(uintptr_t)(READER_ALIGN - 1);
+    struct CCC_Optimistic_flat_hash_map_reader *const readers
+        = (struct CCC_Optimistic_flat_hash_map_reader *)first_reader;
+    _Atomic uint64_t *const sequence
+        = (_Atomic uint64_t *)(void *)((char *)readers + reader_bytes);
+    for (size_t i = 0; i < reader_count; ++i)
+    {
+        atomic_init(&readers[i].epoch, IDLE);
+    }
+    for (size_t i = 0; i < STRIPES; ++i)
+    {
+        atomic_init(&sequence[i], 0);
+    }
+    *map = (struct CCC_Optimistic_flat_hash_map){
+        .prototype = prototype,
+        .readers = readers,
+        .sequence = sequence,
+        .scratch = (char *)sequence + sequence_bytes(),
+        .allocation = allocation,
+        .reader_count = reader_count,
+        .map = prototype,
+    };
+    atomic_init(&map->table, NULL);
+    atomic_init(&map->epoch, FIRST_EPOCH);
+    return CCC_RESULT_OK;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+/** Searches for key with the epoch of the reader announced for the duration.
+The search itself is the flat hash map search run on a view of the published
+table. A found slot is then copied between two loads of the sequence counter
+guarding it and the key is compared on the consistent copy. The output may be
+NULL for membership, in which case the scratch slot of the reader is used. */
+static CCC_Tribool
+lookup(struct CCC_Optimistic_flat_hash_map const *const map,
+       size_t const reader, void const *const key, void *const type_output)
+{
+    _Atomic uint64_t *const epoch = &map->readers[reader].epoch;
+    /* Sequentially consistent so that the writer either sees this epoch when
+       it scans for readers or this reader sees the table it just published. */
+    atomic_store(epoch, atomic_load(&map->epoch));
+    uint64_t const hash = CCC_private_flat_hash_map_hash(&map->prototype, key);
+    CCC_Tribool found = CCC_FALSE;
+    for (;;)
+    {
+        struct CCC_Optimistic_flat_hash_map_table const *const table
+            = atomic_load(&map->table);
+        if (!table)
+        {
+            break;
+        }
+        struct CCC_Flat_hash_map view = map->prototype;
+        view.data = table->data;
+        view.tag = table->tag;
+        view.mask = table->mask;
+        view.group_count = table->group_count;
+        void const *const slot
+            = CCC_private_flat_hash_map_find_with_hash(&view, key, hash);
+        if (!slot)
+        {
+            break;
+        }
+        _Atomic uint64_t *const sequence
+            = sequence_of(map, slot_index(&view, slot));
+        uint64_t const before
+            = atomic_load_explicit(sequence, memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+        void *const copy = type_output ? type_output : scratch_of(map, reader);
+        (void)memcpy(copy, slot, map->prototype.sizeof_type);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(sequence, memory_order_relaxed) != before)
+        {
+            continue;
+        }
+        /* A consistent copy with another key means the slot was reused after
+           the probe found it, so the key moved or left. Search again. */
+        if (key_matches(map, key, copy))
+        {
+            found = CCC_TRUE;
+            break;
+        }
+    }
+    atomic_store_explicit(epoch, IDLE, memory_order_release);
+    return found;
+}
+
+/** Ensures the writer's map has room for one more element so the flat hash
+map never rehashes a table that readers may be probing. */
+static inline CCC_Result
+reserve_one(struct CCC_Optimistic_flat_hash_map *const map)
+{
+    if (atomic_load_explicit(&map->table, memory_order_relaxed)
+        && map->map.remain)
+    {
+        return CCC_RESULT_OK;
+    }
+    return grow(map);
+}
+
+/** Copies every element into a new table sized by the load factor for one
+more element and publishes it. A table filled by live elements doubles while
+one filled by erased slots is rebuilt at the size its elements need. The old
+table is retired, not freed. */
+static CCC_Result
+grow(struct CCC_Optimistic_flat_hash_map *const map)
+{
+    struct CCC_Flat_hash_map next = map->prototype;
+    CCC_Result const r = CCC_flat_hash_map_reserve(&next, map->map.count + 1,
+                                                   map->prototype.allocate);
+    if (r != CCC_RESULT_OK)
+    {
+        return r;
+    }
+    struct CCC_Optimistic_flat_hash_map_table *const view
+        = map->prototype.allocate((CCC_Allocator_context){
+            .input = NULL,
+            .bytes = sizeof(struct CCC_Optimistic_flat_hash_map_table),
+            .context = map->prototype.context,
+        });
+    if (!view)
+    {
+        (void)CCC_flat_hash_map_clear_and_free(&next, NULL);
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    for (void const *type = CCC_flat_hash_map_begin(&map->map);
+         type != CCC_flat_hash_map_end(&map->map);
+         type = CCC_flat_hash_map_next(&map->map, type))
+    {
+        (void)CCC_flat_hash_map_insert_or_assign(&next, type);
+    }
+    *view = (struct CCC_Optimistic_flat_hash_map_table){
+        .data = next.data,
+        .tag = next.tag,
+        .mask = next.mask,
+        .group_count = next.group_count,
+    };
+    struct CCC_Optimistic_flat_hash_map_table *const old
+        = atomic_load_explicit(&map->table, memory_order_relaxed);
+    map->map = next;
+    atomic_store(&map->table, view);
+    if (old)
+    {
+        old->retired = atomic_fetch_add(&map->epoch, 1);
+        old->next = map->retired;
+        map->retired = old;
+        (void)reclaim(map);
+    }
+    return CCC_RESULT_OK;
+}
+
+/** Frees the retired tables that no reader can reach and returns the number
+that remain. */
+static size_t
+reclaim(struct CCC_Optimistic_flat_hash_map *const map)
+{
+    size_t remain = 0;
+    struct CCC_Optimistic_flat_hash_map_table **link = &map->retired;
+    while (*link)
+    {
+        struct CCC_Optimistic_flat_hash_map_table *const table = *link;
+        if (is_quiescent(map, table->retired))
+        {
+            *link = table->next;
+            free_table(map, table, CCC_TRUE);
+        }
+        else
+        {
+            ++remain;
+            link = &table->next;
+        }
+    }
+    return remain;
+}
+
+/** A reader that announced an epoch after a table was retired loaded the
+epoch after the new table was published, and so can only hold newer tables.
+Idle readers hold none. */
+static CCC_Tribool
+is_quiescent(struct CCC_Optimistic_flat_hash_map const *const map,
+             uint64_t const retired)
+{
+    for (size_t i = 0; i < map->reader_count; ++i)
+    {
+        uint64_t const e = atomic_load(&map->readers[i].epoch);
+        if (e != IDLE && e <= retired)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+/** Makes the sequence of slot i odd. The release fence orders the increment
+before the writes to the slot that follow. */
+static inline void
+write_begin(struct CCC_Optimistic_flat_hash_map *const map, size_t const i)
+{
+    _Atomic uint64_t *const sequence = sequence_of(map, i);
+    atomic_store_explicit(
+        sequence, atomic_load_explicit(sequence, memory_order_relaxed) + 1,
+        memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void
+write_end(struct CCC_Optimistic_flat_hash_map *const map, size_t const i)
+{
+    _Atomic uint64_t *const sequence = sequence_of(map, i);
+    atomic_store_explicit(
+        sequence, atomic_load_explicit(sequence, memory_order_relaxed) + 1,
+        memory_order_release);
+}
+
+/** A write to a slot also writes the replica of its tag past the end of the
+table, but any group load that reads the replica resolves the match to the
+slot itself, so the group of the slot is the only group that must change. */
+static inline _Atomic uint64_t *
+sequence_of(struct CCC_Optimistic_flat_hash_map const *const map,
+            size_t const i)
+{
+    return &map->sequence[(i / GROUP_COUNT) & (STRIPES - 1)];
+}
+
+static inline CCC_Tribool
+key_matches(struct CCC_Optimistic_flat_hash_map const *const map,
+            void const *const key, void const *const slot)
+{
+    return map->prototype.compare((CCC_Key_comparator_context){
+               .key_left = key,
+               .type_right = slot,
+               .context = map->prototype.context,
+           })
+        == CCC_ORDER_EQUAL;
+}
+
+static inline size_t
+slot_index(struct CCC_Flat_hash_map const *const map, void const *const slot)
+{
+    return (size_t)((char const *)slot - (char const *)map->data)
+         / map->sizeof_type;
+}
+
+static inline void *
+key_in_slot(struct CCC_Optimistic_flat_hash_map const *const map,
+            void const *const type)
+{
+    return (char *)type + map->prototype.key_offset;
+}
+
+/** The bytes allocated for the reader epochs, the sequence counters, and the
+scratch slots with room to align the first reader. */
+static inline size_t
+reader_allocation_bytes(size_t const reader_count, size_t const sizeof_type)
+{
+    return (reader_count * sizeof(struct CCC_Optimistic_flat_hash_map_reader))
+         + sequence_bytes() + (reader_count * scratch_stride(sizeof_type))
+         + READER_ALIGN - 1;
+}
+
+/** The sequence counters rounded up so the scratch slots start on a fresh
+line. */
+static inline size_t
+sequence_bytes(void)
+{
+    return ((STRIPES * sizeof(_Atomic uint64_t)) + READER_ALIGN - 1)
+         & ~(size_t)(READER_ALIGN - 1);
+}
+
+/** Each scratch slot is padded to the reader alignment so two readers never
+write to the same cache line. */
+static inline size_t
+scratch_stride(size_t const sizeof_type)
+{
+    return (sizeof_type + READER_ALIGN - 1) & ~(size_t)(READER_ALIGN - 1);
+}
+
+static inline void *
+scratch_of(struct CCC_Optimistic_flat_hash_map const *const map,
+           size_t const reader)
+{
+    return (char *)map->scratch
+         + (reader * scratch_stride(map->prototype.sizeof_type));
+}
+
+/** Frees a table view and, for retired tables, the table it refers to. The
+current table belongs to the writer's map and is freed with it. */
+static void
+free_table(struct CCC_Optimistic_flat_hash_map *const map,
+           struct CCC_Optimistic_flat_hash_map_table *const table,
+           CCC_Tribool const with_data)
+{
+    if (with_data)
+    {
+        struct CCC_Flat_hash_map layout = map->prototype;
+        layout.group_count = table->group_count;
+        (void)map->prototype.allocate((CCC_Allocator_context){
+            .input = table->data,
+            .bytes = 0,
+            .context = map->prototype.context,
+            .old_bytes
+            = CCC_private_flat_hash_map_table_bytes(&layout, table->mask),
+        });
+    }
+    (void)map->prototype.allocate((CCC_Allocator_context){
+        .input = table,
+        .bytes = 0,
+        .context = map->prototype.context,
+        .old_bytes = sizeof(struct CCC_Optimistic_flat_hash_map_table),
+    });
+}
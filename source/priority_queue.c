@@ -115,6 +115,7 @@ CCC_priority_queue_pop(CCC_Priority_queue *const priority_queue)
             .input = struct_base(priority_queue, popped),
             .bytes = 0,
             .context = priority_queue->context,
+            .old_bytes = priority_queue->sizeof_type,
         });
     }
     return CCC_RESULT_OK;
@@ -152,6 +153,7 @@ CCC_priority_queue_erase(CCC_Priority_queue *const priority_queue,
             .input = struct_base(priority_queue, type_intruder),
             .bytes = 0,
             .context = priority_queue->context,
+            .old_bytes = priority_queue->sizeof_type,
         });
     }
     return CCC_RESULT_OK;
@@ -213,6 +215,7 @@ CCC_priority_queue_clear(CCC_Priority_queue *const priority_queue,
                     .input = destroy_this,
                     .bytes = 0,
                     .context = priority_queue->context,
+                    .old_bytes = priority_queue->sizeof_type,
                 });
             }
             node = prev_node;
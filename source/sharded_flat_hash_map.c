@@ -0,0 +1,612 @@
+/** Copyright 2025 Alexander G. Lopez
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file implements a thread safe map as an array of flat hash maps, each
+behind its own mutex. The hash of a key is computed once without any lock held
+and selects both the shard and, through the private hashed interface of the
+flat hash map, the slot within the shard. Shard maps are never read outside of
+their lock; hashing and key layout come from an immutable prototype map. */
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "flat_hash_map.h"
+#include "private/private_flat_hash_map.h"
+#include "private/private_sharded_flat_hash_map.h"
+#include "private/private_types.h"
+#include "sharded_flat_hash_map.h"
+#include "types.h"
+
+enum : unsigned
+{
+    /** The number of upper hash bits the flat hash map uses for tags. */
+    TAG_BITS = 7,
+};
+
+enum : size_t
+{
+    SHARD_ALIGN = CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_SHARD_ALIGN,
+    MAX_SHARD_BITS = CCC_PRIVATE_SHARDED_FLAT_HASH_MAP_MAX_SHARD_BITS,
+};
+
+/*===========================   Prototypes   ================================*/
+
+static uint64_t hash_key(struct CCC_Sharded_flat_hash_map const *,
+                         void const *);
+static struct CCC_Sharded_flat_hash_map_shard *
+shard_of(struct CCC_Sharded_flat_hash_map const *, uint64_t);
+static void *key_in_slot(struct CCC_Sharded_flat_hash_map const *,
+                         void const *);
+static size_t sizeof_type(struct CCC_Sharded_flat_hash_map const *);
+static size_t shard_array_bytes(size_t);
+static void lock(struct CCC_Sharded_flat_hash_map_shard *);
+static void unlock(struct CCC_Sharded_flat_hash_map_shard *);
+static void swap_bytes(void *, void *, size_t);
+
+/*===========================   Interface   =================================*/
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_contains(CCC_Sharded_flat_hash_map *const map,
+                                   void const *const key)
+{
+    if (!map || !key || !map->shards)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    CCC_Tribool const found
+        = CCC_private_flat_hash_map_find_with_hash(&shard->map, key, hash)
+       != NULL;
+    unlock(shard);
+    return found;
+}
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_get_key_value(CCC_Sharded_flat_hash_map *const map,
+                                        void const *const key,
+                                        void *const type_output)
+{
+    if (!map || !key || !type_output || !map->shards)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    void const *const found
+        = CCC_private_flat_hash_map_find_with_hash(&shard->map, key, hash);
+    if (found)
+    {
+        (void)memcpy(type_output, found, sizeof_type(map));
+    }
+    unlock(shard);
+    return found != NULL;
+}
+
+CCC_Entry
+CCC_sharded_flat_hash_map_swap_entry(CCC_Sharded_flat_hash_map *const map,
+                                     void *const type_input_output)
+{
+    if (!map || !type_input_output || !map->shards)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type_input_output);
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(&shard->map, key, hash);
+    CCC_Entry result = {{.type = type_input_output, .status = e.status}};
+    if (e.status & CCC_ENTRY_OCCUPIED)
+    {
+        swap_bytes(CCC_private_flat_hash_map_data_at(&shard->map, e.index),
+                   type_input_output, sizeof_type(map));
+    }
+    else if (e.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        result.private.type = NULL;
+    }
+    else
+    {
+        CCC_private_flat_hash_map_insert(&shard->map, type_input_output, hash,
+                                         e.index);
+    }
+    unlock(shard);
+    return result;
+}
+
+CCC_Entry
+CCC_sharded_flat_hash_map_try_insert(CCC_Sharded_flat_hash_map *const map,
+                                     void *const type_input_output)
+{
+    if (!map || !type_input_output || !map->shards)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type_input_output);
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(&shard->map, key, hash);
+    CCC_Entry result = {{.type = type_input_output, .status = e.status}};
+    if (e.status & CCC_ENTRY_OCCUPIED)
+    {
+        (void)memcpy(type_input_output,
+                     CCC_private_flat_hash_map_data_at(&shard->map, e.index),
+                     sizeof_type(map));
+    }
+    else if (e.status & CCC_ENTRY_INSERT_ERROR)
+    {
+        result.private.type = NULL;
+    }
+    else
+    {
+        CCC_private_flat_hash_map_insert(&shard->map, type_input_output, hash,
+                                         e.index);
+    }
+    unlock(shard);
+    return result;
+}
+
+CCC_Entry
+CCC_sharded_flat_hash_map_insert_or_assign(CCC_Sharded_flat_hash_map *const map,
+                                           void const *const type)
+{
+    if (!map || !type || !map->shards)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    void const *const key = key_in_slot(map, type);
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    struct CCC_Flat_hash_map_entry const e
+        = CCC_private_flat_hash_map_entry_with_hash(&shard->map, key, hash);
+    if (e.status & CCC_ENTRY_OCCUPIED)
+    {
+        (void)memcpy(CCC_private_flat_hash_map_data_at(&shard->map, e.index),
+                     type, sizeof_type(map));
+    }
+    else if (!(e.status & CCC_ENTRY_INSERT_ERROR))
+    {
+        CCC_private_flat_hash_map_insert(&shard->map, type, hash, e.index);
+    }
+    unlock(shard);
+    return (CCC_Entry){{.status = e.status}};
+}
+
+CCC_Entry
+CCC_sharded_flat_hash_map_remove_key_value(CCC_Sharded_flat_hash_map *const map,
+                                           void *const type_output)
+{
+    if (!map || !type_output || !map->shards)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    uint64_t const hash = hash_key(map, key_in_slot(map, type_output));
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    CCC_Entry const result = CCC_private_flat_hash_map_remove_with_hash(
+        &shard->map, type_output, hash);
+    unlock(shard);
+    return result;
+}
+
+CCC_Sharded_flat_hash_map_entry
+CCC_sharded_flat_hash_map_entry(CCC_Sharded_flat_hash_map *const map,
+                                void const *const key)
+{
+    if (!map || !key || !map->shards)
+    {
+        return (CCC_Sharded_flat_hash_map_entry){
+            .entry = {{.status = CCC_ENTRY_ARGUMENT_ERROR}},
+        };
+    }
+    uint64_t const hash = hash_key(map, key);
+    struct CCC_Sharded_flat_hash_map_shard *const shard = shard_of(map, hash);
+    lock(shard);
+    return (CCC_Sharded_flat_hash_map_entry){
+        .shard = shard,
+        .entry = {
+            CCC_private_flat_hash_map_entry_with_hash(&shard->map, key, hash),
+        },
+    };
+}
+
+CCC_Result
+CCC_sharded_flat_hash_map_entry_release(
+    CCC_Sharded_flat_hash_map_entry *const entry)
+{
+    if (!entry || !entry->shard)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    unlock(entry->shard);
+    *entry = (CCC_Sharded_flat_hash_map_entry){
+        .entry = {{.status = CCC_ENTRY_ARGUMENT_ERROR}},
+    };
+    return CCC_RESULT_OK;
+}
+
+void *
+CCC_sharded_flat_hash_map_or_insert(
+    CCC_Sharded_flat_hash_map_entry const *const entry, void const *const type)
+{
+    if (!entry || !entry->shard)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_or_insert(&entry->entry, type);
+}
+
+void *
+CCC_sharded_flat_hash_map_insert_entry(
+    CCC_Sharded_flat_hash_map_entry const *const entry, void const *const type)
+{
+    if (!entry || !entry->shard)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_insert_entry(&entry->entry, type);
+}
+
+CCC_Entry
+CCC_sharded_flat_hash_map_remove_entry(
+    CCC_Sharded_flat_hash_map_entry const *const entry)
+{
+    if (!entry || !entry->shard)
+    {
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
+    }
+    return CCC_flat_hash_map_remove_entry(&entry->entry);
+}
+
+CCC_Sharded_flat_hash_map_entry *
+CCC_sharded_flat_hash_map_and_modify(
+    CCC_Sharded_flat_hash_map_entry *const entry,
+    CCC_Type_modifier *const modify)
+{
+    if (entry && entry->shard)
+    {
+        (void)CCC_flat_hash_map_and_modify(&entry->entry, modify);
+    }
+    return entry;
+}
+
+CCC_Sharded_flat_hash_map_entry *
+CCC_sharded_flat_hash_map_and_modify_context(
+    CCC_Sharded_flat_hash_map_entry *const entry,
+    CCC_Type_modifier *const modify, void *const context)
+{
+    if (entry && entry->shard)
+    {
+        (void)CCC_flat_hash_map_and_modify_context(&entry->entry, modify,
+                                                   context);
+    }
+    return entry;
+}
+
+void *
+CCC_sharded_flat_hash_map_unwrap(
+    CCC_Sharded_flat_hash_map_entry const *const entry)
+{
+    if (!entry || !entry->shard)
+    {
+        return NULL;
+    }
+    return CCC_flat_hash_map_unwrap(&entry->entry);
+}
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_occupied(
+    CCC_Sharded_flat_hash_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return CCC_flat_hash_map_occupied(&entry->entry);
+}
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_insert_error(
+    CCC_Sharded_flat_hash_map_entry const *const entry)
+{
+    if (!entry)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    return CCC_flat_hash_map_insert_error(&entry->entry);
+}
+
+CCC_Count
+CCC_sharded_flat_hash_map_shard_count(
+    CCC_Sharded_flat_hash_map const *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = map->shard_count};
+}
+
+CCC_Flat_hash_map *
+CCC_sharded_flat_hash_map_shard_lock(CCC_Sharded_flat_hash_map *const map,
+                                     size_t const shard_index)
+{
+    if (!map || shard_index >= map->shard_count)
+    {
+        return NULL;
+    }
+    lock(&map->shards[shard_index]);
+    return &map->shards[shard_index].map;
+}
+
+CCC_Result
+CCC_sharded_flat_hash_map_shard_unlock(CCC_Sharded_flat_hash_map *const map,
+                                       size_t const shard_index)
+{
+    if (!map || shard_index >= map->shard_count)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    unlock(&map->shards[shard_index]);
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_sharded_flat_hash_map_clear(CCC_Sharded_flat_hash_map *const map,
+                                CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    for (size_t i = 0; i < map->shard_count; ++i)
+    {
+        lock(&map->shards[i]);
+        (void)CCC_flat_hash_map_clear(&map->shards[i].map, destroy);
+        unlock(&map->shards[i]);
+    }
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_sharded_flat_hash_map_clear_and_free(CCC_Sharded_flat_hash_map *const map,
+                                         CCC_Type_destructor *const destroy)
+{
+    if (!map)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    for (size_t i = 0; i < map->shard_count; ++i)
+    {
+        (void)CCC_flat_hash_map_clear_and_free(&map->shards[i].map, destroy);
+        (void)pthread_mutex_destroy(&map->shards[i].lock);
+    }
+    if (map->allocation)
+    {
+        (void)map->allocate((CCC_Allocator_context){
+            .input = map->allocation,
+            .bytes = 0,
+            .context = map->context,
+            .old_bytes = shard_array_bytes(map->shard_count),
+        });
+    }
+    *map = (struct CCC_Sharded_flat_hash_map){};
+    return CCC_RESULT_OK;
+}
+
+CCC_Count
+CCC_sharded_flat_hash_map_count(CCC_Sharded_flat_hash_map *const map)
+{
+    if (!map)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < map->shard_count; ++i)
+    {
+        lock(&map->shards[i]);
+        total += map->shards[i].map.count;
+        unlock(&map->shards[i]);
+    }
+    return (CCC_Count){.count = total};
+}
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_is_empty(CCC_Sharded_flat_hash_map *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    for (size_t i = 0; i < map->shard_count; ++i)
+    {
+        lock(&map->shards[i]);
+        size_t const count = map->shards[i].map.count;
+        unlock(&map->shards[i]);
+        if (count)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+CCC_Tribool
+CCC_sharded_flat_hash_map_validate(CCC_Sharded_flat_hash_map *const map)
+{
+    if (!map)
+    {
+        return CCC_TRIBOOL_ERROR;
+    }
+    for (size_t i = 0; i < map->shard_count; ++i)
+    {
+        struct CCC_Sharded_flat_hash_map_shard *const shard = &map->shards[i];
+        lock(shard);
+        CCC_Tribool valid = CCC_flat_hash_map_validate(&shard->map);
+        for (void const *type = CCC_flat_hash_map_begin(&shard->map);
+             valid == CCC_TRUE && type != CCC_flat_hash_map_end(&shard->map);
+             type = CCC_flat_hash_map_next(&shard->map, type))
+        {
+            valid = shard_of(map, hash_key(map, key_in_slot(map, type)))
+                 == shard;
+        }
+        unlock(shard);
+        if (valid != CCC_TRUE)
+        {
+            return valid;
+        }
+    }
+    return CCC_TRUE;
+}
+
+/*=======================   Private Interface   =============================*/
+
+CCC_Result
+CCC_private_sharded_flat_hash_map_initialize(
+    struct CCC_Sharded_flat_hash_map *const map,
+    struct CCC_Flat_hash_map const prototype, size_t const shard_count)
+{
+    if (!map || !prototype.allocate || !shard_count
+        || shard_count > ((size_t)1 << MAX_SHARD_BITS))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < shard_count)
+    {
+        ++bits;
+    }
+    size_t const count = (size_t)1 << bits;
+    /* Allocators may ignore the alignment request so the array is placed at
+       the first aligned address within a larger allocation. */
+    void *const allocation = prototype.allocate((CCC_Allocator_context){
+        .input = NULL,
+        .bytes = shard_array_bytes(count),
+        .context = prototype.context,
+        .alignment = SHARD_ALIGN,
+    });
+    if (!allocation)
+    {
+        return CCC_RESULT_ALLOCATOR_ERROR;
+    }
+    struct CCC_Sharded_flat_hash_map_shard *const shards
+        = (struct CCC_Sharded_flat_hash_map_shard *)(((uintptr_t)allocation
+                                                      + SHARD_ALIGN - 1)
+                                                     & ~(uintptr_t)(SHARD_ALIGN
+                                                                    - 1));
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pthread_mutex_init(&shards[i].lock, NULL))
+        {
+            while (i--)
+            {
+                (void)pthread_mutex_destroy(&shards[i].lock);
+            }
+            (void)prototype.allocate((CCC_Allocator_context){
+                .input = allocation,
+                .bytes = 0,
+                .context = prototype.context,
+                .old_bytes = shard_array_bytes(count),
+            });
+            return CCC_RESULT_FAIL;
+        }
+        shards[i].map = prototype;
+    }
+    *map = (struct CCC_Sharded_flat_hash_map){
+        .shards = shards,
+        .prototype = prototype,
+        .allocation = allocation,
+        .shard_count = count,
+        .shard_shift = (unsigned)(64 - TAG_BITS - bits),
+        .allocate = prototype.allocate,
+        .context = prototype.context,
+    };
+    return CCC_RESULT_OK;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+/** Every shard shares the hash function, context, and options of the
+prototype. A shard map is overwritten as a whole when it resizes so these
+fields are never read from a shard that another thread may hold. */
+static inline uint64_t
+hash_key(struct CCC_Sharded_flat_hash_map const *const map,
+         void const *const key)
+{
+    return CCC_private_flat_hash_map_hash(&map->prototype, key);
+}
+
+static inline struct CCC_Sharded_flat_hash_map_shard *
+shard_of(struct CCC_Sharded_flat_hash_map const *const map,
+         uint64_t const hash)
+{
+    return &map->shards[(hash >> map->shard_shift) & (map->shard_count - 1)];
+}
+
+static inline void *
+key_in_slot(struct CCC_Sharded_flat_hash_map const *const map,
+            void const *const type)
+{
+    return (char *)type + map->prototype.key_offset;
+}
+
+static inline size_t
+sizeof_type(struct CCC_Sharded_flat_hash_map const *const map)
+{
+    return map->prototype.sizeof_type;
+}
+
+/** The bytes allocated for count shards with room to align the first. */
+static inline size_t
+shard_array_bytes(size_t const count)
+{
+    return (count * sizeof(struct CCC_Sharded_flat_hash_map_shard))
+         + SHARD_ALIGN - 1;
+}
+
+/** Locking a default mutex only fails for invalid mutexes or a thread locking
+a mutex it already holds, both of which are usage errors documented in the
+interface. */
+static inline void
+lock(struct CCC_Sharded_flat_hash_map_shard *const shard)
+{
+    (void)pthread_mutex_lock(&shard->lock);
+}
+
+static inline void
+unlock(struct CCC_Sharded_flat_hash_map_shard *const shard)
+{
+    (void)pthread_mutex_unlock(&shard->lock);
+}
+
+static inline void
+swap_bytes(void *const a, void *const b, size_t const n)
+{
+    unsigned char *x = a;
+    unsigned char *y = b;
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned char const tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+}
@@ -119,6 +119,7 @@ CCC_singly_linked_list_pop_front(CCC_Singly_linked_list *const list)
             .input = struct_base(list, remove),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
     }
     --list->count;
@@ -216,6 +217,7 @@ CCC_singly_linked_list_erase(CCC_Singly_linked_list *const list,
             .input = struct_base(list, type_intruder),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
     }
     --list->count;
@@ -348,6 +350,7 @@ CCC_singly_linked_list_clear(CCC_Singly_linked_list *const list,
                 .input = data,
                 .bytes = 0,
                 .context = list->context,
+                .old_bytes = list->sizeof_type,
             });
         }
     }
@@ -701,6 +704,7 @@ erase_range(struct CCC_Singly_linked_list *const list,
             .input = struct_base(list, begin),
             .bytes = 0,
             .context = list->context,
+            .old_bytes = list->sizeof_type,
         });
         ++count;
         if (begin == end)
@@ -46,9 +46,11 @@ that appear in the paper. We could choose to describe the nodes in terms of
 their tree lineage but that changes with rotations so a symbolic representation
 is fine. */
 #include <assert.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <string.h>
 
+#include "buffer.h"
 #include "private/private_tree_map.h"
 #include "private/private_types.h"
 #include "tree_map.h"
@@ -78,14 +80,87 @@ struct Query
     };
 };
 
+/** @internal A tree detached from any map during a join or split. The rank of
+the root is carried along so joins never walk a tree to find it. The rank of an
+empty tree is -1. */
+struct Subtree
+{
+    struct CCC_Tree_map_node *root;
+    int rank;
+};
+
+/** @internal The result of splitting a tree by a key. The node with a key equal
+to the split key, if any, belongs to neither side. */
+struct Split
+{
+    struct Subtree lesser;
+    struct CCC_Tree_map_node *equal;
+    struct Subtree greater;
+};
+
+/** @internal The two sides of a tree around its root. */
+struct Halves
+{
+    struct Subtree lesser;
+    struct Subtree greater;
+};
+
+/** @internal The state one thread of a set operation works with. The map is a
+private copy that absorbs root writes from rotations on detached trees. Trees
+to drop are linked through the parent field of their roots and freed by the
+caller once every thread is done, so the destructor and allocator only ever run
+on the calling thread. */
+struct Set_operation
+{
+    struct CCC_Tree_map map;
+    struct CCC_Tree_map_node *dropped;
+    struct CCC_Tree_map_node *last_dropped;
+};
+
+/** @internal Merges tree b into tree a with up to the given number of threads
+and returns the merged tree. */
+typedef struct Subtree Set_merge(struct Set_operation *, struct Subtree,
+                                 struct Subtree, size_t);
+
+/** @internal The lesser halves of a set operation handed to another thread. */
+struct Set_task
+{
+    pthread_t thread;
+    struct Set_operation operation;
+    Set_merge *merge;
+    struct Subtree a;
+    struct Subtree b;
+    size_t threads;
+    struct Subtree merged;
+};
+
+enum : int
+{
+    /** @internal The least rank of both lesser halves of a set operation for
+    them to be merged by another thread. A tree of this rank has at least 2^6
+    nodes and usually closer to 2^12, enough work to outweigh a thread. */
+    PARALLEL_MIN_RANK = 12,
+};
+
 /*==============================  Prototypes   ==============================*/
 
 static void init_node(struct CCC_Tree_map *, struct CCC_Tree_map_node *);
+static void copy_node(struct CCC_Tree_map const *, struct CCC_Tree_map_node *,
+                      struct CCC_Tree_map_node const *);
 static CCC_Order order(struct CCC_Tree_map const *, void const *,
                        struct CCC_Tree_map_node const *, CCC_Key_comparator *);
 static void *struct_base(struct CCC_Tree_map const *,
                          struct CCC_Tree_map_node const *);
 static struct Query find(struct CCC_Tree_map const *, void const *);
+static struct Query find_from(struct CCC_Tree_map const *,
+                              struct CCC_Tree_map_node const *, CCC_Order,
+                              void const *);
+static struct Query find_hint(struct CCC_Tree_map const *, void const *,
+                              void const *);
+static CCC_Entry try_insert(struct CCC_Tree_map *, struct Query,
+                            struct CCC_Tree_map_node *);
+static CCC_Entry insert_or_assign(struct CCC_Tree_map *, struct Query,
+                                  struct CCC_Tree_map_node *);
 static void swap(void *, void *, void *, size_t);
 static void *maybe_allocate_insert(struct CCC_Tree_map *,
                                    struct CCC_Tree_map_node *, CCC_Order,
@@ -140,11 +215,62 @@ static struct CCC_Range equal_range(struct CCC_Tree_map const *, void const *,
                                     void const *, enum Link);
 static struct CCC_Tree_map_entry entry(struct CCC_Tree_map const *,
                                        void const *);
+static struct CCC_Tree_map_entry entry_from(struct CCC_Tree_map const *,
+                                            struct Query);
 static void *insert(struct CCC_Tree_map *, struct CCC_Tree_map_node *,
                     CCC_Order, struct CCC_Tree_map_node *);
 static void *key_from_node(struct CCC_Tree_map const *,
                            struct CCC_Tree_map_node const *);
 static void *key_in_slot(struct CCC_Tree_map const *, void const *);
+static CCC_Tribool is_strictly_sorted(struct CCC_Tree_map const *,
+                                      CCC_Buffer const *);
+static void free_sorted_list(struct CCC_Tree_map *, struct CCC_Tree_map_node *);
+static struct CCC_Tree_map_node *build_sorted(struct CCC_Tree_map const *,
+                                              struct CCC_Tree_map_node **,
+                                              size_t, size_t *);
+static struct CCC_Tree_map_counted_node *counted(struct CCC_Tree_map_node *);
+static size_t subtree_count(struct CCC_Tree_map_node const *);
+static void update_count(struct CCC_Tree_map_node *);
+static void add_path_count(struct CCC_Tree_map_node *, size_t);
+static void subtract_path_count(struct CCC_Tree_map_node *, size_t);
+static size_t count_subtrees(struct CCC_Tree_map const *,
+                             struct CCC_Tree_map_node *);
+static size_t rank_of(struct CCC_Tree_map const *, void const *);
+static CCC_Tribool are_compatible(struct CCC_Tree_map const *,
+                                  struct CCC_Tree_map const *);
+static struct CCC_Tree_map counting_view(struct CCC_Tree_map const *,
+                                         struct CCC_Tree_map const *);
+static size_t tree_size(struct CCC_Tree_map const *,
+                        struct CCC_Tree_map_node *);
+static int rank_difference(struct CCC_Tree_map_node const *,
+                           struct CCC_Tree_map_node const *);
+static struct Subtree whole_tree(struct CCC_Tree_map const *);
+static struct Subtree detach(struct CCC_Tree_map_node *, enum Link, int);
+static struct Subtree join(struct CCC_Tree_map *, struct Subtree,
+                           struct CCC_Tree_map_node *, struct Subtree);
+static struct Subtree join_spine(struct CCC_Tree_map *, struct Subtree,
+                                 struct CCC_Tree_map_node *, struct Subtree,
+                                 enum Link);
+static CCC_Tribool join_fixup(struct CCC_Tree_map *, struct CCC_Tree_map_node *,
+                              struct CCC_Tree_map_node *);
+static struct Subtree join_trees(struct CCC_Tree_map *, struct Subtree,
+                                 struct Subtree);
+static struct Split split(struct CCC_Tree_map *, struct Subtree, void const *);
+static struct Subtree split_last(struct CCC_Tree_map *, struct Subtree,
+                                 struct CCC_Tree_map_node **);
+static CCC_Result set_operation(struct CCC_Tree_map *, struct CCC_Tree_map *,
+                                CCC_Type_destructor *, Set_merge *, size_t);
+static struct Halves merge_halves(struct Set_operation *, Set_merge *,
+                                  struct Halves, struct Split const *, size_t);
+static void *merge_task(void *);
+static void drop(struct Set_operation *, struct CCC_Tree_map_node *);
+static Set_merge union_trees;
+static Set_merge intersect_trees;
+static Set_merge subtract_trees;
+static void delete_node(struct CCC_Tree_map *, struct CCC_Tree_map_node *,
+                        CCC_Type_destructor *);
+static size_t delete_tree(struct CCC_Tree_map *, struct CCC_Tree_map_node *,
+                          CCC_Type_destructor *);
 static struct CCC_Tree_map_node *elem_in_slot(struct CCC_Tree_map const *,
                                               void const *);
 
@@ -183,7 +309,7 @@ CCC_tree_map_swap_entry(CCC_Tree_map *const map,
     struct Query const q = find(map, key_from_node(map, type_intruder));
     if (CCC_ORDER_EQUAL == q.last_order)
     {
-        *type_intruder = *q.found;
+        copy_node(map, type_intruder, q.found);
         void *const found = struct_base(map, q.found);
         void *const any_struct = struct_base(map, type_intruder);
         void *const old_val = struct_base(map, temp_intruder);
@@ -218,27 +344,21 @@ CCC_tree_map_try_insert(CCC_Tree_map *const map,
     {
         return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    struct Query const q = find(map, key_from_node(map, type_intruder));
-    if (CCC_ORDER_EQUAL == q.last_order)
-    {
-        return (CCC_Entry){{
-            .type = struct_base(map, q.found),
-            .status = CCC_ENTRY_OCCUPIED,
-        }};
-    }
-    void *const inserted
-        = maybe_allocate_insert(map, q.parent, q.last_order, type_intruder);
-    if (!inserted)
+    return try_insert(map, find(map, key_from_node(map, type_intruder)),
+                      type_intruder);
+}
+
+CCC_Entry
+CCC_tree_map_try_insert_hint(CCC_Tree_map *const map, void const *const hint,
+                             CCC_Tree_map_node *const type_intruder)
+{
+    if (!map || !type_intruder)
     {
-        return (CCC_Entry){{
-            .type = NULL,
-            .status = CCC_ENTRY_INSERT_ERROR,
-        }};
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    return (CCC_Entry){{
-        .type = inserted,
-        .status = CCC_ENTRY_VACANT,
-    }};
+    return try_insert(
+        map, find_hint(map, hint, key_from_node(map, type_intruder)),
+        type_intruder);
 }
 
 CCC_Entry
@@ -249,30 +369,22 @@ CCC_tree_map_insert_or_assign(CCC_Tree_map *const map,
     {
         return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    struct Query const q = find(map, key_from_node(map, type_intruder));
-    if (CCC_ORDER_EQUAL == q.last_order)
-    {
-        void *const found = struct_base(map, q.found);
-        *type_intruder = *elem_in_slot(map, found);
-        memcpy(found, struct_base(map, type_intruder), map->sizeof_type);
-        return (CCC_Entry){{
-            .type = found,
-            .status = CCC_ENTRY_OCCUPIED,
-        }};
-    }
-    void *const inserted
-        = maybe_allocate_insert(map, q.parent, q.last_order, type_intruder);
-    if (!inserted)
+    return insert_or_assign(
+        map, find(map, key_from_node(map, type_intruder)), type_intruder);
+}
+
+CCC_Entry
+CCC_tree_map_insert_or_assign_hint(CCC_Tree_map *const map,
+                                   void const *const hint,
+                                   CCC_Tree_map_node *const type_intruder)
+{
+    if (!map || !type_intruder)
     {
-        return (CCC_Entry){{
-            .type = NULL,
-            .status = CCC_ENTRY_INSERT_ERROR,
-        }};
+        return (CCC_Entry){{.status = CCC_ENTRY_ARGUMENT_ERROR}};
     }
-    return (CCC_Entry){{
-        .type = inserted,
-        .status = CCC_ENTRY_VACANT,
-    }};
+    return insert_or_assign(
+        map, find_hint(map, hint, key_from_node(map, type_intruder)),
+        type_intruder);
 }
 
 CCC_Tree_map_entry
@@ -286,6 +398,18 @@ CCC_tree_map_entry(CCC_Tree_map const *const map, void const *const key)
     return (CCC_Tree_map_entry){entry(map, key)};
 }
 
+CCC_Tree_map_entry
+CCC_tree_map_entry_hint(CCC_Tree_map const *const map, void const *const hint,
+                        void const *const key)
+{
+    if (!map || !key)
+    {
+        return (CCC_Tree_map_entry){
+            {.entry = {.status = CCC_ENTRY_ARGUMENT_ERROR}}};
+    }
+    return (CCC_Tree_map_entry){entry_from(map, find_hint(map, hint, key))};
+}
+
 void *
 CCC_tree_map_or_insert(CCC_Tree_map_entry const *const entry,
                        CCC_Tree_map_node *const type_intruder)
@@ -314,8 +438,8 @@ CCC_tree_map_insert_entry(CCC_Tree_map_entry const *const entry,
     }
     if (entry->private.entry.status == CCC_ENTRY_OCCUPIED)
     {
-        *type_intruder
-            = *elem_in_slot(entry->private.map, entry->private.entry.type);
+        copy_node(entry->private.map, type_intruder,
+                  elem_in_slot(entry->private.map, entry->private.entry.type));
         memcpy(entry->private.entry.type,
                struct_base(entry->private.map, type_intruder),
                entry->private.map->sizeof_type);
@@ -346,6 +470,7 @@ CCC_tree_map_remove_entry(CCC_Tree_map_entry const *const entry)
                 .input = erased,
                 .bytes = 0,
                 .context = entry->private.map->context,
+                .old_bytes = entry->private.map->sizeof_type,
             });
             return (CCC_Entry){{
                 .type = NULL,
@@ -388,6 +513,7 @@ CCC_tree_map_remove_key_value(CCC_Tree_map *const map,
             .input = removed,
             .bytes = 0,
             .context = map->context,
+            .old_bytes = map->sizeof_type,
         });
         return (CCC_Entry){{
             .type = any_struct,
@@ -591,8 +717,6 @@ CCC_tree_map_validate(CCC_Tree_map const *map)
     return validate(map);
 }
 
-/** This is a linear time constant space deletion of tree nodes via left
-rotations so element fields are modified during progression of deletes. */
 CCC_Result
 CCC_tree_map_clear(CCC_Tree_map *const map, CCC_Type_destructor *const destroy)
 {
@@ -600,41 +724,281 @@ CCC_tree_map_clear(CCC_Tree_map *const map, CCC_Type_destructor *const destroy)
     {
         return CCC_RESULT_ARGUMENT_ERROR;
     }
-    struct CCC_Tree_map_node *node = map->root;
-    while (node != NULL)
+    (void)delete_tree(map, map->root, destroy);
+    map->root = NULL;
+    map->count = 0;
+    return CCC_RESULT_OK;
+}
+
+/** The elements are first threaded in order through their right links, copying
+them to new allocations if the map allocates, so a failed allocation leaves only
+a list to free. The balanced tree is then built from that list in one in order
+pass. */
+CCC_Result
+CCC_tree_map_from_sorted(CCC_Tree_map *const map, CCC_Buffer *const sorted)
+{
+    if (!map || !sorted || map->count
+        || (sorted->count
+            && (!sorted->data || sorted->sizeof_type != map->sizeof_type))
+        || !is_strictly_sorted(map, sorted))
     {
-        if (node->branch[L] != NULL)
-        {
-            struct CCC_Tree_map_node *const left = node->branch[L];
-            node->branch[L] = left->branch[R];
-            left->branch[R] = node;
-            node = left;
-            continue;
-        }
-        struct CCC_Tree_map_node *const next = node->branch[R];
-        node->branch[L] = node->branch[R] = NULL;
-        node->parent = NULL;
-        void *const type = struct_base(map, node);
-        if (destroy)
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Tree_map_node *head = NULL;
+    struct CCC_Tree_map_node **tail = &head;
+    for (size_t i = 0; i < sorted->count; ++i)
+    {
+        void *slot = (char *)sorted->data + (i * map->sizeof_type);
+        if (map->allocate)
         {
-            destroy((CCC_Type_context){
-                .type = type,
+            void *const copy = map->allocate((CCC_Allocator_context){
+                .input = NULL,
+                .bytes = map->sizeof_type,
                 .context = map->context,
             });
+            if (!copy)
+            {
+                free_sorted_list(map, head);
+                return CCC_RESULT_ALLOCATOR_ERROR;
+            }
+            (void)memcpy(copy, slot, map->sizeof_type);
+            slot = copy;
         }
-        if (map->allocate)
+        struct CCC_Tree_map_node *const node = elem_in_slot(map, slot);
+        node->branch[R] = NULL;
+        *tail = node;
+        tail = &node->branch[R];
+    }
+    size_t rank = 0;
+    map->root = build_sorted(map, &head, sorted->count, &rank);
+    if (map->root)
+    {
+        map->root->parent = NULL;
+    }
+    map->count = sorted->count;
+    return CCC_RESULT_OK;
+}
+
+/** Counts are not written while disabled so enabling needs one postorder pass
+to count the existing nodes. A plain node has no room for a count. */
+CCC_Result
+CCC_tree_map_enable_order_statistics(CCC_Tree_map *const map)
+{
+    if (!map || !map->counted)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!map->order_statistics)
+    {
+        map->order_statistics = true;
+        (void)count_subtrees(map, map->root);
+    }
+    return CCC_RESULT_OK;
+}
+
+CCC_Count
+CCC_tree_map_rank(CCC_Tree_map const *const map, void const *const key)
+{
+    if (!map || !key || !map->order_statistics)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    return (CCC_Count){.count = rank_of(map, key)};
+}
+
+void *
+CCC_tree_map_select(CCC_Tree_map const *const map, size_t index)
+{
+    if (!map || !map->order_statistics || index >= map->count)
+    {
+        return NULL;
+    }
+    struct CCC_Tree_map_node const *node = map->root;
+    while (node)
+    {
+        size_t const left = subtree_count(node->branch[L]);
+        if (index == left)
         {
-            (void)map->allocate((CCC_Allocator_context){
-                .input = type,
-                .bytes = 0,
-                .context = map->context,
-            });
+            return struct_base(map, node);
         }
-        node = next;
+        if (index < left)
+        {
+            node = node->branch[L];
+        }
+        else
+        {
+            index -= left + 1;
+            node = node->branch[R];
+        }
+    }
+    return NULL;
+}
+
+CCC_Count
+CCC_tree_map_count_range(CCC_Tree_map const *const map,
+                         void const *const begin_key,
+                         void const *const end_key)
+{
+    if (!map || !begin_key || !end_key || !map->order_statistics)
+    {
+        return (CCC_Count){.error = CCC_RESULT_ARGUMENT_ERROR};
+    }
+    size_t const begin = rank_of(map, begin_key);
+    size_t const end = rank_of(map, end_key);
+    return (CCC_Count){.count = end > begin ? end - begin : 0};
+}
+
+/** The last node of the destination becomes the key between the two trees so
+the join itself is a single walk down the spine of the taller tree. */
+CCC_Result
+CCC_tree_map_join(CCC_Tree_map *const destination, CCC_Tree_map *const source)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    if (!source->count)
+    {
+        return CCC_RESULT_OK;
+    }
+    if (destination->count
+        && order(destination,
+                 key_from_node(destination, min_max_from(source->root, L)),
+                 min_max_from(destination->root, R), destination->compare)
+               != CCC_ORDER_GREATER)
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Tree_map keeper = counting_view(destination, source);
+    struct Subtree joined = whole_tree(source);
+    if (destination->count)
+    {
+        struct CCC_Tree_map_node *last = NULL;
+        struct Subtree const rest
+            = split_last(&keeper, whole_tree(destination), &last);
+        joined = join(&keeper, rest, last, joined);
+    }
+    destination->root = joined.root;
+    destination->count += source->count;
+    source->root = NULL;
+    source->count = 0;
+    return CCC_RESULT_OK;
+}
+
+CCC_Result
+CCC_tree_map_split(CCC_Tree_map *const map, void const *const key,
+                   CCC_Tree_map *const destination)
+{
+    if (!map || !key || !destination || destination->count
+        || !are_compatible(map, destination))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Tree_map keeper = counting_view(map, destination);
+    struct Split const parts = split(&keeper, whole_tree(map), key);
+    struct Subtree greater = parts.greater;
+    if (parts.equal)
+    {
+        greater = join(&keeper, (struct Subtree){.rank = -1}, parts.equal,
+                       greater);
+    }
+    size_t const moved = tree_size(&keeper, greater.root);
+    map->root = parts.lesser.root;
+    map->count -= moved;
+    destination->root = greater.root;
+    destination->count = moved;
+    return CCC_RESULT_OK;
+}
+
+/** Two splits isolate the range and one join closes the gap it leaves. A range
+that ends before it begins is empty because everything not less than the begin
+key is then greater than the end key. */
+CCC_Result
+CCC_tree_map_extract_range(CCC_Tree_map *const map,
+                           void const *const begin_key,
+                           void const *const end_key,
+                           CCC_Tree_map *const destination)
+{
+    if (!map || !begin_key || !end_key || !destination || destination->count
+        || !are_compatible(map, destination))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct CCC_Tree_map keeper = counting_view(map, destination);
+    struct Split const first = split(&keeper, whole_tree(map), begin_key);
+    struct Subtree middle = first.greater;
+    if (first.equal)
+    {
+        middle = join(&keeper, (struct Subtree){.rank = -1}, first.equal,
+                      middle);
     }
+    struct Split const second = split(&keeper, middle, end_key);
+    struct Subtree greater = second.greater;
+    if (second.equal)
+    {
+        greater = join(&keeper, (struct Subtree){.rank = -1}, second.equal,
+                       greater);
+    }
+    size_t const moved = tree_size(&keeper, second.lesser.root);
+    map->root = join_trees(&keeper, first.lesser, greater).root;
+    map->count -= moved;
+    destination->root = second.lesser.root;
+    destination->count = moved;
     return CCC_RESULT_OK;
 }
 
+CCC_Result
+CCC_tree_map_union(CCC_Tree_map *const destination, CCC_Tree_map *const source,
+                   CCC_Type_destructor *const destroy)
+{
+    return set_operation(destination, source, destroy, union_trees, 1);
+}
+
+CCC_Result
+CCC_tree_map_intersection(CCC_Tree_map *const destination,
+                          CCC_Tree_map *const source,
+                          CCC_Type_destructor *const destroy)
+{
+    return set_operation(destination, source, destroy, intersect_trees, 1);
+}
+
+CCC_Result
+CCC_tree_map_difference(CCC_Tree_map *const destination,
+                        CCC_Tree_map *const source,
+                        CCC_Type_destructor *const destroy)
+{
+    return set_operation(destination, source, destroy, subtract_trees, 1);
+}
+
+CCC_Result
+CCC_tree_map_union_parallel(CCC_Tree_map *const destination,
+                            CCC_Tree_map *const source,
+                            CCC_Type_destructor *const destroy,
+                            size_t const threads)
+{
+    return set_operation(destination, source, destroy, union_trees, threads);
+}
+
+CCC_Result
+CCC_tree_map_intersection_parallel(CCC_Tree_map *const destination,
+                                   CCC_Tree_map *const source,
+                                   CCC_Type_destructor *const destroy,
+                                   size_t const threads)
+{
+    return set_operation(destination, source, destroy, intersect_trees,
+                         threads);
+}
+
+CCC_Result
+CCC_tree_map_difference_parallel(CCC_Tree_map *const destination,
+                                 CCC_Tree_map *const source,
+                                 CCC_Type_destructor *const destroy,
+                                 size_t const threads)
+{
+    return set_operation(destination, source, destroy, subtract_trees,
+                         threads);
+}
+
 /*=========================   Private Interface  ============================*/
 
 struct CCC_Tree_map_entry
@@ -684,7 +1048,12 @@ min_max_from(struct CCC_Tree_map_node *start, enum Link const dir)
 static struct CCC_Tree_map_entry
 entry(struct CCC_Tree_map const *const map, void const *const key)
 {
-    struct Query const q = find(map, key);
+    return entry_from(map, find(map, key));
+}
+
+static struct CCC_Tree_map_entry
+entry_from(struct CCC_Tree_map const *const map, struct Query const q)
+{
     if (CCC_ORDER_EQUAL == q.last_order)
     {
         return (struct CCC_Tree_map_entry){
@@ -750,6 +1119,10 @@ insert(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *const parent,
         parent->branch[CCC_ORDER_GREATER == last_order] = type_output_intruder;
     }
     type_output_intruder->parent = parent;
+    if (map->order_statistics)
+    {
+        add_path_count(parent, 1);
+    }
     if (rank_rule_break)
     {
         insert_fixup(map, parent, type_output_intruder);
@@ -758,36 +1131,142 @@ insert(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *const parent,
     return struct_base(map, type_output_intruder);
 }
 
-static struct Query
-find(struct CCC_Tree_map const *const map, void const *const key)
+/** Attempts to insert the user type if the query did not find its key. */
+static CCC_Entry
+try_insert(struct CCC_Tree_map *const map, struct Query const q,
+           struct CCC_Tree_map_node *const type_intruder)
 {
-    struct CCC_Tree_map_node const *parent = NULL;
-    struct Query q = {
-        .last_order = CCC_ORDER_ERROR,
-        .found = map->root,
-    };
-    while (q.found != NULL)
+    if (CCC_ORDER_EQUAL == q.last_order)
     {
-        q.last_order = order(map, key, q.found, map->compare);
-        if (CCC_ORDER_EQUAL == q.last_order)
-        {
-            return q;
-        }
-        parent = q.found;
-        q.found = q.found->branch[CCC_ORDER_GREATER == q.last_order];
+        return (CCC_Entry){{
+            .type = struct_base(map, q.found),
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
     }
-    /* Type punning here OK as both union members have same type and size. */
-    q.parent = (struct CCC_Tree_map_node *)parent;
-    return q;
+    void *const inserted
+        = maybe_allocate_insert(map, q.parent, q.last_order, type_intruder);
+    if (!inserted)
+    {
+        return (CCC_Entry){{
+            .type = NULL,
+            .status = CCC_ENTRY_INSERT_ERROR,
+        }};
+    }
+    return (CCC_Entry){{
+        .type = inserted,
+        .status = CCC_ENTRY_VACANT,
+    }};
 }
 
-static struct CCC_Tree_map_node *
-next(struct CCC_Tree_map const *const map, struct CCC_Tree_map_node const *n,
-     enum Link const traversal)
+/** Overwrites the element the query found or inserts the user type. */
+static CCC_Entry
+insert_or_assign(struct CCC_Tree_map *const map, struct Query const q,
+                 struct CCC_Tree_map_node *const type_intruder)
 {
-    if (!n)
+    if (CCC_ORDER_EQUAL == q.last_order)
     {
-        return NULL;
+        void *const found = struct_base(map, q.found);
+        copy_node(map, type_intruder, elem_in_slot(map, found));
+        memcpy(found, struct_base(map, type_intruder), map->sizeof_type);
+        return (CCC_Entry){{
+            .type = found,
+            .status = CCC_ENTRY_OCCUPIED,
+        }};
+    }
+    return try_insert(map, q, type_intruder);
+}
+
+static struct Query
+find(struct CCC_Tree_map const *const map, void const *const key)
+{
+    return find_from(map, NULL, CCC_ORDER_ERROR, key);
+}
+
+/** Starts the search for the key at a user type in the map rather than the
+root. A hint is a node whose subtree the key may not be in, so the search first
+walks up. Ancestors reached from their near side are on the same side of the key
+as the hint and are passed without a comparison. Each ancestor reached from the
+far side bounds the keys next to the hint, so it is compared and the walk stops
+at the first one the key does not pass. The search then descends from the last
+node the key passed. A key next to the hint, such as a new greatest key after
+the previous greatest key, is found with one or two comparisons. A NULL hint or
+an empty map searches from the root. */
+static struct Query
+find_hint(struct CCC_Tree_map const *const map, void const *const hint,
+          void const *const key)
+{
+    if (!hint || !map->root)
+    {
+        return find(map, key);
+    }
+    struct CCC_Tree_map_node const *passed = elem_in_slot(map, hint);
+    CCC_Order const side = order(map, key, passed, map->compare);
+    if (CCC_ORDER_EQUAL == side)
+    {
+        return (struct Query){
+            .last_order = side,
+            .found = (struct CCC_Tree_map_node *)passed,
+        };
+    }
+    enum Link const dir = CCC_ORDER_GREATER == side;
+    for (struct CCC_Tree_map_node const *x = passed, *p = x->parent; p;
+         x = p, p = p->parent)
+    {
+        if (p->branch[dir] == x)
+        {
+            continue;
+        }
+        CCC_Order const o = order(map, key, p, map->compare);
+        if (CCC_ORDER_EQUAL == o)
+        {
+            return (struct Query){
+                .last_order = o,
+                .found = (struct CCC_Tree_map_node *)p,
+            };
+        }
+        if (o != side)
+        {
+            break;
+        }
+        passed = p;
+    }
+    return find_from(map, passed, side, key);
+}
+
+/** Continues a search below the parent in the direction of the last order or
+from the root if the parent is NULL. */
+static struct Query
+find_from(struct CCC_Tree_map const *const map,
+          struct CCC_Tree_map_node const *parent, CCC_Order const last_order,
+          void const *const key)
+{
+    struct Query q = {
+        .last_order = last_order,
+        .found = parent ? parent->branch[CCC_ORDER_GREATER == last_order]
+                        : map->root,
+    };
+    while (q.found != NULL)
+    {
+        q.last_order = order(map, key, q.found, map->compare);
+        if (CCC_ORDER_EQUAL == q.last_order)
+        {
+            return q;
+        }
+        parent = q.found;
+        q.found = q.found->branch[CCC_ORDER_GREATER == q.last_order];
+    }
+    /* Type punning here OK as both union members have same type and size. */
+    q.parent = (struct CCC_Tree_map_node *)parent;
+    return q;
+}
+
+static struct CCC_Tree_map_node *
+next(struct CCC_Tree_map const *const map, struct CCC_Tree_map_node const *n,
+     enum Link const traversal)
+{
+    if (!n)
+    {
+        return NULL;
     }
     assert(map->root->parent == NULL);
     if (n->branch[traversal])
@@ -828,15 +1307,119 @@ equal_range(struct CCC_Tree_map const *const map, void const *const begin_key,
     };
 }
 
+static CCC_Tribool
+is_strictly_sorted(struct CCC_Tree_map const *const map,
+                   CCC_Buffer const *const sorted)
+{
+    for (size_t i = 1; i < sorted->count; ++i)
+    {
+        char const *const prev
+            = (char const *)sorted->data + ((i - 1) * map->sizeof_type);
+        if (order(map, key_in_slot(map, prev + map->sizeof_type),
+                  elem_in_slot(map, prev), map->compare)
+            != CCC_ORDER_GREATER)
+        {
+            return CCC_FALSE;
+        }
+    }
+    return CCC_TRUE;
+}
+
+/** Frees the copies threaded through their right links by a failed sorted
+build. Nothing is freed if the map does not allocate. */
+static void
+free_sorted_list(struct CCC_Tree_map *const map,
+                 struct CCC_Tree_map_node *node)
+{
+    if (!map->allocate)
+    {
+        return;
+    }
+    while (node)
+    {
+        struct CCC_Tree_map_node *const next = node->branch[R];
+        (void)map->allocate((CCC_Allocator_context){
+            .input = struct_base(map, node),
+            .bytes = 0,
+            .context = map->context,
+            .old_bytes = map->sizeof_type,
+        });
+        node = next;
+    }
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Builds a tree of count nodes taken in order from the list at cursor. The
+left subtree receives the larger half so its rank is the maximum of the two
+and the rank of the root is one more, or 0 for a leaf. Halving keeps sibling
+ranks within one of each other so every rank difference is 1 or 2, a valid
+WAVL tree in which no leaf is a 2,2 node. The recursion depth is lg N. */
+static struct CCC_Tree_map_node *
+build_sorted(struct CCC_Tree_map const *const map,
+             struct CCC_Tree_map_node **const cursor, size_t const count,
+             size_t *const rank)
+{
+    if (!count)
+    {
+        return NULL;
+    }
+    size_t left_rank = 0;
+    size_t right_rank = 0;
+    struct CCC_Tree_map_node *const left
+        = build_sorted(map, cursor, count / 2, &left_rank);
+    struct CCC_Tree_map_node *const root = *cursor;
+    *cursor = root->branch[R];
+    struct CCC_Tree_map_node *const right
+        = build_sorted(map, cursor, count - (count / 2) - 1, &right_rank);
+    root->branch[L] = left;
+    root->branch[R] = right;
+    if (left)
+    {
+        left->parent = root;
+    }
+    if (right)
+    {
+        right->parent = root;
+    }
+    *rank = left ? left_rank + 1 : 0;
+    root->parity = *rank & 1;
+    if (map->order_statistics)
+    {
+        counted(root)->count = count;
+    }
+    return root;
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
 static inline void
 init_node(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *const e)
 {
     assert(e != NULL);
     assert(map != NULL);
     e->branch[L] = e->branch[R] = e->parent = NULL;
+    if (map->order_statistics)
+    {
+        counted(e)->count = 1;
+    }
     e->parity = 0;
 }
 
+/** A user type about to overwrite a stored element takes over the links,
+parity, and subtree count of the stored node so the tree is unchanged. */
+static inline void
+copy_node(struct CCC_Tree_map const *const map,
+          struct CCC_Tree_map_node *const destination,
+          struct CCC_Tree_map_node const *const source)
+{
+    *destination = *source;
+    if (map->order_statistics)
+    {
+        counted(destination)->count = subtree_count(source);
+    }
+}
+
 static inline void
 swap(void *const temp, void *const a, void *const b, size_t const sizeof_type)
 {
@@ -958,6 +1541,10 @@ remove_fixup(struct CCC_Tree_map *const map,
         {
             p_of_xy->branch[p_of_xy->branch[R] == y] = x;
         }
+        if (map->order_statistics)
+        {
+            subtract_path_count(p_of_xy, 1);
+        }
         two_child = is_2_child(p_of_xy, y);
     }
     else
@@ -975,6 +1562,12 @@ remove_fixup(struct CCC_Tree_map *const map,
 
         two_child = is_2_child(p_of_xy, y);
         p_of_xy->branch[p_of_xy->branch[R] == y] = x;
+        /* The path from the spliced parent passes through remove so the count
+           y inherits from remove in the transplant is already correct. */
+        if (map->order_statistics)
+        {
+            subtract_path_count(p_of_xy, 1);
+        }
         transplant(map, remove, y);
         if (remove == p_of_xy)
         {
@@ -1109,6 +1702,10 @@ transplant(struct CCC_Tree_map *const map,
     }
     replacement->branch[R] = remove->branch[R];
     replacement->branch[L] = remove->branch[L];
+    if (map->order_statistics)
+    {
+        counted(replacement)->count = counted(remove)->count;
+    }
     replacement->parity = parity(remove);
 }
 
@@ -1146,6 +1743,11 @@ rotate(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *const z,
     {
         y->parent = z;
     }
+    if (map->order_statistics)
+    {
+        counted(x)->count = counted(z)->count;
+        update_count(z);
+    }
 }
 
 /** A double rotation shouldn't actually be two calls to rotate because that
@@ -1194,6 +1796,12 @@ double_rotate(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *const z,
     }
     y->branch[!dir] = z;
     z->parent = y;
+    if (map->order_statistics)
+    {
+        counted(y)->count = counted(z)->count;
+        update_count(x);
+        update_count(z);
+    }
 }
 
 /* Returns the parity of a node. A NULL node has a parity of 1 aka CCC_TRUE. */
@@ -1350,6 +1958,642 @@ sibling_of(struct CCC_Tree_map_node const *const x)
     return x->parent->branch[x->parent->branch[L] == x];
 }
 
+/*========================   Order Statistics   =============================*/
+
+/** The node is the first member of a counted node so the cast recovers the
+count. Only a map with order statistics enabled, and therefore counted nodes,
+may call the functions in this section. */
+static inline struct CCC_Tree_map_counted_node *
+counted(struct CCC_Tree_map_node *const x)
+{
+    return (struct CCC_Tree_map_counted_node *)x;
+}
+
+static inline size_t
+subtree_count(struct CCC_Tree_map_node const *const x)
+{
+    return x ? ((struct CCC_Tree_map_counted_node const *)x)->count : 0;
+}
+
+/** Rotations rebuild counts from the children of each moved node. */
+static inline void
+update_count(struct CCC_Tree_map_node *const x)
+{
+    counted(x)->count
+        = 1 + subtree_count(x->branch[L]) + subtree_count(x->branch[R]);
+}
+
+static inline void
+add_path_count(struct CCC_Tree_map_node *x, size_t const n)
+{
+    for (; x; x = x->parent)
+    {
+        counted(x)->count += n;
+    }
+}
+
+static inline void
+subtract_path_count(struct CCC_Tree_map_node *x, size_t const n)
+{
+    for (; x; x = x->parent)
+    {
+        counted(x)->count -= n;
+    }
+}
+
+/** The number of keys in the map strictly less than the given key. */
+static size_t
+rank_of(struct CCC_Tree_map const *const map, void const *const key)
+{
+    size_t rank = 0;
+    struct CCC_Tree_map_node const *node = map->root;
+    while (node)
+    {
+        if (order(map, key, node, map->compare) == CCC_ORDER_GREATER)
+        {
+            rank += subtree_count(node->branch[L]) + 1;
+            node = node->branch[R];
+        }
+        else
+        {
+            node = node->branch[L];
+        }
+    }
+    return rank;
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Counts every subtree in postorder, writing the counts if the map maintains
+them. The recursion depth is bounded by the height of the tree. */
+static size_t
+count_subtrees(struct CCC_Tree_map const *const map,
+               struct CCC_Tree_map_node *const x)
+{
+    if (!x)
+    {
+        return 0;
+    }
+    size_t const count = 1 + count_subtrees(map, x->branch[L])
+                       + count_subtrees(map, x->branch[R]);
+    if (map->order_statistics)
+    {
+        counted(x)->count = count;
+    }
+    return count;
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
+/*=========================   Join and Split   =============================*/
+
+/** Nodes are relinked between maps so the maps must agree on the layout of the
+user type, the ordering of keys, and the memory the nodes came from. */
+static CCC_Tribool
+are_compatible(struct CCC_Tree_map const *const a,
+               struct CCC_Tree_map const *const b)
+{
+    return a != b && a->sizeof_type == b->sizeof_type
+        && a->key_offset == b->key_offset
+        && a->type_intruder_offset == b->type_intruder_offset
+        && a->counted == b->counted && a->compare == b->compare
+        && a->allocate == b->allocate && a->context == b->context;
+}
+
+/** Returns a copy of map to drive a join or split that maintains subtree
+counts if either map does. If only one map has counts the tree of the other is
+counted first. The copy absorbs root writes from rotations on detached trees and
+the caller sets the final roots of the real maps. */
+static struct CCC_Tree_map
+counting_view(struct CCC_Tree_map const *const map,
+              struct CCC_Tree_map const *const other)
+{
+    struct CCC_Tree_map view = *map;
+    if (map->order_statistics != other->order_statistics)
+    {
+        view.order_statistics = true;
+        (void)count_subtrees(&view,
+                             map->order_statistics ? other->root : map->root);
+    }
+    return view;
+}
+
+/** The number of nodes in a tree produced by a split. */
+static size_t
+tree_size(struct CCC_Tree_map const *const map,
+          struct CCC_Tree_map_node *const root)
+{
+    return map->order_statistics ? subtree_count(root)
+                                  : count_subtrees(map, root);
+}
+
+/** Ranks are only stored as parity but a valid rank difference is 1 or 2, so
+the parity of a parent and child tells the two apart. */
+static inline int
+rank_difference(struct CCC_Tree_map_node const *const parent,
+                struct CCC_Tree_map_node const *const child)
+{
+    return parity(parent) == parity(child) ? 2 : 1;
+}
+
+/** Recovers the rank of the root by summing rank differences down to NULL. */
+static struct Subtree
+whole_tree(struct CCC_Tree_map const *const map)
+{
+    int rank = -1;
+    for (struct CCC_Tree_map_node const *x = map->root; x; x = x->branch[L])
+    {
+        rank += rank_difference(x, x->branch[L]);
+    }
+    return (struct Subtree){.root = map->root, .rank = rank};
+}
+
+/** Cuts the child of a node in the given direction loose as its own tree. */
+static struct Subtree
+detach(struct CCC_Tree_map_node *const parent, enum Link const dir,
+       int const parent_rank)
+{
+    struct CCC_Tree_map_node *const child = parent->branch[dir];
+    int const rank = parent_rank - rank_difference(parent, child);
+    parent->branch[dir] = NULL;
+    if (child)
+    {
+        child->parent = NULL;
+    }
+    return (struct Subtree){.root = child, .rank = rank};
+}
+
+/** Joins two trees and a middle node with a key between them. If the ranks are
+within one of each other the middle node becomes the root. Otherwise the middle
+node is placed on the spine of the taller tree. The cost is proportional to the
+difference in rank. */
+static struct Subtree
+join(struct CCC_Tree_map *const map, struct Subtree const lesser,
+     struct CCC_Tree_map_node *const middle, struct Subtree const greater)
+{
+    if (lesser.rank > greater.rank + 1)
+    {
+        return join_spine(map, lesser, middle, greater, R);
+    }
+    if (greater.rank > lesser.rank + 1)
+    {
+        return join_spine(map, greater, middle, lesser, L);
+    }
+    int const rank
+        = (lesser.rank > greater.rank ? lesser.rank : greater.rank) + 1;
+    middle->branch[L] = lesser.root;
+    middle->branch[R] = greater.root;
+    middle->parent = NULL;
+    if (lesser.root)
+    {
+        lesser.root->parent = middle;
+    }
+    if (greater.root)
+    {
+        greater.root->parent = middle;
+    }
+    middle->parity = rank & 1;
+    if (map->order_statistics)
+    {
+        update_count(middle);
+    }
+    return (struct Subtree){.root = middle, .rank = rank};
+}
+
+/** Walks down the spine of the taller tree facing the shorter tree to the first
+node with a rank no more than one above the shorter tree. That node and the
+shorter tree become the children of the middle node which takes its place. The
+parent on the spine had a rank at least two above the shorter tree so the middle
+node is a 0 or 1 child and any rank rule break is repaired on the way up. */
+static struct Subtree
+join_spine(struct CCC_Tree_map *const map, struct Subtree const taller,
+           struct CCC_Tree_map_node *const middle, struct Subtree const shorter,
+           enum Link const dir)
+{
+    struct CCC_Tree_map_node *parent = NULL;
+    struct CCC_Tree_map_node *cut = taller.root;
+    int parent_rank = taller.rank;
+    int cut_rank = taller.rank;
+    while (cut_rank > shorter.rank + 1)
+    {
+        parent = cut;
+        parent_rank = cut_rank;
+        cut_rank -= rank_difference(cut, cut->branch[dir]);
+        cut = cut->branch[dir];
+    }
+    assert(parent != NULL);
+    int const middle_rank = cut_rank + 1;
+    middle->branch[!dir] = cut;
+    middle->branch[dir] = shorter.root;
+    if (cut)
+    {
+        cut->parent = middle;
+    }
+    if (shorter.root)
+    {
+        shorter.root->parent = middle;
+    }
+    middle->parity = middle_rank & 1;
+    middle->parent = parent;
+    parent->branch[dir] = middle;
+    if (map->order_statistics)
+    {
+        for (struct CCC_Tree_map_node *x = middle; x; x = x->parent)
+        {
+            update_count(x);
+        }
+    }
+    int rank = taller.rank;
+    if (parent_rank == middle_rank && join_fixup(map, parent, middle))
+    {
+        ++rank;
+    }
+    struct CCC_Tree_map_node *root = taller.root;
+    while (root->parent)
+    {
+        root = root->parent;
+    }
+    return (struct Subtree){.root = root, .rank = rank};
+}
+
+/** Repairs a 0 child x of z left by a join. This is the insertion fix up with
+one more case. The middle node of a join may be a 1,1 node under a 0,2 parent,
+which insertion never produces. A single rotation lifts x over z and a promotion
+of x leaves it a 1,2 node so the repair continues as an insertion would. Returns
+true if the rank of the root of the whole tree grew. */
+static CCC_Tribool
+join_fixup(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *z,
+           struct CCC_Tree_map_node *x)
+{
+    for (;;)
+    {
+        if (parity(z) != parity(sibling_of(x)))
+        {
+            promote(z);
+            x = z;
+            z = z->parent;
+            if (z == NULL)
+            {
+                return CCC_TRUE;
+            }
+            if (parity(z) != parity(x))
+            {
+                return CCC_FALSE;
+            }
+            continue;
+        }
+        enum Link const p_to_x_dir = z->branch[R] == x;
+        struct CCC_Tree_map_node *const y = x->branch[!p_to_x_dir];
+        if (parity(x) != parity(x->branch[L])
+            && parity(x) != parity(x->branch[R]))
+        {
+            struct CCC_Tree_map_node *const g = z->parent;
+            CCC_Tribool const makes_0_child = g && parity(g) != parity(z);
+            rotate(map, z, x, y, !p_to_x_dir);
+            promote(x);
+            if (g == NULL)
+            {
+                return CCC_TRUE;
+            }
+            if (!makes_0_child)
+            {
+                return CCC_FALSE;
+            }
+            z = g;
+            continue;
+        }
+        if (y == NULL || is_2_child(x, y))
+        {
+            rotate(map, z, x, y, !p_to_x_dir);
+            demote(z);
+        }
+        else
+        {
+            double_rotate(map, z, x, y, p_to_x_dir);
+            promote(y);
+            demote(x);
+            demote(z);
+        }
+        return CCC_FALSE;
+    }
+}
+
+/** Joins two trees without a middle node by borrowing the last node of the
+lesser tree. */
+static struct Subtree
+join_trees(struct CCC_Tree_map *const map, struct Subtree const lesser,
+           struct Subtree const greater)
+{
+    if (!lesser.root)
+    {
+        return greater;
+    }
+    if (!greater.root)
+    {
+        return lesser;
+    }
+    struct CCC_Tree_map_node *last = NULL;
+    struct Subtree const rest = split_last(map, lesser, &last);
+    return join(map, rest, last, greater);
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/** Splits a tree into the nodes less than and greater than the key by cutting
+the search path apart and joining the pieces on each side from the bottom up.
+The joins on each side climb in rank so the total cost is O(lg N). */
+static struct Split
+split(struct CCC_Tree_map *const map, struct Subtree const tree,
+      void const *const key)
+{
+    if (!tree.root)
+    {
+        return (struct Split){
+            .lesser = tree,
+            .greater = tree,
+        };
+    }
+    struct CCC_Tree_map_node *const root = tree.root;
+    struct Subtree const left = detach(root, L, tree.rank);
+    struct Subtree const right = detach(root, R, tree.rank);
+    CCC_Order const o = order(map, key, root, map->compare);
+    if (o == CCC_ORDER_EQUAL)
+    {
+        return (struct Split){
+            .lesser = left,
+            .equal = root,
+            .greater = right,
+        };
+    }
+    if (o == CCC_ORDER_LESSER)
+    {
+        struct Split parts = split(map, left, key);
+        parts.greater = join(map, parts.greater, root, right);
+        return parts;
+    }
+    struct Split parts = split(map, right, key);
+    parts.lesser = join(map, left, root, parts.lesser);
+    return parts;
+}
+
+/** Removes the last node of a tree, handing it back through the output
+parameter, and returns the rest of the tree. */
+static struct Subtree
+split_last(struct CCC_Tree_map *const map, struct Subtree const tree,
+           struct CCC_Tree_map_node **const last)
+{
+    struct CCC_Tree_map_node *const root = tree.root;
+    struct Subtree const left = detach(root, L, tree.rank);
+    if (!root->branch[R])
+    {
+        *last = root;
+        return left;
+    }
+    struct Subtree const rest
+        = split_last(map, detach(root, R, tree.rank), last);
+    return join(map, left, root, rest);
+}
+
+/** The root of tree a splits tree b and each side is merged recursively before
+the root joins them back. A node of b with the same key as the root of a is
+dropped. The recursion follows the height of a and the cost is
+O(M lg(N / M + 1)) for trees of size M and N with M <= N. */
+static struct Subtree
+union_trees(struct Set_operation *const op, struct Subtree const a,
+            struct Subtree const b, size_t const threads)
+{
+    if (!a.root)
+    {
+        return b;
+    }
+    if (!b.root)
+    {
+        return a;
+    }
+    struct CCC_Tree_map_node *const pivot = a.root;
+    struct Halves const sides = {
+        .lesser = detach(pivot, L, a.rank),
+        .greater = detach(pivot, R, a.rank),
+    };
+    struct Split const parts
+        = split(&op->map, b, key_from_node(&op->map, pivot));
+    struct Halves const merged
+        = merge_halves(op, union_trees, sides, &parts, threads);
+    drop(op, parts.equal);
+    return join(&op->map, merged.lesser, pivot, merged.greater);
+}
+
+/** Keeps the root of tree a only if tree b has its key. Every node of b is
+dropped along with the nodes of a that b does not have. */
+static struct Subtree
+intersect_trees(struct Set_operation *const op, struct Subtree const a,
+                struct Subtree const b, size_t const threads)
+{
+    if (!a.root || !b.root)
+    {
+        drop(op, a.root);
+        drop(op, b.root);
+        return (struct Subtree){.rank = -1};
+    }
+    struct CCC_Tree_map_node *const pivot = a.root;
+    struct Halves const sides = {
+        .lesser = detach(pivot, L, a.rank),
+        .greater = detach(pivot, R, a.rank),
+    };
+    struct Split const parts
+        = split(&op->map, b, key_from_node(&op->map, pivot));
+    struct Halves const merged
+        = merge_halves(op, intersect_trees, sides, &parts, threads);
+    if (parts.equal)
+    {
+        drop(op, parts.equal);
+        return join(&op->map, merged.lesser, pivot, merged.greater);
+    }
+    drop(op, pivot);
+    return join_trees(&op->map, merged.lesser, merged.greater);
+}
+
+/** Keeps the root of tree a only if tree b does not have its key. Every node of
+b is dropped along with the nodes of a that b has. */
+static struct Subtree
+subtract_trees(struct Set_operation *const op, struct Subtree const a,
+               struct Subtree const b, size_t const threads)
+{
+    if (!a.root || !b.root)
+    {
+        drop(op, b.root);
+        return a;
+    }
+    struct CCC_Tree_map_node *const pivot = a.root;
+    struct Halves const sides = {
+        .lesser = detach(pivot, L, a.rank),
+        .greater = detach(pivot, R, a.rank),
+    };
+    struct Split const parts
+        = split(&op->map, b, key_from_node(&op->map, pivot));
+    struct Halves const merged
+        = merge_halves(op, subtract_trees, sides, &parts, threads);
+    if (parts.equal)
+    {
+        drop(op, parts.equal);
+        drop(op, pivot);
+        return join_trees(&op->map, merged.lesser, merged.greater);
+    }
+    return join(&op->map, merged.lesser, pivot, merged.greater);
+}
+
+/** Merges the lesser sides of trees a and b and then their greater sides. The
+lesser sides go to a new thread with half of the threads if more than one
+remains and both are large enough. The two sides share no nodes so neither
+thread can see a write of the other. The caller merges both sides if a thread
+cannot be started. */
+static struct Halves
+merge_halves(struct Set_operation *const op, Set_merge *const merge,
+             struct Halves const a, struct Split const *const b,
+             size_t const threads)
+{
+    if (threads > 1 && a.lesser.rank >= PARALLEL_MIN_RANK
+        && b->lesser.rank >= PARALLEL_MIN_RANK)
+    {
+        struct Set_task task = {
+            .operation = {.map = op->map},
+            .merge = merge,
+            .a = a.lesser,
+            .b = b->lesser,
+            .threads = threads / 2,
+        };
+        if (!pthread_create(&task.thread, NULL, merge_task, &task))
+        {
+            struct Subtree const greater
+                = merge(op, a.greater, b->greater, threads - (threads / 2));
+            (void)pthread_join(task.thread, NULL);
+            if (task.operation.dropped)
+            {
+                if (!op->dropped)
+                {
+                    op->last_dropped = task.operation.last_dropped;
+                }
+                task.operation.last_dropped->parent = op->dropped;
+                op->dropped = task.operation.dropped;
+            }
+            return (struct Halves){.lesser = task.merged, .greater = greater};
+        }
+    }
+    struct Subtree const lesser = merge(op, a.lesser, b->lesser, threads);
+    return (struct Halves){
+        .lesser = lesser,
+        .greater = merge(op, a.greater, b->greater, threads),
+    };
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
+/** Merges the lesser halves of a set operation on another thread. */
+static void *
+merge_task(void *const arg)
+{
+    struct Set_task *const task = arg;
+    task->merged
+        = task->merge(&task->operation, task->a, task->b, task->threads);
+    return NULL;
+}
+
+/** Adds a tree with no parent to the trees dropped by a set operation. */
+static void
+drop(struct Set_operation *const op, struct CCC_Tree_map_node *const root)
+{
+    if (!root)
+    {
+        return;
+    }
+    if (!op->dropped)
+    {
+        op->last_dropped = root;
+    }
+    root->parent = op->dropped;
+    op->dropped = root;
+}
+
+/** Runs a set operation and then frees the dropped trees on the calling
+thread. The destination count is corrected by the number of nodes dropped. */
+static CCC_Result
+set_operation(struct CCC_Tree_map *const destination,
+              struct CCC_Tree_map *const source,
+              CCC_Type_destructor *const destroy, Set_merge *const merge,
+              size_t const threads)
+{
+    if (!destination || !source || !are_compatible(destination, source))
+    {
+        return CCC_RESULT_ARGUMENT_ERROR;
+    }
+    struct Set_operation op = {.map = counting_view(destination, source)};
+    destination->root
+        = merge(&op, whole_tree(destination), whole_tree(source), threads)
+              .root;
+    size_t dropped = 0;
+    while (op.dropped)
+    {
+        struct CCC_Tree_map_node *const next = op.dropped->parent;
+        dropped += delete_tree(&op.map, op.dropped, destroy);
+        op.dropped = next;
+    }
+    destination->count = destination->count + source->count - dropped;
+    source->root = NULL;
+    source->count = 0;
+    return CCC_RESULT_OK;
+}
+
+static void
+delete_node(struct CCC_Tree_map *const map,
+            struct CCC_Tree_map_node *const node,
+            CCC_Type_destructor *const destroy)
+{
+    node->branch[L] = node->branch[R] = node->parent = NULL;
+    void *const type = struct_base(map, node);
+    if (destroy)
+    {
+        destroy((CCC_Type_context){
+            .type = type,
+            .context = map->context,
+        });
+    }
+    if (map->allocate)
+    {
+        (void)map->allocate((CCC_Allocator_context){
+            .input = type,
+            .bytes = 0,
+            .context = map->context,
+            .old_bytes = map->sizeof_type,
+        });
+    }
+}
+
+/** This is a linear time constant space deletion of tree nodes via left
+rotations so element fields are modified during progression of deletes. Returns
+the number of nodes deleted. */
+static size_t
+delete_tree(struct CCC_Tree_map *const map, struct CCC_Tree_map_node *node,
+            CCC_Type_destructor *const destroy)
+{
+    size_t deleted = 0;
+    while (node != NULL)
+    {
+        if (node->branch[L] != NULL)
+        {
+            struct CCC_Tree_map_node *const left = node->branch[L];
+            node->branch[L] = left->branch[R];
+            left->branch[R] = node;
+            node = left;
+            continue;
+        }
+        struct CCC_Tree_map_node *const next = node->branch[R];
+        delete_node(map, node, destroy);
+        ++deleted;
+        node = next;
+    }
+    return deleted;
+}
+
 /*===========================   Validation   ===============================*/
 
 /* NOLINTBEGIN(*misc-no-recursion) */
@@ -1423,6 +2667,22 @@ is_storing_parent(struct CCC_Tree_map const *const t,
         && is_storing_parent(t, root, root->branch[R]);
 }
 
+static CCC_Tribool
+are_counts_valid(struct CCC_Tree_map_node const *const root)
+{
+    if (root == NULL)
+    {
+        return CCC_TRUE;
+    }
+    if (subtree_count(root)
+        != 1 + subtree_count(root->branch[L]) + subtree_count(root->branch[R]))
+    {
+        return CCC_FALSE;
+    }
+    return are_counts_valid(root->branch[L])
+        && are_counts_valid(root->branch[R]);
+}
+
 static CCC_Tribool
 validate(struct CCC_Tree_map const *const map)
 {
@@ -1442,6 +2702,10 @@ validate(struct CCC_Tree_map const *const map)
     {
         return CCC_FALSE;
     }
+    if (map->order_statistics && !are_counts_valid(map->root))
+    {
+        return CCC_FALSE;
+    }
     return CCC_TRUE;
 }
 
@@ -6,9 +6,11 @@
 
 #include "array_tree_map.h"
 #include "array_tree_map_utility.h"
+#include "buffer.h"
 #include "checkers.h"
 #include "traits.h"
 #include "types.h"
+#include "utility/allocate.h"
 #include "utility/stack_allocator.h"
 
 check_static_begin(array_tree_map_test_empty)
@@ -303,6 +305,134 @@ check_static_begin(array_tree_map_test_init_with_capacity_fail)
     check_end(array_tree_map_clear_and_free(&map, NULL););
 }
 
+/** Every size up to a few complete trees, and one large size, is built from
+sorted ids, checked in order, and then modified so that the insert and remove
+fix ups run on the parity bits the build assigned. */
+check_static_begin(array_tree_map_test_init_from_sorted)
+{
+    enum : size_t
+    {
+        SMALL_SIZES = 70,
+        MAX_SIZE = 1000,
+    };
+    static struct Val vals[MAX_SIZE];
+    struct Sized_allocator sized = {};
+    Array_tree_map map = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    for (size_t round = 0; round <= SMALL_SIZES; ++round)
+    {
+        size_t const n = round < SMALL_SIZES ? round : MAX_SIZE;
+        for (size_t i = 0; i < n; ++i)
+        {
+            vals[i] = (struct Val){.id = (int)i * 2, .val = (int)i};
+        }
+        CCC_Buffer const buffer
+            = CCC_buffer_initialize(vals, struct Val, NULL, NULL, n, n);
+        check(array_tree_map_from_sorted(&map, &buffer), CCC_RESULT_OK);
+        check(array_tree_map_validate(&map), true);
+        check(array_tree_map_count(&map).count, n);
+        int expected = 0;
+        for (CCC_Handle_index i = begin(&map); i != end(&map);
+             i = next(&map, i))
+        {
+            struct Val const *const v = array_tree_map_at(&map, i);
+            check(v->id, expected * 2);
+            check(v->val, expected);
+            ++expected;
+        }
+        check((size_t)expected, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            CCC_Handle const h = CCC_array_tree_map_try_insert(
+                &map, &(struct Val){.id = (int)i * 2 + 1});
+            check(CCC_handle_insert_error(&h), false);
+            check(CCC_handle_occupied(&h), false);
+        }
+        check(array_tree_map_validate(&map), true);
+        for (size_t i = 0; i < n; i += 2)
+        {
+            struct Val even = {.id = (int)i * 2};
+            CCC_Handle const h
+                = CCC_array_tree_map_remove_key_value(&map, &even);
+            check(CCC_handle_occupied(&h), true);
+        }
+        check(array_tree_map_validate(&map), true);
+        check(array_tree_map_count(&map).count, n + (n / 2));
+        check(array_tree_map_clear_and_free(&map, NULL), CCC_RESULT_OK);
+        check(sized.live_bytes, 0);
+    }
+    check_end((void)array_tree_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(array_tree_map_test_init_from_sorted_fixed)
+{
+    struct Val vals[SMALL_FIXED_CAP];
+    for (size_t i = 0; i < SMALL_FIXED_CAP; ++i)
+    {
+        vals[i] = (struct Val){.id = (int)i, .val = (int)i};
+    }
+    Array_tree_map map
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    /* The sentinel takes one slot so a full Buffer does not fit. */
+    CCC_Buffer const full = CCC_buffer_initialize(
+        vals, struct Val, NULL, NULL, SMALL_FIXED_CAP, SMALL_FIXED_CAP);
+    check(array_tree_map_from_sorted(&map, &full),
+          CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(array_tree_map_is_empty(&map), true);
+    CCC_Buffer const half
+        = CCC_buffer_initialize(vals, struct Val, NULL, NULL,
+                                SMALL_FIXED_CAP / 2, SMALL_FIXED_CAP / 2);
+    check(array_tree_map_from_sorted(&map, &half), CCC_RESULT_OK);
+    check(array_tree_map_validate(&map), true);
+    check(array_tree_map_count(&map).count, SMALL_FIXED_CAP / 2);
+    /* Elements occupy consecutive slots after the sentinel. */
+    check(array_tree_map_get_key_value(&map, &(int){5}), 6);
+    /* The rest of the capacity is on the free list. */
+    for (size_t i = SMALL_FIXED_CAP / 2; i < SMALL_FIXED_CAP - 1; ++i)
+    {
+        CCC_Handle const h = CCC_array_tree_map_try_insert(&map, &vals[i]);
+        check(CCC_handle_insert_error(&h), false);
+    }
+    check(array_tree_map_validate(&map), true);
+    check(array_tree_map_count(&map).count, SMALL_FIXED_CAP - 1);
+    CCC_Handle const h
+        = CCC_array_tree_map_try_insert(&map, &vals[SMALL_FIXED_CAP - 1]);
+    check(CCC_handle_insert_error(&h), true);
+    check_end();
+}
+
+check_static_begin(array_tree_map_test_init_from_sorted_fail)
+{
+    struct Val unsorted[3] = {{.id = 0}, {.id = 2}, {.id = 1}};
+    struct Val repeated[3] = {{.id = 0}, {.id = 1}, {.id = 1}};
+    CCC_Buffer const unsorted_buffer
+        = CCC_buffer_initialize(unsorted, struct Val, NULL, NULL, 3, 3);
+    CCC_Buffer const repeated_buffer
+        = CCC_buffer_initialize(repeated, struct Val, NULL, NULL, 3, 3);
+    int ints[2] = {0, 1};
+    CCC_Buffer const wrong_type
+        = CCC_buffer_initialize(ints, int, NULL, NULL, 2, 2);
+    Array_tree_map map = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, std_allocate, NULL, 0);
+    check(array_tree_map_from_sorted(&map, &unsorted_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_from_sorted(&map, &repeated_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_from_sorted(&map, &wrong_type),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_from_sorted(&map, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_capacity(&map).count, 0);
+    CCC_Handle const h
+        = CCC_array_tree_map_try_insert(&map, &(struct Val){.id = 7});
+    check(CCC_handle_insert_error(&h), false);
+    /* Only an empty map may be built. */
+    check(array_tree_map_from_sorted(&map, &unsorted_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_count(&map).count, 1);
+    check_end((void)array_tree_map_clear_and_free(&map, NULL););
+}
+
 int
 main()
 {
@@ -317,5 +447,8 @@ main()
                      array_tree_map_test_init_from_fail(),
                      array_tree_map_test_init_with_capacity(),
                      array_tree_map_test_init_with_capacity_no_op(),
-                     array_tree_map_test_init_with_capacity_fail());
+                     array_tree_map_test_init_with_capacity_fail(),
+                     array_tree_map_test_init_from_sorted(),
+                     array_tree_map_test_init_from_sorted_fixed(),
+                     array_tree_map_test_init_from_sorted_fail());
 }
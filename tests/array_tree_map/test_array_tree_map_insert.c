@@ -709,6 +709,73 @@ check_static_begin(array_tree_map_test_insert_weak_srand)
     check_end();
 }
 
+check_static_begin(array_tree_map_test_insert_hint)
+{
+    CCC_Array_tree_map map = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, std_allocate, NULL, 0);
+    int const to_insert = 1000;
+    /* Appending after the last insert is the sorted input case hints serve. */
+    CCC_Handle_index hint = 0;
+    for (int i = 0; i < to_insert; i += 2)
+    {
+        CCC_Handle const h = array_tree_map_try_insert_hint(
+            &map, hint, &(struct Val){.id = i, .val = i});
+        check(occupied(&h), false);
+        hint = unwrap(&h);
+        check(hint != 0, true);
+        check(((struct Val *)array_tree_map_at(&map, hint))->id, i);
+    }
+    check(validate(&map), true);
+    /* A far hint walks up to the root and still finds the odd gaps. */
+    CCC_Handle_index const first = begin(&map);
+    for (int i = to_insert - 1; i > 0; i -= 2)
+    {
+        CCC_Handle const h = array_tree_map_insert_or_assign_hint(
+            &map, first, &(struct Val){.id = i, .val = i});
+        check(occupied(&h), false);
+    }
+    check(validate(&map), true);
+    check(count(&map).count, (size_t)to_insert);
+    int expected = 0;
+    for (CCC_Handle_index i = begin(&map); i != end(&map);
+         i = next(&map, i), ++expected)
+    {
+        check(((struct Val *)array_tree_map_at(&map, i))->id, expected);
+    }
+    check(expected, to_insert);
+    /* A hint that is the key itself finds it without descending. */
+    CCC_Handle_index const middle = get_key_value(&map, &(int){to_insert / 2});
+    check(middle != 0, true);
+    CCC_Handle h = array_tree_map_try_insert_hint(
+        &map, middle, &(struct Val){.id = to_insert / 2, .val = -1});
+    check(occupied(&h), true);
+    check(unwrap(&h), middle);
+    struct Val const *const in_table = array_tree_map_at(&map, middle);
+    check(in_table->val, to_insert / 2);
+    h = array_tree_map_insert_or_assign_hint(
+        &map, middle, &(struct Val){.id = to_insert / 2, .val = -1});
+    check(occupied(&h), true);
+    check(in_table->val, -1);
+    /* Handles from a hint match handles from the root. */
+    CCC_Handle_index i = or_insert(
+        array_tree_map_handle_hint_wrap(&map, hint, &(int){to_insert}),
+        &(struct Val){.id = to_insert, .val = to_insert});
+    check(i != 0, true);
+    check(((struct Val *)array_tree_map_at(&map, i))->id, to_insert);
+    i = or_insert(
+        array_tree_map_handle_hint_wrap(&map, i, &(int){-1}),
+        &(struct Val){.id = -1, .val = -1});
+    check(i, begin(&map));
+    /* Out of bounds hints search from the root. */
+    CCC_Array_tree_map_handle const found = array_tree_map_handle_hint(
+        &map, array_tree_map_capacity(&map).count, &(int){to_insert / 2});
+    check(occupied(&found), true);
+    check(unwrap(&found), middle);
+    check(validate(&map), true);
+    check(count(&map).count, (size_t)to_insert + 2);
+    check_end((void)clear_and_free(&map, NULL););
+}
+
 int
 main()
 {
@@ -727,5 +794,6 @@ main()
         array_tree_map_test_resize_from_null_macros(),
         array_tree_map_test_insert_limit(),
         array_tree_map_test_insert_weak_srand(),
-        array_tree_map_test_insert_shuffle());
+        array_tree_map_test_insert_shuffle(),
+        array_tree_map_test_insert_hint());
 }
@@ -13,6 +13,7 @@
 #include "checkers.h"
 #include "traits.h"
 #include "types.h"
+#include "utility/allocate.h"
 
 check_static_begin(check_range, Array_tree_map const *const map,
                    Handle_range const *const r, size_t const n,
@@ -374,6 +375,106 @@ check_static_begin(array_tree_map_test_empty_range)
     check_end();
 }
 
+/** Every position in an inorder walk must agree with rank and select. */
+check_static_begin(order_statistics_check, Array_tree_map const *const s)
+{
+    size_t index = 0;
+    for (CCC_Handle_index i = begin(s); i != end(s); i = next(s, i), ++index)
+    {
+        struct Val const *const v = array_tree_map_at(s, i);
+        check(array_tree_map_select(s, index), i);
+        CCC_Count const rank = array_tree_map_rank(s, &v->id);
+        check(rank.error, CCC_RESULT_OK);
+        check(rank.count, index);
+        check(array_tree_map_count_range(s, &v->id, &(int){v->id + 1}).count,
+              1);
+    }
+    check(index, count(s).count);
+    check(array_tree_map_select(s, index), 0);
+    check_end();
+}
+
+check_static_begin(array_tree_map_test_order_statistics)
+{
+    CCC_Array_tree_map fixed
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    check(array_tree_map_enable_order_statistics(&fixed),
+          CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(array_tree_map_rank(&fixed, &(int){0}).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    CCC_Array_tree_map s = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, std_allocate, NULL, 0);
+    check(array_tree_map_rank(&s, &(int){0}).error, CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_select(&s, 0), 0);
+    check(array_tree_map_enable_order_statistics(&s), CCC_RESULT_OK);
+    check(array_tree_map_rank(&s, &(int){0}).count, 0);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const key_range = 700;
+    for (int i = 0; i < 1000; ++i)
+    {
+        /* Force duplicates. NOLINTNEXTLINE */
+        (void)swap_handle(&s,
+                          &(struct Val){.id = rand() % key_range, .val = i});
+        check(validate(&s), true);
+    }
+    check(order_statistics_check(&s), CHECK_PASS);
+    for (int i = 0; i < 500; ++i)
+    {
+        /* NOLINTNEXTLINE */
+        (void)remove_key_value(&s, &(struct Val){.id = rand() % key_range});
+        check(validate(&s), true);
+    }
+    check(order_statistics_check(&s), CHECK_PASS);
+    check(array_tree_map_count_range(&s, &(int){0}, &(int){key_range}).count,
+          count(&s).count);
+    check(array_tree_map_count_range(&s, &(int){key_range}, &(int){0}).count,
+          0);
+    check_end((void)array_tree_map_clear_and_free(&s, NULL););
+}
+
+check_static_begin(array_tree_map_test_order_statistics_enable_late)
+{
+    struct Sized_allocator sized = {};
+    CCC_Array_tree_map s = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    int const num_nodes = 25;
+    /* 0, 5, 10, 15, 20, 25, 30, 35,... 120 */
+    for (int i = 0, id = 0; i < num_nodes; ++i, id += 5)
+    {
+        (void)insert_or_assign(&s, &(struct Val){.id = id, .val = i});
+    }
+    check(array_tree_map_count_range(&s, &(int){6}, &(int){44}).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_enable_order_statistics(&s), CCC_RESULT_OK);
+    check(validate(&s), true);
+    check(order_statistics_check(&s), CHECK_PASS);
+    /* Absent keys rank at the position they would be inserted. */
+    check(array_tree_map_rank(&s, &(int){6}).count, 2);
+    check(array_tree_map_rank(&s, &(int){-1}).count, 0);
+    check(array_tree_map_rank(&s, &(int){999}).count, num_nodes);
+    /* [6, 44) holds 10 through 40 and [10, 45) is the same range. */
+    check(array_tree_map_count_range(&s, &(int){6}, &(int){44}).count, 7);
+    check(array_tree_map_count_range(&s, &(int){10}, &(int){45}).count, 7);
+    struct Val const *const last
+        = array_tree_map_at(&s, array_tree_map_select(&s, 24));
+    check(last->id, 120);
+    check(array_tree_map_select(&s, 25), 0);
+    /* Growth after enabling carries the counts into the larger allocation. */
+    for (int i = 0, id = 1; i < 100; ++i, id += 5)
+    {
+        (void)insert_or_assign(&s, &(struct Val){.id = id, .val = i});
+    }
+    check(validate(&s), true);
+    check(order_statistics_check(&s), CHECK_PASS);
+    check_end({
+        (void)array_tree_map_clear_and_free(&s, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
 int
 main()
 {
@@ -383,5 +484,7 @@ main()
                      array_tree_map_test_valid_range_equals(),
                      array_tree_map_test_invalid_range(),
                      array_tree_map_test_empty_range(),
-                     array_tree_map_test_iterate_remove_key_value_reinsert());
+                     array_tree_map_test_iterate_remove_key_value_reinsert(),
+                     array_tree_map_test_order_statistics(),
+                     array_tree_map_test_order_statistics_enable_late());
 }
@@ -0,0 +1,311 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRAITS_USING_NAMESPACE_CCC
+#define ARRAY_TREE_MAP_USING_NAMESPACE_CCC
+#define TYPES_USING_NAMESPACE_CCC
+
+#include "array_tree_map.h"
+#include "array_tree_map_utility.h"
+#include "checkers.h"
+#include "traits.h"
+#include "types.h"
+#include "utility/allocate.h"
+
+enum : int
+{
+    KEYS = 1000,
+};
+
+/** The map must hold exactly the keys marked in the expected set in order. */
+check_static_begin(check_keys, Array_tree_map const *const map,
+                   bool const expected[static KEYS])
+{
+    check(validate(map), true);
+    size_t present = 0;
+    for (int key = 0; key < KEYS; ++key)
+    {
+        present += expected[key];
+    }
+    check(count(map).count, present);
+    int prev = -1;
+    size_t seen = 0;
+    for (CCC_Handle_index i = begin(map); i != end(map);
+         i = next(map, i), ++seen)
+    {
+        struct Val const *const v = array_tree_map_at(map, i);
+        check(v->id > prev, true);
+        check(expected[v->id], true);
+        prev = v->id;
+    }
+    check(seen, present);
+    check_end();
+}
+
+/** Fills the map with random keys and records them in the set. */
+check_static_begin(fill_random, Array_tree_map *const map,
+                   bool set[static KEYS], int const tries)
+{
+    for (int i = 0; i < tries; ++i)
+    {
+        int const id = rand() % KEYS; /* NOLINT */
+        CCC_Handle const h
+            = insert_or_assign(map, &(struct Val){.id = id, .val = i});
+        check(insert_error(&h), false);
+        set[id] = true;
+    }
+    check_end();
+}
+
+static void
+count_destroyed(CCC_Type_context const context)
+{
+    ++*(size_t *)context.context;
+}
+
+check_static_begin(array_tree_map_test_set_operations, int const lhs_tries,
+                   int const rhs_tries)
+{
+    struct Sized_allocator sized = {};
+    Array_tree_map a = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    Array_tree_map b = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, std_allocate, NULL, 0);
+    bool a_keys[KEYS] = {};
+    bool b_keys[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+
+    check(fill_random(&a, a_keys, lhs_tries), CHECK_PASS);
+    check(fill_random(&b, b_keys, rhs_tries), CHECK_PASS);
+    check(array_tree_map_union(&a, &b), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        a_keys[key] = a_keys[key] || b_keys[key];
+    }
+    check(check_keys(&a, a_keys), CHECK_PASS);
+    /* The source of a set operation is only read. */
+    check(check_keys(&b, b_keys), CHECK_PASS);
+
+    check(array_tree_map_clear_and_free(&b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        b_keys[key] = false;
+    }
+    check(fill_random(&b, b_keys, rhs_tries), CHECK_PASS);
+    check(array_tree_map_intersection(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        a_keys[key] = a_keys[key] && b_keys[key];
+    }
+    check(check_keys(&a, a_keys), CHECK_PASS);
+    check(check_keys(&b, b_keys), CHECK_PASS);
+
+    check(fill_random(&a, a_keys, lhs_tries), CHECK_PASS);
+    check(array_tree_map_difference(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        a_keys[key] = a_keys[key] && !b_keys[key];
+    }
+    check(check_keys(&a, a_keys), CHECK_PASS);
+    check(check_keys(&b, b_keys), CHECK_PASS);
+    check_end({
+        (void)array_tree_map_clear_and_free(&a, NULL);
+        (void)array_tree_map_clear_and_free(&b, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(array_tree_map_test_set_operations_fixed)
+{
+    Array_tree_map a
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    Array_tree_map b = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, std_allocate, NULL, 0);
+    /* The counts array would need a larger allocation. */
+    check(array_tree_map_enable_order_statistics(&a),
+          CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    for (int id = 0; id < 40; ++id)
+    {
+        (void)insert_or_assign(&a, &(struct Val){.id = id, .val = id});
+    }
+    for (int id = 30; id < 60; ++id)
+    {
+        (void)insert_or_assign(&b, &(struct Val){.id = id, .val = -id});
+    }
+    /* Room is reserved for all 30 source elements but only 23 are free. */
+    check(array_tree_map_union(&a, &b), CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(count(&a).count, 40);
+    check(validate(&a), true);
+    size_t destroyed = 0;
+    Array_tree_map counting = a;
+    counting.context = &destroyed;
+    check(array_tree_map_difference(&counting, &b, count_destroyed),
+          CCC_RESULT_OK);
+    check(destroyed, 10);
+    check(count(&counting).count, 30);
+    check(array_tree_map_union(&counting, &b), CCC_RESULT_OK);
+    check(count(&counting).count, 60);
+    check(validate(&counting), true);
+    struct Val const *const copied
+        = array_tree_map_at(&counting, get_key_value(&counting, &(int){45}));
+    check(copied->val, -45);
+    check(array_tree_map_intersection(&counting, &b, count_destroyed),
+          CCC_RESULT_OK);
+    check(destroyed, 40);
+    check(count(&counting).count, 30);
+    check(validate(&counting), true);
+    check_end((void)array_tree_map_clear_and_free(&b, NULL););
+}
+
+check_static_begin(array_tree_map_test_split_join, int const split_key)
+{
+    struct Sized_allocator sized = {};
+    Array_tree_map map = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    Array_tree_map greater
+        = array_tree_map_initialize(&(Standard_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, STANDARD_FIXED_CAP);
+    bool keys[KEYS] = {};
+    bool expected[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    check(fill_random(&map, keys, KEYS / 2), CHECK_PASS);
+    check(array_tree_map_split(&map, &split_key, &greater), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key < split_key;
+    }
+    check(check_keys(&map, expected), CHECK_PASS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key >= split_key;
+    }
+    check(check_keys(&greater, expected), CHECK_PASS);
+    check(array_tree_map_join(&map, &greater), CCC_RESULT_OK);
+    check(check_keys(&map, keys), CHECK_PASS);
+    check(is_empty(&greater), true);
+    check(validate(&greater), true);
+    check_end({
+        (void)array_tree_map_clear_and_free(&map, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(array_tree_map_test_extract_range)
+{
+    struct Sized_allocator sized = {};
+    Array_tree_map map = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    Array_tree_map range = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    Array_tree_map upper = array_tree_map_initialize(
+        NULL, struct Val, id, id_order, sized_allocate, &sized, 0);
+    check(array_tree_map_enable_order_statistics(&map), CCC_RESULT_OK);
+    bool keys[KEYS] = {};
+    bool expected[KEYS] = {};
+    for (int id = 0; id < KEYS; id += 3)
+    {
+        (void)insert_or_assign(&map, &(struct Val){.id = id});
+        keys[id] = true;
+    }
+    int const begin_key = 100;
+    int const end_key = 601;
+    check(array_tree_map_extract_range(&map, &begin_key, &end_key, &range),
+          CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key >= begin_key && key < end_key;
+    }
+    check(check_keys(&range, expected), CHECK_PASS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && (key < begin_key || key >= end_key);
+    }
+    check(check_keys(&map, expected), CHECK_PASS);
+    check(array_tree_map_rank(&map, &end_key).count, count(&map).count - 133);
+    /* The range put back between the remaining halves restores the map. */
+    check(array_tree_map_split(&map, &end_key, &upper), CCC_RESULT_OK);
+    check(array_tree_map_join(&map, &range), CCC_RESULT_OK);
+    check(array_tree_map_join(&map, &upper), CCC_RESULT_OK);
+    check(check_keys(&map, keys), CHECK_PASS);
+    /* A backwards range moves nothing. */
+    check(array_tree_map_extract_range(&map, &end_key, &begin_key, &range),
+          CCC_RESULT_OK);
+    check(is_empty(&range), true);
+    check(check_keys(&map, keys), CHECK_PASS);
+    check_end({
+        (void)array_tree_map_clear_and_free(&map, NULL);
+        (void)array_tree_map_clear_and_free(&range, NULL);
+        (void)array_tree_map_clear_and_free(&upper, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(array_tree_map_test_join_split_arguments)
+{
+    Array_tree_map a
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    Array_tree_map b
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    Array_tree_map full
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    Array_tree_map rest
+        = array_tree_map_initialize(&(Small_fixed_map){}, struct Val, id,
+                                    id_order, NULL, NULL, SMALL_FIXED_CAP);
+    for (int id = 0; id < 10; ++id)
+    {
+        (void)insert_or_assign(&a, &(struct Val){.id = id});
+        (void)insert_or_assign(&b, &(struct Val){.id = id + 9});
+    }
+    for (int id = 100; id < 160; ++id)
+    {
+        (void)insert_or_assign(&full, &(struct Val){.id = id});
+    }
+    /* Key 9 is in both maps so b does not follow a. */
+    check(array_tree_map_join(&a, &b), CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_join(&a, &a), CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_split(&a, &(int){5}, &b), CCC_RESULT_ARGUMENT_ERROR);
+    check(array_tree_map_union(&a, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    /* A failed move leaves both maps as they were. */
+    check(array_tree_map_join(&a, &full), CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(array_tree_map_split(&full, &(int){0}, &a),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(count(&a).count, 10);
+    check(count(&full).count, 60);
+    check(validate(&a), true);
+    check(validate(&full), true);
+    check(array_tree_map_difference(&b, &a, NULL), CCC_RESULT_OK);
+    check(count(&b).count, 9);
+    check(array_tree_map_split(&a, &(int){0}, &rest), CCC_RESULT_OK);
+    check(is_empty(&a), true);
+    check(count(&rest).count, 10);
+    check(array_tree_map_join(&a, &b), CCC_RESULT_OK);
+    check(count(&a).count, 9);
+    check(is_empty(&b), true);
+    check(validate(&a), true);
+    check(validate(&b), true);
+    check_end();
+}
+
+int
+main()
+{
+    return check_run(array_tree_map_test_set_operations(500, 500),
+                     array_tree_map_test_set_operations(900, 20),
+                     array_tree_map_test_set_operations(20, 900),
+                     array_tree_map_test_set_operations_fixed(),
+                     array_tree_map_test_split_join(KEYS / 2),
+                     array_tree_map_test_split_join(0),
+                     array_tree_map_test_split_join(KEYS),
+                     array_tree_map_test_extract_range(),
+                     array_tree_map_test_join_split_arguments());
+}
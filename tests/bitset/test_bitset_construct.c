@@ -1,8 +1,10 @@
 #include <stddef.h>
+#include <stdint.h>
 
 #include "ccc/bitset.h"
 #include "ccc/types.h"
 #include "checkers.h"
+#include "utility/allocate.h"
 #include "utility/stack_allocator.h"
 #include "utility/string_view/string_view.h"
 
@@ -215,6 +217,28 @@ check_static_begin(bitset_test_init_with_capacity_fail)
     check_end(CCC_bitset_clear_and_free(&b););
 }
 
+/** Every bit must survive growth through an allocator that copies only the
+old bytes the bit set reports, and all bytes must be returned on free. */
+check_static_begin(bitset_test_sized_allocator)
+{
+    struct Sized_allocator sized = {};
+    CCC_Bitset b = CCC_bitset_initialize(NULL, sized_allocate, &sized, 0);
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        check(CCC_bitset_push_back(&b, i % 3 == 0), CCC_RESULT_OK);
+        check((uintptr_t)CCC_bitset_data(&b) % 64, 0);
+    }
+    check(sized.live_bytes, CCC_bitset_blocks_capacity(&b).count
+                                * sizeof(*(CCC_Bitset){}.blocks));
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        check(CCC_bitset_test(&b, i), i % 3 == 0);
+    }
+    check(CCC_bitset_clear_and_free(&b), CCC_RESULT_OK);
+    check(sized.live_bytes, 0);
+    check_end(CCC_bitset_clear_and_free(&b););
+}
+
 int
 main(void)
 {
@@ -224,5 +248,5 @@ main(void)
         bitset_test_init_from(), bitset_test_init_from_cap(),
         bitset_test_init_from_fail(), bitset_test_init_from_cap_fail(),
         bitset_test_init_with_capacity(),
-        bitset_test_init_with_capacity_fail());
+        bitset_test_init_with_capacity_fail(), bitset_test_sized_allocator());
 }
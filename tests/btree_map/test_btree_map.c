@@ -0,0 +1,542 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BTREE_MAP_USING_NAMESPACE_CCC
+#define TYPES_USING_NAMESPACE_CCC
+
+#include "ccc/btree_map.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+enum : int
+{
+    KEYS = 2000,
+};
+
+enum : size_t
+{
+    PAYLOAD = 200,
+};
+
+struct Val
+{
+    int key;
+    int val;
+};
+
+/* Large enough that nodes grow past the default and hold few records. */
+struct Record
+{
+    int key;
+    unsigned char payload[PAYLOAD];
+};
+
+/** The map context is shared by the allocator, the comparator, and the
+destructor. */
+struct Counting_allocator
+{
+    struct Sized_allocator sized;
+    int destroyed;
+    size_t compares;
+};
+
+/** An allocator that fails once its budget of allocations is spent. */
+struct Budget_allocator
+{
+    struct Sized_allocator sized;
+    size_t remaining;
+};
+
+static CCC_Order
+val_order(CCC_Key_comparator_context const order)
+{
+    int const key = *(int const *)order.key_left;
+    struct Val const *const right = order.type_right;
+    return (key > right->key) - (key < right->key);
+}
+
+static CCC_Order
+counted_val_order(CCC_Key_comparator_context const order)
+{
+    ++((struct Counting_allocator *)order.context)->compares;
+    return val_order(order);
+}
+
+static CCC_Order
+record_order(CCC_Key_comparator_context const order)
+{
+    int const key = *(int const *)order.key_left;
+    struct Record const *const right = order.type_right;
+    return (key > right->key) - (key < right->key);
+}
+
+static void
+plus_one(CCC_Type_context const t)
+{
+    ++((struct Val *)t.type)->val;
+}
+
+static void
+count_destroyed(CCC_Type_context const t)
+{
+    ++((struct Counting_allocator *)t.context)->destroyed;
+}
+
+/** Ignores every alignment request. Blocks are shifted by a maximal alignment
+from a block aligned as requested so no node is ever aligned to its size. */
+static void *
+misaligned_allocate(CCC_Allocator_context const context)
+{
+    size_t const shift = alignof(max_align_t);
+    if (!context.input)
+    {
+        char *const block = sized_allocate((CCC_Allocator_context){
+            .bytes = context.bytes ? context.bytes + shift : 0,
+            .context = context.context,
+            .alignment
+            = context.alignment > shift ? context.alignment : shift * 2,
+        });
+        return block ? block + shift : NULL;
+    }
+    assert(!context.bytes);
+    return sized_allocate((CCC_Allocator_context){
+        .input = (char *)context.input - shift,
+        .context = context.context,
+        .old_bytes = context.old_bytes + shift,
+    });
+}
+
+/** Counts every allocation against the budget while ignoring alignment. */
+static void *
+misaligned_budget_allocate(CCC_Allocator_context const context)
+{
+    struct Budget_allocator *const budget = context.context;
+    if (context.bytes && !context.input)
+    {
+        --budget->remaining;
+    }
+    return misaligned_allocate(context);
+}
+
+static void *
+budget_allocate(CCC_Allocator_context const context)
+{
+    struct Budget_allocator *const budget = context.context;
+    if (context.bytes && !context.input)
+    {
+        if (!budget->remaining)
+        {
+            return NULL;
+        }
+        --budget->remaining;
+    }
+    return sized_allocate((CCC_Allocator_context){
+        .input = context.input,
+        .bytes = context.bytes,
+        .context = &budget->sized,
+        .alignment = context.alignment,
+        .old_bytes = context.old_bytes,
+    });
+}
+
+/** The map must hold exactly the keys marked in the expected set, in order
+both ways, each with its key as its value. */
+check_static_begin(check_keys, Btree_map const *const map,
+                   bool const expected[static KEYS])
+{
+    check(btree_map_validate(map), true);
+    size_t present = 0;
+    for (int key = 0; key < KEYS; ++key)
+    {
+        present += expected[key];
+        check(btree_map_contains(map, &key), expected[key]);
+    }
+    check(btree_map_count(map).count, present);
+    size_t seen = 0;
+    int prev = -1;
+    for (struct Val const *i = btree_map_begin(map); i != btree_map_end(map);
+         i = btree_map_next(map, i), ++seen)
+    {
+        check(i->key > prev, true);
+        check(expected[i->key], true);
+        check(i->val, i->key);
+        prev = i->key;
+    }
+    check(seen, present);
+    seen = 0;
+    prev = KEYS;
+    for (struct Val const *i = btree_map_reverse_begin(map);
+         i != btree_map_reverse_end(map);
+         i = btree_map_reverse_next(map, i), ++seen)
+    {
+        check(i->key < prev, true);
+        prev = i->key;
+    }
+    check(seen, present);
+    check_end();
+}
+
+check_static_begin(btree_map_test_random, CCC_Allocator *const allocate)
+{
+    /* The standard allocator ignores alignment requests and the context. */
+    struct Counting_allocator counting = {};
+    Btree_map map = btree_map_initialize(struct Val, key, counted_val_order,
+                                         allocate, &counting);
+    bool expected[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    for (int i = 0; i < KEYS; ++i)
+    {
+        int const key = rand() % KEYS; /* NOLINT */
+        CCC_Entry const e
+            = btree_map_insert_or_assign(&map, &(struct Val){key, key});
+        check(entry_insert_error(&e), false);
+        check(entry_occupied(&e), expected[key]);
+        check(((struct Val *)entry_unwrap(&e))->key, key);
+        expected[key] = true;
+        check(btree_map_validate(&map), true);
+    }
+    /* Every node is aligned however the allocator behaves so iteration
+       finds each leaf by its address rather than by comparing keys. */
+    check((uintptr_t)map.root % map.node_bytes, 0);
+    if (allocate != std_allocate)
+    {
+        check(map.root->padded, allocate == misaligned_allocate);
+        check(map.pad_nodes, allocate == misaligned_allocate);
+    }
+    size_t const compares = counting.compares;
+    size_t seen = 0;
+    for (struct Val const *i = btree_map_begin(&map); i != btree_map_end(&map);
+         i = btree_map_next(&map, i))
+    {
+        ++seen;
+    }
+    for (struct Val const *i = btree_map_reverse_begin(&map);
+         i != btree_map_reverse_end(&map); i = btree_map_reverse_next(&map, i))
+    {
+        ++seen;
+    }
+    check(seen, 2 * btree_map_count(&map).count);
+    check(counting.compares, compares);
+    check(check_keys(&map, expected), CHECK_PASS);
+    for (int i = 0; i < KEYS; ++i)
+    {
+        int const key = rand() % KEYS; /* NOLINT */
+        struct Val out = {.key = key};
+        CCC_Entry const e = btree_map_remove_key_value(&map, &out);
+        check(entry_occupied(&e), expected[key]);
+        if (expected[key])
+        {
+            check(entry_unwrap(&e) == &out, true);
+            check(out.val, key);
+        }
+        expected[key] = false;
+        check(btree_map_validate(&map), true);
+    }
+    check(check_keys(&map, expected), CHECK_PASS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        CCC_Entry const e = btree_map_remove_entry(btree_map_entry_wrap(&map,
+                                                                        &key));
+        check(entry_occupied(&e), expected[key]);
+        expected[key] = false;
+    }
+    check(btree_map_is_empty(&map), true);
+    check(check_keys(&map, expected), CHECK_PASS);
+    check_end({
+        (void)btree_map_clear(&map, NULL);
+        check(counting.sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(btree_map_test_large_records)
+{
+    struct Sized_allocator sized = {};
+    Btree_map map = btree_map_initialize(struct Record, key, record_order,
+                                         sized_allocate, &sized);
+    /* Ascending then descending keys split and merge only at the edges. */
+    for (int key = 0; key < KEYS; key += 2)
+    {
+        struct Record r = {.key = key};
+        (void)memset(r.payload, key & 0xFF, PAYLOAD);
+        CCC_Entry const e = btree_map_try_insert(&map, &r);
+        check(entry_occupied(&e), false);
+    }
+    for (int key = KEYS - 1; key > 0; key -= 2)
+    {
+        struct Record r = {.key = key};
+        (void)memset(r.payload, key & 0xFF, PAYLOAD);
+        CCC_Entry const e = btree_map_try_insert(&map, &r);
+        check(entry_occupied(&e), false);
+    }
+    check(btree_map_validate(&map), true);
+    check(btree_map_count(&map).count, KEYS);
+    check(map.node_bytes > 512, true);
+    check(map.leaf_capacity < 16, true);
+    int expected = 0;
+    for (struct Record const *i = btree_map_begin(&map);
+         i != btree_map_end(&map); i = btree_map_next(&map, i), ++expected)
+    {
+        check(i->key, expected);
+        check(i->payload[0], expected & 0xFF);
+        check(i->payload[PAYLOAD - 1], expected & 0xFF);
+    }
+    check(expected, KEYS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        struct Record out = {.key = key};
+        CCC_Entry const e = btree_map_remove_key_value(&map, &out);
+        check(entry_occupied(&e), true);
+        check(out.payload[PAYLOAD / 2], key & 0xFF);
+        if (key % 97 == 0)
+        {
+            check(btree_map_validate(&map), true);
+        }
+    }
+    check(btree_map_is_empty(&map), true);
+    check(sized.live_bytes, 0);
+    check_end((void)btree_map_clear(&map, NULL););
+}
+
+check_static_begin(btree_map_test_entry_interface)
+{
+    struct Counting_allocator counting = {};
+    Btree_map map = btree_map_initialize(struct Val, key, val_order,
+                                         sized_allocate, &counting);
+    for (int key = 0; key < 100; ++key)
+    {
+        struct Val *const v = btree_map_or_insert(
+            btree_map_entry_wrap(&map, &key), &(struct Val){key, key});
+        check(v != NULL, true);
+        check(v->key, key);
+    }
+    int const key = 50;
+    Btree_map_entry *e = btree_map_entry_wrap(&map, &key);
+    check(btree_map_occupied(e), true);
+    e = btree_map_and_modify(e, plus_one);
+    check(((struct Val *)btree_map_unwrap(e))->val, key + 1);
+    struct Val *v = btree_map_insert_entry(btree_map_entry_wrap(&map, &key),
+                                           &(struct Val){key, -1});
+    check(v->val, -1);
+    v = btree_map_or_insert(btree_map_entry_wrap(&map, &key),
+                            &(struct Val){key, 7});
+    check(v->val, -1);
+    struct Val swapped = {key, 9};
+    CCC_Entry const s = btree_map_swap_entry(&map, &swapped);
+    check(entry_occupied(&s), true);
+    check(swapped.val, -1);
+    check(((struct Val *)btree_map_get_key_value(&map, &key))->val, 9);
+    CCC_Entry const t = btree_map_try_insert(&map, &(struct Val){key, 3});
+    check(entry_occupied(&t), true);
+    check(((struct Val *)entry_unwrap(&t))->val, 9);
+    int const absent = 1000;
+    e = btree_map_entry_wrap(&map, &absent);
+    check(btree_map_occupied(e), false);
+    check(btree_map_unwrap(e) == NULL, true);
+    check(btree_map_and_modify(e, plus_one) == e, true);
+    v = btree_map_insert_entry(e, &(struct Val){absent, absent});
+    check(v != NULL, true);
+    check(btree_map_reverse_begin(&map) == v, true);
+    CCC_Entry const r
+        = btree_map_remove_entry(btree_map_entry_wrap(&map, &key));
+    check(entry_occupied(&r), true);
+    check(btree_map_contains(&map, &key), false);
+    check(btree_map_count(&map).count, 100);
+    check(btree_map_validate(&map), true);
+    check(btree_map_clear(&map, count_destroyed), CCC_RESULT_OK);
+    check(counting.destroyed, 100);
+    check(counting.sized.live_bytes, 0);
+    check_end((void)btree_map_clear(&map, NULL););
+}
+
+check_static_begin(btree_map_test_entry_with)
+{
+    struct Counting_allocator counting = {};
+    Btree_map map = btree_map_initialize(struct Val, key, val_order,
+                                         sized_allocate, &counting);
+    for (int key = 0; key < 100; ++key)
+    {
+        CCC_Entry const *const e
+            = btree_map_try_insert_with(&map, key, (struct Val){.val = key});
+        check(entry_occupied(e), false);
+        check(((struct Val *)entry_unwrap(e))->key, key);
+    }
+    int const key = 50;
+    /* The lazy value is not built when the key is present. */
+    int built = 0;
+    CCC_Entry const *e
+        = btree_map_try_insert_with(&map, key, (struct Val){.val = ++built});
+    check(entry_occupied(e), true);
+    check(built, 0);
+    check(((struct Val *)entry_unwrap(e))->val, key);
+    e = btree_map_insert_or_assign_with(&map, key, (struct Val){.val = -1});
+    check(entry_occupied(e), true);
+    check(((struct Val *)btree_map_get_mut(&map, &key))->val, -1);
+    e = btree_map_insert_or_assign_with(&map, 100, (struct Val){.val = 100});
+    check(entry_occupied(e), false);
+    check(((struct Val *)entry_unwrap(e))->key, 100);
+    struct Val *v = btree_map_or_insert_with(
+        btree_map_and_modify_with(btree_map_entry_wrap(&map, &key), struct Val,
+                                  { T->val = 7; }),
+        (struct Val){.key = key, .val = ++built});
+    check(v->val, 7);
+    check(built, 0);
+    int const absent = 1000;
+    v = btree_map_or_insert_with(
+        btree_map_and_modify_wrap(btree_map_entry_wrap(&map, &absent),
+                                  plus_one),
+        (struct Val){.key = absent, .val = ++built});
+    check(v->key, absent);
+    check(built, 1);
+    v = btree_map_insert_entry_with(btree_map_entry_wrap(&map, &absent),
+                                    (struct Val){.key = absent, .val = 3});
+    check(v->val, 3);
+    Btree_map_entry *const entry = btree_map_and_modify_wrap(
+        btree_map_entry_wrap(&map, &absent), plus_one);
+    check(btree_map_entry_status(entry), CCC_ENTRY_OCCUPIED);
+    check(((struct Val *)btree_map_unwrap_mut(entry))->val, 4);
+    CCC_Entry const *const r
+        = btree_map_remove_entry_wrap(btree_map_entry_wrap(&map, &absent));
+    check(entry_occupied(r), true);
+    check(btree_map_get_mut(&map, &absent) == NULL, true);
+    check(btree_map_entry_status(btree_map_entry_wrap(&map, &absent)),
+          CCC_ENTRY_VACANT);
+    check(btree_map_entry_status(NULL), CCC_ENTRY_ARGUMENT_ERROR);
+    check(btree_map_entry_status(btree_map_and_modify_wrap(NULL, plus_one)),
+          CCC_ENTRY_ARGUMENT_ERROR);
+    check(btree_map_or_insert_with(btree_map_and_modify_wrap(NULL, plus_one),
+                                   (struct Val){})
+              == NULL,
+          true);
+    check(btree_map_count(&map).count, (size_t)101);
+    check(btree_map_validate(&map), true);
+    check_end((void)btree_map_clear(&map, NULL););
+}
+
+check_static_begin(btree_map_test_ranges)
+{
+    Btree_map map
+        = btree_map_initialize(struct Val, key, val_order, std_allocate, NULL);
+    for (int key = 0; key < KEYS; key += 3)
+    {
+        (void)btree_map_insert_or_assign(&map, &(struct Val){key, key});
+    }
+    /* [100, 601) holds the multiples of three from 102 through 600. */
+    CCC_Range const *const range
+        = btree_map_equal_range_wrap(&map, &(int){100}, &(int){601});
+    int expected = 102;
+    for (struct Val const *i = range_begin(range); i != range_end(range);
+         i = btree_map_next(&map, i), expected += 3)
+    {
+        check(i->key, expected);
+    }
+    check(expected, 603);
+    /* An end key in the map is included as in the tree map. */
+    CCC_Range const *const inclusive
+        = btree_map_equal_range_wrap(&map, &(int){3}, &(int){9});
+    check(((struct Val *)range_begin(inclusive))->key, 3);
+    check(((struct Val *)range_end(inclusive))->key, 12);
+    CCC_Range_reverse const *const reverse
+        = btree_map_equal_range_reverse_wrap(&map, &(int){601}, &(int){100});
+    expected = 600;
+    for (struct Val const *i = range_reverse_begin(reverse);
+         i != range_reverse_end(reverse);
+         i = btree_map_reverse_next(&map, i), expected -= 3)
+    {
+        check(i->key, expected);
+    }
+    check(expected, 99);
+    CCC_Range const *const past
+        = btree_map_equal_range_wrap(&map, &(int){KEYS}, &(int){KEYS + 10});
+    check(range_begin(past) == NULL, true);
+    check(range_end(past) == NULL, true);
+    CCC_Range_reverse const *const before
+        = btree_map_equal_range_reverse_wrap(&map, &(int){-1}, &(int){-5});
+    check(range_reverse_begin(before) == NULL, true);
+    check_end((void)btree_map_clear(&map, NULL););
+}
+
+check_static_begin(btree_map_test_failed_allocation)
+{
+    struct Budget_allocator budget = {.remaining = 8};
+    Btree_map map = btree_map_initialize(struct Val, key, val_order,
+                                         budget_allocate, &budget);
+    int key = 0;
+    for (;; ++key)
+    {
+        CCC_Entry const e
+            = btree_map_try_insert(&map, &(struct Val){key, key});
+        if (entry_insert_error(&e))
+        {
+            break;
+        }
+    }
+    /* The split that failed allocated nothing and moved nothing. */
+    check(btree_map_count(&map).count, (size_t)key);
+    check(btree_map_contains(&map, &key), false);
+    check(btree_map_validate(&map), true);
+    check(budget.remaining <= 1, true);
+    Btree_map none
+        = btree_map_initialize(struct Val, key, val_order, NULL, NULL);
+    CCC_Entry const e = btree_map_insert_or_assign(&none, &(struct Val){});
+    check(entry_insert_error(&e), true);
+    check(btree_map_or_insert(btree_map_entry_wrap(&none, &key),
+                              &(struct Val){key, key})
+              == NULL,
+          true);
+    check(btree_map_is_empty(&none), true);
+    CCC_Entry const bad = btree_map_try_insert(NULL, &(struct Val){});
+    check(CCC_entry_input_error(&bad), true);
+    check(btree_map_validate(NULL), CCC_TRIBOOL_ERROR);
+    check_end({
+        (void)btree_map_clear(&map, NULL);
+        check(budget.sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(btree_map_test_padded_allocations)
+{
+    size_t const budget_start = 100000;
+    struct Budget_allocator budget = {.remaining = budget_start};
+    Btree_map map = btree_map_initialize(
+        struct Val, key, val_order, misaligned_budget_allocate, &budget);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        CCC_Entry const e
+            = btree_map_try_insert(&map, &(struct Val){key, key});
+        check(entry_insert_error(&e), false);
+    }
+    check(map.pad_nodes, true);
+    /* Only the first node wastes an aligned attempt. Every later node is one
+       padded allocation of two nodes behind the misaligned shift. */
+    size_t const padded_bytes = (2 * map.node_bytes) + alignof(max_align_t);
+    check(budget.sized.live_bytes % padded_bytes, 0);
+    size_t const nodes = budget.sized.live_bytes / padded_bytes;
+    check(nodes > 1, true);
+    check(budget_start - budget.remaining, nodes + 1);
+    check_end({
+        (void)btree_map_clear(&map, NULL);
+        check(budget.sized.live_bytes, 0);
+    });
+}
+
+int
+main()
+{
+    return check_run(btree_map_test_random(sized_allocate),
+                     btree_map_test_random(misaligned_allocate),
+                     btree_map_test_random(std_allocate),
+                     btree_map_test_large_records(),
+                     btree_map_test_entry_interface(),
+                     btree_map_test_entry_with(), btree_map_test_ranges(),
+                     btree_map_test_failed_allocation(),
+                     btree_map_test_padded_allocations());
+}
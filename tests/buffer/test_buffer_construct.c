@@ -1,4 +1,5 @@
 #include <stddef.h>
+#include <stdint.h>
 
 #define BUFFER_USING_NAMESPACE_CCC
 
@@ -197,6 +198,30 @@ check_static_begin(buffer_test_init_with_capacity_fail)
     check_end(CCC_buffer_clear_and_free(&b, NULL););
 }
 
+/** The sized allocator resizes without realloc so every element survives
+growth only if the buffer reports the bytes it held before. */
+check_static_begin(buffer_test_sized_allocator)
+{
+    struct Sized_allocator sized = {};
+    Buffer b = buffer_initialize(NULL, int, sized_allocate, &sized, 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        check(buffer_push_back(&b, &i) != NULL, CCC_TRUE);
+        check((uintptr_t)buffer_begin(&b) % 64, 0);
+    }
+    check(sized.live_bytes, buffer_capacity(&b).count * sizeof(int));
+    int expected = 0;
+    for (int const *i = buffer_begin(&b); i != buffer_end(&b);
+         i = buffer_next(&b, i))
+    {
+        check(*i, expected);
+        ++expected;
+    }
+    check(buffer_clear_and_free(&b, NULL), CCC_RESULT_OK);
+    check(sized.live_bytes, 0);
+    check_end(buffer_clear_and_free(&b, NULL););
+}
+
 int
 main(void)
 {
@@ -207,5 +232,5 @@ main(void)
         buffer_test_copy_allocate(), buffer_test_copy_allocate_fail(),
         buffer_test_init_from(), buffer_test_init_from_fail(),
         buffer_test_init_with_capacity(),
-        buffer_test_init_with_capacity_fail());
+        buffer_test_init_with_capacity_fail(), buffer_test_sized_allocator());
 }
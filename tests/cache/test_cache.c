@@ -0,0 +1,298 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#define CACHE_USING_NAMESPACE_CCC
+
+#include "ccc/cache.h"
+#include "ccc/hash.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+struct Page
+{
+    uint32_t id;
+    uint32_t value;
+};
+
+cache_declare_fixed_s3_fifo(Small_page_cache, struct Page, 32);
+cache_declare_fixed(Standard_page_cache, struct Page, 128);
+cache_declare_fixed_s3_fifo(Standard_s3_fifo_page_cache, struct Page, 128);
+
+static CCC_Order
+page_order(CCC_Key_comparator_context const order)
+{
+    uint32_t const *const left = order.key_left;
+    struct Page const *const right = order.type_right;
+    return (*left > right->id) - (*left < right->id);
+}
+
+/** Loads a page whose value is derived from its key and counts each load.
+Keys at or above the limit in the context fail to load. */
+struct Loader
+{
+    size_t loads;
+    uint32_t limit;
+};
+
+static bool
+load_page(CCC_Cache_load_context const load)
+{
+    struct Loader *const loader = load.context;
+    uint32_t const id = *(uint32_t const *)load.key;
+    if (id >= loader->limit)
+    {
+        return false;
+    }
+    ++loader->loads;
+    *(struct Page *)load.type_output = (struct Page){
+        .id = id,
+        .value = id * 3,
+    };
+    return true;
+}
+
+static CCC_Entry
+insert_page(Cache *const cache, uint32_t const id)
+{
+    return cache_insert_or_assign(cache, &(struct Page){.id = id, .value = id});
+}
+
+check_static_begin(cache_test_initialize_errors)
+{
+    Cache cache;
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, CCC_CACHE_POLICY_LRU, NULL, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, CCC_CACHE_POLICY_LRU, std_allocate, NULL,
+                           0),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, (Cache_policy)7, std_allocate, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(cache_initialize_fixed(&cache, &(Small_page_cache){}, struct Page, id,
+                                 NULL, page_order, CCC_CACHE_POLICY_CLOCK,
+                                 NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    /* Only the S3-FIFO declaration reserves ghosts so the other refuses it. */
+    check(sizeof(Standard_page_cache) < sizeof(Standard_s3_fifo_page_cache),
+          true);
+    check(cache_initialize_fixed(&cache, &(Standard_page_cache){}, struct Page,
+                                 id, CCC_hash_key_u32, page_order,
+                                 CCC_CACHE_POLICY_S3_FIFO, NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, CCC_CACHE_POLICY_LRU, std_allocate, NULL,
+                           8),
+          CCC_RESULT_OK);
+    check(cache_is_empty(&cache), true);
+    check(cache_capacity(&cache).count, 8);
+    check(cache_contains(&cache, &(uint32_t){1}), false);
+    check(cache_get_key_value(&cache, &(uint32_t){1}) == NULL, true);
+    struct Page out = {.id = 1};
+    CCC_Entry const e = cache_remove_key_value(&cache, &out);
+    check(CCC_entry_occupied(&e), false);
+    check(cache_validate(&cache), true);
+    check_end(cache_clear_and_free(&cache, NULL););
+}
+
+check_static_begin(cache_test_lru_order)
+{
+    Cache cache;
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, CCC_CACHE_POLICY_LRU, std_allocate, NULL,
+                           4),
+          CCC_RESULT_OK);
+    for (uint32_t id = 0; id < 4; ++id)
+    {
+        CCC_Entry const e = insert_page(&cache, id);
+        check(CCC_entry_occupied(&e), false);
+    }
+    /* Page 0 becomes the most recent so page 1 is the victim. */
+    check(cache_get_key_value(&cache, &(uint32_t){0}) != NULL, true);
+    CCC_Entry e = insert_page(&cache, 4);
+    check(CCC_entry_occupied(&e), false);
+    check(cache_contains(&cache, &(uint32_t){1}), false);
+    check(cache_contains(&cache, &(uint32_t){0}), true);
+    /* Overwriting counts as an access so page 2 survives and 3 does not. */
+    e = insert_page(&cache, 2);
+    check(CCC_entry_occupied(&e), true);
+    e = insert_page(&cache, 5);
+    check(cache_contains(&cache, &(uint32_t){3}), false);
+    check(cache_contains(&cache, &(uint32_t){2}), true);
+    check(cache_count(&cache).count, 4);
+    check(cache_validate(&cache), true);
+    check_end(cache_clear_and_free(&cache, NULL););
+}
+
+check_static_begin(cache_test_clock_order)
+{
+    Cache cache;
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, CCC_CACHE_POLICY_CLOCK, std_allocate,
+                           NULL, 4),
+          CCC_RESULT_OK);
+    for (uint32_t id = 0; id < 4; ++id)
+    {
+        (void)insert_page(&cache, id);
+    }
+    check(cache_get_key_value(&cache, &(uint32_t){0}) != NULL, true);
+    check(cache_get_key_value(&cache, &(uint32_t){2}) != NULL, true);
+    /* The hand clears the bit of page 0 and evicts page 1, then clears the
+       bit of page 2 and evicts page 3. */
+    (void)insert_page(&cache, 4);
+    check(cache_contains(&cache, &(uint32_t){1}), false);
+    (void)insert_page(&cache, 5);
+    check(cache_contains(&cache, &(uint32_t){3}), false);
+    check(cache_contains(&cache, &(uint32_t){0}), true);
+    check(cache_contains(&cache, &(uint32_t){2}), true);
+    check(cache_validate(&cache), true);
+    check_end(cache_clear_and_free(&cache, NULL););
+}
+
+/** A small hot set is accessed twice and then a long scan of keys used once
+passes through the cache. S3-FIFO evicts the scan from its small queue and
+keeps the hot set while LRU loses it. */
+check_static_begin(cache_test_scan_resistance, Cache_policy const policy,
+                   bool const keeps_hot_set)
+{
+    Cache cache;
+    Small_page_cache storage = {};
+    check(cache_initialize_fixed(&cache, &storage, struct Page, id,
+                                 CCC_hash_key_u32, page_order, policy, NULL),
+          CCC_RESULT_OK);
+    check(cache_capacity(&cache).count,
+          cache_fixed_capacity(Small_page_cache));
+    uint32_t const hot = 8;
+    for (uint32_t id = 0; id < hot; ++id)
+    {
+        (void)insert_page(&cache, id);
+        check(cache_get_key_value(&cache, &id) != NULL, true);
+    }
+    for (uint32_t id = 1000; id < 2000; ++id)
+    {
+        (void)insert_page(&cache, id);
+    }
+    check(cache_count(&cache).count, cache_capacity(&cache).count);
+    check(cache_validate(&cache), true);
+    for (uint32_t id = 0; id < hot; ++id)
+    {
+        check(cache_contains(&cache, &id), keeps_hot_set);
+    }
+    check_end(check(cache_clear_and_free(&cache, NULL),
+                    CCC_RESULT_NO_ALLOCATION_FUNCTION););
+}
+
+check_static_begin(cache_test_get_or_load, Cache_policy const policy)
+{
+    Cache cache;
+    check(cache_initialize(&cache, struct Page, id, CCC_hash_key_u32,
+                           page_order, policy, std_allocate, NULL, 64),
+          CCC_RESULT_OK);
+    struct Loader loader = {.limit = 1000};
+    enum : size_t
+    {
+        KEYS = 40,
+    };
+    uint32_t ids[KEYS];
+    void const *keys[KEYS];
+    struct Page pages[KEYS];
+    for (size_t i = 0; i < KEYS; ++i)
+    {
+        /* Every key appears twice so half of the batch hits. */
+        ids[i] = (uint32_t)(i / 2);
+        keys[i] = &ids[i];
+    }
+    CCC_Count served
+        = cache_get_or_load(&cache, keys, KEYS, pages, load_page, &loader);
+    check(served.error, CCC_RESULT_OK);
+    check(served.count, KEYS);
+    check(loader.loads, KEYS / 2);
+    for (size_t i = 0; i < KEYS; ++i)
+    {
+        check(pages[i].id, ids[i]);
+        check(pages[i].value, ids[i] * 3);
+    }
+    served = cache_get_or_load(&cache, keys, KEYS, pages, load_page, &loader);
+    check(served.count, KEYS);
+    check(loader.loads, KEYS / 2);
+    /* A failed load stops the batch at the key that could not be loaded. */
+    ids[5] = loader.limit;
+    served = cache_get_or_load(&cache, keys, KEYS, pages, load_page, &loader);
+    check(served.error, CCC_RESULT_FAIL);
+    check(served.count, 5);
+    check(cache_contains(&cache, &loader.limit), false);
+    check(cache_validate(&cache), true);
+    check_end(cache_clear_and_free(&cache, NULL););
+}
+
+/** Insertions, hits, and removals in a fixed cache with no allocation. Every
+key still cached must hold its latest value. */
+check_static_begin(cache_test_fixed_churn, Cache_policy const policy)
+{
+    Cache cache;
+    Standard_page_cache storage = {};
+    Standard_s3_fifo_page_cache s3_fifo_storage = {};
+    CCC_Result const init
+        = policy == CCC_CACHE_POLICY_S3_FIFO
+            ? cache_initialize_fixed(&cache, &s3_fifo_storage, struct Page, id,
+                                     CCC_hash_key_u32, page_order, policy, NULL)
+            : cache_initialize_fixed(&cache, &storage, struct Page, id,
+                                     CCC_hash_key_u32, page_order, policy,
+                                     NULL);
+    check(init, CCC_RESULT_OK);
+    size_t const capacity = cache_fixed_capacity(Standard_page_cache);
+    uint32_t const keys = 600;
+    for (uint32_t round = 0; round < 20; ++round)
+    {
+        for (uint32_t id = round; id < keys; id += 3)
+        {
+            CCC_Entry const e = cache_insert_or_assign(
+                &cache, &(struct Page){.id = id, .value = id + round});
+            check(CCC_entry_insert_error(&e), false);
+            check(((struct Page *)CCC_entry_unwrap(&e))->value, id + round);
+            if (id % 5 == 0)
+            {
+                struct Page const *const p = cache_get_key_value(&cache, &id);
+                check(p != NULL, true);
+                check(p->value, id + round);
+            }
+            if (id % 7 == 0)
+            {
+                struct Page out = {.id = id};
+                CCC_Entry const r = cache_remove_key_value(&cache, &out);
+                check(CCC_entry_occupied(&r), true);
+                check(out.value, id + round);
+            }
+        }
+        check(cache_count(&cache).count <= capacity, true);
+        check(cache_validate(&cache), true);
+    }
+    check(cache_clear(&cache, NULL), CCC_RESULT_OK);
+    check(cache_is_empty(&cache), true);
+    check(cache_validate(&cache), true);
+    for (uint32_t id = 0; id < keys; ++id)
+    {
+        (void)insert_page(&cache, id);
+    }
+    check(cache_count(&cache).count, capacity);
+    check(cache_validate(&cache), true);
+    check_end();
+}
+
+int
+main(void)
+{
+    return check_run(
+        cache_test_initialize_errors(), cache_test_lru_order(),
+        cache_test_clock_order(),
+        cache_test_scan_resistance(CCC_CACHE_POLICY_S3_FIFO, true),
+        cache_test_scan_resistance(CCC_CACHE_POLICY_LRU, false),
+        cache_test_get_or_load(CCC_CACHE_POLICY_LRU),
+        cache_test_get_or_load(CCC_CACHE_POLICY_CLOCK),
+        cache_test_get_or_load(CCC_CACHE_POLICY_S3_FIFO),
+        cache_test_fixed_churn(CCC_CACHE_POLICY_LRU),
+        cache_test_fixed_churn(CCC_CACHE_POLICY_CLOCK),
+        cache_test_fixed_churn(CCC_CACHE_POLICY_S3_FIFO));
+}
@@ -0,0 +1,205 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DENSE_HASH_MAP_USING_NAMESPACE_CCC
+
+#include "ccc/dense_hash_map.h"
+#include "ccc/hash.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+enum : size_t
+{
+    PAYLOAD = 248,
+};
+
+/* Records large enough that moving them is the cost the map avoids. The
+payload repeats one byte so any torn or misplaced copy is detected. */
+struct Record
+{
+    uint64_t id;
+    unsigned char payload[PAYLOAD];
+};
+
+static CCC_Order
+record_order(CCC_Key_comparator_context const order)
+{
+    uint64_t const *const left = order.key_left;
+    struct Record const *const right = order.type_right;
+    return (*left > right->id) - (*left < right->id);
+}
+
+/** Only seven hashes so long probes and equal stored hashes are common. */
+static uint64_t
+record_hash_seven(CCC_Key_context const k)
+{
+    return *(uint64_t const *)k.key % 7;
+}
+
+static struct Record
+record(uint64_t const id, unsigned char const fill)
+{
+    struct Record r = {.id = id};
+    (void)memset(r.payload, fill, PAYLOAD);
+    return r;
+}
+
+static bool
+payload_is(struct Record const *const r, unsigned char const fill)
+{
+    for (size_t i = 0; i < PAYLOAD; ++i)
+    {
+        if (r->payload[i] != fill)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+bump_payload(CCC_Type_context const t)
+{
+    struct Record *const r = t.type;
+    (void)memset(r->payload, r->payload[0] + 1, PAYLOAD);
+}
+
+check_static_begin(dense_hash_map_test_initialize_errors)
+{
+    Dense_hash_map map;
+    check(dense_hash_map_initialize(&map, struct Record, id, CCC_hash_key_u64,
+                                    record_order, NULL, NULL, 0),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(dense_hash_map_initialize(&map, struct Record, id, NULL, record_order,
+                                    std_allocate, NULL, 0),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(dense_hash_map_initialize(&map, struct Record, id, CCC_hash_key_u64,
+                                    record_order, std_allocate, NULL, 0),
+          CCC_RESULT_OK);
+    check(dense_hash_map_is_empty(&map), true);
+    check(dense_hash_map_contains(&map, &(uint64_t){1}), false);
+    check(dense_hash_map_get_key_value(&map, &(uint64_t){1}) == NULL, true);
+    struct Record out = {.id = 1};
+    CCC_Entry const e = dense_hash_map_remove_key_value(&map, &out);
+    check(CCC_entry_occupied(&e), false);
+    check(dense_hash_map_begin(&map) == dense_hash_map_end(&map), true);
+    check(dense_hash_map_validate(&map), true);
+    check(dense_hash_map_or_insert(
+              &(Dense_hash_map_entry){dense_hash_map_entry(NULL, &out).private},
+              &out)
+              == NULL,
+          true);
+    check_end(dense_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(dense_hash_map_test_entry_interface)
+{
+    Dense_hash_map map;
+    check(dense_hash_map_initialize(&map, struct Record, id, CCC_hash_key_u64,
+                                    record_order, std_allocate, NULL, 8),
+          CCC_RESULT_OK);
+    uint64_t const key = 42;
+    Dense_hash_map_entry *e = dense_hash_map_entry_wrap(&map, &key);
+    check(dense_hash_map_occupied(e), false);
+    check(dense_hash_map_insert_error(e), false);
+    struct Record const r = record(key, 1);
+    struct Record *stored = dense_hash_map_or_insert(e, &r);
+    check(stored != NULL, true);
+    check(payload_is(stored, 1), true);
+    e = dense_hash_map_and_modify(dense_hash_map_entry_wrap(&map, &key),
+                                  bump_payload);
+    check(dense_hash_map_occupied(e), true);
+    check(payload_is(dense_hash_map_unwrap(e), 2), true);
+    struct Record const replacement = record(key, 9);
+    stored = dense_hash_map_insert_entry(dense_hash_map_entry_wrap(&map, &key),
+                                         &replacement);
+    check(payload_is(stored, 9), true);
+    CCC_Entry ins = dense_hash_map_try_insert(&map, &r);
+    check(CCC_entry_occupied(&ins), true);
+    check(payload_is(CCC_entry_unwrap(&ins), 9), true);
+    ins = dense_hash_map_insert_or_assign(&map, &r);
+    check(CCC_entry_occupied(&ins), true);
+    check(payload_is(CCC_entry_unwrap(&ins), 1), true);
+    struct Record const other = record(7, 3);
+    ins = dense_hash_map_insert_or_assign(&map, &other);
+    check(CCC_entry_occupied(&ins), false);
+    check(dense_hash_map_count(&map).count, 2);
+    CCC_Entry const removed
+        = dense_hash_map_remove_entry(dense_hash_map_entry_wrap(&map, &key));
+    check(CCC_entry_occupied(&removed), true);
+    check(dense_hash_map_contains(&map, &key), false);
+    check(payload_is(dense_hash_map_get_key_value(&map, &(uint64_t){7}), 3),
+          true);
+    check(dense_hash_map_validate(&map), true);
+    check_end(dense_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(dense_hash_map_test_dense_removal,
+                   CCC_Key_hasher *const hash)
+{
+    Dense_hash_map map;
+    check(dense_hash_map_initialize(&map, struct Record, id, hash, record_order,
+                                    std_allocate, NULL, 0),
+          CCC_RESULT_OK);
+    uint64_t const size = 2000;
+    for (uint64_t id = 0; id < size; ++id)
+    {
+        struct Record const r = record(id, (unsigned char)id);
+        CCC_Entry const e = dense_hash_map_try_insert(&map, &r);
+        check(CCC_entry_occupied(&e), false);
+        check(CCC_entry_insert_error(&e), false);
+    }
+    check(dense_hash_map_count(&map).count, size);
+    check(dense_hash_map_validate(&map), true);
+    /* Remove in two ways so the last record is moved into many holes. */
+    for (uint64_t id = 0; id < size; id += 3)
+    {
+        struct Record out = {.id = id};
+        CCC_Entry const e = dense_hash_map_remove_key_value(&map, &out);
+        check(CCC_entry_occupied(&e), true);
+        check(payload_is(&out, (unsigned char)id), true);
+        uint64_t const next = id + 1;
+        CCC_Entry const gone = dense_hash_map_remove_entry(
+            dense_hash_map_entry_wrap(&map, &next));
+        check(CCC_entry_occupied(&gone), true);
+    }
+    check(dense_hash_map_validate(&map), true);
+    size_t seen = 0;
+    for (struct Record const *r = dense_hash_map_begin(&map);
+         r != dense_hash_map_end(&map); r = dense_hash_map_next(&map, r))
+    {
+        check(r->id % 3, 2);
+        check(payload_is(r, (unsigned char)r->id), true);
+        ++seen;
+    }
+    check(seen, dense_hash_map_count(&map).count);
+    for (uint64_t id = 0; id < size; ++id)
+    {
+        struct Record const *const r = dense_hash_map_get_key_value(&map, &id);
+        check(r != NULL, id % 3 == 2);
+    }
+    /* Holes are refilled at the back and the index follows. */
+    for (uint64_t id = 0; id < size; id += 3)
+    {
+        struct Record const r = record(id, 0xAB);
+        CCC_Entry const e = dense_hash_map_insert_or_assign(&map, &r);
+        check(CCC_entry_occupied(&e), false);
+    }
+    check(dense_hash_map_validate(&map), true);
+    check(dense_hash_map_clear(&map, NULL), CCC_RESULT_OK);
+    check(dense_hash_map_is_empty(&map), true);
+    check(dense_hash_map_contains(&map, &(uint64_t){2}), false);
+    check(dense_hash_map_validate(&map), true);
+    check_end(dense_hash_map_clear_and_free(&map, NULL););
+}
+
+int
+main(void)
+{
+    return check_run(dense_hash_map_test_initialize_errors(),
+                     dense_hash_map_test_entry_interface(),
+                     dense_hash_map_test_dense_removal(CCC_hash_key_u64),
+                     dense_hash_map_test_dense_removal(record_hash_seven));
+}
@@ -0,0 +1,244 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#define FILTER_USING_NAMESPACE_CCC
+
+#include "ccc/filter.h"
+#include "ccc/hash.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+filter_declare_fixed(Small_fixed_filter, 64);
+
+/** Present keys are even and absent keys are odd so the sets never meet. */
+static uint32_t
+present_key(uint32_t const i)
+{
+    return i * 2;
+}
+
+static uint32_t
+absent_key(uint32_t const i)
+{
+    return i * 2 + 1;
+}
+
+check_static_begin(filter_test_no_false_negatives, Filter_kind const kind)
+{
+    struct Sized_allocator sized = {};
+    Filter filter;
+    uint32_t const expected = 1000;
+    check(filter_initialize(&filter, kind, CCC_hash_key_u32, sized_allocate,
+                            &sized, expected),
+          CCC_RESULT_OK);
+    check(filter_is_empty(&filter), true);
+    check(filter_block_count(&filter).count >= 1, true);
+    check((uintptr_t)filter.blocks % 64, 0);
+    for (uint32_t i = 0; i < expected; ++i)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_insert(&filter, &key), CCC_RESULT_OK);
+    }
+    check(filter_count(&filter).count, expected);
+    for (uint32_t i = 0; i < expected; ++i)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_contains(&filter, &key), true);
+    }
+    /* The filter spends about 16 bits or counters per key, which is well
+       under one percent false positives. Allow some slack for the hash. */
+    uint32_t const probes = 10000;
+    uint32_t false_positives = 0;
+    for (uint32_t i = 0; i < probes; ++i)
+    {
+        uint32_t const key = absent_key(i);
+        false_positives += filter_contains(&filter, &key) == true;
+    }
+    check(false_positives < probes / 50, true);
+    check(filter_clear(&filter), CCC_RESULT_OK);
+    check(filter_is_empty(&filter), true);
+    uint32_t const first = present_key(0);
+    check(filter_contains(&filter, &first), false);
+    check_end({
+        (void)filter_clear_and_free(&filter);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(filter_test_counting_remove)
+{
+    Filter filter;
+    uint32_t const expected = 512;
+    check(filter_initialize(&filter, CCC_FILTER_KIND_COUNTING,
+                            CCC_hash_key_u32, std_allocate, NULL, expected),
+          CCC_RESULT_OK);
+    for (uint32_t i = 0; i < expected; ++i)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_insert(&filter, &key), CCC_RESULT_OK);
+    }
+    /* Insert one key twice so that it takes two removals to be absent. */
+    uint32_t const twice = present_key(0);
+    check(filter_insert(&filter, &twice), CCC_RESULT_OK);
+    for (uint32_t i = 0; i < expected; i += 2)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_remove(&filter, &key), CCC_RESULT_OK);
+    }
+    check(filter_count(&filter).count, expected / 2 + 1);
+    check(filter_contains(&filter, &twice), true);
+    uint32_t still_present = 0;
+    for (uint32_t i = 2; i < expected; i += 2)
+    {
+        uint32_t const key = present_key(i);
+        still_present += filter_contains(&filter, &key) == true;
+    }
+    check(still_present < (expected / 2) / 50, true);
+    for (uint32_t i = 1; i < expected; i += 2)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_contains(&filter, &key), true);
+    }
+    check(filter_remove(&filter, &twice), CCC_RESULT_OK);
+    for (uint32_t i = 1; i < expected; i += 2)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_remove(&filter, &key), CCC_RESULT_OK);
+    }
+    check(filter_is_empty(&filter), true);
+    /* Every counter is zero again so nothing can be removed. */
+    check(filter_remove(&filter, &twice), CCC_RESULT_FAIL);
+    uint32_t const never = absent_key(0);
+    check(filter_contains(&filter, &never), false);
+    check_end((void)filter_clear_and_free(&filter););
+}
+
+check_static_begin(filter_test_fixed)
+{
+    Small_fixed_filter storage;
+    Filter filter;
+    check(filter_fixed_block_count(Small_fixed_filter), 64);
+    check(filter_initialize_fixed(&filter, &storage, CCC_FILTER_KIND_BLOOM,
+                                  CCC_hash_key_u32, NULL),
+          CCC_RESULT_OK);
+    check(filter_block_count(&filter).count, 64);
+    check((uintptr_t)filter.blocks % 64, 0);
+    uint32_t const count = 64 * 32;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_insert(&filter, &key), CCC_RESULT_OK);
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t const key = present_key(i);
+        check(filter_contains(&filter, &key), true);
+    }
+    /* Bloom filters cannot remove and fixed filters have nothing to free. */
+    uint32_t const first = present_key(0);
+    check(filter_remove(&filter, &first), CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_clear_and_free(&filter), CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(filter_is_empty(&filter), true);
+    check(filter_contains(&filter, &first), false);
+    check_end();
+}
+
+check_static_begin(filter_test_batch_and_hash, Filter_kind const kind)
+{
+    Filter filter;
+    check(filter_initialize(&filter, kind, CCC_hash_key_u32, std_allocate,
+                            NULL, 256),
+          CCC_RESULT_OK);
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t const key = present_key(i);
+        if (i % 2)
+        {
+            check(filter_insert(&filter, &key), CCC_RESULT_OK);
+        }
+        else
+        {
+            uint64_t const hash
+                = CCC_hash_key_u32((CCC_Key_context){.key = &key});
+            check(filter_insert_with_hash(&filter, hash), CCC_RESULT_OK);
+        }
+    }
+    /* An odd length exercises the partial final chunk of the batch. */
+    enum : uint32_t
+    {
+        BATCH = 301,
+    };
+    uint32_t values[BATCH];
+    void const *keys[BATCH];
+    bool maybe[BATCH];
+    for (uint32_t i = 0; i < BATCH; ++i)
+    {
+        values[i] = i;
+        keys[i] = &values[i];
+    }
+    CCC_Count const hits = filter_contains_batch(&filter, keys, BATCH, maybe);
+    check(hits.error, CCC_RESULT_OK);
+    size_t expected_hits = 0;
+    for (uint32_t i = 0; i < BATCH; ++i)
+    {
+        CCC_Tribool const single = filter_contains(&filter, &values[i]);
+        check(maybe[i], single == true);
+        uint64_t const hash
+            = CCC_hash_key_u32((CCC_Key_context){.key = &values[i]});
+        check(filter_contains_with_hash(&filter, hash), single);
+        expected_hits += single == true;
+    }
+    check(hits.count, expected_hits);
+    check(filter_contains_batch(&filter, NULL, 0, NULL).count, 0);
+    check(filter_contains_batch(&filter, NULL, 1, maybe).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    /* A NULL key fails the whole batch as it fails a single query. */
+    keys[BATCH / 2] = NULL;
+    check(filter_contains(&filter, NULL), CCC_TRIBOOL_ERROR);
+    check(filter_contains_batch(&filter, keys, BATCH, maybe).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    check_end((void)filter_clear_and_free(&filter););
+}
+
+check_static_begin(filter_test_arguments)
+{
+    Filter filter;
+    check(filter_initialize(NULL, CCC_FILTER_KIND_BLOOM, CCC_hash_key_u32,
+                            std_allocate, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_initialize(&filter, CCC_FILTER_KIND_BLOOM, NULL,
+                            std_allocate, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_initialize(&filter, CCC_FILTER_KIND_BLOOM, CCC_hash_key_u32,
+                            NULL, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_initialize(&filter, (Filter_kind)7, CCC_hash_key_u32,
+                            std_allocate, NULL, 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    /* A filter for no keys still has one block to answer queries. */
+    check(filter_initialize(&filter, CCC_FILTER_KIND_BLOOM, CCC_hash_key_u32,
+                            std_allocate, NULL, 0),
+          CCC_RESULT_OK);
+    check(filter_block_count(&filter).count, 1);
+    check(filter_clear_and_free(&filter), CCC_RESULT_OK);
+    check(filter_block_count(&filter).count, 0);
+    uint32_t const key = 1;
+    check(filter_contains(&filter, &key), false);
+    check(filter_insert(&filter, &key), CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_contains(&filter, NULL), CCC_TRIBOOL_ERROR);
+    check(filter_count(NULL).error, CCC_RESULT_ARGUMENT_ERROR);
+    check(filter_is_empty(NULL), CCC_TRIBOOL_ERROR);
+    check_end();
+}
+
+int
+main(void)
+{
+    return check_run(filter_test_no_false_negatives(CCC_FILTER_KIND_BLOOM),
+                     filter_test_no_false_negatives(CCC_FILTER_KIND_COUNTING),
+                     filter_test_counting_remove(), filter_test_fixed(),
+                     filter_test_batch_and_hash(CCC_FILTER_KIND_BLOOM),
+                     filter_test_batch_and_hash(CCC_FILTER_KIND_COUNTING),
+                     filter_test_arguments());
+}
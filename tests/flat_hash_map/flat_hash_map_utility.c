@@ -35,6 +35,13 @@ flat_hash_map_int_to_u64(CCC_Key_context const k)
     return x;
 }
 
+uint64_t
+flat_hash_map_int_to_u64_counted(CCC_Key_context const k)
+{
+    ++*((size_t *)k.context);
+    return flat_hash_map_int_to_u64(k);
+}
+
 void
 flat_hash_map_modplus(CCC_Type_context const mod)
 {
@@ -23,6 +23,10 @@ capacity. Insertions can continue for 87.5% of the capacity so about 896. Play
 it safe and avoid this limit unless testing insertion failure is important. */
 CCC_flat_hash_map_declare_fixed(Standard_fixed_map, struct Val, 1024);
 
+/** A small fixed map that also has room to store the hash of every element. */
+CCC_flat_hash_map_declare_fixed_stored_hash(Small_stored_hash_fixed_map,
+                                            struct Val, 64);
+
 enum : size_t
 {
     SMALL_FIXED_CAP = CCC_flat_hash_map_fixed_capacity(Small_fixed_map),
@@ -32,6 +36,8 @@ enum : size_t
 uint64_t flat_hash_map_int_zero(CCC_Key_context);
 uint64_t flat_hash_map_int_last_digit(CCC_Key_context);
 uint64_t flat_hash_map_int_to_u64(CCC_Key_context);
+/** Same as int to u64 but increments the size_t pointed to by context. */
+uint64_t flat_hash_map_int_to_u64_counted(CCC_Key_context);
 CCC_Order flat_hash_map_id_order(CCC_Key_comparator_context);
 
 void flat_hash_map_modplus(CCC_Type_context);
@@ -1,8 +1,13 @@
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
 #define FLAT_HASH_MAP_USING_NAMESPACE_CCC
 #define TRAITS_USING_NAMESPACE_CCC
 
+#include "buffer.h"
 #include "checkers.h"
 #include "flat_hash_map.h"
 #include "flat_hash_map_utility.h"
@@ -70,6 +75,62 @@ check_static_begin(flat_hash_map_test_static_initialize)
     check_end();
 }
 
+/** A fixed size map keeps the width its layout was declared for while a
+dynamic map scans the widest group the processor supports, unless the build
+lowered it. A width the processor does not scan is rejected. */
+check_static_begin(flat_hash_map_test_group_width)
+{
+    size_t widest = CCC_FLAT_HASH_MAP_GROUP_COUNT;
+#ifdef CCC_HAS_X86_SIMD
+    if (__builtin_cpu_supports("avx512bw"))
+    {
+        widest = 64;
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        widest = 32;
+    }
+#endif /* CCC_HAS_X86_SIMD */
+    Flat_hash_map fixed = flat_hash_map_initialize(
+        &(Small_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, SMALL_FIXED_CAP);
+    CCC_Entry const f = insert_or_assign(&fixed, &(struct Val){.key = 1});
+    check(insert_error(&f), false);
+    check(fixed.group_count, CCC_FLAT_HASH_MAP_GROUP_COUNT);
+    check(validate(&fixed), true);
+    fixed.group_count = CCC_FLAT_HASH_MAP_GROUP_COUNT / 2;
+    check(validate(&fixed), false);
+    Flat_hash_map dynamic = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, std_allocate, NULL, 0);
+    int const size = 1000;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&dynamic, &(struct Val){i, i});
+        check(insert_error(&e), false);
+    }
+    size_t const width = dynamic.group_count;
+    check(width >= CCC_FLAT_HASH_MAP_GROUP_COUNT && width <= widest, true);
+    check(width & (width - 1), (size_t)0);
+    for (int i = 0; i < size; i += 3)
+    {
+        CCC_Entry const e = remove_key_value(&dynamic, &(struct Val){.key = i});
+        check(occupied(&e), true);
+    }
+    check(dynamic.group_count, width);
+    check(validate(&dynamic), true);
+    check(flat_hash_map_group_count(&dynamic).count,
+          flat_hash_map_capacity(&dynamic).count / width);
+    for (int i = 0; i < size; ++i)
+    {
+        check(contains(&dynamic, &i), i % 3 != 0);
+    }
+    dynamic.group_count = widest * 2;
+    check(validate(&dynamic), false);
+    dynamic.group_count = width;
+    check_end({ (void)flat_hash_map_clear_and_free(&dynamic, NULL); });
+}
+
 check_static_begin(flat_hash_map_test_with_literal)
 {
     Flat_hash_map fh = flat_hash_map_with_compound_literal(
@@ -297,6 +358,331 @@ check_static_begin(flat_hash_map_test_init_from_fail)
     check_end(flat_hash_map_clear_and_free(&map_from_list, NULL););
 }
 
+check_static_begin(flat_hash_map_test_init_from_buffer)
+{
+    enum : int
+    {
+        VALS = 1000,
+    };
+    struct Val vals[VALS];
+    for (int i = 0; i < VALS; ++i)
+    {
+        vals[i] = (struct Val){.key = i, .val = i * 2};
+    }
+    CCC_Buffer const buf
+        = CCC_buffer_initialize(vals, struct Val, NULL, NULL, VALS, VALS);
+    Flat_hash_map fh = flat_hash_map_from_buffer(
+        struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, &buf, CCC_TRUE);
+    check(validate(&fh), true);
+    check(count(&fh).count, VALS);
+    for (int i = 0; i < VALS; ++i)
+    {
+        struct Val const *const v = get_key_value(&fh, &i);
+        check(v != NULL, true);
+        check(v->val, i * 2);
+    }
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_extend_overwrite)
+{
+    Flat_hash_map fh
+        = flat_hash_map_from(key, flat_hash_map_int_to_u64,
+                             flat_hash_map_id_order, std_allocate, NULL, 0,
+                             (struct Val[]){
+                                 {.key = 0, .val = 0},
+                                 {.key = 1, .val = 1},
+                             });
+    struct Val vals[] = {
+        {.key = 1, .val = 10},
+        {.key = 2, .val = 20},
+        {.key = 2, .val = 21},
+        {.key = 3, .val = 30},
+    };
+    CCC_Buffer const buf = CCC_buffer_initialize(vals, struct Val, NULL, NULL,
+                                                 sizeof(vals) / sizeof(*vals),
+                                                 sizeof(vals) / sizeof(*vals));
+    check(flat_hash_map_extend(&fh, &buf, CCC_FALSE), CCC_RESULT_OK);
+    check(validate(&fh), true);
+    check(count(&fh).count, 4);
+    int const expected[] = {0, 10, 21, 30};
+    for (int i = 0; i < 4; ++i)
+    {
+        struct Val const *const v = get_key_value(&fh, &i);
+        check(v != NULL, true);
+        check(v->val, expected[i]);
+    }
+    CCC_Buffer const empty
+        = CCC_buffer_initialize(NULL, struct Val, NULL, NULL, 0);
+    check(flat_hash_map_extend(&fh, &empty, CCC_FALSE), CCC_RESULT_OK);
+    check(count(&fh).count, 4);
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_extend_fail)
+{
+    Flat_hash_map fh
+        = flat_hash_map_initialize(&(Small_fixed_map){}, struct Val, key,
+                                   flat_hash_map_int_to_u64,
+                                   flat_hash_map_id_order, NULL, NULL,
+                                   SMALL_FIXED_CAP);
+    int ints[] = {1, 2, 3};
+    CCC_Buffer const wrong_type
+        = CCC_buffer_initialize(ints, int, NULL, NULL, 3, 3);
+    check(flat_hash_map_extend(&fh, &wrong_type, CCC_FALSE),
+          CCC_RESULT_ARGUMENT_ERROR);
+    struct Val vals[SMALL_FIXED_CAP] = {};
+    for (int i = 0; i < (int)SMALL_FIXED_CAP; ++i)
+    {
+        vals[i] = (struct Val){.key = i, .val = i};
+    }
+    CCC_Buffer const too_many = CCC_buffer_initialize(
+        vals, struct Val, NULL, NULL, SMALL_FIXED_CAP, SMALL_FIXED_CAP);
+    check(flat_hash_map_extend(&fh, &too_many, CCC_TRIBOOL_ERROR),
+          CCC_RESULT_ARGUMENT_ERROR);
+    /* A fixed map cannot hold a full capacity of elements due to its load
+       factor so nothing is inserted. */
+    check(flat_hash_map_extend(&fh, &too_many, CCC_TRUE) != CCC_RESULT_OK,
+          true);
+    check(count(&fh).count, 0);
+    check(validate(&fh), true);
+    check_end();
+}
+
+enum : uint64_t
+{
+    SNAPSHOT_HASH_ID = 0x5EED,
+};
+
+/** Copies a snapshot into aligned memory as if it were written to a file and
+mapped back in. */
+static void *
+snapshot_to_memory(Flat_hash_map_snapshot const *const s, size_t *const bytes)
+{
+    *bytes = sizeof(s->header) + s->table_bytes;
+    size_t const rounded
+        = (*bytes + sizeof(s->header) - 1) & ~(sizeof(s->header) - 1);
+    char *const mem = aligned_alloc(sizeof(s->header), rounded);
+    if (!mem)
+    {
+        return NULL;
+    }
+    (void)memcpy(mem, &s->header, sizeof(s->header));
+    if (s->table_bytes)
+    {
+        (void)memcpy(mem + sizeof(s->header), s->table, s->table_bytes);
+    }
+    return mem;
+}
+
+check_static_begin(flat_hash_map_test_snapshot_load)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0, CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    int const size = 1000;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&fh, &(struct Val){i, i * 3});
+        check(insert_error(&e), false);
+    }
+    for (int i = 0; i < size; i += 4)
+    {
+        CCC_Entry const e = remove_key_value(&fh, &(struct Val){.key = i});
+        check(occupied(&e), true);
+    }
+    Flat_hash_map_snapshot snap = {};
+    check(flat_hash_map_snapshot(NULL, SNAPSHOT_HASH_ID, &snap),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_snapshot(&fh, SNAPSHOT_HASH_ID, &snap), CCC_RESULT_OK);
+    check(snap.table != NULL, true);
+    size_t bytes = 0;
+    void *const mem = snapshot_to_memory(&snap, &bytes);
+    check(mem != NULL, true);
+    Flat_hash_map loaded = {};
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes),
+          CCC_RESULT_OK);
+    check(validate(&loaded), true);
+    check(count(&loaded).count, count(&fh).count);
+    check(capacity(&loaded).count, capacity(&fh).count);
+    for (int i = 0; i < size; ++i)
+    {
+        struct Val const *const v = get_key_value(&loaded, &i);
+        check(v == NULL, i % 4 == 0);
+        if (v)
+        {
+            check(v->val, i * 3);
+        }
+    }
+    /* The loaded map is read only but a copy may be changed freely. */
+    CCC_Entry const e = insert_or_assign(&loaded, &(struct Val){0, -1});
+    check(insert_error(&e), true);
+    check(contains(&loaded, &(int){0}), false);
+    check(flat_hash_map_clear_and_free(&loaded, NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    Flat_hash_map copy = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0, CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    check(flat_hash_map_copy(&copy, &loaded, std_allocate), CCC_RESULT_OK);
+    CCC_Entry const c = insert_or_assign(&copy, &(struct Val){0, -1});
+    check(occupied(&c), false);
+    check(insert_error(&c), false);
+    check(contains(&loaded, &(int){0}), false);
+    check(validate(&copy), true);
+    check(count(&copy).count, count(&loaded).count + 1);
+    check_end({
+        free(mem);
+        (void)flat_hash_map_clear_and_free(&fh, NULL);
+        (void)flat_hash_map_clear_and_free(&copy, NULL);
+    });
+}
+
+static bool
+keep_none(CCC_Type_context const)
+{
+    return false;
+}
+
+/** Every modification of a map loaded from memory mapped without write
+permission must fail without touching the memory, or the test faults. */
+check_static_begin(flat_hash_map_test_snapshot_load_read_only)
+{
+    Flat_hash_map fh = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0);
+    int const size = 100;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&fh, &(struct Val){i, i});
+        check(insert_error(&e), false);
+    }
+    /* A deleted slot would let an insertion reuse it without a rehash. */
+    CCC_Entry const removed = remove_key_value(&fh, &(struct Val){.key = 0});
+    check(occupied(&removed), true);
+    Flat_hash_map_snapshot snap = {};
+    check(flat_hash_map_snapshot(&fh, SNAPSHOT_HASH_ID, &snap), CCC_RESULT_OK);
+    size_t const bytes = sizeof(snap.header) + snap.table_bytes;
+    char *const mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    check(mem != MAP_FAILED, true);
+    (void)memcpy(mem, &snap.header, sizeof(snap.header));
+    (void)memcpy(mem + sizeof(snap.header), snap.table, snap.table_bytes);
+    check(mprotect(mem, bytes, PROT_READ), 0);
+    Flat_hash_map loaded = {};
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes),
+          CCC_RESULT_OK);
+    check(validate(&loaded), true);
+    int const present = size / 2;
+    check(((struct Val *)get_key_value(&loaded, &present))->val, present);
+    CCC_Entry e = insert_or_assign(&loaded, &(struct Val){present, -1});
+    check(insert_error(&e), true);
+    e = try_insert(&loaded, &(struct Val){.key = 0});
+    check(insert_error(&e), true);
+    e = swap_entry(&loaded, &(struct Val){present, -1});
+    check(insert_error(&e), true);
+    e = remove_key_value(&loaded, &(struct Val){.key = present});
+    check(CCC_entry_input_error(&e), true);
+    Flat_hash_map_entry *const ent = entry_wrap(&loaded, &present);
+    check(occupied(ent), true);
+    check(insert_error(ent), true);
+    check(and_modify(ent, mod) == ent, true);
+    check(insert_entry(ent, &(struct Val){present, -1}) == NULL, true);
+    check(flat_hash_map_insert_entry_with(ent, (struct Val){present, -1})
+              == NULL,
+          true);
+    e = remove_entry(ent);
+    check(CCC_entry_input_error(&e), true);
+    check(flat_hash_map_or_insert(entry_wrap(&loaded, &(int){0}),
+                                  &(struct Val){.key = 0})
+              == NULL,
+          true);
+    check(flat_hash_map_retain(&loaded, keep_none, NULL).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_for_each_range(&loaded, 0, 1, mod, NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_clear(&loaded, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_compact(&loaded), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_reserve(&loaded, 1, std_allocate),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_shrink_to_fit(&loaded, std_allocate),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_copy(&loaded, &fh, std_allocate),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(count(&loaded).count, count(&fh).count);
+    check(((struct Val *)get_key_value(&loaded, &present))->val, present);
+    check(validate(&loaded), true);
+    check_end({
+        (void)munmap(mem, bytes);
+        (void)flat_hash_map_clear_and_free(&fh, NULL);
+    });
+}
+
+check_static_begin(flat_hash_map_test_snapshot_load_fail)
+{
+    struct Wide
+    {
+        int key;
+        int val;
+        int extra;
+    };
+    Flat_hash_map fh = flat_hash_map_initialize(
+        &(Small_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, SMALL_FIXED_CAP);
+    Flat_hash_map_snapshot snap = {};
+    /* An uninitialized map still produces a snapshot of an empty map. */
+    check(flat_hash_map_snapshot(&fh, SNAPSHOT_HASH_ID, &snap), CCC_RESULT_OK);
+    check(snap.table_bytes, 0);
+    for (int i = 0; i < 10; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&fh, &(struct Val){i, i});
+        check(insert_error(&e), false);
+    }
+    check(flat_hash_map_snapshot(&fh, SNAPSHOT_HASH_ID, &snap), CCC_RESULT_OK);
+    size_t bytes = 0;
+    char *const mem = snapshot_to_memory(&snap, &bytes);
+    check(mem != NULL, true);
+    Flat_hash_map loaded = {};
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID + 1, mem, bytes),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Wide, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes - 1),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem + 8,
+              bytes - 8),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(loaded.data == NULL, true);
+    /* A corrupt header claiming spare capacity beyond the load factor. */
+    struct CCC_Flat_hash_map_snapshot_header *const header = (void *)mem;
+    uint64_t const remain = header->remain;
+    header->remain = header->mask + 1;
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes),
+          CCC_RESULT_ARGUMENT_ERROR);
+    header->remain = remain;
+    check(flat_hash_map_load_snapshot(
+              &loaded, struct Val, key, flat_hash_map_int_to_u64,
+              flat_hash_map_id_order, NULL, SNAPSHOT_HASH_ID, mem, bytes),
+          CCC_RESULT_OK);
+    check(count(&loaded).count, 10);
+    check(validate(&loaded), true);
+    check_end(free(mem););
+}
+
 check_static_begin(flat_hash_map_test_init_with_capacity)
 {
     Flat_hash_map fh = flat_hash_map_with_capacity(
@@ -374,10 +760,54 @@ check_static_begin(flat_hash_map_test_init_with_capacity_fail)
     check_end(flat_hash_map_clear_and_free(&fh, NULL););
 }
 
+/** The sized allocator frees and resizes by the sizes the map reports. Each
+table the map grows, shrinks, copies, or migrates away from must be returned
+with the bytes it was allocated with. */
+check_static_begin(flat_hash_map_test_sized_allocator,
+                   Flat_hash_map_option const options)
+{
+    struct Sized_allocator sized = {};
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, sized_allocate, &sized, 0, options);
+    Flat_hash_map copy = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, sized_allocate, &sized, 0, options);
+    int const size = 1000;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e
+            = insert_or_assign(&fh, &(struct Val){.key = i, .val = i});
+        check(insert_error(&e), false);
+    }
+    for (int i = 0; i < size - 100; ++i)
+    {
+        CCC_Entry const e = CCC_remove_key_value(&fh, &(struct Val){.key = i});
+        check(occupied(&e), true);
+    }
+    check(flat_hash_map_shrink_to_fit(&fh, sized_allocate), CCC_RESULT_OK);
+    check(flat_hash_map_copy(&copy, &fh, sized_allocate), CCC_RESULT_OK);
+    for (int i = size - 100; i < size; ++i)
+    {
+        struct Val const *const v = get_key_value(&copy, &i);
+        check(v != NULL, true);
+        check(v->val, i);
+    }
+    check(validate(&fh), true);
+    check(flat_hash_map_clear_and_free(&fh, NULL), CCC_RESULT_OK);
+    check(flat_hash_map_clear_and_free(&copy, NULL), CCC_RESULT_OK);
+    check(sized.live_bytes, 0);
+    check_end({
+        (void)flat_hash_map_clear_and_free(&fh, NULL);
+        (void)flat_hash_map_clear_and_free(&copy, NULL);
+    });
+}
+
 int
 main()
 {
     return check_run(flat_hash_map_test_static_initialize(),
+                     flat_hash_map_test_group_width(),
                      flat_hash_map_test_with_literal(),
                      flat_hash_map_test_copy_no_allocate(),
                      flat_hash_map_test_copy_no_allocate_fail(),
@@ -386,7 +816,18 @@ main()
                      flat_hash_map_test_empty(), flat_hash_map_test_init_from(),
                      flat_hash_map_test_init_from_overwrite(),
                      flat_hash_map_test_init_from_fail(),
+                     flat_hash_map_test_init_from_buffer(),
+                     flat_hash_map_test_extend_overwrite(),
+                     flat_hash_map_test_extend_fail(),
+                     flat_hash_map_test_snapshot_load(),
+                     flat_hash_map_test_snapshot_load_fail(),
+                     flat_hash_map_test_snapshot_load_read_only(),
                      flat_hash_map_test_init_with_capacity(),
                      flat_hash_map_test_init_with_capacity_no_op(),
-                     flat_hash_map_test_init_with_capacity_fail());
+                     flat_hash_map_test_init_with_capacity_fail(),
+                     flat_hash_map_test_sized_allocator(
+                         CCC_FLAT_HASH_MAP_OPTION_NONE),
+                     flat_hash_map_test_sized_allocator(
+                         CCC_FLAT_HASH_MAP_OPTION_STORE_HASH
+                         | CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE));
 }
@@ -915,6 +915,79 @@ check_static_begin(flat_hash_map_test_remove_entry)
     check_end();
 }
 
+check_static_begin(flat_hash_map_test_with_hash)
+{
+    /* One hash must drive maps with different internal hash handling and
+       the user hash function should run once per key. */
+    size_t hashes = 0;
+    Flat_hash_map plain = flat_hash_map_initialize(
+        &(Small_fixed_map){}, struct Val, key,
+        flat_hash_map_int_to_u64_counted, flat_hash_map_id_order, NULL,
+        &hashes, SMALL_FIXED_CAP);
+    Flat_hash_map mixed = flat_hash_map_initialize_with_options(
+        &(Small_fixed_map){}, struct Val, key,
+        flat_hash_map_int_to_u64_counted, flat_hash_map_id_order, NULL,
+        &hashes, SMALL_FIXED_CAP, CCC_FLAT_HASH_MAP_OPTION_MIX_HASH);
+    Flat_hash_map stored = flat_hash_map_initialize_with_options(
+        &(Small_stored_hash_fixed_map){}, struct Val, key,
+        flat_hash_map_int_to_u64_counted, flat_hash_map_id_order, NULL,
+        &hashes, SMALL_FIXED_CAP, CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    Flat_hash_map *const maps[] = {&plain, &mixed, &stored};
+    size_t const map_count = sizeof(maps) / sizeof(maps[0]);
+    int const size = 40;
+    for (int i = 0; i < size; ++i)
+    {
+        uint64_t const hash = flat_hash_map_hash(&plain, &i);
+        for (size_t m = 0; m < map_count; ++m)
+        {
+            check(flat_hash_map_contains_with_hash(maps[m], &i, hash), false);
+            CCC_Entry e = flat_hash_map_try_insert_with_hash(
+                maps[m], &(struct Val){.key = i, .val = i}, hash);
+            check(occupied(&e), false);
+            e = flat_hash_map_try_insert_with_hash(
+                maps[m], &(struct Val){.key = i, .val = -1}, hash);
+            check(occupied(&e), true);
+            check(((struct Val *)unwrap(&e))->val, i);
+            struct Val *const v
+                = flat_hash_map_get_key_value_with_hash(maps[m], &i, hash);
+            check(v != NULL, true);
+            check(v->val, i);
+            Flat_hash_map_entry const *const ent = and_modify(
+                flat_hash_map_entry_with_hash_wrap(maps[m], &i, hash),
+                flat_hash_map_modplus);
+            check(occupied(ent), true);
+            check(v->val, i + 1);
+        }
+    }
+    for (int i = 0; i < size; i += 2)
+    {
+        uint64_t const hash = flat_hash_map_hash(&plain, &i);
+        for (size_t m = 0; m < map_count; ++m)
+        {
+            struct Val out = {.key = i};
+            CCC_Entry const e
+                = flat_hash_map_remove_key_value_with_hash(maps[m], &out, hash);
+            check(occupied(&e), true);
+            check(out.val, i + 1);
+            check(flat_hash_map_contains_with_hash(maps[m], &i, hash), false);
+        }
+    }
+    check(hashes, (size_t)(size + (size / 2)));
+    for (size_t m = 0; m < map_count; ++m)
+    {
+        check(validate(maps[m]), true);
+        check(count(maps[m]).count, size / 2);
+        for (int i = 0; i < size; ++i)
+        {
+            check(contains(maps[m], &i), i % 2 != 0);
+        }
+    }
+    check(flat_hash_map_hash(NULL, &(int){0}), 0);
+    check(flat_hash_map_contains_with_hash(NULL, &(int){0}, 0),
+          CCC_TRIBOOL_ERROR);
+    check_end();
+}
+
 int
 main(void)
 {
@@ -930,5 +1003,5 @@ main(void)
         flat_hash_map_test_or_insert(), flat_hash_map_test_or_insert_with(),
         flat_hash_map_test_insert_entry(),
         flat_hash_map_test_insert_entry_with(),
-        flat_hash_map_test_remove_entry());
+        flat_hash_map_test_remove_entry(), flat_hash_map_test_with_hash());
 }
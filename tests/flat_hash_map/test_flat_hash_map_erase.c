@@ -310,6 +310,248 @@ check_static_begin(flat_hash_map_test_shuffle_erase_dynamic)
     check_end(flat_hash_map_clear_and_free(&h, NULL););
 }
 
+check_static_begin(flat_hash_map_test_shrink_to_fit)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    size_t const full_cap = capacity(&h).count;
+    for (int i = 100; i < 1000; ++i)
+    {
+        CCC_Entry removed = remove_entry(entry_wrap(&h, &i));
+        check(occupied(&removed), true);
+    }
+    check(capacity(&h).count, full_cap);
+    check(flat_hash_map_shrink_to_fit(&h, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_shrink_to_fit(&h, std_allocate), CCC_RESULT_OK);
+    /* 112 is the load factor of 128 slots, the first to fit 100 elements. */
+    check(capacity(&h).count, 128);
+    check(count(&h).count, 100);
+    check(validate(&h), true);
+    for (int i = 0; i < 100; ++i)
+    {
+        struct Val const *const v = get_key_value(&h, &i);
+        check(v != NULL, true);
+        check(v->val, i);
+    }
+    check(flat_hash_map_shrink_to_fit(&h, std_allocate), CCC_RESULT_OK);
+    check(capacity(&h).count, 128);
+    check_end(flat_hash_map_clear_and_free(&h, NULL););
+}
+
+check_static_begin(flat_hash_map_test_compact_fixed)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        &(Standard_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, STANDARD_FIXED_CAP);
+    for (int i = 0; i < 800; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    for (int i = 0; i < 800; i += 8)
+    {
+        CCC_Entry removed = remove_entry(entry_wrap(&h, &i));
+        check(occupied(&removed), true);
+    }
+    check(flat_hash_map_shrink_to_fit(&h, NULL),
+          CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(flat_hash_map_auto_shrink(&h, 4), CCC_RESULT_NO_ALLOCATION_FUNCTION);
+    check(flat_hash_map_compact(&h), CCC_RESULT_OK);
+    check(capacity(&h).count, STANDARD_FIXED_CAP);
+    check(count(&h).count, 700);
+    check(validate(&h), true);
+    for (int i = 0; i < 800; ++i)
+    {
+        check(contains(&h, &i), (i % 8) != 0);
+    }
+    /* Every removed slot is usable again without another rehash. */
+    for (int i = 800; i < 800 + 84; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    check(validate(&h), true);
+    check_end();
+}
+
+check_static_begin(flat_hash_map_test_auto_shrink)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0);
+    check(flat_hash_map_auto_shrink(&h, 1), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_auto_shrink(&h, 4), CCC_RESULT_OK);
+    for (int i = 0; i < 1024; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    size_t prev_cap = capacity(&h).count;
+    for (int i = 0; i < 1020; ++i)
+    {
+        if (i % 2)
+        {
+            CCC_Entry removed = remove_entry(entry_wrap(&h, &i));
+            check(occupied(&removed), true);
+        }
+        else
+        {
+            struct Val const *const old
+                = unwrap(remove_key_value_wrap(&h, &(struct Val){.key = i}));
+            check(old != NULL, true);
+            check(old->val, i);
+        }
+        size_t const cap = capacity(&h).count;
+        check(cap <= prev_cap, true);
+        /* One group, at most 64 slots, is the smallest table. */
+        check(count(&h).count >= cap / 4 || cap <= 64, true);
+        check(validate(&h), true);
+        prev_cap = cap;
+    }
+    check(capacity(&h).count <= 64, true);
+    for (int i = 1020; i < 1024; ++i)
+    {
+        check(contains(&h, &i), true);
+    }
+    check_end(flat_hash_map_clear_and_free(&h, NULL););
+}
+
+check_static_begin(flat_hash_map_test_stats)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        &(Standard_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, STANDARD_FIXED_CAP);
+    Flat_hash_map_stats stats = {};
+    check(flat_hash_map_stats(NULL, 0, &stats), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_stats(&h, 0, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_stats(&h, 0, &stats), CCC_RESULT_OK);
+    check(stats.capacity, 0);
+    for (int i = 0; i < 800; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    for (int i = 0; i < 800; i += 8)
+    {
+        CCC_Entry removed = remove_entry(entry_wrap(&h, &i));
+        check(occupied(&removed), true);
+    }
+    check(flat_hash_map_stats(&h, 0, &stats), CCC_RESULT_OK);
+    check(stats.count, 700);
+    check(stats.capacity, STANDARD_FIXED_CAP);
+    check(stats.sampled_groups,
+          STANDARD_FIXED_CAP / CCC_FLAT_HASH_MAP_GROUP_COUNT);
+    check(stats.sampled_elements, 700);
+    check(stats.bytes_used, 700 * sizeof(struct Val));
+    check(stats.bytes_allocated > stats.bytes_used, true);
+    size_t probed = 0;
+    for (size_t i = 0; i < CCC_FLAT_HASH_MAP_STATS_PROBE_BUCKETS; ++i)
+    {
+        probed += stats.probe_length[i];
+    }
+    check(probed, 700);
+    check(stats.probe_length[0] > 350, true);
+    check(stats.total_probe_length >= 700, true);
+    size_t groups = 0;
+    size_t full = 0;
+    for (size_t i = 0; i <= CCC_FLAT_HASH_MAP_GROUP_COUNT; ++i)
+    {
+        groups += stats.group_fill[i];
+        full += i * stats.group_fill[i];
+    }
+    check(groups, stats.sampled_groups);
+    check(full, 700);
+    check(stats.tombstones <= 100, true);
+    check(flat_hash_map_compact(&h), CCC_RESULT_OK);
+    check(flat_hash_map_stats(&h, 1, &stats), CCC_RESULT_OK);
+    check(stats.sampled_groups, 1);
+    check(stats.tombstones, 0);
+    check_end();
+}
+
+check_static_begin(flat_hash_map_test_stats_bad_hash)
+{
+    /* Every key hashes to zero so every element shares one tag and one home
+       group. The element placed k-th along the probe sequence is compared
+       after the k elements before it. */
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        &(Standard_fixed_map){}, struct Val, key, flat_hash_map_int_zero,
+        flat_hash_map_id_order, NULL, NULL, STANDARD_FIXED_CAP);
+    int const n = 200;
+    for (int i = 0; i < n; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    Flat_hash_map_stats stats = {};
+    check(flat_hash_map_stats(&h, 0, &stats), CCC_RESULT_OK);
+    check(stats.sampled_elements, n);
+    check(stats.false_tag_matches, (size_t)(n * (n - 1) / 2));
+    check(stats.max_probe_length > 1, true);
+    check(stats.probe_length[0], CCC_FLAT_HASH_MAP_GROUP_COUNT);
+    check_end();
+}
+
+static bool
+keep_multiple(CCC_Type_context const t)
+{
+    struct Val const *const v = t.type;
+    int *const calls = t.context;
+    ++*calls;
+    return v->key % 3 == 0;
+}
+
+check_static_begin(flat_hash_map_test_retain, CCC_Key_hasher *const hash,
+                   CCC_Flat_hash_map_option const options)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, hash, flat_hash_map_id_order, std_allocate, NULL,
+        0, options);
+    int calls = 0;
+    check(flat_hash_map_retain(&fh, keep_multiple, &calls).count, 0);
+    check(flat_hash_map_retain(&fh, NULL, &calls).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    int const size = 900;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e
+            = insert_or_assign(&fh, &(struct Val){.key = i, .val = i});
+        check(insert_error(&e), false);
+    }
+    CCC_Count const removed = flat_hash_map_retain(&fh, keep_multiple, &calls);
+    check(removed.error, CCC_RESULT_OK);
+    check(removed.count, size - ((size + 2) / 3));
+    check(calls, size);
+    check(count(&fh).count, (size + 2) / 3);
+    check(validate(&fh), true);
+    for (int i = 0; i < size; ++i)
+    {
+        check(contains(&fh, &i), i % 3 == 0);
+    }
+    /* Slots freed by the scan must be usable by later insertions. */
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e
+            = insert_or_assign(&fh, &(struct Val){.key = i, .val = -i});
+        check(occupied(&e), i % 3 == 0);
+    }
+    check(count(&fh).count, size);
+    check(validate(&fh), true);
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
 int
 main()
 {
@@ -317,5 +559,18 @@ main()
                      flat_hash_map_test_shuffle_insert_erase(),
                      flat_hash_map_test_shuffle_erase_fixed(),
                      flat_hash_map_test_shuffle_erase_reserved(),
-                     flat_hash_map_test_shuffle_erase_dynamic());
+                     flat_hash_map_test_shuffle_erase_dynamic(),
+                     flat_hash_map_test_shrink_to_fit(),
+                     flat_hash_map_test_compact_fixed(),
+                     flat_hash_map_test_auto_shrink(),
+                     flat_hash_map_test_stats(),
+                     flat_hash_map_test_stats_bad_hash(),
+                     flat_hash_map_test_retain(flat_hash_map_int_to_u64,
+                                               CCC_FLAT_HASH_MAP_OPTION_NONE),
+                     flat_hash_map_test_retain(
+                         flat_hash_map_int_last_digit,
+                         CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+                     flat_hash_map_test_retain(
+                         flat_hash_map_int_to_u64,
+                         CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE));
 }
@@ -4,6 +4,7 @@
 #define FLAT_HASH_MAP_USING_NAMESPACE_CCC
 #define TRAITS_USING_NAMESPACE_CCC
 
+#include "buffer.h"
 #include "checkers.h"
 #include "flat_hash_map.h"
 #include "flat_hash_map_utility.h"
@@ -690,6 +691,361 @@ check_static_begin(flat_hash_map_test_reserve_without_permissions)
     check_end(flat_hash_map_clear_and_free_reserve(&fh, NULL, std_allocate););
 }
 
+check_static_begin(flat_hash_map_test_insert_batch_resize)
+{
+    Flat_hash_map fh = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0);
+    enum : int
+    {
+        BATCH_SIZE = 500,
+    };
+    struct Val vals[BATCH_SIZE];
+    void const *types[BATCH_SIZE];
+    void *outputs[BATCH_SIZE];
+    /* Every key appears twice so half of the batch finds an earlier element
+       from the same batch. */
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        vals[i] = (struct Val){.key = i / 2, .val = i};
+        types[i] = &vals[i];
+    }
+    CCC_Count inserted
+        = flat_hash_map_or_insert_batch(&fh, types, BATCH_SIZE, outputs);
+    check(inserted.error, CCC_RESULT_OK);
+    check(inserted.count, BATCH_SIZE / 2);
+    check(count(&fh).count, BATCH_SIZE / 2);
+    check(validate(&fh), true);
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        struct Val const *const v = outputs[i];
+        check(v != NULL, true);
+        check(v->key, i / 2);
+        check(v->val, (i / 2) * 2);
+    }
+    /* Search for present and absent keys interleaved. */
+    int keys[BATCH_SIZE];
+    void const *key_pointers[BATCH_SIZE];
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        keys[i] = (i % 2) ? i + BATCH_SIZE : i;
+        key_pointers[i] = &keys[i];
+    }
+    CCC_Count const found = flat_hash_map_get_key_value_batch(
+        &fh, key_pointers, BATCH_SIZE, outputs);
+    check(found.error, CCC_RESULT_OK);
+    check(found.count, BATCH_SIZE / 4);
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        struct Val const *const v = outputs[i];
+        if (keys[i] < BATCH_SIZE / 2)
+        {
+            check(v != NULL, true);
+            check(v->key, keys[i]);
+        }
+        else
+        {
+            check(v == NULL, true);
+        }
+    }
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_insert_batch_limit)
+{
+    Flat_hash_map fh = flat_hash_map_initialize(
+        &(Small_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, SMALL_FIXED_CAP);
+    struct Val vals[SMALL_FIXED_CAP];
+    void const *types[SMALL_FIXED_CAP];
+    void *outputs[SMALL_FIXED_CAP];
+    for (int i = 0; i < (int)SMALL_FIXED_CAP; ++i)
+    {
+        vals[i] = (struct Val){.key = i, .val = i};
+        types[i] = &vals[i];
+    }
+    /* A fixed map cannot hold a full capacity of elements. The batch should
+       insert what fits and report the rest as NULL. */
+    CCC_Count const inserted
+        = flat_hash_map_or_insert_batch(&fh, types, SMALL_FIXED_CAP, outputs);
+    check(inserted.error, CCC_RESULT_OK);
+    check(inserted.count < SMALL_FIXED_CAP, true);
+    check(count(&fh).count, inserted.count);
+    check(validate(&fh), true);
+    size_t non_null = 0;
+    for (size_t i = 0; i < SMALL_FIXED_CAP; ++i)
+    {
+        struct Val const *const v = outputs[i];
+        if (v)
+        {
+            ++non_null;
+            check(v->key, vals[i].key);
+        }
+    }
+    check(non_null, inserted.count);
+    check(flat_hash_map_get_key_value_batch(&fh, NULL, 0, NULL).count, 0);
+    check(flat_hash_map_or_insert_batch(NULL, types, 1, outputs).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    check_end();
+}
+
+check_static_begin(flat_hash_map_test_stored_hash_resize)
+{
+    size_t hash_calls = 0;
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64_counted,
+        flat_hash_map_id_order, std_allocate, &hash_calls, 0,
+        CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    int const to_insert = 1000;
+    for (int i = 0; i < to_insert; ++i)
+    {
+        struct Val const *const v = insert_entry(
+            entry_wrap(&fh, &i), &(struct Val){.key = i, .val = i});
+        check(v != NULL, true);
+    }
+    /* Each entry query hashes once. Resizing must not hash again. */
+    check(hash_calls, (size_t)to_insert);
+    check(count(&fh).count, to_insert);
+    for (int i = 0; i < to_insert; i += 2)
+    {
+        CCC_Entry const e = remove_key_value(&fh, &(struct Val){.key = i});
+        check(occupied(&e), true);
+    }
+    for (int i = 0; i < to_insert; ++i)
+    {
+        check(contains(&fh, &i), (i % 2) != 0);
+    }
+    check(validate(&fh), true);
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_stored_hash_fixed_rehash)
+{
+    size_t hash_calls = 0;
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        &(Small_stored_hash_fixed_map){}, struct Val, key,
+        flat_hash_map_int_to_u64_counted, flat_hash_map_id_order, NULL,
+        &hash_calls,
+        flat_hash_map_fixed_capacity(Small_stored_hash_fixed_map),
+        CCC_FLAT_HASH_MAP_OPTION_STORE_HASH);
+    int const live = 40;
+    for (int i = 0; i < live; ++i)
+    {
+        CCC_Entry const e = try_insert(&fh, &(struct Val){.key = i, .val = i});
+        check(occupied(&e), false);
+    }
+    /* Churning through new keys leaves deleted tags behind until the map
+       must rehash in place to recover them. */
+    for (int i = live; i < live * 20; ++i)
+    {
+        CCC_Entry e = remove_key_value(&fh, &(struct Val){.key = i - live});
+        check(occupied(&e), true);
+        e = try_insert(&fh, &(struct Val){.key = i, .val = i});
+        check(occupied(&e), false);
+        check(validate(&fh), true);
+    }
+    check(count(&fh).count, live);
+    for (int i = live * 19; i < live * 20; ++i)
+    {
+        struct Val const *const v = get_key_value(&fh, &i);
+        check(v != NULL, true);
+        check(v->val, i);
+    }
+    check_end();
+}
+
+check_static_begin(flat_hash_map_test_incremental_resize,
+                   CCC_Flat_hash_map_option const options)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0,
+        options | CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE);
+    /* Just past a resize threshold so that the final checks run while the
+       previous table still holds most of the elements. */
+    int const to_insert = 900;
+    int const larger_prime = 907;
+    for (int i = 0, shuffled_index = larger_prime % to_insert; i < to_insert;
+         ++i, shuffled_index = (shuffled_index + larger_prime) % to_insert)
+    {
+        CCC_Entry const e = try_insert(
+            &fh, &(struct Val){.key = shuffled_index, .val = shuffled_index});
+        check(occupied(&e), false);
+        check(unwrap(&e) != NULL, true);
+        /* Every key must be visible while elements are split across tables. */
+        check(contains(&fh, &shuffled_index), true);
+        if (i % 97 == 0)
+        {
+            check(validate(&fh), true);
+        }
+    }
+    check(count(&fh).count, to_insert);
+    check(validate(&fh), true);
+    /* Copying and iterating must see elements in both tables as well. */
+    Flat_hash_map copy = flat_hash_map_initialize(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0);
+    check(flat_hash_map_copy(&copy, &fh, std_allocate), CCC_RESULT_OK);
+    check(count(&copy).count, to_insert);
+    size_t seen = 0;
+    for (struct Val const *v = begin(&fh); v != end(&fh); v = next(&fh, v))
+    {
+        check(v->key, v->val);
+        check(contains(&copy, &v->key), true);
+        ++seen;
+    }
+    check(seen, (size_t)to_insert);
+    for (int i = 0; i < to_insert; i += 2)
+    {
+        CCC_Entry const e = remove_key_value(&fh, &(struct Val){.key = i});
+        check(occupied(&e), true);
+    }
+    check(count(&fh).count, to_insert / 2);
+    check(validate(&fh), true);
+    for (int i = 0; i < to_insert; ++i)
+    {
+        struct Val const *const v = get_key_value(&fh, &i);
+        check(v != NULL, (i % 2) != 0);
+    }
+    check_end(flat_hash_map_clear_and_free(&fh, NULL);
+              flat_hash_map_clear_and_free(&copy, NULL););
+}
+
+/* The identity hash leaves every key below with equal low bits and equal upper
+seven bits so only the finalizer spreads them across groups and tags. */
+static uint64_t
+int_identity(CCC_Key_context const k)
+{
+    return (uint64_t)*((int *)k.key);
+}
+
+check_static_begin(flat_hash_map_test_mix_hash,
+                   CCC_Flat_hash_map_option const options)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, int_identity, flat_hash_map_id_order,
+        std_allocate, NULL, 0, options | CCC_FLAT_HASH_MAP_OPTION_MIX_HASH);
+    int const to_insert = 1000;
+    int const shift = 20;
+    for (int i = 0; i < to_insert; ++i)
+    {
+        int const key = i << shift;
+        CCC_Entry const e
+            = insert_or_assign(&fh, &(struct Val){.key = key, .val = i});
+        check(insert_error(&e), false);
+    }
+    check(count(&fh).count, to_insert);
+    check(validate(&fh), true);
+    for (int i = 0; i < to_insert; i += 2)
+    {
+        CCC_Entry const e
+            = remove_key_value(&fh, &(struct Val){.key = i << shift});
+        check(occupied(&e), true);
+    }
+    check(validate(&fh), true);
+    for (int i = 0; i < to_insert; ++i)
+    {
+        int const key = i << shift;
+        struct Val const *const v = get_key_value(&fh, &key);
+        check(v != NULL, (i % 2) != 0);
+        if (v)
+        {
+            check(v->val, i);
+        }
+    }
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_reserve_parallel,
+                   CCC_Flat_hash_map_option const options)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0, options);
+    check(flat_hash_map_reserve_parallel(&h, 0, std_allocate, 4),
+          CCC_RESULT_ARGUMENT_ERROR);
+    int const size = 20000;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    size_t const old_cap = capacity(&h).count;
+    check(flat_hash_map_reserve_parallel(&h, 100000, std_allocate, 4),
+          CCC_RESULT_OK);
+    check(capacity(&h).count > old_cap, true);
+    check(validate(&h), true);
+    check(count(&h).count, size);
+    for (int i = 0; i < size; ++i)
+    {
+        struct Val const *const v = get_key_value(&h, &i);
+        check(v != NULL, true);
+        check(v->val, i);
+    }
+    /* Room was reserved so no more resizing occurs. */
+    size_t const reserved_cap = capacity(&h).count;
+    for (int i = size; i < size + 100000; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = i});
+        check(insert_error(e), false);
+    }
+    check(capacity(&h).count, reserved_cap);
+    check(validate(&h), true);
+    check_end(flat_hash_map_clear_and_free(&h, NULL););
+}
+
+check_static_begin(flat_hash_map_test_extend_parallel,
+                   CCC_Key_hasher *const hash, int const keys)
+{
+    CCC_Flat_hash_map h = flat_hash_map_initialize(
+        NULL, struct Val, key, hash, flat_hash_map_id_order, std_allocate, NULL,
+        0);
+    for (int i = 0; i < 100; ++i)
+    {
+        CCC_Entry const *const e = flat_hash_map_insert_or_assign_with(
+            &h, i, (struct Val){.val = -1});
+        check(insert_error(e), false);
+    }
+    /* Every key appears once or twice and the later value must win. */
+    int const total = keys + (keys / 2);
+    CCC_Buffer buf
+        = CCC_buffer_with_capacity(struct Val, std_allocate, NULL, total);
+    for (int i = 0; i < total; ++i)
+    {
+        struct Val *const v
+            = CCC_buffer_push_back(&buf, &(struct Val){i % keys, i});
+        check(v != NULL, true);
+    }
+    check(flat_hash_map_extend_parallel(&h, &buf, CCC_FALSE, 4), CCC_RESULT_OK);
+    check(validate(&h), true);
+    check(count(&h).count, keys);
+    for (int k = 0; k < keys; ++k)
+    {
+        struct Val const *const v = get_key_value(&h, &k);
+        check(v != NULL, true);
+        check(v->val, k < keys / 2 ? k + keys : k);
+    }
+    /* Distinct new keys may skip comparison entirely. */
+    for (int i = 0; i < total; ++i)
+    {
+        struct Val *const v = CCC_buffer_at(&buf, i);
+        *v = (struct Val){keys + i, i};
+    }
+    check(flat_hash_map_extend_parallel(&h, &buf, CCC_TRUE, 3), CCC_RESULT_OK);
+    check(validate(&h), true);
+    check(count(&h).count, keys + total);
+    for (int i = 0; i < keys + total; ++i)
+    {
+        check(contains(&h, &i), true);
+    }
+    check_end({
+        (void)flat_hash_map_clear_and_free(&h, NULL);
+        (void)CCC_buffer_clear_and_free(&buf, NULL);
+    });
+}
+
 int
 main(void)
 {
@@ -707,5 +1063,20 @@ main(void)
         flat_hash_map_test_resize_from_null(),
         flat_hash_map_test_resize_from_null_macros(),
         flat_hash_map_test_insert_limit(),
-        flat_hash_map_test_reserve_without_permissions());
+        flat_hash_map_test_reserve_without_permissions(),
+        flat_hash_map_test_insert_batch_resize(),
+        flat_hash_map_test_insert_batch_limit(),
+        flat_hash_map_test_stored_hash_resize(),
+        flat_hash_map_test_stored_hash_fixed_rehash(),
+        flat_hash_map_test_incremental_resize(CCC_FLAT_HASH_MAP_OPTION_NONE),
+        flat_hash_map_test_incremental_resize(
+            CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+        flat_hash_map_test_mix_hash(CCC_FLAT_HASH_MAP_OPTION_NONE),
+        flat_hash_map_test_mix_hash(CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+        flat_hash_map_test_reserve_parallel(CCC_FLAT_HASH_MAP_OPTION_NONE),
+        flat_hash_map_test_reserve_parallel(
+            CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+        flat_hash_map_test_extend_parallel(flat_hash_map_int_to_u64, 50000),
+        flat_hash_map_test_extend_parallel(flat_hash_map_int_last_digit,
+                                           1000));
 }
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -32,6 +33,38 @@ destroy_owner_allocation(CCC_Type_context const t)
     free(o->allocation);
 }
 
+enum : size_t
+{
+    RANGE_THREADS = 4,
+};
+
+struct Range_scan
+{
+    Flat_hash_map *map;
+    size_t start;
+    size_t end;
+    size_t seen;
+    CCC_Result result;
+};
+
+static void
+count_and_bump(CCC_Type_context const t)
+{
+    struct Val *const v = t.type;
+    struct Range_scan *const scan = t.context;
+    ++v->val;
+    ++scan->seen;
+}
+
+static void *
+scan_range(void *const arg)
+{
+    struct Range_scan *const scan = arg;
+    scan->result = flat_hash_map_for_each_range(
+        scan->map, scan->start, scan->end, count_and_bump, scan);
+    return NULL;
+}
+
 check_static_begin(flat_hash_map_test_insert_then_iterate)
 {
     CCC_Flat_hash_map fh = flat_hash_map_initialize(
@@ -91,9 +124,74 @@ check_static_begin(flat_hash_map_test_insert_allocate_clear_free)
     check_end(CCC_flat_hash_map_clear_and_free(&fh, destroy_owner_allocation););
 }
 
+check_static_begin(flat_hash_map_test_for_each_range,
+                   CCC_Flat_hash_map_option const options)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0, options);
+    check(flat_hash_map_group_count(&fh).count, 0);
+    check(flat_hash_map_for_each_range(&fh, 0, 0, count_and_bump, NULL),
+          CCC_RESULT_OK);
+    /* Just past a resize threshold so an incremental resize is still moving
+       elements and the ranges must span both tables. */
+    int const size = 900;
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e
+            = insert_or_assign(&fh, &(struct Val){.key = i, .val = i});
+        check(insert_error(&e), false);
+    }
+    CCC_Count const groups = flat_hash_map_group_count(&fh);
+    check(groups.error, CCC_RESULT_OK);
+    check(flat_hash_map_for_each_range(&fh, 0, groups.count + 1,
+                                       count_and_bump, NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(flat_hash_map_for_each_range(&fh, 1, 0, count_and_bump, NULL),
+          CCC_RESULT_ARGUMENT_ERROR);
+    size_t const share = (groups.count + RANGE_THREADS - 1) / RANGE_THREADS;
+    pthread_t threads[RANGE_THREADS];
+    struct Range_scan scans[RANGE_THREADS];
+    for (size_t t = 0; t < RANGE_THREADS; ++t)
+    {
+        size_t const start
+            = t * share < groups.count ? t * share : groups.count;
+        size_t const end
+            = start + share < groups.count ? start + share : groups.count;
+        scans[t] = (struct Range_scan){
+            .map = &fh,
+            .start = start,
+            .end = end,
+            .result = CCC_RESULT_FAIL,
+        };
+        check(pthread_create(&threads[t], NULL, scan_range, &scans[t]), 0);
+    }
+    size_t seen = 0;
+    for (size_t t = 0; t < RANGE_THREADS; ++t)
+    {
+        check(pthread_join(threads[t], NULL), 0);
+        check(scans[t].result, CCC_RESULT_OK);
+        seen += scans[t].seen;
+    }
+    /* Every element is visited exactly once across the disjoint ranges. */
+    check(seen, (size_t)size);
+    for (int i = 0; i < size; ++i)
+    {
+        struct Val const *const v = get_key_value(&fh, &i);
+        check(v != NULL, true);
+        check(v->val, i + 1);
+    }
+    check(validate(&fh), true);
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
 int
 main(void)
 {
     return check_run(flat_hash_map_test_insert_then_iterate(),
-                     flat_hash_map_test_insert_allocate_clear_free());
+                     flat_hash_map_test_insert_allocate_clear_free(),
+                     flat_hash_map_test_for_each_range(
+                         CCC_FLAT_HASH_MAP_OPTION_NONE),
+                     flat_hash_map_test_for_each_range(
+                         CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE));
 }
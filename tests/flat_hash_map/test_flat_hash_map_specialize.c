@@ -0,0 +1,164 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+#define TRAITS_USING_NAMESPACE_CCC
+
+#include "checkers.h"
+#include "flat_hash_map.h"
+#include "flat_hash_map_utility.h"
+#include "traits.h"
+#include "types.h"
+#include "utility/allocate.h"
+
+static inline uint64_t
+val_hash(int const *const key)
+{
+    return flat_hash_map_int_to_u64((CCC_Key_context){.key = key});
+}
+
+static inline uint64_t
+val_last_digit(int const *const key)
+{
+    return flat_hash_map_int_last_digit((CCC_Key_context){.key = key});
+}
+
+static inline bool
+val_equal(int const *const left, int const *const right)
+{
+    return *left == *right;
+}
+
+CCC_FLAT_HASH_MAP_SPECIALIZE(val_map, struct Val, key, val_hash, val_equal);
+CCC_FLAT_HASH_MAP_SPECIALIZE(digit_map, struct Val, key, val_last_digit,
+                             val_equal);
+
+check_static_begin(flat_hash_map_test_specialize_mixed,
+                   Flat_hash_map_option const options)
+{
+    Flat_hash_map fh = flat_hash_map_initialize_with_options(
+        NULL, struct Val, key, flat_hash_map_int_to_u64, flat_hash_map_id_order,
+        std_allocate, NULL, 0, options);
+    int const size = 1000;
+    check(val_map_contains(&fh, &(int){0}), false);
+    for (int i = 0; i < size; ++i)
+    {
+        CCC_Entry const e = val_map_insert_or_assign(
+            &fh, &(struct Val){.key = i, .val = i});
+        check(CCC_entry_occupied(&e), false);
+        check(((struct Val *)CCC_entry_unwrap(&e))->key, i);
+    }
+    check(validate(&fh), true);
+    check(count(&fh).count, size);
+    /* The library and the specialized functions must find the same slots. */
+    for (int i = 0; i < size; ++i)
+    {
+        struct Val const *const lib = get_key_value(&fh, &i);
+        struct Val const *const spec = val_map_get_key_value(&fh, &i);
+        check(lib != NULL, true);
+        check(lib == spec, true);
+        check(spec->val, i);
+    }
+    for (int i = 0; i < size; i += 2)
+    {
+        CCC_Entry const e = val_map_insert_or_assign(
+            &fh, &(struct Val){.key = i, .val = -i});
+        check(CCC_entry_occupied(&e), true);
+    }
+    for (int i = 0; i < size; i += 3)
+    {
+        struct Val out = {.key = i};
+        CCC_Entry const e = val_map_remove_key_value(&fh, &out);
+        check(CCC_entry_occupied(&e), true);
+        check(out.val, i % 2 ? i : -i);
+    }
+    check(validate(&fh), true);
+    for (int i = 0; i < size; ++i)
+    {
+        check(val_map_contains(&fh, &i), i % 3 != 0);
+        check(contains(&fh, &i), i % 3 != 0);
+    }
+    struct Val out = {.key = 0};
+    CCC_Entry const e = val_map_remove_key_value(&fh, &out);
+    check(CCC_entry_occupied(&e), false);
+    check_end(flat_hash_map_clear_and_free(&fh, NULL););
+}
+
+check_static_begin(flat_hash_map_test_specialize_collisions)
+{
+    /* Every key hashes to one of ten values so long runs of full and deleted
+       slots form and the erase rule decides between empty and deleted. */
+    Flat_hash_map fh = flat_hash_map_initialize(
+        &(Standard_fixed_map){}, struct Val, key, flat_hash_map_int_last_digit,
+        flat_hash_map_id_order, NULL, NULL, STANDARD_FIXED_CAP);
+    int const size = 500;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            CCC_Entry const e = digit_map_insert_or_assign(
+                &fh, &(struct Val){.key = i, .val = round});
+            check(CCC_entry_insert_error(&e), false);
+        }
+        check(validate(&fh), true);
+        for (int i = round; i < size; i += 2)
+        {
+            struct Val out = {.key = i};
+            CCC_Entry const e = digit_map_remove_key_value(&fh, &out);
+            check(CCC_entry_occupied(&e), true);
+            check(out.val, round);
+        }
+        check(validate(&fh), true);
+        for (int i = 0; i < size; ++i)
+        {
+            struct Val const *const v = get_key_value(&fh, &i);
+            check(v == NULL, i >= round && (i - round) % 2 == 0);
+            check(digit_map_get_key_value(&fh, &i) == v, true);
+        }
+    }
+    check_end();
+}
+
+check_static_begin(flat_hash_map_test_specialize_fixed_full)
+{
+    Flat_hash_map fh = flat_hash_map_initialize(
+        &(Small_fixed_map){}, struct Val, key, flat_hash_map_int_to_u64,
+        flat_hash_map_id_order, NULL, NULL, SMALL_FIXED_CAP);
+    int inserted = 0;
+    for (int i = 0; i < (int)SMALL_FIXED_CAP; ++i)
+    {
+        CCC_Entry const e = val_map_insert_or_assign(
+            &fh, &(struct Val){.key = i, .val = i});
+        if (CCC_entry_insert_error(&e))
+        {
+            break;
+        }
+        ++inserted;
+    }
+    check(inserted < (int)SMALL_FIXED_CAP, true);
+    check(count(&fh).count, inserted);
+    check(validate(&fh), true);
+    /* A full table still assigns to keys already present. */
+    CCC_Entry const e = val_map_insert_or_assign(
+        &fh, &(struct Val){.key = 0, .val = 99});
+    check(CCC_entry_occupied(&e), true);
+    check(val_map_get_key_value(&fh, &(int){0})->val, 99);
+    check(val_map_insert_or_assign(NULL, &(struct Val){}).private.status,
+          CCC_ENTRY_ARGUMENT_ERROR);
+    check(val_map_contains(NULL, &(int){0}), CCC_TRIBOOL_ERROR);
+    check_end();
+}
+
+int
+main()
+{
+    return check_run(
+        flat_hash_map_test_specialize_mixed(CCC_FLAT_HASH_MAP_OPTION_NONE),
+        flat_hash_map_test_specialize_mixed(
+            CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+        flat_hash_map_test_specialize_mixed(CCC_FLAT_HASH_MAP_OPTION_MIX_HASH),
+        flat_hash_map_test_specialize_mixed(
+            CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE),
+        flat_hash_map_test_specialize_collisions(),
+        flat_hash_map_test_specialize_fixed_full());
+}
@@ -0,0 +1,204 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLAT_HASH_MULTIMAP_USING_NAMESPACE_CCC
+
+#include "ccc/flat_hash_multimap.h"
+#include "ccc/hash.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+struct Row
+{
+    uint32_t key;
+    uint32_t row;
+};
+
+flat_hash_multimap_declare_fixed(Small_fixed_multimap, struct Row, 64);
+
+static CCC_Order
+row_order(CCC_Key_comparator_context const order)
+{
+    uint32_t const *const left = order.key_left;
+    struct Row const *const right = order.type_right;
+    return (*left > right->key) - (*left < right->key);
+}
+
+static void
+count_destroyed(CCC_Type_context const t)
+{
+    ++*(size_t *)t.context;
+}
+
+/** Key k appears k % 5 + 1 times with rows numbered after their key. */
+static uint32_t
+copies_of(uint32_t const key)
+{
+    return key % 5 + 1;
+}
+
+static uint32_t
+row_of(uint32_t const key, uint32_t const copy)
+{
+    return key * 10 + copy;
+}
+
+check_static_begin(flat_hash_multimap_test_equal_range)
+{
+    Flat_hash_multimap map = flat_hash_multimap_initialize(
+        NULL, struct Row, key, CCC_hash_key_u32, row_order, std_allocate, NULL,
+        0);
+    uint32_t const keys = 200;
+    size_t total = 0;
+    for (uint32_t copy = 0; copy < 5; ++copy)
+    {
+        for (uint32_t key = 0; key < keys; ++key)
+        {
+            if (copy < copies_of(key))
+            {
+                CCC_Entry const e = flat_hash_multimap_insert(
+                    &map, &(struct Row){.key = key, .row = row_of(key, copy)});
+                check(CCC_entry_occupied(&e), false);
+                check(CCC_entry_insert_error(&e), false);
+                ++total;
+            }
+        }
+    }
+    check(flat_hash_multimap_count(&map).count, total);
+    check(flat_hash_multimap_validate(&map), true);
+    for (uint32_t key = 0; key < keys; ++key)
+    {
+        check(flat_hash_multimap_count_key(&map, &key).count, copies_of(key));
+        struct Row *rows[5] = {};
+        CCC_Count const n
+            = flat_hash_multimap_equal_range(&map, &key, (void **)rows, 5);
+        check(n.count, copies_of(key));
+        uint32_t seen = 0;
+        for (size_t i = 0; i < n.count; ++i)
+        {
+            check(rows[i]->key, key);
+            check(rows[i]->row / 10, key);
+            seen |= 1U << (rows[i]->row % 10);
+        }
+        check(seen, (1U << copies_of(key)) - 1);
+    }
+    /* A short range still reports the full count. */
+    struct Row *one[1] = {};
+    uint32_t const four = 4;
+    check(flat_hash_multimap_equal_range(&map, &four, (void **)one, 1).count,
+          5);
+    check(one[0]->key, four);
+    check(flat_hash_multimap_count_key(&map, &keys).count, 0);
+    check(flat_hash_multimap_contains(&map, &keys), false);
+    check_end(flat_hash_multimap_clear_and_free(&map, NULL););
+}
+
+check_static_begin(flat_hash_multimap_test_remove)
+{
+    size_t destroyed = 0;
+    Flat_hash_multimap map = flat_hash_multimap_initialize(
+        NULL, struct Row, key, CCC_hash_key_u32, row_order, std_allocate,
+        &destroyed, 0);
+    uint32_t const keys = 100;
+    size_t total = 0;
+    for (uint32_t key = 0; key < keys; ++key)
+    {
+        for (uint32_t copy = 0; copy < copies_of(key); ++copy)
+        {
+            CCC_Entry const e = flat_hash_multimap_insert(
+                &map, &(struct Row){.key = key, .row = row_of(key, copy)});
+            check(CCC_entry_insert_error(&e), false);
+            ++total;
+        }
+    }
+    size_t removed = 0;
+    for (uint32_t key = 0; key < keys; key += 2)
+    {
+        CCC_Count const n
+            = flat_hash_multimap_remove_all(&map, &key, count_destroyed);
+        check(n.count, copies_of(key));
+        removed += n.count;
+    }
+    check(destroyed, removed);
+    check(flat_hash_multimap_count(&map).count, total - removed);
+    check(flat_hash_multimap_validate(&map), true);
+    for (uint32_t key = 0; key < keys; ++key)
+    {
+        check(flat_hash_multimap_count_key(&map, &key).count,
+              key % 2 ? copies_of(key) : 0);
+    }
+    /* Removing one at a time takes every copy in turn. */
+    for (uint32_t key = 1; key < keys; key += 2)
+    {
+        for (uint32_t left = copies_of(key); left > 0; --left)
+        {
+            struct Row out = {.key = key};
+            CCC_Entry const e = flat_hash_multimap_remove_key_value(&map, &out);
+            check(CCC_entry_occupied(&e), true);
+            check(out.row / 10, key);
+            check(flat_hash_multimap_count_key(&map, &key).count, left - 1);
+        }
+        struct Row out = {.key = key};
+        CCC_Entry const e = flat_hash_multimap_remove_key_value(&map, &out);
+        check(CCC_entry_occupied(&e), false);
+    }
+    check(flat_hash_multimap_is_empty(&map), true);
+    check(flat_hash_multimap_validate(&map), true);
+    check_end(flat_hash_multimap_clear_and_free(&map, NULL););
+}
+
+/** Many copies of a few keys in a fixed table that fills completely. */
+check_static_begin(flat_hash_multimap_test_fixed)
+{
+    Flat_hash_multimap map = flat_hash_multimap_initialize(
+        &(Small_fixed_multimap){}, struct Row, key, CCC_hash_key_u32,
+        row_order, NULL, NULL,
+        flat_hash_multimap_fixed_capacity(Small_fixed_multimap));
+    size_t inserted = 0;
+    for (uint32_t row = 0;; ++row)
+    {
+        CCC_Entry const e = flat_hash_multimap_insert(
+            &map, &(struct Row){.key = row % 3, .row = row});
+        if (CCC_entry_insert_error(&e))
+        {
+            break;
+        }
+        ++inserted;
+    }
+    check(inserted > 0, true);
+    check(flat_hash_multimap_count(&map).count, inserted);
+    size_t sum = 0;
+    for (uint32_t key = 0; key < 3; ++key)
+    {
+        sum += flat_hash_multimap_count_key(&map, &key).count;
+    }
+    check(sum, inserted);
+    uint32_t const zero = 0;
+    check(flat_hash_multimap_remove_all(&map, &zero, NULL).count,
+          (inserted + 2) / 3);
+    check(flat_hash_multimap_validate(&map), true);
+    size_t iterated = 0;
+    for (struct Row const *r = flat_hash_multimap_begin(&map);
+         r != flat_hash_multimap_end(&map);
+         r = flat_hash_multimap_next(&map, r))
+    {
+        check(r->key != 0, true);
+        ++iterated;
+    }
+    check(iterated, flat_hash_multimap_count(&map).count);
+    /* Room freed by the removal is reused by the next copies. */
+    CCC_Entry const e
+        = flat_hash_multimap_insert(&map, &(struct Row){.key = 0, .row = 0});
+    check(CCC_entry_insert_error(&e), false);
+    check(flat_hash_multimap_count_key(&map, &zero).count, 1);
+    check_end(flat_hash_multimap_clear(&map, NULL););
+}
+
+int
+main(void)
+{
+    return check_run(flat_hash_multimap_test_equal_range(),
+                     flat_hash_multimap_test_remove(),
+                     flat_hash_multimap_test_fixed());
+}
@@ -0,0 +1,174 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+#define HASH_USING_NAMESPACE_CCC
+#define TRAITS_USING_NAMESPACE_CCC
+
+#include "ccc/flat_hash_map.h"
+#include "ccc/hash.h"
+#include "ccc/traits.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+enum : size_t
+{
+    MAX_LENGTH = 256,
+    TAG_BITS = 7,
+    TAG_VALUES = 1 << TAG_BITS,
+    SEQUENTIAL_KEYS = 4096,
+};
+
+struct Id
+{
+    uint32_t id;
+};
+
+struct Name
+{
+    char const *name;
+    int id;
+};
+
+static CCC_Order
+name_order(CCC_Key_comparator_context const order)
+{
+    char const *const *const left = order.key_left;
+    struct Name const *const right = order.type_right;
+    int const cmp = strcmp(*left, right->name);
+    return (cmp > 0) - (cmp < 0);
+}
+
+static CCC_Order
+u32_order(CCC_Key_comparator_context const order)
+{
+    uint32_t const *const left = order.key_left;
+    struct Id const *const right = order.type_right;
+    return (*left > right->id) - (*left < right->id);
+}
+
+/* Every prefix of a buffer is hashed with every length stage. Any two equal
+results would mean bytes past the length leaked in or a stage dropped bytes. */
+check_static_begin(hash_test_bytes_lengths)
+{
+    unsigned char buffer[MAX_LENGTH] = {};
+    uint64_t hashes[MAX_LENGTH] = {};
+    for (size_t i = 0; i < MAX_LENGTH; ++i)
+    {
+        hashes[i] = hash_bytes(buffer, i, HASH_DEFAULT_SEED);
+        check(hashes[i], hash_bytes(buffer, i, HASH_DEFAULT_SEED));
+        for (size_t j = 0; j < i; ++j)
+        {
+            check(hashes[i] != hashes[j], true);
+        }
+    }
+    check(hash_bytes(NULL, 10, HASH_DEFAULT_SEED), hashes[0]);
+    check_end();
+}
+
+/* Flipping any single bit of an input must change the hash for inputs that
+use each of the short, medium, and three lane paths. */
+check_static_begin(hash_test_bytes_every_bit)
+{
+    size_t const lengths[] = {1, 3, 4, 7, 8, 15, 16, 17, 47, 48, 49, 97, 200};
+    unsigned char buffer[MAX_LENGTH];
+    for (size_t i = 0; i < MAX_LENGTH; ++i)
+    {
+        buffer[i] = (unsigned char)(i * 31);
+    }
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+    {
+        size_t const len = lengths[l];
+        uint64_t const original = hash_bytes(buffer, len, HASH_DEFAULT_SEED);
+        for (size_t bit = 0; bit < len * 8; ++bit)
+        {
+            buffer[bit / 8] ^= (unsigned char)(1U << (bit % 8));
+            check(hash_bytes(buffer, len, HASH_DEFAULT_SEED) != original, true);
+            buffer[bit / 8] ^= (unsigned char)(1U << (bit % 8));
+        }
+        check(hash_bytes(buffer, len, HASH_DEFAULT_SEED), original);
+    }
+    check_end();
+}
+
+check_static_begin(hash_test_seed)
+{
+    char const *const text = "the quick brown fox jumps over the lazy dog";
+    check(hash_string(text, 0) != hash_string(text, 1), true);
+    check(hash_u64(42, 0) != hash_u64(42, 1), true);
+    check(hash_string(text, 7), hash_bytes(text, strlen(text), 7));
+    check(hash_string(NULL, 7), hash_string("", 7));
+    check(hash_u32(42, 7), hash_u64(42, 7));
+    check_end();
+}
+
+/* Sequential integers are the common worst case for weak hashes. The upper
+seven bits form the flat hash map tag and must take on every value. */
+check_static_begin(hash_test_sequential_integers_spread)
+{
+    bool u64_tags[TAG_VALUES] = {};
+    bool mix_tags[TAG_VALUES] = {};
+    size_t u64_distinct = 0;
+    size_t mix_distinct = 0;
+    for (uint64_t i = 0; i < SEQUENTIAL_KEYS; ++i)
+    {
+        uint64_t const h = hash_u64(i, HASH_DEFAULT_SEED);
+        uint64_t const m = hash_mix(i);
+        u64_distinct += !u64_tags[h >> (64 - TAG_BITS)];
+        u64_tags[h >> (64 - TAG_BITS)] = true;
+        mix_distinct += !mix_tags[m >> (64 - TAG_BITS)];
+        mix_tags[m >> (64 - TAG_BITS)] = true;
+        check(m != hash_mix(i + 1), true);
+    }
+    check(u64_distinct, (size_t)TAG_VALUES);
+    check(mix_distinct, (size_t)TAG_VALUES);
+    check_end();
+}
+
+check_static_begin(hash_test_key_hashers_in_map)
+{
+    Flat_hash_map names = flat_hash_map_initialize(
+        NULL, struct Name, name, hash_key_string, name_order, std_allocate,
+        NULL, 0);
+    char const *const words[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+    size_t const n = sizeof(words) / sizeof(words[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(
+            &names, &(struct Name){.name = words[i], .id = (int)i});
+        check(insert_error(&e), false);
+    }
+    char const buffer[] = "gamma";
+    char const *const lookup = buffer;
+    struct Name const *const found = get_key_value(&names, &lookup);
+    check(found != NULL, true);
+    check(found->id, 2);
+    check(hash_key_string((CCC_Key_context){.key = &lookup}),
+          hash_string("gamma", HASH_DEFAULT_SEED));
+
+    Flat_hash_map ids = flat_hash_map_initialize(
+        NULL, struct Id, id, hash_key_u32, u32_order, std_allocate, NULL, 0);
+    for (uint32_t i = 0; i < SEQUENTIAL_KEYS; ++i)
+    {
+        CCC_Entry const e = insert_or_assign(&ids, &(struct Id){.id = i << 16});
+        check(insert_error(&e), false);
+    }
+    check(count(&ids).count, (size_t)SEQUENTIAL_KEYS);
+    check(validate(&ids), true);
+    uint64_t const wide = 99;
+    check(hash_key_u64((CCC_Key_context){.key = &wide}),
+          hash_u64(99, HASH_DEFAULT_SEED));
+    check_end(flat_hash_map_clear_and_free(&names, NULL);
+              flat_hash_map_clear_and_free(&ids, NULL););
+}
+
+int
+main(void)
+{
+    return check_run(hash_test_bytes_lengths(), hash_test_bytes_every_bit(),
+                     hash_test_seed(), hash_test_sequential_integers_spread(),
+                     hash_test_key_hashers_in_map());
+}
@@ -0,0 +1,231 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define OPTIMISTIC_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+
+#include "ccc/flat_hash_map.h"
+#include "ccc/hash.h"
+#include "ccc/optimistic_flat_hash_map.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+enum : size_t
+{
+    READERS = 4,
+    STABLE_KEYS = 64,
+    WRITER_KEYS = 20000,
+    ROUNDS = 8,
+};
+
+/* The writer always stores equal copies so a torn read is detectable. */
+struct Val
+{
+    uint64_t key;
+    uint64_t a;
+    uint64_t b;
+};
+
+struct Reader
+{
+    Optimistic_flat_hash_map const *map;
+    atomic_bool const *done;
+    size_t id;
+    size_t lookups;
+    size_t failures;
+};
+
+static CCC_Order
+val_key_order(CCC_Key_comparator_context const order)
+{
+    uint64_t const *const left = order.key_left;
+    struct Val const *const right = order.type_right;
+    return (*left > right->key) - (*left < right->key);
+}
+
+static void *
+read_stable(void *const arg)
+{
+    struct Reader *const r = arg;
+    uint64_t key = r->id;
+    while (!atomic_load(r->done))
+    {
+        key = (key + 7) % STABLE_KEYS;
+        struct Val out = {};
+        CCC_Tribool const found
+            = optimistic_flat_hash_map_get_key_value(r->map, r->id, &key, &out);
+        r->failures += found != CCC_TRUE || out.key != key || out.a != out.b
+                     || out.a % STABLE_KEYS != key;
+        r->failures
+            += optimistic_flat_hash_map_contains(r->map, r->id, &key) != true;
+        ++r->lookups;
+    }
+    return NULL;
+}
+
+check_static_begin(optimistic_flat_hash_map_test_initialize_errors)
+{
+    Optimistic_flat_hash_map map = {};
+    check(optimistic_flat_hash_map_initialize(&map, struct Val, key,
+                                              CCC_hash_key_u64, val_key_order,
+                                              std_allocate, NULL, 0),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(optimistic_flat_hash_map_initialize(&map, struct Val, key,
+                                              CCC_hash_key_u64, val_key_order,
+                                              NULL, NULL, READERS),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(optimistic_flat_hash_map_initialize_with_options(
+              &map, struct Val, key, CCC_hash_key_u64, val_key_order,
+              std_allocate, NULL, READERS,
+              CCC_FLAT_HASH_MAP_OPTION_INCREMENTAL_RESIZE),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(optimistic_flat_hash_map_initialize(&map, struct Val, key,
+                                              CCC_hash_key_u64, val_key_order,
+                                              std_allocate, NULL, READERS),
+          CCC_RESULT_OK);
+    uint64_t const key = 1;
+    check(optimistic_flat_hash_map_contains(&map, READERS, &key),
+          CCC_TRIBOOL_ERROR);
+    check(optimistic_flat_hash_map_contains(&map, 0, &key), false);
+    check(optimistic_flat_hash_map_is_empty(&map), true);
+    check(optimistic_flat_hash_map_validate(&map), true);
+    check_end(optimistic_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(optimistic_flat_hash_map_test_writer_semantics,
+                   CCC_Flat_hash_map_option const options)
+{
+    Optimistic_flat_hash_map map = {};
+    check(optimistic_flat_hash_map_initialize_with_options(
+              &map, struct Val, key, CCC_hash_key_u64, val_key_order,
+              std_allocate, NULL, 1, options),
+          CCC_RESULT_OK);
+    CCC_Entry e = optimistic_flat_hash_map_insert_or_assign(
+        &map, &(struct Val){.key = 1, .a = 10, .b = 10});
+    check(CCC_entry_occupied(&e), false);
+    e = optimistic_flat_hash_map_insert_or_assign(
+        &map, &(struct Val){.key = 1, .a = 11, .b = 11});
+    check(CCC_entry_occupied(&e), true);
+    struct Val v = {.key = 1, .a = 99};
+    e = optimistic_flat_hash_map_try_insert(&map, &v);
+    check(CCC_entry_occupied(&e), true);
+    check(v.a, 11);
+    /* Enough keys to grow the table several times and erase many of them to
+       leave it full of deleted slots. */
+    for (uint64_t key = 2; key < 1000; ++key)
+    {
+        v = (struct Val){.key = key, .a = key, .b = key};
+        e = optimistic_flat_hash_map_try_insert(&map, &v);
+        check(CCC_entry_occupied(&e), false);
+    }
+    check(optimistic_flat_hash_map_count(&map).count, 999);
+    check(optimistic_flat_hash_map_validate(&map), true);
+    for (uint64_t key = 2; key < 1000; key += 2)
+    {
+        struct Val out = {.key = key};
+        e = optimistic_flat_hash_map_remove_key_value(&map, &out);
+        check(CCC_entry_occupied(&e), true);
+        check(out.a, key);
+    }
+    for (uint64_t key = 1000; key < 2000; ++key)
+    {
+        e = optimistic_flat_hash_map_insert_or_assign(
+            &map, &(struct Val){.key = key, .a = key, .b = key});
+        check(CCC_entry_occupied(&e), false);
+    }
+    check(optimistic_flat_hash_map_validate(&map), true);
+    for (uint64_t key = 2; key < 2000; ++key)
+    {
+        struct Val out = {};
+        CCC_Tribool const found
+            = optimistic_flat_hash_map_get_key_value(&map, 0, &key, &out);
+        check(found, key >= 1000 || key % 2);
+        if (found)
+        {
+            check(out.a, key);
+        }
+    }
+    /* Without readers inside a lookup every retired table is reclaimed. */
+    check(optimistic_flat_hash_map_reclaim(&map).count, 0);
+    check_end(optimistic_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(optimistic_flat_hash_map_test_concurrent_readers)
+{
+    Optimistic_flat_hash_map map = {};
+    check(optimistic_flat_hash_map_initialize(&map, struct Val, key,
+                                              CCC_hash_key_u64, val_key_order,
+                                              std_allocate, NULL, READERS),
+          CCC_RESULT_OK);
+    for (uint64_t key = 0; key < STABLE_KEYS; ++key)
+    {
+        CCC_Entry const e = optimistic_flat_hash_map_insert_or_assign(
+            &map, &(struct Val){.key = key, .a = key, .b = key});
+        check(CCC_entry_insert_error(&e), false);
+    }
+    atomic_bool done = false;
+    pthread_t threads[READERS];
+    struct Reader readers[READERS];
+    for (size_t i = 0; i < READERS; ++i)
+    {
+        readers[i] = (struct Reader){.map = &map, .done = &done, .id = i};
+        check(pthread_create(&threads[i], NULL, read_stable, &readers[i]), 0);
+    }
+    /* The writer grows the table many times under the readers and rewrites
+       the stable keys between growths. */
+    for (uint64_t key = STABLE_KEYS; key < STABLE_KEYS + WRITER_KEYS; ++key)
+    {
+        CCC_Entry e = optimistic_flat_hash_map_insert_or_assign(
+            &map, &(struct Val){.key = key, .a = key, .b = key});
+        check(CCC_entry_insert_error(&e), false);
+        uint64_t const stable = key % STABLE_KEYS;
+        uint64_t const val = stable + (STABLE_KEYS * (key / STABLE_KEYS));
+        e = optimistic_flat_hash_map_insert_or_assign(
+            &map, &(struct Val){.key = stable, .a = val, .b = val});
+        check(CCC_entry_occupied(&e), true);
+    }
+    for (size_t round = 0; round < ROUNDS; ++round)
+    {
+        for (uint64_t key = STABLE_KEYS; key < STABLE_KEYS + WRITER_KEYS;
+             key += 3)
+        {
+            struct Val out = {.key = key};
+            CCC_Entry const e
+                = optimistic_flat_hash_map_remove_key_value(&map, &out);
+            check(CCC_entry_occupied(&e), true);
+            check(out.a, out.b);
+            out.a = out.b = out.a + 1;
+            CCC_Entry const back
+                = optimistic_flat_hash_map_insert_or_assign(&map, &out);
+            check(CCC_entry_occupied(&back), false);
+        }
+    }
+    atomic_store(&done, true);
+    for (size_t i = 0; i < READERS; ++i)
+    {
+        check(pthread_join(threads[i], NULL), 0);
+        check(readers[i].failures, 0);
+    }
+    check(optimistic_flat_hash_map_count(&map).count,
+          STABLE_KEYS + WRITER_KEYS);
+    check(optimistic_flat_hash_map_validate(&map), true);
+    check(optimistic_flat_hash_map_reclaim(&map).count, 0);
+    check_end({
+        atomic_store(&done, true);
+        (void)optimistic_flat_hash_map_clear_and_free(&map, NULL);
+    });
+}
+
+int
+main(void)
+{
+    return check_run(optimistic_flat_hash_map_test_initialize_errors(),
+                     optimistic_flat_hash_map_test_writer_semantics(
+                         CCC_FLAT_HASH_MAP_OPTION_NONE),
+                     optimistic_flat_hash_map_test_writer_semantics(
+                         CCC_FLAT_HASH_MAP_OPTION_STORE_HASH),
+                     optimistic_flat_hash_map_test_concurrent_readers());
+}
@@ -0,0 +1,242 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHARDED_FLAT_HASH_MAP_USING_NAMESPACE_CCC
+#define FLAT_HASH_MAP_USING_NAMESPACE_CCC
+
+#include "ccc/flat_hash_map.h"
+#include "ccc/hash.h"
+#include "ccc/sharded_flat_hash_map.h"
+#include "ccc/types.h"
+#include "checkers.h"
+#include "utility/allocate.h"
+
+enum : size_t
+{
+    THREADS = 8,
+    KEYS_PER_THREAD = 2000,
+    SHARED_KEYS = 64,
+    INCREMENTS = 500,
+    SHARDS = 16,
+};
+
+struct Val
+{
+    uint64_t key;
+    uint64_t val;
+};
+
+struct Worker
+{
+    Sharded_flat_hash_map *map;
+    size_t id;
+    uint64_t sum;
+    size_t failures;
+};
+
+static CCC_Order
+val_key_order(CCC_Key_comparator_context const order)
+{
+    uint64_t const *const left = order.key_left;
+    struct Val const *const right = order.type_right;
+    return (*left > right->key) - (*left < right->key);
+}
+
+static void
+increment(CCC_Type_context const t)
+{
+    ++((struct Val *)t.type)->val;
+}
+
+static void *
+insert_range(void *const arg)
+{
+    struct Worker *const w = arg;
+    for (uint64_t i = 0; i < KEYS_PER_THREAD; ++i)
+    {
+        uint64_t const key = (w->id * KEYS_PER_THREAD) + i;
+        struct Val v = {.key = key, .val = key * 2};
+        CCC_Entry const e = sharded_flat_hash_map_try_insert(w->map, &v);
+        w->failures += CCC_entry_occupied(&e) != CCC_FALSE
+                    || CCC_entry_insert_error(&e) != CCC_FALSE;
+    }
+    return NULL;
+}
+
+/* Every thread increments the same keys so threads contend for shards. */
+static void *
+increment_shared(void *const arg)
+{
+    struct Worker *const w = arg;
+    for (size_t round = 0; round < INCREMENTS; ++round)
+    {
+        for (uint64_t key = 0; key < SHARED_KEYS; ++key)
+        {
+            Sharded_flat_hash_map_entry e
+                = sharded_flat_hash_map_entry(w->map, &key);
+            struct Val *const v = sharded_flat_hash_map_or_insert(
+                sharded_flat_hash_map_and_modify(&e, increment),
+                &(struct Val){.key = key, .val = 1});
+            w->failures += v == NULL;
+            w->failures
+                += sharded_flat_hash_map_entry_release(&e) != CCC_RESULT_OK;
+        }
+    }
+    return NULL;
+}
+
+/* Threads divide the shards among themselves and scan without a global
+   lock. */
+static void *
+scan_shards(void *const arg)
+{
+    struct Worker *const w = arg;
+    size_t const shards = sharded_flat_hash_map_shard_count(w->map).count;
+    for (size_t s = w->id; s < shards; s += THREADS)
+    {
+        Flat_hash_map *const shard
+            = sharded_flat_hash_map_shard_lock(w->map, s);
+        for (struct Val const *v = flat_hash_map_begin(shard);
+             v != flat_hash_map_end(shard); v = flat_hash_map_next(shard, v))
+        {
+            w->sum += v->val;
+        }
+        (void)sharded_flat_hash_map_shard_unlock(w->map, s);
+    }
+    return NULL;
+}
+
+check_static_begin(sharded_flat_hash_map_test_initialize_errors)
+{
+    Sharded_flat_hash_map map = {};
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           std_allocate, NULL, 0),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           NULL, NULL, 4),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           std_allocate, NULL, 5),
+          CCC_RESULT_OK);
+    check(sharded_flat_hash_map_shard_count(&map).count, 8);
+    check(sharded_flat_hash_map_shard_lock(&map, 8) == NULL, true);
+    check(sharded_flat_hash_map_is_empty(&map), true);
+    check_end(sharded_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(sharded_flat_hash_map_test_copy_semantics)
+{
+    Sharded_flat_hash_map map = {};
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           std_allocate, NULL, SHARDS),
+          CCC_RESULT_OK);
+    CCC_Entry e = sharded_flat_hash_map_insert_or_assign(
+        &map, &(struct Val){.key = 1, .val = 10});
+    check(CCC_entry_occupied(&e), false);
+    e = sharded_flat_hash_map_insert_or_assign(
+        &map, &(struct Val){.key = 1, .val = 11});
+    check(CCC_entry_occupied(&e), true);
+    struct Val v = {.key = 1, .val = 99};
+    e = sharded_flat_hash_map_try_insert(&map, &v);
+    check(CCC_entry_occupied(&e), true);
+    check(v.val, 11);
+    v = (struct Val){.key = 1, .val = 12};
+    e = sharded_flat_hash_map_swap_entry(&map, &v);
+    check(CCC_entry_occupied(&e), true);
+    check(v.val, 11);
+    struct Val out = {};
+    uint64_t const key = 1;
+    check(sharded_flat_hash_map_get_key_value(&map, &key, &out), true);
+    check(out.val, 12);
+    check(sharded_flat_hash_map_contains(&map, &(uint64_t){2}), false);
+    out = (struct Val){.key = 1};
+    e = sharded_flat_hash_map_remove_key_value(&map, &out);
+    check(CCC_entry_occupied(&e), true);
+    check(out.val, 12);
+    check(sharded_flat_hash_map_contains(&map, &key), false);
+    check(sharded_flat_hash_map_count(&map).count, 0);
+    check(sharded_flat_hash_map_validate(&map), true);
+    check_end(sharded_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(sharded_flat_hash_map_test_concurrent_insert)
+{
+    Sharded_flat_hash_map map = {};
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           std_allocate, NULL, SHARDS),
+          CCC_RESULT_OK);
+    pthread_t threads[THREADS];
+    struct Worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct Worker){.map = &map, .id = i};
+        check(pthread_create(&threads[i], NULL, insert_range, &workers[i]), 0);
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        check(pthread_join(threads[i], NULL), 0);
+        check(workers[i].failures, 0);
+    }
+    check(sharded_flat_hash_map_count(&map).count, THREADS * KEYS_PER_THREAD);
+    check(sharded_flat_hash_map_validate(&map), true);
+    for (uint64_t key = 0; key < THREADS * KEYS_PER_THREAD; ++key)
+    {
+        struct Val out = {};
+        check(sharded_flat_hash_map_get_key_value(&map, &key, &out), true);
+        check(out.val, key * 2);
+    }
+    check_end(sharded_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+check_static_begin(sharded_flat_hash_map_test_concurrent_entry)
+{
+    Sharded_flat_hash_map map = {};
+    check(sharded_flat_hash_map_initialize(&map, struct Val, key,
+                                           CCC_hash_key_u64, val_key_order,
+                                           std_allocate, NULL, SHARDS),
+          CCC_RESULT_OK);
+    pthread_t threads[THREADS];
+    struct Worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct Worker){.map = &map, .id = i};
+        check(pthread_create(&threads[i], NULL, increment_shared, &workers[i]),
+              0);
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        check(pthread_join(threads[i], NULL), 0);
+        check(workers[i].failures, 0);
+    }
+    check(sharded_flat_hash_map_count(&map).count, SHARED_KEYS);
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct Worker){.map = &map, .id = i};
+        check(pthread_create(&threads[i], NULL, scan_shards, &workers[i]), 0);
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        check(pthread_join(threads[i], NULL), 0);
+        total += workers[i].sum;
+    }
+    check(total, (uint64_t)THREADS * INCREMENTS * SHARED_KEYS);
+    check(sharded_flat_hash_map_validate(&map), true);
+    check_end(sharded_flat_hash_map_clear_and_free(&map, NULL););
+}
+
+int
+main(void)
+{
+    return check_run(sharded_flat_hash_map_test_initialize_errors(),
+                     sharded_flat_hash_map_test_copy_semantics(),
+                     sharded_flat_hash_map_test_concurrent_insert(),
+                     sharded_flat_hash_map_test_concurrent_entry());
+}
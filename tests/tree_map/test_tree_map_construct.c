@@ -1,10 +1,12 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "buffer.h"
 #include "checkers.h"
 #include "tree_map.h"
 #include "tree_map_utility.h"
 #include "types.h"
+#include "utility/allocate.h"
 #include "utility/stack_allocator.h"
 
 static CCC_Tree_map
@@ -91,11 +93,147 @@ check_static_begin(tree_map_test_construct_from_fail)
     check_end((void)CCC_tree_map_clear(&map, NULL););
 }
 
+/** Every size up to a few complete trees, and one large size, is built from
+sorted keys, checked in order, and then modified so that the insert and remove
+fix ups run on the ranks the build assigned. */
+check_static_begin(tree_map_test_construct_from_sorted)
+{
+    enum : size_t
+    {
+        SMALL_SIZES = 70,
+        MAX_SIZE = 1000,
+    };
+    static struct Val vals[MAX_SIZE];
+    struct Sized_allocator sized = {};
+    CCC_Tree_map map = CCC_tree_map_initialize(struct Val, elem, key, id_order,
+                                               sized_allocate, &sized);
+    for (size_t round = 0; round <= SMALL_SIZES; ++round)
+    {
+        size_t const n = round < SMALL_SIZES ? round : MAX_SIZE;
+        for (size_t i = 0; i < n; ++i)
+        {
+            vals[i] = (struct Val){.key = (int)i * 2, .val = (int)i};
+        }
+        CCC_Buffer buffer
+            = CCC_buffer_initialize(vals, struct Val, NULL, NULL, n, n);
+        check(CCC_tree_map_from_sorted(&map, &buffer), CCC_RESULT_OK);
+        check(CCC_tree_map_validate(&map), true);
+        check(CCC_tree_map_count(&map).count, n);
+        int expected = 0;
+        for (struct Val const *v = CCC_tree_map_begin(&map);
+             v != CCC_tree_map_end(&map); v = CCC_tree_map_next(&map, &v->elem))
+        {
+            check(v->key, expected * 2);
+            check(v->val, expected);
+            ++expected;
+        }
+        check((size_t)expected, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            struct Val odd = {.key = (int)i * 2 + 1};
+            CCC_Entry const e = CCC_tree_map_try_insert(&map, &odd.elem);
+            check(CCC_entry_insert_error(&e), false);
+            check(CCC_entry_occupied(&e), false);
+        }
+        check(CCC_tree_map_validate(&map), true);
+        for (size_t i = 0; i < n; i += 2)
+        {
+            struct Val even = {.key = (int)i * 2};
+            CCC_Entry const e
+                = CCC_tree_map_remove_key_value(&map, &even.elem);
+            check(CCC_entry_occupied(&e), true);
+        }
+        check(CCC_tree_map_validate(&map), true);
+        check(CCC_tree_map_count(&map).count, n + (n / 2));
+        check(CCC_tree_map_clear(&map, NULL), CCC_RESULT_OK);
+        check(sized.live_bytes, 0);
+    }
+    check_end((void)CCC_tree_map_clear(&map, NULL););
+}
+
+check_static_begin(tree_map_test_construct_from_sorted_in_place)
+{
+    struct Val vals[33];
+    for (size_t i = 0; i < 33; ++i)
+    {
+        vals[i] = (struct Val){.key = (int)i, .val = (int)i};
+    }
+    CCC_Buffer buffer
+        = CCC_buffer_initialize(vals, struct Val, NULL, NULL, 33, 33);
+    CCC_Tree_map map
+        = CCC_tree_map_initialize(struct Val, elem, key, id_order, NULL, NULL);
+    check(CCC_tree_map_from_sorted(&map, &buffer), CCC_RESULT_OK);
+    check(CCC_tree_map_validate(&map), true);
+    check(CCC_tree_map_count(&map).count, 33);
+    /* Without allocation the Buffer elements are the stored elements. */
+    check(CCC_tree_map_get_key_value(&map, &(int){16}) == &vals[16], true);
+    struct Val extra = {.key = 100, .val = 100};
+    CCC_Entry const e = CCC_tree_map_try_insert(&map, &extra.elem);
+    check(CCC_entry_unwrap(&e) == &extra, true);
+    for (int i = 0; i < 33; i += 3)
+    {
+        struct Val out = {.key = i};
+        CCC_Entry const r = CCC_tree_map_remove_key_value(&map, &out.elem);
+        check(CCC_entry_unwrap(&r) == &vals[i], true);
+    }
+    check(CCC_tree_map_validate(&map), true);
+    check(CCC_tree_map_count(&map).count, 23);
+    check_end();
+}
+
+check_static_begin(tree_map_test_construct_from_sorted_fail)
+{
+    struct Val unsorted[3] = {{.key = 0}, {.key = 2}, {.key = 1}};
+    struct Val repeated[3] = {{.key = 0}, {.key = 1}, {.key = 1}};
+    struct Val sorted[5] = {{.key = 0}, {.key = 1}, {.key = 2}, {.key = 3},
+                            {.key = 4}};
+    CCC_Buffer unsorted_buffer
+        = CCC_buffer_initialize(unsorted, struct Val, NULL, NULL, 3, 3);
+    CCC_Buffer repeated_buffer
+        = CCC_buffer_initialize(repeated, struct Val, NULL, NULL, 3, 3);
+    CCC_Buffer sorted_buffer
+        = CCC_buffer_initialize(sorted, struct Val, NULL, NULL, 5, 5);
+    int ints[2] = {0, 1};
+    CCC_Buffer wrong_type = CCC_buffer_initialize(ints, int, NULL, NULL, 2, 2);
+    struct Stack_allocator allocator
+        = stack_allocator_initialize(struct Val, 3);
+    CCC_Tree_map map = CCC_tree_map_initialize(
+        struct Val, elem, key, id_order, stack_allocator_allocate, &allocator);
+    check(CCC_tree_map_from_sorted(&map, &unsorted_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(CCC_tree_map_from_sorted(&map, &repeated_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(CCC_tree_map_from_sorted(&map, &wrong_type),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(CCC_tree_map_from_sorted(NULL, &sorted_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(CCC_tree_map_is_empty(&map), true);
+    /* Only three of the five copies can be allocated. */
+    check(CCC_tree_map_from_sorted(&map, &sorted_buffer),
+          CCC_RESULT_ALLOCATOR_ERROR);
+    check(CCC_tree_map_is_empty(&map), true);
+    check(CCC_tree_map_validate(&map), true);
+    stack_allocator_reset(&allocator);
+    check(CCC_tree_map_from_sorted(&map, &unsorted_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(allocator.bytes_occupied, 0);
+    struct Val one = {.key = 7};
+    (void)CCC_tree_map_try_insert(&map, &one.elem);
+    /* Only an empty map may be built. */
+    check(CCC_tree_map_from_sorted(&map, &repeated_buffer),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(CCC_tree_map_count(&map).count, 1);
+    check_end((void)CCC_tree_map_clear(&map, NULL););
+}
+
 int
 main()
 {
     return check_run(tree_map_test_empty(), tree_map_test_construct(),
                      tree_map_test_construct_from(),
                      tree_map_test_construct_from_overwrite(),
-                     tree_map_test_construct_from_fail());
+                     tree_map_test_construct_from_fail(),
+                     tree_map_test_construct_from_sorted(),
+                     tree_map_test_construct_from_sorted_in_place(),
+                     tree_map_test_construct_from_sorted_fail());
 }
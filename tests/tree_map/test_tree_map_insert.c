@@ -11,6 +11,7 @@
 #include "tree_map.h"
 #include "tree_map_utility.h"
 #include "types.h"
+#include "utility/allocate.h"
 #include "utility/stack_allocator.h"
 
 static inline struct Val
@@ -467,6 +468,71 @@ check_static_begin(tree_map_test_insert_weak_srand)
     check_end(tree_map_clear(&rom, NULL););
 }
 
+check_static_begin(tree_map_test_insert_hint)
+{
+    CCC_Tree_map rom = tree_map_initialize(struct Val, elem, key, id_order,
+                                           std_allocate, NULL);
+    int const to_insert = 1000;
+    /* Appending after the last insert is the sorted input case hints serve. */
+    struct Val const *hint = NULL;
+    for (int i = 0; i < to_insert; i += 2)
+    {
+        CCC_Entry const e = tree_map_try_insert_hint(
+            &rom, hint, &(struct Val){.key = i, .val = i}.elem);
+        check(occupied(&e), false);
+        hint = unwrap(&e);
+        check(hint != NULL, true);
+        check(hint->key, i);
+    }
+    check(validate(&rom), true);
+    /* A far hint walks up to the root and still finds the odd gaps. */
+    struct Val const *const first = begin(&rom);
+    for (int i = to_insert - 1; i > 0; i -= 2)
+    {
+        CCC_Entry const e = tree_map_insert_or_assign_hint(
+            &rom, first, &(struct Val){.key = i, .val = i}.elem);
+        check(occupied(&e), false);
+    }
+    check(validate(&rom), true);
+    check(count(&rom).count, (size_t)to_insert);
+    int expected = 0;
+    for (struct Val const *i = begin(&rom); i != end(&rom);
+         i = next(&rom, &i->elem), ++expected)
+    {
+        check(i->key, expected);
+    }
+    check(expected, to_insert);
+    /* A hint that is the key itself finds it without descending. */
+    struct Val *const middle = get_key_value(&rom, &(int){to_insert / 2});
+    check(middle != NULL, true);
+    CCC_Entry e = tree_map_try_insert_hint(
+        &rom, middle, &(struct Val){.key = to_insert / 2, .val = -1}.elem);
+    check(occupied(&e), true);
+    check(((struct Val *)unwrap(&e))->val, to_insert / 2);
+    e = tree_map_insert_or_assign_hint(
+        &rom, middle, &(struct Val){.key = to_insert / 2, .val = -1}.elem);
+    check(occupied(&e), true);
+    check(middle->val, -1);
+    /* Entries from a hint match entries from the root. */
+    struct Val *v = or_insert(
+        tree_map_entry_hint_wrap(&rom, hint, &(int){to_insert}),
+        &(struct Val){.key = to_insert, .val = to_insert}.elem);
+    check(v != NULL, true);
+    check(v->key, to_insert);
+    check(end(&rom) == v, false);
+    v = or_insert(tree_map_entry_hint_wrap(&rom, v, &(int){-1}),
+                  &(struct Val){.key = -1, .val = -1}.elem);
+    check(v != NULL, true);
+    check(begin(&rom) == v, true);
+    CCC_Tree_map_entry const found
+        = tree_map_entry_hint(&rom, NULL, &(int){to_insert / 2});
+    check(occupied(&found), true);
+    check(unwrap(&found) == middle, true);
+    check(validate(&rom), true);
+    check(count(&rom).count, (size_t)to_insert + 2);
+    check_end(tree_map_clear(&rom, NULL););
+}
+
 int
 main()
 {
@@ -477,5 +543,5 @@ main()
         tree_map_test_insert_via_entry_macros(),
         tree_map_test_entry_api_functional(), tree_map_test_entry_api_macros(),
         tree_map_test_two_sum(), tree_map_test_insert_weak_srand(),
-        tree_map_test_insert_shuffle());
+        tree_map_test_insert_shuffle(), tree_map_test_insert_hint());
 }
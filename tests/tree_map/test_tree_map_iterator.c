@@ -421,6 +421,103 @@ check_static_begin(tree_map_test_empty_range)
     check_end();
 }
 
+/** Every position in an inorder walk must agree with rank and select. */
+check_static_begin(order_statistics_check, Tree_map const *const s)
+{
+    size_t index = 0;
+    for (struct Counted_val *i = begin(s); i != end(s);
+         i = next(s, &i->elem.node), ++index)
+    {
+        check(tree_map_select(s, index), i);
+        CCC_Count const rank = tree_map_rank(s, &i->key);
+        check(rank.error, CCC_RESULT_OK);
+        check(rank.count, index);
+        check(tree_map_count_range(s, &i->key, &(int){i->key + 1}).count, 1);
+    }
+    check(index, count(s).count);
+    check(tree_map_select(s, index), NULL);
+    check_end();
+}
+
+check_static_begin(tree_map_test_order_statistics)
+{
+    /* A plain node has no room for a count. */
+    Tree_map plain
+        = tree_map_initialize(struct Val, elem, key, id_order, NULL, NULL);
+    check(tree_map_enable_order_statistics(&plain), CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_rank(&plain, &(int){0}).error, CCC_RESULT_ARGUMENT_ERROR);
+    struct Stack_allocator allocator
+        = stack_allocator_initialize(struct Counted_val, 300);
+    Tree_map s
+        = tree_map_initialize(struct Counted_val, elem, key, counted_id_order,
+                              stack_allocator_allocate, &allocator);
+    check(tree_map_rank(&s, &(int){0}).error, CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_select(&s, 0), NULL);
+    check(tree_map_enable_order_statistics(&s), CCC_RESULT_OK);
+    check(tree_map_rank(&s, &(int){0}).count, 0);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const key_range = 200;
+    for (int i = 0; i < 300; ++i)
+    {
+        /* Force duplicates. */
+        (void)swap_entry(&s,
+                         &(struct Counted_val){
+                             .key = rand() % key_range, /* NOLINT */
+                             .val = i,
+                         }
+                              .elem.node,
+                         &(struct Counted_val){}.elem.node);
+        check(validate(&s), true);
+    }
+    check(order_statistics_check(&s), CHECK_PASS);
+    for (int i = 0; i < 150; ++i)
+    {
+        (void)remove_key_value(&s, &(struct Counted_val){
+                                       .key = rand() % key_range, /* NOLINT */
+                                   }
+                                        .elem.node);
+        check(validate(&s), true);
+    }
+    check(order_statistics_check(&s), CHECK_PASS);
+    check(tree_map_count_range(&s, &(int){0}, &(int){key_range}).count,
+          count(&s).count);
+    check(tree_map_count_range(&s, &(int){key_range}, &(int){0}).count, 0);
+    check_end();
+}
+
+check_static_begin(tree_map_test_order_statistics_enable_late)
+{
+    struct Stack_allocator allocator
+        = stack_allocator_initialize(struct Counted_val, 25);
+    Tree_map s
+        = tree_map_initialize(struct Counted_val, elem, key, counted_id_order,
+                              stack_allocator_allocate, &allocator);
+    int const num_nodes = 25;
+    /* 0, 5, 10, 15, 20, 25, 30, 35,... 120 */
+    for (int i = 0, id = 0; i < num_nodes; ++i, id += 5)
+    {
+        (void)insert_or_assign(
+            &s, &(struct Counted_val){.key = id, .val = i}.elem.node);
+    }
+    check(tree_map_count_range(&s, &(int){6}, &(int){44}).error,
+          CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_enable_order_statistics(&s), CCC_RESULT_OK);
+    check(validate(&s), true);
+    check(order_statistics_check(&s), CHECK_PASS);
+    /* Absent keys rank at the position they would be inserted. */
+    check(tree_map_rank(&s, &(int){6}).count, 2);
+    check(tree_map_rank(&s, &(int){-1}).count, 0);
+    check(tree_map_rank(&s, &(int){999}).count, num_nodes);
+    /* [6, 44) holds 10 through 40 and [10, 45) is the same range. */
+    check(tree_map_count_range(&s, &(int){6}, &(int){44}).count, 7);
+    check(tree_map_count_range(&s, &(int){10}, &(int){45}).count, 7);
+    check(((struct Counted_val *)tree_map_select(&s, 24))->key, 120);
+    check(tree_map_select(&s, 25), NULL);
+    check_end();
+}
+
 int
 main()
 {
@@ -428,5 +525,7 @@ main()
         tree_map_test_forward_iterator(), tree_map_test_iterate_removal(),
         tree_map_test_valid_range(), tree_map_test_valid_range_equals(),
         tree_map_test_invalid_range(), tree_map_test_empty_range(),
-        tree_map_test_iterate_remove_key_value_reinsert());
+        tree_map_test_iterate_remove_key_value_reinsert(),
+        tree_map_test_order_statistics(),
+        tree_map_test_order_statistics_enable_late());
 }
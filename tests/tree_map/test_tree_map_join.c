@@ -0,0 +1,460 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TREE_MAP_USING_NAMESPACE_CCC
+#define TRAITS_USING_NAMESPACE_CCC
+#define TYPES_USING_NAMESPACE_CCC
+
+#include "checkers.h"
+#include "traits.h"
+#include "tree_map.h"
+#include "tree_map_utility.h"
+#include "types.h"
+#include "utility/allocate.h"
+
+enum : int
+{
+    KEYS = 1000,
+    /** Enough keys that both sides of the first few splits are merged by
+    threads of their own. */
+    PARALLEL_KEYS = 1 << 17,
+};
+
+/** The thread that started the parallel set operations. */
+static pthread_t set_operation_caller;
+/** Elements destroyed by a set operation and those destroyed off the caller. */
+static size_t destroyed;
+static size_t destroyed_elsewhere;
+
+/** The map must hold exactly the keys marked in the expected set in order. */
+check_static_begin(check_keys, Tree_map const *const map,
+                   bool const expected[static KEYS])
+{
+    check(validate(map), true);
+    size_t present = 0;
+    for (int key = 0; key < KEYS; ++key)
+    {
+        present += expected[key];
+    }
+    check(count(map).count, present);
+    int prev = -1;
+    size_t seen = 0;
+    for (struct Val const *i = begin(map); i != end(map);
+         i = next(map, &i->elem), ++seen)
+    {
+        check(i->key > prev, true);
+        check(expected[i->key], true);
+        prev = i->key;
+    }
+    check(seen, present);
+    check_end();
+}
+
+/** Fills the map with random keys and records them in the set. */
+check_static_begin(fill_random, Tree_map *const map, bool set[static KEYS],
+                   int const tries)
+{
+    for (int i = 0; i < tries; ++i)
+    {
+        int const key = rand() % KEYS; /* NOLINT */
+        CCC_Entry const e
+            = insert_or_assign(map, &(struct Val){.key = key, .val = i}.elem);
+        check(insert_error(&e), false);
+        set[key] = true;
+    }
+    check_end();
+}
+
+/** The map of counted values must hold exactly the keys marked in the expected
+set in order. */
+check_static_begin(check_counted_keys, Tree_map const *const map,
+                   bool const expected[static KEYS])
+{
+    check(validate(map), true);
+    size_t present = 0;
+    for (int key = 0; key < KEYS; ++key)
+    {
+        present += expected[key];
+    }
+    check(count(map).count, present);
+    int prev = -1;
+    size_t seen = 0;
+    for (struct Counted_val const *i = begin(map); i != end(map);
+         i = next(map, &i->elem.node), ++seen)
+    {
+        check(i->key > prev, true);
+        check(expected[i->key], true);
+        prev = i->key;
+    }
+    check(seen, present);
+    check_end();
+}
+
+/** Fills the map of counted values with random keys and records them. */
+check_static_begin(fill_counted_random, Tree_map *const map,
+                   bool set[static KEYS], int const tries)
+{
+    for (int i = 0; i < tries; ++i)
+    {
+        int const key = rand() % KEYS; /* NOLINT */
+        CCC_Entry const e = insert_or_assign(
+            map, &(struct Counted_val){.key = key, .val = i}.elem.node);
+        check(insert_error(&e), false);
+        set[key] = true;
+    }
+    check_end();
+}
+
+check_static_begin(tree_map_test_set_operations, int const lhs_tries,
+                   int const rhs_tries)
+{
+    struct Sized_allocator sized = {};
+    Tree_map a = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    Tree_map b = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    bool a_keys[KEYS] = {};
+    bool b_keys[KEYS] = {};
+    bool expected[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+
+    check(fill_random(&a, a_keys, lhs_tries), CHECK_PASS);
+    check(fill_random(&b, b_keys, rhs_tries), CHECK_PASS);
+    check(tree_map_union(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = a_keys[key] || b_keys[key];
+        a_keys[key] = expected[key];
+        b_keys[key] = false;
+    }
+    check(check_keys(&a, expected), CHECK_PASS);
+    check(is_empty(&b), true);
+
+    check(fill_random(&b, b_keys, rhs_tries), CHECK_PASS);
+    check(tree_map_intersection(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = a_keys[key] && b_keys[key];
+        a_keys[key] = expected[key];
+        b_keys[key] = false;
+    }
+    check(check_keys(&a, expected), CHECK_PASS);
+    check(is_empty(&b), true);
+
+    check(fill_random(&a, a_keys, lhs_tries), CHECK_PASS);
+    check(fill_random(&b, b_keys, rhs_tries), CHECK_PASS);
+    check(tree_map_difference(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = a_keys[key] && !b_keys[key];
+    }
+    check(check_keys(&a, expected), CHECK_PASS);
+    check(is_empty(&b), true);
+    check_end({
+        (void)tree_map_clear(&a, NULL);
+        (void)tree_map_clear(&b, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+static void
+count_destroyed(CCC_Type_context const)
+{
+    ++destroyed;
+    destroyed_elsewhere += !pthread_equal(pthread_self(), set_operation_caller);
+}
+
+/** Inserts every key below PARALLEL_KEYS that is a multiple of step. */
+check_static_begin(fill_multiples, Tree_map *const map, int const step)
+{
+    for (int key = 0; key < PARALLEL_KEYS; key += step)
+    {
+        CCC_Entry const e
+            = insert_or_assign(map, &(struct Val){.key = key, .val = key}.elem);
+        check(insert_error(&e), false);
+    }
+    check_end();
+}
+
+/** The map must hold exactly the keys below PARALLEL_KEYS that the predicate
+accepts, in order. */
+check_static_begin(check_multiples, Tree_map const *const map,
+                   bool (*const keep)(int), size_t const expected)
+{
+    check(validate(map), true);
+    check(count(map).count, expected);
+    int key = 0;
+    for (struct Val const *i = begin(map); i != end(map);
+         i = next(map, &i->elem))
+    {
+        while (!keep(key))
+        {
+            ++key;
+        }
+        check(i->key, key);
+        check(i->val, key);
+        ++key;
+    }
+    check_end();
+}
+
+static bool
+even_or_third(int const key)
+{
+    return !(key % 2) || !(key % 3);
+}
+
+static bool
+even(int const key)
+{
+    return !(key % 2);
+}
+
+static bool
+even_not_sixth(int const key)
+{
+    return !(key % 2) && key % 6;
+}
+
+/** The parallel set operations must leave the same keys as the serial ones,
+count every dropped element, and destroy them all on the calling thread. */
+check_static_begin(tree_map_test_set_operations_parallel, size_t const threads)
+{
+    struct Sized_allocator sized = {};
+    Tree_map a = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    Tree_map b = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    set_operation_caller = pthread_self();
+    destroyed = destroyed_elsewhere = 0;
+    size_t const halves = PARALLEL_KEYS / 2;
+    size_t const thirds = (PARALLEL_KEYS + 2) / 3;
+    size_t const sixths = (PARALLEL_KEYS + 5) / 6;
+
+    check(fill_multiples(&a, 2), CHECK_PASS);
+    check(fill_multiples(&b, 3), CHECK_PASS);
+    check(tree_map_union_parallel(&a, &b, count_destroyed, threads),
+          CCC_RESULT_OK);
+    check(destroyed, sixths);
+    check(check_multiples(&a, even_or_third, halves + thirds - sixths),
+          CHECK_PASS);
+    check(is_empty(&b), true);
+
+    destroyed = 0;
+    check(fill_multiples(&b, 2), CHECK_PASS);
+    check(tree_map_intersection_parallel(&a, &b, count_destroyed, threads),
+          CCC_RESULT_OK);
+    check(destroyed, (thirds - sixths) + halves);
+    check(check_multiples(&a, even, halves), CHECK_PASS);
+    check(is_empty(&b), true);
+
+    destroyed = 0;
+    check(fill_multiples(&b, 6), CHECK_PASS);
+    check(tree_map_difference_parallel(&a, &b, count_destroyed, threads),
+          CCC_RESULT_OK);
+    check(destroyed, 2 * sixths);
+    check(check_multiples(&a, even_not_sixth, halves - sixths), CHECK_PASS);
+    check(is_empty(&b), true);
+
+    check(tree_map_intersection_parallel(&a, &b, count_destroyed, threads),
+          CCC_RESULT_OK);
+    check(is_empty(&a), true);
+    check(destroyed_elsewhere, 0);
+    check(tree_map_union_parallel(NULL, &b, NULL, threads),
+          CCC_RESULT_ARGUMENT_ERROR);
+    check_end({
+        (void)tree_map_clear(&a, NULL);
+        (void)tree_map_clear(&b, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(tree_map_test_set_operations_order_statistics)
+{
+    struct Sized_allocator sized = {};
+    Tree_map a = tree_map_initialize(struct Counted_val, elem, key,
+                                     counted_id_order, sized_allocate, &sized);
+    Tree_map b = tree_map_initialize(struct Counted_val, elem, key,
+                                     counted_id_order, sized_allocate, &sized);
+    check(tree_map_enable_order_statistics(&a), CCC_RESULT_OK);
+    bool a_keys[KEYS] = {};
+    bool b_keys[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    check(fill_counted_random(&a, a_keys, 300), CHECK_PASS);
+    check(fill_counted_random(&b, b_keys, 700), CHECK_PASS);
+    /* Only the destination keeps counts so the source is counted first. */
+    check(tree_map_union(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        a_keys[key] = a_keys[key] || b_keys[key];
+        b_keys[key] = false;
+    }
+    check(check_counted_keys(&a, a_keys), CHECK_PASS);
+    size_t index = 0;
+    for (struct Counted_val const *i = begin(&a); i != end(&a);
+         i = next(&a, &i->elem.node), ++index)
+    {
+        check(tree_map_rank(&a, &i->key).count, index);
+    }
+    check(fill_counted_random(&b, b_keys, 500), CHECK_PASS);
+    check(tree_map_difference(&a, &b, NULL), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        a_keys[key] = a_keys[key] && !b_keys[key];
+    }
+    check(check_counted_keys(&a, a_keys), CHECK_PASS);
+    check(tree_map_count_range(&a, &(int){0}, &(int){KEYS}).count,
+          count(&a).count);
+    check_end({
+        (void)tree_map_clear(&a, NULL);
+        (void)tree_map_clear(&b, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(tree_map_test_split_join, int const split_key)
+{
+    struct Sized_allocator sized = {};
+    Tree_map map = tree_map_initialize(struct Val, elem, key, id_order,
+                                       sized_allocate, &sized);
+    Tree_map greater = tree_map_initialize(struct Val, elem, key, id_order,
+                                           sized_allocate, &sized);
+    bool keys[KEYS] = {};
+    bool expected[KEYS] = {};
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    check(fill_random(&map, keys, KEYS / 2), CHECK_PASS);
+    check(tree_map_split(&map, &split_key, &greater), CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key < split_key;
+    }
+    check(check_keys(&map, expected), CHECK_PASS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key >= split_key;
+    }
+    check(check_keys(&greater, expected), CHECK_PASS);
+    check(tree_map_join(&map, &greater), CCC_RESULT_OK);
+    check(check_keys(&map, keys), CHECK_PASS);
+    check(is_empty(&greater), true);
+    check_end({
+        (void)tree_map_clear(&map, NULL);
+        (void)tree_map_clear(&greater, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(tree_map_test_extract_range)
+{
+    struct Sized_allocator sized = {};
+    Tree_map map
+        = tree_map_initialize(struct Counted_val, elem, key, counted_id_order,
+                              sized_allocate, &sized);
+    Tree_map range
+        = tree_map_initialize(struct Counted_val, elem, key, counted_id_order,
+                              sized_allocate, &sized);
+    check(tree_map_enable_order_statistics(&map), CCC_RESULT_OK);
+    bool keys[KEYS] = {};
+    bool expected[KEYS] = {};
+    for (int key = 0; key < KEYS; key += 3)
+    {
+        (void)insert_or_assign(&map,
+                               &(struct Counted_val){.key = key}.elem.node);
+        keys[key] = true;
+    }
+    int const begin_key = 100;
+    int const end_key = 601;
+    check(tree_map_extract_range(&map, &begin_key, &end_key, &range),
+          CCC_RESULT_OK);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && key >= begin_key && key < end_key;
+    }
+    check(check_counted_keys(&range, expected), CHECK_PASS);
+    for (int key = 0; key < KEYS; ++key)
+    {
+        expected[key] = keys[key] && (key < begin_key || key >= end_key);
+    }
+    check(check_counted_keys(&map, expected), CHECK_PASS);
+    check(tree_map_rank(&map, &end_key).count, count(&map).count - 133);
+    /* The range put back between the remaining halves restores the map. */
+    Tree_map upper
+        = tree_map_initialize(struct Counted_val, elem, key, counted_id_order,
+                              sized_allocate, &sized);
+    check(tree_map_split(&map, &end_key, &upper), CCC_RESULT_OK);
+    check(tree_map_join(&map, &range), CCC_RESULT_OK);
+    check(tree_map_join(&map, &upper), CCC_RESULT_OK);
+    check(check_counted_keys(&map, keys), CHECK_PASS);
+    /* A backwards range moves nothing. */
+    check(tree_map_extract_range(&map, &end_key, &begin_key, &range),
+          CCC_RESULT_OK);
+    check(is_empty(&range), true);
+    check(check_counted_keys(&map, keys), CHECK_PASS);
+    check_end({
+        (void)tree_map_clear(&map, NULL);
+        (void)tree_map_clear(&range, NULL);
+        (void)tree_map_clear(&upper, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+check_static_begin(tree_map_test_join_split_arguments)
+{
+    struct Sized_allocator sized = {};
+    Tree_map a = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    Tree_map b = tree_map_initialize(struct Val, elem, key, id_order,
+                                     sized_allocate, &sized);
+    Tree_map other_memory = tree_map_initialize(struct Val, elem, key,
+                                                id_order, std_allocate, NULL);
+    for (int key = 0; key < 10; ++key)
+    {
+        (void)insert_or_assign(&a, &(struct Val){.key = key}.elem);
+        (void)insert_or_assign(&b, &(struct Val){.key = key + 9}.elem);
+    }
+    /* Key 9 is in both maps so b does not follow a. */
+    check(tree_map_join(&a, &b), CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_join(&a, &a), CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_union(&a, &other_memory, NULL), CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_split(&a, &(int){5}, &b), CCC_RESULT_ARGUMENT_ERROR);
+    check(tree_map_split(&a, NULL, &other_memory), CCC_RESULT_ARGUMENT_ERROR);
+    check(count(&a).count, 10);
+    check(count(&b).count, 10);
+    check(tree_map_difference(&b, &a, NULL), CCC_RESULT_OK);
+    check(count(&b).count, 9);
+    check(is_empty(&a), true);
+    check(tree_map_join(&a, &b), CCC_RESULT_OK);
+    check(count(&a).count, 9);
+    check(validate(&a), true);
+    check_end({
+        (void)tree_map_clear(&a, NULL);
+        (void)tree_map_clear(&b, NULL);
+        check(sized.live_bytes, 0);
+    });
+}
+
+int
+main()
+{
+    return check_run(tree_map_test_set_operations(500, 500),
+                     tree_map_test_set_operations(900, 20),
+                     tree_map_test_set_operations(20, 900),
+                     tree_map_test_set_operations_order_statistics(),
+                     tree_map_test_set_operations_parallel(1),
+                     tree_map_test_set_operations_parallel(4),
+                     tree_map_test_set_operations_parallel(7),
+                     tree_map_test_split_join(KEYS / 2),
+                     tree_map_test_split_join(0),
+                     tree_map_test_split_join(KEYS),
+                     tree_map_test_extract_range(),
+                     tree_map_test_join_split_arguments());
+}
@@ -18,6 +18,14 @@ id_order(CCC_Key_comparator_context const order)
     return (key > c->key) - (key < c->key);
 }
 
+CCC_Order
+counted_id_order(CCC_Key_comparator_context const order)
+{
+    struct Counted_val const *const c = order.type_right;
+    int const key = *((int *)order.key_left);
+    return (key > c->key) - (key < c->key);
+}
+
 check_begin(insert_shuffled, CCC_Tree_map *m, size_t const size,
             int const larger_prime)
 {
@@ -14,7 +14,16 @@ struct Val
     CCC_Tree_map_node elem;
 };
 
+/** A value with room for subtree counts for maps with order statistics. */
+struct Counted_val
+{
+    int key;
+    int val;
+    CCC_Tree_map_counted_node elem;
+};
+
 CCC_Order id_order(CCC_Key_comparator_context);
+CCC_Order counted_id_order(CCC_Key_comparator_context);
 
 /** Runs a prime shuffle over the map using size as N and larger_prime as the
 larger prime to run the shuffle. Expects the map to have allocation permission.
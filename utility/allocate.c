@@ -1,5 +1,7 @@
+#include <stdalign.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "allocate.h"
 #include "types.h"
@@ -23,3 +25,47 @@ std_allocate(CCC_Allocator_context const context)
     }
     return realloc(context.input, context.bytes);
 }
+
+/** Requests memory aligned to at least the requested alignment. The standard
+requires the size given to aligned_alloc to be a multiple of the alignment. */
+static void *
+aligned_block(size_t const bytes, size_t const alignment)
+{
+    if (alignment <= alignof(max_align_t))
+    {
+        return malloc(bytes);
+    }
+    return aligned_alloc(alignment,
+                         (bytes + alignment - 1) & ~(alignment - 1));
+}
+
+void *
+sized_allocate(CCC_Allocator_context const context)
+{
+    struct Sized_allocator *const sized = context.context;
+    if (!sized || (!context.input && !context.bytes))
+    {
+        return NULL;
+    }
+    if (!context.bytes)
+    {
+        sized->live_bytes -= context.old_bytes;
+        free(context.input);
+        return NULL;
+    }
+    void *const block = aligned_block(context.bytes, context.alignment);
+    if (!block)
+    {
+        return NULL;
+    }
+    if (context.input)
+    {
+        (void)memcpy(block, context.input,
+                     context.old_bytes < context.bytes ? context.old_bytes
+                                                       : context.bytes);
+        sized->live_bytes -= context.old_bytes;
+        free(context.input);
+    }
+    sized->live_bytes += context.bytes;
+    return block;
+}
@@ -5,4 +5,20 @@
 
 void *std_allocate(CCC_Allocator_context);
 
+/** The state of a sized allocator. It keeps no header in front of its blocks
+and instead trusts the old size reported by the container on every resize and
+free. The live byte count returns to zero once a container has freed all it
+allocated, if and only if every reported size was correct. */
+struct Sized_allocator
+{
+    /** The bytes outstanding according to the sizes the caller reported. */
+    size_t live_bytes;
+};
+
+/** Allocates through the standard library while honoring the alignment field
+of the request and resizing with the old_bytes field rather than realloc. The
+context must point to a Sized_allocator. Intended for testing that containers
+report old sizes correctly. */
+void *sized_allocate(CCC_Allocator_context);
+
 #endif /* CCC_ALLOC_H */